@@ -11,12 +11,17 @@
 #include "access/htup_details.h"
 #include "catalog/pg_type.h"
 #include "funcapi.h"
+#include "miscadmin.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
+#include "utils/hsearch.h"
 
 
 #define NUM_BUFFERCACHE_PAGES_MIN_ELEM	8
 #define NUM_BUFFERCACHE_PAGES_ELEM	9
+#define NUM_BUFFERCACHE_SUMMARY_ELEM 5
+#define NUM_BUFFERCACHE_USAGE_COUNTS_ELEM 4
+#define NUM_BUFFERCACHE_RELATIONS_ELEM 8
 
 PG_MODULE_MAGIC;
 
@@ -54,11 +59,29 @@ typedef struct
 } BufferCachePagesContext;
 
 
+/*
+ * Hash table entry accumulating the buffers of one relation fork, for
+ * pg_buffercache_relations.
+ */
+typedef struct
+{
+	RelFileNode rnode;			/* hash key, with forknum */
+	ForkNumber	forknum;
+	int32		buffers;
+	int32		dirty;
+	int32		pinned;
+	int64		usagecount_total;
+} BufferCacheRelationsEntry;
+
+
 /*
  * Function returning data from the shared buffer cache - buffer number,
  * relation node/tablespace/database/blocknum and dirty indicator.
  */
 PG_FUNCTION_INFO_V1(pg_buffercache_pages);
+PG_FUNCTION_INFO_V1(pg_buffercache_summary);
+PG_FUNCTION_INFO_V1(pg_buffercache_usage_counts);
+PG_FUNCTION_INFO_V1(pg_buffercache_relations);
 
 Datum
 pg_buffercache_pages(PG_FUNCTION_ARGS)
@@ -237,3 +260,208 @@ pg_buffercache_pages(PG_FUNCTION_ARGS)
 	else
 		SRF_RETURN_DONE(funcctx);
 }
+
+/*
+ * Return a single row summarizing the state of the whole buffer cache,
+ * without building a row per buffer.
+ *
+ * Unlike pg_buffercache_pages, we don't take the buffer header locks; each
+ * buffer's state word is read atomically, which is all we need here.  The
+ * result is not a consistent snapshot, but it's cheap enough to run often.
+ */
+Datum
+pg_buffercache_summary(PG_FUNCTION_ARGS)
+{
+	Datum		result;
+	TupleDesc	tupledesc;
+	HeapTuple	tuple;
+	Datum		values[NUM_BUFFERCACHE_SUMMARY_ELEM];
+	bool		nulls[NUM_BUFFERCACHE_SUMMARY_ELEM];
+
+	int32		buffers_used = 0;
+	int32		buffers_unused = 0;
+	int32		buffers_dirty = 0;
+	int32		buffers_pinned = 0;
+	int64		usagecount_total = 0;
+
+	if (get_call_result_type(fcinfo, NULL, &tupledesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	for (int i = 0; i < NBuffers; i++)
+	{
+		BufferDesc *bufHdr;
+		uint32		buf_state;
+
+		CHECK_FOR_INTERRUPTS();
+
+		bufHdr = GetBufferDescriptor(i);
+		buf_state = pg_atomic_read_u32(&bufHdr->state);
+
+		if (buf_state & BM_VALID)
+		{
+			buffers_used++;
+			usagecount_total += BUF_STATE_GET_USAGECOUNT(buf_state);
+
+			if (buf_state & BM_DIRTY)
+				buffers_dirty++;
+		}
+		else
+			buffers_unused++;
+
+		if (BUF_STATE_GET_REFCOUNT(buf_state) > 0)
+			buffers_pinned++;
+	}
+
+	memset(nulls, 0, sizeof(nulls));
+	values[0] = Int32GetDatum(buffers_used);
+	values[1] = Int32GetDatum(buffers_unused);
+	values[2] = Int32GetDatum(buffers_dirty);
+	values[3] = Int32GetDatum(buffers_pinned);
+
+	if (buffers_used != 0)
+		values[4] = Float8GetDatum((double) usagecount_total / buffers_used);
+	else
+		nulls[4] = true;
+
+	/* Build and return the tuple. */
+	tuple = heap_form_tuple(tupledesc, values, nulls);
+	result = HeapTupleGetDatum(tuple);
+
+	PG_RETURN_DATUM(result);
+}
+
+/*
+ * Return one row per possible usage count, giving the number of buffers with
+ * that usage count and how many of them are dirty or pinned.  Like
+ * pg_buffercache_summary, this reads the state words without locking.
+ */
+Datum
+pg_buffercache_usage_counts(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	int			usage_counts[BM_MAX_USAGE_COUNT + 1] = {0};
+	int			dirty[BM_MAX_USAGE_COUNT + 1] = {0};
+	int			pinned[BM_MAX_USAGE_COUNT + 1] = {0};
+	Datum		values[NUM_BUFFERCACHE_USAGE_COUNTS_ELEM];
+	bool		nulls[NUM_BUFFERCACHE_USAGE_COUNTS_ELEM] = {0};
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	for (int i = 0; i < NBuffers; i++)
+	{
+		BufferDesc *bufHdr = GetBufferDescriptor(i);
+		uint32		buf_state = pg_atomic_read_u32(&bufHdr->state);
+		int			usage_count;
+
+		CHECK_FOR_INTERRUPTS();
+
+		usage_count = BUF_STATE_GET_USAGECOUNT(buf_state);
+		usage_counts[usage_count]++;
+
+		if (buf_state & BM_DIRTY)
+			dirty[usage_count]++;
+
+		if (BUF_STATE_GET_REFCOUNT(buf_state) > 0)
+			pinned[usage_count]++;
+	}
+
+	for (int i = 0; i < BM_MAX_USAGE_COUNT + 1; i++)
+	{
+		values[0] = Int32GetDatum(i);
+		values[1] = Int32GetDatum(usage_counts[i]);
+		values[2] = Int32GetDatum(dirty[i]);
+		values[3] = Int32GetDatum(pinned[i]);
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	return (Datum) 0;
+}
+
+/*
+ * Return one row per relation fork with buffers in the cache, giving the
+ * number of its buffers and how many of them are dirty or pinned.  The
+ * counts are accumulated in a hash table in one pass over the buffers, so
+ * the result has as many rows as there are cached relation forks, not
+ * buffers.
+ *
+ * Like pg_buffercache_pages, we lock each buffer header while reading its
+ * tag, which could otherwise be torn by a concurrent replacement.  The lock
+ * is only held for a few instructions.
+ */
+Datum
+pg_buffercache_relations(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	HASHCTL		hash_ctl;
+	HTAB	   *relations;
+	HASH_SEQ_STATUS status;
+	BufferCacheRelationsEntry *entry;
+	Datum		values[NUM_BUFFERCACHE_RELATIONS_ELEM];
+	bool		nulls[NUM_BUFFERCACHE_RELATIONS_ELEM] = {0};
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	/* the key is the rnode and forknum fields, which have no padding */
+	hash_ctl.keysize = offsetof(BufferCacheRelationsEntry, buffers);
+	hash_ctl.entrysize = sizeof(BufferCacheRelationsEntry);
+	hash_ctl.hcxt = CurrentMemoryContext;
+	relations = hash_create("pg_buffercache relations", 1024, &hash_ctl,
+							HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	for (int i = 0; i < NBuffers; i++)
+	{
+		BufferDesc *bufHdr = GetBufferDescriptor(i);
+		BufferCacheRelationsEntry key;
+		uint32		buf_state;
+		bool		found;
+
+		CHECK_FOR_INTERRUPTS();
+
+		buf_state = LockBufHdr(bufHdr);
+		if (!(buf_state & BM_VALID) || !(buf_state & BM_TAG_VALID))
+		{
+			UnlockBufHdr(bufHdr, buf_state);
+			continue;
+		}
+		key.rnode = bufHdr->tag.rnode;
+		key.forknum = bufHdr->tag.forkNum;
+		UnlockBufHdr(bufHdr, buf_state);
+
+		entry = hash_search(relations, &key, HASH_ENTER, &found);
+		if (!found)
+		{
+			entry->buffers = 0;
+			entry->dirty = 0;
+			entry->pinned = 0;
+			entry->usagecount_total = 0;
+		}
+
+		entry->buffers++;
+		entry->usagecount_total += BUF_STATE_GET_USAGECOUNT(buf_state);
+		if (buf_state & BM_DIRTY)
+			entry->dirty++;
+		if (BUF_STATE_GET_REFCOUNT(buf_state) > 0)
+			entry->pinned++;
+	}
+
+	hash_seq_init(&status, relations);
+	while ((entry = hash_seq_search(&status)) != NULL)
+	{
+		values[0] = ObjectIdGetDatum(entry->rnode.relNode);
+		values[1] = ObjectIdGetDatum(entry->rnode.spcNode);
+		values[2] = ObjectIdGetDatum(entry->rnode.dbNode);
+		values[3] = Int16GetDatum(entry->forknum);
+		values[4] = Int32GetDatum(entry->buffers);
+		values[5] = Int32GetDatum(entry->dirty);
+		values[6] = Int32GetDatum(entry->pinned);
+		values[7] = Float8GetDatum((double) entry->usagecount_total /
+								   entry->buffers);
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	hash_destroy(relations);
+
+	return (Datum) 0;
+}
@@ -10,11 +10,17 @@
  *		and we need to lock the relations so that we don't try to prewarm
  *		pages from a relation that is in the process of being dropped.
  *
- *		While prewarming, autoprewarm will use two workers.  There's a
- *		leader worker that reads and sorts the list of blocks to be
- *		prewarmed and then launches a per-database worker for each
- *		relevant database in turn.  The former keeps running after the
- *		initial prewarm is complete to update the dump file periodically.
+ *		While prewarming, autoprewarm uses a leader worker that reads and
+ *		sorts the list of blocks to be prewarmed and then prewarms each
+ *		relevant database in turn, by splitting its blocks among up to
+ *		autoprewarm_workers per-database workers that run concurrently.
+ *		The leader keeps running after the initial prewarm is complete to
+ *		update the dump file periodically.
+ *
+ *		The per-database workers read the blocks in runs of consecutive
+ *		blocks, each with a single vectored read, and prefetch the
+ *		following ones in batches, so that a storage manager that fetches
+ *		pages over the network can serve them with few round trips.
  *
  *	Copyright (c) 2016-2022, PostgreSQL Global Development Group
  *
@@ -75,14 +81,32 @@ typedef struct AutoPrewarmSharedState
 	pid_t		bgworker_pid;	/* for main bgworker */
 	pid_t		pid_using_dumpfile; /* for autoprewarm or block dump */
 
-	/* Following items are for communication with per-database worker */
+	/* Following items are for communication with per-database workers */
 	dsm_handle	block_info_handle;
-	Oid			database;
-	int			prewarm_start_idx;
-	int			prewarm_stop_idx;
 	int			prewarmed_blocks;
 } AutoPrewarmSharedState;
 
+/*
+ * Work assignment of a per-database worker, passed in bgw_extra: the range
+ * of BlockInfoRecords to prewarm, and when to give up.
+ */
+typedef struct AutoPrewarmWorkerArgs
+{
+	Oid			database;
+	int			start_idx;
+	int			stop_idx;
+	TimestampTz deadline;		/* 0 if no time limit */
+} AutoPrewarmWorkerArgs;
+
+StaticAssertDecl(sizeof(AutoPrewarmWorkerArgs) <= BGW_EXTRALEN,
+				 "AutoPrewarmWorkerArgs must fit in bgw_extra");
+
+/* maximum number of per-database workers prewarming one database */
+#define AUTOPREWARM_MAX_WORKERS	64
+
+/* don't split databases with fewer blocks than this per worker */
+#define MIN_BLOCKS_PER_WORKER	1024
+
 void		_PG_init(void);
 void		autoprewarm_main(Datum main_arg);
 void		autoprewarm_database_main(Datum main_arg);
@@ -93,7 +117,9 @@ PG_FUNCTION_INFO_V1(autoprewarm_dump_now);
 static void apw_load_buffers(void);
 static int	apw_dump_now(bool is_bgworker, bool dump_unlogged);
 static void apw_start_leader_worker(void);
-static void apw_start_database_worker(void);
+static BackgroundWorkerHandle *apw_start_database_worker(AutoPrewarmWorkerArgs *args);
+static void apw_prewarm_database(Oid database, int start_idx, int stop_idx,
+								 TimestampTz deadline);
 static bool apw_init_shmem(void);
 static void apw_detach_shmem(int code, Datum arg);
 static int	apw_compare_blockinfo(const void *p, const void *q);
@@ -106,6 +132,8 @@ static AutoPrewarmSharedState *apw_state = NULL;
 /* GUC variables. */
 static bool autoprewarm = true; /* start worker? */
 static int	autoprewarm_interval;	/* dump interval */
+static int	autoprewarm_workers;	/* per-database workers per database */
+static int	autoprewarm_time_limit; /* time budget of the initial prewarm */
 
 /*
  * Module load callback.
@@ -125,6 +153,30 @@ _PG_init(void)
 							NULL,
 							NULL);
 
+	DefineCustomIntVariable("pg_prewarm.autoprewarm_workers",
+							"Sets the number of workers prewarming a database concurrently.",
+							NULL,
+							&autoprewarm_workers,
+							1,
+							1, AUTOPREWARM_MAX_WORKERS,
+							PGC_SIGHUP,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("pg_prewarm.autoprewarm_time_limit",
+							"Sets the maximum duration of the prewarm at startup.",
+							"If set to zero, there is no limit.",
+							&autoprewarm_time_limit,
+							0,
+							0, INT_MAX / 1000,
+							PGC_SIGHUP,
+							GUC_UNIT_S,
+							NULL,
+							NULL,
+							NULL);
+
 	if (!process_shared_preload_libraries_in_progress)
 		return;
 
@@ -282,8 +334,8 @@ autoprewarm_main(Datum main_arg)
 }
 
 /*
- * Read the dump file and launch per-database workers one at a time to
- * prewarm the buffers found there.
+ * Read the dump file and launch per-database workers to prewarm the buffers
+ * found there, one database at a time.
  */
 static void
 apw_load_buffers(void)
@@ -291,8 +343,10 @@ apw_load_buffers(void)
 	FILE	   *file = NULL;
 	int			num_elements,
 				i;
+	int			start_idx;
 	BlockInfoRecord *blkinfo;
 	dsm_segment *seg;
+	TimestampTz deadline = 0;
 
 	/*
 	 * Skip the prewarm if the dump file is in use; otherwise, prevent any
@@ -364,18 +418,22 @@ apw_load_buffers(void)
 
 	/* Populate shared memory state. */
 	apw_state->block_info_handle = dsm_segment_handle(seg);
-	apw_state->prewarm_start_idx = apw_state->prewarm_stop_idx = 0;
 	apw_state->prewarmed_blocks = 0;
 
+	if (autoprewarm_time_limit > 0)
+		deadline = TimestampTzPlusMilliseconds(GetCurrentTimestamp(),
+											   autoprewarm_time_limit * 1000);
+
 	/* Get the info position of the first block of the next database. */
-	while (apw_state->prewarm_start_idx < num_elements)
+	start_idx = 0;
+	while (start_idx < num_elements)
 	{
-		int			j = apw_state->prewarm_start_idx;
+		int			j = start_idx;
 		Oid			current_db = blkinfo[j].database;
 
 		/*
-		 * Advance the prewarm_stop_idx to the first BlockInfoRecord that does
-		 * not belong to this database.
+		 * Advance j to the first BlockInfoRecord that does not belong to this
+		 * database.
 		 */
 		j++;
 		while (j < num_elements)
@@ -402,10 +460,7 @@ apw_load_buffers(void)
 		if (current_db == InvalidOid)
 			break;
 
-		/* Configure stop point and database for next per-database worker. */
-		apw_state->prewarm_stop_idx = j;
-		apw_state->database = current_db;
-		Assert(apw_state->prewarm_start_idx < apw_state->prewarm_stop_idx);
+		Assert(start_idx < j);
 
 		/* If we've run out of free buffers, don't launch another worker. */
 		if (!have_free_buffer())
@@ -418,14 +473,18 @@ apw_load_buffers(void)
 		if (ShutdownRequestPending)
 			break;
 
+		/* ... or if we're out of time */
+		if (deadline != 0 && GetCurrentTimestamp() >= deadline)
+			break;
+
 		/*
-		 * Start a per-database worker to load blocks for this database; this
-		 * function will return once the per-database worker exits.
+		 * Load blocks for this database; this returns once the per-database
+		 * workers exit.
 		 */
-		apw_start_database_worker();
+		apw_prewarm_database(current_db, start_idx, j, deadline);
 
 		/* Prepare for next database. */
-		apw_state->prewarm_start_idx = apw_state->prewarm_stop_idx;
+		start_idx = j;
 	}
 
 	/* Clean up. */
@@ -436,28 +495,91 @@ apw_load_buffers(void)
 	LWLockRelease(&apw_state->lock);
 
 	/* Report our success, if we were able to finish. */
-	if (!ShutdownRequestPending)
+	if (!ShutdownRequestPending && deadline != 0 &&
+		GetCurrentTimestamp() >= deadline)
+		ereport(LOG,
+				(errmsg("autoprewarm prewarmed %d of %d previously-loaded blocks before reaching the time limit",
+						apw_state->prewarmed_blocks, num_elements)));
+	else if (!ShutdownRequestPending)
 		ereport(LOG,
 				(errmsg("autoprewarm successfully prewarmed %d of %d previously-loaded blocks",
 						apw_state->prewarmed_blocks, num_elements)));
 }
 
 /*
- * Prewarm all blocks for one database (and possibly also global objects, if
- * those got grouped with this database).
+ * Prewarm the BlockInfoRecords start_idx..stop_idx-1, which belong to one
+ * database (and possibly also to global objects, if those got grouped with
+ * this database).  Unless the database has few blocks, they are split
+ * among autoprewarm_workers concurrent per-database workers.  If we can't
+ * launch as many workers, the remaining parts wait for a worker to exit.
+ */
+static void
+apw_prewarm_database(Oid database, int start_idx, int stop_idx,
+					 TimestampTz deadline)
+{
+	BackgroundWorkerHandle *handles[AUTOPREWARM_MAX_WORKERS];
+	int			nworkers;
+	int			nrunning = 0;
+
+	nworkers = Min(autoprewarm_workers,
+				   (stop_idx - start_idx) / MIN_BLOCKS_PER_WORKER);
+	nworkers = Max(nworkers, 1);
+
+	for (int i = 0; i < nworkers; i++)
+	{
+		AutoPrewarmWorkerArgs args;
+
+		args.database = database;
+		args.start_idx = start_idx +
+			(int) ((int64) (stop_idx - start_idx) * i / nworkers);
+		args.stop_idx = start_idx +
+			(int) ((int64) (stop_idx - start_idx) * (i + 1) / nworkers);
+		args.deadline = deadline;
+
+		while ((handles[nrunning] = apw_start_database_worker(&args)) == NULL)
+		{
+			if (nrunning == 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_INSUFFICIENT_RESOURCES),
+						 errmsg("registering dynamic bgworker autoprewarm failed"),
+						 errhint("Consider increasing configuration parameter \"max_worker_processes\".")));
+
+			/*
+			 * Ignore return value; if it fails, postmaster has died, but we
+			 * have checks for that elsewhere.
+			 */
+			WaitForBackgroundWorkerShutdown(handles[0]);
+			memmove(&handles[0], &handles[1],
+					(nrunning - 1) * sizeof(BackgroundWorkerHandle *));
+			nrunning--;
+		}
+		nrunning++;
+	}
+
+	for (int i = 0; i < nrunning; i++)
+		WaitForBackgroundWorkerShutdown(handles[i]);
+}
+
+/*
+ * Prewarm the blocks assigned to this per-database worker.
  */
 void
 autoprewarm_database_main(Datum main_arg)
 {
+	AutoPrewarmWorkerArgs args;
 	int			pos;
-	int			io_concurrency;
+	int			io_concurrency = -1;
 	BlockInfoRecord *block_info;
+	BlockInfoRecord *stop_blk;
 	Relation	rel = NULL;
 	BlockNumber nblocks = 0;
 	BlockInfoRecord *old_blk = NULL;
 	BlockInfoRecord *prefetch_blk = NULL;
+	int			prewarmed_blocks = 0;
 	dsm_segment *seg;
 
+	memcpy(&args, MyBgworkerEntry->bgw_extra, sizeof(args));
+
 	/* Establish signal handlers; once that's done, unblock signals. */
 	pqsignal(SIGTERM, die);
 	BackgroundWorkerUnblockSignals();
@@ -469,21 +591,26 @@ autoprewarm_database_main(Datum main_arg)
 		ereport(ERROR,
 				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
 				 errmsg("could not map dynamic shared memory segment")));
-	BackgroundWorkerInitializeConnectionByOid(apw_state->database, InvalidOid, 0);
+	BackgroundWorkerInitializeConnectionByOid(args.database, InvalidOid, 0);
 	block_info = (BlockInfoRecord *) dsm_segment_address(seg);
-	pos = apw_state->prewarm_start_idx;
+	pos = args.start_idx;
+	stop_blk = &block_info[args.stop_idx];
 
 	/*
-	 * Loop until we run out of blocks to prewarm or until we run out of free
-	 * buffers.
+	 * Loop until we run out of blocks to prewarm, until we run out of free
+	 * buffers, or until we run out of time.
 	 */
-	while (pos < apw_state->prewarm_stop_idx && have_free_buffer())
+	while (pos < args.stop_idx && have_free_buffer())
 	{
 		BlockInfoRecord *blk = &block_info[pos++];
-		Buffer		buf;
+		Buffer		buffers[MAX_BUFFERS_PER_READ];
+		int			nread;
 
 		CHECK_FOR_INTERRUPTS();
 
+		if (args.deadline != 0 && GetCurrentTimestamp() >= args.deadline)
+			break;
+
 		/*
 		 * Quit if we've reached records for another database. If previous
 		 * blocks are of some global objects, then continue pre-warming.
@@ -556,49 +683,68 @@ autoprewarm_database_main(Datum main_arg)
 			continue;
 		}
 
-		/* if prefetching is enabled for this relation */
+		/*
+		 * If prefetching is enabled for this relation, prefetch the following
+		 * blocks of the fork up to io_concurrency blocks ahead.  We top up
+		 * only once half of the distance has been consumed, so that the
+		 * prefetches go out in batches.
+		 */
 		if (io_concurrency > 0)
 		{
+			BlockNumber blocks[PREFETCH_BATCH_SIZE];
+			int			nprefetch = 0;
+
 			/* make prefetch_blk catch up */
 			if (blk > prefetch_blk)
-			{
 				prefetch_blk = blk;
-			}
 
-			/* now, prefetch all following blocks */
-			while (prefetch_blk <= &block_info[apw_state->prewarm_stop_idx])
+			if (prefetch_blk - blk <= io_concurrency / 2)
 			{
-				/* unless they're of a different relfilenode */
-				if (prefetch_blk->filenode != blk->filenode ||
-					prefetch_blk->forknum != blk->forknum ||
-					prefetch_blk->blocknum >= nblocks)
-					break;
-
-				/* or unless they are more than io_concurrency blocks ahead */
-				if (blk + io_concurrency <= prefetch_blk)
-					break;
-
-				PrefetchBuffer(rel, prefetch_blk->forknum, prefetch_blk->blocknum);
-
-				/* continue with the next block */
-				prefetch_blk++;
+				while (prefetch_blk < stop_blk &&
+					   prefetch_blk < blk + io_concurrency &&
+					   prefetch_blk->filenode == blk->filenode &&
+					   prefetch_blk->forknum == blk->forknum &&
+					   prefetch_blk->blocknum < nblocks)
+				{
+					blocks[nprefetch++] = (prefetch_blk++)->blocknum;
+					if (nprefetch == PREFETCH_BATCH_SIZE)
+					{
+						PrefetchBuffers(rel, blk->forknum, blocks, nprefetch);
+						nprefetch = 0;
+					}
+				}
+				if (nprefetch > 0)
+					PrefetchBuffers(rel, blk->forknum, blocks, nprefetch);
 			}
 		}
 
-		/* Prewarm buffer. */
-		buf = ReadBufferExtended(rel, blk->forknum, blk->blocknum, RBM_NORMAL,
-								 NULL);
-		if (BufferIsValid(buf))
-		{
-			apw_state->prewarmed_blocks++;
-			ReleaseBuffer(buf);
-		}
-
-		old_blk = blk;
+		/* Prewarm the run of consecutive blocks starting here. */
+		nread = 1;
+		while (nread < MAX_BUFFERS_PER_READ && blk + nread < stop_blk &&
+			   blk[nread].database == blk->database &&
+			   blk[nread].tablespace == blk->tablespace &&
+			   blk[nread].filenode == blk->filenode &&
+			   blk[nread].forknum == blk->forknum &&
+			   blk[nread].blocknum == blk->blocknum + nread &&
+			   blk[nread].blocknum < nblocks)
+			nread++;
+
+		ReadBuffers(rel, blk->forknum, blk->blocknum, nread, buffers,
+					RBM_NORMAL, NULL);
+		for (int i = 0; i < nread; i++)
+			ReleaseBuffer(buffers[i]);
+		prewarmed_blocks += nread;
+
+		pos += nread - 1;
+		old_blk = &blk[nread - 1];
 	}
 
 	dsm_detach(seg);
 
+	LWLockAcquire(&apw_state->lock, LW_EXCLUSIVE);
+	apw_state->prewarmed_blocks += prewarmed_blocks;
+	LWLockRelease(&apw_state->lock);
+
 	/* Release lock on previous relation. */
 	if (rel)
 	{
@@ -886,10 +1032,11 @@ apw_start_leader_worker(void)
 }
 
 /*
- * Start autoprewarm per-database worker process.
+ * Start autoprewarm per-database worker process.  Returns NULL if no
+ * background worker slot is available.
  */
-static void
-apw_start_database_worker(void)
+static BackgroundWorkerHandle *
+apw_start_database_worker(AutoPrewarmWorkerArgs *args)
 {
 	BackgroundWorker worker;
 	BackgroundWorkerHandle *handle;
@@ -903,21 +1050,15 @@ apw_start_database_worker(void)
 	strcpy(worker.bgw_function_name, "autoprewarm_database_main");
 	strcpy(worker.bgw_name, "autoprewarm worker");
 	strcpy(worker.bgw_type, "autoprewarm worker");
+	memcpy(worker.bgw_extra, args, sizeof(AutoPrewarmWorkerArgs));
 
 	/* must set notify PID to wait for shutdown */
 	worker.bgw_notify_pid = MyProcPid;
 
 	if (!RegisterDynamicBackgroundWorker(&worker, &handle))
-		ereport(ERROR,
-				(errcode(ERRCODE_INSUFFICIENT_RESOURCES),
-				 errmsg("registering dynamic bgworker autoprewarm failed"),
-				 errhint("Consider increasing configuration parameter \"max_worker_processes\".")));
+		return NULL;
 
-	/*
-	 * Ignore return value; if it fails, postmaster has died, but we have
-	 * checks for that elsewhere.
-	 */
-	WaitForBackgroundWorkerShutdown(handle);
+	return handle;
 }
 
 /* Compare member elements to check whether they are not equal. */
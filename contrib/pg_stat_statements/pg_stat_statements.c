@@ -19,19 +19,27 @@
  * these strings in a temporary external query-texts file.  Offsets into this
  * file are kept in shared memory.
  *
- * Note about locking issues: to create or delete an entry in the shared
- * hashtable, one must hold pgss->lock exclusively.  Modifying any field
- * in an entry except the counters requires the same.  To look up an entry,
- * one must hold the lock shared.  To read or update the counters within
- * an entry, one must hold the lock shared or exclusive (so the entry doesn't
- * disappear!) and also take the entry's mutex spinlock.
+ * Note about locking issues: the shared hashtable is protected by
+ * PGSS_NUM_LOCK_PARTITIONS partition locks, pgss->locks; a key belongs to
+ * the partition selected by its hash code.  Below, "holding pgss->locks
+ * exclusively" means holding every partition lock exclusively, while
+ * "holding pgss->locks shared" means holding at least one of them shared,
+ * which is enough to exclude anyone holding them all exclusively.
+ * To create or delete an entry in the shared hashtable, one must hold
+ * pgss->locks exclusively.  Modifying any field in an entry except the
+ * counters requires the same.  To look up an entry, one must hold the
+ * entry's partition lock shared; to scan the whole table, all of them.  To
+ * read or update the counters within an entry, one must hold the lock shared
+ * or exclusive (so the entry doesn't disappear!) and also take the entry's
+ * mutex spinlock.
  * The shared state variable pgss->extent (the next free spot in the external
  * query-text file) should be accessed only while holding either the
- * pgss->mutex spinlock, or exclusive lock on pgss->lock.  We use the mutex to
- * allow reserving file space while holding only shared lock on pgss->lock.
- * Rewriting the entire external query-text file, eg for garbage collection,
- * requires holding pgss->lock exclusively; this allows individual entries
- * in the file to be read or written while holding only shared lock.
+ * pgss->mutex spinlock, or exclusive lock on pgss->locks.  We use the mutex
+ * to allow reserving file space while holding only shared lock on
+ * pgss->locks.  Rewriting the entire external query-text file, eg for garbage
+ * collection, requires holding pgss->locks exclusively; this allows
+ * individual entries in the file to be read or written while holding only
+ * shared lock.
  *
  *
  * Copyright (c) 2008-2022, PostgreSQL Global Development Group
@@ -94,6 +102,7 @@ static const uint32 PGSS_PG_MAJOR_VERSION = PG_VERSION_NUM / 100;
 #define USAGE_INIT				(1.0)	/* including initial planning */
 #define ASSUMED_MEDIAN_INIT		(10.0)	/* initial assumed median usage */
 #define ASSUMED_LENGTH_INIT		1024	/* initial assumed mean query length */
+#define PGSS_NUM_LOCK_PARTITIONS	16	/* number of hashtable partition locks */
 #define USAGE_DECREASE_FACTOR	(0.99)	/* decreased every entry_dealloc */
 #define STICKY_DECREASE_FACTOR	(0.50)	/* factor for sticky entries */
 #define USAGE_DEALLOC_PERCENT	5	/* free this % of entries at once */
@@ -233,7 +242,8 @@ typedef struct pgssEntry
  */
 typedef struct pgssSharedState
 {
-	LWLock	   *lock;			/* protects hashtable search/modification */
+	LWLockPadded *locks;		/* partition locks protecting hashtable
+								 * search/modification */
 	double		cur_median_usage;	/* current median usage in hashtable */
 	Size		mean_query_len; /* current mean entry text length */
 	slock_t		mutex;			/* protects following fields only: */
@@ -243,6 +253,10 @@ typedef struct pgssSharedState
 	pgssGlobalStats stats;		/* global statistics for pgss */
 } pgssSharedState;
 
+/* Lock for the hashtable partition a key with the given hash code is in */
+#define PGSS_PARTITION_LOCK(hashcode) \
+	(&pgss->locks[(hashcode) % PGSS_NUM_LOCK_PARTITIONS].lock)
+
 /*---- Local variables ----*/
 
 /* Current nesting depth of ExecutorRun+ProcessUtility calls */
@@ -360,6 +374,8 @@ static char *qtext_fetch(Size query_offset, int query_len,
 static bool need_gc_qtexts(void);
 static void gc_qtexts(void);
 static void entry_reset(Oid userid, Oid dbid, uint64 queryid);
+static void pgss_lock_all(LWLockMode mode);
+static void pgss_unlock_all(void);
 static char *generate_normalized_query(JumbleState *jstate, const char *query,
 									   int query_loc, int *query_len_p);
 static void fill_in_constant_lengths(JumbleState *jstate, const char *query,
@@ -487,7 +503,7 @@ pgss_shmem_request(void)
 		prev_shmem_request_hook();
 
 	RequestAddinShmemSpace(pgss_memsize());
-	RequestNamedLWLockTranche("pg_stat_statements", 1);
+	RequestNamedLWLockTranche("pg_stat_statements", PGSS_NUM_LOCK_PARTITIONS);
 }
 
 /*
@@ -529,7 +545,7 @@ pgss_shmem_startup(void)
 	if (!found)
 	{
 		/* First time through ... */
-		pgss->lock = &(GetNamedLWLockTranche("pg_stat_statements"))->lock;
+		pgss->locks = GetNamedLWLockTranche("pg_stat_statements");
 		pgss->cur_median_usage = ASSUMED_MEDIAN_INIT;
 		pgss->mean_query_len = ASSUMED_LENGTH_INIT;
 		SpinLockInit(&pgss->mutex);
@@ -1231,6 +1247,9 @@ pgss_store(const char *query, uint64 queryId,
 		   JumbleState *jstate)
 {
 	pgssHashKey key;
+	uint32		hashcode;
+	LWLock	   *partitionLock;
+	bool		all_locked = false;
 	pgssEntry  *entry;
 	char	   *norm_query = NULL;
 	int			encoding = GetDatabaseEncoding();
@@ -1265,10 +1284,14 @@ pgss_store(const char *query, uint64 queryId,
 	key.queryid = queryId;
 	key.toplevel = (exec_nested_level == 0);
 
-	/* Lookup the hash table entry with shared lock. */
-	LWLockAcquire(pgss->lock, LW_SHARED);
+	/* Lookup the hash table entry with shared lock on its partition. */
+	hashcode = get_hash_value(pgss_hash, &key);
+	partitionLock = PGSS_PARTITION_LOCK(hashcode);
+	LWLockAcquire(partitionLock, LW_SHARED);
 
-	entry = (pgssEntry *) hash_search(pgss_hash, &key, HASH_FIND, NULL);
+	entry = (pgssEntry *) hash_search_with_hash_value(pgss_hash, &key,
+													   hashcode, HASH_FIND,
+													   NULL);
 
 	/* Create new entry, if not present */
 	if (!entry)
@@ -1287,11 +1310,11 @@ pgss_store(const char *query, uint64 queryId,
 		 */
 		if (jstate)
 		{
-			LWLockRelease(pgss->lock);
+			LWLockRelease(partitionLock);
 			norm_query = generate_normalized_query(jstate, query,
 												   query_location,
 												   &query_len);
-			LWLockAcquire(pgss->lock, LW_SHARED);
+			LWLockAcquire(partitionLock, LW_SHARED);
 		}
 
 		/* Append new query text to file with only shared lock held */
@@ -1305,9 +1328,14 @@ pgss_store(const char *query, uint64 queryId,
 		 */
 		do_gc = need_gc_qtexts();
 
-		/* Need exclusive lock to make a new hashtable entry - promote */
-		LWLockRelease(pgss->lock);
-		LWLockAcquire(pgss->lock, LW_EXCLUSIVE);
+		/*
+		 * Need exclusive lock on all partitions to make a new hashtable
+		 * entry, since entry_alloc may need to deallocate entries anywhere in
+		 * the table - promote
+		 */
+		LWLockRelease(partitionLock);
+		pgss_lock_all(LW_EXCLUSIVE);
+		all_locked = true;
 
 		/*
 		 * A garbage collection may have occurred while we weren't holding the
@@ -1419,7 +1447,10 @@ pgss_store(const char *query, uint64 queryId,
 	}
 
 done:
-	LWLockRelease(pgss->lock);
+	if (all_locked)
+		pgss_unlock_all();
+	else
+		LWLockRelease(partitionLock);
 
 	/* We postpone this clean-up until we're out of the lock */
 	if (norm_query)
@@ -1612,7 +1643,7 @@ pg_stat_statements_internal(FunctionCallInfo fcinfo,
 
 	/*
 	 * We'd like to load the query text file (if needed) while not holding any
-	 * lock on pgss->lock.  In the worst case we'll have to do this again
+	 * lock on pgss->locks.  In the worst case we'll have to do this again
 	 * after we have the lock, but it's unlikely enough to make this a win
 	 * despite occasional duplicated work.  We need to reload if anybody
 	 * writes to the file (either a retail qtext_store(), or a garbage
@@ -1641,17 +1672,15 @@ pg_stat_statements_internal(FunctionCallInfo fcinfo,
 	}
 
 	/*
-	 * Get shared lock, load or reload the query text file if we must, and
-	 * iterate over the hashtable entries.
+	 * Get shared lock on all partitions, load or reload the query text file
+	 * if we must, and iterate over the hashtable entries.
 	 *
-	 * With a large hash table, we might be holding the lock rather longer
+	 * With a large hash table, we might be holding the locks rather longer
 	 * than one could wish.  However, this only blocks creation of new hash
 	 * table entries, and the larger the hash table the less likely that is to
-	 * be needed.  So we can hope this is okay.  Perhaps someday we'll decide
-	 * we need to partition the hash table to limit the time spent holding any
-	 * one lock.
+	 * be needed.  So we can hope this is okay.
 	 */
-	LWLockAcquire(pgss->lock, LW_SHARED);
+	pgss_lock_all(LW_SHARED);
 
 	if (showtext)
 	{
@@ -1852,7 +1881,7 @@ pg_stat_statements_internal(FunctionCallInfo fcinfo,
 		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
 	}
 
-	LWLockRelease(pgss->lock);
+	pgss_unlock_all();
 
 	if (qbuffer)
 		free(qbuffer);
@@ -1915,7 +1944,7 @@ pgss_memsize(void)
 
 /*
  * Allocate a new hashtable entry.
- * caller must hold an exclusive lock on pgss->lock
+ * caller must hold an exclusive lock on pgss->locks
  *
  * "query" need not be null-terminated; we rely on query_len instead
  *
@@ -1984,7 +2013,7 @@ entry_cmp(const void *lhs, const void *rhs)
 /*
  * Deallocate least-used entries.
  *
- * Caller must hold an exclusive lock on pgss->lock.
+ * Caller must hold an exclusive lock on pgss->locks.
  */
 static void
 entry_dealloc(void)
@@ -2075,7 +2104,7 @@ entry_dealloc(void)
  *
  * On failure, returns false.
  *
- * At least a shared lock on pgss->lock must be held by the caller, so as
+ * At least a shared lock on pgss->locks must be held by the caller, so as
  * to prevent a concurrent garbage collection.  Share-lock-holding callers
  * should pass a gc_count pointer to obtain the number of garbage collections,
  * so that they can recheck the count after obtaining exclusive lock to
@@ -2170,7 +2199,7 @@ error:
  *
  * On success, the buffer size is also returned into *buffer_size.
  *
- * This can be called without any lock on pgss->lock, but in that case
+ * This can be called without any lock on pgss->locks, but in that case
  * the caller is responsible for verifying that the result is sane.
  */
 static char *
@@ -2287,7 +2316,7 @@ qtext_fetch(Size query_offset, int query_len,
 /*
  * Do we need to garbage-collect the external query text file?
  *
- * Caller should hold at least a shared lock on pgss->lock.
+ * Caller should hold at least a shared lock on pgss->locks.
  */
 static bool
 need_gc_qtexts(void)
@@ -2336,7 +2365,7 @@ need_gc_qtexts(void)
  * becomes unreasonably large, with no other method of compaction likely to
  * occur in the foreseeable future.
  *
- * The caller must hold an exclusive lock on pgss->lock.
+ * The caller must hold an exclusive lock on pgss->locks.
  *
  * At the first sign of trouble we unlink the query text file to get a clean
  * slate (although existing statistics are retained), rather than risk
@@ -2463,7 +2492,7 @@ gc_qtexts(void)
 
 	/*
 	 * OK, count a garbage collection cycle.  (Note: even though we have
-	 * exclusive lock on pgss->lock, we must take pgss->mutex for this, since
+	 * exclusive lock on pgss->locks, we must take pgss->mutex for this, since
 	 * other processes may examine gc_count while holding only the mutex.
 	 * Also, we have to advance the count *after* we've rewritten the file,
 	 * else other processes might not realize they read a stale file.)
@@ -2513,12 +2542,12 @@ gc_fail:
 	 * Bump the GC count even though we failed.
 	 *
 	 * This is needed to make concurrent readers of file without any lock on
-	 * pgss->lock notice existence of new version of file.  Once readers
-	 * subsequently observe a change in GC count with pgss->lock held, that
+	 * pgss->locks notice existence of new version of file.  Once readers
+	 * subsequently observe a change in GC count with pgss->locks held, that
 	 * forces a safe reopen of file.  Writers also require that we bump here,
 	 * of course.  (As required by locking protocol, readers and writers don't
 	 * trust earlier file contents until gc_count is found unchanged after
-	 * pgss->lock acquired in shared or exclusive mode respectively.)
+	 * pgss->locks acquired in shared or exclusive mode respectively.)
 	 */
 	record_gc_qtexts();
 }
@@ -2541,7 +2570,7 @@ entry_reset(Oid userid, Oid dbid, uint64 queryid)
 				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
 				 errmsg("pg_stat_statements must be loaded via shared_preload_libraries")));
 
-	LWLockAcquire(pgss->lock, LW_EXCLUSIVE);
+	pgss_lock_all(LW_EXCLUSIVE);
 	num_entries = hash_get_num_entries(pgss_hash);
 
 	if (userid != 0 && dbid != 0 && queryid != UINT64CONST(0))
@@ -2639,7 +2668,32 @@ done:
 	record_gc_qtexts();
 
 release_lock:
-	LWLockRelease(pgss->lock);
+	pgss_unlock_all();
+}
+
+/*
+ * Acquire all the hashtable partition locks, in partition order so that
+ * concurrent callers cannot deadlock.
+ */
+static void
+pgss_lock_all(LWLockMode mode)
+{
+	int			i;
+
+	for (i = 0; i < PGSS_NUM_LOCK_PARTITIONS; i++)
+		LWLockAcquire(&pgss->locks[i].lock, mode);
+}
+
+/*
+ * Release all the hashtable partition locks.
+ */
+static void
+pgss_unlock_all(void)
+{
+	int			i;
+
+	for (i = PGSS_NUM_LOCK_PARTITIONS; --i >= 0;)
+		LWLockRelease(&pgss->locks[i].lock);
 }
 
 /*
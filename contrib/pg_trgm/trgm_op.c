@@ -165,6 +165,19 @@ comp_trgm(const void *a, const void *b)
 	return CMPTRGM(a, b);
 }
 
+/*
+ * Specialized sort for trigram arrays, with CMPTRGM inlined rather than
+ * called through a function pointer the way qsort() would.  Trigram arrays
+ * are sorted for every indexed value and every query string, so this is
+ * worth having.
+ */
+#define ST_SORT trigram_qsort
+#define ST_ELEMENT_TYPE_VOID
+#define ST_COMPARE(a, b) CMPTRGM(a, b)
+#define ST_SCOPE static
+#define ST_DEFINE
+#include "lib/sort_template.h"
+
 /*
  * Finds first word in string, returns pointer to the word,
  * endword points to the character after word
@@ -376,7 +389,7 @@ generate_trgm(char *str, int slen)
 	 */
 	if (len > 1)
 	{
-		qsort((void *) GETARR(trg), len, sizeof(trgm), comp_trgm);
+		trigram_qsort(GETARR(trg), len, sizeof(trgm));
 		len = qunique(GETARR(trg), len, sizeof(trgm), comp_trgm);
 	}
 
@@ -924,7 +937,7 @@ generate_wildcard_trgm(const char *str, int slen)
 	 */
 	if (len > 1)
 	{
-		qsort((void *) GETARR(trg), len, sizeof(trgm), comp_trgm);
+		trigram_qsort(GETARR(trg), len, sizeof(trgm));
 		len = qunique(GETARR(trg), len, sizeof(trgm), comp_trgm);
 	}
 
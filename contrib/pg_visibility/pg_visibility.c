@@ -484,6 +484,7 @@ collect_visibility_data(Oid relid, bool include_pd)
 	BlockNumber blkno;
 	Buffer		vmbuffer = InvalidBuffer;
 	BufferAccessStrategy bstrategy = GetAccessStrategy(BAS_BULKREAD);
+	VMPrefetchState prefetch;
 
 	rel = relation_open(relid, AccessShareLock);
 
@@ -495,6 +496,9 @@ collect_visibility_data(Oid relid, bool include_pd)
 	info->next = 0;
 	info->count = nblocks;
 
+	if (include_pd)
+		visibilitymap_prefetch_init(&prefetch, rel, 0, false);
+
 	for (blkno = 0; blkno < nblocks; ++blkno)
 	{
 		int32		mapbits;
@@ -519,6 +523,7 @@ collect_visibility_data(Oid relid, bool include_pd)
 			Buffer		buffer;
 			Page		page;
 
+			visibilitymap_prefetch_before_read(&prefetch, rel, blkno, nblocks);
 			buffer = ReadBufferExtended(rel, MAIN_FORKNUM, blkno, RBM_NORMAL,
 										bstrategy);
 			LockBuffer(buffer, BUFFER_LOCK_SHARE);
@@ -532,6 +537,8 @@ collect_visibility_data(Oid relid, bool include_pd)
 	}
 
 	/* Clean up. */
+	if (include_pd)
+		visibilitymap_prefetch_end(&prefetch);
 	if (vmbuffer != InvalidBuffer)
 		ReleaseBuffer(vmbuffer);
 	relation_close(rel, AccessShareLock);
@@ -563,6 +570,7 @@ collect_corrupt_items(Oid relid, bool all_visible, bool all_frozen)
 	Buffer		vmbuffer = InvalidBuffer;
 	BufferAccessStrategy bstrategy = GetAccessStrategy(BAS_BULKREAD);
 	TransactionId OldestXmin = InvalidTransactionId;
+	VMPrefetchState prefetch;
 
 	rel = relation_open(relid, AccessShareLock);
 
@@ -587,6 +595,12 @@ collect_corrupt_items(Oid relid, bool all_visible, bool all_frozen)
 	items->count = 64;
 	items->tids = palloc(items->count * sizeof(ItemPointerData));
 
+	/* We only read the pages whose VM bits we are going to check. */
+	visibilitymap_prefetch_init(&prefetch, rel,
+								(all_visible ? VISIBILITYMAP_ALL_VISIBLE : 0) |
+								(all_frozen ? VISIBILITYMAP_ALL_FROZEN : 0),
+								false);
+
 	/* Loop over every block in the relation. */
 	for (blkno = 0; blkno < nblocks; ++blkno)
 	{
@@ -609,6 +623,7 @@ collect_corrupt_items(Oid relid, bool all_visible, bool all_frozen)
 			continue;
 
 		/* Read and lock the page. */
+		visibilitymap_prefetch_before_read(&prefetch, rel, blkno, nblocks);
 		buffer = ReadBufferExtended(rel, MAIN_FORKNUM, blkno, RBM_NORMAL,
 									bstrategy);
 		LockBuffer(buffer, BUFFER_LOCK_SHARE);
@@ -709,6 +724,7 @@ collect_corrupt_items(Oid relid, bool all_visible, bool all_frozen)
 	}
 
 	/* Clean up. */
+	visibilitymap_prefetch_end(&prefetch);
 	if (vmbuffer != InvalidBuffer)
 		ReleaseBuffer(vmbuffer);
 	relation_close(rel, AccessShareLock);
@@ -70,6 +70,7 @@ statapprox_heap(Relation rel, output_type *stat)
 	Buffer		vmbuffer = InvalidBuffer;
 	BufferAccessStrategy bstrategy;
 	TransactionId OldestXmin;
+	VMPrefetchState prefetch;
 
 	OldestXmin = GetOldestNonRemovableTransactionId(rel);
 	bstrategy = GetAccessStrategy(BAS_BULKREAD);
@@ -77,6 +78,10 @@ statapprox_heap(Relation rel, output_type *stat)
 	nblocks = RelationGetNumberOfBlocks(rel);
 	scanned = 0;
 
+	/* We only read the pages that are not all-visible. */
+	visibilitymap_prefetch_init(&prefetch, rel, VISIBILITYMAP_ALL_VISIBLE,
+								true);
+
 	for (blkno = 0; blkno < nblocks; blkno++)
 	{
 		Buffer		buf;
@@ -99,6 +104,7 @@ statapprox_heap(Relation rel, output_type *stat)
 			continue;
 		}
 
+		visibilitymap_prefetch_before_read(&prefetch, rel, blkno, nblocks);
 		buf = ReadBufferExtended(rel, MAIN_FORKNUM, blkno,
 								 RBM_NORMAL, bstrategy);
 
@@ -182,6 +188,8 @@ statapprox_heap(Relation rel, output_type *stat)
 		UnlockReleaseBuffer(buf);
 	}
 
+	visibilitymap_prefetch_end(&prefetch);
+
 	stat->table_len = (uint64) nblocks * BLCKSZ;
 
 	/*
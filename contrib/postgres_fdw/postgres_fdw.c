@@ -341,6 +341,9 @@ static void postgresBeginForeignScan(ForeignScanState *node, int eflags);
 static TupleTableSlot *postgresIterateForeignScan(ForeignScanState *node);
 static void postgresReScanForeignScan(ForeignScanState *node);
 static void postgresEndForeignScan(ForeignScanState *node);
+static bool postgresIsForeignScanParallelSafe(PlannerInfo *root,
+											  RelOptInfo *rel,
+											  RangeTblEntry *rte);
 static void postgresAddForeignUpdateTargets(PlannerInfo *root,
 											Index rtindex,
 											RangeTblEntry *target_rte,
@@ -561,6 +564,7 @@ postgres_fdw_handler(PG_FUNCTION_ARGS)
 	routine->IterateForeignScan = postgresIterateForeignScan;
 	routine->ReScanForeignScan = postgresReScanForeignScan;
 	routine->EndForeignScan = postgresEndForeignScan;
+	routine->IsForeignScanParallelSafe = postgresIsForeignScanParallelSafe;
 
 	/* Functions for updating foreign tables */
 	routine->AddForeignUpdateTargets = postgresAddForeignUpdateTargets;
@@ -1727,6 +1731,55 @@ postgresEndForeignScan(ForeignScanState *node)
 	/* MemoryContexts will be deleted automatically. */
 }
 
+/*
+ * postgresIsForeignScanParallelSafe
+ *		Determine whether a scan of a foreign table may run in a parallel
+ *		worker.
+ *
+ * A worker opens its own connection, and hence its own remote transaction
+ * and snapshot, so the rows it sees need not be consistent with what the
+ * leader or other workers see on the same server.  We therefore only allow
+ * this when the user has said that's acceptable, via the "parallel_safe"
+ * option.  This is called before postgresGetForeignRelSize, so look at the
+ * options directly rather than in fdw_private.
+ */
+static bool
+postgresIsForeignScanParallelSafe(PlannerInfo *root, RelOptInfo *rel,
+								  RangeTblEntry *rte)
+{
+	bool		parallel_safe;
+	ForeignTable *table;
+	ForeignServer *server;
+	ListCell   *lc;
+
+	/*
+	 * By default, scans are not parallel safe. This can be overridden by a
+	 * per-server setting, which in turn can be overridden by a per-table
+	 * setting.
+	 */
+	parallel_safe = false;
+
+	table = GetForeignTable(rte->relid);
+	server = GetForeignServer(table->serverid);
+
+	foreach(lc, server->options)
+	{
+		DefElem    *def = (DefElem *) lfirst(lc);
+
+		if (strcmp(def->defname, "parallel_safe") == 0)
+			parallel_safe = defGetBoolean(def);
+	}
+	foreach(lc, table->options)
+	{
+		DefElem    *def = (DefElem *) lfirst(lc);
+
+		if (strcmp(def->defname, "parallel_safe") == 0)
+			parallel_safe = defGetBoolean(def);
+	}
+
+	return parallel_safe;
+}
+
 /*
  * postgresAddForeignUpdateTargets
  *		Add resjunk column(s) needed for update/delete on a foreign table
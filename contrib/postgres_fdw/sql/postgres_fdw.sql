@@ -161,6 +161,7 @@ CREATE FOREIGN TABLE ft7 (
 ALTER SERVER testserver1 OPTIONS (
 	use_remote_estimate 'false',
 	updatable 'true',
+	parallel_safe 'false',
 	fdw_startup_cost '123.456',
 	fdw_tuple_cost '0.123',
 	service 'value',
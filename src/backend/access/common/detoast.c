@@ -14,20 +14,38 @@
 #include "postgres.h"
 
 #include "access/detoast.h"
+#include "access/heaptoast.h"
 #include "access/table.h"
 #include "access/tableam.h"
 #include "access/toast_internals.h"
 #include "common/int.h"
 #include "common/pg_lzcompress.h"
+#include "optimizer/cost.h"
 #include "utils/expandeddatum.h"
 #include "utils/rel.h"
 
+/*
+ * A toast relation kept open in a ToastPrefetchState, with its indexes.
+ */
+typedef struct ToastPrefetchRel
+{
+	Relation	toastrel;
+	Relation   *toastidxs;
+	int			num_indexes;
+	int			validIndex;
+} ToastPrefetchRel;
+
 static struct varlena *toast_fetch_datum(struct varlena *attr);
 static struct varlena *toast_fetch_datum_slice(struct varlena *attr,
 											   int32 sliceoffset,
 											   int32 slicelength);
 static struct varlena *toast_decompress_datum(struct varlena *attr);
 static struct varlena *toast_decompress_datum_slice(struct varlena *attr, int32 slicelength);
+static void toast_prefetch_datums(ToastPrefetchState *state,
+								  struct varlena **attrs, int nattrs,
+								  Snapshot snapshot, bool heap);
+static ToastPrefetchRel *toast_prefetch_open(ToastPrefetchState *state,
+											 Oid toastrelid);
 
 /* ----------
  * detoast_external_attr -
@@ -249,11 +267,20 @@ detoast_attr_slice(struct varlena *attr,
 			 * At least for now, if it's LZ4 data, we'll have to fetch the
 			 * whole thing, because there doesn't seem to be an API call to
 			 * determine how much compressed data we need to be sure of being
-			 * able to decompress the required slice.
+			 * able to decompress the required slice.  zstd data is stored as
+			 * a sequence of independently compressed frames, which bounds it.
 			 */
-			if (VARATT_EXTERNAL_GET_COMPRESS_METHOD(toast_pointer) ==
-				TOAST_PGLZ_COMPRESSION_ID)
-				max_size = pglz_maximum_compressed_size(slicelimit, max_size);
+			switch (VARATT_EXTERNAL_GET_COMPRESS_METHOD(toast_pointer))
+			{
+				case TOAST_PGLZ_COMPRESSION_ID:
+					max_size = pglz_maximum_compressed_size(slicelimit, max_size);
+					break;
+				case TOAST_ZSTD_COMPRESSION_ID:
+					max_size = zstd_maximum_compressed_size(slicelimit, max_size);
+					break;
+				default:
+					break;
+			}
 
 			/*
 			 * Fetch enough compressed slices (compressed marker will get set
@@ -332,6 +359,147 @@ detoast_attr_slice(struct varlena *attr,
 	return result;
 }
 
+/* ----------
+ * detoast_prefetch_begin -
+ *
+ *	Set up the state for detoast_prefetch_attrs calls.  The toast relations
+ *	they open are kept open, and their descriptors allocated in the current
+ *	memory context, until detoast_prefetch_end.
+ * ----------
+ */
+void
+detoast_prefetch_begin(ToastPrefetchState *state)
+{
+	state->mcxt = CurrentMemoryContext;
+	state->toastrels = NIL;
+}
+
+/* ----------
+ * detoast_prefetch_end -
+ *
+ *	Close the toast relations opened by detoast_prefetch_attrs calls.
+ * ----------
+ */
+void
+detoast_prefetch_end(ToastPrefetchState *state)
+{
+	ListCell   *lc;
+
+	foreach(lc, state->toastrels)
+	{
+		ToastPrefetchRel *rel = (ToastPrefetchRel *) lfirst(lc);
+
+		toast_close_indexes(rel->toastidxs, rel->num_indexes, AccessShareLock);
+		table_close(rel->toastrel, AccessShareLock);
+		pfree(rel);
+	}
+	list_free(state->toastrels);
+	state->toastrels = NIL;
+}
+
+/* ----------
+ * detoast_prefetch_attrs -
+ *
+ *	Prefetch the chunks of the external values among the given attributes,
+ *	which the caller is about to detoast one by one.  Each detoasting first
+ *	reads the toast index page the value starts on, and then the chunks, so
+ *	we first prefetch the index pages of all the values, and then their
+ *	chunks.  Values that are not stored externally on disk are ignored.
+ * ----------
+ */
+void
+detoast_prefetch_attrs(ToastPrefetchState *state, struct varlena **attrs,
+					   int nattrs)
+{
+	int			nexternal = 0;
+	SnapshotData SnapshotToast;
+
+	if (!enable_indexscan_prefetch)
+		return;
+
+	for (int i = 0; i < nattrs; i++)
+	{
+		if (VARATT_IS_EXTERNAL_ONDISK(attrs[i]))
+			nexternal++;
+	}
+
+	/* detoasting a single value prefetches its chunks by itself */
+	if (nexternal < 2)
+		return;
+
+	init_toast_snapshot(&SnapshotToast);
+	toast_prefetch_datums(state, attrs, nattrs, &SnapshotToast, false);
+	toast_prefetch_datums(state, attrs, nattrs, &SnapshotToast, true);
+}
+
+/* ----------
+ * toast_prefetch_datums -
+ *
+ *	Workhorse of detoast_prefetch_attrs: prefetch either the toast index
+ *	pages or the chunks of the external values.  Values of more than one
+ *	chunk are skipped when prefetching chunks, as heap_fetch_toast_slice
+ *	prefetches all their chunks itself; doing it here too would only cost
+ *	another descent of the toast index.
+ * ----------
+ */
+static void
+toast_prefetch_datums(ToastPrefetchState *state, struct varlena **attrs,
+					  int nattrs, Snapshot snapshot, bool heap)
+{
+	for (int i = 0; i < nattrs; i++)
+	{
+		struct varatt_external toast_pointer;
+		int32		attrsize;
+		ToastPrefetchRel *rel;
+
+		if (!VARATT_IS_EXTERNAL_ONDISK(attrs[i]))
+			continue;
+
+		/* Must copy to access aligned fields */
+		VARATT_EXTERNAL_GET_POINTER(toast_pointer, attrs[i]);
+		attrsize = VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer);
+		if (attrsize == 0 || (heap && attrsize > TOAST_MAX_CHUNK_SIZE))
+			continue;
+
+		rel = toast_prefetch_open(state, toast_pointer.va_toastrelid);
+		toast_prefetch_value(rel->toastrel, rel->toastidxs[rel->validIndex],
+							 toast_pointer.va_valueid, attrsize, 0, attrsize,
+							 snapshot, heap);
+	}
+}
+
+/* ----------
+ * toast_prefetch_open -
+ *
+ *	Get the toast relation with the given OID from the state, opening it
+ *	and its indexes if it isn't open yet.
+ * ----------
+ */
+static ToastPrefetchRel *
+toast_prefetch_open(ToastPrefetchState *state, Oid toastrelid)
+{
+	ToastPrefetchRel *rel;
+	MemoryContext oldcxt;
+	ListCell   *lc;
+
+	foreach(lc, state->toastrels)
+	{
+		rel = (ToastPrefetchRel *) lfirst(lc);
+		if (RelationGetRelid(rel->toastrel) == toastrelid)
+			return rel;
+	}
+
+	oldcxt = MemoryContextSwitchTo(state->mcxt);
+	rel = (ToastPrefetchRel *) palloc(sizeof(ToastPrefetchRel));
+	rel->toastrel = table_open(toastrelid, AccessShareLock);
+	rel->validIndex = toast_open_indexes(rel->toastrel, AccessShareLock,
+										 &rel->toastidxs, &rel->num_indexes);
+	state->toastrels = lappend(state->toastrels, rel);
+	MemoryContextSwitchTo(oldcxt);
+
+	return rel;
+}
+
 /* ----------
  * toast_fetch_datum -
  *
@@ -485,6 +653,8 @@ toast_decompress_datum(struct varlena *attr)
 			return pglz_decompress_datum(attr);
 		case TOAST_LZ4_COMPRESSION_ID:
 			return lz4_decompress_datum(attr);
+		case TOAST_ZSTD_COMPRESSION_ID:
+			return zstd_decompress_datum(attr);
 		default:
 			elog(ERROR, "invalid compression method id %d", cmid);
 			return NULL;		/* keep compiler quiet */
@@ -528,6 +698,8 @@ toast_decompress_datum_slice(struct varlena *attr, int32 slicelength)
 			return pglz_decompress_datum_slice(attr, slicelength);
 		case TOAST_LZ4_COMPRESSION_ID:
 			return lz4_decompress_datum_slice(attr, slicelength);
+		case TOAST_ZSTD_COMPRESSION_ID:
+			return zstd_decompress_datum_slice(attr, slicelength);
 		default:
 			elog(ERROR, "invalid compression method id %d", cmid);
 			return NULL;		/* keep compiler quiet */
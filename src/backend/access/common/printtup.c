@@ -15,13 +15,19 @@
  */
 #include "postgres.h"
 
+#include "access/detoast.h"
 #include "access/printtup.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
 #include "tcop/pquery.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/memdebug.h"
 #include "utils/memutils.h"
+#include "utils/timestamp.h"
+#include "utils/uuid.h"
 
 
 static void printtup_startup(DestReceiver *self, int operation,
@@ -39,7 +45,9 @@ static void printtup_destroy(DestReceiver *self);
  *		Private state for a printtup destination object
  *
  * NOTE: finfo is the lookup info for either typoutput or typsend, whichever
- * we are using for this column.
+ * we are using for this column.  If that function is one of the built-in
+ * ones that printtup_fast_attr() knows how to emulate, fastfn is its Oid and
+ * the column is serialized inline, without a function call or palloc.
  * ----------------
  */
 typedef struct
@@ -48,6 +56,7 @@ typedef struct
 	Oid			typsend;		/* Oid for the type's binary output fn */
 	bool		typisvarlena;	/* is it varlena (ie possibly toastable)? */
 	int16		format;			/* format code for this column */
+	Oid			fastfn;			/* output fn handled inline, or InvalidOid */
 	FmgrInfo	finfo;			/* Precomputed call info for output fn */
 } PrinttupAttrInfo;
 
@@ -61,6 +70,8 @@ typedef struct
 	PrinttupAttrInfo *myinfo;	/* Cached info about each attr */
 	StringInfoData buf;			/* output buffer (*not* in tmpcontext) */
 	MemoryContext tmpcontext;	/* Memory context for per-row workspace */
+	struct varlena **varlenas;	/* per-row workspace for toast prefetching */
+	ToastPrefetchState toast_prefetch;	/* toast relations opened for it */
 } DR_printtup;
 
 /* ----------------
@@ -89,6 +100,7 @@ printtup_create_DR(CommandDest dest)
 	self->myinfo = NULL;
 	self->buf.data = NULL;
 	self->tmpcontext = NULL;
+	self->varlenas = NULL;
 
 	return (DestReceiver *) self;
 }
@@ -129,6 +141,9 @@ printtup_startup(DestReceiver *self, int operation, TupleDesc typeinfo)
 												"printtup",
 												ALLOCSET_DEFAULT_SIZES);
 
+	/* Toast relations are opened once, on first use, for all rows */
+	detoast_prefetch_begin(&myState->toast_prefetch);
+
 	/*
 	 * If we are supposed to emit row descriptions, then send the tuple
 	 * descriptor of the tuples.
@@ -243,6 +258,103 @@ SendRowDescriptionMessage(StringInfo buf, TupleDesc typeinfo,
 	pq_endmessage_reuse(buf);
 }
 
+/*
+ * Can printtup_fast_attr() serialize the output of this function inline?
+ */
+static bool
+printtup_has_fast_path(Oid outfn)
+{
+	switch (outfn)
+	{
+		case F_INT2OUT:
+		case F_INT4OUT:
+		case F_INT8OUT:
+		case F_BOOLSEND:
+		case F_INT2SEND:
+		case F_INT4SEND:
+		case F_INT8SEND:
+		case F_FLOAT8SEND:
+		case F_DATE_SEND:
+		case F_TIMESTAMP_SEND:
+		case F_TIMESTAMPTZ_SEND:
+		case F_UUID_SEND:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Append one non-null attribute to a DataRow message, producing the same
+ * bytes that calling the output or send function "outfn" would.
+ *
+ * The integer text forms are pure ASCII, which every client encoding
+ * represents identically, so no encoding conversion is needed.
+ */
+static void
+printtup_fast_attr(StringInfo buf, Oid outfn, Datum attr)
+{
+	char		str[MAXINT8LEN + 1];
+	int			len;
+
+	switch (outfn)
+	{
+		case F_INT2OUT:
+			len = pg_itoa(DatumGetInt16(attr), str);
+			pq_sendint32(buf, len);
+			pq_sendbytes(buf, str, len);
+			break;
+		case F_INT4OUT:
+			len = pg_ltoa(DatumGetInt32(attr), str);
+			pq_sendint32(buf, len);
+			pq_sendbytes(buf, str, len);
+			break;
+		case F_INT8OUT:
+			len = pg_lltoa(DatumGetInt64(attr), str);
+			pq_sendint32(buf, len);
+			pq_sendbytes(buf, str, len);
+			break;
+		case F_BOOLSEND:
+			pq_sendint32(buf, 1);
+			pq_sendbyte(buf, DatumGetBool(attr) ? 1 : 0);
+			break;
+		case F_INT2SEND:
+			pq_sendint32(buf, sizeof(int16));
+			pq_sendint16(buf, DatumGetInt16(attr));
+			break;
+		case F_INT4SEND:
+			pq_sendint32(buf, sizeof(int32));
+			pq_sendint32(buf, DatumGetInt32(attr));
+			break;
+		case F_INT8SEND:
+			pq_sendint32(buf, sizeof(int64));
+			pq_sendint64(buf, DatumGetInt64(attr));
+			break;
+		case F_FLOAT8SEND:
+			pq_sendint32(buf, sizeof(float8));
+			pq_sendfloat8(buf, DatumGetFloat8(attr));
+			break;
+		case F_DATE_SEND:
+			pq_sendint32(buf, sizeof(DateADT));
+			pq_sendint32(buf, DatumGetDateADT(attr));
+			break;
+		case F_TIMESTAMP_SEND:
+			pq_sendint32(buf, sizeof(Timestamp));
+			pq_sendint64(buf, DatumGetTimestamp(attr));
+			break;
+		case F_TIMESTAMPTZ_SEND:
+			pq_sendint32(buf, sizeof(TimestampTz));
+			pq_sendint64(buf, DatumGetTimestampTz(attr));
+			break;
+		case F_UUID_SEND:
+			pq_sendint32(buf, UUID_LEN);
+			pq_sendbytes(buf, (char *) DatumGetUUIDP(attr)->data, UUID_LEN);
+			break;
+		default:
+			elog(ERROR, "no fast path for output function %u", outfn);
+	}
+}
+
 /*
  * Get the lookup info that printtup() needs
  */
@@ -256,6 +368,9 @@ printtup_prepare_info(DR_printtup *myState, TupleDesc typeinfo, int numAttrs)
 	if (myState->myinfo)
 		pfree(myState->myinfo);
 	myState->myinfo = NULL;
+	if (myState->varlenas)
+		pfree(myState->varlenas);
+	myState->varlenas = NULL;
 
 	myState->attrinfo = typeinfo;
 	myState->nattrs = numAttrs;
@@ -264,6 +379,8 @@ printtup_prepare_info(DR_printtup *myState, TupleDesc typeinfo, int numAttrs)
 
 	myState->myinfo = (PrinttupAttrInfo *)
 		palloc0(numAttrs * sizeof(PrinttupAttrInfo));
+	myState->varlenas = (struct varlena **)
+		palloc(numAttrs * sizeof(struct varlena *));
 
 	for (i = 0; i < numAttrs; i++)
 	{
@@ -278,6 +395,8 @@ printtup_prepare_info(DR_printtup *myState, TupleDesc typeinfo, int numAttrs)
 							  &thisState->typoutput,
 							  &thisState->typisvarlena);
 			fmgr_info(thisState->typoutput, &thisState->finfo);
+			if (printtup_has_fast_path(thisState->typoutput))
+				thisState->fastfn = thisState->typoutput;
 		}
 		else if (format == 1)
 		{
@@ -285,6 +404,8 @@ printtup_prepare_info(DR_printtup *myState, TupleDesc typeinfo, int numAttrs)
 									&thisState->typsend,
 									&thisState->typisvarlena);
 			fmgr_info(thisState->typsend, &thisState->finfo);
+			if (printtup_has_fast_path(thisState->typsend))
+				thisState->fastfn = thisState->typsend;
 		}
 		else
 			ereport(ERROR,
@@ -324,6 +445,24 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 
 	pq_sendint16(buf, natts);
 
+	/*
+	 * The output functions will detoast the attributes one by one, so let
+	 * the chunks of all of them be fetched at once.
+	 */
+	if (natts > 1)
+	{
+		int			nvarlenas = 0;
+
+		for (i = 0; i < natts; ++i)
+		{
+			if (!slot->tts_isnull[i] && myState->myinfo[i].typisvarlena)
+				myState->varlenas[nvarlenas++] = (struct varlena *)
+					DatumGetPointer(slot->tts_values[i]);
+		}
+		detoast_prefetch_attrs(&myState->toast_prefetch, myState->varlenas,
+							   nvarlenas);
+	}
+
 	/*
 	 * send the attributes of this tuple
 	 */
@@ -349,7 +488,12 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 			VALGRIND_CHECK_MEM_IS_DEFINED(DatumGetPointer(attr),
 										  VARSIZE_ANY(attr));
 
-		if (thisState->format == 0)
+		if (OidIsValid(thisState->fastfn))
+		{
+			/* Common built-in type, serialized without calling fmgr */
+			printtup_fast_attr(buf, thisState->fastfn, attr);
+		}
+		else if (thisState->format == 0)
 		{
 			/* Text output */
 			char	   *outputstr;
@@ -391,8 +535,14 @@ printtup_shutdown(DestReceiver *self)
 		pfree(myState->myinfo);
 	myState->myinfo = NULL;
 
+	if (myState->varlenas)
+		pfree(myState->varlenas);
+	myState->varlenas = NULL;
+
 	myState->attrinfo = NULL;
 
+	detoast_prefetch_end(&myState->toast_prefetch);
+
 	if (myState->buf.data)
 		pfree(myState->buf.data);
 	myState->buf.data = NULL;
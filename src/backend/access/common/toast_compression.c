@@ -17,6 +17,10 @@
 #include <lz4.h>
 #endif
 
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
 #include "access/detoast.h"
 #include "access/toast_compression.h"
 #include "common/pg_lzcompress.h"
@@ -32,6 +36,19 @@ int			default_toast_compression = TOAST_PGLZ_COMPRESSION;
 			 errmsg("compression method lz4 not supported"), \
 			 errdetail("This functionality requires the server to be built with lz4 support.")))
 
+#define NO_ZSTD_SUPPORT() \
+	ereport(ERROR, \
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED), \
+			 errmsg("compression method zstd not supported"), \
+			 errdetail("This functionality requires the server to be built with zstd support.")))
+
+/*
+ * Amount of raw data compressed into each zstd frame.  Changing this doesn't
+ * affect the readability of existing data, only how well the slice fetching
+ * in detoast.c works for it.
+ */
+#define TOAST_ZSTD_FRAME_SIZE	(64 * 1024)
+
 /*
  * Compress a varlena using PGLZ.
  *
@@ -246,6 +263,210 @@ lz4_decompress_datum_slice(const struct varlena *value, int32 slicelength)
 #endif
 }
 
+/*
+ * Compress a varlena using zstd.
+ *
+ * The value is split into pieces of TOAST_ZSTD_FRAME_SIZE bytes, and each
+ * piece becomes an independent zstd frame.  A sequence of frames is itself
+ * valid zstd data, so decompression doesn't need to know about this, but it
+ * puts an upper bound on how much compressed data must be read to decode a
+ * prefix of the value; see zstd_maximum_compressed_size().
+ *
+ * Returns the compressed varlena, or NULL if compression fails.
+ */
+struct varlena *
+zstd_compress_datum(const struct varlena *value)
+{
+#ifndef USE_ZSTD
+	NO_ZSTD_SUPPORT();
+	return NULL;				/* keep compiler quiet */
+#else
+	int32		valsize;
+	const char *src;
+	char	   *dst;
+	size_t		len = 0;
+	int32		offset;
+	ZSTD_CCtx  *cctx;
+	struct varlena *tmp = NULL;
+
+	valsize = VARSIZE_ANY_EXHDR(value);
+	src = VARDATA_ANY(value);
+
+	/*
+	 * There's no point in storing output that is larger than the input, so
+	 * only allocate that much, plus the bytes that will be needed for varlena
+	 * overhead.
+	 */
+	tmp = (struct varlena *) palloc(valsize + VARHDRSZ_COMPRESSED);
+	dst = (char *) tmp + VARHDRSZ_COMPRESSED;
+
+	cctx = ZSTD_createCCtx();
+	if (cctx == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory")));
+
+	for (offset = 0; offset < valsize; offset += TOAST_ZSTD_FRAME_SIZE)
+	{
+		size_t		srclen = Min(valsize - offset, TOAST_ZSTD_FRAME_SIZE);
+		size_t		capacity = valsize - len;
+		size_t		ret;
+
+		ret = ZSTD_compressCCtx(cctx, dst + len, capacity,
+								src + offset, srclen,
+								ZSTD_CLEVEL_DEFAULT);
+		if (ZSTD_isError(ret))
+		{
+			ZSTD_freeCCtx(cctx);
+
+			/*
+			 * Running out of room means the data is incompressible, so just
+			 * free the memory and return NULL.
+			 */
+			if (capacity < ZSTD_compressBound(srclen))
+			{
+				pfree(tmp);
+				return NULL;
+			}
+			elog(ERROR, "zstd compression failed: %s", ZSTD_getErrorName(ret));
+		}
+		len += ret;
+	}
+
+	ZSTD_freeCCtx(cctx);
+
+	SET_VARSIZE_COMPRESSED(tmp, len + VARHDRSZ_COMPRESSED);
+
+	return tmp;
+#endif
+}
+
+/*
+ * Calculate the maximum amount of stored zstd data that is needed to decode
+ * the first rawsize bytes of a value.  Return the maximum size, or total
+ * compressed size if maximum size is larger than total compressed size.
+ *
+ * Every frame holds TOAST_ZSTD_FRAME_SIZE bytes of the original value (save
+ * for the last one), and no frame is larger than the compression bound for
+ * that much input, so it's enough to read that many bytes for each frame
+ * that the prefix touches.  The result also covers the compression header
+ * that precedes the frames in the stored data.
+ */
+int32
+zstd_maximum_compressed_size(int32 rawsize, int32 total_compressed_size)
+{
+#ifndef USE_ZSTD
+	return total_compressed_size;
+#else
+	int64		nframes;
+	int64		compressed_size;
+
+	/* Use int64 here to prevent overflow during calculation. */
+	nframes = ((int64) rawsize + TOAST_ZSTD_FRAME_SIZE - 1) / TOAST_ZSTD_FRAME_SIZE;
+	compressed_size = nframes * ZSTD_COMPRESSBOUND(TOAST_ZSTD_FRAME_SIZE) +
+		(VARHDRSZ_COMPRESSED - VARHDRSZ);
+
+	/*
+	 * Maximum compressed size can't be larger than total compressed size.
+	 * (This also ensures that our result fits in int32.)
+	 */
+	compressed_size = Min(compressed_size, total_compressed_size);
+
+	return (int32) compressed_size;
+#endif
+}
+
+/*
+ * Decompress a varlena that was compressed using zstd.
+ */
+struct varlena *
+zstd_decompress_datum(const struct varlena *value)
+{
+#ifndef USE_ZSTD
+	NO_ZSTD_SUPPORT();
+	return NULL;				/* keep compiler quiet */
+#else
+	size_t		rawsize;
+	struct varlena *result;
+
+	/* allocate memory for the uncompressed data */
+	result = (struct varlena *) palloc(VARDATA_COMPRESSED_GET_EXTSIZE(value) + VARHDRSZ);
+
+	/* decompress the data */
+	rawsize = ZSTD_decompress(VARDATA(result),
+							  VARDATA_COMPRESSED_GET_EXTSIZE(value),
+							  (char *) value + VARHDRSZ_COMPRESSED,
+							  VARSIZE(value) - VARHDRSZ_COMPRESSED);
+	if (ZSTD_isError(rawsize))
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("compressed zstd data is corrupt")));
+
+	SET_VARSIZE(result, rawsize + VARHDRSZ);
+
+	return result;
+#endif
+}
+
+/*
+ * Decompress part of a varlena that was compressed using zstd.
+ *
+ * The streaming decoder stops as soon as the output buffer is full, so only
+ * as much of the data as is needed for the slice gets decompressed.  The
+ * caller may have fetched only a prefix of the compressed data, as allowed
+ * by zstd_maximum_compressed_size().
+ */
+struct varlena *
+zstd_decompress_datum_slice(const struct varlena *value, int32 slicelength)
+{
+#ifndef USE_ZSTD
+	NO_ZSTD_SUPPORT();
+	return NULL;				/* keep compiler quiet */
+#else
+	struct varlena *result;
+	ZSTD_DCtx  *dctx;
+	ZSTD_inBuffer input;
+	ZSTD_outBuffer output;
+
+	dctx = ZSTD_createDCtx();
+	if (dctx == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory")));
+
+	/* allocate memory for the uncompressed data */
+	result = (struct varlena *) palloc(slicelength + VARHDRSZ);
+
+	input.src = (char *) value + VARHDRSZ_COMPRESSED;
+	input.size = VARSIZE(value) - VARHDRSZ_COMPRESSED;
+	input.pos = 0;
+	output.dst = VARDATA(result);
+	output.size = slicelength;
+	output.pos = 0;
+
+	/* decompress the data */
+	while (output.pos < output.size && input.pos < input.size)
+	{
+		size_t		ret;
+
+		ret = ZSTD_decompressStream(dctx, &output, &input);
+		if (ZSTD_isError(ret))
+		{
+			ZSTD_freeDCtx(dctx);
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg_internal("compressed zstd data is corrupt")));
+		}
+	}
+
+	ZSTD_freeDCtx(dctx);
+
+	SET_VARSIZE(result, output.pos + VARHDRSZ);
+
+	return result;
+#endif
+}
+
 /*
  * Extract compression ID from a varlena.
  *
@@ -294,6 +515,13 @@ CompressionNameToMethod(const char *compression)
 #endif
 		return TOAST_LZ4_COMPRESSION;
 	}
+	else if (strcmp(compression, "zstd") == 0)
+	{
+#ifndef USE_ZSTD
+		NO_ZSTD_SUPPORT();
+#endif
+		return TOAST_ZSTD_COMPRESSION;
+	}
 
 	return InvalidCompressionMethod;
 }
@@ -310,6 +538,8 @@ GetCompressionMethodName(char method)
 			return "pglz";
 		case TOAST_LZ4_COMPRESSION:
 			return "lz4";
+		case TOAST_ZSTD_COMPRESSION:
+			return "zstd";
 		default:
 			elog(ERROR, "invalid compression method %c", method);
 			return NULL;		/* keep compiler quiet */
@@ -72,6 +72,10 @@ toast_compress_datum(Datum value, char cmethod)
 			tmp = lz4_compress_datum((const struct varlena *) value);
 			cmid = TOAST_LZ4_COMPRESSION_ID;
 			break;
+		case TOAST_ZSTD_COMPRESSION:
+			tmp = zstd_compress_datum((const struct varlena *) value);
+			cmid = TOAST_ZSTD_COMPRESSION_ID;
+			break;
 		default:
 			elog(ERROR, "invalid compression method %c", cmethod);
 	}
@@ -614,6 +618,57 @@ toast_open_indexes(Relation toastrel,
 	return res;
 }
 
+/* ----------
+ * toast_prefetch_value
+ *
+ *	Prefetch the chunks holding the given slice of a toast value of size
+ *	attrsize, to be fetched with the given index of the toast relation.  If heap is false, only the
+ *	index page the lookup of the value will start on is prefetched, without
+ *	waiting for it; a caller fetching several values can prefetch all their
+ *	index pages first, and then the chunks, which needs those index pages.
+ *
+ *	This is merely a hint, see index_prefetch.  The heap pages of a slice
+ *	that doesn't start at the first chunk aren't prefetched, since the
+ *	index can't be searched for such a range without also prefetching the
+ *	chunks before it.
+ */
+void
+toast_prefetch_value(Relation toastrel, Relation toastidx, Oid valueid,
+					 int32 attrsize, int32 sliceoffset, int32 slicelength,
+					 Snapshot snapshot, bool heap)
+{
+	ScanKeyData toastkey[2];
+	int			nscankeys = 1;
+	int			nheappages = 0;
+	int32		startchunk = sliceoffset / TOAST_MAX_CHUNK_SIZE;
+	int32		endchunk = (sliceoffset + slicelength - 1) / TOAST_MAX_CHUNK_SIZE;
+
+	if (attrsize == 0 || slicelength <= 0)
+		return;
+
+	ScanKeyInit(&toastkey[0],
+				(AttrNumber) 1,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(valueid));
+
+	if (startchunk == endchunk && startchunk > 0)
+	{
+		ScanKeyInit(&toastkey[1],
+					(AttrNumber) 2,
+					BTEqualStrategyNumber, F_INT4EQ,
+					Int32GetDatum(startchunk));
+		nscankeys = 2;
+	}
+
+	if (heap && (startchunk == 0 || startchunk == endchunk))
+		nheappages = endchunk - startchunk + 1;
+	else if (heap)
+		return;
+
+	index_prefetch(toastidx, toastrel, toastkey, nscankeys, snapshot,
+				   nheappages);
+}
+
 /* ----------
  * toast_close_indexes
  *
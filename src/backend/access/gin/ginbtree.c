@@ -19,10 +19,12 @@
 #include "access/xloginsert.h"
 #include "miscadmin.h"
 #include "storage/predicate.h"
+#include "storage/prefetch.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
 
 static void ginFindParents(GinBtree btree, GinBtreeStack *stack);
+static void ginQueueDownlinks(GinBtree btree, GinBtreeStack *stack);
 static bool ginPlaceToPage(GinBtree btree, GinBtreeStack *stack,
 						   void *insertdata, BlockNumber updateblkno,
 						   Buffer childbuf, GinStatsData *buildStats);
@@ -139,6 +141,9 @@ ginFindLeafPage(GinBtree btree, bool searchMode,
 		/* now we have correct buffer, try to find child */
 		child = btree->findChildPage(btree, stack);
 
+		if (searchMode && btree->leafPrefetch)
+			ginQueueDownlinks(btree, stack);
+
 		LockBuffer(stack->buffer, GIN_UNLOCK);
 		Assert(child != InvalidBlockNumber);
 		Assert(stack->blkno != child);
@@ -162,6 +167,37 @@ ginFindLeafPage(GinBtree btree, bool searchMode,
 	}
 }
 
+/*
+ * Neon: queue the child chosen on the locked internal posting tree page
+ * stack->buffer, and the children to the right of it, for prefetching.
+ *
+ * Each level of the descent replaces what the level above it queued, so in
+ * the end the queue holds the leaf level.  Collecting the downlinks on the
+ * way down means we never lock the parent again while holding a lock on the
+ * leaf, which would lock pages bottom-up and could deadlock with VACUUM
+ * (see ginScanToDelete).
+ */
+static void
+ginQueueDownlinks(GinBtree btree, GinBtreeStack *stack)
+{
+	Page		page = BufferGetPage(stack->buffer);
+	OffsetNumber maxoff = GinPageGetOpaque(page)->maxoff;
+	OffsetNumber i;
+
+	Assert(btree->isData && !GinPageIsLeaf(page));
+
+	PrefetchQueueReset(btree->leafPrefetch);
+	for (i = stack->off; i <= maxoff; i++)
+	{
+		PostingItem *pitem = GinDataPageGetPostingItem(page, i);
+
+		PrefetchQueueAdd(btree->leafPrefetch, PostingItemGetBlockNumber(pitem));
+	}
+
+	btree->leafPrefetchNext = GinPageRightMost(page) ? InvalidBlockNumber :
+		GinPageGetOpaque(page)->rightlink;
+}
+
 /*
  * Step right from current page.
  *
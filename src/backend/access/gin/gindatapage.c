@@ -1928,13 +1928,14 @@ ginInsertItemPointers(Relation index, BlockNumber rootBlkno,
  */
 GinBtreeStack *
 ginScanBeginPostingTree(GinBtree btree, Relation index, BlockNumber rootBlkno,
-						Snapshot snapshot)
+						Snapshot snapshot, struct PrefetchQueue *leafPrefetch)
 {
 	GinBtreeStack *stack;
 
 	ginPrepareDataScan(btree, index, rootBlkno);
 
 	btree->fullScan = true;
+	btree->leafPrefetch = leafPrefetch;
 
 	stack = ginFindLeafPage(btree, true, false, snapshot);
 
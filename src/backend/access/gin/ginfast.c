@@ -19,6 +19,7 @@
 #include "postgres.h"
 
 #include "access/gin_private.h"
+#include "access/relation.h"
 #include "access/ginxlog.h"
 #include "access/xlog.h"
 #include "access/xloginsert.h"
@@ -41,6 +42,12 @@ int			gin_pending_list_limit = 0;
 #define GIN_PAGE_FREESIZE \
 	( BLCKSZ - MAXALIGN(SizeOfPageHeaderData) - MAXALIGN(sizeof(GinPageOpaqueData)) )
 
+/*
+ * Once the pending list is this many times larger than its cleanup size, an
+ * insertion cleans it up itself even if autovacuum has been asked to.
+ */
+#define GIN_PENDING_LIST_FORCE_MULTIPLE 4
+
 typedef struct KeyArray
 {
 	Datum	   *keys;			/* expansible array */
@@ -214,9 +221,15 @@ makeSublist(Relation index, IndexTuple *tuples, int32 ntuples,
  *
  * Function guarantees that all these tuples will be inserted consecutively,
  * preserving order
+ *
+ * If the pending list grows too large and autovacuum is enabled for heapRel,
+ * the cleanup is left to an autovacuum worker, so that the insert doesn't
+ * have to wait for it, unless the list is GIN_PENDING_LIST_FORCE_MULTIPLE
+ * times over its limit.
  */
 void
-ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
+ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector,
+					   Relation heapRel)
 {
 	Relation	index = ginstate->index;
 	Buffer		metabuffer;
@@ -227,6 +240,8 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 	ginxlogUpdateMeta data;
 	bool		separateList = false;
 	bool		needCleanup = false;
+	bool		forceCleanup = false;
+	BlockNumber pendingHead;
 	int			cleanupSize;
 	bool		needWal;
 
@@ -457,17 +472,60 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 	cleanupSize = GinGetPendingListCleanupSize(index);
 	if (metadata->nPendingPages * GIN_PAGE_FREESIZE > cleanupSize * 1024L)
 		needCleanup = true;
+	if (metadata->nPendingPages * GIN_PAGE_FREESIZE >
+		GIN_PENDING_LIST_FORCE_MULTIPLE * cleanupSize * 1024L)
+		forceCleanup = true;
+	pendingHead = metadata->head;
 
 	UnlockReleaseBuffer(metabuffer);
 
 	END_CRIT_SECTION();
 
+	if (!needCleanup)
+		return;
+
+	/*
+	 * Ask autovacuum to clean up the pending list, if it will process the
+	 * table.  It cleans up the whole list in one sorted merge, with
+	 * autovacuum_work_mem to collect the entries in.  We clean up ourselves
+	 * if the request can't be recorded, or if the list has grown so large
+	 * that the worker is evidently not keeping up.
+	 *
+	 * Every insert finds the list too long until the worker gets to it, and
+	 * recording a request takes AutovacuumLock.  So we remember in the
+	 * relcache entry's rd_amcache, which GIN doesn't otherwise use, the head
+	 * of the pending list when we last asked, and don't ask again while the
+	 * head is unchanged: the worker hasn't started on the list yet.
+	 */
+	if (!forceCleanup &&
+		AutoVacuumingActive() &&
+		(heapRel->rd_options == NULL ||
+		 ((StdRdOptions *) heapRel->rd_options)->autovacuum.enabled))
+	{
+		BlockNumber *requestedHead = (BlockNumber *) index->rd_amcache;
+
+		if (requestedHead != NULL && *requestedHead == pendingHead)
+			return;
+
+		if (AutoVacuumRequestWork(AVW_GINCleanupPendingList,
+								  RelationGetRelid(index), InvalidBlockNumber))
+		{
+			if (requestedHead == NULL)
+			{
+				requestedHead = MemoryContextAlloc(index->rd_indexcxt,
+												   sizeof(BlockNumber));
+				index->rd_amcache = requestedHead;
+			}
+			*requestedHead = pendingHead;
+			return;
+		}
+	}
+
 	/*
 	 * Since it could contend with concurrent cleanup process we cleanup
 	 * pending list not forcibly.
 	 */
-	if (needCleanup)
-		ginInsertCleanup(ginstate, false, true, false, NULL);
+	ginInsertCleanup(ginstate, false, true, false, NULL);
 }
 
 /*
@@ -1033,7 +1091,7 @@ Datum
 gin_clean_pending_list(PG_FUNCTION_ARGS)
 {
 	Oid			indexoid = PG_GETARG_OID(0);
-	Relation	indexRel = index_open(indexoid, RowExclusiveLock);
+	Relation	indexRel;
 	IndexBulkDeleteResult stats;
 	GinState	ginstate;
 
@@ -1043,6 +1101,14 @@ gin_clean_pending_list(PG_FUNCTION_ARGS)
 				 errmsg("recovery is in progress"),
 				 errhint("GIN pending list cannot be cleaned up during recovery.")));
 
+	/*
+	 * Autovacuum calls us for work items that may have been requested before
+	 * the index was dropped, in which case there is nothing to do.
+	 */
+	indexRel = try_relation_open(indexoid, RowExclusiveLock);
+	if (indexRel == NULL)
+		PG_RETURN_INT64(0);
+
 	/* Must be a GIN index */
 	if (indexRel->rd_rel->relkind != RELKIND_INDEX ||
 		indexRel->rd_rel->relam != GIN_AM_OID)
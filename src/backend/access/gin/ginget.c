@@ -14,11 +14,13 @@
 
 #include "postgres.h"
 
+#include "access/genam.h"
 #include "access/gin_private.h"
 #include "access/relscan.h"
 #include "common/pg_prng.h"
 #include "miscadmin.h"
 #include "storage/predicate.h"
+#include "storage/prefetch.h"
 #include "utils/datum.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
@@ -61,6 +63,76 @@ moveRightIfItNeeded(GinBtreeData *btree, GinBtreeStack *stack, Snapshot snapshot
 	return true;
 }
 
+/*
+ * Queue more posting tree leaf pages to prefetch, and prefetch them.
+ *
+ * The descent to the first leaf queued the children of its parent (see
+ * ginFindLeafPage).  When those run short of the prefetch distance, the
+ * children of the following internal pages on the same level are queued,
+ * starting with *parent.  *parent is advanced to the next internal page, or
+ * set to InvalidBlockNumber when there are no more.
+ *
+ * 'leaf' is the share-locked leaf page the scan is on.  It must have been
+ * processed already, because its lock is released while an internal page is
+ * read: VACUUM locks posting tree pages top-down, so we must not lock a
+ * parent while holding a lock on its child.  The caller only uses the leaf's
+ * right link afterwards, which is still valid if the page was split in the
+ * meantime; the caller's pin keeps it from being deleted.
+ */
+static void
+ginPrefetchLeaves(Relation index, PrefetchQueue *prefetch, BlockNumber *parent,
+				  Buffer leaf)
+{
+	bool		unlocked = false;
+
+	while (BlockNumberIsValid(*parent) &&
+		   PrefetchQueueLength(prefetch) <= PrefetchControlTarget(&prefetch->ctl))
+	{
+		Buffer		buffer;
+		Page		page;
+
+		if (!unlocked)
+		{
+			LockBuffer(leaf, GIN_UNLOCK);
+			unlocked = true;
+		}
+
+		buffer = ReadBuffer(index, *parent);
+
+		LockBuffer(buffer, GIN_SHARE);
+		page = BufferGetPage(buffer);
+
+		if (GinPageIsDeleted(page) || GinPageIsLeaf(page) ||
+			!GinPageIsData(page))
+		{
+			/* concurrently deleted or recycled, give up on prefetching */
+			*parent = InvalidBlockNumber;
+		}
+		else
+		{
+			OffsetNumber maxoff = GinPageGetOpaque(page)->maxoff;
+			OffsetNumber i;
+
+			for (i = FirstOffsetNumber; i <= maxoff; i++)
+			{
+				PostingItem *pitem = GinDataPageGetPostingItem(page, i);
+
+				PrefetchQueueAdd(prefetch, PostingItemGetBlockNumber(pitem));
+			}
+
+			*parent = GinPageRightMost(page) ? InvalidBlockNumber :
+				GinPageGetOpaque(page)->rightlink;
+		}
+
+		UnlockReleaseBuffer(buffer);
+	}
+
+	if (unlocked)
+		LockBuffer(leaf, GIN_SHARE);
+
+	PrefetchQueueIssue(prefetch);
+}
+
 /*
  * Scan all pages of a posting tree and save all its heap ItemPointers
  * in scanEntry->matchBitmap
@@ -73,13 +145,40 @@ scanPostingTree(Relation index, GinScanEntry scanEntry,
 	GinBtreeStack *stack;
 	Buffer		buffer;
 	Page		page;
+	PrefetchQueue *prefetch = NULL;
+	BlockNumber parent = InvalidBlockNumber;
+	int			prefetch_maximum;
 
-	/* Descend to the leftmost leaf page */
-	stack = ginScanBeginPostingTree(&btree, index, rootPostingTree, snapshot);
+	/*
+	 * All the leaf pages are going to be read, so prefetch them at the full
+	 * distance right away.
+	 */
+	prefetch_maximum = index_prefetch_maximum(index);
+	if (prefetch_maximum > 0)
+	{
+		prefetch = palloc(sizeof(PrefetchQueue));
+		PrefetchQueueInit(prefetch, index, prefetch_maximum, prefetch_maximum);
+	}
+
+	/* Descend to the leftmost leaf page, queueing it and its siblings */
+	stack = ginScanBeginPostingTree(&btree, index, rootPostingTree, snapshot,
+									prefetch);
 	buffer = stack->buffer;
 
 	IncrBufferRefCount(buffer); /* prevent unpin in freeGinBtreeStack */
 
+	if (prefetch && PrefetchQueueLength(prefetch) == 0)
+	{
+		/* the root is the only leaf, nothing to prefetch */
+		pfree(prefetch);
+		prefetch = NULL;
+	}
+	else if (prefetch)
+	{
+		parent = btree.leafPrefetchNext;
+		PrefetchQueueIssue(prefetch);
+	}
+
 	freeGinBtreeStack(stack);
 
 	/*
@@ -98,10 +197,19 @@ scanPostingTree(Relation index, GinScanEntry scanEntry,
 		if (GinPageRightMost(page))
 			break;				/* no more pages */
 
+		if (prefetch)
+		{
+			PrefetchQueueConsume(prefetch);
+			ginPrefetchLeaves(index, prefetch, &parent, buffer);
+		}
+
 		buffer = ginStepRight(buffer, index, GIN_SHARE);
 	}
 
 	UnlockReleaseBuffer(buffer);
+
+	if (prefetch)
+		pfree(prefetch);
 }
 
 /*
@@ -401,6 +509,7 @@ restartScanEntry:
 			GinBtreeStack *stack;
 			Page		page;
 			ItemPointerData minItem;
+			int			prefetch_maximum;
 
 			/*
 			 * This is an equality scan, so lock the root of the posting tree.
@@ -419,8 +528,30 @@ restartScanEntry:
 			LockBuffer(stackEntry->buffer, GIN_UNLOCK);
 			needUnlock = false;
 
+			/*
+			 * The scan may stop early or skip over most of the leaf pages, so
+			 * prefetch the leaves following the first one at a short
+			 * distance.  The descent queues them.
+			 */
+			prefetch_maximum = index_prefetch_maximum(ginstate->index);
+			if (prefetch_maximum > 0)
+			{
+				if (entry->leafPrefetch == NULL)
+					entry->leafPrefetch =
+						MemoryContextAlloc(GetMemoryChunkContext(entry),
+										   sizeof(PrefetchQueue));
+				PrefetchQueueInit(entry->leafPrefetch, ginstate->index,
+								  prefetch_maximum, 1);
+			}
+			else if (entry->leafPrefetch)
+			{
+				pfree(entry->leafPrefetch);
+				entry->leafPrefetch = NULL;
+			}
+
 			stack = ginScanBeginPostingTree(&entry->btree, ginstate->index,
-											rootPostingTree, snapshot);
+											rootPostingTree, snapshot,
+											entry->leafPrefetch);
 			entry->buffer = stack->buffer;
 
 			/*
@@ -441,6 +572,19 @@ restartScanEntry:
 			entry->predictNumberResult = stack->predictNumber * entry->nlist;
 
 			LockBuffer(entry->buffer, GIN_UNLOCK);
+
+			if (entry->leafPrefetch &&
+				PrefetchQueueLength(entry->leafPrefetch) == 0)
+			{
+				/* the root is the only leaf, nothing to prefetch */
+				pfree(entry->leafPrefetch);
+				entry->leafPrefetch = NULL;
+			}
+			else if (entry->leafPrefetch)
+			{
+				entry->leafPrefetchParent = entry->btree.leafPrefetchNext;
+				PrefetchQueueIssue(entry->leafPrefetch);
+			}
 			freeGinBtreeStack(stack);
 			entry->isFinished = false;
 		}
@@ -698,11 +842,24 @@ entryLoadMoreItems(GinState *ginstate, GinScanEntry entry,
 						   OffsetNumberNext(GinItemPointerGetOffsetNumber(&advancePast)));
 		}
 		entry->btree.fullScan = false;
+
+		/* continue prefetching from the new leaf page, queued by the descent */
+		if (entry->leafPrefetch)
+		{
+			PrefetchQueueReset(entry->leafPrefetch);
+			entry->btree.leafPrefetchNext = InvalidBlockNumber;
+		}
 		stack = ginFindLeafPage(&entry->btree, true, false, snapshot);
 
 		/* we don't need the stack, just the buffer. */
 		entry->buffer = stack->buffer;
 		IncrBufferRefCount(entry->buffer);
+
+		if (entry->leafPrefetch)
+		{
+			entry->leafPrefetchParent = entry->btree.leafPrefetchNext;
+			PrefetchQueueIssue(entry->leafPrefetch);
+		}
 		freeGinBtreeStack(stack);
 		stepright = false;
 	}
@@ -737,6 +894,13 @@ entryLoadMoreItems(GinState *ginstate, GinScanEntry entry,
 				return;
 			}
 
+			if (entry->leafPrefetch)
+			{
+				PrefetchQueueConsume(entry->leafPrefetch);
+				ginPrefetchLeaves(ginstate->index, entry->leafPrefetch,
+								  &entry->leafPrefetchParent, entry->buffer);
+			}
+
 			/*
 			 * Step to next page, following the right link. then find the
 			 * first ItemPointer greater than advancePast.
@@ -103,6 +103,8 @@ ginFillScanEntry(GinScanOpaque so, OffsetNumber attnum,
 	scanEntry->attnum = attnum;
 
 	scanEntry->buffer = InvalidBuffer;
+	scanEntry->leafPrefetch = NULL;
+	scanEntry->leafPrefetchParent = InvalidBlockNumber;
 	ItemPointerSetMin(&scanEntry->curItem);
 	scanEntry->matchBitmap = NULL;
 	scanEntry->matchIterator = NULL;
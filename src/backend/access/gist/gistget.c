@@ -338,9 +338,13 @@ gistScanPage(IndexScanDesc scan, GISTSearchItem *pageItem,
 	OffsetNumber maxoff;
 	OffsetNumber i;
 	MemoryContext oldcxt;
+	BlockNumber children[MaxIndexTuplesPerPage];
+	int			nchildren = 0;
 
 	Assert(!GISTSearchItemIsHeap(*pageItem));
 
+	PrefetchControlConsume(&so->index_prefetch);
+
 	buffer = ReadBuffer(scan->indexRelation, pageItem->blkno);
 	LockBuffer(buffer, GIST_SHARE);
 	PredicateLockPage(r, BufferGetBlockNumber(buffer), scan->xs_snapshot);
@@ -509,6 +513,7 @@ gistScanPage(IndexScanDesc scan, GISTSearchItem *pageItem,
 			{
 				/* Creating index-page GISTSearchItem */
 				item->blkno = ItemPointerGetBlockNumber(&it->t_tid);
+				children[nchildren++] = item->blkno;
 
 				/*
 				 * LSN of current page is lsn of parent page for child. We
@@ -529,6 +534,36 @@ gistScanPage(IndexScanDesc scan, GISTSearchItem *pageItem,
 	}
 
 	UnlockReleaseBuffer(buffer);
+
+	/*
+	 * Prefetch the child pages we pushed.  Without ORDER BY, the queue
+	 * returns pages with equal distances in LIFO order, so the last ones
+	 * pushed are visited first.  A bitmap scan visits all of them, so it can
+	 * prefetch as many as the maximum distance allows.  In an ordered scan we
+	 * can't tell which pages will be visited next, so we don't prefetch.
+	 */
+	if (nchildren > 0 && scan->numberOfOrderBys == 0)
+	{
+		int			n = tbm ? so->index_prefetch.maximum
+			: PrefetchControlTarget(&so->index_prefetch);
+
+		n = Min(n, nchildren);
+		if (n > 0)
+		{
+			PrefetchBuffers(r, MAIN_FORKNUM, children + nchildren - n, n);
+			PrefetchControlIssued(&so->index_prefetch, n);
+		}
+	}
+
+	/* Prefetch the heap pages of the tuples we are about to return */
+	if (so->nPageData > 0 && PrefetchQueueEnabled(&so->heap_prefetch))
+	{
+		PrefetchQueueReset(&so->heap_prefetch);
+		for (int j = 0; j < so->nPageData; j++)
+			PrefetchQueueAdd(&so->heap_prefetch,
+							 ItemPointerGetBlockNumber(&so->pageData[j].heapPtr));
+		PrefetchQueueIssue(&so->heap_prefetch);
+	}
 }
 
 /*
@@ -670,6 +705,8 @@ gistgettuple(IndexScanDesc scan, ScanDirection dir)
 							so->pageData[so->curPageData - 1].offnum;
 				}
 				/* continuing to return tuples from a leaf page */
+				if (so->curPageData > 0)
+					PrefetchQueueConsume(&so->heap_prefetch);
 				scan->xs_heaptid = so->pageData[so->curPageData].heapPtr;
 				scan->xs_recheck = so->pageData[so->curPageData].recheck;
 
@@ -216,6 +216,11 @@ gistrescan(IndexScanDesc scan, ScanKey key, int nkeys,
 
 	so->firstCall = true;
 
+	/* A rescan starts with what the previous scans learned, see prefetch.c */
+	PrefetchControlRescan(&so->index_prefetch,
+						  index_prefetch_maximum(scan->indexRelation), 1);
+	index_heap_prefetch_rescan(scan, &so->heap_prefetch);
+
 	/* Update scan key, if a new one is given */
 	if (key && scan->numberOfKeys > 0)
 	{
@@ -76,6 +76,7 @@ hashhandler(PG_FUNCTION_ARGS)
 	amroutine->amcanparallel = false;
 	amroutine->amcaninclude = false;
 	amroutine->amusemaintenanceworkmem = false;
+	amroutine->amsummarizing = false;
 	amroutine->amparallelvacuumoptions =
 		VACUUM_OPTION_PARALLEL_BULKDEL;
 	amroutine->amkeytype = INT4OID;
@@ -99,6 +100,7 @@ hashhandler(PG_FUNCTION_ARGS)
 	amroutine->amendscan = hashendscan;
 	amroutine->ammarkpos = NULL;
 	amroutine->amrestrpos = NULL;
+	amroutine->amprefetch = NULL;
 	amroutine->amestimateparallelscan = NULL;
 	amroutine->aminitparallelscan = NULL;
 	amroutine->amparallelrescan = NULL;
@@ -383,6 +385,9 @@ hashbeginscan(Relation rel, int nkeys, int norderbys)
 	so->killedItems = NULL;
 	so->numKilled = 0;
 
+	/* set up by hashrescan, once the heap relation is known */
+	PrefetchQueueInit(&so->heap_prefetch, NULL, 0, 0);
+
 	scan->opaque = so;
 
 	return scan;
@@ -410,6 +415,8 @@ hashrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
 	/* set position invalid (this will cause _hash_first call) */
 	HashScanPosInvalidate(so->currPos);
 
+	index_heap_prefetch_rescan(scan, &so->heap_prefetch);
+
 	/* Update scan key, if a new one is given */
 	if (scankey && scan->numberOfKeys > 0)
 	{
@@ -62,7 +62,9 @@ _hash_next(IndexScanDesc scan, ScanDirection dir)
 	 */
 	if (ScanDirectionIsForward(dir))
 	{
-		if (++so->currPos.itemIndex > so->currPos.lastItem)
+		if (++so->currPos.itemIndex <= so->currPos.lastItem)
+			PrefetchQueueConsume(&so->heap_prefetch);
+		else
 		{
 			if (so->numKilled > 0)
 				_hash_kill_items(scan);
@@ -81,7 +83,9 @@ _hash_next(IndexScanDesc scan, ScanDirection dir)
 	}
 	else
 	{
-		if (--so->currPos.itemIndex < so->currPos.firstItem)
+		if (--so->currPos.itemIndex >= so->currPos.firstItem)
+			PrefetchQueueConsume(&so->heap_prefetch);
+		else
 		{
 			if (so->numKilled > 0)
 				_hash_kill_items(scan);
@@ -474,6 +478,14 @@ _hash_readpage(IndexScanDesc scan, Buffer *bufP, ScanDirection dir)
 
 		for (;;)
 		{
+			/*
+			 * A forward scan always goes on to the rest of the bucket chain
+			 * unless it's stopped early, so get the next overflow page read
+			 * in while we're busy with this one.
+			 */
+			if (BlockNumberIsValid(opaque->hasho_nextblkno))
+				PrefetchBuffer(rel, MAIN_FORKNUM, opaque->hasho_nextblkno);
+
 			/* new page, locate starting position by binary search */
 			offnum = _hash_binsearch(page, so->hashso_sk_hash);
 
@@ -597,6 +609,26 @@ _hash_readpage(IndexScanDesc scan, Buffer *bufP, ScanDirection dir)
 	}
 
 	Assert(so->currPos.firstItem <= so->currPos.lastItem);
+
+	/* Start prefetching the heap pages of the items, in scan order */
+	if (PrefetchQueueEnabled(&so->heap_prefetch))
+	{
+		PrefetchQueueReset(&so->heap_prefetch);
+		if (ScanDirectionIsForward(dir))
+		{
+			for (int i = so->currPos.firstItem; i <= so->currPos.lastItem; i++)
+				PrefetchQueueAdd(&so->heap_prefetch,
+								 ItemPointerGetBlockNumber(&so->currPos.items[i].heapTid));
+		}
+		else
+		{
+			for (int i = so->currPos.lastItem; i >= so->currPos.firstItem; i--)
+				PrefetchQueueAdd(&so->heap_prefetch,
+								 ItemPointerGetBlockNumber(&so->currPos.items[i].heapTid));
+		}
+		PrefetchQueueIssue(&so->heap_prefetch);
+	}
+
 	return true;
 }
 
@@ -232,6 +232,7 @@ initscan(HeapScanDesc scan, ScanKey key, bool keep_startblock)
 	ParallelBlockTableScanDesc bpscan = NULL;
 	bool		allow_strat;
 	bool		allow_sync;
+	int			prefetch_maximum;
 
 	/*
 	 * Determine the number of blocks we have to scan.
@@ -325,18 +326,20 @@ initscan(HeapScanDesc scan, ScanKey key, bool keep_startblock)
 		 * might result in a deadlock.
 		 */
 		if (IsCatalogRelation(scan->rs_base.rs_rd))
-			scan->rs_prefetch_maximum = effective_io_concurrency;
+			prefetch_maximum = effective_io_concurrency;
 		else
-			scan->rs_prefetch_maximum =
+			prefetch_maximum =
 				get_tablespace_io_concurrency(scan->rs_base.rs_rd->rd_rel->reltablespace);
-
-		scan->rs_prefetch_target = 1;
 	}
 	else
-	{
-		scan->rs_prefetch_maximum = -1;
-		scan->rs_prefetch_target = -1;
-	}
+		prefetch_maximum = 0;
+
+	/* A rescan starts from what the previous scan learned */
+	if (keep_startblock && prefetch_maximum == scan->rs_prefetch.maximum)
+		PrefetchControlRestart(&scan->rs_prefetch);
+	else
+		PrefetchControlInit(&scan->rs_prefetch, prefetch_maximum, 1);
+	scan->rs_prefetch_next = 0;
 
 	scan->rs_numblocks = InvalidBlockNumber;
 	scan->rs_inited = false;
@@ -384,6 +387,131 @@ heap_setscanlimits(TableScanDesc sscan, BlockNumber startBlk, BlockNumber numBlk
 	scan->rs_numblocks = numBlks;
 }
 
+/*
+ * heap_setscanmaintenance - prefetch like a maintenance operation
+ *
+ * Scans done on behalf of maintenance commands, such as the heap scans of
+ * CREATE INDEX and of the validation phase of CREATE INDEX CONCURRENTLY,
+ * read the whole table while nothing else in the backend competes for I/O,
+ * so they use maintenance_io_concurrency rather than effective_io_concurrency
+ * as their prefetch distance, like VACUUM and ANALYZE do.
+ */
+void
+heap_setscanmaintenance(TableScanDesc sscan)
+{
+	HeapScanDesc scan = (HeapScanDesc) sscan;
+	int			prefetch_maximum;
+
+	Assert(!scan->rs_inited);	/* else too late to change */
+
+	if (!enable_seqscan_prefetch)
+		return;
+
+	/* see initscan() about catalog relations */
+	if (IsCatalogRelation(scan->rs_base.rs_rd))
+		prefetch_maximum = maintenance_io_concurrency;
+	else
+		prefetch_maximum =
+			get_tablespace_maintenance_io_concurrency(scan->rs_base.rs_rd->rd_rel->reltablespace);
+
+	PrefetchControlInit(&scan->rs_prefetch, prefetch_maximum, 1);
+	scan->rs_prefetch_next = 0;
+}
+
+/*
+ * heap_prefetch_range - prefetch the blocks at some scan offsets
+ *
+ * The blocks at scan offsets start..end - 1 from startblock, wrapping around
+ * at nblocks, are prefetched.
+ */
+static void
+heap_prefetch_range(HeapScanDesc scan, int64 start, int64 end,
+					BlockNumber startblock, BlockNumber nblocks)
+{
+	while (start < end)
+	{
+		BlockNumber blocks[PREFETCH_BATCH_SIZE];
+		int			nprefetch = 0;
+
+		while (start < end && nprefetch < PREFETCH_BATCH_SIZE)
+		{
+			BlockNumber blckno = (startblock + start) % nblocks;
+
+			Assert(blckno < nblocks);
+			Assert(blckno < INT_MAX);
+			blocks[nprefetch++] = blckno;
+			start += 1;
+		}
+		PrefetchBuffers(scan->rs_base.rs_rd, MAIN_FORKNUM, blocks, nprefetch);
+		PrefetchControlIssued(&scan->rs_prefetch, nprefetch);
+	}
+}
+
+/*
+ * heap_prefetch_parallel - prefetch for heapgetpage() in a parallel scan
+ *
+ * A worker only reads the blocks of the chunks allocated to it, so it
+ * prefetches within its current chunk.  Once the prefetch distance reaches
+ * past the end of that chunk, it claims its next chunk in advance and goes on
+ * prefetching the first blocks of that one.  Without that, every chunk
+ * boundary would leave the worker waiting for the first pages of the next
+ * chunk, and small chunks at the end of the scan would hardly be prefetched
+ * at all.
+ */
+static void
+heap_prefetch_parallel(HeapScanDesc scan)
+{
+	ParallelBlockTableScanWorker pbscanwork = scan->rs_parallelworkerdata;
+	ParallelBlockTableScanDesc pbscan =
+	(ParallelBlockTableScanDesc) scan->rs_base.rs_parallel;
+	uint64		cur = pbscanwork->phsw_nallocated;
+	uint64		chunk_end;
+	uint64		start;
+	uint64		end;
+	int			distance;
+
+	Assert(pbscan != NULL);
+	chunk_end = Min(cur + pbscanwork->phsw_chunk_remaining + 1,
+					pbscan->phs_nblocks);
+
+	/* As in a serial scan, the distance adapts from the second page on */
+	if (scan->rs_prefetch_next == 0)
+		distance = PrefetchControlTarget(&scan->rs_prefetch);
+	else
+		distance = PrefetchControlConsume(&scan->rs_prefetch);
+
+	/* the part of the prefetch window in the current chunk */
+	start = Max(scan->rs_prefetch_next, cur);
+	end = Min(cur + distance, chunk_end);
+	if (start < end)
+	{
+		heap_prefetch_range(scan, start, end, pbscan->phs_startblock,
+							pbscan->phs_nblocks);
+		scan->rs_prefetch_next = end;
+	}
+
+	/* the part in the next chunk */
+	if (cur + distance > chunk_end)
+	{
+		uint32		nnext = table_block_parallelscan_claimnext(pbscanwork,
+															   pbscan);
+
+		if (nnext > 0)
+		{
+			uint64		next = pbscanwork->phsw_next_nallocated;
+
+			start = Max(scan->rs_prefetch_next, next);
+			end = next + Min(cur + distance - chunk_end, nnext);
+			if (start < end)
+			{
+				heap_prefetch_range(scan, start, end, pbscan->phs_startblock,
+									pbscan->phs_nblocks);
+				scan->rs_prefetch_next = end;
+			}
+		}
+	}
+}
+
 /*
  * heapgetpage - subroutine for heapgettup()
  *
@@ -421,50 +549,19 @@ heapgetpage(TableScanDesc sscan, BlockNumber page)
 	CHECK_FOR_INTERRUPTS();
 
 	/* Prefetch up to io_concurrency blocks ahead */
-	if (scan->rs_prefetch_maximum > 0 && scan->rs_nblocks > 1)
+	if (scan->rs_prefetch.maximum > 0 && scan->rs_parallelworkerdata != NULL)
+		heap_prefetch_parallel(scan);
+	else if (scan->rs_prefetch.maximum > 0 && scan->rs_nblocks > 1)
 	{
-		int64	nblocks;
-		int64	rel_scan_start;
-		int64	rel_scan_end; /* blockno of end of scan (mod scan->rs_nblocks) */
+		int64	rel_scan_start = scan->rs_startblock;
+		int64	rel_scan_end = scan->rs_startblock + scan->rs_nblocks; /* blockno of end of scan (mod scan->rs_nblocks) */
 		int64	scan_pageoff; /* page, but adjusted for scan position as above */
 
 		int64	prefetch_start; /* start block of prefetch requests this iteration */
 		int64	prefetch_end; /* end block of prefetch requests this iteration, if applicable */
-		ParallelBlockTableScanWorker pbscanwork = scan->rs_parallelworkerdata;
-		ParallelBlockTableScanDesc pbscandesc = (ParallelBlockTableScanDesc) sscan->rs_parallel;
-
-		/*
-		 * Parallel scans look like repeated sequential table scans for
-		 * prefetching; with a scan start at nalloc + ch_remaining - ch_size
-		 */
-		if (pbscanwork != NULL)
-		{
-			uint64	start_offset,
-					end_offset;
-
-			Assert(pbscandesc != NULL);
-			start_offset = pbscanwork->phsw_nallocated
-						   + pbscanwork->phsw_chunk_remaining + 1
-						   - pbscanwork->phsw_chunk_size;
-			end_offset = Min(pbscanwork->phsw_nallocated +
-							 pbscanwork->phsw_chunk_remaining + 1,
-							 pbscandesc->phs_nblocks);
-
-			rel_scan_start = (int64) (pbscandesc->phs_startblock) + start_offset;
-			rel_scan_end = (int64) (pbscandesc->phs_startblock) + end_offset;
-			nblocks = pbscandesc->phs_nblocks;
-		}
-		else
-		{
-			rel_scan_start = scan->rs_startblock;
-			rel_scan_end = scan->rs_startblock + scan->rs_nblocks;
-			nblocks = scan->rs_nblocks;
-		}
-
-		prefetch_end = rel_scan_end;
 
 		if ((uint64) page < rel_scan_start)
-			scan_pageoff = page + nblocks;
+			scan_pageoff = page + scan->rs_nblocks;
 		else
 			scan_pageoff = page;
 
@@ -472,49 +569,27 @@ heapgetpage(TableScanDesc sscan, BlockNumber page)
 
 		/*
 		 * If this is the first page of this seqscan, initiate prefetch of
-		 * pages page..page + n. On each subsequent call, prefetch the next
-		 * page that we haven't prefetched yet, at page + n.
-		 * If this is the last page of the prefetch, 
+		 * pages page..page + n, where n is the prefetch distance. On each
+		 * subsequent call, pages up to page - 1 + n have been prefetched
+		 * already; let the prefetch controller adjust n, and prefetch the
+		 * pages up to page + n that we haven't prefetched yet.
 		 */
 		if (rel_scan_start != page)
 		{
-			prefetch_start = scan_pageoff + (int64) scan->rs_prefetch_target - 1;
-			prefetch_end = prefetch_start + 1;
+			prefetch_start = scan_pageoff - 1 + PrefetchControlTarget(&scan->rs_prefetch);
+			prefetch_end = scan_pageoff + PrefetchControlConsume(&scan->rs_prefetch);
 		}
 		else
 		{
 			prefetch_start = scan_pageoff;
-			prefetch_end = rel_scan_end;
+			prefetch_end = scan_pageoff + PrefetchControlTarget(&scan->rs_prefetch);
 		}
 
-		/* do not prefetch if the only page we're trying to prefetch is past the end of our scan window */
-		if (prefetch_start > rel_scan_end)
-			prefetch_end = 0;
-
-		if (prefetch_end > prefetch_start + scan->rs_prefetch_target)
-			prefetch_end = prefetch_start + scan->rs_prefetch_target;
-
 		if (prefetch_end > rel_scan_end)
 			prefetch_end = rel_scan_end;
 
-		while (prefetch_start < prefetch_end)
-		{
-			BlockNumber blckno = (prefetch_start % nblocks);
-			Assert(blckno < nblocks);
-			Assert(blckno < INT_MAX);
-			PrefetchBuffer(scan->rs_base.rs_rd, MAIN_FORKNUM, blckno);
-			prefetch_start += 1;
-		}
-
-		/*
-		 * Use exponential growth of readahead up to prefetch_maximum, to
-		 * make sure that a low LIMIT does not result in high IO overhead,
-		 * but operations in general are still very fast.
-		 */
-		if (scan->rs_prefetch_target < scan->rs_prefetch_maximum / 2)
-			scan->rs_prefetch_target *= 2;
-		else if (scan->rs_prefetch_target < scan->rs_prefetch_maximum)
-			scan->rs_prefetch_target = scan->rs_prefetch_maximum;
+		heap_prefetch_range(scan, prefetch_start, prefetch_end, 0,
+							scan->rs_nblocks);
 	}
 
 	/* read page using selected strategy */
@@ -2096,6 +2171,7 @@ GetBulkInsertState(void)
 	bistate = (BulkInsertState) palloc(sizeof(BulkInsertStateData));
 	bistate->strategy = GetAccessStrategy(BAS_BULKWRITE);
 	bistate->current_buf = InvalidBuffer;
+	bistate->extend_by = 0;
 	return bistate;
 }
 
@@ -3255,15 +3331,21 @@ simple_heap_delete(Relation relation, ItemPointer tid)
  * t_xmax (resolving a possible MultiXact, if necessary), and t_cmax (the last
  * only for TM_SelfModified, since we cannot obtain cmax from a combo CID
  * generated by another transaction).
+ *
+ * On success, *update_indexes tells which indexes need new entries for the
+ * tuple: all of them, none in the case of a HOT update, or only the
+ * summarizing ones if the HOT update changed columns they index.
  */
 TM_Result
 heap_update(Relation relation, ItemPointer otid, HeapTuple newtup,
 			CommandId cid, Snapshot crosscheck, bool wait,
-			TM_FailureData *tmfd, LockTupleMode *lockmode)
+			TM_FailureData *tmfd, LockTupleMode *lockmode,
+			TU_UpdateIndexes *update_indexes)
 {
 	TM_Result	result;
 	TransactionId xid = GetCurrentTransactionId();
 	Bitmapset  *hot_attrs;
+	Bitmapset  *sum_attrs;
 	Bitmapset  *key_attrs;
 	Bitmapset  *id_attrs;
 	Bitmapset  *interesting_attrs;
@@ -3286,6 +3368,7 @@ heap_update(Relation relation, ItemPointer otid, HeapTuple newtup,
 	bool		have_tuple_lock = false;
 	bool		iscombo;
 	bool		use_hot_update = false;
+	bool		summarized_update = false;
 	bool		key_intact;
 	bool		all_visible_cleared = false;
 	bool		all_visible_cleared_new = false;
@@ -3331,12 +3414,16 @@ heap_update(Relation relation, ItemPointer otid, HeapTuple newtup,
 	 * Note that we get copies of each bitmap, so we need not worry about
 	 * relcache flush happening midway through.
 	 */
-	hot_attrs = RelationGetIndexAttrBitmap(relation, INDEX_ATTR_BITMAP_ALL);
+	hot_attrs = RelationGetIndexAttrBitmap(relation,
+										   INDEX_ATTR_BITMAP_HOT_BLOCKING);
+	sum_attrs = RelationGetIndexAttrBitmap(relation,
+										   INDEX_ATTR_BITMAP_SUMMARIZED);
 	key_attrs = RelationGetIndexAttrBitmap(relation, INDEX_ATTR_BITMAP_KEY);
 	id_attrs = RelationGetIndexAttrBitmap(relation,
 										  INDEX_ATTR_BITMAP_IDENTITY_KEY);
 	interesting_attrs = NULL;
 	interesting_attrs = bms_add_members(interesting_attrs, hot_attrs);
+	interesting_attrs = bms_add_members(interesting_attrs, sum_attrs);
 	interesting_attrs = bms_add_members(interesting_attrs, key_attrs);
 	interesting_attrs = bms_add_members(interesting_attrs, id_attrs);
 
@@ -3646,7 +3733,10 @@ l2:
 			UnlockTupleTuplock(relation, &(oldtup.t_self), *lockmode);
 		if (vmbuffer != InvalidBuffer)
 			ReleaseBuffer(vmbuffer);
+		*update_indexes = TU_None;
+
 		bms_free(hot_attrs);
+		bms_free(sum_attrs);
 		bms_free(key_attrs);
 		bms_free(id_attrs);
 		bms_free(modified_attrs);
@@ -3966,10 +4056,17 @@ l2:
 		/*
 		 * Since the new tuple is going into the same page, we might be able
 		 * to do a HOT update.  Check if any of the index columns have been
-		 * changed.
+		 * changed, apart from those of summarizing indexes.  Those only
+		 * summarize the block, so they can be told about the new version
+		 * without breaking the HOT chain.
 		 */
 		if (!bms_overlap(modified_attrs, hot_attrs))
+		{
 			use_hot_update = true;
+
+			if (bms_overlap(modified_attrs, sum_attrs))
+				summarized_update = true;
+		}
 	}
 	else
 	{
@@ -4132,7 +4229,22 @@ l2:
 	if (old_key_tuple != NULL && old_key_copied)
 		heap_freetuple(old_key_tuple);
 
+	/*
+	 * Even after a HOT update, the summarizing indexes must be told about
+	 * changes to their columns, lest their block summaries go stale.
+	 */
+	if (use_hot_update)
+	{
+		if (summarized_update)
+			*update_indexes = TU_Summarizing;
+		else
+			*update_indexes = TU_None;
+	}
+	else
+		*update_indexes = TU_All;
+
 	bms_free(hot_attrs);
+	bms_free(sum_attrs);
 	bms_free(key_attrs);
 	bms_free(id_attrs);
 	bms_free(modified_attrs);
@@ -4301,11 +4413,12 @@ simple_heap_update(Relation relation, ItemPointer otid, HeapTuple tup)
 	TM_Result	result;
 	TM_FailureData tmfd;
 	LockTupleMode lockmode;
+	TU_UpdateIndexes update_indexes;
 
 	result = heap_update(relation, otid, tup,
 						 GetCurrentCommandId(true), InvalidSnapshot,
 						 true /* wait for commit */ ,
-						 &tmfd, &lockmode);
+						 &tmfd, &lockmode, &update_indexes);
 	switch (result)
 	{
 		case TM_SelfModified:
@@ -314,7 +314,7 @@ static TM_Result
 heapam_tuple_update(Relation relation, ItemPointer otid, TupleTableSlot *slot,
 					CommandId cid, Snapshot snapshot, Snapshot crosscheck,
 					bool wait, TM_FailureData *tmfd,
-					LockTupleMode *lockmode, bool *update_indexes)
+					LockTupleMode *lockmode, TU_UpdateIndexes *update_indexes)
 {
 	bool		shouldFree = true;
 	HeapTuple	tuple = ExecFetchSlotHeapTuple(slot, true, &shouldFree);
@@ -325,7 +325,7 @@ heapam_tuple_update(Relation relation, ItemPointer otid, TupleTableSlot *slot,
 	tuple->t_tableOid = slot->tts_tableOid;
 
 	result = heap_update(relation, otid, tuple, cid, crosscheck, wait,
-						 tmfd, lockmode);
+						 tmfd, lockmode, update_indexes);
 	ItemPointerCopy(&tuple->t_self, &slot->tts_tid);
 
 	/*
@@ -334,9 +334,17 @@ heapam_tuple_update(Relation relation, ItemPointer otid, TupleTableSlot *slot,
 	 * Note: heap_update returns the tid (location) of the new tuple in the
 	 * t_self field.
 	 *
-	 * If it's a HOT update, we mustn't insert new index entries.
+	 * If the update is not HOT, we must update all indexes.  If it is HOT,
+	 * heap_update has already told us whether the summarizing indexes need
+	 * to know about it.
 	 */
-	*update_indexes = result == TM_Ok && !HeapTupleIsHeapOnly(tuple);
+	if (result != TM_Ok)
+		*update_indexes = TU_None;
+	else if (!HeapTupleIsHeapOnly(tuple))
+		Assert(*update_indexes == TU_All);
+	else
+		Assert(*update_indexes == TU_Summarizing ||
+			   *update_indexes == TU_None);
 
 	if (shouldFree)
 		pfree(tuple);
@@ -1300,6 +1308,9 @@ heapam_index_build_range_scan(Relation heapRelation,
 									 nblocks);
 	}
 
+	/* this is a maintenance scan, as far as prefetching is concerned */
+	heap_setscanmaintenance(scan);
+
 	/* set our scan endpoints */
 	if (!allow_sync)
 		heap_setscanlimits(scan, start_blockno, numblocks);
@@ -1789,6 +1800,7 @@ heapam_index_validate_scan(Relation heapRelation,
 								 true,	/* buffer access strategy OK */
 								 false);	/* syncscan not OK */
 	hscan = (HeapScanDesc) scan;
+	heap_setscanmaintenance(scan);
 
 	pgstat_progress_update_param(PROGRESS_SCAN_BLOCKS_TOTAL,
 								 hscan->rs_nblocks);
@@ -2453,7 +2465,14 @@ heapam_scan_sample_next_tuple(TableScanDesc scan, SampleScanState *scanstate,
  * currently only known to happen as an after-effect of ALTER TABLE
  * SET WITHOUT OIDS.
  *
- * So, we must reconstruct the tuple from component Datums.
+ * 3. The tuple might have fewer attributes than the descriptor, relying on
+ * the old table's "missing" attribute values, which the new table doesn't
+ * have.
+ *
+ * So, in general we must reconstruct the tuple from component Datums.  But
+ * when none of the above applies, which is by far the common case, the
+ * reconstructed tuple would be identical to the original one, and a plain
+ * copy is much cheaper than deforming and re-forming every tuple.
  */
 static void
 reform_and_rewrite_tuple(HeapTuple tuple,
@@ -2463,18 +2482,33 @@ reform_and_rewrite_tuple(HeapTuple tuple,
 	TupleDesc	oldTupDesc = RelationGetDescr(OldHeap);
 	TupleDesc	newTupDesc = RelationGetDescr(NewHeap);
 	HeapTuple	copiedTuple;
+	bool		reform;
 	int			i;
 
-	heap_deform_tuple(tuple, oldTupDesc, values, isnull);
-
-	/* Be sure to null out any dropped columns */
-	for (i = 0; i < newTupDesc->natts; i++)
+	reform = (oldTupDesc->natts != newTupDesc->natts ||
+			  HeapTupleHeaderGetNatts(tuple->t_data) != newTupDesc->natts ||
+			  (tuple->t_data->t_infomask & HEAP_HASOID_OLD) != 0);
+	for (i = 0; i < newTupDesc->natts && !reform; i++)
 	{
 		if (TupleDescAttr(newTupDesc, i)->attisdropped)
-			isnull[i] = true;
+			reform = true;
 	}
 
-	copiedTuple = heap_form_tuple(newTupDesc, values, isnull);
+	if (reform)
+	{
+		heap_deform_tuple(tuple, oldTupDesc, values, isnull);
+
+		/* Be sure to null out any dropped columns */
+		for (i = 0; i < newTupDesc->natts; i++)
+		{
+			if (TupleDescAttr(newTupDesc, i)->attisdropped)
+				isnull[i] = true;
+		}
+
+		copiedTuple = heap_form_tuple(newTupDesc, values, isnull);
+	}
+	else
+		copiedTuple = heap_copytuple(tuple);
 
 	/* The heap rewrite module does the rest */
 	rewrite_heap_tuple(rwstate, tuple, copiedTuple);
@@ -30,6 +30,7 @@
 #include "access/heaptoast.h"
 #include "access/toast_helper.h"
 #include "access/toast_internals.h"
+#include "optimizer/cost.h"
 #include "utils/fmgroids.h"
 
 
@@ -686,6 +687,18 @@ heap_fetch_toast_slice(Relation toastrel, Oid valueid, int32 attrsize,
 
 	/* Prepare for scan */
 	init_toast_snapshot(&SnapshotToast);
+
+	/*
+	 * The index scan prefetches the heap pages of the chunks only as it
+	 * learns that the chunks are being read, but we know how many there are,
+	 * so prefetch them all now.  That's pointless for a single chunk, which
+	 * the scan reads right away.
+	 */
+	if (enable_indexscan_prefetch && endchunk > startchunk)
+		toast_prefetch_value(toastrel, toastidxs[validIndex], valueid,
+							 attrsize, sliceoffset, slicelength,
+							 &SnapshotToast, true);
+
 	toastscan = systable_beginscan_ordered(toastrel, toastidxs[validIndex],
 										   &SnapshotToast, nscankeys, toastkey);
 
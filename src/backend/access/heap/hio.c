@@ -24,6 +24,13 @@
 #include "storage/lmgr.h"
 #include "storage/smgr.h"
 
+/*
+ * Upper limit on the number of blocks RelationAddExtraBlocks adds at once,
+ * and the number a bulk inserter starts out with.
+ */
+#define MAX_EXTRA_BLOCKS		512
+#define MIN_BULK_EXTRA_BLOCKS	8
+
 
 /*
  * RelationPutHeapTuple - place tuple at specified page
@@ -189,76 +196,101 @@ GetVisibilityMapPins(Relation relation, Buffer buffer1, Buffer buffer2,
  * Extend a relation by multiple blocks to avoid future contention on the
  * relation extension lock.  Our goal is to pre-extend the relation by an
  * amount which ramps up as the degree of contention ramps up, but limiting
- * the result to some sane overall value.
+ * the result to some sane overall value.  A bulk inserter is also very likely
+ * to come back for more space soon, so for it the amount ramps up with each
+ * extension even when nobody else is waiting.
+ *
+ * The caller must hold the relation extension lock.
  */
 static void
 RelationAddExtraBlocks(Relation relation, BulkInsertState bistate)
 {
 	BlockNumber blockNum,
-				firstBlock = InvalidBlockNumber;
+				firstBlock;
 	int			extraBlocks;
 	int			lockWaiters;
+	Size		freespace;
+	SMgrRelation smgr;
 
 	/* Use the length of the lock wait queue to judge how much to extend. */
 	lockWaiters = RelationExtensionLockWaiterCount(relation);
-	if (lockWaiters <= 0)
-		return;
 
 	/*
 	 * It might seem like multiplying the number of lock waiters by as much as
 	 * 20 is too aggressive, but benchmarking revealed that smaller numbers
-	 * were insufficient.  512 is just an arbitrary cap to prevent
-	 * pathological results.
+	 * were insufficient.  MAX_EXTRA_BLOCKS is just an arbitrary cap to
+	 * prevent pathological results.
 	 */
-	extraBlocks = Min(512, lockWaiters * 20);
+	extraBlocks = Min(MAX_EXTRA_BLOCKS, Max(lockWaiters, 0) * 20);
 
-	do
+	if (bistate)
 	{
-		Buffer		buffer;
-		Page		page;
-		Size		freespace;
+		bistate->extend_by = Min(MAX_EXTRA_BLOCKS,
+								 Max(MIN_BULK_EXTRA_BLOCKS,
+									 bistate->extend_by * 2));
+		extraBlocks = Max(extraBlocks, bistate->extend_by);
+	}
 
-		/*
-		 * Extend by one page.  This should generally match the main-line
-		 * extension code in RelationGetBufferForTuple, except that we hold
-		 * the relation extension lock throughout, and we don't immediately
-		 * initialize the page (see below).
-		 */
-		buffer = ReadBufferBI(relation, P_NEW, RBM_ZERO_AND_LOCK, bistate);
-		page = BufferGetPage(buffer);
+	if (extraBlocks <= 0)
+		return;
 
-		if (!PageIsNew(page))
-			elog(ERROR, "page %u of relation \"%s\" should be empty but is not",
-				 BufferGetBlockNumber(buffer),
-				 RelationGetRelationName(relation));
+	/*
+	 * If the storage manager can add all the pages in one go, do that,
+	 * bypassing shared buffers.  The new pages are left all-zeroes: if we were
+	 * to initialize them here, they would potentially get flushed out to disk
+	 * before we add any useful content, and there's no guarantee that that'd
+	 * happen before a potential crash, so we need to deal with uninitialized
+	 * pages anyway.  RelationGetBufferForTuple() initializes such a page when
+	 * it picks it from the FSM.
+	 *
+	 * The current end of the relation is looked up only once, and is normally
+	 * answered by the shared relation size cache, which every extension keeps
+	 * up to date while we hold the extension lock.
+	 */
+	smgr = RelationGetSmgr(relation);
+	if (smgrcanzeroextend(smgr))
+	{
+		firstBlock = smgrnblocks(smgr, MAIN_FORKNUM);
+		smgrzeroextend(smgr, MAIN_FORKNUM, firstBlock, extraBlocks, false);
 
 		/*
-		 * Add the page to the FSM without initializing. If we were to
-		 * initialize here, the page would potentially get flushed out to disk
-		 * before we add any useful content. There's no guarantee that that'd
-		 * happen before a potential crash, so we need to deal with
-		 * uninitialized pages anyway, thus avoid the potential for
-		 * unnecessary writes.
+		 * Immediately update the bottom level of the FSM.  This has a good
+		 * chance of making these pages visible to other concurrently
+		 * inserting backends, and we want that to happen without delay.
 		 */
+		freespace = BLCKSZ - SizeOfPageHeaderData;
+		for (blockNum = firstBlock; blockNum < firstBlock + extraBlocks; blockNum++)
+			RecordPageWithFreeSpace(relation, blockNum, freespace);
+	}
+	else
+	{
+		/* Otherwise extend page by page, through shared buffers. */
+		firstBlock = InvalidBlockNumber;
+		for (int i = 0; i < extraBlocks; i++)
+		{
+			Buffer		buffer;
+			Page		page;
 
-		/* we'll need this info below */
-		blockNum = BufferGetBlockNumber(buffer);
-		freespace = BufferGetPageSize(buffer) - SizeOfPageHeaderData;
+			buffer = ReadBufferBI(relation, P_NEW, RBM_ZERO_AND_LOCK, bistate);
+			page = BufferGetPage(buffer);
 
-		UnlockReleaseBuffer(buffer);
+			if (!PageIsNew(page))
+				elog(ERROR, "page %u of relation \"%s\" should be empty but is not",
+					 BufferGetBlockNumber(buffer),
+					 RelationGetRelationName(relation));
 
-		/* Remember first block number thus added. */
-		if (firstBlock == InvalidBlockNumber)
-			firstBlock = blockNum;
+			blockNum = BufferGetBlockNumber(buffer);
+			freespace = BufferGetPageSize(buffer) - SizeOfPageHeaderData;
 
-		/*
-		 * Immediately update the bottom level of the FSM.  This has a good
-		 * chance of making this page visible to other concurrently inserting
-		 * backends, and we want that to happen without delay.
-		 */
-		RecordPageWithFreeSpace(relation, blockNum, freespace);
+			UnlockReleaseBuffer(buffer);
+
+			/* Remember first block number thus added. */
+			if (firstBlock == InvalidBlockNumber)
+				firstBlock = blockNum;
+
+			RecordPageWithFreeSpace(relation, blockNum, freespace);
+		}
 	}
-	while (--extraBlocks > 0);
 
 	/*
 	 * Updating the upper levels of the free space map is too expensive to do
@@ -266,7 +298,7 @@ RelationAddExtraBlocks(Relation relation, BulkInsertState bistate)
 	 * subsequent insertion activity sees all of those nifty free pages we
 	 * just inserted.
 	 */
-	FreeSpaceMapVacuumRange(relation, firstBlock, blockNum + 1);
+	FreeSpaceMapVacuumRange(relation, firstBlock, firstBlock + extraBlocks);
 }
 
 /*
@@ -579,8 +611,10 @@ loop:
 	/*
 	 * If we need the lock but are not able to acquire it immediately, we'll
 	 * consider extending the relation by multiple blocks at a time to manage
-	 * contention on the relation extension lock.  However, this only makes
-	 * sense if we're using the FSM; otherwise, there's no point.
+	 * contention on the relation extension lock.  Bulk inserters do the same
+	 * even without contention, as they will be back for more space soon.
+	 * However, this only makes sense if we're using the FSM; otherwise,
+	 * there's no point.
 	 */
 	if (needLock)
 	{
@@ -610,6 +644,8 @@ loop:
 			/* Time to bulk-extend. */
 			RelationAddExtraBlocks(relation, bistate);
 		}
+		else if (bistate)
+			RelationAddExtraBlocks(relation, bistate);
 	}
 
 	/*
@@ -87,9 +87,10 @@
  * is optimized for bulk inserting a lot of tuples, knowing that we have
  * exclusive access to the heap.  raw_heap_insert builds new pages in
  * local storage.  When a page is full, or at the end of the process,
- * we insert it to WAL as a single record and then write it to disk
- * directly through smgr.  Note, however, that any data sent to the new
- * heap's TOAST table will go through the normal bufmgr.
+ * we write it to disk directly through smgr.  At the end of the process,
+ * all the new pages are WAL-logged together (NEON: the writes are an
+ * "unlogged build" for the smgr).  Note, however, that any data sent to
+ * the new heap's TOAST table will go through the normal bufmgr.
  *
  *
  * Portions Copyright (c) 1996-2022, PostgreSQL Global Development Group
@@ -136,6 +137,7 @@ typedef struct RewriteStateData
 	Relation	rs_new_rel;		/* destination heap */
 	Page		rs_buffer;		/* page currently being built */
 	BlockNumber rs_blockno;		/* block where page will go */
+	BlockNumber rs_first_blockno;	/* first block written by the rewrite */
 	bool		rs_buffer_valid;	/* T if any tuples in buffer */
 	bool		rs_logical_rewrite; /* do we need to do logical rewriting */
 	TransactionId rs_oldest_xmin;	/* oldest xmin used by caller to determine
@@ -198,6 +200,7 @@ typedef struct RewriteMappingFile
 	off_t		off;			/* how far have we written yet */
 	uint32		num_mappings;	/* number of in-memory mappings */
 	dlist_head	mappings;		/* list of in-memory mappings */
+	bool		wallog_pending; /* NEON: contents not WAL-logged yet */
 	char		path[MAXPGPATH];	/* path, for error messages */
 } RewriteMappingFile;
 
@@ -260,6 +263,7 @@ begin_heap_rewrite(Relation old_heap, Relation new_heap, TransactionId oldest_xm
 	state->rs_buffer = (Page) palloc(BLCKSZ);
 	/* new_heap needn't be empty, just locked */
 	state->rs_blockno = RelationGetNumberOfBlocks(new_heap);
+	state->rs_first_blockno = state->rs_blockno;
 	state->rs_buffer_valid = false;
 	state->rs_oldest_xmin = oldest_xmin;
 	state->rs_freeze_xid = freeze_xid;
@@ -289,6 +293,12 @@ begin_heap_rewrite(Relation old_heap, Relation new_heap, TransactionId oldest_xm
 
 	logical_begin_heap_rewrite(state);
 
+	/*
+	 * NEON: the new pages are not WAL-logged one at a time as they are
+	 * written, but all together at the end of the rewrite.
+	 */
+	smgr_start_unlogged_build(RelationGetSmgr(new_heap));
+
 	return state;
 }
 
@@ -318,28 +328,40 @@ end_heap_rewrite(RewriteState state)
 	/* Write the last page, if any */
 	if (state->rs_buffer_valid)
 	{
-		if (RelationNeedsWAL(state->rs_new_rel))
-			log_newpage(&state->rs_new_rel->rd_node,
-						MAIN_FORKNUM,
-						state->rs_blockno,
-						state->rs_buffer,
-						true);
-
 		PageSetChecksumInplace(state->rs_buffer, state->rs_blockno);
 
 		smgrextend(RelationGetSmgr(state->rs_new_rel), MAIN_FORKNUM,
 				   state->rs_blockno, (char *) state->rs_buffer, true);
 	}
 
+	smgr_finish_unlogged_build_phase_1(RelationGetSmgr(state->rs_new_rel));
+
 	/*
-	 * When we WAL-logged rel pages, we must nonetheless fsync them.  The
-	 * reason is the same as in storage.c's RelationCopyStorage(): we're
-	 * writing data that's not in shared buffers, and so a CHECKPOINT
-	 * occurring during the rewriteheap operation won't have fsync'd data we
-	 * wrote before the checkpoint.
+	 * We didn't write WAL records as we wrote the pages, so if WAL-logging is
+	 * required, write all pages to the WAL now.  This reads them into shared
+	 * buffers and dirties them, so a checkpoint takes care of flushing them
+	 * from now on, and we don't need to fsync them ourselves.
 	 */
 	if (RelationNeedsWAL(state->rs_new_rel))
-		smgrimmedsync(RelationGetSmgr(state->rs_new_rel), MAIN_FORKNUM);
+	{
+		Relation	rel = state->rs_new_rel;
+		BlockNumber nblocks = RelationGetNumberOfBlocks(rel);
+
+		if (nblocks > state->rs_first_blockno)
+		{
+			log_newpage_range(rel, MAIN_FORKNUM,
+							  state->rs_first_blockno, nblocks, true);
+			SetLastWrittenLSNForBlockRange(XactLastRecEnd,
+										   RelationGetSmgr(rel)->smgr_rnode.node,
+										   MAIN_FORKNUM, state->rs_first_blockno,
+										   nblocks - state->rs_first_blockno);
+			SetLastWrittenLSNForRelation(XactLastRecEnd,
+										 RelationGetSmgr(rel)->smgr_rnode.node,
+										 MAIN_FORKNUM);
+		}
+	}
+
+	smgr_end_unlogged_build(RelationGetSmgr(state->rs_new_rel));
 
 	logical_end_heap_rewrite(state);
 
@@ -678,18 +700,10 @@ raw_heap_insert(RewriteState state, HeapTuple tup)
 			 * enforce saveFreeSpace unconditionally.
 			 */
 
-			/* XLOG stuff */
-			if (RelationNeedsWAL(state->rs_new_rel))
-				log_newpage(&state->rs_new_rel->rd_node,
-							MAIN_FORKNUM,
-							state->rs_blockno,
-							page,
-							true);
-
 			/*
 			 * Now write the page. We say skipFsync = true because there's no
-			 * need for smgr to schedule an fsync for this write; we'll do it
-			 * ourselves in end_heap_rewrite.
+			 * need for smgr to schedule an fsync for this write; the page is
+			 * WAL-logged and dirtied in shared buffers in end_heap_rewrite.
 			 */
 			PageSetChecksumInplace(page, state->rs_blockno);
 
@@ -816,6 +830,36 @@ wallog_mapping_file(char const* path, int fd)
 	}
 }
 
+/*
+ * NEON: like wallog_mapping_file(), for a mapping file that is open as a
+ * virtual file.  The contents are read through the vfd, since the kernel
+ * descriptor may have been closed by fd.c's LRU in the meantime.
+ */
+static void
+wallog_mapping_vfd(char const* path, File vfd)
+{
+	char	prefix[MAXPGPATH];
+	off_t	size;
+	char   *buf;
+	int		nread;
+
+	snprintf(prefix, sizeof(prefix), "neon-file:%s", path);
+	size = FileSize(vfd);
+	if (size < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not determine size of file \"%s\": %m", path)));
+	buf = palloc((size_t)size);
+	nread = FileRead(vfd, buf, (int) size, 0, WAIT_EVENT_LOGICAL_REWRITE_READ);
+	if (nread != size)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read file \"%s\", read %d of %ld: %m",
+						path, nread, (long) size)));
+	LogLogicalMessage(prefix, buf, (size_t)size, false);
+	pfree(buf);
+}
+
 /*
  * Do preparations for logging logical mappings during a rewrite if
  * necessary. If we detect that we don't need to log anything we'll prevent
@@ -951,7 +995,12 @@ logical_heap_rewrite_flush_mappings(RewriteState state)
 					 errmsg("could not write to file \"%s\", wrote %d of %d: %m", src->path,
 							written, len)));
 		src->off += len;
-		wallog_mapping_file(src->path, FileGetRawDesc(src->vfd));
+
+		/*
+		 * NEON: the whole file is WAL-logged at the end of the rewrite, so
+		 * that a file flushed many times is only logged once.
+		 */
+		src->wallog_pending = true;
 
 		XLogBeginInsert();
 		XLogRegisterData((char *) (&xlrec), sizeof(xlrec));
@@ -986,6 +1035,13 @@ logical_end_heap_rewrite(RewriteState state)
 	hash_seq_init(&seq_status, state->rs_logical_mappings);
 	while ((src = (RewriteMappingFile *) hash_seq_search(&seq_status)) != NULL)
 	{
+		/*
+		 * NEON: a crash before the rewriting transaction commits leaves the
+		 * mappings unused, so logging them only now is sufficient.
+		 */
+		if (src->wallog_pending)
+			wallog_mapping_vfd(src->path, src->vfd);
+
 		if (FileSync(src->vfd, WAIT_EVENT_LOGICAL_REWRITE_SYNC) != 0)
 			ereport(data_sync_elevel(ERROR),
 					(errcode_for_file_access(),
@@ -1036,6 +1092,7 @@ logical_rewrite_log_mapping(RewriteState state, TransactionId xid,
 		dlist_init(&src->mappings);
 		src->num_mappings = 0;
 		src->off = 0;
+		src->wallog_pending = false;
 		memcpy(src->path, path, sizeof(path));
 		src->vfd = PathNameOpenFile(path,
 									O_CREAT | O_EXCL | O_RDWR | PG_BINARY);
@@ -3,18 +3,20 @@
  * vacuumlazy.c
  *	  Concurrent ("lazy") vacuuming.
  *
- * The major space usage for vacuuming is storage for the array of dead TIDs
- * that are to be removed from indexes.  We want to ensure we can vacuum even
- * the very largest relations with finite memory space usage.  To do that, we
- * set upper bounds on the number of TIDs we can keep track of at once.
+ * The major space usage for vacuuming is storage for the dead TIDs that are
+ * to be removed from indexes.  We want to ensure we can vacuum even the very
+ * largest relations with finite memory space usage.  To do that, we set upper
+ * bounds on the space we use to keep track of TIDs at once.
  *
  * We are willing to use at most maintenance_work_mem (or perhaps
  * autovacuum_work_mem) memory space to keep track of dead TIDs.  We initially
- * allocate an array of TIDs of that size, with an upper limit that depends on
+ * allocate a VacDeadItems of that size, with an upper limit that depends on
  * table size (this limit ensures we don't allocate a huge area uselessly for
- * vacuuming small tables).  If the array threatens to overflow, we must call
- * lazy_vacuum to vacuum indexes (and to vacuum the pages that we've pruned).
- * This frees up the memory space dedicated to storing dead TIDs.
+ * vacuuming small tables).  It keeps the dead offsets of each heap page as a
+ * bitmap, so that it holds many more TIDs than an array of the same size
+ * would.  If it threatens to overflow, we must call lazy_vacuum to vacuum
+ * indexes (and to vacuum the pages that we've pruned).  This frees up the
+ * memory space dedicated to storing dead TIDs.
  *
  * In practice VACUUM will often complete its initial pass over the target
  * heap relation without ever running out of space to store TIDs.  This means
@@ -178,6 +180,8 @@ typedef struct LVRelState
 	/* VACUUM operation's target cutoffs for freezing XIDs and MultiXactIds */
 	TransactionId FreezeLimit;
 	MultiXactId MultiXactCutoff;
+	/* pages last modified before this LSN are frozen eagerly, if possible */
+	XLogRecPtr	EagerFreezeLSN;
 	/* Tracks oldest extant XID/MXID for setting relfrozenxid/relminmxid */
 	TransactionId NewRelfrozenXid;
 	MultiXactId NewRelminMxid;
@@ -223,6 +227,26 @@ typedef struct LVRelState
 	int64		missed_dead_tuples; /* # removable, but not removed */
 } LVRelState;
 
+/*
+ * Blocks lazy_scan_heap() will scan, decided ahead of the scan using the
+ * visibility map so that exactly those blocks can be prefetched
+ */
+typedef struct LVScanAhead
+{
+	BlockNumber next_block;		/* next block not yet decided on */
+	BlockNumber next_unskippable_block; /* as returned by lazy_scan_skip */
+	bool		next_unskippable_allvis;
+	bool		skipping_current_range;
+	Buffer		vmbuffer;		/* for lazy_scan_skip */
+
+	/* ring buffer of the blocks to scan next, and their all-visible status */
+	int			depth;			/* size of the ring buffer */
+	int			head;
+	int			count;
+	BlockNumber *blocks;
+	bool	   *allvis;
+} LVScanAhead;
+
 /*
  * State returned by lazy_scan_prune()
  */
@@ -256,6 +280,11 @@ static BlockNumber lazy_scan_skip(LVRelState *vacrel, Buffer *vmbuffer,
 								  BlockNumber next_block,
 								  bool *next_unskippable_allvis,
 								  bool *skipping_current_range);
+static void lazy_scan_ahead_init(LVRelState *vacrel, LVScanAhead *scanahead);
+static BlockNumber lazy_scan_next_block(LVRelState *vacrel,
+										LVScanAhead *scanahead,
+										bool *all_visible_according_to_vm);
+static void lazy_scan_ahead_end(LVScanAhead *scanahead);
 static bool lazy_scan_new_or_empty(LVRelState *vacrel, Buffer buf,
 								   BlockNumber blkno, Page page,
 								   bool sharelock, Buffer vmbuffer);
@@ -269,7 +298,7 @@ static void lazy_vacuum(LVRelState *vacrel);
 static bool lazy_vacuum_all_indexes(LVRelState *vacrel);
 static void lazy_vacuum_heap_rel(LVRelState *vacrel);
 static int	lazy_vacuum_heap_page(LVRelState *vacrel, BlockNumber blkno,
-								  Buffer buffer, int index, Buffer *vmbuffer);
+								  Buffer buffer, int blockidx, Buffer *vmbuffer);
 static bool lazy_check_wraparound_failsafe(LVRelState *vacrel);
 static void lazy_cleanup_all_indexes(LVRelState *vacrel);
 static IndexBulkDeleteResult *lazy_vacuum_one_index(Relation indrel,
@@ -519,6 +548,20 @@ heap_vacuum_rel(Relation rel, VacuumParams *params,
 	vacrel->FreezeLimit = FreezeLimit;
 	/* MultiXactCutoff controls MXID freezing (always <= OldestMxact) */
 	vacrel->MultiXactCutoff = MultiXactCutoff;
+
+	/*
+	 * A page that has seen no changes in the last max_wal_size of WAL, about
+	 * a checkpoint cycle, is unlikely to be modified again soon, so it is
+	 * worth freezing once it is all-visible, even if that costs a full-page
+	 * image.
+	 */
+	{
+		XLogRecPtr	insert_lsn = GetInsertRecPtr();
+		uint64		max_wal_bytes = (uint64) max_wal_size_mb * 1024 * 1024;
+
+		vacrel->EagerFreezeLSN = insert_lsn > max_wal_bytes ?
+			insert_lsn - max_wal_bytes : InvalidXLogRecPtr;
+	}
 	/* Initialize state used to track oldest extant XID/MXID */
 	vacrel->NewRelfrozenXid = OldestXmin;
 	vacrel->NewRelminMxid = OldestMxact;
@@ -853,14 +896,11 @@ lazy_scan_heap(LVRelState *vacrel)
 {
 	BlockNumber rel_pages = vacrel->rel_pages,
 				blkno,
-				next_unskippable_block,
-				next_prefetch_block,
 				next_failsafe_block = 0,
 				next_fsm_block_to_vacuum = 0;
 	VacDeadItems *dead_items = vacrel->dead_items;
 	Buffer		vmbuffer = InvalidBuffer;
-	bool		next_unskippable_allvis,
-				skipping_current_range;
+	LVScanAhead scanahead;
 	const int	initprog_index[] = {
 		PROGRESS_VACUUM_PHASE,
 		PROGRESS_VACUUM_TOTAL_HEAP_BLKS,
@@ -871,46 +911,23 @@ lazy_scan_heap(LVRelState *vacrel)
 	/* Report that we're scanning the heap, advertising total # of blocks */
 	initprog_val[0] = PROGRESS_VACUUM_PHASE_SCAN_HEAP;
 	initprog_val[1] = rel_pages;
-	initprog_val[2] = dead_items->max_items;
+	initprog_val[2] = vac_dead_items_max_items(dead_items);
 	pgstat_progress_update_multi_param(3, initprog_index, initprog_val);
 
 	/* Set up an initial range of skippable blocks using the visibility map */
-	next_unskippable_block = lazy_scan_skip(vacrel, &vmbuffer, 0,
-											&next_unskippable_allvis,
-											&skipping_current_range);
-	next_prefetch_block = 0;
-	for (blkno = 0; blkno < rel_pages; blkno++)
+	lazy_scan_ahead_init(vacrel, &scanahead);
+	for (;;)
 	{
 		Buffer		buf;
 		Page		page;
 		bool		all_visible_according_to_vm;
 		LVPagePruneState prunestate;
 
-		if (blkno == next_unskippable_block)
-		{
-			/*
-			 * Can't skip this page safely.  Must scan the page.  But
-			 * determine the next skippable range after the page first.
-			 */
-			all_visible_according_to_vm = next_unskippable_allvis;
-			next_unskippable_block = lazy_scan_skip(vacrel, &vmbuffer,
-													blkno + 1,
-													&next_unskippable_allvis,
-													&skipping_current_range);
-
-			Assert(next_unskippable_block >= blkno + 1);
-		}
-		else
-		{
-			/* Last page always scanned (may need to set nonempty_pages) */
-			Assert(blkno < rel_pages - 1);
-
-			if (skipping_current_range)
-				continue;
-
-			/* Current range is too small to skip -- just scan the page */
-			all_visible_according_to_vm = true;
-		}
+		/* Get the next page that the visibility map doesn't let us skip */
+		blkno = lazy_scan_next_block(vacrel, &scanahead,
+									 &all_visible_according_to_vm);
+		if (blkno == InvalidBlockNumber)
+			break;
 
 		vacrel->scanned_pages++;
 
@@ -942,8 +959,7 @@ lazy_scan_heap(LVRelState *vacrel)
 		 * dead_items TIDs, pause and do a cycle of vacuuming before we tackle
 		 * this page.
 		 */
-		Assert(dead_items->max_items >= MaxHeapTuplesPerPage);
-		if (dead_items->max_items - dead_items->num_items < MaxHeapTuplesPerPage)
+		if (vac_dead_items_full(dead_items))
 		{
 			/*
 			 * Before beginning index vacuuming, we release any pin we may
@@ -956,6 +972,11 @@ lazy_scan_heap(LVRelState *vacrel)
 				ReleaseBuffer(vmbuffer);
 				vmbuffer = InvalidBuffer;
 			}
+			if (BufferIsValid(scanahead.vmbuffer))
+			{
+				ReleaseBuffer(scanahead.vmbuffer);
+				scanahead.vmbuffer = InvalidBuffer;
+			}
 
 			/* Perform a round of index and heap vacuuming */
 			vacrel->consider_bypass_optimization = false;
@@ -981,33 +1002,6 @@ lazy_scan_heap(LVRelState *vacrel)
 		 */
 		visibilitymap_pin(vacrel->rel, blkno, &vmbuffer);
 
-		if (vacrel->io_concurrency > 0)
-		{
-			/*
-			 * Prefetch io_concurrency blocks ahead
-			 */
-			uint32 prefetch_budget = vacrel->io_concurrency;
-
-			/* never trail behind the current scan */
-			if (next_prefetch_block < blkno)
-				next_prefetch_block = blkno;
-
-			/* but only up to the end of the relation */
-			if (prefetch_budget > rel_pages - next_prefetch_block)
-				prefetch_budget = rel_pages - next_prefetch_block;
-
-			/* And only up to io_concurrency ahead of the current vacuum scan */
-			if (next_prefetch_block + prefetch_budget > blkno + vacrel->io_concurrency)
-				prefetch_budget = blkno + vacrel->io_concurrency - next_prefetch_block;
-
-			/* And only up to the next unskippable block */
-			if (next_prefetch_block + prefetch_budget > next_unskippable_block)
-				prefetch_budget = next_unskippable_block - next_prefetch_block;
-
-			for (; prefetch_budget-- > 0; next_prefetch_block++)
-				PrefetchBuffer(vacrel->rel, MAIN_FORKNUM, next_prefetch_block);
-		}
-
 		/* Finished preparatory checks.  Actually scan the page. */
 		buf = ReadBufferExtended(vacrel->rel, MAIN_FORKNUM, blkno,
 								 RBM_NORMAL, vacrel->bstrategy);
@@ -1106,7 +1100,7 @@ lazy_scan_heap(LVRelState *vacrel)
 				lazy_vacuum_heap_page(vacrel, blkno, buf, 0, &vmbuffer);
 
 				/* Forget the LP_DEAD items that we just vacuumed */
-				dead_items->num_items = 0;
+				vac_dead_items_reset(dead_items);
 
 				/*
 				 * Periodically perform FSM vacuuming to make newly-freed
@@ -1275,8 +1269,10 @@ lazy_scan_heap(LVRelState *vacrel)
 	vacrel->blkno = InvalidBlockNumber;
 	if (BufferIsValid(vmbuffer))
 		ReleaseBuffer(vmbuffer);
+	lazy_scan_ahead_end(&scanahead);
 
 	/* report that everything is now scanned */
+	blkno = rel_pages;
 	pgstat_progress_update_param(PROGRESS_VACUUM_HEAP_BLKS_SCANNED, blkno);
 
 	/* now we can compute the new value for pg_class.reltuples */
@@ -1420,6 +1416,130 @@ lazy_scan_skip(LVRelState *vacrel, Buffer *vmbuffer, BlockNumber next_block,
 	return next_unskippable_block;
 }
 
+/*
+ *	lazy_scan_ahead_init() -- set up deciding which blocks to scan ahead.
+ *
+ * lazy_scan_heap() gets the blocks to scan from lazy_scan_next_block(), which
+ * decides with lazy_scan_skip() which blocks to skip up to io_concurrency
+ * scanned blocks ahead of the scan, and prefetches the blocks it decided to
+ * scan.  So the prefetches skip the same ranges as the scan, and continue
+ * past them, keeping up to io_concurrency reads of blocks that will actually
+ * be scanned in flight.
+ */
+static void
+lazy_scan_ahead_init(LVRelState *vacrel, LVScanAhead *scanahead)
+{
+	scanahead->vmbuffer = InvalidBuffer;
+	scanahead->next_block = 0;
+	scanahead->next_unskippable_block =
+		lazy_scan_skip(vacrel, &scanahead->vmbuffer, 0,
+					   &scanahead->next_unskippable_allvis,
+					   &scanahead->skipping_current_range);
+
+	/* the block being scanned, plus io_concurrency blocks to prefetch */
+	scanahead->depth = Max(vacrel->io_concurrency, 0) + 1;
+	scanahead->head = 0;
+	scanahead->count = 0;
+	scanahead->blocks = palloc(sizeof(BlockNumber) * scanahead->depth);
+	scanahead->allvis = palloc(sizeof(bool) * scanahead->depth);
+}
+
+/*
+ *	lazy_scan_next_block() -- get the next block lazy_scan_heap() must scan.
+ *
+ * Returns InvalidBlockNumber when there are no more blocks to scan.  The
+ * all-visible status of the block according to the visibility map is set in
+ * *all_visible_according_to_vm.
+ */
+static BlockNumber
+lazy_scan_next_block(LVRelState *vacrel, LVScanAhead *scanahead,
+					 bool *all_visible_according_to_vm)
+{
+	BlockNumber rel_pages = vacrel->rel_pages;
+	BlockNumber prefetch[PREFETCH_BATCH_SIZE];
+	int			nprefetch = 0;
+	BlockNumber blkno;
+
+	/* Decide on blocks until the ring buffer is full */
+	while (scanahead->count < scanahead->depth &&
+		   scanahead->next_block < rel_pages)
+	{
+		BlockNumber next_block = scanahead->next_block;
+		bool		allvis;
+
+		if (next_block == scanahead->next_unskippable_block)
+		{
+			/*
+			 * Can't skip this page safely.  Must scan the page.  But
+			 * determine the next skippable range after the page first.
+			 */
+			allvis = scanahead->next_unskippable_allvis;
+			scanahead->next_unskippable_block =
+				lazy_scan_skip(vacrel, &scanahead->vmbuffer, next_block + 1,
+							   &scanahead->next_unskippable_allvis,
+							   &scanahead->skipping_current_range);
+
+			Assert(scanahead->next_unskippable_block >= next_block + 1);
+		}
+		else
+		{
+			/* Last page always scanned (may need to set nonempty_pages) */
+			Assert(next_block < rel_pages - 1);
+
+			if (scanahead->skipping_current_range)
+			{
+				scanahead->next_block = scanahead->next_unskippable_block;
+				continue;
+			}
+
+			/* Current range is too small to skip -- just scan the page */
+			allvis = true;
+		}
+
+		scanahead->blocks[(scanahead->head + scanahead->count) %
+						  scanahead->depth] = next_block;
+		scanahead->allvis[(scanahead->head + scanahead->count) %
+						  scanahead->depth] = allvis;
+		scanahead->count++;
+		scanahead->next_block = next_block + 1;
+
+		/* The first block is read right away, no point prefetching it */
+		if (vacrel->io_concurrency > 0 && scanahead->count > 1)
+		{
+			prefetch[nprefetch++] = next_block;
+			if (nprefetch == PREFETCH_BATCH_SIZE)
+			{
+				PrefetchBuffers(vacrel->rel, MAIN_FORKNUM, prefetch, nprefetch);
+				nprefetch = 0;
+			}
+		}
+	}
+	if (nprefetch > 0)
+		PrefetchBuffers(vacrel->rel, MAIN_FORKNUM, prefetch, nprefetch);
+
+	if (scanahead->count == 0)
+		return InvalidBlockNumber;
+
+	blkno = scanahead->blocks[scanahead->head];
+	*all_visible_according_to_vm = scanahead->allvis[scanahead->head];
+	scanahead->head = (scanahead->head + 1) % scanahead->depth;
+	scanahead->count--;
+
+	return blkno;
+}
+
+/*
+ *	lazy_scan_ahead_end() -- release the resources of lazy_scan_next_block().
+ */
+static void
+lazy_scan_ahead_end(LVScanAhead *scanahead)
+{
+	if (BufferIsValid(scanahead->vmbuffer))
+		ReleaseBuffer(scanahead->vmbuffer);
+	pfree(scanahead->blocks);
+	pfree(scanahead->allvis);
+}
+
 /*
  *	lazy_scan_new_or_empty() -- lazy_scan_heap() new/empty page handling.
  *
@@ -1590,10 +1710,19 @@ lazy_scan_prune(LVRelState *vacrel,
 				recently_dead_tuples;
 	int			nnewlpdead;
 	int			nfrozen;
+	TransactionId frz_cutoff;
+	int			neager;
+	bool		eager_possible;
+	int64		fpi_before;
+	bool		prune_fpi;
+	bool		page_cold;
 	TransactionId NewRelfrozenXid;
 	MultiXactId NewRelminMxid;
+	TransactionId EagerRelfrozenXid;
+	MultiXactId EagerRelminMxid;
 	OffsetNumber deadoffsets[MaxHeapTuplesPerPage];
 	xl_heap_freeze_tuple frozen[MaxHeapTuplesPerPage];
+	xl_heap_freeze_tuple eager[MaxHeapTuplesPerPage];
 
 	Assert(BufferGetBlockNumber(buf) == blkno);
 
@@ -1604,11 +1733,16 @@ lazy_scan_prune(LVRelState *vacrel,
 	 */
 	maxoff = PageGetMaxOffsetNumber(page);
 
+	/* Note how long ago the page was last modified, before pruning does */
+	page_cold = PageGetLSN(page) < vacrel->EagerFreezeLSN;
+
 retry:
 
 	/* Initialize (or reset) page-level state */
 	NewRelfrozenXid = vacrel->NewRelfrozenXid;
 	NewRelminMxid = vacrel->NewRelminMxid;
+	EagerRelfrozenXid = vacrel->NewRelfrozenXid;
+	EagerRelminMxid = vacrel->NewRelminMxid;
 	tuples_deleted = 0;
 	lpdead_items = 0;
 	live_tuples = 0;
@@ -1623,9 +1757,11 @@ retry:
 	 * lpdead_items's final value can be thought of as the number of tuples
 	 * that were deleted from indexes.
 	 */
+	fpi_before = pgWalUsage.wal_fpi;
 	tuples_deleted = heap_page_prune(rel, buf, vacrel->vistest,
 									 InvalidTransactionId, 0, &nnewlpdead,
 									 &vacrel->offnum);
+	prune_fpi = (pgWalUsage.wal_fpi != fpi_before);
 
 	/*
 	 * Now scan the page to collect LP_DEAD items and check for tuples
@@ -1637,6 +1773,9 @@ retry:
 	prunestate->all_frozen = true;
 	prunestate->visibility_cutoff_xid = InvalidTransactionId;
 	nfrozen = 0;
+	frz_cutoff = vacrel->FreezeLimit;
+	neager = 0;
+	eager_possible = true;
 
 	for (offnum = FirstOffsetNumber;
 		 offnum <= maxoff;
@@ -1828,10 +1967,71 @@ retry:
 		 */
 		if (!tuple_totally_frozen)
 			prunestate->all_frozen = false;
+
+		/*
+		 * As long as the page can still turn out all-visible, also work out
+		 * how to freeze all of it, using OldestXmin as the cutoff.  Tuples
+		 * with a MultiXact xmax are left to the regular rules, as freezing
+		 * them could require creating a new MultiXact.
+		 */
+		if (prunestate->all_visible && eager_possible)
+		{
+			bool		tuple_eager_frozen;
+
+			if (tuple.t_data->t_infomask & HEAP_XMAX_IS_MULTI)
+				eager_possible = false;
+			else
+			{
+				if (heap_prepare_freeze_tuple(tuple.t_data,
+											  vacrel->relfrozenxid,
+											  vacrel->relminmxid,
+											  vacrel->OldestXmin,
+											  vacrel->MultiXactCutoff,
+											  &eager[neager],
+											  &tuple_eager_frozen,
+											  &EagerRelfrozenXid,
+											  &EagerRelminMxid))
+					eager[neager++].offset = offnum;
+
+				if (!tuple_eager_frozen)
+					eager_possible = false;
+			}
+		}
 	}
 
 	vacrel->offnum = InvalidOffsetNumber;
 
+	/*
+	 * Freeze the whole page now, rather than only the tuples older than
+	 * FreezeLimit, if it is all-visible and that makes it all-frozen, and
+	 * doing so is cheap or likely to pay off.  It is cheap if some tuples
+	 * must be frozen anyway, or if pruning has just written a full-page image
+	 * of it, so that the freeze record won't need another one.  It is likely
+	 * to pay off if the page was last modified long ago, see EagerFreezeLSN.
+	 * Otherwise, an append-mostly table gets frozen only by a much later
+	 * aggressive VACUUM, which has to dirty and log every page of it again.
+	 */
+	if (prunestate->all_visible && eager_possible && neager > nfrozen &&
+		(nfrozen > 0 || prune_fpi || page_cold))
+	{
+		memcpy(frozen, eager, sizeof(xl_heap_freeze_tuple) * neager);
+		nfrozen = neager;
+		NewRelfrozenXid = EagerRelfrozenXid;
+		NewRelminMxid = EagerRelminMxid;
+		prunestate->all_frozen = true;
+
+		/*
+		 * Tuples newer than FreezeLimit are frozen too, so standby queries
+		 * that might not see the newest of them as committed must conflict.
+		 */
+		if (TransactionIdFollowsOrEquals(prunestate->visibility_cutoff_xid,
+										 frz_cutoff))
+		{
+			frz_cutoff = prunestate->visibility_cutoff_xid;
+			TransactionIdAdvance(frz_cutoff);
+		}
+	}
+
 	/*
 	 * We have now divided every item on the page into either an LP_DEAD item
 	 * that will need to be vacuumed in indexes later, or a LP_NORMAL tuple
@@ -1877,7 +2077,7 @@ retry:
 		{
 			XLogRecPtr	recptr;
 
-			recptr = log_heap_freeze(vacrel->rel, buf, vacrel->FreezeLimit,
+			recptr = log_heap_freeze(vacrel->rel, buf, frz_cutoff,
 									 frozen, nfrozen);
 			PageSetLSN(page, recptr);
 		}
@@ -1928,22 +2128,14 @@ retry:
 	if (lpdead_items > 0)
 	{
 		VacDeadItems *dead_items = vacrel->dead_items;
-		ItemPointerData tmp;
 
 		Assert(!prunestate->all_visible);
 		Assert(prunestate->has_lpdead_items);
 
 		vacrel->lpdead_item_pages++;
 
-		ItemPointerSetBlockNumber(&tmp, blkno);
+		vac_dead_items_add(dead_items, blkno, deadoffsets, lpdead_items);
 
-		for (int i = 0; i < lpdead_items; i++)
-		{
-			ItemPointerSetOffsetNumber(&tmp, deadoffsets[i]);
-			dead_items->items[dead_items->num_items++] = tmp;
-		}
-
-		Assert(dead_items->num_items <= dead_items->max_items);
 		pgstat_progress_update_param(PROGRESS_VACUUM_NUM_DEAD_TUPLES,
 									 dead_items->num_items);
 	}
@@ -2152,7 +2344,6 @@ lazy_scan_noprune(LVRelState *vacrel,
 	else
 	{
 		VacDeadItems *dead_items = vacrel->dead_items;
-		ItemPointerData tmp;
 
 		/*
 		 * Page has LP_DEAD items, and so any references/TIDs that remain in
@@ -2161,15 +2352,8 @@ lazy_scan_noprune(LVRelState *vacrel,
 		 */
 		vacrel->lpdead_item_pages++;
 
-		ItemPointerSetBlockNumber(&tmp, blkno);
-
-		for (int i = 0; i < lpdead_items; i++)
-		{
-			ItemPointerSetOffsetNumber(&tmp, deadoffsets[i]);
-			dead_items->items[dead_items->num_items++] = tmp;
-		}
+		vac_dead_items_add(dead_items, blkno, deadoffsets, lpdead_items);
 
-		Assert(dead_items->num_items <= dead_items->max_items);
 		pgstat_progress_update_param(PROGRESS_VACUUM_NUM_DEAD_TUPLES,
 									 dead_items->num_items);
 
@@ -2220,7 +2404,7 @@ lazy_vacuum(LVRelState *vacrel)
 	if (!vacrel->do_index_vacuuming)
 	{
 		Assert(!vacrel->do_index_cleanup);
-		vacrel->dead_items->num_items = 0;
+		vac_dead_items_reset(vacrel->dead_items);
 		return;
 	}
 
@@ -2277,7 +2461,8 @@ lazy_vacuum(LVRelState *vacrel)
 		 */
 		threshold = (double) vacrel->rel_pages * BYPASS_THRESHOLD_PAGES;
 		bypass = (vacrel->lpdead_item_pages < threshold &&
-				  vacrel->lpdead_items < MAXDEADITEMS(32L * 1024L * 1024L));
+				  vac_dead_items_used_size(vacrel->dead_items) <
+				  32L * 1024L * 1024L);
 	}
 
 	if (bypass)
@@ -2322,7 +2507,7 @@ lazy_vacuum(LVRelState *vacrel)
 	 * Forget the LP_DEAD items that we just vacuumed (or just decided to not
 	 * vacuum)
 	 */
-	vacrel->dead_items->num_items = 0;
+	vac_dead_items_reset(vacrel->dead_items);
 }
 
 /*
@@ -2431,8 +2616,11 @@ lazy_vacuum_all_indexes(LVRelState *vacrel)
 static void
 lazy_vacuum_heap_rel(LVRelState *vacrel)
 {
-	int			index,
-				pindex;
+	VacDeadItems *dead_items = vacrel->dead_items;
+	int			blockidx,
+				pblockidx,
+				nprefetched;
+	int64		vacuumed_items;
 	BlockNumber vacuumed_pages;
 	Buffer		vmbuffer = InvalidBuffer;
 	LVSavedErrInfo saved_err_info;
@@ -2451,10 +2639,11 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 							 InvalidBlockNumber, InvalidOffsetNumber);
 
 	vacuumed_pages = 0;
+	vacuumed_items = 0;
 
-	index = 0;
-	pindex = 0;
-	while (index < vacrel->dead_items->num_items)
+	pblockidx = 0;
+	nprefetched = 0;
+	for (blockidx = 0; blockidx < dead_items->num_blocks; blockidx++)
 	{
 		BlockNumber tblk;
 		Buffer		buf;
@@ -2463,54 +2652,47 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 
 		vacuum_delay_point();
 
-		tblk = ItemPointerGetBlockNumber(&vacrel->dead_items->items[index]);
+		tblk = vac_dead_items_get_block(dead_items, blockidx);
 
+		/*
+		 * Prefetch the blocks of the dead items that follow, keeping
+		 * io_concurrency blocks ahead of the one we vacuum now.  pblockidx
+		 * is the next block to prefetch, and nprefetched the number of
+		 * blocks prefetched but not yet vacuumed.
+		 */
 		if (vacrel->io_concurrency > 0)
 		{
-			/*
-			 * If we're just starting out, prefetch N consecutive blocks.
-			 * If not, only the next 1 block
-			 */
-			if (pindex == 0)
-			{
-				int prefetch_budget = Min(vacrel->dead_items->num_items,
-										  Min(vacrel->rel_pages,
-											  vacrel->io_concurrency));
-				BlockNumber prev_prefetch = ItemPointerGetBlockNumber(&vacrel->dead_items->items[pindex]);
-				PrefetchBuffer(vacrel->rel, MAIN_FORKNUM, prev_prefetch);
-
-				while (++pindex < vacrel->dead_items->num_items &&
-					   prefetch_budget > 0)
-				{
-					ItemPointer ptr = &vacrel->dead_items->items[pindex];
-					if (ItemPointerGetBlockNumber(ptr) != prev_prefetch)
-					{
-						prev_prefetch = ItemPointerGetBlockNumber(ptr);
-						prefetch_budget -= 1;
-						PrefetchBuffer(vacrel->rel, MAIN_FORKNUM, prev_prefetch);
-					}
-				}
-			}
-			else if (pindex < vacrel->dead_items->num_items)
+			BlockNumber prefetch[PREFETCH_BATCH_SIZE];
+			int			nprefetch = 0;
+
+			if (pblockidx > blockidx)
+				nprefetched--;	/* this block was prefetched */
+			else
+				pblockidx = blockidx + 1;	/* no use prefetching this one */
+
+			while (nprefetched < vacrel->io_concurrency &&
+				   pblockidx < dead_items->num_blocks)
 			{
-				BlockNumber previous = ItemPointerGetBlockNumber(&vacrel->dead_items->items[pindex]);
-				while (++pindex < vacrel->dead_items->num_items)
+				prefetch[nprefetch++] = vac_dead_items_get_block(dead_items,
+																 pblockidx++);
+				nprefetched++;
+				if (nprefetch == PREFETCH_BATCH_SIZE)
 				{
-					BlockNumber toPrefetch = ItemPointerGetBlockNumber(&vacrel->dead_items->items[pindex]);
-					if (previous != toPrefetch)
-					{
-						PrefetchBuffer(vacrel->rel, MAIN_FORKNUM, toPrefetch);
-						break;
-					}
+					PrefetchBuffers(vacrel->rel, MAIN_FORKNUM, prefetch,
+									nprefetch);
+					nprefetch = 0;
 				}
 			}
+			if (nprefetch > 0)
+				PrefetchBuffers(vacrel->rel, MAIN_FORKNUM, prefetch, nprefetch);
 		}
 
 		vacrel->blkno = tblk;
 		buf = ReadBufferExtended(vacrel->rel, MAIN_FORKNUM, tblk, RBM_NORMAL,
 								 vacrel->bstrategy);
 		LockBuffer(buf, BUFFER_LOCK_EXCLUSIVE);
-		index = lazy_vacuum_heap_page(vacrel, tblk, buf, index, &vmbuffer);
+		vacuumed_items += lazy_vacuum_heap_page(vacrel, tblk, buf, blockidx,
+												&vmbuffer);
 
 		/* Now that we've vacuumed the page, record its available space */
 		page = BufferGetPage(buf);
@@ -2534,14 +2716,15 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
 	 * We set all LP_DEAD items from the first heap pass to LP_UNUSED during
 	 * the second heap pass.  No more, no less.
 	 */
-	Assert(index > 0);
+	Assert(vacuumed_items > 0);
 	Assert(vacrel->num_index_scans > 1 ||
-		   (index == vacrel->lpdead_items &&
+		   (vacuumed_items == vacrel->lpdead_items &&
 			vacuumed_pages == vacrel->lpdead_item_pages));
 
 	ereport(DEBUG2,
 			(errmsg("table \"%s\": removed %lld dead item identifiers in %u pages",
-					vacrel->relname, (long long) index, vacuumed_pages)));
+					vacrel->relname, (long long) vacuumed_items,
+					vacuumed_pages)));
 
 	/* Revert to the previous phase information for error traceback */
 	restore_vacuum_error_info(vacrel, &saved_err_info);
@@ -2554,18 +2737,17 @@ lazy_vacuum_heap_rel(LVRelState *vacrel)
  * Caller must have an exclusive buffer lock on the buffer (though a full
  * cleanup lock is also acceptable).
  *
- * index is an offset into the vacrel->dead_items array for the first listed
- * LP_DEAD item on the page.  The return value is the first index immediately
- * after all LP_DEAD items for the same page in the array.
+ * blockidx is the index of the page among the blocks in vacrel->dead_items.
+ * The return value is the number of LP_DEAD items freed.
  */
 static int
 lazy_vacuum_heap_page(LVRelState *vacrel, BlockNumber blkno, Buffer buffer,
-					  int index, Buffer *vmbuffer)
+					  int blockidx, Buffer *vmbuffer)
 {
 	VacDeadItems *dead_items = vacrel->dead_items;
 	Page		page = BufferGetPage(buffer);
 	OffsetNumber unused[MaxHeapTuplesPerPage];
-	int			uncnt = 0;
+	int			uncnt;
 	TransactionId visibility_cutoff_xid;
 	bool		all_frozen;
 	LVSavedErrInfo saved_err_info;
@@ -2579,23 +2761,17 @@ lazy_vacuum_heap_page(LVRelState *vacrel, BlockNumber blkno, Buffer buffer,
 							 VACUUM_ERRCB_PHASE_VACUUM_HEAP, blkno,
 							 InvalidOffsetNumber);
 
+	Assert(vac_dead_items_get_block(dead_items, blockidx) == blkno);
+	uncnt = vac_dead_items_get_offsets(dead_items, blockidx, unused);
+
 	START_CRIT_SECTION();
 
-	for (; index < dead_items->num_items; index++)
+	for (int i = 0; i < uncnt; i++)
 	{
-		BlockNumber tblk;
-		OffsetNumber toff;
-		ItemId		itemid;
-
-		tblk = ItemPointerGetBlockNumber(&dead_items->items[index]);
-		if (tblk != blkno)
-			break;				/* past end of tuples for this block */
-		toff = ItemPointerGetOffsetNumber(&dead_items->items[index]);
-		itemid = PageGetItemId(page, toff);
+		ItemId		itemid = PageGetItemId(page, unused[i]);
 
 		Assert(ItemIdIsDead(itemid) && !ItemIdHasStorage(itemid));
 		ItemIdSetUnused(itemid);
-		unused[uncnt++] = toff;
 	}
 
 	Assert(uncnt > 0);
@@ -2670,7 +2846,7 @@ lazy_vacuum_heap_page(LVRelState *vacrel, BlockNumber blkno, Buffer buffer,
 
 	/* Revert to the previous phase information for error traceback */
 	restore_vacuum_error_info(vacrel, &saved_err_info);
-	return index;
+	return uncnt;
 }
 
 /*
@@ -3173,17 +3349,17 @@ count_nondeletable_pages(LVRelState *vacrel, bool *lock_waiter_detected)
 }
 
 /*
- * Returns the number of dead TIDs that VACUUM should allocate space to
- * store, given a heap rel of size vacrel->rel_pages, and given current
- * maintenance_work_mem setting (or current autovacuum_work_mem setting,
- * when applicable).
+ * Returns the number of VacDeadItems slots that VACUUM should allocate to
+ * store dead TIDs, given a heap rel of size vacrel->rel_pages, and given
+ * current maintenance_work_mem setting (or current autovacuum_work_mem
+ * setting, when applicable).
  *
  * See the comments at the head of this file for rationale.
  */
 static int
-dead_items_max_items(LVRelState *vacrel)
+dead_items_max_slots(LVRelState *vacrel)
 {
-	int64		max_items;
+	int64		max_slots;
 	int			vac_work_mem = IsAutoVacuumWorkerProcess() &&
 	autovacuum_work_mem != -1 ?
 	autovacuum_work_mem : maintenance_work_mem;
@@ -3192,24 +3368,24 @@ dead_items_max_items(LVRelState *vacrel)
 	{
 		BlockNumber rel_pages = vacrel->rel_pages;
 
-		max_items = MAXDEADITEMS(vac_work_mem * 1024L);
-		max_items = Min(max_items, INT_MAX);
-		max_items = Min(max_items, MAXDEADITEMS(MaxAllocSize));
+		max_slots = MAXDEADSLOTS(vac_work_mem * 1024L);
+		max_slots = Min(max_slots, INT_MAX);
+		max_slots = Min(max_slots, MAXDEADSLOTS(MaxAllocSize));
 
 		/* curious coding here to ensure the multiplication can't overflow */
-		if ((BlockNumber) (max_items / MaxHeapTuplesPerPage) > rel_pages)
-			max_items = rel_pages * MaxHeapTuplesPerPage;
+		if ((BlockNumber) (max_slots / VAC_DEAD_BLOCK_MAX_SLOTS) > rel_pages)
+			max_slots = rel_pages * VAC_DEAD_BLOCK_MAX_SLOTS;
 
 		/* stay sane if small maintenance_work_mem */
-		max_items = Max(max_items, MaxHeapTuplesPerPage);
+		max_slots = Max(max_slots, VAC_DEAD_BLOCK_MAX_SLOTS);
 	}
 	else
 	{
 		/* One-pass case only stores a single heap page's TIDs at a time */
-		max_items = MaxHeapTuplesPerPage;
+		max_slots = VAC_DEAD_BLOCK_MAX_SLOTS;
 	}
 
-	return (int) max_items;
+	return (int) max_slots;
 }
 
 /*
@@ -3223,10 +3399,10 @@ static void
 dead_items_alloc(LVRelState *vacrel, int nworkers)
 {
 	VacDeadItems *dead_items;
-	int			max_items;
+	int			max_slots;
 
-	max_items = dead_items_max_items(vacrel);
-	Assert(max_items >= MaxHeapTuplesPerPage);
+	max_slots = dead_items_max_slots(vacrel);
+	Assert(max_slots >= VAC_DEAD_BLOCK_MAX_SLOTS);
 
 	/*
 	 * Initialize state for a parallel vacuum.  As of now, only one worker can
@@ -3253,7 +3429,7 @@ dead_items_alloc(LVRelState *vacrel, int nworkers)
 		else
 			vacrel->pvs = parallel_vacuum_init(vacrel->rel, vacrel->indrels,
 											   vacrel->nindexes, nworkers,
-											   max_items,
+											   max_slots,
 											   vacrel->verbose ? INFO : DEBUG2,
 											   vacrel->bstrategy);
 
@@ -3266,9 +3442,8 @@ dead_items_alloc(LVRelState *vacrel, int nworkers)
 	}
 
 	/* Serial VACUUM case */
-	dead_items = (VacDeadItems *) palloc(vac_max_items_to_alloc_size(max_items));
-	dead_items->max_items = max_items;
-	dead_items->num_items = 0;
+	dead_items = (VacDeadItems *) palloc(vac_max_slots_to_alloc_size(max_slots));
+	vac_dead_items_init(dead_items, max_slots);
 
 	vacrel->dead_items = dead_items;
 }
@@ -16,6 +16,8 @@
  *		visibilitymap_pin_ok - check whether correct map page is already pinned
  *		visibilitymap_set	 - set a bit in a previously pinned page
  *		visibilitymap_get_status - get status of bits
+ *		visibilitymap_prefetch_before_read - prefetch the heap blocks a
+ *			scan skipping blocks by their bits is about to read
  *		visibilitymap_count  - count number of bits set in visibility map
  *		visibilitymap_prepare_truncate -
  *			prepare for truncation of the visibility map
@@ -96,6 +98,7 @@
 #include "storage/lmgr.h"
 #include "storage/smgr.h"
 #include "utils/inval.h"
+#include "utils/spccache.h"
 
 
 /*#define TRACE_VISIBILITYMAP */
@@ -127,6 +130,7 @@
 /* prototypes for internal routines */
 static Buffer vm_readbuf(Relation rel, BlockNumber blkno, bool extend);
 static void vm_extend(Relation rel, BlockNumber vm_nblocks);
+static BlockNumber vm_prefetch(Relation rel, BlockNumber start);
 
 
 /*
@@ -370,6 +374,135 @@ visibilitymap_get_status(Relation rel, BlockNumber heapBlk, Buffer *buf)
 	return result;
 }
 
+/*
+ *	visibilitymap_cache_init - initialize a cache of visibility map pages
+ */
+void
+visibilitymap_cache_init(VMBufferCache *cache)
+{
+	for (int i = 0; i < VM_BUFFER_CACHE_SIZE; i++)
+		cache->buffers[i] = InvalidBuffer;
+}
+
+/*
+ *	visibilitymap_get_status_cached - get status of bits
+ *
+ * Like visibilitymap_get_status, but keeps the map page pinned in 'cache'
+ * instead of a single buffer.  The same caveats about concurrency apply.
+ */
+uint8
+visibilitymap_get_status_cached(Relation rel, BlockNumber heapBlk,
+								VMBufferCache *cache)
+{
+	BlockNumber mapBlock = HEAPBLK_TO_MAPBLOCK(heapBlk);
+
+	return visibilitymap_get_status(rel, heapBlk,
+									&cache->buffers[mapBlock % VM_BUFFER_CACHE_SIZE]);
+}
+
+/*
+ *	visibilitymap_cache_release - release the pins held by a cache
+ */
+void
+visibilitymap_cache_release(VMBufferCache *cache)
+{
+	for (int i = 0; i < VM_BUFFER_CACHE_SIZE; i++)
+	{
+		if (BufferIsValid(cache->buffers[i]))
+		{
+			ReleaseBuffer(cache->buffers[i]);
+			cache->buffers[i] = InvalidBuffer;
+		}
+	}
+}
+
+/*
+ *	visibilitymap_prefetch_init - set up prefetching for a scan of rel
+ *
+ * The scan reads the blocks with one of the bits in vmflags set, or with
+ * none of them set if skip_if_set, or every block if vmflags is 0.  The
+ * window size follows maintenance_io_concurrency for the relation's
+ * tablespace, as for ANALYZE.
+ */
+void
+visibilitymap_prefetch_init(VMPrefetchState *ps, Relation rel, uint8 vmflags,
+							bool skip_if_set)
+{
+	ps->maximum = 0;
+#ifdef USE_PREFETCH
+	ps->maximum = get_tablespace_maintenance_io_concurrency(rel->rd_rel->reltablespace);
+#endif
+	ps->pending = 0;
+	ps->next = 0;
+	ps->vmflags = vmflags;
+	ps->skip_if_set = skip_if_set;
+	ps->vmbuffer = InvalidBuffer;
+	ps->blocks = ps->maximum > 0 ? palloc(ps->maximum * sizeof(BlockNumber)) : NULL;
+}
+
+/*
+ *	visibilitymap_prefetch_before_read - called just before the scan reads
+ *		heap block blkno
+ *
+ * Accounts for that block, and if at least half of the window has been
+ * consumed, prefetches the next blocks the scan is going to read.
+ *
+ * The VM bits may change between the look-ahead and the actual read, so the
+ * scan may end up skipping a block we prefetched or reading one we didn't.
+ * Either way the only cost is a wasted or missed prefetch.
+ */
+void
+visibilitymap_prefetch_before_read(VMPrefetchState *ps, Relation rel,
+								   BlockNumber blkno, BlockNumber nblocks)
+{
+	int			nprefetch = 0;
+
+	if (ps->maximum <= 0)
+		return;
+
+	if (blkno < ps->next && ps->pending > 0)
+		ps->pending--;
+
+	if (ps->pending > ps->maximum / 2 || ps->next >= nblocks)
+		return;
+
+	ps->next = Max(ps->next, blkno + 1);
+	while (ps->pending + nprefetch < ps->maximum && ps->next < nblocks)
+	{
+		BlockNumber candidate = ps->next++;
+
+		if (ps->vmflags != 0)
+		{
+			bool		set;
+
+			set = (visibilitymap_get_status(rel, candidate, &ps->vmbuffer) &
+				   ps->vmflags) != 0;
+			if (set == ps->skip_if_set)
+				continue;
+		}
+
+		ps->blocks[nprefetch++] = candidate;
+	}
+
+	if (nprefetch > 0)
+	{
+		PrefetchBuffers(rel, MAIN_FORKNUM, ps->blocks, nprefetch);
+		ps->pending += nprefetch;
+	}
+}
+
+/*
+ *	visibilitymap_prefetch_end - release resources held by the prefetch state
+ */
+void
+visibilitymap_prefetch_end(VMPrefetchState *ps)
+{
+	if (BufferIsValid(ps->vmbuffer))
+		ReleaseBuffer(ps->vmbuffer);
+	if (ps->blocks)
+		pfree(ps->blocks);
+}
+
 /*
  *	visibilitymap_count  - count number of bits set in visibility map
  *
@@ -383,6 +516,7 @@ visibilitymap_count(Relation rel, BlockNumber *all_visible, BlockNumber *all_fro
 	BlockNumber mapBlock;
 	BlockNumber nvisible = 0;
 	BlockNumber nfrozen = 0;
+	BlockNumber prefetched = 0;
 
 	/* all_visible must be specified */
 	Assert(all_visible);
@@ -393,6 +527,14 @@ visibilitymap_count(Relation rel, BlockNumber *all_visible, BlockNumber *all_fro
 		uint64	   *map;
 		int			i;
 
+		/*
+		 * We are going to read the whole map, so ask for it in batches
+		 * rather than waiting for the pages one at a time.  vm_readbuf()
+		 * has cached the size of the map by the time we get here.
+		 */
+		if (mapBlock == prefetched && mapBlock > 0)
+			prefetched = vm_prefetch(rel, mapBlock);
+
 		/*
 		 * Read till we fall off the end of the map.  We assume that any extra
 		 * bytes in the last page are zeroed, so we don't bother excluding
@@ -401,6 +543,8 @@ visibilitymap_count(Relation rel, BlockNumber *all_visible, BlockNumber *all_fro
 		mapBuffer = vm_readbuf(rel, mapBlock, false);
 		if (!BufferIsValid(mapBuffer))
 			break;
+		if (mapBlock == 0)
+			prefetched = vm_prefetch(rel, 1);
 
 		/*
 		 * We choose not to lock the page, since the result is going to be
@@ -609,6 +753,34 @@ vm_readbuf(Relation rel, BlockNumber blkno, bool extend)
 	return buf;
 }
 
+/*
+ * Prefetch a batch of visibility map pages starting at 'start', stopping at
+ * the end of the map as of the last time its size was checked.
+ *
+ * Returns the block after the last one prefetched.
+ */
+static BlockNumber
+vm_prefetch(Relation rel, BlockNumber start)
+{
+	BlockNumber blocks[PREFETCH_BATCH_SIZE];
+	BlockNumber nblocks;
+	int			n = 0;
+
+	nblocks = RelationGetSmgr(rel)->smgr_cached_nblocks[VISIBILITYMAP_FORKNUM];
+	if (nblocks == InvalidBlockNumber)
+		return start;
+
+	while (n < PREFETCH_BATCH_SIZE && start + n < nblocks)
+	{
+		blocks[n] = start + n;
+		n++;
+	}
+	if (n > 0)
+		PrefetchBuffers(rel, VISIBILITYMAP_FORKNUM, blocks, n);
+
+	return start + n;
+}
+
 /*
  * Ensure that the visibility map fork is at least vm_nblocks long, extending
  * it if necessary with zeroed pages.
@@ -20,6 +20,9 @@
  *		index_insert	- insert an index tuple into a relation
  *		index_markpos	- mark a scan position
  *		index_restrpos	- restore a scan position
+ *		index_prefetch	- prefetch the pages of an upcoming scan
+ *		index_prefetch_maximum - prefetch distance limit for a relation
+ *		index_heap_prefetch_rescan - set up heap prefetching for a scan
  *		index_parallelscan_estimate - estimate shared memory for parallel scan
  *		index_parallelscan_initialize - initialize parallel scan
  *		index_parallelrescan  - (re)start a parallel scan of an index
@@ -50,17 +53,21 @@
 #include "access/tableam.h"
 #include "access/transam.h"
 #include "access/xlog.h"
+#include "catalog/catalog.h"
 #include "catalog/index.h"
 #include "catalog/pg_amproc.h"
 #include "catalog/pg_type.h"
 #include "commands/defrem.h"
 #include "nodes/makefuncs.h"
+#include "optimizer/cost.h"
 #include "pgstat.h"
 #include "storage/bufmgr.h"
 #include "storage/lmgr.h"
 #include "storage/predicate.h"
+#include "storage/prefetch.h"
 #include "utils/ruleutils.h"
 #include "utils/snapmgr.h"
+#include "utils/spccache.h"
 #include "utils/syscache.h"
 
 
@@ -391,6 +398,71 @@ index_restrpos(IndexScanDesc scan)
 	scan->indexRelation->rd_indam->amrestrpos(scan);
 }
 
+/* ----------------
+ *		index_prefetch	- prefetch the pages of an upcoming scan
+ *
+ * Prefetch the index pages that a scan with the given keys will start on,
+ * and if nheappages is positive, the heap pages of up to that many of the
+ * tuples it will return.  This is only a hint: index AMs that don't
+ * support it, and keys that the AM can't deal with, are silently ignored.
+ * ----------------
+ */
+void
+index_prefetch(Relation indexRelation, Relation heapRelation,
+			   ScanKey keys, int nkeys, Snapshot snapshot, int nheappages)
+{
+	RELATION_CHECKS;
+
+	if (indexRelation->rd_indam->amprefetch == NULL)
+		return;
+
+	indexRelation->rd_indam->amprefetch(indexRelation, heapRelation,
+										keys, nkeys, snapshot, nheappages);
+}
+
+/* ----------------
+ *		index_prefetch_maximum - prefetch distance limit for a relation
+ *
+ * Index AMs use this as the maximum distance when prefetching the pages of
+ * the index or the heap.
+ * ----------------
+ */
+int
+index_prefetch_maximum(Relation relation)
+{
+	if (IsCatalogRelation(relation))
+		return effective_io_concurrency;
+
+	return get_tablespace_io_concurrency(relation->rd_rel->reltablespace);
+}
+
+/* ----------------
+ *		index_heap_prefetch_rescan - set up heap prefetching for a scan
+ *
+ * For index AMs that prefetch the heap pages of the tuples they are about to
+ * return with a PrefetchQueue.  To be called from amrescan, as the heap
+ * relation isn't known yet in ambeginscan; a rescan starts with what the
+ * previous scans learned about the prefetch distance.  Prefetching is
+ * disabled for bitmap scans, which prefetch the heap pages themselves, and
+ * for index-only scans, which mostly don't visit the heap.
+ * ----------------
+ */
+void
+index_heap_prefetch_rescan(IndexScanDesc scan, PrefetchQueue *pq)
+{
+	Relation	heapRelation = scan->heapRelation;
+	int			maximum = 0;
+
+	if (enable_indexscan_prefetch && heapRelation != NULL &&
+		!scan->xs_want_itup)
+		maximum = index_prefetch_maximum(heapRelation);
+
+	if (pq->rel == heapRelation && pq->ctl.maximum == maximum)
+		PrefetchQueueRestart(pq);
+	else
+		PrefetchQueueInit(pq, heapRelation, maximum, 1);
+}
+
 /*
  * index_parallelscan_estimate - estimate shared memory for parallel scan
  *
@@ -21,6 +21,7 @@
 #include "access/nbtree.h"
 #include "access/nbtxlog.h"
 #include "access/relscan.h"
+#include "access/visibilitymap.h"
 #include "access/xlog.h"
 #include "access/xloginsert.h"
 #include "commands/progress.h"
@@ -72,6 +73,8 @@ typedef struct BTParallelScanDescData
 									 * possible states of parallel scan. */
 	int			btps_arrayKeyCount; /* count indicating number of array scan
 									 * keys processed by parallel scan */
+	uint32		btps_pagesScanned;	/* number of pages handed on so far, used
+									 * to pace leaf page prefetching */
 	slock_t		btps_mutex;		/* protects above variables */
 	ConditionVariable btps_cv;	/* used to synchronize parallel scan */
 }			BTParallelScanDescData;
@@ -115,6 +118,7 @@ bthandler(PG_FUNCTION_ARGS)
 	amroutine->amcanparallel = true;
 	amroutine->amcaninclude = true;
 	amroutine->amusemaintenanceworkmem = false;
+	amroutine->amsummarizing = false;
 	amroutine->amparallelvacuumoptions =
 		VACUUM_OPTION_PARALLEL_BULKDEL | VACUUM_OPTION_PARALLEL_COND_CLEANUP;
 	amroutine->amkeytype = InvalidOid;
@@ -138,6 +142,7 @@ bthandler(PG_FUNCTION_ARGS)
 	amroutine->amendscan = btendscan;
 	amroutine->ammarkpos = btmarkpos;
 	amroutine->amrestrpos = btrestrpos;
+	amroutine->amprefetch = btprefetch;
 	amroutine->amestimateparallelscan = btestimateparallelscan;
 	amroutine->aminitparallelscan = btinitparallelscan;
 	amroutine->amparallelrescan = btparallelrescan;
@@ -222,13 +227,14 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 	 * scan.  We can't do this in btrescan because we don't know the scan
 	 * direction at that time.
 	 */
-	if (so->numArrayKeys && !BTScanPosIsValid(so->currPos))
+	if (BTScanHasArrayKeys(so) && !BTScanPosIsValid(so->currPos))
 	{
 		/* punt if we have any unsatisfiable array keys */
 		if (so->numArrayKeys < 0)
 			return false;
 
-		_bt_start_array_keys(scan, dir);
+		if (!_bt_start_array_keys(scan, dir))
+			return false;
 	}
 
 	/* This loop handles advancing to the next array elements, if any */
@@ -274,7 +280,7 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 		if (res)
 			break;
 		/* ... otherwise see if we have more array keys to deal with */
-	} while (so->numArrayKeys && _bt_advance_array_keys(scan, dir));
+	} while (BTScanHasArrayKeys(so) && _bt_advance_array_keys(scan, dir));
 
 	return res;
 }
@@ -292,13 +298,14 @@ btgetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 	/*
 	 * If we have any array keys, initialize them.
 	 */
-	if (so->numArrayKeys)
+	if (BTScanHasArrayKeys(so))
 	{
 		/* punt if we have any unsatisfiable array keys */
 		if (so->numArrayKeys < 0)
 			return ntids;
 
-		_bt_start_array_keys(scan, ForwardScanDirection);
+		if (!_bt_start_array_keys(scan, ForwardScanDirection))
+			return ntids;
 	}
 
 	/* This loop handles advancing to the next array elements, if any */
@@ -332,7 +339,8 @@ btgetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 			}
 		}
 		/* Now see if we have more array keys to deal with */
-	} while (so->numArrayKeys && _bt_advance_array_keys(scan, ForwardScanDirection));
+	} while (BTScanHasArrayKeys(so) &&
+			 _bt_advance_array_keys(scan, ForwardScanDirection));
 
 	return ntids;
 }
@@ -356,8 +364,10 @@ btbeginscan(Relation rel, int nkeys, int norderbys)
 	so = (BTScanOpaque) palloc(sizeof(BTScanOpaqueData));
 	BTScanPosInvalidate(so->currPos);
 	BTScanPosInvalidate(so->markPos);
+	/* leave room for a skip scan key, see _bt_preprocess_array_keys */
 	if (scan->numberOfKeys > 0)
-		so->keyData = (ScanKey) palloc(scan->numberOfKeys * sizeof(ScanKeyData));
+		so->keyData = (ScanKey) palloc((scan->numberOfKeys + 1) *
+									   sizeof(ScanKeyData));
 	else
 		so->keyData = NULL;
 
@@ -365,10 +375,16 @@ btbeginscan(Relation rel, int nkeys, int norderbys)
 	so->numArrayKeys = 0;
 	so->arrayKeys = NULL;
 	so->arrayContext = NULL;
+	so->lastLeafPage = InvalidBlockNumber;
+	so->skipKey = NULL;
 
 	so->killedItems = NULL;		/* until needed */
 	so->numKilled = 0;
 	so->prefetch_maximum = 0;   /* disable prefetch */
+	PrefetchControlInit(&so->prefetch_ctl, 0, 0);
+	so->heap_prefetch_page = InvalidBlockNumber;
+	so->heap_prefetch_item = 0;
+	visibilitymap_cache_init(&so->heap_prefetch_vmbufs);
 
 	/*
 	 * We don't know yet whether the scan will be index-only, so we do not
@@ -405,6 +421,7 @@ btrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
 
 	so->markItemIndex = -1;
 	so->arrayKeyCount = 0;
+	so->lastLeafPage = InvalidBlockNumber;
 	BTScanPosUnpinIfPinned(so->markPos);
 	BTScanPosInvalidate(so->markPos);
 
@@ -463,6 +480,8 @@ btendscan(IndexScanDesc scan)
 	so->markItemIndex = -1;
 	BTScanPosUnpinIfPinned(so->markPos);
 
+	visibilitymap_cache_release(&so->heap_prefetch_vmbufs);
+
 	/* No need to invalidate positions, the RAM is about to be freed. */
 
 	/* Release storage */
@@ -505,7 +524,7 @@ btmarkpos(IndexScanDesc scan)
 	}
 
 	/* Also record the current positions of any array keys */
-	if (so->numArrayKeys)
+	if (BTScanHasArrayKeys(so))
 		_bt_mark_array_keys(scan);
 }
 
@@ -518,7 +537,7 @@ btrestrpos(IndexScanDesc scan)
 	BTScanOpaque so = (BTScanOpaque) scan->opaque;
 
 	/* Restore the marked positions of any array keys */
-	if (so->numArrayKeys)
+	if (BTScanHasArrayKeys(so))
 		_bt_restore_array_keys(scan);
 
 	if (so->markItemIndex >= 0)
@@ -565,6 +584,17 @@ btrestrpos(IndexScanDesc scan)
 	}
 }
 
+/*
+ *	btprefetch() -- prefetch the pages of an upcoming scan
+ */
+void
+btprefetch(Relation indexRelation, Relation heapRelation, ScanKey keys,
+		   int nkeys, Snapshot snapshot, int nheappages)
+{
+	_bt_prefetch(indexRelation, heapRelation, keys, nkeys, snapshot,
+				 nheappages);
+}
+
 /*
  * btestimateparallelscan -- estimate storage for BTParallelScanDescData
  */
@@ -586,6 +616,7 @@ btinitparallelscan(void *target)
 	bt_target->btps_scanPage = InvalidBlockNumber;
 	bt_target->btps_pageStatus = BTPARALLEL_NOT_INITIALIZED;
 	bt_target->btps_arrayKeyCount = 0;
+	bt_target->btps_pagesScanned = 0;
 	ConditionVariableInit(&bt_target->btps_cv);
 }
 
@@ -612,6 +643,7 @@ btparallelrescan(IndexScanDesc scan)
 	btscan->btps_scanPage = InvalidBlockNumber;
 	btscan->btps_pageStatus = BTPARALLEL_NOT_INITIALIZED;
 	btscan->btps_arrayKeyCount = 0;
+	btscan->btps_pagesScanned = 0;
 	SpinLockRelease(&btscan->btps_mutex);
 }
 
@@ -703,10 +735,35 @@ _bt_parallel_release(IndexScanDesc scan, BlockNumber scan_page)
 	SpinLockAcquire(&btscan->btps_mutex);
 	btscan->btps_scanPage = scan_page;
 	btscan->btps_pageStatus = BTPARALLEL_IDLE;
+	btscan->btps_pagesScanned++;
 	SpinLockRelease(&btscan->btps_mutex);
 	ConditionVariableSignal(&btscan->btps_cv);
 }
 
+/*
+ * _bt_parallel_pages_scanned() -- Return the number of pages the
+ *		participants of the parallel scan have advanced over so far.
+ *
+ * The worker prefetching leaf pages uses this to keep its prefetch window
+ * ahead of the whole scan, rather than only ahead of its own position.
+ */
+uint32
+_bt_parallel_pages_scanned(IndexScanDesc scan)
+{
+	ParallelIndexScanDesc parallel_scan = scan->parallel_scan;
+	BTParallelScanDesc btscan;
+	uint32		pages;
+
+	btscan = (BTParallelScanDesc) OffsetToPointer((void *) parallel_scan,
+												  parallel_scan->ps_offset);
+
+	SpinLockAcquire(&btscan->btps_mutex);
+	pages = btscan->btps_pagesScanned;
+	SpinLockRelease(&btscan->btps_mutex);
+
+	return pages;
+}
+
 /*
  * _bt_parallel_done() -- Mark the parallel scan as complete.
  *
@@ -17,12 +17,14 @@
 
 #include "access/nbtree.h"
 #include "access/relscan.h"
+#include "access/visibilitymap.h"
 #include "access/xact.h"
 #include "catalog/catalog.h"
 #include "miscadmin.h"
 #include "optimizer/cost.h"
 #include "pgstat.h"
 #include "storage/predicate.h"
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
 #include "utils/spccache.h"
@@ -31,6 +33,8 @@ static void _bt_drop_lock_and_maybe_pin(IndexScanDesc scan, BTScanPos sp);
 static OffsetNumber _bt_binsrch(Relation rel, BTScanInsert key, Buffer buf);
 static int	_bt_binsrch_posting(BTScanInsert key, Page page,
 								OffsetNumber offnum);
+static Buffer _bt_search_last_leaf(IndexScanDesc scan, BTScanInsert key,
+									OffsetNumber *offnum);
 static bool _bt_readpage(IndexScanDesc scan, ScanDirection dir,
 						 OffsetNumber offnum);
 static void _bt_saveitem(BTScanOpaque so, int itemIndex,
@@ -48,6 +52,7 @@ static bool _bt_parallel_readpage(IndexScanDesc scan, BlockNumber blkno,
 static Buffer _bt_walk_left(Relation rel, Buffer buf, Snapshot snapshot);
 static bool _bt_endpoint(IndexScanDesc scan, ScanDirection dir);
 static inline void _bt_initialize_more_data(BTScanOpaque so, ScanDirection dir);
+static void _bt_prefetch_heap_for_ios(IndexScanDesc scan, ScanDirection dir);
 
 #define INCREASE_PREFETCH_DISTANCE_STEP 1
 
@@ -864,7 +869,7 @@ _bt_read_parent_for_prefetch(IndexScanDesc scan, BlockNumber parent, ScanDirecti
 	offnum = P_FIRSTDATAKEY(opaque);
 	n_child = PageGetMaxOffsetNumber(page) - offnum + 1;
 
-	/* Position where we should insert prefetch of parent page: we intentionally use prefetch_maximum here instead of current_prefetch_distance,
+	/* Position where we should insert prefetch of parent page: we intentionally use prefetch_maximum here instead of current prefetch distance,
 	 * assuming that it will reach prefetch_maximum before we reach and of the parent page
 	 */
 	next_parent_prefetch_index = (n_child > so->prefetch_maximum)
@@ -904,6 +909,325 @@ _bt_read_parent_for_prefetch(IndexScanDesc scan, BlockNumber parent, ScanDirecti
 	return offnum;
 }
 
+/*
+ * _bt_prefetch_heap_for_ios - prefetch the heap pages an index-only scan
+ * will have to visit.
+ *
+ * An index-only scan visits the heap for the TIDs on heap pages that are not
+ * all-visible.  Look ahead at up to prefetch_maximum items of the current
+ * leaf page past the one being returned, and prefetch the heap pages of
+ * those whose visibility map bit is clear.  The bits may change before the
+ * executor tests them, which can only make a prefetch useless or missing.
+ * Pages that are all-visible are not prefetched, so there is no need to ramp
+ * the distance up as for plain index scans.
+ */
+static void
+_bt_prefetch_heap_for_ios(IndexScanDesc scan, ScanDirection dir)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	BlockNumber blocks[MAX_IO_CONCURRENCY];
+	BlockNumber last_block = InvalidBlockNumber;
+	int			nblocks = 0;
+	int			stop;
+
+	/* Start over on a new leaf page */
+	if (so->heap_prefetch_page != so->currPos.currPage)
+	{
+		so->heap_prefetch_page = so->currPos.currPage;
+		so->heap_prefetch_item = so->currPos.itemIndex;
+	}
+
+	if (ScanDirectionIsForward(dir))
+	{
+		if (so->heap_prefetch_item <= so->currPos.itemIndex)
+			so->heap_prefetch_item = so->currPos.itemIndex + 1;
+		stop = Min(so->currPos.lastItem,
+				   so->currPos.itemIndex + so->prefetch_maximum);
+		while (so->heap_prefetch_item <= stop)
+		{
+			BTScanPosItem *item = &so->currPos.items[so->heap_prefetch_item++];
+			BlockNumber blkno = ItemPointerGetBlockNumber(&item->heapTid);
+
+			if (blkno != last_block &&
+				!VM_ALL_VISIBLE_CACHED(scan->heapRelation, blkno,
+									   &so->heap_prefetch_vmbufs))
+				blocks[nblocks++] = blkno;
+			last_block = blkno;
+		}
+	}
+	else
+	{
+		if (so->heap_prefetch_item >= so->currPos.itemIndex)
+			so->heap_prefetch_item = so->currPos.itemIndex - 1;
+		stop = Max(so->currPos.firstItem,
+				   so->currPos.itemIndex - so->prefetch_maximum);
+		while (so->heap_prefetch_item >= stop)
+		{
+			BTScanPosItem *item = &so->currPos.items[so->heap_prefetch_item--];
+			BlockNumber blkno = ItemPointerGetBlockNumber(&item->heapTid);
+
+			if (blkno != last_block &&
+				!VM_ALL_VISIBLE_CACHED(scan->heapRelation, blkno,
+									   &so->heap_prefetch_vmbufs))
+				blocks[nblocks++] = blkno;
+			last_block = blkno;
+		}
+	}
+
+	if (nblocks > 0)
+		PrefetchBuffers(scan->heapRelation, MAIN_FORKNUM, blocks, nblocks);
+}
+
+/*
+ * _bt_prefetch_leaf_pages - prefetch leaf pages of an index-only scan.
+ *
+ * Neon prefetch requests are private to the backend which issued them, so in
+ * a parallel scan a leaf page prefetched by one worker is usually read by
+ * another one.  Therefore in a parallel scan we read the prefetched pages
+ * into shared buffers right away, where whichever worker gets to scan them
+ * will find them.  Issuing all the prefetch requests first lets the reads be
+ * served by a single round trip to the page server.
+ */
+static void
+_bt_prefetch_leaf_pages(IndexScanDesc scan, BlockNumber *blocks, int nblocks)
+{
+	Relation	rel = scan->indexRelation;
+	Buffer		buffers[MAX_BUFFERS_PER_READ];
+	int			i = 0;
+
+	if (nblocks <= 0)
+		return;
+
+	PrefetchBuffers(rel, MAIN_FORKNUM, blocks, nblocks);
+	PrefetchControlIssued(&((BTScanOpaque) scan->opaque)->prefetch_ctl, nblocks);
+
+	if (scan->parallel_scan == NULL)
+		return;
+
+	while (i < nblocks)
+	{
+		int			n = 1;
+
+		/* read runs of consecutive blocks with one vectored read */
+		while (i + n < nblocks && n < MAX_BUFFERS_PER_READ &&
+			   blocks[i + n] == blocks[i] + n)
+			n++;
+
+		ReadBuffers(rel, MAIN_FORKNUM, blocks[i], n, buffers, RBM_NORMAL, NULL);
+		for (int k = 0; k < n; k++)
+			ReleaseBuffer(buffers[k]);
+		i += n;
+	}
+}
+
+/*
+ *	_bt_search_last_leaf() -- Try to position a scan on the last leaf page
+ *		it read.
+ *
+ * A scan with array keys is done as a series of primitive scans, one for
+ * each set of array key values, and each of them normally descends the tree
+ * from the root in _bt_first.  When the array elements are close together,
+ * the next primitive scan usually starts on the leaf page the previous one
+ * ended on, and we can save the descent by checking whether the page the
+ * scan read last is the right one.
+ *
+ * The page is the right place to start if the key is not beyond its high
+ * key and the binary search lands after its first item: then every item on
+ * the pages to its left sorts before the key.  It does not matter where the
+ * page came from, which keeps this safe after a concurrent page split or
+ * deletion.  Both scan directions work the same way, since a backward scan
+ * also starts from the _bt_binsrch position, just before it.  We need an
+ * MVCC snapshot so that a page deleted since we read it cannot have been
+ * recycled into a different part of the tree.
+ *
+ * If the page is the right place, returns it read-locked and pinned, and
+ * sets *offnum to the result of _bt_binsrch on it.  Otherwise returns
+ * InvalidBuffer.
+ */
+static Buffer
+_bt_search_last_leaf(IndexScanDesc scan, BTScanInsert key,
+					 OffsetNumber *offnum)
+{
+	Relation	rel = scan->indexRelation;
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Buffer		buf;
+	Page		page;
+	BTPageOpaque opaque;
+	int			cmpval;
+
+	if ((so->numArrayKeys <= 0 && so->skipKey == NULL) ||
+		!BlockNumberIsValid(so->lastLeafPage) ||
+		scan->parallel_scan != NULL ||
+		!IsMVCCSnapshot(scan->xs_snapshot))
+		return InvalidBuffer;
+
+	buf = _bt_getbuf(rel, so->lastLeafPage, BT_READ);
+	page = BufferGetPage(buf);
+	TestForOldSnapshot(scan->xs_snapshot, rel, page);
+	opaque = BTPageGetOpaque(page);
+
+	/* as in _bt_moveright */
+	cmpval = key->nextkey ? 0 : 1;
+
+	if (P_ISLEAF(opaque) && !P_IGNORE(opaque) &&
+		(P_RIGHTMOST(opaque) ||
+		 _bt_compare(rel, key, page, P_HIKEY) < cmpval))
+	{
+		*offnum = _bt_binsrch(rel, key, buf);
+		if (*offnum > P_FIRSTDATAKEY(opaque))
+			return buf;
+		*offnum = InvalidOffsetNumber;
+	}
+
+	_bt_relbuf(rel, buf);
+	return InvalidBuffer;
+}
+
+/*
+ *	_bt_skip_probe() -- Find the next value of the first index column for a
+ *		skip scan.
+ *
+ * Looks for the first item in the scan direction whose first column is
+ * beyond the current value of the skip scan key, or the first item of the
+ * index if the skip scan has not started yet.  The item may be dead; then
+ * the primitive scan for its value will just find nothing.
+ *
+ * Returns false if there is no such item.  Otherwise, sets *value (copied
+ * into the array context) and *isnull to the item's first column, and
+ * *samepage to whether it was found on the leaf page the scan read last, in
+ * which case skipping saved nothing.
+ */
+bool
+_bt_skip_probe(IndexScanDesc scan, ScanDirection dir,
+			   Datum *value, bool *isnull, bool *samepage)
+{
+	Relation	rel = scan->indexRelation;
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	BTSkipKeyInfo *skip = so->skipKey;
+	Buffer		buf;
+	Page		page;
+	BTPageOpaque opaque;
+	OffsetNumber offnum;
+	IndexTuple	itup;
+	Datum		datum;
+	MemoryContext oldContext;
+
+	Assert(skip != NULL && skip->state != BTSKIP_RANGE);
+
+	*samepage = false;
+
+	if (skip->state == BTSKIP_START)
+	{
+		buf = _bt_get_endpoint(rel, 0, ScanDirectionIsBackward(dir), NULL,
+							   scan->xs_snapshot);
+		if (!BufferIsValid(buf))
+		{
+			PredicateLockRelation(rel, scan->xs_snapshot);
+			return false;
+		}
+		page = BufferGetPage(buf);
+		opaque = BTPageGetOpaque(page);
+		if (ScanDirectionIsForward(dir))
+			offnum = P_FIRSTDATAKEY(opaque);
+		else
+			offnum = PageGetMaxOffsetNumber(page);
+	}
+	else
+	{
+		BTScanInsertData inskey;
+		int			flags;
+
+		/*
+		 * Build an insertion scan key for the current value.  A forward scan
+		 * wants the first item > value, a backward scan the last item <
+		 * value, which is just before the first item >= value.
+		 */
+		flags = rel->rd_indoption[0] << SK_BT_INDOPTION_SHIFT;
+		if (skip->state == BTSKIP_NULL)
+			flags |= SK_ISNULL;
+		ScanKeyEntryInitializeWithInfo(&inskey.scankeys[0],
+									   flags,
+									   1,
+									   InvalidStrategy,
+									   InvalidOid,
+									   rel->rd_indcollation[0],
+									   index_getprocinfo(rel, 1, BTORDER_PROC),
+									   skip->state == BTSKIP_NULL ?
+									   (Datum) 0 : skip->value);
+		_bt_metaversion(rel, &inskey.heapkeyspace, &inskey.allequalimage);
+		inskey.anynullkeys = false; /* unused */
+		inskey.nextkey = ScanDirectionIsForward(dir);
+		inskey.pivotsearch = false;
+		inskey.scantid = NULL;
+		inskey.keysz = 1;
+
+		buf = _bt_search_last_leaf(scan, &inskey, &offnum);
+		if (BufferIsValid(buf))
+			*samepage = true;
+		else
+		{
+			_bt_freestack(_bt_search(rel, &inskey, &buf, BT_READ,
+									 scan->xs_snapshot));
+			if (!BufferIsValid(buf))
+			{
+				PredicateLockRelation(rel, scan->xs_snapshot);
+				return false;
+			}
+			offnum = _bt_binsrch(rel, &inskey, buf);
+		}
+		if (ScanDirectionIsBackward(dir))
+			offnum = OffsetNumberPrev(offnum);
+	}
+
+	/* step to the next page in the scan direction until we find an item */
+	for (;;)
+	{
+		page = BufferGetPage(buf);
+		opaque = BTPageGetOpaque(page);
+		if (!P_IGNORE(opaque))
+		{
+			PredicateLockPage(rel, BufferGetBlockNumber(buf),
+							  scan->xs_snapshot);
+			if (offnum >= P_FIRSTDATAKEY(opaque) &&
+				offnum <= PageGetMaxOffsetNumber(page))
+				break;
+		}
+
+		*samepage = false;
+		if (ScanDirectionIsForward(dir))
+		{
+			if (P_RIGHTMOST(opaque))
+			{
+				_bt_relbuf(rel, buf);
+				return false;
+			}
+			buf = _bt_relandgetbuf(rel, buf, opaque->btpo_next, BT_READ);
+			page = BufferGetPage(buf);
+			TestForOldSnapshot(scan->xs_snapshot, rel, page);
+			offnum = P_FIRSTDATAKEY(BTPageGetOpaque(page));
+		}
+		else
+		{
+			buf = _bt_walk_left(rel, buf, scan->xs_snapshot);
+			if (!BufferIsValid(buf))
+				return false;
+			offnum = PageGetMaxOffsetNumber(BufferGetPage(buf));
+		}
+	}
+
+	itup = (IndexTuple) PageGetItem(page, PageGetItemId(page, offnum));
+	datum = index_getattr(itup, 1, RelationGetDescr(rel), isnull);
+	if (!*isnull)
+	{
+		oldContext = MemoryContextSwitchTo(so->arrayContext);
+		*value = datumCopy(datum, skip->attbyval, skip->attlen);
+		MemoryContextSwitchTo(oldContext);
+	}
+
+	_bt_relbuf(rel, buf);
+	return true;
+}
+
 /*
  *	_bt_first() -- Find the first item in a scan.
  *
@@ -1168,31 +1492,30 @@ _bt_first(IndexScanDesc scan, ScanDirection dir)
 	so->n_prefetch_blocks = 0;
 	so->last_prefetch_index = 0;
 	so->next_parent = P_NONE;
+	so->heap_prefetch_page = InvalidBlockNumber;
 	so->prefetch_maximum = IsCatalogRelation(rel)
 		? effective_io_concurrency
 		: get_tablespace_io_concurrency(rel->rd_rel->reltablespace);
 
 	if (scan->xs_want_itup) /* index only scan */
 	{
-		if (enable_indexonlyscan_prefetch)
-		{
-			/* We disable prefetch for parallel index-only scan.
-			 * Neon prefetch is efficient only if prefetched blocks are accessed by the same worker
-			 * which issued prefetch request. The logic of splitting pages between parallel workers in
-			 * index scan doesn't allow to satisfy this requirement.
-			 * Also prefetch of leave pages will be useless if expected number of rows fits in one page.
-			 */
-			if (scan->parallel_scan)
-				so->prefetch_maximum = 0;  /* disable prefetch */
-		}
-		else
+		/* Parallel index-only scans publish prefetched leaves into shared buffers, see _bt_prefetch_leaf_pages */
+		if (!enable_indexonlyscan_prefetch)
 			so->prefetch_maximum = 0; /* disable prefetch */
 	}
 	else if (!enable_indexscan_prefetch || !scan->heapRelation)
 		so->prefetch_maximum = 0; /* disable prefetch */
 
-	/* If key bounds are not specified, then we will scan the whole relation and it make sense to start with the largest possible prefetch distance */
-	so->current_prefetch_distance = (keysCount == 0) ? so->prefetch_maximum : 0;
+	/*
+	 * If key bounds are not specified, then we will scan the whole relation and it make sense to start with the largest possible prefetch distance.
+	 * A rescan starts with the distance learned by the previous scans, see prefetch.c.
+	 */
+	if (so->prefetch_ctl.maximum != so->prefetch_maximum)
+		PrefetchControlInit(&so->prefetch_ctl, so->prefetch_maximum,
+							(keysCount == 0) ? so->prefetch_maximum
+							: scan->xs_want_itup ? INCREASE_PREFETCH_DISTANCE_STEP : 0);
+	else
+		PrefetchControlRestart(&so->prefetch_ctl);
 
 	/*
 	 * If we found no usable boundary keys, we have to start from one end of
@@ -1460,9 +1783,15 @@ _bt_first(IndexScanDesc scan, ScanDirection dir)
 
 	/*
 	 * Use the manufactured insertion scan key to descend the tree and
-	 * position ourselves on the target leaf page.
+	 * position ourselves on the target leaf page.  When we get here to start
+	 * the scan for the next set of array keys, the target is often the leaf
+	 * page the scan for the previous keys ended on, so try that first.
 	 */
-	stack = _bt_search(rel, &inskey, &buf, BT_READ, scan->xs_snapshot);
+	offnum = InvalidOffsetNumber;
+	stack = NULL;
+	buf = _bt_search_last_leaf(scan, &inskey, &offnum);
+	if (!BufferIsValid(buf))
+		stack = _bt_search(rel, &inskey, &buf, BT_READ, scan->xs_snapshot);
 
 	/* Start prefetching for index only scan */
 	if (so->prefetch_maximum > 0 && stack != NULL && scan->xs_want_itup) /* index only scan */
@@ -1472,11 +1801,19 @@ _bt_first(IndexScanDesc scan, ScanDirection dir)
 			? stack->bts_offset - first_offset
 			: first_offset + so->n_prefetch_blocks - 1 - stack->bts_offset;
 		Assert(so->n_prefetch_blocks >= skip);
-		so->current_prefetch_distance = INCREASE_PREFETCH_DISTANCE_STEP;
-		so->n_prefetch_requests = Min(so->current_prefetch_distance, so->n_prefetch_blocks - skip);
-		so->last_prefetch_index = skip + so->n_prefetch_requests;
-		for (int i = skip; i < so->last_prefetch_index; i++)
-			PrefetchBuffer(rel, MAIN_FORKNUM, so->prefetch_blocks[i]);
+		if (scan->parallel_scan != NULL)
+		{
+			/* Other workers are waiting for us to release the scan: defer the prefetch to _bt_steppage */
+			so->n_prefetch_requests = 0;
+			so->last_prefetch_index = skip;
+			so->prefetch_pages_seen = _bt_parallel_pages_scanned(scan);
+		}
+		else
+		{
+			so->n_prefetch_requests = Min(PrefetchControlTarget(&so->prefetch_ctl), so->n_prefetch_blocks - skip);
+			so->last_prefetch_index = skip + so->n_prefetch_requests;
+			_bt_prefetch_leaf_pages(scan, &so->prefetch_blocks[skip], so->n_prefetch_requests);
+		}
 	}
 
 	/* don't need to keep the stack around... */
@@ -1517,8 +1854,9 @@ _bt_first(IndexScanDesc scan, ScanDirection dir)
 
 	_bt_initialize_more_data(so, dir);
 
-	/* position to the precise item on the page */
-	offnum = _bt_binsrch(rel, &inskey, buf);
+	/* position to the precise item on the page, if not done already */
+	if (offnum == InvalidOffsetNumber)
+		offnum = _bt_binsrch(rel, &inskey, buf);
 
 	/*
 	 * If nextkey = false, we are positioned at the first item >= scan key, or
@@ -1569,7 +1907,11 @@ readcomplete:
 	currItem = &so->currPos.items[so->currPos.itemIndex];
 	scan->xs_heaptid = currItem->heapTid;
 	if (scan->xs_want_itup)
+	{
 		scan->xs_itup = (IndexTuple) (so->currTuples + currItem->tupleOffset);
+		if (so->prefetch_maximum > 0 && scan->heapRelation)
+			_bt_prefetch_heap_for_ios(scan, dir);
+	}
 
 	return true;
 }
@@ -1621,26 +1963,25 @@ _bt_next(IndexScanDesc scan, ScanDirection dir)
 	if (scan->xs_want_itup) /* index-only scan */
 	{
 		scan->xs_itup = (IndexTuple) (so->currTuples + currItem->tupleOffset);
+		if (so->prefetch_maximum > 0 && scan->heapRelation)
+			_bt_prefetch_heap_for_ios(scan, dir);
 	}
 	else if (so->prefetch_maximum > 0)
 	{
 		int prefetchLimit, prefetchDistance;
+		BlockNumber prefetchBlocks[MAX_IO_CONCURRENCY];
+		int nPrefetchBlocks = 0;
 
 		/* Neon: prefetch referenced heap pages.
 		 * As far as it is difficult to predict how much items index scan will return
 		 * we do not want to prefetch many heap pages from the very beginning because
-		 * them may not be needed. So we are going to increase prefetch distance by INCREASE_PREFETCH_DISTANCE_STEP
-		 * at each index scan iteration until it reaches prefetch_maximum.
+		 * them may not be needed. So the prefetch controller starts with a small prefetch distance
+		 * and adjusts it at each index scan iteration, up to prefetch_maximum.
 		 */
-
-		/* Advance pefetch distance until it reaches prefetch_maximum */
-		if (so->current_prefetch_distance + INCREASE_PREFETCH_DISTANCE_STEP <= so->prefetch_maximum)
-			so->current_prefetch_distance += INCREASE_PREFETCH_DISTANCE_STEP;
-		else
-			so->current_prefetch_distance = so->prefetch_maximum;
+		PrefetchControlConsume(&so->prefetch_ctl);
 
 		/* How much we can prefetch */
-		prefetchLimit = Min(so->current_prefetch_distance, so->currPos.lastItem - so->currPos.firstItem + 1);
+		prefetchLimit = Min(PrefetchControlTarget(&so->prefetch_ctl), so->currPos.lastItem - so->currPos.firstItem + 1);
 
 		/* Active prefeth requests */
 		prefetchDistance = so->n_prefetch_requests;
@@ -1652,15 +1993,14 @@ _bt_next(IndexScanDesc scan, ScanDirection dir)
 			prefetchDistance -= 1;
 
 		/* Keep number of active prefetch requests equal to the current prefetch distance.
-		 * When prefetch distance reaches prefetch maximum, this loop performs at most one iteration,
-		 * but at the beginning of index scan it performs up to INCREASE_PREFETCH_DISTANCE_STEP+1 iterations
+		 * While the prefetch distance is stable, this loop performs at most one iteration,
+		 * but when the distance grows it performs two.
 		 */
 		if (ScanDirectionIsForward(dir))
 		{
 			while (prefetchDistance < prefetchLimit && so->currPos.itemIndex + prefetchDistance <= so->currPos.lastItem)
 			{
-				BlockNumber blkno = BlockIdGetBlockNumber(&so->currPos.items[so->currPos.itemIndex + prefetchDistance].heapTid.ip_blkid);
-				PrefetchBuffer(scan->heapRelation, MAIN_FORKNUM, blkno);
+				prefetchBlocks[nPrefetchBlocks++] = BlockIdGetBlockNumber(&so->currPos.items[so->currPos.itemIndex + prefetchDistance].heapTid.ip_blkid);
 				prefetchDistance += 1;
 			}
 		}
@@ -1668,16 +2008,203 @@ _bt_next(IndexScanDesc scan, ScanDirection dir)
 		{
 			while (prefetchDistance < prefetchLimit && so->currPos.itemIndex - prefetchDistance >= so->currPos.firstItem)
 			{
-				BlockNumber blkno = BlockIdGetBlockNumber(&so->currPos.items[so->currPos.itemIndex - prefetchDistance].heapTid.ip_blkid);
-				PrefetchBuffer(scan->heapRelation, MAIN_FORKNUM, blkno);
+				prefetchBlocks[nPrefetchBlocks++] = BlockIdGetBlockNumber(&so->currPos.items[so->currPos.itemIndex - prefetchDistance].heapTid.ip_blkid);
 				prefetchDistance += 1;
 			}
 		}
+		/* Send all new requests to the storage manager at once */
+		if (nPrefetchBlocks > 0)
+		{
+			PrefetchBuffers(scan->heapRelation, MAIN_FORKNUM, prefetchBlocks, nPrefetchBlocks);
+			PrefetchControlIssued(&so->prefetch_ctl, nPrefetchBlocks);
+		}
 		so->n_prefetch_requests = prefetchDistance; /* update number of active prefetch requests */
 	}
 	return true;
 }
 
+/*
+ *	_bt_prefetch() -- Prefetch the pages that a future scan will need.
+ *
+ *		Used to look ahead of upcoming scans, typically the inner index scans
+ *		of a nested loop join for the next few outer tuples.  If nheappages
+ *		is zero, we descend the internal levels of the tree and prefetch the
+ *		leaf page on which the scan will start, without waiting for it.
+ *		Otherwise we read that leaf page (whose prefetch was hopefully issued
+ *		by an earlier call), and prefetch the heap pages of up to nheappages
+ *		of the items on it that match the keys.
+ *
+ * Only equality keys on a prefix of the index columns are used; a scan with
+ * no such keys is ignored, since prefetching is merely a hint.  The keys are
+ * search-type scankeys as passed to btrescan, but unlike scan->keyData they
+ * haven't been preprocessed.
+ */
+void
+_bt_prefetch(Relation rel, Relation heapRel, ScanKey scankey, int nkeys,
+			 Snapshot snapshot, int nheappages)
+{
+	BTScanInsertData inskey;
+	int			keysCount = 0;
+	Buffer		buf;
+	Page		page;
+	BTPageOpaque opaque;
+	OffsetNumber offnum;
+	OffsetNumber maxoff;
+	BlockNumber blocks[PREFETCH_BATCH_SIZE];
+	int			nblocks = 0;
+
+	if (!enable_indexscan_prefetch || heapRel == NULL)
+		nheappages = 0;
+	nheappages = Min(nheappages, PREFETCH_BATCH_SIZE);
+
+	/* Build an insertion scankey from the leading equality keys */
+	for (int i = 0; i < Min(nkeys, IndexRelationGetNumberOfKeyAttributes(rel)); i++)
+	{
+		ScanKey		cur = &scankey[i];
+		int			flags;
+
+		if (cur->sk_attno != i + 1 ||
+			cur->sk_strategy != BTEqualStrategyNumber ||
+			(cur->sk_flags & (SK_ISNULL | SK_ROW_HEADER | SK_SEARCHARRAY |
+							  SK_SEARCHNULL | SK_SEARCHNOTNULL)))
+			break;
+
+		flags = cur->sk_flags | (rel->rd_indoption[i] << SK_BT_INDOPTION_SHIFT);
+
+		/* same as in _bt_first */
+		if (cur->sk_subtype == rel->rd_opcintype[i] ||
+			cur->sk_subtype == InvalidOid)
+		{
+			FmgrInfo   *procinfo;
+
+			procinfo = index_getprocinfo(rel, cur->sk_attno, BTORDER_PROC);
+			ScanKeyEntryInitializeWithInfo(inskey.scankeys + i,
+										   flags,
+										   cur->sk_attno,
+										   InvalidStrategy,
+										   cur->sk_subtype,
+										   cur->sk_collation,
+										   procinfo,
+										   cur->sk_argument);
+		}
+		else
+		{
+			RegProcedure cmp_proc;
+
+			cmp_proc = get_opfamily_proc(rel->rd_opfamily[i],
+										 rel->rd_opcintype[i],
+										 cur->sk_subtype,
+										 BTORDER_PROC);
+			if (!RegProcedureIsValid(cmp_proc))
+				break;
+			ScanKeyEntryInitialize(inskey.scankeys + i,
+								   flags,
+								   cur->sk_attno,
+								   InvalidStrategy,
+								   cur->sk_subtype,
+								   cur->sk_collation,
+								   cmp_proc,
+								   cur->sk_argument);
+		}
+		keysCount++;
+	}
+
+	if (keysCount == 0)
+		return;
+
+	_bt_metaversion(rel, &inskey.heapkeyspace, &inskey.allequalimage);
+	inskey.anynullkeys = false; /* unused */
+	inskey.nextkey = false;
+	inskey.pivotsearch = false;
+	inskey.scantid = NULL;
+	inskey.keysz = keysCount;
+
+	if (nheappages == 0)
+	{
+		/*
+		 * Descend like _bt_search does, but stop at level 1 and only prefetch
+		 * the leaf page the downlink points to.  The internal pages are few
+		 * and usually cached, so reading them synchronously is cheap.
+		 */
+		buf = _bt_getroot(rel, BT_READ);
+		if (!BufferIsValid(buf))
+			return;
+
+		for (;;)
+		{
+			ItemId		itemid;
+			IndexTuple	itup;
+			BlockNumber child;
+
+			buf = _bt_moveright(rel, &inskey, buf, false, NULL, BT_READ,
+								snapshot);
+			page = BufferGetPage(buf);
+			opaque = BTPageGetOpaque(page);
+
+			/* root is a leaf, so the scan will find it in the buffer pool */
+			if (P_ISLEAF(opaque))
+				break;
+
+			offnum = _bt_binsrch(rel, &inskey, buf);
+			itemid = PageGetItemId(page, offnum);
+			itup = (IndexTuple) PageGetItem(page, itemid);
+			child = BTreeTupleGetDownLink(itup);
+
+			if (opaque->btpo_level == 1)
+			{
+				PrefetchBuffer(rel, MAIN_FORKNUM, child);
+				break;
+			}
+
+			buf = _bt_relandgetbuf(rel, buf, child, BT_READ);
+		}
+		_bt_relbuf(rel, buf);
+		return;
+	}
+
+	_bt_freestack(_bt_search(rel, &inskey, &buf, BT_READ, snapshot));
+	if (!BufferIsValid(buf))
+		return;
+
+	/*
+	 * Collect the heap blocks of the matching items on the leaf page.  We
+	 * don't follow the scan onto the right sibling: if there are that many
+	 * matches, the scan's own prefetching will take over soon enough.
+	 */
+	page = BufferGetPage(buf);
+	maxoff = PageGetMaxOffsetNumber(page);
+	for (offnum = _bt_binsrch(rel, &inskey, buf);
+		 offnum <= maxoff && nblocks < nheappages;
+		 offnum = OffsetNumberNext(offnum))
+	{
+		ItemId		itemid = PageGetItemId(page, offnum);
+		IndexTuple	itup;
+		int			nitems;
+
+		if (_bt_compare(rel, &inskey, page, offnum) != 0)
+			break;
+		if (ItemIdIsDead(itemid))
+			continue;
+
+		itup = (IndexTuple) PageGetItem(page, itemid);
+		nitems = BTreeTupleIsPosting(itup) ? BTreeTupleGetNPosting(itup) : 1;
+		for (int j = 0; j < nitems && nblocks < nheappages; j++)
+		{
+			ItemPointer tid = BTreeTupleIsPosting(itup) ?
+			BTreeTupleGetPostingN(itup, j) : &itup->t_tid;
+			BlockNumber blkno = ItemPointerGetBlockNumber(tid);
+
+			/* skip duplicates of neighbouring items */
+			if (nblocks == 0 || blocks[nblocks - 1] != blkno)
+				blocks[nblocks++] = blkno;
+		}
+	}
+	_bt_relbuf(rel, buf);
+
+	if (nblocks > 0)
+		PrefetchBuffers(heapRel, MAIN_FORKNUM, blocks, nblocks);
+}
+
 /*
  *	_bt_readpage() -- Load data from current index page into so->currPos
  *
@@ -1737,6 +2264,7 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 	 * This allows us to re-read the buffer if it is needed again for hinting.
 	 */
 	so->currPos.currPage = BufferGetBlockNumber(so->currPos.buf);
+	so->lastLeafPage = so->currPos.currPage;
 
 	/*
 	 * We save the LSN of the page as we read it, so that we know whether it
@@ -2083,11 +2611,25 @@ _bt_steppage(IndexScanDesc scan, ScanDirection dir)
 
 	if (scan->xs_want_itup && so->prefetch_maximum > 0) /* Prefetching of leave pages for index-only scan */
 	{
-		/* Advance pefetch distance until it reaches prefetch_maximum */
-		if (so->current_prefetch_distance + INCREASE_PREFETCH_DISTANCE_STEP <= so->prefetch_maximum)
-			so->current_prefetch_distance += INCREASE_PREFETCH_DISTANCE_STEP;
+		/* We move on to the next leaf page, let the prefetch controller adjust the distance */
+		int			distance = PrefetchControlConsume(&so->prefetch_ctl);
+
+		if (scan->parallel_scan != NULL)
+		{
+			/* Pages scanned by any worker consume our prefetch requests */
+			uint32 scanned = _bt_parallel_pages_scanned(scan);
 
-		so->n_prefetch_requests -= 1; /* we load next leaf page, so decrement number of active prefetch requests */
+			so->n_prefetch_requests -= (int) (scanned - so->prefetch_pages_seen);
+			so->prefetch_pages_seen = scanned;
+			if (so->n_prefetch_requests < 0)
+			{
+				/* The scan overtook our prefetch window: skip the pages that are already scanned */
+				so->last_prefetch_index = Min(so->last_prefetch_index - so->n_prefetch_requests, so->n_prefetch_blocks);
+				so->n_prefetch_requests = 0;
+			}
+		}
+		else
+			so->n_prefetch_requests -= 1; /* we load next leaf page, so decrement number of active prefetch requests */
 
 		/* Check if the are more children to prefetch at current parent  page */
 		if (so->last_prefetch_index == so->n_prefetch_blocks && so->next_parent != P_NONE)
@@ -2098,10 +2640,14 @@ _bt_steppage(IndexScanDesc scan, ScanDirection dir)
 		}
 
 		/* Try to keep number of active prefetch requests equal to current prefetch distance */
-		while (so->n_prefetch_requests < so->current_prefetch_distance && so->last_prefetch_index < so->n_prefetch_blocks)
+		if (so->n_prefetch_requests < distance && so->last_prefetch_index < so->n_prefetch_blocks)
 		{
-			so->n_prefetch_requests += 1;
-			PrefetchBuffer(scan->indexRelation, MAIN_FORKNUM, so->prefetch_blocks[so->last_prefetch_index++]);
+			int n = Min(distance - so->n_prefetch_requests,
+						so->n_prefetch_blocks - so->last_prefetch_index);
+
+			_bt_prefetch_leaf_pages(scan, &so->prefetch_blocks[so->last_prefetch_index], n);
+			so->n_prefetch_requests += n;
+			so->last_prefetch_index += n;
 		}
 	}
 
@@ -2630,9 +3176,17 @@ _bt_endpoint(IndexScanDesc scan, ScanDirection dir)
 	if (so->prefetch_maximum > 0 && parent != P_NONE && scan->xs_want_itup) /* index only scan */
 	{
 		_bt_read_parent_for_prefetch(scan, parent, dir);
-		so->n_prefetch_requests = so->last_prefetch_index = Min(so->prefetch_maximum, so->n_prefetch_blocks);
-		for (int i = 0; i < so->last_prefetch_index; i++)
-			PrefetchBuffer(rel, MAIN_FORKNUM, so->prefetch_blocks[i]);
+		if (scan->parallel_scan != NULL)
+		{
+			/* See _bt_first */
+			so->n_prefetch_requests = so->last_prefetch_index = 0;
+			so->prefetch_pages_seen = _bt_parallel_pages_scanned(scan);
+		}
+		else
+		{
+			so->n_prefetch_requests = so->last_prefetch_index = Min(PrefetchControlTarget(&so->prefetch_ctl), so->n_prefetch_blocks);
+			_bt_prefetch_leaf_pages(scan, so->prefetch_blocks, so->last_prefetch_index);
+		}
 	}
 
 	PredicateLockPage(rel, BufferGetBlockNumber(buf), scan->xs_snapshot);
@@ -31,6 +31,11 @@
  * them.  They will need to be re-read into shared buffers on first use after
  * the build finishes.
  *
+ * The pages are not WAL-logged as they are written.  Once the index is
+ * complete, all of them are WAL-logged together with log_newpage_range(),
+ * which also brings them into shared buffers.  For the Neon smgr, this makes
+ * the build an "unlogged build", like a GiST or SP-GiST build.
+ *
  * This code isn't concerned about the FSM at all. The caller is responsible
  * for initializing that.
  *
@@ -252,7 +257,6 @@ typedef struct BTWriteState
 	Relation	heap;
 	Relation	index;
 	BTScanInsert inskey;		/* generic insertion scankey */
-	bool		btws_use_wal;	/* dump pages to WAL? */
 	BlockNumber btws_pages_alloced; /* # pages allocated */
 	BlockNumber btws_pages_written; /* # pages written out */
 	Page		btws_zeropage;	/* workspace for filling zeroes */
@@ -569,7 +573,6 @@ _bt_leafbuild(BTSpool *btspool, BTSpool *btspool2)
 	wstate.inskey = _bt_mkscankey(wstate.index, NULL);
 	/* _bt_mkscankey() won't set allequalimage without metapage */
 	wstate.inskey->allequalimage = _bt_allequalimage(wstate.index, true);
-	wstate.btws_use_wal = RelationNeedsWAL(wstate.index);
 
 	/* reserve the metapage */
 	wstate.btws_pages_alloced = BTREE_METAPAGE + 1;
@@ -578,7 +581,38 @@ _bt_leafbuild(BTSpool *btspool, BTSpool *btspool2)
 
 	pgstat_progress_update_param(PROGRESS_CREATEIDX_SUBPHASE,
 								 PROGRESS_BTREE_PHASE_LEAF_LOAD);
+
+	/*
+	 * NEON: the pages are not WAL-logged one at a time as they are written,
+	 * but all together once the index is complete.
+	 */
+	smgr_start_unlogged_build(RelationGetSmgr(wstate.index));
+
 	_bt_load(&wstate, btspool, btspool2);
+
+	smgr_finish_unlogged_build_phase_1(RelationGetSmgr(wstate.index));
+
+	/*
+	 * We didn't write WAL records as we built the index, so if WAL-logging is
+	 * required, write all pages to the WAL now.  This reads them into shared
+	 * buffers and dirties them, so a checkpoint takes care of flushing them
+	 * from now on, and we don't need to fsync them ourselves.
+	 */
+	if (RelationNeedsWAL(wstate.index))
+	{
+		Relation	index = wstate.index;
+		BlockNumber nblocks = RelationGetNumberOfBlocks(index);
+
+		log_newpage_range(index, MAIN_FORKNUM, 0, nblocks, true);
+		SetLastWrittenLSNForBlockRange(XactLastRecEnd,
+									   RelationGetSmgr(index)->smgr_rnode.node,
+									   MAIN_FORKNUM, 0, nblocks);
+		SetLastWrittenLSNForRelation(XactLastRecEnd,
+									 RelationGetSmgr(index)->smgr_rnode.node,
+									 MAIN_FORKNUM);
+	}
+
+	smgr_end_unlogged_build(RelationGetSmgr(wstate.index));
 }
 
 /*
@@ -643,13 +677,6 @@ _bt_blnewpage(uint32 level)
 static void
 _bt_blwritepage(BTWriteState *wstate, Page page, BlockNumber blkno)
 {
-	/* XLOG stuff */
-	if (wstate->btws_use_wal)
-	{
-		/* We use the XLOG_FPI record type for this */
-		log_newpage(&wstate->index->rd_node, MAIN_FORKNUM, blkno, page, true);
-	}
-
 	/*
 	 * If we have to write pages nonsequentially, fill in the space with
 	 * zeroes until we come back and overwrite.  This is not logically
@@ -1420,18 +1447,6 @@ _bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
 
 	/* Close down final pages and write the metapage */
 	_bt_uppershutdown(wstate, state);
-
-	/*
-	 * When we WAL-logged index pages, we must nonetheless fsync index files.
-	 * Since we're building outside shared buffers, a CHECKPOINT occurring
-	 * during the build has no way to flush the previously written data to
-	 * disk (indeed it won't know the index even exists).  A crash later on
-	 * would replay WAL from the checkpoint, therefore it wouldn't replay our
-	 * earlier WAL entries. If we do not fsync those pages here, they might
-	 * still not be on disk when the crash occurs.
-	 */
-	if (wstate->btws_use_wal)
-		smgrimmedsync(RelationGetSmgr(wstate->index), MAIN_FORKNUM);
 }
 
 /*
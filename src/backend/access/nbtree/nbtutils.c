@@ -45,6 +45,13 @@ static int	_bt_sort_array_elements(IndexScanDesc scan, ScanKey skey,
 									bool reverse,
 									Datum *elems, int nelems);
 static int	_bt_compare_array_elements(const void *a, const void *b, void *arg);
+static bool _bt_skip_scan_wanted(IndexScanDesc scan);
+static BTSkipKeyInfo *_bt_init_skip_key(IndexScanDesc scan);
+static void _bt_lookup_skip_operator(Relation rel, StrategyNumber strat,
+									 FmgrInfo *finfo);
+static void _bt_set_skip_key(IndexScanDesc scan, BTSkipState state,
+							 Datum value);
+static bool _bt_advance_skip_key(IndexScanDesc scan, ScanDirection dir);
 static bool _bt_compare_scankey_args(IndexScanDesc scan, ScanKey op,
 									 ScanKey leftarg, ScanKey rightarg,
 									 bool *result);
@@ -202,6 +209,13 @@ _bt_freestack(BTStack stack)
  * array keys, it's sufficient to find the extreme element value and replace
  * the whole array with that scalar value.
  *
+ * If the scan has no keys on the first index column but has keys on the
+ * second one, we also set up a skip scan key for the first column in
+ * so->arrayKeyData[0], ahead of the scan's own keys.  It is an equality key
+ * that steps through the distinct values of the column, so that the keys on
+ * the second column are required keys in each primitive indexscan, which
+ * can then skip over the parts of the index that cannot match.
+ *
  * Note: the reason we need so->arrayKeyData, rather than just scribbling
  * on scan->keyData, is that callers are permitted to call btrescan without
  * supplying a new set of scankey data.
@@ -213,6 +227,8 @@ _bt_preprocess_array_keys(IndexScanDesc scan)
 	int			numberOfKeys = scan->numberOfKeys;
 	int16	   *indoption = scan->indexRelation->rd_indoption;
 	int			numArrayKeys;
+	bool		skip;
+	int			nskip;
 	ScanKey		cur;
 	int			i;
 	MemoryContext oldContext;
@@ -231,16 +247,21 @@ _bt_preprocess_array_keys(IndexScanDesc scan)
 			{
 				so->numArrayKeys = -1;
 				so->arrayKeyData = NULL;
+				so->skipKey = NULL;
 				return;
 			}
 		}
 	}
 
+	skip = _bt_skip_scan_wanted(scan);
+	nskip = skip ? 1 : 0;
+
 	/* Quit if nothing to do. */
-	if (numArrayKeys == 0)
+	if (numArrayKeys == 0 && !skip)
 	{
 		so->numArrayKeys = 0;
 		so->arrayKeyData = NULL;
+		so->skipKey = NULL;
 		return;
 	}
 
@@ -257,11 +278,21 @@ _bt_preprocess_array_keys(IndexScanDesc scan)
 
 	oldContext = MemoryContextSwitchTo(so->arrayContext);
 
-	/* Create modifiable copy of scan->keyData in the workspace context */
-	so->arrayKeyData = (ScanKey) palloc(scan->numberOfKeys * sizeof(ScanKeyData));
-	memcpy(so->arrayKeyData,
+	/*
+	 * Create modifiable copy of scan->keyData in the workspace context,
+	 * leaving room for the skip scan key if any
+	 */
+	so->arrayKeyData = (ScanKey) palloc((scan->numberOfKeys + nskip) *
+										sizeof(ScanKeyData));
+	memcpy(so->arrayKeyData + nskip,
 		   scan->keyData,
 		   scan->numberOfKeys * sizeof(ScanKeyData));
+	so->skipKey = NULL;
+	if (skip)
+	{
+		so->skipKey = _bt_init_skip_key(scan);
+		_bt_set_skip_key(scan, BTSKIP_START, (Datum) 0);
+	}
 
 	/* Allocate space for per-array data in the workspace context */
 	so->arrayKeys = (BTArrayKeyInfo *) palloc0(numArrayKeys * sizeof(BTArrayKeyInfo));
@@ -280,7 +311,7 @@ _bt_preprocess_array_keys(IndexScanDesc scan)
 		int			num_nonnulls;
 		int			j;
 
-		cur = &so->arrayKeyData[i];
+		cur = &so->arrayKeyData[i + nskip];
 		if (!(cur->sk_flags & SK_SEARCHARRAY))
 			continue;
 
@@ -360,7 +391,7 @@ _bt_preprocess_array_keys(IndexScanDesc scan)
 		/*
 		 * And set up the BTArrayKeyInfo data.
 		 */
-		so->arrayKeys[numArrayKeys].scan_key = i;
+		so->arrayKeys[numArrayKeys].scan_key = i + nskip;
 		so->arrayKeys[numArrayKeys].num_elems = num_elems;
 		so->arrayKeys[numArrayKeys].elem_values = elem_values;
 		numArrayKeys++;
@@ -515,13 +546,237 @@ _bt_compare_array_elements(const void *a, const void *b, void *arg)
 	return compare;
 }
 
+/*
+ * _bt_skip_scan_wanted() -- should the scan skip over the first column?
+ *
+ * Only if the planner costed the scan as a skip scan, which it does when the
+ * first column has few enough distinct values for skipping to pay off.
+ * Scan keys are ordered by attribute, so if the first one is on the second
+ * index column, the first column has none.  A skip scan is not done if the
+ * qual can never be satisfied anyway, nor for parallel scans, whose
+ * participants must all step through the same sets of keys, which the
+ * probes of the index cannot guarantee.
+ */
+static bool
+_bt_skip_scan_wanted(IndexScanDesc scan)
+{
+	int			i;
+
+	if (!scan->xs_skip_scan ||
+		scan->parallel_scan != NULL ||
+		IndexRelationGetNumberOfKeyAttributes(scan->indexRelation) < 2 ||
+		scan->numberOfKeys < 1 ||
+		scan->keyData[0].sk_attno != 2)
+		return false;
+
+	for (i = 0; i < scan->numberOfKeys; i++)
+	{
+		ScanKey		cur = &scan->keyData[i];
+
+		if ((cur->sk_flags & SK_ISNULL) &&
+			!(cur->sk_flags & (SK_SEARCHNULL | SK_SEARCHNOTNULL)))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * _bt_init_skip_key() -- set up the skip scan key for the first column
+ *
+ * Allocates the BTSkipKeyInfo in the current memory context.
+ */
+static BTSkipKeyInfo *
+_bt_init_skip_key(IndexScanDesc scan)
+{
+	Relation	rel = scan->indexRelation;
+	Form_pg_attribute attr = TupleDescAttr(RelationGetDescr(rel), 0);
+	BTSkipKeyInfo *skip;
+
+	skip = (BTSkipKeyInfo *) palloc0(sizeof(BTSkipKeyInfo));
+	skip->state = BTSKIP_START;
+	skip->value = (Datum) 0;
+	skip->mark_state = BTSKIP_START;
+	skip->mark_value = (Datum) 0;
+	skip->attlen = attr->attlen;
+	skip->attbyval = attr->attbyval;
+	_bt_lookup_skip_operator(rel, BTEqualStrategyNumber, &skip->eq_finfo);
+	_bt_lookup_skip_operator(rel, BTLessStrategyNumber, &skip->lt_finfo);
+	_bt_lookup_skip_operator(rel, BTGreaterStrategyNumber, &skip->gt_finfo);
+
+	return skip;
+}
+
+/*
+ * _bt_lookup_skip_operator() -- look up a comparison operator for the skip
+ * scan key in the first column's opfamily
+ */
+static void
+_bt_lookup_skip_operator(Relation rel, StrategyNumber strat, FmgrInfo *finfo)
+{
+	Oid			opfamily = rel->rd_opfamily[0];
+	Oid			opcintype = rel->rd_opcintype[0];
+	Oid			cmp_op;
+	RegProcedure cmp_proc;
+
+	cmp_op = get_opfamily_member(opfamily, opcintype, opcintype, strat);
+	if (!OidIsValid(cmp_op))
+		elog(ERROR, "missing operator %d(%u,%u) in opfamily %u",
+			 strat, opcintype, opcintype, opfamily);
+	cmp_proc = get_opcode(cmp_op);
+	if (!RegProcedureIsValid(cmp_proc))
+		elog(ERROR, "missing oprcode for operator %u", cmp_op);
+
+	fmgr_info_cxt(cmp_proc, finfo, CurrentMemoryContext);
+}
+
+/*
+ * _bt_set_skip_key() -- move the skip scan key to a new state
+ *
+ * "value" becomes the current value of the key, which is freed when it is
+ * replaced, and fills in so->arrayKeyData[0] to match.
+ */
+static void
+_bt_set_skip_key(IndexScanDesc scan, BTSkipState state, Datum value)
+{
+	Relation	rel = scan->indexRelation;
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	BTSkipKeyInfo *skip = so->skipKey;
+	ScanKey		skey = &so->arrayKeyData[0];
+	bool		desc = (rel->rd_indoption[0] & INDOPTION_DESC) != 0;
+
+	if (value != skip->value)
+	{
+		if (!skip->attbyval && DatumGetPointer(skip->value) != NULL)
+			pfree(DatumGetPointer(skip->value));
+		skip->value = value;
+	}
+	skip->state = state;
+
+	switch (state)
+	{
+		case BTSKIP_VALUE:
+			ScanKeyEntryInitializeWithInfo(skey, 0, 1, BTEqualStrategyNumber,
+										   rel->rd_opcintype[0],
+										   rel->rd_indcollation[0],
+										   &skip->eq_finfo, value);
+			break;
+		case BTSKIP_NULL:
+			ScanKeyEntryInitialize(skey, SK_ISNULL | SK_SEARCHNULL, 1,
+								   InvalidStrategy, InvalidOid, InvalidOid,
+								   InvalidOid, (Datum) 0);
+			break;
+		case BTSKIP_RANGE:
+			/* the values after "value" in index order in range_dir */
+			if (ScanDirectionIsForward(skip->range_dir) != desc)
+				ScanKeyEntryInitializeWithInfo(skey, 0, 1,
+											   BTGreaterStrategyNumber,
+											   rel->rd_opcintype[0],
+											   rel->rd_indcollation[0],
+											   &skip->gt_finfo, value);
+			else
+				ScanKeyEntryInitializeWithInfo(skey, 0, 1,
+											   BTLessStrategyNumber,
+											   rel->rd_opcintype[0],
+											   rel->rd_indcollation[0],
+											   &skip->lt_finfo, value);
+			break;
+		case BTSKIP_START:
+			/* placeholder until the first value is known */
+			ScanKeyEntryInitialize(skey, SK_ISNULL | SK_SEARCHNOTNULL, 1,
+								   InvalidStrategy, InvalidOid, InvalidOid,
+								   InvalidOid, (Datum) 0);
+			break;
+	}
+}
+
+/*
+ * _bt_advance_skip_key() -- advance the skip scan key to the next value of
+ * the first column
+ *
+ * Returns false if there are no more values in the scan direction.
+ *
+ * The next value is found by probing the index with _bt_skip_probe.  When
+ * the column has many distinct values, the probes keep finding the next
+ * value on the page the previous primitive scan ended on, and skipping
+ * costs more than it saves.  After BTSKIP_MAX_DENSE_PROBES such probes, we
+ * give up skipping and turn the key into a range key covering all the
+ * remaining values, followed by the NULLs if they come after the values in
+ * the scan direction.
+ */
+#define BTSKIP_MAX_DENSE_PROBES		8
+
+static bool
+_bt_advance_skip_key(IndexScanDesc scan, ScanDirection dir)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	BTSkipKeyInfo *skip = so->skipKey;
+	int16	   *indoption = scan->indexRelation->rd_indoption;
+	bool		nulls_at_end;
+	Datum		value;
+	bool		isnull;
+	bool		samepage;
+
+	/* do the NULLs come after all the values in this direction? */
+	nulls_at_end = (ScanDirectionIsForward(dir) !=
+					((indoption[0] & INDOPTION_NULLS_FIRST) != 0));
+
+	switch (skip->state)
+	{
+		case BTSKIP_START:
+			break;
+		case BTSKIP_VALUE:
+			if (skip->dense_probes >= BTSKIP_MAX_DENSE_PROBES)
+			{
+				skip->range_dir = dir;
+				_bt_set_skip_key(scan, BTSKIP_RANGE, skip->value);
+				return true;
+			}
+			break;
+		case BTSKIP_NULL:
+			if (nulls_at_end)
+				return false;
+			break;
+		case BTSKIP_RANGE:
+			skip->dense_probes = 0;
+			if (skip->range_dir != dir)
+			{
+				/* the scan turned around, go back to where the range began */
+				_bt_set_skip_key(scan, BTSKIP_VALUE, skip->value);
+				return true;
+			}
+			if (!nulls_at_end)
+				return false;
+			_bt_set_skip_key(scan, BTSKIP_NULL, skip->value);
+			return true;
+	}
+
+	if (!_bt_skip_probe(scan, dir, &value, &isnull, &samepage))
+		return false;
+
+	if (samepage)
+		skip->dense_probes++;
+	else
+		skip->dense_probes = 0;
+
+	if (isnull)
+		_bt_set_skip_key(scan, BTSKIP_NULL, (Datum) 0);
+	else
+		_bt_set_skip_key(scan, BTSKIP_VALUE, value);
+
+	return true;
+}
+
 /*
  * _bt_start_array_keys() -- Initialize array keys at start of a scan
  *
  * Set up the cur_elem counters and fill in the first sk_argument value for
  * each array scankey.  We can't do this until we know the scan direction.
+ *
+ * Returns false if there is no set of keys to scan, which happens when the
+ * skip scan key finds the index empty.
  */
-void
+bool
 _bt_start_array_keys(IndexScanDesc scan, ScanDirection dir)
 {
 	BTScanOpaque so = (BTScanOpaque) scan->opaque;
@@ -539,6 +794,16 @@ _bt_start_array_keys(IndexScanDesc scan, ScanDirection dir)
 			curArrayKey->cur_elem = 0;
 		skey->sk_argument = curArrayKey->elem_values[curArrayKey->cur_elem];
 	}
+
+	/* The skip scan key probes the index for the first value */
+	if (so->skipKey != NULL)
+	{
+		_bt_set_skip_key(scan, BTSKIP_START, (Datum) 0);
+		so->skipKey->dense_probes = 0;
+		return _bt_advance_skip_key(scan, dir);
+	}
+
+	return true;
 }
 
 /*
@@ -594,6 +859,10 @@ _bt_advance_array_keys(IndexScanDesc scan, ScanDirection dir)
 			break;
 	}
 
+	/* The skip scan key is for the first column, so it advances last */
+	if (!found && so->skipKey != NULL)
+		found = _bt_advance_skip_key(scan, dir);
+
 	/* advance parallel scan */
 	if (scan->parallel_scan != NULL)
 		_bt_parallel_advance_array_keys(scan);
@@ -618,6 +887,25 @@ _bt_mark_array_keys(IndexScanDesc scan)
 
 		curArrayKey->mark_elem = curArrayKey->cur_elem;
 	}
+
+	if (so->skipKey != NULL)
+	{
+		BTSkipKeyInfo *skip = so->skipKey;
+		MemoryContext oldContext;
+
+		if (!skip->attbyval && DatumGetPointer(skip->mark_value) != NULL)
+			pfree(DatumGetPointer(skip->mark_value));
+		skip->mark_value = (Datum) 0;
+		skip->mark_state = skip->state;
+		skip->mark_range_dir = skip->range_dir;
+		if (skip->state == BTSKIP_VALUE || skip->state == BTSKIP_RANGE)
+		{
+			oldContext = MemoryContextSwitchTo(so->arrayContext);
+			skip->mark_value = datumCopy(skip->value, skip->attbyval,
+										 skip->attlen);
+			MemoryContextSwitchTo(oldContext);
+		}
+	}
 }
 
 /*
@@ -647,6 +935,26 @@ _bt_restore_array_keys(IndexScanDesc scan)
 		}
 	}
 
+	/* Likewise the skip scan key, whose values we don't bother to compare */
+	if (so->skipKey != NULL)
+	{
+		BTSkipKeyInfo *skip = so->skipKey;
+		Datum		value = (Datum) 0;
+		MemoryContext oldContext;
+
+		if (skip->mark_state == BTSKIP_VALUE ||
+			skip->mark_state == BTSKIP_RANGE)
+		{
+			oldContext = MemoryContextSwitchTo(so->arrayContext);
+			value = datumCopy(skip->mark_value, skip->attbyval, skip->attlen);
+			MemoryContextSwitchTo(oldContext);
+		}
+		skip->range_dir = skip->mark_range_dir;
+		skip->dense_probes = 0;
+		_bt_set_skip_key(scan, skip->mark_state, value);
+		changed = true;
+	}
+
 	/*
 	 * If we changed any keys, we must redo _bt_preprocess_keys.  That might
 	 * sound like overkill, but in cases with multiple keys per index column
@@ -770,10 +1078,15 @@ _bt_preprocess_keys(IndexScanDesc scan)
 		return;					/* done if qual-less scan */
 
 	/*
-	 * Read so->arrayKeyData if array keys are present, else scan->keyData
+	 * Read so->arrayKeyData if array keys are present, else scan->keyData.
+	 * The former starts with the skip scan key, if any.
 	 */
 	if (so->arrayKeyData != NULL)
+	{
 		inkeys = so->arrayKeyData;
+		if (so->skipKey != NULL)
+			numberOfKeys++;
+	}
 	else
 		inkeys = scan->keyData;
 
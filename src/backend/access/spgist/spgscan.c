@@ -421,6 +421,11 @@ spgrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
 	/* set up starting queue entries */
 	resetSpGistScanOpaque(so);
 
+	/* A rescan starts with what the previous scans learned, see prefetch.c */
+	PrefetchControlRescan(&so->index_prefetch,
+						  index_prefetch_maximum(scan->indexRelation), 1);
+	index_heap_prefetch_rescan(scan, &so->heap_prefetch);
+
 	/* count an indexscan for stats */
 	pgstat_count_index_scan(scan->indexRelation);
 }
@@ -704,6 +709,8 @@ spgInnerTest(SpGistScanOpaque so, SpGistSearchItem *item,
 		/* collect node pointers */
 		SpGistNodeTuple node;
 		SpGistNodeTuple *nodes = (SpGistNodeTuple *) palloc(sizeof(SpGistNodeTuple) * nNodes);
+		BlockNumber *children = (BlockNumber *) palloc(sizeof(BlockNumber) * out.nNodes);
+		int			nchildren = 0;
 
 		SGITITERATE(innerTuple, i, node)
 		{
@@ -735,6 +742,25 @@ spgInnerTest(SpGistScanOpaque so, SpGistSearchItem *item,
 										 distances);
 
 			spgAddSearchItemToQueue(so, innerItem);
+			children[nchildren++] = ItemPointerGetBlockNumber(&node->t_tid);
+		}
+
+		/*
+		 * Prefetch the child pages, as in gistScanPage: without ORDER BY the
+		 * queue returns them in LIFO order, and a bitmap scan visits all.
+		 */
+		if (nchildren > 0 && so->numberOfOrderBys == 0)
+		{
+			int			n = so->tbm ? so->index_prefetch.maximum
+				: PrefetchControlTarget(&so->index_prefetch);
+
+			n = Min(n, nchildren);
+			if (n > 0)
+			{
+				PrefetchBuffers(so->state.index, MAIN_FORKNUM,
+								children + nchildren - n, n);
+				PrefetchControlIssued(&so->index_prefetch, n);
+			}
 		}
 	}
 
@@ -849,11 +875,13 @@ redirect:
 
 			if (buffer == InvalidBuffer)
 			{
+				PrefetchControlConsume(&so->index_prefetch);
 				buffer = ReadBuffer(index, blkno);
 				LockBuffer(buffer, BUFFER_LOCK_SHARE);
 			}
 			else if (blkno != BufferGetBlockNumber(buffer))
 			{
+				PrefetchControlConsume(&so->index_prefetch);
 				UnlockReleaseBuffer(buffer);
 				buffer = ReadBuffer(index, blkno);
 				LockBuffer(buffer, BUFFER_LOCK_SHARE);
@@ -1039,6 +1067,8 @@ spggettuple(IndexScanDesc scan, ScanDirection dir)
 		if (so->iPtr < so->nPtrs)
 		{
 			/* continuing to return reported tuples */
+			if (so->iPtr > 0)
+				PrefetchQueueConsume(&so->heap_prefetch);
 			scan->xs_heaptid = so->heapPtrs[so->iPtr];
 			scan->xs_recheck = so->recheck[so->iPtr];
 			scan->xs_hitup = so->reconTups[so->iPtr];
@@ -1076,6 +1106,16 @@ spggettuple(IndexScanDesc scan, ScanDirection dir)
 
 		if (so->nPtrs == 0)
 			break;				/* must have completed scan */
+
+		/* Prefetch the heap pages of the tuples we are about to return */
+		if (PrefetchQueueEnabled(&so->heap_prefetch))
+		{
+			PrefetchQueueReset(&so->heap_prefetch);
+			for (int i = 0; i < so->nPtrs; i++)
+				PrefetchQueueAdd(&so->heap_prefetch,
+								 ItemPointerGetBlockNumber(&so->heapPtrs[i]));
+			PrefetchQueueIssue(&so->heap_prefetch);
+		}
 	}
 
 	return false;
@@ -346,7 +346,7 @@ void
 simple_table_tuple_update(Relation rel, ItemPointer otid,
 						  TupleTableSlot *slot,
 						  Snapshot snapshot,
-						  bool *update_indexes)
+						  TU_UpdateIndexes *update_indexes)
 {
 	TM_Result	result;
 	TM_FailureData tmfd;
@@ -490,6 +490,32 @@ retry:
 	SpinLockRelease(&pbscan->phs_mutex);
 }
 
+/*
+ * allocate a new chunk of blocks to a worker
+ *
+ * Returns the scan offset of the first block of the chunk, and sets
+ * pbscanwork->phsw_chunk_size to its size.
+ */
+static uint64
+table_block_parallelscan_allocchunk(ParallelBlockTableScanWorker pbscanwork,
+									ParallelBlockTableScanDesc pbscan)
+{
+	/*
+	 * When we've only got PARALLEL_SEQSCAN_RAMPDOWN_CHUNKS chunks remaining
+	 * in the scan, we half the chunk size.  Since we reduce the chunk size
+	 * here, we'll hit this again after doing PARALLEL_SEQSCAN_RAMPDOWN_CHUNKS
+	 * at the new size.  After a few iterations of this, we'll end up doing
+	 * the last few blocks with the chunk size set to 1.
+	 */
+	if (pbscanwork->phsw_chunk_size > 1 &&
+		pbscanwork->phsw_nallocated > pbscan->phs_nblocks -
+		(pbscanwork->phsw_chunk_size * PARALLEL_SEQSCAN_RAMPDOWN_CHUNKS))
+		pbscanwork->phsw_chunk_size >>= 1;
+
+	return pg_atomic_fetch_add_u64(&pbscan->phs_nallocated,
+								   pbscanwork->phsw_chunk_size);
+}
+
 /*
  * get the next page to scan
  *
@@ -530,7 +556,8 @@ table_block_parallelscan_nextpage(Relation rel,
 	 *
 	 * Here pbscanwork is local worker memory.  phsw_chunk_remaining tracks
 	 * the number of blocks remaining in the chunk.  When that reaches 0 then
-	 * we must allocate a new chunk for the worker.
+	 * we must allocate a new chunk for the worker, unless it has already
+	 * claimed one with table_block_parallelscan_claimnext.
 	 *
 	 * phs_nallocated tracks how many blocks have been allocated to workers
 	 * already.  When phs_nallocated >= rs_nblocks, all blocks have been
@@ -561,24 +588,18 @@ table_block_parallelscan_nextpage(Relation rel,
 		nallocated = ++pbscanwork->phsw_nallocated;
 		pbscanwork->phsw_chunk_remaining--;
 	}
+	else if (pbscanwork->phsw_next_chunk_size > 0)
+	{
+		/* Move on to the chunk claimed in advance. */
+		nallocated = pbscanwork->phsw_nallocated =
+			pbscanwork->phsw_next_nallocated;
+		pbscanwork->phsw_chunk_remaining = pbscanwork->phsw_next_chunk_size - 1;
+		pbscanwork->phsw_next_chunk_size = 0;
+	}
 	else
 	{
-		/*
-		 * When we've only got PARALLEL_SEQSCAN_RAMPDOWN_CHUNKS chunks
-		 * remaining in the scan, we half the chunk size.  Since we reduce the
-		 * chunk size here, we'll hit this again after doing
-		 * PARALLEL_SEQSCAN_RAMPDOWN_CHUNKS at the new size.  After a few
-		 * iterations of this, we'll end up doing the last few blocks with the
-		 * chunk size set to 1.
-		 */
-		if (pbscanwork->phsw_chunk_size > 1 &&
-			pbscanwork->phsw_nallocated > pbscan->phs_nblocks -
-			(pbscanwork->phsw_chunk_size * PARALLEL_SEQSCAN_RAMPDOWN_CHUNKS))
-			pbscanwork->phsw_chunk_size >>= 1;
-
 		nallocated = pbscanwork->phsw_nallocated =
-			pg_atomic_fetch_add_u64(&pbscan->phs_nallocated,
-									pbscanwork->phsw_chunk_size);
+			table_block_parallelscan_allocchunk(pbscanwork, pbscan);
 
 		/*
 		 * Set the remaining number of blocks in this chunk so that subsequent
@@ -610,6 +631,46 @@ table_block_parallelscan_nextpage(Relation rel,
 	return page;
 }
 
+/*
+ * claim the chunk a worker will scan after its current one
+ *
+ * A worker that prefetches ahead of the page it is scanning calls this when
+ * its prefetch window reaches the end of its current chunk, so that it can
+ * keep prefetching across the chunk boundary instead of stalling on the
+ * first page of each chunk.  The chunk is allocated like the ones
+ * table_block_parallelscan_nextpage allocates, and that function moves on to
+ * it once the current chunk is done.  Only one chunk is claimed in advance;
+ * calling this again before then returns the same one.
+ *
+ * Returns the number of blocks of the claimed chunk that are within the
+ * scan, which is 0 once all blocks have been allocated.  The scan offset of
+ * the first block of the chunk is in pbscanwork->phsw_next_nallocated.
+ */
+uint32
+table_block_parallelscan_claimnext(ParallelBlockTableScanWorker pbscanwork,
+								   ParallelBlockTableScanDesc pbscan)
+{
+	uint64		nallocated;
+
+	if (pbscanwork->phsw_next_chunk_size == 0)
+	{
+		/* nothing more to claim */
+		if (pg_atomic_read_u64(&pbscan->phs_nallocated) >= pbscan->phs_nblocks)
+			return 0;
+
+		pbscanwork->phsw_next_nallocated =
+			table_block_parallelscan_allocchunk(pbscanwork, pbscan);
+		pbscanwork->phsw_next_chunk_size = pbscanwork->phsw_chunk_size;
+	}
+
+	nallocated = pbscanwork->phsw_next_nallocated;
+	if (nallocated >= pbscan->phs_nblocks)
+		return 0;
+
+	return (uint32) Min(pbscanwork->phsw_next_chunk_size,
+						pbscan->phs_nblocks - nallocated);
+}
+
 /* ----------------------------------------------------------------------------
  * Helper functions to implement relation sizing for block oriented AMs.
  * ----------------------------------------------------------------------------
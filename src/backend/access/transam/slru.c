@@ -120,6 +120,17 @@ typedef struct SlruWriteAllData *SlruWriteAll;
 		} \
 	} while (0)
 
+/*
+ * Compute the range of slots [*first, *last) of the bank that page "pageno"
+ * must be kept in.
+ */
+#define SlruBankSlots(shared, pageno, first, last) \
+	do { \
+		int		bankno = (uint32) (pageno) % (shared)->num_banks; \
+		*(first) = bankno * (shared)->num_slots / (shared)->num_banks; \
+		*(last) = (bankno + 1) * (shared)->num_slots / (shared)->num_banks; \
+	} while (0)
+
 /* Saved info for SlruReportIOError */
 typedef enum
 {
@@ -210,6 +221,7 @@ SimpleLruInit(SlruCtl ctl, const char *name, int nslots, int nlsns,
 		shared->ControlLock = ctllock;
 
 		shared->num_slots = nslots;
+		shared->num_banks = Max(nslots / SLRU_BANK_SIZE, 1);
 		shared->lsn_groups_per_page = nlsns;
 
 		shared->cur_lru_count = 0;
@@ -497,12 +509,16 @@ SimpleLruReadPage_ReadOnly(SlruCtl ctl, int pageno, TransactionId xid)
 {
 	SlruShared	shared = ctl->shared;
 	int			slotno;
+	int			firstslot;
+	int			lastslot;
+
+	SlruBankSlots(shared, pageno, &firstslot, &lastslot);
 
 	/* Try to find the page while holding only shared lock */
 	LWLockAcquire(shared->ControlLock, LW_SHARED);
 
 	/* See if page is already in a buffer */
-	for (slotno = 0; slotno < shared->num_slots; slotno++)
+	for (slotno = firstslot; slotno < lastslot; slotno++)
 	{
 		if (shared->page_number[slotno] == pageno &&
 			shared->page_status[slotno] != SLRU_PAGE_EMPTY &&
@@ -1009,7 +1025,7 @@ SlruReportIOError(SlruCtl ctl, int pageno, TransactionId xid)
  * any slot already holds the target page, and return that slot if so.
  * Thus, the returned slot is *either* a slot already holding the pageno
  * (could be any state except EMPTY), *or* a freeable slot (state EMPTY
- * or CLEAN).
+ * or CLEAN).  Only the slots of the page's bank are considered.
  *
  * Control lock must be held at entry, and will be held at exit.
  */
@@ -1017,6 +1033,10 @@ static int
 SlruSelectLRUPage(SlruCtl ctl, int pageno)
 {
 	SlruShared	shared = ctl->shared;
+	int			firstslot;
+	int			lastslot;
+
+	SlruBankSlots(shared, pageno, &firstslot, &lastslot);
 
 	/* Outer loop handles restart after I/O */
 	for (;;)
@@ -1031,7 +1051,7 @@ SlruSelectLRUPage(SlruCtl ctl, int pageno)
 		int			best_invalid_page_number = 0;	/* keep compiler quiet */
 
 		/* See if page already has a buffer assigned */
-		for (slotno = 0; slotno < shared->num_slots; slotno++)
+		for (slotno = firstslot; slotno < lastslot; slotno++)
 		{
 			if (shared->page_number[slotno] == pageno &&
 				shared->page_status[slotno] != SLRU_PAGE_EMPTY)
@@ -1066,7 +1086,7 @@ SlruSelectLRUPage(SlruCtl ctl, int pageno)
 		 * multiple pages with the same lru_count.
 		 */
 		cur_count = (shared->cur_lru_count)++;
-		for (slotno = 0; slotno < shared->num_slots; slotno++)
+		for (slotno = firstslot; slotno < lastslot; slotno++)
 		{
 			int			this_delta;
 			int			this_page_number;
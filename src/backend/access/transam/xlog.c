@@ -69,6 +69,7 @@
 #include "catalog/pg_database.h"
 #include "common/controldata_utils.h"
 #include "common/file_utils.h"
+#include "common/hashfn.h"
 #include "executor/instrument.h"
 #include "miscadmin.h"
 #include "pg_trace.h"
@@ -83,6 +84,7 @@
 #include "replication/slot.h"
 #include "replication/snapbuild.h"
 #include "replication/walreceiver.h"
+#include "replication/syncrep.h"
 #include "replication/walsender.h"
 #include "storage/bufmgr.h"
 #include "storage/buf_internals.h"
@@ -124,15 +126,18 @@ bool		EnableHotStandby = false;
 bool		fullPageWrites = true;
 bool		wal_log_hints = false;
 int			wal_compression = WAL_COMPRESSION_NONE;
+int			wal_compression_zstd_level = 3;
 char	   *wal_consistency_checking_string = NULL;
 bool	   *wal_consistency_checking = NULL;
 bool		wal_init_zero = true;
 bool		wal_recycle = true;
+int			wal_preallocate_segments = 0;
 bool		log_checkpoints = true;
 int			sync_method = DEFAULT_SYNC_METHOD;
 int			wal_level = WAL_LEVEL_MINIMAL;
 int			CommitDelay = 0;	/* precommit delay in microseconds */
 int			CommitSiblings = 5; /* # concurrent xacts needed to sleep */
+bool		adaptive_commit_delay = false;	/* size delay by sync rep acks */
 int			wal_retrieve_retry_interval = 5000;
 int			max_slot_wal_keep_size_mb = -1;
 int			wal_decode_buffer_size = 512 * 1024;
@@ -147,11 +152,14 @@ bool		XLOG_DEBUG = false;
 int			wal_segment_size = DEFAULT_XLOG_SEG_SIZE;
 
 /*
- * Number of WAL insertion locks to use. A higher value allows more insertions
- * to happen concurrently, but adds some CPU overhead to flushing the WAL,
- * which needs to iterate all the locks.
+ * Number of WAL insertion locks to use (wal_insert_locks). A higher value
+ * allows more insertions to happen concurrently, but adds some CPU overhead
+ * to flushing the WAL, which needs to iterate all the locks.  -1 means to
+ * size it from max_connections, see XLOGChooseNumInsertLocks.
  */
-#define NUM_XLOGINSERT_LOCKS  8
+int			wal_insert_locks = -1;
+
+#define NUM_XLOGINSERT_LOCKS  wal_insert_locks
 
 /*
  * Max distance from last checkpoint, before triggering a new xlog-based
@@ -201,24 +209,88 @@ const struct config_enum_entry archive_mode_options[] = {
 	{NULL, 0, false}
 };
 
+/*
+ * Cache of last written LSN for each relation page.
+ * Also to provide request LSN for smgrnblocks, smgrexists there is pseudokey=InvalidBlockId which stores LSN of last
+ * relation metadata update.
+ * Size of the cache is limited by GUC variable lastWrittenLsnCacheSize ("lsn_cache_size").
+ *
+ * The cache is split into LAST_WRITTEN_LSN_PARTITIONS partitions, each with
+ * its own LWLock that serializes modifications of its entries.  Entries are
+ * grouped into sets of LAST_WRITTEN_LSN_SET_SIZE: a page can only be cached
+ * in the set its BufferTag hashes to, and when the set is full a victim is
+ * chosen with a clock sweep over the set.  The LSN of an evicted entry is
+ * folded into the partition's maxLsn, which serves as the upper bound for
+ * all pages of the partition that are not cached.
+ *
+ * Writes that cover many blocks at once, like a bulk load or an index
+ * build, are remembered as a single block range instead of one entry per
+ * block, so that they don't flush the per-page entries of everybody else.
+ * Ranges of a relation fork live in a small per-partition table (keyed by
+ * the relation fork, not the page) with its own clock sweep and maxLsn, and
+ * adjacent or overlapping ranges of the same fork are coalesced.  When the
+ * relation is extended one block at a time right past the end of a range,
+ * the range simply grows.  The last written LSN of a page is the maximum of
+ * what the per-page entries and the ranges report for it.
+ *
+ * Lookups don't take the partition lock.  Each entry has a change counter
+ * that is odd while the entry's key is being changed; a reader that sees
+ * the counter odd, or changed during its read, simply retries.
+ */
+#define LAST_WRITTEN_LSN_PARTITIONS		16	/* must be a power of 2 */
+#define LAST_WRITTEN_LSN_SET_SIZE		8
+#define LAST_WRITTEN_LSN_RANGES			32	/* ranges per partition */
+
 typedef struct LastWrittenLsnCacheEntry
 {
+	pg_atomic_uint32 changecount;	/* odd while the key is being changed */
+	bool		valid;			/* does the entry hold a page? */
+	bool		referenced;		/* clock reference bit; only a hint */
 	BufferTag	key;
-	XLogRecPtr	lsn;
-	/* double linked list for LRU replacement algorithm */
-	dlist_node	lru_node;
+	pg_atomic_uint64 lsn;
 } LastWrittenLsnCacheEntry;
 
+typedef struct LastWrittenLsnCacheSet
+{
+	int			clock_hand;		/* next entry to consider for eviction */
+	LastWrittenLsnCacheEntry entries[LAST_WRITTEN_LSN_SET_SIZE];
+} LastWrittenLsnCacheSet;
 
-/*
- * Cache of last written LSN for each relation page.
- * Also to provide request LSN for smgrnblocks, smgrexists there is pseudokey=InvalidBlockId which stores LSN of last
- * relation metadata update.
- * Size of the cache is limited by GUC variable lastWrittenLsnCacheSize ("lsn_cache_size"),
- * pages are replaced using LRU algorithm, based on L2-list.
- * Access to this cache is protected by 'LastWrittenLsnLock'.
- */
-static HTAB *lastWrittenLsnCache;
+typedef struct LastWrittenLsnCacheRange
+{
+	pg_atomic_uint32 changecount;	/* odd while the range is being changed */
+	bool		valid;			/* does the entry hold a range? */
+	bool		referenced;		/* clock reference bit; only a hint */
+	RelFileNode rnode;
+	ForkNumber	forknum;
+	BlockNumber from;			/* first block of the range */
+	BlockNumber to;				/* first block after the range */
+	pg_atomic_uint64 lsn;
+} LastWrittenLsnCacheRange;
+
+typedef struct LastWrittenLsnCacheRanges
+{
+	int			clock_hand;		/* next range to consider for eviction */
+	/* Maximal last written LSN of ranges evicted from this partition */
+	pg_atomic_uint64 maxLsn;
+	LastWrittenLsnCacheRange ranges[LAST_WRITTEN_LSN_RANGES];
+} LastWrittenLsnCacheRanges;
+
+typedef struct LastWrittenLsnCacheCtl
+{
+	LWLockPadded locks[LAST_WRITTEN_LSN_PARTITIONS];
+	LastWrittenLsnCacheRanges ranges[LAST_WRITTEN_LSN_PARTITIONS];
+	/* Maximal last written LSN for pages of a partition not present in cache */
+	pg_atomic_uint64 maxLsn[LAST_WRITTEN_LSN_PARTITIONS];
+	int			nsets;
+	LastWrittenLsnCacheSet sets[FLEXIBLE_ARRAY_MEMBER];
+} LastWrittenLsnCacheCtl;
+
+static LastWrittenLsnCacheCtl *lastWrittenLsnCache;
+
+static Size LastWrittenLsnCacheShmemSize(void);
+static void LastWrittenLsnCacheShmemInit(void);
+static void ResetLastWrittenLsnCache(XLogRecPtr lsn);
 
 /*
  * Statistics for current checkpoint are collected in this global struct.
@@ -574,16 +646,6 @@ typedef struct XLogCtlData
 	 */
 	XLogRecPtr	lastFpwDisableRecPtr;
 
-	/*
-	 * Maximal last written LSN for pages not present in lastWrittenLsnCache
-	 */
-	XLogRecPtr  maxLastWrittenLsn;
-
-	/*
-	 * Double linked list to implement LRU replacement policy for last written LSN cache.
-	 * Access to this list as well as to last written LSN cache is protected by 'LastWrittenLsnLock'.
-	 */
-	dlist_head lastWrittenLsnLRU;
 
 	/* neon: copy of startup's RedoStartLSN for walproposer's use */
 	XLogRecPtr	RedoStartLSN;
@@ -2562,6 +2624,7 @@ XLogFlush(XLogRecPtr record)
 	XLogRecPtr	WriteRqstPtr;
 	XLogwrtRqst WriteRqst;
 	TimeLineID	insertTLI = XLogCtl->InsertTimeLineID;
+	int			commit_delay;
 
 	/*
 	 * During REDO, we are reading not writing WAL.  Therefore, instead of
@@ -2659,11 +2722,21 @@ XLogFlush(XLogRecPtr record)
 		 *
 		 * We do not sleep if enableFsync is not turned on, nor if there are
 		 * fewer than CommitSiblings other backends with active transactions.
+		 *
+		 * With adaptive_commit_delay, the commits wait for a sync standby
+		 * (a safekeeper, with Neon) rather than for the fsync, so the delay
+		 * is sized by how long the standby takes to confirm a flush and how
+		 * many commits one confirmation releases, with commit_delay as the
+		 * upper limit if set.  A single confirmation then releases all the
+		 * commits that joined the group.
 		 */
-		if (CommitDelay > 0 && enableFsync &&
-			MinimumActiveBackends(CommitSiblings))
+		if (adaptive_commit_delay)
+			commit_delay = SyncRepGroupCommitDelay(CommitDelay, CommitSiblings);
+		else
+			commit_delay = enableFsync ? CommitDelay : 0;
+		if (commit_delay > 0 && MinimumActiveBackends(CommitSiblings))
 		{
-			pg_usleep(CommitDelay);
+			pg_usleep(commit_delay);
 
 			/*
 			 * Re-check how far we can now flush the WAL. It's generally not
@@ -3156,13 +3229,21 @@ XLogFileInitInternal(XLogSegNo logsegno, TimeLineID logtli,
 int
 XLogFileInit(XLogSegNo logsegno, TimeLineID logtli)
 {
-	bool		ignore_added;
+	bool		added;
 	char		path[MAXPGPATH];
 	int			fd;
 
 	Assert(logtli != 0);
 
-	fd = XLogFileInitInternal(logsegno, logtli, &ignore_added, path);
+	fd = XLogFileInitInternal(logsegno, logtli, &added, path);
+
+	/*
+	 * Count the segments that had to be created while writing WAL, because
+	 * neither a checkpoint nor the WAL writer had got it ready in time.
+	 */
+	if (added)
+		PendingWalStats.wal_segment_init++;
+
 	if (fd >= 0)
 		return fd;
 
@@ -3495,6 +3576,48 @@ PreallocXlogFiles(XLogRecPtr endptr, TimeLineID tli)
 	}
 }
 
+/*
+ * Make sure the wal_preallocate_segments segments following the one being
+ * inserted into exist, so that backends writing WAL find them ready instead
+ * of having to create and fill them.  This is called by the WAL writer.
+ *
+ * At most one segment is created per call, so that the WAL writer gets back
+ * to flushing WAL soon.  Returns true if a segment was created.
+ */
+bool
+XLogPreallocateSegments(void)
+{
+	XLogSegNo	segno;
+	TimeLineID	tli;
+
+	if (wal_preallocate_segments <= 0 || RecoveryInProgress())
+		return false;
+	if (!XLogCtl->InstallXLogFileSegmentActive)
+		return false;			/* unlocked check says no */
+
+	XLByteToSeg(GetXLogInsertRecPtr(), segno, wal_segment_size);
+	tli = GetWALInsertionTimeLine();
+
+	for (int i = 1; i <= wal_preallocate_segments; i++)
+	{
+		char		path[MAXPGPATH];
+		struct stat stat_buf;
+		bool		added;
+		int			fd;
+
+		XLogFilePath(path, tli, segno + i, wal_segment_size);
+		if (stat(path, &stat_buf) == 0)
+			continue;
+
+		fd = XLogFileInitInternal(segno + i, tli, &added, path);
+		if (fd >= 0)
+			close(fd);
+		return added;
+	}
+
+	return false;
+}
+
 /*
  * Throws an error if the given log segment has already been removed or
  * recycled. The caller should only pass a segment that it knows to have
@@ -4332,6 +4455,59 @@ XLOGChooseNumBuffers(void)
 	return xbuffers;
 }
 
+/*
+ * Auto-tune the number of WAL insertion locks.
+ *
+ * The default of 8 locks is enough for the insertions that a handful of CPUs
+ * can do concurrently.  On a larger server with many connections, use one
+ * lock per 16 backends, up to 64.
+ *
+ * This should not be called until MaxBackends has received its final value.
+ */
+static int
+XLOGChooseNumInsertLocks(void)
+{
+	return Min(Max(MaxBackends / 16, 8), 64);
+}
+
+/*
+ * GUC check_hook for wal_insert_locks
+ */
+bool
+check_wal_insert_locks(int *newval, void **extra, GucSource source)
+{
+	/*
+	 * -1 indicates a request for auto-tune.
+	 */
+	if (*newval == -1)
+	{
+		/*
+		 * If we haven't yet changed the boot_val default of -1, just let it
+		 * be.  We'll fix it when XLOGShmemSize is called.
+		 */
+		if (wal_insert_locks == -1)
+			return true;
+
+		/* Otherwise, substitute the auto-tune value */
+		*newval = XLOGChooseNumInsertLocks();
+	}
+
+	/*
+	 * The range allows 0, but at least one lock is needed.  The range's
+	 * upper limit is MAX_WAL_INSERT_LOCKS already, but check it here too,
+	 * because exceeding it would end in a PANIC: WALInsertLockAcquireExclusive
+	 * takes all the locks at once within a critical section.
+	 */
+	if (*newval < 1 || *newval > MAX_WAL_INSERT_LOCKS)
+	{
+		GUC_check_errdetail("\"wal_insert_locks\" must be -1 or between 1 and %d.",
+							MAX_WAL_INSERT_LOCKS);
+		return false;
+	}
+
+	return true;
+}
+
 /*
  * GUC check_hook for wal_buffers
  */
@@ -4416,6 +4592,20 @@ XLOGCtlShmemSize(void)
 	}
 	Assert(XLOGbuffers > 0);
 
+	/* Likewise for wal_insert_locks, which needs MaxBackends */
+	if (wal_insert_locks == -1)
+	{
+		char		buf[32];
+
+		snprintf(buf, sizeof(buf), "%d", XLOGChooseNumInsertLocks());
+		SetConfigOption("wal_insert_locks", buf, PGC_POSTMASTER,
+						PGC_S_DYNAMIC_DEFAULT);
+		if (wal_insert_locks == -1)	/* failed to apply it? */
+			SetConfigOption("wal_insert_locks", buf, PGC_POSTMASTER,
+							PGC_S_OVERRIDE);
+	}
+	Assert(wal_insert_locks > 0);
+
 	/* XLogCtl */
 	size = sizeof(XLogCtlData);
 
@@ -4443,8 +4633,7 @@ XLOGCtlShmemSize(void)
 Size
 XLOGShmemSize(void)
 {
-	return XLOGCtlShmemSize() +
-		hash_estimate_size(lastWrittenLsnCacheSize, sizeof(LastWrittenLsnCacheEntry));
+	return add_size(XLOGCtlShmemSize(), LastWrittenLsnCacheShmemSize());
 }
 
 void
@@ -4476,16 +4665,7 @@ XLOGShmemInit(void)
 	XLogCtl = (XLogCtlData *)
 		ShmemInitStruct("XLOG Ctl", XLOGCtlShmemSize(), &foundXLog);
 
-	if (lastWrittenLsnCacheSize > 0)
-	{
-		static HASHCTL info;
-		info.keysize = sizeof(BufferTag);
-		info.entrysize = sizeof(LastWrittenLsnCacheEntry);
-		lastWrittenLsnCache = ShmemInitHash("last_written_lsn_cache",
-											lastWrittenLsnCacheSize, lastWrittenLsnCacheSize,
-											&info,
-											HASH_ELEM | HASH_BLOBS);
-	}
+	LastWrittenLsnCacheShmemInit();
 
 	localControlFile = ControlFile;
 	ControlFile = (ControlFileData *)
@@ -5057,6 +5237,9 @@ StartupXLOG(void)
 	XLogRecPtr	missingContrecPtr;
 	TransactionId oldestActiveXID;
 	bool		promoted = false;
+	TimestampTz startupStart;
+	TimestampTz recoverySetupDone = 0;
+	TimestampTz subsystemsDone = 0;
 
 	/*
 	 * We should have an aux process resource owner to use, and we should not
@@ -5071,6 +5254,7 @@ StartupXLOG(void)
 	 * Read zenith.signal before anything else.
 	 */
 	readZenithSignalFile();
+	startupStart = GetCurrentTimestamp();
 
 	/*
 	 * Check that contents look valid.
@@ -5161,13 +5345,18 @@ StartupXLOG(void)
 	 *   which we had not actually fsync'd yet.  Therefore, a power failure in
 	 *   the near future might cause earlier unflushed writes to be lost, even
 	 *   though more recent data written to disk from here on would be
-	 *   persisted.  To avoid that, fsync the entire data directory.
+	 *   persisted.  To avoid that, fsync the entire data directory.  That is
+	 *   not necessary when starting from a page server basebackup: the data
+	 *   directory is thrown away with the compute node, and anything that
+	 *   must survive it is in the WAL sent to the safekeepers.  Syncing it
+	 *   would only delay the start of the compute node.
 	 */
 	if (ControlFile->state != DB_SHUTDOWNED &&
 		ControlFile->state != DB_SHUTDOWNED_IN_RECOVERY)
 	{
 		RemoveTempXlogFiles();
-		SyncDataDirectory();
+		if (!ZenithRecoveryRequested)
+			SyncDataDirectory();
 		didCrash = true;
 	}
 	else
@@ -5184,6 +5373,8 @@ StartupXLOG(void)
 	InitWalRecovery(ControlFile, &wasShutdown,
 					&haveBackupLabel, &haveTblspcMap);
 	checkPoint = ControlFile->checkPointCopy;
+	if (ZenithRecoveryRequested)
+		recoverySetupDone = GetCurrentTimestamp();
 
 	/* initialize shared memory variables from the checkpoint record */
 	ShmemVariableCache->nextXid = checkPoint.nextXid;
@@ -5307,10 +5498,11 @@ StartupXLOG(void)
 	/*
 	 * Setup last written lsn cache, max written LSN.
 	 * Starting from here, we could be modifying pages through REDO, which requires
-	 * the existance of maxLwLsn + LwLsn LRU.
+	 * the existance of maxLwLsn + LwLsn cache.
 	 */
-	XLogCtl->maxLastWrittenLsn = RedoRecPtr;
-	dlist_init(&XLogCtl->lastWrittenLsnLRU);
+	ResetLastWrittenLsnCache(RedoRecPtr);
+	if (ZenithRecoveryRequested)
+		subsystemsDone = GetCurrentTimestamp();
 
 	/* REDO */
 	if (InRecovery)
@@ -5815,6 +6007,24 @@ StartupXLOG(void)
 	 */
 	if (promoted)
 		RequestCheckpoint(CHECKPOINT_FORCE);
+
+	/*
+	 * Cold start time of a compute node matters, so report where it went
+	 * when starting from a page server basebackup.
+	 */
+	if (ZenithRecoveryRequested)
+	{
+		TimestampTz now = GetCurrentTimestamp();
+
+		ereport(LOG,
+				(errmsg("startup from page server basebackup completed in %ld ms, %ld ms after postmaster start",
+						TimestampDifferenceMilliseconds(startupStart, now),
+						TimestampDifferenceMilliseconds(PgStartTime, now)),
+				 errdetail("control file and recovery setup: %ld ms, subsystem startup: %ld ms, end of recovery: %ld ms.",
+						   TimestampDifferenceMilliseconds(startupStart, recoverySetupDone),
+						   TimestampDifferenceMilliseconds(recoverySetupDone, subsystemsDone),
+						   TimestampDifferenceMilliseconds(subsystemsDone, now))));
+	}
 }
 
 /*
@@ -6106,61 +6316,519 @@ GetInsertRecPtr(void)
 	return recptr;
 }
 
+/*
+ * LastWrittenLsnCacheShmemSize -- shared memory needed for the cache
+ */
+static Size
+LastWrittenLsnCacheShmemSize(void)
+{
+	int			nsets;
+
+	nsets = (lastWrittenLsnCacheSize + LAST_WRITTEN_LSN_SET_SIZE - 1) /
+		LAST_WRITTEN_LSN_SET_SIZE;
+	return add_size(offsetof(LastWrittenLsnCacheCtl, sets),
+					mul_size(nsets, sizeof(LastWrittenLsnCacheSet)));
+}
+
+/*
+ * LastWrittenLsnCacheShmemInit -- allocate and initialize the cache
+ */
+static void
+LastWrittenLsnCacheShmemInit(void)
+{
+	bool		found;
+
+	lastWrittenLsnCache = (LastWrittenLsnCacheCtl *)
+		ShmemInitStruct("last_written_lsn_cache",
+						LastWrittenLsnCacheShmemSize(), &found);
+	if (!found)
+	{
+		lastWrittenLsnCache->nsets =
+			(lastWrittenLsnCacheSize + LAST_WRITTEN_LSN_SET_SIZE - 1) /
+			LAST_WRITTEN_LSN_SET_SIZE;
+
+		for (int i = 0; i < LAST_WRITTEN_LSN_PARTITIONS; i++)
+		{
+			LWLockInitialize(&lastWrittenLsnCache->locks[i].lock,
+							 LWTRANCHE_LAST_WRITTEN_LSN_CACHE);
+			pg_atomic_init_u64(&lastWrittenLsnCache->maxLsn[i],
+							   InvalidXLogRecPtr);
+
+			lastWrittenLsnCache->ranges[i].clock_hand = 0;
+			pg_atomic_init_u64(&lastWrittenLsnCache->ranges[i].maxLsn,
+							   InvalidXLogRecPtr);
+			for (int j = 0; j < LAST_WRITTEN_LSN_RANGES; j++)
+			{
+				LastWrittenLsnCacheRange *range = &lastWrittenLsnCache->ranges[i].ranges[j];
+
+				pg_atomic_init_u32(&range->changecount, 0);
+				range->valid = false;
+				range->referenced = false;
+				pg_atomic_init_u64(&range->lsn, InvalidXLogRecPtr);
+			}
+		}
+
+		for (int i = 0; i < lastWrittenLsnCache->nsets; i++)
+		{
+			LastWrittenLsnCacheSet *set = &lastWrittenLsnCache->sets[i];
+
+			set->clock_hand = 0;
+			for (int j = 0; j < LAST_WRITTEN_LSN_SET_SIZE; j++)
+			{
+				pg_atomic_init_u32(&set->entries[j].changecount, 0);
+				set->entries[j].valid = false;
+				set->entries[j].referenced = false;
+				pg_atomic_init_u64(&set->entries[j].lsn, InvalidXLogRecPtr);
+			}
+		}
+	}
+}
+
+/*
+ * ResetLastWrittenLsnCache -- forget all cached pages, and use "lsn" as the
+ * last written LSN of every page.
+ *
+ * Only used at startup, before anyone else looks at the cache.
+ */
+static void
+ResetLastWrittenLsnCache(XLogRecPtr lsn)
+{
+	for (int i = 0; i < LAST_WRITTEN_LSN_PARTITIONS; i++)
+	{
+		pg_atomic_write_u64(&lastWrittenLsnCache->maxLsn[i], lsn);
+
+		/* the per-page maximum covers everything, ranges start out empty */
+		pg_atomic_write_u64(&lastWrittenLsnCache->ranges[i].maxLsn,
+							InvalidXLogRecPtr);
+		for (int j = 0; j < LAST_WRITTEN_LSN_RANGES; j++)
+			lastWrittenLsnCache->ranges[i].ranges[j].valid = false;
+	}
+
+	for (int i = 0; i < lastWrittenLsnCache->nsets; i++)
+	{
+		for (int j = 0; j < LAST_WRITTEN_LSN_SET_SIZE; j++)
+			lastWrittenLsnCache->sets[i].entries[j].valid = false;
+	}
+}
+
+/*
+ * Map a page to its set of the cache, and a set to its partition.
+ */
+static inline int
+LastWrittenLsnCacheSetNo(const BufferTag *key)
+{
+	return hash_bytes((const unsigned char *) key, sizeof(BufferTag)) %
+		lastWrittenLsnCache->nsets;
+}
+
+#define LastWrittenLsnCachePartition(setno) \
+	((setno) % LAST_WRITTEN_LSN_PARTITIONS)
+
+/*
+ * Map a relation fork to the partition holding its ranges.
+ */
+static inline int
+LastWrittenLsnRangePartition(RelFileNode rnode, ForkNumber forknum)
+{
+	return hash_combine(hash_bytes((const unsigned char *) &rnode, sizeof(RelFileNode)),
+						(uint32) forknum) % LAST_WRITTEN_LSN_PARTITIONS;
+}
+
+/*
+ * Raise an atomically maintained maximum LSN to at least "lsn".
+ */
+static inline void
+AdvanceLastWrittenLsnMax(pg_atomic_uint64 *max, XLogRecPtr lsn)
+{
+	uint64		cur = pg_atomic_read_u64(max);
+
+	while (cur < lsn)
+	{
+		if (pg_atomic_compare_exchange_u64(max, &cur, lsn))
+			break;
+	}
+}
+
+/*
+ * Acquire a partition lock of the cache exclusively, counting the time spent
+ * waiting for it in the cumulative statistics.
+ */
+static void
+LastWrittenLsnCacheLockAcquire(LWLock *lock)
+{
+	instr_time	start;
+	instr_time	duration;
+
+	if (LWLockConditionalAcquire(lock, LW_EXCLUSIVE))
+		return;
+
+	INSTR_TIME_SET_CURRENT(start);
+	LWLockAcquire(lock, LW_EXCLUSIVE);
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, start);
+
+	pgstat_count_lwlsn_lock_wait(INSTR_TIME_GET_MICROSEC(duration));
+}
+
+/*
+ * Look up a page in its set of the cache, without locking.
+ *
+ * Returns the cached LSN, or InvalidXLogRecPtr if the page isn't cached.
+ * In that case the caller has to fall back to the partition's maxLsn, which
+ * it must read only after this returns: when evicting, the LSN of the
+ * victim is folded into maxLsn before the entry is reused.
+ */
+static XLogRecPtr
+LookupLastWrittenLsnCache(LastWrittenLsnCacheSet *set, const BufferTag *key)
+{
+	for (int i = 0; i < LAST_WRITTEN_LSN_SET_SIZE; i++)
+	{
+		LastWrittenLsnCacheEntry *entry = &set->entries[i];
+
+		for (;;)
+		{
+			uint32		before = pg_atomic_read_u32(&entry->changecount);
+			bool		match;
+			XLogRecPtr	lsn;
+
+			if (before & 1)
+			{
+				/* entry is being changed, wait for it to settle */
+				SPIN_DELAY();
+				continue;
+			}
+			pg_read_barrier();
+			match = entry->valid && BUFFERTAGS_EQUAL(entry->key, *key);
+			lsn = pg_atomic_read_u64(&entry->lsn);
+			pg_read_barrier();
+			if (pg_atomic_read_u32(&entry->changecount) != before)
+				continue;		/* changed under us, retry */
+
+			if (match)
+			{
+				if (!entry->referenced)
+					entry->referenced = true;
+				return lsn;
+			}
+			break;
+		}
+	}
+	pg_read_barrier();
+
+	return InvalidXLogRecPtr;
+}
+
+/*
+ * Look up the ranges covering a page, without locking.
+ *
+ * Returns the maximal LSN of all ranges containing the page, or
+ * InvalidXLogRecPtr if there are none; the same rules as for
+ * LookupLastWrittenLsnCache apply in that case.
+ */
+static XLogRecPtr
+LookupLastWrittenLsnRanges(LastWrittenLsnCacheRanges *part, RelFileNode rnode,
+						   ForkNumber forknum, BlockNumber blkno)
+{
+	XLogRecPtr	result = InvalidXLogRecPtr;
+
+	for (int i = 0; i < LAST_WRITTEN_LSN_RANGES; i++)
+	{
+		LastWrittenLsnCacheRange *range = &part->ranges[i];
+
+		for (;;)
+		{
+			uint32		before = pg_atomic_read_u32(&range->changecount);
+			bool		match;
+			XLogRecPtr	lsn;
+
+			if (before & 1)
+			{
+				/* range is being changed, wait for it to settle */
+				SPIN_DELAY();
+				continue;
+			}
+			pg_read_barrier();
+			match = range->valid &&
+				RelFileNodeEquals(range->rnode, rnode) &&
+				range->forknum == forknum &&
+				range->from <= blkno && blkno < range->to;
+			lsn = pg_atomic_read_u64(&range->lsn);
+			pg_read_barrier();
+			if (pg_atomic_read_u32(&range->changecount) != before)
+				continue;		/* changed under us, retry */
+
+			if (match)
+			{
+				if (!range->referenced)
+					range->referenced = true;
+				result = Max(result, lsn);
+			}
+			break;
+		}
+	}
+	pg_read_barrier();
+
+	return result;
+}
+
 /*
  * GetLastWrittenLSN -- Returns maximal LSN of written page.
  * It returns an upper bound for the last written LSN of a given page,
- * either from a cached last written LSN or a global maximum last written LSN.
- * If rnode is InvalidOid then we calculate maximum among all cached LSN and maxLastWrittenLsn.
- * If cache is large enough, iterating through all hash items may be rather expensive.
+ * either from a cached last written LSN or the maximal last written LSN of
+ * the cache partition the page belongs to.
+ * If rnode is InvalidOid then we calculate maximum among all cached LSN and maxLsn of all partitions.
+ * If cache is large enough, iterating through all entries may be rather expensive.
  * But GetLastWrittenLSN(InvalidOid) is used only by zenith_dbsize which is not performance critical.
  */
 XLogRecPtr
 GetLastWrittenLSN(RelFileNode rnode, ForkNumber forknum, BlockNumber blkno)
 {
-	XLogRecPtr lsn;
-	LastWrittenLsnCacheEntry* entry;
+	XLogRecPtr lsn = InvalidXLogRecPtr;
 
 	Assert(lastWrittenLsnCacheSize != 0);
 
-	LWLockAcquire(LastWrittenLsnLock, LW_SHARED);
-
-	/* Maximal last written LSN among all non-cached pages */
-	lsn = XLogCtl->maxLastWrittenLsn;
-
 	if (rnode.relNode != InvalidOid)
 	{
-		BufferTag key;
-		key.rnode = rnode;
-		key.forkNum = forknum;
-		key.blockNum = blkno;
-		entry = hash_search(lastWrittenLsnCache, &key, HASH_FIND, NULL);
-		if (entry != NULL)
-			lsn = entry->lsn;
+		BufferTag	key;
+		int			setno;
+		bool		hit = false;
+
+		INIT_BUFFERTAG(key, rnode, forknum, blkno);
+		setno = LastWrittenLsnCacheSetNo(&key);
+
+		lsn = LookupLastWrittenLsnCache(&lastWrittenLsnCache->sets[setno], &key);
+		if (lsn == InvalidXLogRecPtr)
+		{
+			/* Maximal last written LSN among all non-cached pages */
+			lsn = pg_atomic_read_u64(&lastWrittenLsnCache->maxLsn[LastWrittenLsnCachePartition(setno)]);
+		}
+		else
+		{
+			pgstat_count_lwlsn_page_hit();
+			hit = true;
+		}
+
+		/* The page may also have been written as part of a range */
+		if (blkno != REL_METADATA_PSEUDO_BLOCKNO)
+		{
+			LastWrittenLsnCacheRanges *part;
+			XLogRecPtr	range_lsn;
+
+			part = &lastWrittenLsnCache->ranges[LastWrittenLsnRangePartition(rnode, forknum)];
+			range_lsn = LookupLastWrittenLsnRanges(part, rnode, forknum, blkno);
+			if (range_lsn == InvalidXLogRecPtr)
+				range_lsn = pg_atomic_read_u64(&part->maxLsn);
+			else if (!hit)
+			{
+				pgstat_count_lwlsn_range_hit();
+				hit = true;
+			}
+			lsn = Max(lsn, range_lsn);
+		}
+
+		if (!hit)
+			pgstat_count_lwlsn_miss();
 	}
 	else
 	{
-		HASH_SEQ_STATUS seq;
 		/* Find maximum of all cached LSNs */
-		hash_seq_init(&seq, lastWrittenLsnCache);
-		while ((entry = (LastWrittenLsnCacheEntry *) hash_seq_search(&seq)) != NULL)
+		for (int i = 0; i < LAST_WRITTEN_LSN_PARTITIONS; i++)
+		{
+			LastWrittenLsnCacheRanges *part = &lastWrittenLsnCache->ranges[i];
+
+			lsn = Max(lsn, pg_atomic_read_u64(&lastWrittenLsnCache->maxLsn[i]));
+			lsn = Max(lsn, pg_atomic_read_u64(&part->maxLsn));
+			for (int j = 0; j < LAST_WRITTEN_LSN_RANGES; j++)
+				lsn = Max(lsn, pg_atomic_read_u64(&part->ranges[j].lsn));
+		}
+
+		for (int i = 0; i < lastWrittenLsnCache->nsets; i++)
 		{
-			if (entry->lsn > lsn)
-				lsn = entry->lsn;
+			for (int j = 0; j < LAST_WRITTEN_LSN_SET_SIZE; j++)
+				lsn = Max(lsn, pg_atomic_read_u64(&lastWrittenLsnCache->sets[i].entries[j].lsn));
 		}
 	}
-	LWLockRelease(LastWrittenLsnLock);
 
 	return lsn;
 }
 
+/*
+ * Remember "lsn" as the last written LSN of a page.
+ *
+ * Caller must hold the lock of the set's partition exclusively.
+ */
+static void
+SetLastWrittenLsnCacheEntry(int setno, const BufferTag *key, XLogRecPtr lsn)
+{
+	LastWrittenLsnCacheSet *set = &lastWrittenLsnCache->sets[setno];
+	LastWrittenLsnCacheEntry *victim = NULL;
+
+	/* Is the page cached already?  We are the only writer, no need to retry */
+	for (int i = 0; i < LAST_WRITTEN_LSN_SET_SIZE; i++)
+	{
+		LastWrittenLsnCacheEntry *entry = &set->entries[i];
+
+		if (entry->valid && BUFFERTAGS_EQUAL(entry->key, *key))
+		{
+			if (lsn > pg_atomic_read_u64(&entry->lsn))
+				pg_atomic_write_u64(&entry->lsn, lsn);
+			entry->referenced = true;
+			return;
+		}
+		if (!entry->valid && victim == NULL)
+			victim = entry;
+	}
+
+	/* No free entry, run the clock sweep */
+	while (victim == NULL)
+	{
+		LastWrittenLsnCacheEntry *entry = &set->entries[set->clock_hand];
+
+		set->clock_hand = (set->clock_hand + 1) % LAST_WRITTEN_LSN_SET_SIZE;
+		if (entry->referenced)
+			entry->referenced = false;
+		else
+			victim = entry;
+	}
+
+	/*
+	 * Fold the LSN of the evicted page into the partition's maximum before
+	 * anyone can observe that the page is no longer cached.
+	 */
+	if (victim->valid)
+	{
+		AdvanceLastWrittenLsnMax(&lastWrittenLsnCache->maxLsn[LastWrittenLsnCachePartition(setno)],
+								 pg_atomic_read_u64(&victim->lsn));
+		pgstat_count_lwlsn_eviction(false);
+	}
+
+	pg_atomic_fetch_add_u32(&victim->changecount, 1);	/* now odd */
+	pg_write_barrier();
+	victim->key = *key;
+	victim->valid = true;
+	victim->referenced = true;
+	pg_atomic_write_u64(&victim->lsn, lsn);
+	pg_write_barrier();
+	pg_atomic_fetch_add_u32(&victim->changecount, 1);	/* even again */
+}
+
+/*
+ * Take the partition lock and remember "lsn" as the last written LSN of one
+ * page.
+ */
+static void
+SetLastWrittenLsnCachePage(XLogRecPtr lsn, RelFileNode rnode,
+						   ForkNumber forknum, BlockNumber blkno)
+{
+	BufferTag	key;
+	int			setno;
+	LWLock	   *partitionLock;
+
+	INIT_BUFFERTAG(key, rnode, forknum, blkno);
+	setno = LastWrittenLsnCacheSetNo(&key);
+	partitionLock = &lastWrittenLsnCache->locks[LastWrittenLsnCachePartition(setno)].lock;
+
+	LastWrittenLsnCacheLockAcquire(partitionLock);
+	SetLastWrittenLsnCacheEntry(setno, &key, lsn);
+	LWLockRelease(partitionLock);
+}
+
+/*
+ * Remember "lsn" as the last written LSN of blocks [from, to) of a relation
+ * fork, coalescing with an existing range of the fork that overlaps or
+ * touches it.  If append_only is true, only extend a range that ends right
+ * at "from", and return false without doing anything if there is none.
+ *
+ * Caller must hold the lock of the range partition exclusively.
+ */
+static bool
+SetLastWrittenLsnCacheRange(LastWrittenLsnCacheRanges *part, RelFileNode rnode,
+							ForkNumber forknum, BlockNumber from,
+							BlockNumber to, XLogRecPtr lsn, bool append_only)
+{
+	LastWrittenLsnCacheRange *victim = NULL;
+
+	for (int i = 0; i < LAST_WRITTEN_LSN_RANGES; i++)
+	{
+		LastWrittenLsnCacheRange *range = &part->ranges[i];
+		bool		mergeable;
+
+		if (!range->valid)
+		{
+			if (victim == NULL)
+				victim = range;
+			continue;
+		}
+		if (!RelFileNodeEquals(range->rnode, rnode) || range->forknum != forknum)
+			continue;
+
+		if (append_only)
+			mergeable = (range->to == from);
+		else
+			mergeable = (range->from <= to && from <= range->to);
+
+		if (mergeable)
+		{
+			pg_atomic_fetch_add_u32(&range->changecount, 1);	/* now odd */
+			pg_write_barrier();
+			range->from = Min(range->from, from);
+			range->to = Max(range->to, to);
+			range->referenced = true;
+			if (lsn > pg_atomic_read_u64(&range->lsn))
+				pg_atomic_write_u64(&range->lsn, lsn);
+			pg_write_barrier();
+			pg_atomic_fetch_add_u32(&range->changecount, 1);	/* even again */
+			return true;
+		}
+	}
+
+	if (append_only)
+		return false;
+
+	/* No free entry, run the clock sweep */
+	while (victim == NULL)
+	{
+		LastWrittenLsnCacheRange *range = &part->ranges[part->clock_hand];
+
+		part->clock_hand = (part->clock_hand + 1) % LAST_WRITTEN_LSN_RANGES;
+		if (range->referenced)
+			range->referenced = false;
+		else
+			victim = range;
+	}
+
+	/* See SetLastWrittenLsnCacheEntry */
+	if (victim->valid)
+	{
+		AdvanceLastWrittenLsnMax(&part->maxLsn, pg_atomic_read_u64(&victim->lsn));
+		pgstat_count_lwlsn_eviction(true);
+	}
+
+	pg_atomic_fetch_add_u32(&victim->changecount, 1);	/* now odd */
+	pg_write_barrier();
+	victim->rnode = rnode;
+	victim->forknum = forknum;
+	victim->from = from;
+	victim->to = to;
+	victim->valid = true;
+	victim->referenced = true;
+	pg_atomic_write_u64(&victim->lsn, lsn);
+	pg_write_barrier();
+	pg_atomic_fetch_add_u32(&victim->changecount, 1);	/* even again */
+
+	return true;
+}
+
 /*
  * SetLastWrittenLSNForBlockRange -- Set maximal LSN of written page range.
- * We maintain cache of last written LSNs with limited size and LRU replacement
- * policy. Keeping last written LSN for each page allows to use old LSN when
+ * We maintain cache of last written LSNs with limited size and clock
+ * replacement policy. Keeping last written LSN for each page allows to use old LSN when
  * requesting pages of unchanged or appended relations. Also it is critical for
  * efficient work of prefetch in case massive update operations (like vacuum or remove).
+ * A range of more than one block is stored as a single range entry; a single
+ * block right past the end of a known range extends that range.
  *
- * rnode.relNode can be InvalidOid, in this case maxLastWrittenLsn is updated.
+ * rnode.relNode can be InvalidOid, in this case maxLsn of all partitions is updated.
  * SetLastWrittenLsn with dummy rnode is used by createdb and dbase_redo functions.
  */
 void
@@ -6169,51 +6837,40 @@ SetLastWrittenLSNForBlockRange(XLogRecPtr lsn, RelFileNode rnode, ForkNumber for
 	if (lsn == InvalidXLogRecPtr || n_blocks == 0 || lastWrittenLsnCacheSize == 0)
 		return;
 
-	LWLockAcquire(LastWrittenLsnLock, LW_EXCLUSIVE);
 	if (rnode.relNode == InvalidOid)
 	{
-		if (lsn > XLogCtl->maxLastWrittenLsn)
-			XLogCtl->maxLastWrittenLsn = lsn;
+		for (int i = 0; i < LAST_WRITTEN_LSN_PARTITIONS; i++)
+			AdvanceLastWrittenLsnMax(&lastWrittenLsnCache->maxLsn[i], lsn);
 	}
-	else
+	else if (n_blocks > 1 ||
+			 (from != REL_METADATA_PSEUDO_BLOCKNO && from > 0 &&
+			  LookupLastWrittenLsnRanges(&lastWrittenLsnCache->ranges[LastWrittenLsnRangePartition(rnode, forknum)],
+										 rnode, forknum, from - 1) != InvalidXLogRecPtr))
 	{
-		LastWrittenLsnCacheEntry* entry;
-		BufferTag key;
-		bool found;
-		BlockNumber i;
+		/*
+		 * A multi-block range, or a single block right after a block covered
+		 * by a range (checked without the lock, so that plain page writes
+		 * don't have to take the range partition lock).
+		 */
+		int			partno = LastWrittenLsnRangePartition(rnode, forknum);
+		LWLock	   *partitionLock = &lastWrittenLsnCache->locks[partno].lock;
+		bool		done;
 
-		key.rnode = rnode;
-		key.forkNum = forknum;
-		for (i = 0; i < n_blocks; i++)
-		{
-			key.blockNum = from + i;
-			entry = hash_search(lastWrittenLsnCache, &key, HASH_ENTER, &found);
-			if (found)
-			{
-				if (lsn > entry->lsn)
-					entry->lsn = lsn;
-				/* Unlink from LRU list */
-				dlist_delete(&entry->lru_node);
-			}
-			else
-			{
-				entry->lsn = lsn;
-				if (hash_get_num_entries(lastWrittenLsnCache) > lastWrittenLsnCacheSize)
-				{
-					/* Replace least recently used entry */
-					LastWrittenLsnCacheEntry* victim = dlist_container(LastWrittenLsnCacheEntry, lru_node, dlist_pop_head_node(&XLogCtl->lastWrittenLsnLRU));
-					/* Adjust max LSN for not cached relations/chunks if needed */
-					if (victim->lsn > XLogCtl->maxLastWrittenLsn)
-						XLogCtl->maxLastWrittenLsn = victim->lsn;
+		Assert(from != REL_METADATA_PSEUDO_BLOCKNO &&
+			   n_blocks <= REL_METADATA_PSEUDO_BLOCKNO - from);
 
-					hash_search(lastWrittenLsnCache, victim, HASH_REMOVE, NULL);
-				}
-			}
-			/* Link to the end of LRU list */
-			dlist_push_tail(&XLogCtl->lastWrittenLsnLRU, &entry->lru_node);
-		}
+		LastWrittenLsnCacheLockAcquire(partitionLock);
+		done = SetLastWrittenLsnCacheRange(&lastWrittenLsnCache->ranges[partno],
+										   rnode, forknum, from, from + n_blocks,
+										   lsn, n_blocks == 1);
+		LWLockRelease(partitionLock);
+
+		/* a single block not adjacent to any range gets its own entry */
+		if (!done)
+			SetLastWrittenLsnCachePage(lsn, rnode, forknum, from);
 	}
-	LWLockRelease(LastWrittenLsnLock);
+	else
+		SetLastWrittenLsnCachePage(lsn, rnode, forknum, from);
 }
 
 /*
@@ -121,6 +121,11 @@ static uint8 curinsert_flags = 0;
 static XLogRecData hdr_rdt;
 static char *hdr_scratch = NULL;
 
+#ifdef USE_ZSTD
+/* zstd context for compressing full page images, reused across records */
+static ZSTD_CCtx *zstd_cctx = NULL;
+#endif
+
 #define SizeOfXlogOrigin	(sizeof(RepOriginId) + sizeof(char))
 #define SizeOfXLogTransactionId	(sizeof(TransactionId) + sizeof(char))
 
@@ -139,6 +144,23 @@ static int	max_rdatas;			/* allocated size */
 
 static bool begininsert_called = false;
 
+/*
+ * NEON: WAL backpressure.  When delay_backend_us reports that the backends
+ * should be slowed down, each backend sleeps in proportion to the WAL it
+ * has written since the slowdown began, up to the reported delay for every
+ * WAL_BACKPRESSURE_QUANTUM bytes.  Bulk writers are thus throttled to a
+ * bounded WAL rate, while a small transaction only sleeps for a fraction of
+ * the delay.  The sleep happens in ProcessWalBackpressure, called from
+ * ProcessInterrupts, since XLogInsert is usually called in a critical
+ * section with buffers locked.  It takes the place of the throttling in
+ * ProcessInterruptsCallback: when it has run, ProcessInterrupts doesn't
+ * call the callback, so that the backend isn't throttled twice.
+ */
+#define WAL_BACKPRESSURE_QUANTUM	(64 * 1024)
+
+bool		WalBackpressurePending = false;
+static uint64 backpressure_bytes = 0;
+
 /* Memory context to hold the registered buffer and data references. */
 static MemoryContext xloginsert_cxt;
 
@@ -477,11 +499,6 @@ XLogInsert(RmgrId rmid, uint8 info)
 		return EndPos;
 	}
 
-	if (delay_backend_us != NULL && delay_backend_us() > 0)
-	{
-		InterruptPending = true;
-	}
-
 	do
 	{
 		XLogRecPtr	RedoRecPtr;
@@ -507,9 +524,56 @@ XLogInsert(RmgrId rmid, uint8 info)
 
 	XLogResetInsertion();
 
+	if (delay_backend_us != NULL)
+	{
+		if (delay_backend_us() > 0)
+		{
+			backpressure_bytes += EndPos - ProcLastRecPtr;
+
+			/* raise the interrupt only once until it has been serviced */
+			if (!WalBackpressurePending)
+			{
+				WalBackpressurePending = true;
+				InterruptPending = true;
+			}
+		}
+		else
+			backpressure_bytes = 0;
+	}
+
 	return EndPos;
 }
 
+/*
+ * ProcessWalBackpressure -- sleep for the WAL written during a slowdown
+ *
+ * The sleep is the delay reported by delay_backend_us, scaled down by the
+ * fraction of WAL_BACKPRESSURE_QUANTUM this backend has written since it
+ * last slept.
+ */
+void
+ProcessWalBackpressure(void)
+{
+	uint64		delay_us;
+	uint64		bytes;
+
+	WalBackpressurePending = false;
+
+	bytes = Min(backpressure_bytes, WAL_BACKPRESSURE_QUANTUM);
+	backpressure_bytes = 0;
+
+	if (delay_backend_us == NULL || (delay_us = delay_backend_us()) == 0)
+		return;
+
+	delay_us = delay_us * bytes / WAL_BACKPRESSURE_QUANTUM;
+	if (delay_us > 0)
+	{
+		pgstat_report_wait_start(WAIT_EVENT_BACK_PRESSURE);
+		pg_usleep((long) delay_us);
+		pgstat_report_wait_end();
+	}
+}
+
 /*
  * Assemble a WAL record from the registered data and buffers into an
  * XLogRecData chain, ready for insertion with XLogInsertRecord().
@@ -939,10 +1003,16 @@ XLogCompressBackupBlock(char *page, uint16 hole_offset, uint16 hole_length,
 
 		case WAL_COMPRESSION_ZSTD:
 #ifdef USE_ZSTD
-			len = ZSTD_compress(dest, COMPRESS_BUFSIZE, source, orig_len,
-								ZSTD_CLEVEL_DEFAULT);
-			if (ZSTD_isError(len))
-				len = -1;		/* failure */
+			if (zstd_cctx != NULL)
+			{
+				len = ZSTD_compressCCtx(zstd_cctx, dest, COMPRESS_BUFSIZE,
+										source, orig_len,
+										wal_compression_zstd_level);
+				if (ZSTD_isError(len))
+					len = -1;	/* failure */
+			}
+			else
+				len = -1;		/* no context, store the image as is */
 #else
 			elog(ERROR, "zstd is not supported by this build");
 #endif
@@ -1327,4 +1397,15 @@ InitXLogInsert(void)
 	if (hdr_scratch == NULL)
 		hdr_scratch = MemoryContextAllocZero(xloginsert_cxt,
 											 HEADER_SCRATCH_SIZE);
+
+#ifdef USE_ZSTD
+
+	/*
+	 * Create the zstd compression context up front, as records are often
+	 * assembled in a critical section.  If that fails, full page images are
+	 * just not compressed.
+	 */
+	if (zstd_cctx == NULL)
+		zstd_cctx = ZSTD_createCCtx();
+#endif
 }
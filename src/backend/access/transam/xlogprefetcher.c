@@ -35,6 +35,7 @@
 #include "catalog/pg_control.h"
 #include "catalog/storage_xlog.h"
 #include "commands/dbcommands_xlog.h"
+#include "executor/instrument.h"
 #include "utils/fmgrprotos.h"
 #include "utils/timestamp.h"
 #include "funcapi.h"
@@ -142,6 +143,7 @@ struct XLogPrefetcher
 	/* Book-keeping to avoid repeat prefetches. */
 	RelFileNode recent_rnode[XLOGPREFETCHER_SEQ_WINDOW_SIZE];
 	BlockNumber recent_block[XLOGPREFETCHER_SEQ_WINDOW_SIZE];
+	Buffer		recent_buffer[XLOGPREFETCHER_SEQ_WINDOW_SIZE];
 	int			recent_idx;
 
 	/* Book-keeping to disable prefetching temporarily. */
@@ -152,6 +154,10 @@ struct XLogPrefetcher
 
 	XLogRecPtr	begin_ptr;
 
+	/* Buffer usage when the last record was returned for replay. */
+	int64		last_blks_read;
+	instr_time	last_blk_read_time;
+
 	int			reconfigure_count;
 };
 
@@ -181,6 +187,8 @@ typedef struct XLogPrefetchStats
 	pg_atomic_uint64 skip_new;	/* New/missing blocks filtered. */
 	pg_atomic_uint64 skip_fpw;	/* FPWs skipped. */
 	pg_atomic_uint64 skip_rep;	/* Repeat accesses skipped. */
+	pg_atomic_uint64 stall_reads;	/* Blocks that replay had to read. */
+	pg_atomic_uint64 stall_time;	/* Time spent on them, in microseconds. */
 
 	/* Dynamic values */
 	int			wal_distance;	/* Number of WAL bytes ahead. */
@@ -313,6 +321,8 @@ XLogPrefetchResetStats(void)
 	pg_atomic_write_u64(&SharedStats->skip_new, 0);
 	pg_atomic_write_u64(&SharedStats->skip_fpw, 0);
 	pg_atomic_write_u64(&SharedStats->skip_rep, 0);
+	pg_atomic_write_u64(&SharedStats->stall_reads, 0);
+	pg_atomic_write_u64(&SharedStats->stall_time, 0);
 }
 
 void
@@ -334,6 +344,8 @@ XLogPrefetchShmemInit(void)
 		pg_atomic_init_u64(&SharedStats->skip_new, 0);
 		pg_atomic_init_u64(&SharedStats->skip_fpw, 0);
 		pg_atomic_init_u64(&SharedStats->skip_rep, 0);
+		pg_atomic_init_u64(&SharedStats->stall_reads, 0);
+		pg_atomic_init_u64(&SharedStats->stall_time, 0);
 	}
 }
 
@@ -383,6 +395,9 @@ XLogPrefetcherAllocate(XLogReaderState *reader)
 	SharedStats->block_distance = 0;
 	SharedStats->io_depth = 0;
 
+	prefetcher->last_blks_read = pgBufferUsage.shared_blks_read;
+	prefetcher->last_blk_read_time = pgBufferUsage.blk_read_time;
+
 	/* First usage will cause streaming_read to be allocated. */
 	prefetcher->reconfigure_count = XLogPrefetchReconfigureCount - 1;
 
@@ -653,6 +668,7 @@ XLogPrefetcherNextBlock(uintptr_t pgsr_private, XLogRecPtr *lsn)
 			DecodedBkpBlock *block = &record->blocks[block_id];
 			SMgrRelation reln;
 			PrefetchBufferResult result;
+			int			recent_idx;
 
 			if (!block->in_use)
 				continue;
@@ -703,16 +719,23 @@ XLogPrefetcherNextBlock(uintptr_t pgsr_private, XLogRecPtr *lsn)
 					RelFileNodeEquals(block->rnode, prefetcher->recent_rnode[i]))
 				{
 					/*
-					 * XXX If we also remembered where it was, we could set
-					 * recent_buffer so that recovery could skip smgropen()
-					 * and a buffer table lookup.
+					 * If we know which buffer the block was in, pass it on so
+					 * that recovery can skip the buffer mapping table lookup.
+					 * Records that modify the same few pages over and over,
+					 * such as inserts into the rightmost page of an index,
+					 * are common.  Recovery checks that the buffer still
+					 * holds the block, so it's OK if it has been evicted
+					 * since.
 					 */
+					block->prefetch_buffer = prefetcher->recent_buffer[i];
 					XLogPrefetchIncrement(&SharedStats->skip_rep);
 					return LRQ_NEXT_NO_IO;
 				}
 			}
-			prefetcher->recent_rnode[prefetcher->recent_idx] = block->rnode;
-			prefetcher->recent_block[prefetcher->recent_idx] = block->blkno;
+			recent_idx = prefetcher->recent_idx;
+			prefetcher->recent_rnode[recent_idx] = block->rnode;
+			prefetcher->recent_block[recent_idx] = block->blkno;
+			prefetcher->recent_buffer[recent_idx] = InvalidBuffer;
 			prefetcher->recent_idx =
 				(prefetcher->recent_idx + 1) % XLOGPREFETCHER_SEQ_WINDOW_SIZE;
 
@@ -777,6 +800,7 @@ XLogPrefetcherNextBlock(uintptr_t pgsr_private, XLogRecPtr *lsn)
 				/* Cache hit, nothing to do. */
 				XLogPrefetchIncrement(&SharedStats->hit);
 				block->prefetch_buffer = result.recent_buffer;
+				prefetcher->recent_buffer[recent_idx] = result.recent_buffer;
 				return LRQ_NEXT_NO_IO;
 			}
 			else if (result.initiated_io)
@@ -830,7 +854,7 @@ XLogPrefetcherNextBlock(uintptr_t pgsr_private, XLogRecPtr *lsn)
 Datum
 pg_stat_get_recovery_prefetch(PG_FUNCTION_ARGS)
 {
-#define PG_STAT_GET_RECOVERY_PREFETCH_COLS 10
+#define PG_STAT_GET_RECOVERY_PREFETCH_COLS 12
 	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
 	Datum		values[PG_STAT_GET_RECOVERY_PREFETCH_COLS];
 	bool		nulls[PG_STAT_GET_RECOVERY_PREFETCH_COLS];
@@ -847,9 +871,12 @@ pg_stat_get_recovery_prefetch(PG_FUNCTION_ARGS)
 	values[4] = Int64GetDatum(pg_atomic_read_u64(&SharedStats->skip_new));
 	values[5] = Int64GetDatum(pg_atomic_read_u64(&SharedStats->skip_fpw));
 	values[6] = Int64GetDatum(pg_atomic_read_u64(&SharedStats->skip_rep));
-	values[7] = Int32GetDatum(SharedStats->wal_distance);
-	values[8] = Int32GetDatum(SharedStats->block_distance);
-	values[9] = Int32GetDatum(SharedStats->io_depth);
+	values[7] = Int64GetDatum(pg_atomic_read_u64(&SharedStats->stall_reads));
+	/* convert to msec for display */
+	values[8] = Float8GetDatum((double) pg_atomic_read_u64(&SharedStats->stall_time) / 1000.0);
+	values[9] = Int32GetDatum(SharedStats->wal_distance);
+	values[10] = Int32GetDatum(SharedStats->block_distance);
+	values[11] = Int32GetDatum(SharedStats->io_depth);
 	tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
 
 	return (Datum) 0;
@@ -1027,6 +1054,28 @@ XLogPrefetcherReadRecord(XLogPrefetcher *prefetcher, char **errmsg)
 	 */
 	replayed_up_to = XLogReleasePreviousRecord(prefetcher->reader);
 
+	/*
+	 * Any blocks read since we returned the last record were read by replay,
+	 * because the prefetch for them was not issued or had not completed yet.
+	 * That's how long replay stalled waiting for I/O that prefetching did not
+	 * hide.  The time is only measured if track_io_timing is enabled.
+	 */
+	if (pgBufferUsage.shared_blks_read != prefetcher->last_blks_read)
+	{
+		instr_time	stall_time = pgBufferUsage.blk_read_time;
+
+		INSTR_TIME_SUBTRACT(stall_time, prefetcher->last_blk_read_time);
+		pg_atomic_write_u64(&SharedStats->stall_reads,
+							pg_atomic_read_u64(&SharedStats->stall_reads) +
+							pgBufferUsage.shared_blks_read -
+							prefetcher->last_blks_read);
+		pg_atomic_write_u64(&SharedStats->stall_time,
+							pg_atomic_read_u64(&SharedStats->stall_time) +
+							INSTR_TIME_GET_MICROSEC(stall_time));
+		prefetcher->last_blks_read = pgBufferUsage.shared_blks_read;
+		prefetcher->last_blk_read_time = pgBufferUsage.blk_read_time;
+	}
+
 	/*
 	 * Can we drop any filters yet?  If we were waiting for a relation to be
 	 * created or extended, it is now OK to access blocks in the covered
@@ -936,6 +936,8 @@ CREATE VIEW pg_stat_recovery_prefetch AS
             s.skip_new,
             s.skip_fpw,
             s.skip_rep,
+            s.stall_reads,
+            s.stall_time,
             s.wal_distance,
             s.block_distance,
             s.io_depth
@@ -1120,6 +1122,7 @@ CREATE VIEW pg_stat_wal AS
         w.wal_fpi,
         w.wal_bytes,
         w.wal_buffers_full,
+        w.wal_segment_init,
         w.wal_write,
         w.wal_sync,
         w.wal_write_time,
@@ -1127,6 +1130,43 @@ CREATE VIEW pg_stat_wal AS
         w.stats_reset
     FROM pg_stat_get_wal() w;
 
+CREATE VIEW pg_stat_last_written_lsn_cache AS
+    SELECT
+        c.page_hits,
+        c.range_hits,
+        c.misses,
+        c.page_evictions,
+        c.range_evictions,
+        c.lock_waits,
+        c.lock_wait_time,
+        c.stats_reset
+    FROM pg_stat_get_last_written_lsn_cache() c;
+
+CREATE VIEW pg_stat_smgr_latency AS
+    SELECT
+        s.operation,
+        s.calls,
+        s.total_time,
+        s.histogram,
+        s.stats_reset
+    FROM pg_stat_get_smgr_latency() s;
+
+CREATE VIEW pg_stat_buffer_simulation AS
+    SELECT
+        s.size,
+        s.level,
+        s.hits,
+        s.misses,
+        s.stats_reset
+    FROM pg_stat_get_buffer_simulation() s;
+
+CREATE VIEW pg_stat_backend_memory AS
+    SELECT
+        s.pid,
+        s.backend_type,
+        s.allocated_bytes
+    FROM pg_stat_get_backend_memory() s;
+
 CREATE VIEW pg_stat_progress_analyze AS
     SELECT
         S.pid AS pid, S.datid AS datid, D.datname AS datname,
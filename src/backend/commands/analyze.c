@@ -1147,9 +1147,10 @@ acquire_sample_rows(Relation onerel, int elevel,
 	TableScanDesc scan;
 	BlockNumber nblocks;
 	BlockNumber blksdone = 0;
+	BlockNumber *blocks;
 #ifdef USE_PREFETCH
 	int			prefetch_maximum = 0;	/* blocks to prefetch if enabled */
-	BlockSamplerData prefetch_bs;
+	BlockNumber prefetched = 0; /* blocks[] before this one are prefetched */
 #endif
 
 	Assert(targrows > 0);
@@ -1159,15 +1160,21 @@ acquire_sample_rows(Relation onerel, int elevel,
 	/* Need a cutoff xmin for HeapTupleSatisfiesVacuum */
 	OldestXmin = GetOldestNonRemovableTransactionId(onerel);
 
-	/* Prepare for sampling block numbers */
+	/*
+	 * Prepare for sampling block numbers.  Draw them all up front, so that
+	 * we know which blocks to prefetch however far ahead we like.
+	 */
 	randseed = pg_prng_uint32(&pg_global_prng_state);
 	nblocks = BlockSampler_Init(&bs, totalblocks, targrows, randseed);
+	blocks = palloc(Max(nblocks, 1) * sizeof(BlockNumber));
+	for (BlockNumber i = 0; i < nblocks; i++)
+	{
+		Assert(BlockSampler_HasMore(&bs));
+		blocks[i] = BlockSampler_Next(&bs);
+	}
 
 #ifdef USE_PREFETCH
 	prefetch_maximum = get_tablespace_maintenance_io_concurrency(onerel->rd_rel->reltablespace);
-	/* Create another BlockSampler, using the same seed, for prefetching */
-	if (prefetch_maximum)
-		(void) BlockSampler_Init(&prefetch_bs, totalblocks, targrows, randseed);
 #endif
 
 	/* Report sampling block numbers */
@@ -1180,64 +1187,43 @@ acquire_sample_rows(Relation onerel, int elevel,
 	scan = table_beginscan_analyze(onerel);
 	slot = table_slot_create(onerel, NULL);
 
-#ifdef USE_PREFETCH
-
-	/*
-	 * If we are doing prefetching, then go ahead and tell the kernel about
-	 * the first set of pages we are going to want.  This also moves our
-	 * iterator out ahead of the main one being used, where we will keep it so
-	 * that we're always pre-fetching out prefetch_maximum number of blocks
-	 * ahead.
-	 */
-	if (prefetch_maximum)
-	{
-		for (int i = 0; i < prefetch_maximum; i++)
-		{
-			BlockNumber prefetch_block;
-
-			if (!BlockSampler_HasMore(&prefetch_bs))
-				break;
-
-			prefetch_block = BlockSampler_Next(&prefetch_bs);
-			PrefetchBuffer(scan->rs_rd, MAIN_FORKNUM, prefetch_block);
-		}
-	}
-#endif
-
 	/* Outer loop over blocks to sample */
-	while (BlockSampler_HasMore(&bs))
+	for (BlockNumber blkidx = 0; blkidx < nblocks; blkidx++)
 	{
 		bool		block_accepted;
-		BlockNumber targblock = BlockSampler_Next(&bs);
+		BlockNumber targblock = blocks[blkidx];
+
 #ifdef USE_PREFETCH
-		BlockNumber prefetch_targblock = InvalidBlockNumber;
 
 		/*
-		 * Make sure that every time the main BlockSampler is moved forward
-		 * that our prefetch BlockSampler also gets moved forward, so that we
-		 * always stay out ahead.
+		 * Keep a window of the prefetch_maximum blocks following the block we
+		 * are about to read, which would gain nothing from a prefetch.
+		 * Rather than asking for one more block each time we read one, top
+		 * the window up once half of it has been consumed, so that the blocks
+		 * go to the storage in batches.  We prefetch the blocks even if
+		 * table_scan_analyze_next_block() then decides against analyzing
+		 * them.
 		 */
-		if (prefetch_maximum && BlockSampler_HasMore(&prefetch_bs))
-			prefetch_targblock = BlockSampler_Next(&prefetch_bs);
+		if (prefetch_maximum > 0)
+		{
+			BlockNumber start = Max(prefetched, blkidx + 1);
+
+			if (start < nblocks &&
+				start - (blkidx + 1) <= prefetch_maximum / 2)
+			{
+				BlockNumber upto = Min(nblocks, blkidx + 1 + prefetch_maximum);
+
+				PrefetchBuffers(scan->rs_rd, MAIN_FORKNUM, &blocks[start],
+								upto - start);
+				prefetched = upto;
+			}
+		}
 #endif
 
 		vacuum_delay_point();
 
 		block_accepted = table_scan_analyze_next_block(scan, targblock, vac_strategy);
 
-#ifdef USE_PREFETCH
-
-		/*
-		 * When pre-fetching, after we get a block, tell the kernel about the
-		 * next one we will want, if there's any left.
-		 *
-		 * We want to do this even if the table_scan_analyze_next_block() call
-		 * above decides against analyzing the block it picked.
-		 */
-		if (prefetch_maximum && prefetch_targblock != InvalidBlockNumber)
-			PrefetchBuffer(scan->rs_rd, MAIN_FORKNUM, prefetch_targblock);
-#endif
-
 		/*
 		 * Don't analyze if table_scan_analyze_next_block() indicated this
 		 * block is unsuitable for analyzing.
@@ -1296,6 +1282,7 @@ acquire_sample_rows(Relation onerel, int elevel,
 
 	ExecDropSingleTupleTableSlot(slot);
 	table_endscan(scan);
+	pfree(blocks);
 
 	/*
 	 * If we didn't find as many tuples as we wanted then we're done. No sort
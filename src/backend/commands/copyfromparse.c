@@ -72,6 +72,7 @@
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "port/pg_bswap.h"
+#include "port/simd.h"
 #include "utils/builtins.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
@@ -79,6 +80,50 @@
 #define ISOCTAL(c) (((c) >= '0') && ((c) <= '7'))
 #define OCTVALUE(c) ((c) - '0')
 
+/*
+ * Return the first position from "ptr" onwards, up to "end", that may hold
+ * one of the characters c1 to c5, looking at a vector of bytes at a time.
+ * The bytes skipped over are known not to be any of them.  Callers pass a
+ * character more than once if they have fewer to look for.
+ *
+ * The vector at the returned position holds one of the characters, or is
+ * incomplete, so the caller has to scan that far byte by byte.  To keep
+ * that cheap, we don't look again before *next_try.
+ */
+static inline char *
+CopySkipPlainBytes(char *ptr, char *end, char **next_try,
+				   char c1, char c2, char c3, char c4, char c5)
+{
+#ifndef USE_NO_SIMD
+	if (ptr >= *next_try)
+	{
+		const Vector8 v1 = vector8_broadcast((uint8) c1);
+		const Vector8 v2 = vector8_broadcast((uint8) c2);
+		const Vector8 v3 = vector8_broadcast((uint8) c3);
+		const Vector8 v4 = vector8_broadcast((uint8) c4);
+		const Vector8 v5 = vector8_broadcast((uint8) c5);
+
+		while (end - ptr >= (ptrdiff_t) sizeof(Vector8))
+		{
+			Vector8		chunk;
+			Vector8		match;
+
+			vector8_load(&chunk, (const uint8 *) ptr);
+			match = vector8_or(vector8_or(vector8_eq(chunk, v1),
+										  vector8_eq(chunk, v2)),
+							   vector8_or(vector8_eq(chunk, v3),
+										  vector8_eq(chunk, v4)));
+			match = vector8_or(match, vector8_eq(chunk, v5));
+			if (vector8_is_highbit_set(match))
+				break;
+			ptr += sizeof(Vector8);
+		}
+		*next_try = ptr + sizeof(Vector8);
+	}
+#endif
+	return ptr;
+}
+
 /*
  * These macros centralize code used to process line_buf and input_buf buffers.
  * They are macros because they often do continue/break control and to avoid
@@ -1125,6 +1170,7 @@ CopyReadLineText(CopyFromState cstate)
 				last_was_esc = false;
 	char		quotec = '\0';
 	char		escapec = '\0';
+	char	   *next_try;
 
 	if (cstate->opts.csv_mode)
 	{
@@ -1166,11 +1212,13 @@ CopyReadLineText(CopyFromState cstate)
 	copy_input_buf = cstate->input_buf;
 	input_buf_ptr = cstate->input_buf_index;
 	copy_buf_len = cstate->input_buf_len;
+	next_try = copy_input_buf;
 
 	for (;;)
 	{
 		int			prev_raw_ptr;
 		char		c;
+		char	   *plain_end;
 
 		/*
 		 * Load more data if needed.
@@ -1189,6 +1237,7 @@ CopyReadLineText(CopyFromState cstate)
 			hit_eof = cstate->input_reached_eof;
 			input_buf_ptr = cstate->input_buf_index;
 			copy_buf_len = cstate->input_buf_len;
+			next_try = copy_input_buf;
 
 			/*
 			 * If we are completely out of data, break out of the loop,
@@ -1202,6 +1251,24 @@ CopyReadLineText(CopyFromState cstate)
 			need_data = false;
 		}
 
+		/*
+		 * Pass over data that contains none of the characters we look for
+		 * below quickly.  (In text mode, quotec and escapec are '\0', which
+		 * is harmless.)  For each of those bytes, the loop would just reset
+		 * last_was_esc and first_char_in_line.
+		 */
+		plain_end = CopySkipPlainBytes(copy_input_buf + input_buf_ptr,
+									   copy_input_buf + copy_buf_len,
+									   &next_try,
+									   '\n', '\r', '\\', quotec, escapec);
+		if (plain_end > copy_input_buf + input_buf_ptr)
+		{
+			input_buf_ptr = plain_end - copy_input_buf;
+			last_was_esc = false;
+			first_char_in_line = false;
+			continue;
+		}
+
 		/* OK to fetch a character */
 		prev_raw_ptr = input_buf_ptr;
 		c = copy_input_buf[input_buf_ptr++];
@@ -1482,6 +1549,8 @@ CopyReadAttributesText(CopyFromState cstate)
 	char	   *output_ptr;
 	char	   *cur_ptr;
 	char	   *line_end_ptr;
+	char	   *next_try;
+	char	   *plain_end;
 
 	/*
 	 * We need a special case for zero-column tables: check that the input
@@ -1512,6 +1581,7 @@ CopyReadAttributesText(CopyFromState cstate)
 	/* set pointer variables for loop */
 	cur_ptr = cstate->line_buf.data;
 	line_end_ptr = cstate->line_buf.data + cstate->line_buf.len;
+	next_try = cur_ptr;
 
 	/* Outer loop iterates over fields */
 	fieldno = 0;
@@ -1550,6 +1620,16 @@ CopyReadAttributesText(CopyFromState cstate)
 		{
 			char		c;
 
+			/* copy data without delimiters or backslashes in bulk */
+			plain_end = CopySkipPlainBytes(cur_ptr, line_end_ptr, &next_try,
+										   delimc, '\\', '\\', '\\', '\\');
+			if (plain_end > cur_ptr)
+			{
+				memcpy(output_ptr, cur_ptr, plain_end - cur_ptr);
+				output_ptr += plain_end - cur_ptr;
+				cur_ptr = plain_end;
+			}
+
 			end_ptr = cur_ptr;
 			if (cur_ptr >= line_end_ptr)
 				break;
@@ -1708,6 +1788,8 @@ CopyReadAttributesCSV(CopyFromState cstate)
 	char		delimc = cstate->opts.delim[0];
 	char		quotec = cstate->opts.quote[0];
 	char		escapec = cstate->opts.escape[0];
+	char	   *next_try;
+	char	   *plain_end;
 	int			fieldno;
 	char	   *output_ptr;
 	char	   *cur_ptr;
@@ -1742,6 +1824,7 @@ CopyReadAttributesCSV(CopyFromState cstate)
 	/* set pointer variables for loop */
 	cur_ptr = cstate->line_buf.data;
 	line_end_ptr = cstate->line_buf.data + cstate->line_buf.len;
+	next_try = cur_ptr;
 
 	/* Outer loop iterates over fields */
 	fieldno = 0;
@@ -1779,6 +1862,17 @@ CopyReadAttributesCSV(CopyFromState cstate)
 			/* Not in quote */
 			for (;;)
 			{
+				/* copy data without delimiters or quotes in bulk */
+				plain_end = CopySkipPlainBytes(cur_ptr, line_end_ptr, &next_try,
+											   delimc, quotec, quotec, quotec,
+											   quotec);
+				if (plain_end > cur_ptr)
+				{
+					memcpy(output_ptr, cur_ptr, plain_end - cur_ptr);
+					output_ptr += plain_end - cur_ptr;
+					cur_ptr = plain_end;
+				}
+
 				end_ptr = cur_ptr;
 				if (cur_ptr >= line_end_ptr)
 					goto endfield;
@@ -1802,6 +1896,17 @@ CopyReadAttributesCSV(CopyFromState cstate)
 			/* In quote */
 			for (;;)
 			{
+				/* copy data without escapes or quotes in bulk */
+				plain_end = CopySkipPlainBytes(cur_ptr, line_end_ptr, &next_try,
+											   escapec, quotec, quotec, quotec,
+											   quotec);
+				if (plain_end > cur_ptr)
+				{
+					memcpy(output_ptr, cur_ptr, plain_end - cur_ptr);
+					output_ptr += plain_end - cur_ptr;
+					cur_ptr = plain_end;
+				}
+
 				end_ptr = cur_ptr;
 				if (cur_ptr >= line_end_ptr)
 					ereport(ERROR,
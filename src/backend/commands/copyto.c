@@ -37,6 +37,8 @@
 #include "rewrite/rewriteHandler.h"
 #include "storage/fd.h"
 #include "tcop/tcopprot.h"
+#include "utils/builtins.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/partcache.h"
@@ -53,6 +55,23 @@ typedef enum CopyDest
 	COPY_FRONTEND,				/* to frontend */
 } CopyDest;
 
+/*
+ * Columns whose output function is one of the built-in integer output
+ * functions can be formatted directly into the row buffer, without going
+ * through the fmgr interface or the escaping/quoting pass: their text
+ * representation consists of ASCII digits and an optional leading minus sign
+ * only.  See CopyOutFastPathFor() for the conditions under which that is
+ * safe.
+ */
+typedef enum CopyOutFastPath
+{
+	COPY_OUT_FASTPATH_NONE = 0,
+	COPY_OUT_FASTPATH_INT2,
+	COPY_OUT_FASTPATH_INT4,
+	COPY_OUT_FASTPATH_INT8,
+	COPY_OUT_FASTPATH_OID
+} CopyOutFastPath;
+
 /*
  * This struct contains all the state variables used throughout a COPY TO
  * operation.
@@ -95,6 +114,7 @@ typedef struct CopyToStateData
 	MemoryContext copycontext;	/* per-copy execution context */
 
 	FmgrInfo   *out_functions;	/* lookup info for output functions */
+	CopyOutFastPath *out_fastpath;	/* per-column direct formatting, if any */
 	MemoryContext rowcontext;	/* per-row evaluation context */
 	uint64		bytes_processed;	/* number of bytes processed so far */
 } CopyToStateData;
@@ -114,6 +134,8 @@ static const char BinarySignature[11] = "PGCOPY\n\377\r\n\0";
 /* non-export function prototypes */
 static void EndCopy(CopyToState cstate);
 static void ClosePipeToProgram(CopyToState cstate);
+static CopyOutFastPath CopyOutFastPathFor(CopyToState cstate, int attnum,
+										  Oid out_func_oid);
 static void CopyOneRowTo(CopyToState cstate, TupleTableSlot *slot);
 static void CopyAttributeOutText(CopyToState cstate, const char *string);
 static void CopyAttributeOutCSV(CopyToState cstate, const char *string,
@@ -791,6 +813,8 @@ DoCopyTo(CopyToState cstate)
 
 	/* Get info about the columns we need to process. */
 	cstate->out_functions = (FmgrInfo *) palloc(num_phys_attrs * sizeof(FmgrInfo));
+	cstate->out_fastpath = (CopyOutFastPath *)
+		palloc0(num_phys_attrs * sizeof(CopyOutFastPath));
 	foreach(cur, cstate->attnumlist)
 	{
 		int			attnum = lfirst_int(cur);
@@ -807,6 +831,8 @@ DoCopyTo(CopyToState cstate)
 							  &out_func_oid,
 							  &isvarlena);
 		fmgr_info(out_func_oid, &cstate->out_functions[attnum - 1]);
+		cstate->out_fastpath[attnum - 1] =
+			CopyOutFastPathFor(cstate, attnum, out_func_oid);
 	}
 
 	/*
@@ -924,6 +950,75 @@ DoCopyTo(CopyToState cstate)
 	return processed;
 }
 
+/*
+ * Decide whether column "attnum" can bypass its output function.
+ *
+ * This is only done in text and CSV mode, for the built-in integer output
+ * functions, whose result is known to consist of ASCII digits and possibly a
+ * leading '-'.  Such a value never needs transcoding (all client encodings
+ * are ASCII supersets), and never needs escaping or quoting unless one of
+ * those characters is used as the delimiter or quote character, or -- in CSV
+ * mode -- quoting is forced or the value could collide with the NULL string.
+ * In any of those cases we simply fall back to the general path.
+ */
+static CopyOutFastPath
+CopyOutFastPathFor(CopyToState cstate, int attnum, Oid out_func_oid)
+{
+	CopyOutFastPath result;
+
+	if (cstate->opts.binary)
+		return COPY_OUT_FASTPATH_NONE;
+
+	switch (out_func_oid)
+	{
+		case F_INT2OUT:
+			result = COPY_OUT_FASTPATH_INT2;
+			break;
+		case F_INT4OUT:
+			result = COPY_OUT_FASTPATH_INT4;
+			break;
+		case F_INT8OUT:
+			result = COPY_OUT_FASTPATH_INT8;
+			break;
+		case F_OIDOUT:
+			result = COPY_OUT_FASTPATH_OID;
+			break;
+		default:
+			return COPY_OUT_FASTPATH_NONE;
+	}
+
+	/* Text mode only forbids digits as the delimiter, not '-' */
+	if (cstate->opts.delim[0] == '-')
+		return COPY_OUT_FASTPATH_NONE;
+
+	if (cstate->opts.csv_mode)
+	{
+		const char *p;
+
+		if (cstate->opts.force_quote_flags[attnum - 1])
+			return COPY_OUT_FASTPATH_NONE;
+		if (isdigit((unsigned char) cstate->opts.delim[0]) ||
+			isdigit((unsigned char) cstate->opts.quote[0]) ||
+			cstate->opts.quote[0] == '-')
+			return COPY_OUT_FASTPATH_NONE;
+
+		/*
+		 * A value equal to the NULL string must be quoted.  Rather than
+		 * compare every value, give up if the NULL string looks like a
+		 * number at all.
+		 */
+		for (p = cstate->opts.null_print; *p; p++)
+		{
+			if (!isdigit((unsigned char) *p) && *p != '-')
+				break;
+		}
+		if (*p == '\0' && cstate->opts.null_print_len > 0)
+			return COPY_OUT_FASTPATH_NONE;
+	}
+
+	return result;
+}
+
 /*
  * Emit one row during DoCopyTo().
  */
@@ -932,6 +1027,7 @@ CopyOneRowTo(CopyToState cstate, TupleTableSlot *slot)
 {
 	bool		need_delim = false;
 	FmgrInfo   *out_functions = cstate->out_functions;
+	CopyOutFastPath *out_fastpath = cstate->out_fastpath;
 	MemoryContext oldcontext;
 	ListCell   *cur;
 	char	   *string;
@@ -970,7 +1066,34 @@ CopyOneRowTo(CopyToState cstate, TupleTableSlot *slot)
 		}
 		else
 		{
-			if (!cstate->opts.binary)
+			if (out_fastpath[attnum - 1] != COPY_OUT_FASTPATH_NONE)
+			{
+				char		buf[MAXINT8LEN + 1];
+				int			len;
+
+				switch (out_fastpath[attnum - 1])
+				{
+					case COPY_OUT_FASTPATH_INT2:
+						len = pg_itoa(DatumGetInt16(value), buf);
+						break;
+					case COPY_OUT_FASTPATH_INT4:
+						len = pg_ltoa(DatumGetInt32(value), buf);
+						break;
+					case COPY_OUT_FASTPATH_INT8:
+						len = pg_lltoa(DatumGetInt64(value), buf);
+						break;
+					case COPY_OUT_FASTPATH_OID:
+						len = pg_ultoa_n(DatumGetObjectId(value), buf);
+						break;
+					default:
+						elog(ERROR, "unrecognized COPY output fast path: %d",
+							 (int) out_fastpath[attnum - 1]);
+						len = 0;	/* keep compiler quiet */
+						break;
+				}
+				CopySendData(cstate, buf, len);
+			}
+			else if (!cstate->opts.binary)
 			{
 				string = OutputFunctionCall(&out_functions[attnum - 1],
 											value);
@@ -55,11 +55,13 @@
 #include "postmaster/bgwriter.h"
 #include "replication/slot.h"
 #include "storage/copydir.h"
+#include "storage/dbsize_cache.h"
 #include "storage/fd.h"
 #include "storage/ipc.h"
 #include "storage/lmgr.h"
 #include "storage/md.h"
 #include "storage/procarray.h"
+#include "storage/relsize_cache.h"
 #include "storage/smgr.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
@@ -1499,6 +1501,8 @@ createdb_failure_callback(int code, Datum arg)
 	if (fparms->strategy == CREATEDB_WAL_LOG)
 	{
 		DropDatabaseBuffers(fparms->dest_dboid);
+		RelSizeCacheForgetDatabase(fparms->dest_dboid);
+		DbSizeCacheInvalidate(fparms->dest_dboid);
 		ForgetDatabaseSyncRequests(fparms->dest_dboid);
 
 		/* Release lock on the target database. */
@@ -1702,6 +1706,8 @@ dropdb(const char *dbname, bool missing_ok, bool force)
 	 * dirty buffer to the dead database later...
 	 */
 	DropDatabaseBuffers(db_id);
+	RelSizeCacheForgetDatabase(db_id);
+	DbSizeCacheInvalidate(db_id);
 
 	/*
 	 * Tell checkpointer to forget any pending fsync and unlink requests for
@@ -1987,6 +1993,8 @@ movedb(const char *dbname, const char *tblspcname)
 	 * src_tblspcoid, but bufmgr.c presently provides no API for that.
 	 */
 	DropDatabaseBuffers(db_id);
+	RelSizeCacheForgetDatabase(db_id);
+	DbSizeCacheInvalidate(db_id);
 
 	/*
 	 * Check for existence of files in the target directory, i.e., objects of
@@ -3271,6 +3279,8 @@ dbase_redo(XLogReaderState *record)
 
 		/* Drop pages for this database that are in the shared buffer cache */
 		DropDatabaseBuffers(xlrec->db_id);
+		RelSizeCacheForgetDatabase(xlrec->db_id);
+		DbSizeCacheInvalidate(xlrec->db_id);
 
 		/* Also, clean out any fsync requests that might be pending in md.c */
 		ForgetDatabaseSyncRequests(xlrec->db_id);
@@ -120,6 +120,7 @@ static void show_eval_params(Bitmapset *bms_params, ExplainState *es);
 static const char *explain_get_index_name(Oid indexId);
 static void show_buffer_usage(ExplainState *es, const BufferUsage *usage,
 							  bool planning);
+static bool peek_prefetch_info(const PrefetchInfo *prefetch_info);
 static void show_prefetch_info(ExplainState *es, const PrefetchInfo* prefetch_info);
 static void show_wal_usage(ExplainState *es, const WalUsage *usage);
 static void ExplainIndexScanDetails(Oid indexid, ScanDirection indexorderdir,
@@ -2068,8 +2069,14 @@ ExplainNode(PlanState *planstate, List *ancestors,
 	if (es->wal && planstate->instrument)
 		show_wal_usage(es, &planstate->instrument->walusage);
 
-	/* Show prefetch usage */
-	if (es->prefetch && planstate->instrument)
+	/*
+	 * Show prefetch usage.  BUFFERS includes it when the storage manager
+	 * reported any, to tell prefetched reads from synchronous ones.
+	 */
+	if (planstate->instrument &&
+		(es->prefetch ||
+		 (es->buffers &&
+		  peek_prefetch_info(&planstate->instrument->bufusage.prefetch))))
 		show_prefetch_info(es, &planstate->instrument->bufusage.prefetch);
 
 	/* Prepare per-worker buffer/WAL usage */
@@ -3507,6 +3514,16 @@ explain_get_index_name(Oid indexId)
 	return result;
 }
 
+/*
+ * Return whether show_prefetch_info would have anything to show
+ */
+static bool
+peek_prefetch_info(const PrefetchInfo *prefetch_info)
+{
+	return prefetch_info->hits > 0 || prefetch_info->misses > 0 ||
+		prefetch_info->expired > 0 || prefetch_info->duplicates > 0;
+}
+
 /*
  * Show prefetch statistics
  */
@@ -53,10 +53,14 @@
  * We don't want to log each fetching of a value from a sequence,
  * so we pre-log a few fetches in advance. In the event of
  * crash we can lose (skip over) as many values as we pre-logged.
+ *
+ * Zenith XXX: to ensure sequence order of sequence in Zenith we WAL log each
+ * sequence update by default.  Pre-logged values not yet handed out are also
+ * skipped when the page is evicted from shared buffers, because the page
+ * image is reconstructed from WAL, so enabling this trades gaps for fewer
+ * WAL records on hot sequences.  Upstream uses 32.
  */
-/* Zenith XXX: to ensure sequence order of sequence in Zenith we need to WAL log each sequence update. */
-/* #define SEQ_LOG_VALS	32 */
-#define SEQ_LOG_VALS	0
+int			neon_sequence_log_values = 0;
 
 /*
  * The "special area" of a sequence's buffer page looks like this.
@@ -711,8 +715,8 @@ nextval_internal(Oid relid, bool check_permissions)
 
 	/*
 	 * Decide whether we should emit a WAL log record.  If so, force up the
-	 * fetch count to grab SEQ_LOG_VALS more values than we actually need to
-	 * cache.  (These will then be usable without logging.)
+	 * fetch count to grab neon_sequence_log_values more values than we
+	 * actually need to cache.  (These will then be usable without logging.)
 	 *
 	 * If this is the first nextval after a checkpoint, we must force a new
 	 * WAL record to be written anyway, else replay starting from the
@@ -722,7 +726,7 @@ nextval_internal(Oid relid, bool check_permissions)
 	if (log < fetch || !seq->is_called)
 	{
 		/* forced log to satisfy local demand for values */
-		fetch = log = fetch + SEQ_LOG_VALS;
+		fetch = log = fetch + neon_sequence_log_values;
 		logit = true;
 	}
 	else
@@ -732,7 +736,7 @@ nextval_internal(Oid relid, bool check_permissions)
 		if (PageGetLSN(page) <= redoptr)
 		{
 			/* last update of seq was before checkpoint */
-			fetch = log = fetch + SEQ_LOG_VALS;
+			fetch = log = fetch + neon_sequence_log_values;
 			logit = true;
 		}
 	}
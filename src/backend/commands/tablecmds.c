@@ -19,6 +19,7 @@
 #include "access/heapam.h"
 #include "access/heapam_xlog.h"
 #include "access/multixact.h"
+#include "access/parallel.h"
 #include "access/reloptions.h"
 #include "access/relscan.h"
 #include "access/sysattr.h"
@@ -62,6 +63,7 @@
 #include "commands/typecmds.h"
 #include "commands/user.h"
 #include "executor/executor.h"
+#include "executor/instrument.h"
 #include "foreign/fdwapi.h"
 #include "foreign/foreign.h"
 #include "miscadmin.h"
@@ -89,6 +91,7 @@
 #include "storage/lock.h"
 #include "storage/predicate.h"
 #include "storage/smgr.h"
+#include "tcop/tcopprot.h"
 #include "tcop/utility.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
@@ -125,6 +128,26 @@ typedef struct OnCommitItem
 
 static List *on_commits = NIL;
 
+/*
+ * Shared state for parallel verification of a partition constraint.  The
+ * parallel table scan descriptor follows the struct in shared memory.
+ */
+typedef struct ValidateShared
+{
+	Oid			relid;			/* table being verified */
+	bool		validate_default;	/* is it the default partition? */
+} ValidateShared;
+
+#define ParallelTableScanFromValidateShared(shared) \
+	(ParallelTableScanDesc) ((char *) (shared) + BUFFERALIGN(sizeof(ValidateShared)))
+
+/* Magic numbers for parallel state sharing */
+#define PARALLEL_KEY_VALIDATE_SHARED	UINT64CONST(0xA000000000000001)
+#define PARALLEL_KEY_VALIDATE_QUAL		UINT64CONST(0xA000000000000002)
+#define PARALLEL_KEY_QUERY_TEXT			UINT64CONST(0xA000000000000003)
+#define PARALLEL_KEY_WAL_USAGE			UINT64CONST(0xA000000000000004)
+#define PARALLEL_KEY_BUFFER_USAGE		UINT64CONST(0xA000000000000005)
+
 
 /*
  * State information for ALTER TABLE
@@ -407,6 +430,12 @@ static void ATRewriteTables(AlterTableStmt *parsetree,
 							List **wqueue, LOCKMODE lockmode,
 							AlterTableUtilityContext *context);
 static void ATRewriteTable(AlteredTableInfo *tab, Oid OIDNewHeap, LOCKMODE lockmode);
+static bool ATParallelValidatePartition(Relation rel, Expr *partConstraint,
+										bool validate_default, int nworkers);
+static void ATValidatePartitionScan(Relation rel, Expr *partConstraint,
+									bool validate_default,
+									ParallelTableScanDesc pscan);
+static void ATPartitionConstraintViolated(Relation rel, bool validate_default) pg_attribute_noreturn();
 static AlteredTableInfo *ATGetQueueEntry(List **wqueue, Relation rel);
 static void ATSimplePermissions(AlterTableType cmdtype, Relation rel, int allowed_targets);
 static void ATSimpleRecursion(List **wqueue, Relation rel,
@@ -5798,6 +5827,24 @@ ATRewriteTable(AlteredTableInfo *tab, Oid OIDNewHeap, LOCKMODE lockmode)
 			needscan = true;
 	}
 
+	/*
+	 * If all we have to do is verify the partition constraint, as when
+	 * attaching a partition, try to spread the scan across parallel workers.
+	 * If none can be launched, fall back to the serial scan below.
+	 */
+	if (!newrel && partqualstate && tab->constraints == NIL &&
+		notnull_attrs == NIL)
+	{
+		int			nworkers;
+
+		nworkers = plan_validate_constraint_workers(tab->relid,
+													(Node *) tab->partition_constraint);
+		if (nworkers > 0 &&
+			ATParallelValidatePartition(oldrel, tab->partition_constraint,
+										tab->validate_default, nworkers))
+			needscan = false;
+	}
+
 	if (newrel || needscan)
 	{
 		ExprContext *econtext;
@@ -6015,20 +6062,7 @@ ATRewriteTable(AlteredTableInfo *tab, Oid OIDNewHeap, LOCKMODE lockmode)
 			}
 
 			if (partqualstate && !ExecCheck(partqualstate, econtext))
-			{
-				if (tab->validate_default)
-					ereport(ERROR,
-							(errcode(ERRCODE_CHECK_VIOLATION),
-							 errmsg("updated partition constraint for default partition \"%s\" would be violated by some row",
-									RelationGetRelationName(oldrel)),
-							 errtable(oldrel)));
-				else
-					ereport(ERROR,
-							(errcode(ERRCODE_CHECK_VIOLATION),
-							 errmsg("partition constraint of relation \"%s\" is violated by some row",
-									RelationGetRelationName(oldrel)),
-							 errtable(oldrel)));
-			}
+				ATPartitionConstraintViolated(oldrel, tab->validate_default);
 
 			/* Write the tuple out to the new relation */
 			if (newrel)
@@ -6062,6 +6096,249 @@ ATRewriteTable(AlteredTableInfo *tab, Oid OIDNewHeap, LOCKMODE lockmode)
 	}
 }
 
+/*
+ * ATParallelValidatePartition: verify a partition constraint using a
+ * parallel scan of the table
+ *
+ * nworkers is the number of parallel worker processes to request.  The
+ * leader participates in the scan too.  A violation found by any
+ * participant is reported as an error.  Returns false, having done nothing,
+ * if no worker could be launched; the caller must then scan serially.
+ */
+static bool
+ATParallelValidatePartition(Relation rel, Expr *partConstraint,
+							bool validate_default, int nworkers)
+{
+	ParallelContext *pcxt;
+	Snapshot	snapshot;
+	Size		estshared;
+	ValidateShared *vshared;
+	char	   *qualstr;
+	char	   *sharedqual;
+	WalUsage   *walusage;
+	BufferUsage *bufferusage;
+	int			querylen;
+	int			i;
+
+	EnterParallelMode();
+	pcxt = CreateParallelContext("postgres", "ATParallelValidateMain",
+								 nworkers);
+
+	/* Same snapshot as the serial scan in ATRewriteTable would use */
+	snapshot = RegisterSnapshot(GetLatestSnapshot());
+
+	/* Estimate space for shared state and the serialized qual */
+	estshared = add_size(BUFFERALIGN(sizeof(ValidateShared)),
+						 table_parallelscan_estimate(rel, snapshot));
+	shm_toc_estimate_chunk(&pcxt->estimator, estshared);
+	qualstr = nodeToString(partConstraint);
+	shm_toc_estimate_chunk(&pcxt->estimator, strlen(qualstr) + 1);
+	shm_toc_estimate_keys(&pcxt->estimator, 2);
+
+	/* Estimate space for WalUsage and BufferUsage */
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(sizeof(WalUsage), pcxt->nworkers));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(sizeof(BufferUsage), pcxt->nworkers));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+
+	/* Finally, estimate PARALLEL_KEY_QUERY_TEXT space */
+	if (debug_query_string)
+	{
+		querylen = strlen(debug_query_string);
+		shm_toc_estimate_chunk(&pcxt->estimator, querylen + 1);
+		shm_toc_estimate_keys(&pcxt->estimator, 1);
+	}
+	else
+		querylen = 0;			/* keep compiler quiet */
+
+	InitializeParallelDSM(pcxt);
+
+	/* If no DSM segment was available, back out (do serial scan) */
+	if (pcxt->seg == NULL)
+		goto backout;
+
+	vshared = (ValidateShared *) shm_toc_allocate(pcxt->toc, estshared);
+	vshared->relid = RelationGetRelid(rel);
+	vshared->validate_default = validate_default;
+	table_parallelscan_initialize(rel,
+								  ParallelTableScanFromValidateShared(vshared),
+								  snapshot);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_VALIDATE_SHARED, vshared);
+
+	sharedqual = (char *) shm_toc_allocate(pcxt->toc, strlen(qualstr) + 1);
+	strcpy(sharedqual, qualstr);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_VALIDATE_QUAL, sharedqual);
+
+	if (debug_query_string)
+	{
+		char	   *sharedquery;
+
+		sharedquery = (char *) shm_toc_allocate(pcxt->toc, querylen + 1);
+		memcpy(sharedquery, debug_query_string, querylen + 1);
+		shm_toc_insert(pcxt->toc, PARALLEL_KEY_QUERY_TEXT, sharedquery);
+	}
+
+	walusage = shm_toc_allocate(pcxt->toc,
+								mul_size(sizeof(WalUsage), pcxt->nworkers));
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_WAL_USAGE, walusage);
+	bufferusage = shm_toc_allocate(pcxt->toc,
+								   mul_size(sizeof(BufferUsage), pcxt->nworkers));
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_BUFFER_USAGE, bufferusage);
+
+	LaunchParallelWorkers(pcxt);
+
+	/* If no workers were successfully launched, back out (do serial scan) */
+	if (pcxt->nworkers_launched == 0)
+	{
+		WaitForParallelWorkersToFinish(pcxt);
+		goto backout;
+	}
+
+	ereport(DEBUG1,
+			(errmsg_internal("verifying table \"%s\" with %d parallel workers",
+							 RelationGetRelationName(rel),
+							 pcxt->nworkers_launched)));
+
+	/* Join the scan ourselves, then wait for the workers */
+	ATValidatePartitionScan(rel, partConstraint, validate_default,
+							ParallelTableScanFromValidateShared(vshared));
+	WaitForParallelWorkersToFinish(pcxt);
+
+	/*
+	 * Next, accumulate WAL usage.  (This must wait for the workers to finish,
+	 * or we might get incomplete data.)
+	 */
+	for (i = 0; i < pcxt->nworkers_launched; i++)
+		InstrAccumParallelQuery(&bufferusage[i], &walusage[i]);
+
+	DestroyParallelContext(pcxt);
+	ExitParallelMode();
+	UnregisterSnapshot(snapshot);
+
+	return true;
+
+backout:
+	DestroyParallelContext(pcxt);
+	ExitParallelMode();
+	UnregisterSnapshot(snapshot);
+
+	return false;
+}
+
+/*
+ * ATValidatePartitionScan: check the rows returned by a parallel scan
+ * against a partition constraint
+ *
+ * Used by the leader and each worker in a parallel verification.
+ */
+static void
+ATValidatePartitionScan(Relation rel, Expr *partConstraint,
+						bool validate_default, ParallelTableScanDesc pscan)
+{
+	EState	   *estate;
+	ExprState  *partqualstate;
+	ExprContext *econtext;
+	TupleTableSlot *slot;
+	TableScanDesc scan;
+	MemoryContext oldCxt;
+
+	estate = CreateExecutorState();
+	partqualstate = ExecPrepareExpr(partConstraint, estate);
+	econtext = GetPerTupleExprContext(estate);
+
+	slot = MakeSingleTupleTableSlot(RelationGetDescr(rel),
+									table_slot_callbacks(rel));
+	scan = table_beginscan_parallel(rel, pscan);
+
+	oldCxt = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+
+	econtext->ecxt_scantuple = slot;
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		if (!ExecCheck(partqualstate, econtext))
+			ATPartitionConstraintViolated(rel, validate_default);
+
+		ResetExprContext(econtext);
+
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	MemoryContextSwitchTo(oldCxt);
+	table_endscan(scan);
+
+	ExecDropSingleTupleTableSlot(slot);
+	FreeExecutorState(estate);
+}
+
+/*
+ * Report that some row of rel violates its (new) partition constraint
+ */
+static void
+ATPartitionConstraintViolated(Relation rel, bool validate_default)
+{
+	if (validate_default)
+		ereport(ERROR,
+				(errcode(ERRCODE_CHECK_VIOLATION),
+				 errmsg("updated partition constraint for default partition \"%s\" would be violated by some row",
+						RelationGetRelationName(rel)),
+				 errtable(rel)));
+	else
+		ereport(ERROR,
+				(errcode(ERRCODE_CHECK_VIOLATION),
+				 errmsg("partition constraint of relation \"%s\" is violated by some row",
+						RelationGetRelationName(rel)),
+				 errtable(rel)));
+}
+
+/*
+ * Perform work within a launched parallel process.
+ *
+ * Parallel workers of ATParallelValidatePartition enter here.
+ */
+void
+ATParallelValidateMain(dsm_segment *seg, shm_toc *toc)
+{
+	char	   *sharedquery;
+	ValidateShared *vshared;
+	Expr	   *partConstraint;
+	Relation	rel;
+	WalUsage   *walusage;
+	BufferUsage *bufferusage;
+
+	/* Set debug_query_string for individual workers first */
+	sharedquery = shm_toc_lookup(toc, PARALLEL_KEY_QUERY_TEXT, true);
+	debug_query_string = sharedquery;
+
+	/* Report the query string from leader */
+	pgstat_report_activity(STATE_RUNNING, debug_query_string);
+
+	vshared = shm_toc_lookup(toc, PARALLEL_KEY_VALIDATE_SHARED, false);
+	partConstraint = (Expr *)
+		stringToNode(shm_toc_lookup(toc, PARALLEL_KEY_VALIDATE_QUAL, false));
+
+	/*
+	 * The leader holds a stronger lock, which doesn't conflict with ours
+	 * since we're in its lock group.
+	 */
+	rel = table_open(vshared->relid, AccessShareLock);
+
+	/* Prepare to track buffer usage during parallel execution */
+	InstrStartParallelQuery();
+
+	ATValidatePartitionScan(rel, partConstraint, vshared->validate_default,
+							ParallelTableScanFromValidateShared(vshared));
+
+	/* Report WAL/buffer usage during parallel execution */
+	bufferusage = shm_toc_lookup(toc, PARALLEL_KEY_BUFFER_USAGE, false);
+	walusage = shm_toc_lookup(toc, PARALLEL_KEY_WAL_USAGE, false);
+	InstrEndParallelQuery(&bufferusage[ParallelWorkerNumber],
+						  &walusage[ParallelWorkerNumber]);
+
+	table_close(rel, AccessShareLock);
+}
+
 /*
  * ATGetQueueEntry: find or create an entry in the ALTER TABLE work queue
  */
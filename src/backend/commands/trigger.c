@@ -3807,6 +3807,27 @@ typedef struct AfterTriggerEventList
 #define for_each_event_chunk(eptr, cptr, evtlist) \
 	for_each_chunk(cptr, evtlist) for_each_event(eptr, cptr)
 
+/*
+ * Tuples left in the trigger slots by AfterTriggerExecute().
+ *
+ * Row-level events for all the triggers fired by one row are queued one
+ * after another, so consecutive events usually reference the same ctids.
+ * afterTriggerInvokeEvents() keeps the tuples fetched for the previous event
+ * in the trigger slots and remembers where they came from here, so that
+ * firing N triggers for a row costs one tuple fetch rather than N.  The
+ * contents of a ctid cannot change underneath us: the slot holds a pin on
+ * the tuple's buffer, which keeps the page from being pruned.
+ */
+typedef struct AfterTriggerFetchCache
+{
+	ResultRelInfo *old_relInfo; /* rel old_ctid was fetched from */
+	ItemPointerData old_ctid;
+	TupleTableSlot *old_slot;	/* tg_trigslot holding that tuple, or NULL */
+	ResultRelInfo *new_relInfo; /* rel new_ctid was fetched from */
+	ItemPointerData new_ctid;
+	TupleTableSlot *new_slot;	/* tg_newslot holding that tuple, or NULL */
+} AfterTriggerFetchCache;
+
 /* Macros for iterating from a start point that might not be list start */
 #define for_each_chunk_from(cptr) \
 	for (; cptr != NULL; cptr = cptr->next)
@@ -3969,7 +3990,9 @@ static void AfterTriggerExecute(EState *estate,
 								Instrumentation *instr,
 								MemoryContext per_tuple_context,
 								TupleTableSlot *trig_tuple_slot1,
-								TupleTableSlot *trig_tuple_slot2);
+								TupleTableSlot *trig_tuple_slot2,
+								AfterTriggerFetchCache *fetch_cache);
+static void AfterTriggerFetchCacheReset(AfterTriggerFetchCache *fetch_cache);
 static AfterTriggersTableData *GetAfterTriggersTableData(Oid relid,
 														 CmdType cmdType);
 static TupleTableSlot *GetAfterTriggersStoreSlot(AfterTriggersTableData *table,
@@ -4346,6 +4369,8 @@ afterTriggerDeleteHeadEventChunk(AfterTriggersQueryData *qs)
  *	per_tuple_context: memory context to call trigger function in.
  *	trig_tuple_slot1: scratch slot for tg_trigtuple (foreign tables only)
  *	trig_tuple_slot2: scratch slot for tg_newtuple (foreign tables only)
+ *	fetch_cache: tuples left in the trigger slots by the previous call
+ *		(not used for foreign tables)
  * ----------
  */
 static void
@@ -4358,7 +4383,8 @@ AfterTriggerExecute(EState *estate,
 					FmgrInfo *finfo, Instrumentation *instr,
 					MemoryContext per_tuple_context,
 					TupleTableSlot *trig_tuple_slot1,
-					TupleTableSlot *trig_tuple_slot2)
+					TupleTableSlot *trig_tuple_slot2,
+					AfterTriggerFetchCache *fetch_cache)
 {
 	Relation	rel = relInfo->ri_RelationDesc;
 	Relation	src_rel = src_relInfo->ri_RelationDesc;
@@ -4441,7 +4467,17 @@ AfterTriggerExecute(EState *estate,
 			break;
 
 		default:
-			if (ItemPointerIsValid(&(event->ate_ctid1)))
+			if (ItemPointerIsValid(&(event->ate_ctid1)) &&
+				fetch_cache->old_slot != NULL &&
+				fetch_cache->old_relInfo == src_relInfo &&
+				ItemPointerEquals(&fetch_cache->old_ctid, &(event->ate_ctid1)))
+			{
+				/* still there from the previous event */
+				LocTriggerData.tg_trigslot = fetch_cache->old_slot;
+				LocTriggerData.tg_trigtuple =
+					ExecFetchSlotHeapTuple(LocTriggerData.tg_trigslot, false, &should_free_trig);
+			}
+			else if (ItemPointerIsValid(&(event->ate_ctid1)))
 			{
 				TupleTableSlot *src_slot = ExecGetTriggerOldSlot(estate,
 																 src_relInfo);
@@ -4474,6 +4510,10 @@ AfterTriggerExecute(EState *estate,
 					LocTriggerData.tg_trigslot = src_slot;
 				LocTriggerData.tg_trigtuple =
 					ExecFetchSlotHeapTuple(LocTriggerData.tg_trigslot, false, &should_free_trig);
+
+				fetch_cache->old_relInfo = src_relInfo;
+				ItemPointerCopy(&(event->ate_ctid1), &fetch_cache->old_ctid);
+				fetch_cache->old_slot = LocTriggerData.tg_trigslot;
 			}
 			else
 			{
@@ -4483,7 +4523,19 @@ AfterTriggerExecute(EState *estate,
 			/* don't touch ctid2 if not there */
 			if (((event->ate_flags & AFTER_TRIGGER_TUP_BITS) == AFTER_TRIGGER_2CTID ||
 				 (event->ate_flags & AFTER_TRIGGER_CP_UPDATE)) &&
-				ItemPointerIsValid(&(event->ate_ctid2)))
+				ItemPointerIsValid(&(event->ate_ctid2)) &&
+				fetch_cache->new_slot != NULL &&
+				fetch_cache->new_relInfo == dst_relInfo &&
+				ItemPointerEquals(&fetch_cache->new_ctid, &(event->ate_ctid2)))
+			{
+				/* still there from the previous event */
+				LocTriggerData.tg_newslot = fetch_cache->new_slot;
+				LocTriggerData.tg_newtuple =
+					ExecFetchSlotHeapTuple(LocTriggerData.tg_newslot, false, &should_free_new);
+			}
+			else if (((event->ate_flags & AFTER_TRIGGER_TUP_BITS) == AFTER_TRIGGER_2CTID ||
+					  (event->ate_flags & AFTER_TRIGGER_CP_UPDATE)) &&
+					 ItemPointerIsValid(&(event->ate_ctid2)))
 			{
 				TupleTableSlot *dst_slot = ExecGetTriggerNewSlot(estate,
 																 dst_relInfo);
@@ -4517,6 +4569,10 @@ AfterTriggerExecute(EState *estate,
 					LocTriggerData.tg_newslot = dst_slot;
 				LocTriggerData.tg_newtuple =
 					ExecFetchSlotHeapTuple(LocTriggerData.tg_newslot, false, &should_free_new);
+
+				fetch_cache->new_relInfo = dst_relInfo;
+				ItemPointerCopy(&(event->ate_ctid2), &fetch_cache->new_ctid);
+				fetch_cache->new_slot = LocTriggerData.tg_newslot;
 			}
 			else
 			{
@@ -4587,14 +4643,12 @@ AfterTriggerExecute(EState *estate,
 	if (should_free_new)
 		heap_freetuple(LocTriggerData.tg_newtuple);
 
-	/* don't clear slots' contents if foreign table */
-	if (trig_tuple_slot1 == NULL)
-	{
-		if (LocTriggerData.tg_trigslot)
-			ExecClearTuple(LocTriggerData.tg_trigslot);
-		if (LocTriggerData.tg_newslot)
-			ExecClearTuple(LocTriggerData.tg_newslot);
-	}
+	/*
+	 * Don't clear the slots' contents: foreign table tuples may be reused by
+	 * AFTER_TRIGGER_FDW_REUSE events, and fetched heap tuples by the next
+	 * event for the same row (see AfterTriggerFetchCache).  The caller clears
+	 * them with AfterTriggerFetchCacheReset() when done.
+	 */
 
 	/*
 	 * If doing EXPLAIN ANALYZE, stop charging time to this trigger, and count
@@ -4605,6 +4659,21 @@ AfterTriggerExecute(EState *estate,
 }
 
 
+/*
+ * AfterTriggerFetchCacheReset()
+ *
+ *	Release the tuples remembered in fetch_cache, and forget about them.
+ */
+static void
+AfterTriggerFetchCacheReset(AfterTriggerFetchCache *fetch_cache)
+{
+	if (fetch_cache->old_slot)
+		ExecClearTuple(fetch_cache->old_slot);
+	if (fetch_cache->new_slot)
+		ExecClearTuple(fetch_cache->new_slot);
+	memset(fetch_cache, 0, sizeof(AfterTriggerFetchCache));
+}
+
 /*
  * afterTriggerMarkEvents()
  *
@@ -4720,6 +4789,7 @@ afterTriggerInvokeEvents(AfterTriggerEventList *events,
 	Instrumentation *instr = NULL;
 	TupleTableSlot *slot1 = NULL,
 			   *slot2 = NULL;
+	AfterTriggerFetchCache fetch_cache = {0};
 
 	/* Make a local EState if need be */
 	if (estate == NULL)
@@ -4758,6 +4828,7 @@ afterTriggerInvokeEvents(AfterTriggerEventList *events,
 				 */
 				if (rel == NULL || RelationGetRelid(rel) != evtshared->ats_relid)
 				{
+					AfterTriggerFetchCacheReset(&fetch_cache);
 					rInfo = ExecGetTriggerResultRel(estate, evtshared->ats_relid,
 													NULL);
 					rel = rInfo->ri_RelationDesc;
@@ -4811,7 +4882,8 @@ afterTriggerInvokeEvents(AfterTriggerEventList *events,
 				AfterTriggerExecute(estate, event, rInfo,
 									src_rInfo, dst_rInfo,
 									trigdesc, finfo, instr,
-									per_tuple_context, slot1, slot2);
+									per_tuple_context, slot1, slot2,
+									&fetch_cache);
 
 				/*
 				 * Mark the event as done.
@@ -4842,6 +4914,7 @@ afterTriggerInvokeEvents(AfterTriggerEventList *events,
 				events->tailfree = chunk->freeptr;
 		}
 	}
+	AfterTriggerFetchCacheReset(&fetch_cache);
 	if (slot1 != NULL)
 	{
 		ExecDropSingleTupleTableSlot(slot1);
@@ -45,6 +45,7 @@
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
 #include "pgstat.h"
+#include "port/pg_bitutils.h"
 #include "postmaster/autovacuum.h"
 #include "postmaster/bgworker_internals.h"
 #include "storage/bufmgr.h"
@@ -96,7 +97,6 @@ static bool vacuum_rel(Oid relid, RangeVar *relation, VacuumParams *params);
 static double compute_parallel_delay(void);
 static VacOptValue get_vacoptval_from_boolean(DefElem *def);
 static bool vac_tid_reaped(ItemPointer itemptr, void *state);
-static int	vac_cmp_itemptr(const void *left, const void *right);
 
 /*
  * Primary entry point for manual VACUUM and ANALYZE commands
@@ -2351,9 +2351,9 @@ vac_bulkdel_one_index(IndexVacuumInfo *ivinfo, IndexBulkDeleteResult *istat,
 							  (void *) dead_items);
 
 	ereport(ivinfo->message_level,
-			(errmsg("scanned index \"%s\" to remove %d row versions",
+			(errmsg("scanned index \"%s\" to remove %lld row versions",
 					RelationGetRelationName(ivinfo->index),
-					dead_items->num_items)));
+					(long long) dead_items->num_items)));
 
 	return istat;
 }
@@ -2385,81 +2385,283 @@ vac_cleanup_one_index(IndexVacuumInfo *ivinfo, IndexBulkDeleteResult *istat)
 }
 
 /*
- * Returns the total required space for VACUUM's dead_items array given a
- * max_items value.
+ * Returns the total required space for VACUUM's dead_items given a max_slots
+ * value.
  */
 Size
-vac_max_items_to_alloc_size(int max_items)
+vac_max_slots_to_alloc_size(int max_slots)
 {
-	Assert(max_items <= MAXDEADITEMS(MaxAllocSize));
+	Assert(max_slots <= MAXDEADSLOTS(MaxAllocSize));
 
-	return offsetof(VacDeadItems, items) + sizeof(ItemPointerData) * max_items;
+	return offsetof(VacDeadItems, data) + sizeof(uint64) * max_slots;
 }
 
 /*
- *	vac_tid_reaped() -- is a particular tid deletable?
+ * Initialize dead_items, allocated with room for max_slots slots, as empty.
+ */
+void
+vac_dead_items_init(VacDeadItems *dead_items, int max_slots)
+{
+	Assert(max_slots >= VAC_DEAD_BLOCK_MAX_SLOTS);
+
+	dead_items->max_slots = max_slots;
+	vac_dead_items_reset(dead_items);
+}
+
+/*
+ * Forget all the TIDs in dead_items.
+ */
+void
+vac_dead_items_reset(VacDeadItems *dead_items)
+{
+	dead_items->num_blocks = 0;
+	dead_items->num_items = 0;
+}
+
+/* number of OffsetNumbers in a slot of a block's array */
+#define VAC_DEAD_OFFSETS_PER_SLOT	(sizeof(uint64) / sizeof(OffsetNumber))
+
+/* slot where the offsets of the entries from blockidx on end */
+static inline int
+vac_dead_items_offsets_end(VacDeadItems *dead_items, int blockidx)
+{
+	VacDeadBlock *blocks = (VacDeadBlock *) dead_items->data;
+
+	return blockidx == 0 ? dead_items->max_slots :
+		(int) blocks[blockidx - 1].first_slot;
+}
+
+/*
+ * Returns true if dead_items might not have room for the TIDs of another
+ * heap block.
+ */
+bool
+vac_dead_items_full(VacDeadItems *dead_items)
+{
+	int			free_slots;
+
+	free_slots = vac_dead_items_offsets_end(dead_items,
+											dead_items->num_blocks) -
+		dead_items->num_blocks;
+
+	return free_slots < VAC_DEAD_BLOCK_MAX_SLOTS;
+}
+
+/*
+ * Returns the number of TIDs that dead_items has room for at least.
  *
- *		This has the right signature to be an IndexBulkDeleteCallback.
+ * The worst case is a single TID per heap block, which takes a VacDeadBlock
+ * and a slot for its one-element array.  Blocks with more TIDs take fewer
+ * slots per TID.
+ */
+int64
+vac_dead_items_max_items(VacDeadItems *dead_items)
+{
+	return (dead_items->max_slots - VAC_DEAD_BLOCK_MAX_SLOTS) / 2 + 1;
+}
+
+/*
+ * Returns the space taken by the TIDs in dead_items.
+ */
+Size
+vac_dead_items_used_size(VacDeadItems *dead_items)
+{
+	int			used_slots;
+
+	used_slots = dead_items->num_blocks + dead_items->max_slots -
+		vac_dead_items_offsets_end(dead_items, dead_items->num_blocks);
+
+	return sizeof(uint64) * used_slots;
+}
+
+/*
+ * Add the TIDs of heap block blkno with the given offset numbers, in
+ * ascending order, to dead_items.
  *
- *		Assumes dead_items array is sorted (in ascending TID order).
+ * Blocks must be added in ascending block number order, each only once, and
+ * the caller must make sure there's room with vac_dead_items_full().
  */
-static bool
-vac_tid_reaped(ItemPointer itemptr, void *state)
+void
+vac_dead_items_add(VacDeadItems *dead_items, BlockNumber blkno,
+				   OffsetNumber *offsets, int num_offsets)
 {
-	VacDeadItems *dead_items = (VacDeadItems *) state;
-	int64		litem,
-				ritem,
-				item;
-	ItemPointer res;
+	VacDeadBlock *blocks = (VacDeadBlock *) dead_items->data;
+	OffsetNumber maxoff = offsets[num_offsets - 1];
+	int			bitmap_slots;
+	int			array_slots;
+	int			first_slot;
+	bool		is_array;
+
+	Assert(num_offsets > 0);
+	Assert(!vac_dead_items_full(dead_items));
+	Assert(dead_items->num_blocks == 0 ||
+		   blocks[dead_items->num_blocks - 1].blkno < blkno);
+	Assert(OffsetNumberIsValid(maxoff) && maxoff <= MaxHeapTuplesPerPage);
+
+	bitmap_slots = (maxoff - 1) / 64 + 1;
+	array_slots = (num_offsets - 1) / VAC_DEAD_OFFSETS_PER_SLOT + 1;
+	is_array = array_slots < bitmap_slots;
+	first_slot = vac_dead_items_offsets_end(dead_items,
+											dead_items->num_blocks) -
+		(is_array ? array_slots : bitmap_slots);
+
+	if (is_array)
+	{
+		OffsetNumber *array = (OffsetNumber *) &dead_items->data[first_slot];
 
-	litem = itemptr_encode(&dead_items->items[0]);
-	ritem = itemptr_encode(&dead_items->items[dead_items->num_items - 1]);
-	item = itemptr_encode(itemptr);
+		memset(array, 0, sizeof(uint64) * array_slots);
+		for (int i = 0; i < num_offsets; i++)
+		{
+			Assert(i == 0 || offsets[i - 1] < offsets[i]);
+			array[i] = offsets[i];
+		}
+	}
+	else
+	{
+		uint64	   *bitmap = &dead_items->data[first_slot];
 
-	/*
-	 * Doing a simple bound check before bsearch() is useful to avoid the
-	 * extra cost of bsearch(), especially if dead items on the heap are
-	 * concentrated in a certain range.  Since this function is called for
-	 * every index tuple, it pays to be really fast.
-	 */
-	if (item < litem || item > ritem)
-		return false;
+		memset(bitmap, 0, sizeof(uint64) * bitmap_slots);
+		for (int i = 0; i < num_offsets; i++)
+		{
+			Assert(i == 0 || offsets[i - 1] < offsets[i]);
+			bitmap[(offsets[i] - 1) / 64] |= UINT64CONST(1) << ((offsets[i] - 1) % 64);
+		}
+	}
 
-	res = (ItemPointer) bsearch((void *) itemptr,
-								(void *) dead_items->items,
-								dead_items->num_items,
-								sizeof(ItemPointerData),
-								vac_cmp_itemptr);
+	blocks[dead_items->num_blocks].blkno = blkno;
+	blocks[dead_items->num_blocks].first_slot = first_slot;
+	blocks[dead_items->num_blocks].is_array = is_array;
+	dead_items->num_blocks++;
+	dead_items->num_items += num_offsets;
+}
 
-	return (res != NULL);
+/*
+ * Returns the heap block number of the blockidx'th block in dead_items.
+ */
+BlockNumber
+vac_dead_items_get_block(VacDeadItems *dead_items, int blockidx)
+{
+	VacDeadBlock *blocks = (VacDeadBlock *) dead_items->data;
+
+	Assert(blockidx >= 0 && blockidx < dead_items->num_blocks);
+
+	return blocks[blockidx].blkno;
 }
 
 /*
- * Comparator routines for use with qsort() and bsearch().
+ * Store the offset numbers of the TIDs of the blockidx'th block in
+ * dead_items into *offsets, in ascending order, and return their number.
+ * offsets must have room for MaxHeapTuplesPerPage entries.
  */
-static int
-vac_cmp_itemptr(const void *left, const void *right)
+int
+vac_dead_items_get_offsets(VacDeadItems *dead_items, int blockidx,
+						   OffsetNumber *offsets)
 {
-	BlockNumber lblk,
-				rblk;
-	OffsetNumber loff,
-				roff;
+	VacDeadBlock *blocks = (VacDeadBlock *) dead_items->data;
+	int			end = vac_dead_items_offsets_end(dead_items, blockidx);
+	int			noffsets = 0;
+
+	Assert(blockidx >= 0 && blockidx < dead_items->num_blocks);
+
+	if (blocks[blockidx].is_array)
+	{
+		OffsetNumber *array;
+		int			nentries;
 
-	lblk = ItemPointerGetBlockNumber((ItemPointer) left);
-	rblk = ItemPointerGetBlockNumber((ItemPointer) right);
+		array = (OffsetNumber *) &dead_items->data[blocks[blockidx].first_slot];
+		nentries = (end - blocks[blockidx].first_slot) * VAC_DEAD_OFFSETS_PER_SLOT;
+		while (noffsets < nentries && OffsetNumberIsValid(array[noffsets]))
+		{
+			offsets[noffsets] = array[noffsets];
+			noffsets++;
+		}
+		return noffsets;
+	}
 
-	if (lblk < rblk)
-		return -1;
-	if (lblk > rblk)
-		return 1;
+	for (int slot = blocks[blockidx].first_slot; slot < end; slot++)
+	{
+		uint64		word = dead_items->data[slot];
+		int			base = (slot - blocks[blockidx].first_slot) * 64 + 1;
 
-	loff = ItemPointerGetOffsetNumber((ItemPointer) left);
-	roff = ItemPointerGetOffsetNumber((ItemPointer) right);
+		while (word != 0)
+		{
+			int			bit = pg_rightmost_one_pos64(word);
 
-	if (loff < roff)
-		return -1;
-	if (loff > roff)
-		return 1;
+			offsets[noffsets++] = base + bit;
+			word &= word - 1;
+		}
+	}
+
+	return noffsets;
+}
+
+/*
+ *	vac_tid_reaped() -- is a particular tid deletable?
+ *
+ *		This has the right signature to be an IndexBulkDeleteCallback.
+ */
+static bool
+vac_tid_reaped(ItemPointer itemptr, void *state)
+{
+	VacDeadItems *dead_items = (VacDeadItems *) state;
+	VacDeadBlock *blocks = (VacDeadBlock *) dead_items->data;
+	BlockNumber blkno = ItemPointerGetBlockNumber(itemptr);
+	OffsetNumber offnum = ItemPointerGetOffsetNumber(itemptr);
+	int			lo,
+				hi;
+	int			slot;
+	int			end;
+
+	/*
+	 * Doing a simple bound check before the binary search is useful to avoid
+	 * its extra cost, especially if dead items on the heap are concentrated
+	 * in a certain range.  Since this function is called for every index
+	 * tuple, it pays to be really fast.
+	 */
+	if (dead_items->num_blocks == 0 ||
+		blkno < blocks[0].blkno ||
+		blkno > blocks[dead_items->num_blocks - 1].blkno)
+		return false;
+
+	/* find the block's entry */
+	lo = 0;
+	hi = dead_items->num_blocks - 1;
+	while (lo < hi)
+	{
+		int			mid = lo + (hi - lo) / 2;
+
+		if (blocks[mid].blkno < blkno)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (blocks[lo].blkno != blkno)
+		return false;
+
+	end = vac_dead_items_offsets_end(dead_items, lo);
+
+	/* look for the offset in the block's array, which is short */
+	if (blocks[lo].is_array)
+	{
+		OffsetNumber *array;
+		int			nentries;
+
+		array = (OffsetNumber *) &dead_items->data[blocks[lo].first_slot];
+		nentries = (end - blocks[lo].first_slot) * VAC_DEAD_OFFSETS_PER_SLOT;
+		for (int i = 0; i < nentries && array[i] <= offnum; i++)
+		{
+			if (array[i] == offnum)
+				return true;
+			if (!OffsetNumberIsValid(array[i]))
+				break;
+		}
+		return false;
+	}
+
+	/* or test the offset's bit */
+	slot = blocks[lo].first_slot + (offnum - 1) / 64;
+	if (slot >= end)
+		return false;
 
-	return 0;
+	return (dead_items->data[slot] & (UINT64CONST(1) << ((offnum - 1) % 64))) != 0;
 }
@@ -32,6 +32,7 @@
 
 #include "access/nbtree.h"
 #include "catalog/objectaccess.h"
+#include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
 #include "executor/execExpr.h"
 #include "executor/nodeSubplan.h"
@@ -64,6 +65,11 @@ typedef struct ExprSetupInfo
 static void ExecReadyExpr(ExprState *state);
 static void ExecInitExprRec(Expr *node, ExprState *state,
 							Datum *resv, bool *resnull);
+static bool expr_find_cacheable(Node *node, List **cacheable);
+static bool expr_find_cacheable_walker(Node *node, void *context);
+static int	ExecInitCachedExpr(Expr *node, ExprState *state,
+							   Datum *resv, bool *resnull);
+static void ExecFinishCachedExpr(Expr *node, ExprState *state, int checkstep);
 static void ExecInitFunc(ExprEvalStep *scratch, Expr *node, List *args,
 						 Oid funcid, Oid inputcollid,
 						 ExprState *state);
@@ -870,6 +876,12 @@ ExecCheck(ExprState *state, ExprContext *econtext)
 static void
 ExecReadyExpr(ExprState *state)
 {
+	if (jit_defer_compile_expr(state))
+	{
+		ExecReadyDeferredJitExpr(state);
+		return;
+	}
+
 	if (jit_compile_expr(state))
 		return;
 
@@ -1120,22 +1132,28 @@ ExecInitExprRec(Expr *node, ExprState *state,
 		case T_FuncExpr:
 			{
 				FuncExpr   *func = (FuncExpr *) node;
+				int			checkstep;
 
+				checkstep = ExecInitCachedExpr(node, state, resv, resnull);
 				ExecInitFunc(&scratch, node,
 							 func->args, func->funcid, func->inputcollid,
 							 state);
 				ExprEvalPushStep(state, &scratch);
+				ExecFinishCachedExpr(node, state, checkstep);
 				break;
 			}
 
 		case T_OpExpr:
 			{
 				OpExpr	   *op = (OpExpr *) node;
+				int			checkstep;
 
+				checkstep = ExecInitCachedExpr(node, state, resv, resnull);
 				ExecInitFunc(&scratch, node,
 							 op->args, op->opfuncid, op->inputcollid,
 							 state);
 				ExprEvalPushStep(state, &scratch);
+				ExecFinishCachedExpr(node, state, checkstep);
 				break;
 			}
 
@@ -2445,6 +2463,170 @@ ExprEvalPushStep(ExprState *es, const ExprEvalStep *s)
 	memcpy(&es->steps[es->steps_len++], s, sizeof(ExprEvalStep));
 }
 
+/*
+ * Can the result of the expression be computed once and reused for the rest
+ * of the query's execution?
+ *
+ * That is the case for calls of non-volatile functions whose arguments are
+ * constants, external parameters, or such calls in turn: stable functions
+ * return the same result for the same arguments within a statement, and
+ * the values of external parameters don't change while the query runs.
+ * (Immutable functions of constants have been folded by the planner, but
+ * not those of parameters.)
+ *
+ * Cacheable calls within the expression that are not part of a bigger
+ * cacheable call are appended to *cacheable.  This looks at each node once,
+ * and at the volatility of each function only if its arguments qualify.
+ */
+static bool
+expr_find_cacheable(Node *node, List **cacheable)
+{
+	List	   *args;
+	Oid			funcid;
+	bool		retset;
+	bool		result;
+	int			ncacheable;
+	ListCell   *lc;
+
+	if (node == NULL)
+		return false;
+
+	switch (nodeTag(node))
+	{
+		case T_Const:
+			return true;
+		case T_Param:
+			return ((Param *) node)->paramkind == PARAM_EXTERN;
+		case T_RelabelType:
+			return expr_find_cacheable((Node *) ((RelabelType *) node)->arg,
+									   cacheable);
+		case T_FuncExpr:
+			args = ((FuncExpr *) node)->args;
+			funcid = ((FuncExpr *) node)->funcid;
+			retset = ((FuncExpr *) node)->funcretset;
+			break;
+		case T_OpExpr:
+			set_opfuncid((OpExpr *) node);
+			args = ((OpExpr *) node)->args;
+			funcid = ((OpExpr *) node)->opfuncid;
+			retset = ((OpExpr *) node)->opretset;
+			break;
+		default:
+			/* not cacheable itself, but look for cacheable calls below */
+			(void) expression_tree_walker(node, expr_find_cacheable_walker,
+										  (void *) cacheable);
+			return false;
+	}
+
+	ncacheable = list_length(*cacheable);
+	result = !retset;
+	foreach(lc, args)
+	{
+		if (!expr_find_cacheable(lfirst(lc), cacheable))
+			result = false;
+	}
+	if (result)
+		result = func_volatile(funcid) != PROVOLATILE_VOLATILE;
+
+	/* if so, this call replaces the cacheable calls among its arguments */
+	if (result)
+		*cacheable = lappend(list_truncate(*cacheable, ncacheable), node);
+
+	return result;
+}
+
+static bool
+expr_find_cacheable_walker(Node *node, void *context)
+{
+	(void) expr_find_cacheable(node, (List **) context);
+	return false;
+}
+
+/*
+ * If the result of the function call "node" can be cached, push a step that
+ * returns the cached result after it has been computed once, jumping over
+ * the steps computing it, and return its index.  Otherwise return -1.
+ * Either way, the caller then pushes the steps of the call and passes the
+ * result to ExecFinishCachedExpr().
+ *
+ * Only the outermost cacheable call is cached; the calls within it are only
+ * evaluated when it is.  So when we get to a call that is not within one we
+ * have already looked at, we find all the outermost cacheable calls within
+ * it at once, and remember them in the ExprState until we are done with it.
+ *
+ * Caching is only done for expressions of plan nodes, since other
+ * ExprStates, like those of PL/pgSQL's simple expressions, may be evaluated
+ * with different parameter values.
+ */
+static int
+ExecInitCachedExpr(Expr *node, ExprState *state, Datum *resv, bool *resnull)
+{
+	ExprEvalStep scratch = {0};
+	CachedExprResult *cache;
+
+	if (state->parent == NULL)
+		return -1;
+
+	if (state->cacheable_root == NULL)
+	{
+		List	   *cacheable = NIL;
+
+		(void) expr_find_cacheable((Node *) node, &cacheable);
+		state->cacheable_root = node;
+		state->cacheable_exprs = cacheable;
+	}
+
+	if (!list_member_ptr(state->cacheable_exprs, node))
+		return -1;
+
+	cache = palloc0(sizeof(CachedExprResult));
+	get_typlenbyval(exprType((Node *) node), &cache->typlen,
+					&cache->typbyval);
+
+	scratch.opcode = EEOP_CACHEDEXPR_CHECK;
+	scratch.resvalue = resv;
+	scratch.resnull = resnull;
+	scratch.d.cachedexpr.cache = cache;
+	scratch.d.cachedexpr.jumpdone = -1; /* adjust later */
+	ExprEvalPushStep(state, &scratch);
+
+	return state->steps_len - 1;
+}
+
+/*
+ * Finish caching of the call "node" started by ExecInitCachedExpr(), after
+ * the steps computing it have been pushed.
+ */
+static void
+ExecFinishCachedExpr(Expr *node, ExprState *state, int checkstep)
+{
+	ExprEvalStep *check;
+	ExprEvalStep scratch = {0};
+
+	if (state->cacheable_root == node)
+	{
+		list_free(state->cacheable_exprs);
+		state->cacheable_root = NULL;
+		state->cacheable_exprs = NIL;
+	}
+
+	if (checkstep < 0)
+		return;
+
+	check = &state->steps[checkstep];
+	Assert(check->opcode == EEOP_CACHEDEXPR_CHECK);
+
+	scratch.opcode = EEOP_CACHEDEXPR_STORE;
+	scratch.resvalue = check->resvalue;
+	scratch.resnull = check->resnull;
+	scratch.d.cachedexpr.cache = check->d.cachedexpr.cache;
+	scratch.d.cachedexpr.jumpdone = -1;
+	ExprEvalPushStep(state, &scratch);
+
+	/* ExprEvalPushStep may have moved the steps */
+	state->steps[checkstep].d.cachedexpr.jumpdone = state->steps_len;
+}
+
 /*
  * Perform setup necessary for the evaluation of a function-like expression,
  * appending argument evaluation steps to the steps list in *state, and
@@ -62,6 +62,7 @@
 #include "executor/execExpr.h"
 #include "executor/nodeSubplan.h"
 #include "funcapi.h"
+#include "jit/jit.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "parser/parsetree.h"
@@ -73,6 +74,7 @@
 #include "utils/expandedrecord.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/resowner.h"
 #include "utils/timestamp.h"
 #include "utils/typcache.h"
 #include "utils/xml.h"
@@ -139,6 +141,8 @@ static ExprEvalOpLookup reverse_dispatch_table[EEOP_LAST];
 
 
 static Datum ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnull);
+static Datum ExecInterpExprDeferredJit(ExprState *state, ExprContext *econtext,
+									   bool *isnull);
 static void ExecInitInterpreter(void);
 
 /* support functions */
@@ -378,6 +382,58 @@ ExecReadyInterpretedExpr(ExprState *state)
 	state->evalfunc_private = (void *) ExecInterpExpr;
 }
 
+/*
+ * Prepare ExprState for interpreted execution, to be JIT compiled once it
+ * has been evaluated jit_defer_evaluations times.
+ */
+void
+ExecReadyDeferredJitExpr(ExprState *state)
+{
+	ExecReadyInterpretedExpr(state);
+
+	/* the fast-path evalfuncs are cheap enough as they are */
+	if (state->evalfunc_private != (void *) ExecInterpExpr)
+		return;
+
+	state->jit_countdown = jit_defer_evaluations;
+	state->jit_resowner = CurrentResourceOwner;
+	state->evalfunc_private = (void *) ExecInterpExprDeferredJit;
+}
+
+/*
+ * Interpret the expression until it has been evaluated often enough, then
+ * JIT compile it and switch to the compiled code.
+ *
+ * The steps are not changed by being interpreted, so they can be compiled at
+ * any time.  We compile in the memory context and resource owner the code
+ * would have been compiled in up front, so that it lives exactly as long.
+ */
+static Datum
+ExecInterpExprDeferredJit(ExprState *state, ExprContext *econtext, bool *isnull)
+{
+	if (--state->jit_countdown <= 0)
+	{
+		MemoryContext oldcontext;
+		ResourceOwner oldowner;
+		bool		compiled;
+
+		oldcontext = MemoryContextSwitchTo(state->parent->state->es_query_cxt);
+		oldowner = CurrentResourceOwner;
+		CurrentResourceOwner = state->jit_resowner;
+		compiled = jit_compile_expr(state);
+		CurrentResourceOwner = oldowner;
+		MemoryContextSwitchTo(oldcontext);
+
+		if (compiled)
+			return state->evalfunc(state, econtext, isnull);
+
+		/* keep interpreting, without counting */
+		state->evalfunc = ExecInterpExpr;
+	}
+
+	return ExecInterpExpr(state, econtext, isnull);
+}
+
 
 /*
  * Evaluate expression identified by "state" in the execution context
@@ -479,6 +535,8 @@ ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnull)
 		&&CASE_EEOP_GROUPING_FUNC,
 		&&CASE_EEOP_WINDOW_FUNC,
 		&&CASE_EEOP_SUBPLAN,
+		&&CASE_EEOP_CACHEDEXPR_CHECK,
+		&&CASE_EEOP_CACHEDEXPR_STORE,
 		&&CASE_EEOP_AGG_STRICT_DESERIALIZE,
 		&&CASE_EEOP_AGG_DESERIALIZE,
 		&&CASE_EEOP_AGG_STRICT_INPUT_CHECK_ARGS,
@@ -1568,6 +1626,21 @@ ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnull)
 			EEO_NEXT();
 		}
 
+		EEO_CASE(EEOP_CACHEDEXPR_CHECK)
+		{
+			if (ExecEvalCachedExprCheck(state, op, econtext))
+				EEO_JUMP(op->d.cachedexpr.jumpdone);
+
+			EEO_NEXT();
+		}
+
+		EEO_CASE(EEOP_CACHEDEXPR_STORE)
+		{
+			ExecEvalCachedExprStore(state, op, econtext);
+
+			EEO_NEXT();
+		}
+
 		/* evaluate a strict aggregate deserialization function */
 		EEO_CASE(EEOP_AGG_STRICT_DESERIALIZE)
 		{
@@ -3971,6 +4044,73 @@ ExecEvalSubPlan(ExprState *state, ExprEvalStep *op, ExprContext *econtext)
 	*op->resvalue = ExecSubPlan(sstate, econtext, op->resnull);
 }
 
+/*
+ * Return the cached result of an expression, if it has been computed.
+ *
+ * Returns true, after storing the result, if the steps computing it can be
+ * skipped.
+ */
+bool
+ExecEvalCachedExprCheck(ExprState *state, ExprEvalStep *op,
+						ExprContext *econtext)
+{
+	CachedExprResult *cache = op->d.cachedexpr.cache;
+
+	if (!cache->valid)
+		return false;
+
+	*op->resvalue = cache->value;
+	*op->resnull = cache->isnull;
+	return true;
+}
+
+/*
+ * Forget a cached result, when the plan node is rescanned.
+ */
+static void
+ShutdownCachedExpr(Datum arg)
+{
+	CachedExprResult *cache = (CachedExprResult *) DatumGetPointer(arg);
+
+	if (!cache->isnull && !cache->typbyval)
+		pfree(DatumGetPointer(cache->value));
+	cache->valid = false;
+}
+
+/*
+ * Cache the result of an expression just computed by the preceding steps.
+ *
+ * The value is copied into the per-query memory context, since the result
+ * normally lives in per-tuple memory.  It is kept until the expression
+ * context is shut down, which happens when the plan node is rescanned, so
+ * each rescan computes the result afresh.
+ */
+void
+ExecEvalCachedExprStore(ExprState *state, ExprEvalStep *op,
+						ExprContext *econtext)
+{
+	CachedExprResult *cache = op->d.cachedexpr.cache;
+
+	cache->isnull = *op->resnull;
+	if (cache->isnull)
+		cache->value = (Datum) 0;
+	else
+	{
+		MemoryContext oldcontext;
+
+		oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_query_memory);
+		cache->value = datumCopy(*op->resvalue, cache->typbyval,
+								 cache->typlen);
+		MemoryContextSwitchTo(oldcontext);
+	}
+	cache->valid = true;
+	RegisterExprContextCallback(econtext, ShutdownCachedExpr,
+								PointerGetDatum(cache));
+
+	/* return the cached copy, like all later evaluations will */
+	*op->resvalue = cache->value;
+}
+
 /*
  * Evaluate a wholerow Var expression.
  *
@@ -106,6 +106,7 @@
  */
 #include "postgres.h"
 
+#include "access/amapi.h"
 #include "access/genam.h"
 #include "access/relscan.h"
 #include "access/tableam.h"
@@ -262,7 +263,7 @@ ExecCloseIndices(ResultRelInfo *resultRelInfo)
  *		When 'update' is true, executor is performing an UPDATE
  *		that could not use an optimization like heapam's HOT (in
  *		more general terms a call to table_tuple_update() took
- *		place and set 'update_indexes' to true).  Receiving this
+ *		place and set 'update_indexes' to TU_All).  Receiving this
  *		hint makes us consider if we should pass down the
  *		'indexUnchanged' hint in turn.  That's something that we
  *		figure out for each index_insert() call iff 'update' is
@@ -278,6 +279,11 @@ ExecCloseIndices(ResultRelInfo *resultRelInfo)
  *
  *		If 'arbiterIndexes' is nonempty, noDupErr applies only to
  *		those indexes.  NIL means noDupErr applies to all indexes.
+ *
+ *		If 'onlySummarizing' is true, the tuple is the new version of a
+ *		HOT update that changed columns of summarizing indexes only
+ *		(table_tuple_update() set 'update_indexes' to TU_Summarizing), and
+ *		only the summarizing indexes are inserted into.
  * ----------------------------------------------------------------
  */
 List *
@@ -287,7 +293,8 @@ ExecInsertIndexTuples(ResultRelInfo *resultRelInfo,
 					  bool update,
 					  bool noDupErr,
 					  bool *specConflict,
-					  List *arbiterIndexes)
+					  List *arbiterIndexes,
+					  bool onlySummarizing)
 {
 	ItemPointer tupleid = &slot->tts_tid;
 	List	   *result = NIL;
@@ -343,6 +350,13 @@ ExecInsertIndexTuples(ResultRelInfo *resultRelInfo,
 		if (!indexInfo->ii_ReadyForInserts)
 			continue;
 
+		/*
+		 * Skip processing of non-summarizing indexes if we only update
+		 * summarizing indexes
+		 */
+		if (onlySummarizing && !indexRelation->rd_indam->amsummarizing)
+			continue;
+
 		/* Check for partial index */
 		if (indexInfo->ii_Predicate != NIL)
 		{
@@ -822,6 +822,8 @@ ExecInitParallelPlan(PlanState *planstate, EState *estate,
 		pei->area = dsa_create_in_place(area_space, dsa_minsize,
 										LWTRANCHE_PARALLEL_QUERY_DSA,
 										pcxt->seg);
+		/* The area goes away with the DSM segment, so caching is safe. */
+		dsa_enable_cache(pei->area);
 
 		/*
 		 * Serialize parameters, if any, using DSA storage.  We don't dare use
@@ -1426,6 +1428,7 @@ ParallelQueryMain(dsm_segment *seg, shm_toc *toc)
 	/* Attach to the dynamic shared memory area. */
 	area_space = shm_toc_lookup(toc, PARALLEL_KEY_DSA, false);
 	area = dsa_attach_in_place(area_space, seg);
+	dsa_enable_cache(area);
 
 	/* Start up the executor */
 	queryDesc->plannedstmt->jitFlags = fpes->jit_flags;
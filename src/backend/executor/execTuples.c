@@ -63,6 +63,7 @@
 #include "catalog/pg_type.h"
 #include "funcapi.h"
 #include "nodes/nodeFuncs.h"
+#include "port/pg_bitutils.h"
 #include "storage/bufmgr.h"
 #include "utils/builtins.h"
 #include "utils/expandeddatum.h"
@@ -907,6 +908,25 @@ tts_buffer_heap_store_tuple(TupleTableSlot *slot, HeapTuple tuple,
 	}
 }
 
+/*
+ * Return the number of the first attribute below natts that is null in the
+ * tuple's null bitmap "bp", or natts if there is none.  This looks at the
+ * bitmap a byte at a time instead of one bit per attribute.
+ */
+static inline int
+heap_first_null_attr(bits8 *bp, int natts)
+{
+	int			nbytes = (natts + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+
+	for (int i = 0; i < nbytes; i++)
+	{
+		if (bp[i] != 0xFF)
+			return Min(i * BITS_PER_BYTE +
+					   pg_rightmost_one_pos32(~bp[i] & 0xFF), natts);
+	}
+	return natts;
+}
+
 /*
  * slot_deform_heap_tuple
  *		Given a TupleTableSlot, extract data from the slot's physical tuple
@@ -959,6 +979,30 @@ slot_deform_heap_tuple(TupleTableSlot *slot, HeapTuple tuple, uint32 *offp,
 
 	tp = (char *) tup + tup->t_hoff;
 
+	/*
+	 * Fast path for the leading fixed-width attributes: as long as no null
+	 * has been seen and their offsets are cached, each of them is a fetch at
+	 * a known offset, without any null check or alignment computation.
+	 * Their offsets are cached by the loop below the first time a tuple of
+	 * this descriptor is deformed.
+	 */
+	if (!slow)
+	{
+		int			firstnull = hasnulls ? heap_first_null_attr(bp, natts) : natts;
+
+		for (; attnum < firstnull; attnum++)
+		{
+			Form_pg_attribute thisatt = TupleDescAttr(tupleDesc, attnum);
+
+			if (thisatt->attlen <= 0 || thisatt->attcacheoff < 0)
+				break;
+
+			isnull[attnum] = false;
+			values[attnum] = fetchatt(thisatt, tp + thisatt->attcacheoff);
+			off = thisatt->attcacheoff + thisatt->attlen;
+		}
+	}
+
 	for (; attnum < natts; attnum++)
 	{
 		Form_pg_attribute thisatt = TupleDescAttr(tupleDesc, attnum);
@@ -101,8 +101,8 @@ BitmapHeapNext(BitmapHeapScanState *node)
 	 * For prefetching, we use *two* iterators, one for the pages we are
 	 * actually scanning and another that runs ahead of the first for
 	 * prefetching.  node->prefetch_pages tracks exactly how many pages ahead
-	 * the prefetch iterator is.  Also, node->prefetch_target tracks the
-	 * desired prefetch distance, which starts small and increases up to the
+	 * the prefetch iterator is.  Also, node->prefetch_ctl tracks the
+	 * desired prefetch distance, which starts small and is adjusted up to
 	 * node->prefetch_maximum.  This is to avoid doing a lot of prefetching in
 	 * a scan that stops after a few tuples because of a LIMIT.
 	 */
@@ -124,7 +124,7 @@ BitmapHeapNext(BitmapHeapScanState *node)
 			{
 				node->prefetch_iterator = tbm_begin_iterate(tbm);
 				node->prefetch_pages = 0;
-				node->prefetch_target = -1;
+				PrefetchControlRestart(&node->prefetch_ctl);
 			}
 #endif							/* USE_PREFETCH */
 		}
@@ -156,7 +156,8 @@ BitmapHeapNext(BitmapHeapScanState *node)
 #ifdef USE_PREFETCH
 			node->prefetch_head = 0;
 			node->prefetch_pages = 0;
-			node->prefetch_target = -1;
+			node->prefetch_exhausted = false;
+			PrefetchControlRestart(&node->prefetch_ctl);
 #endif
 
 			/* Allocate a private iterator and attach the shared state to it */
@@ -245,22 +246,7 @@ BitmapHeapNext(BitmapHeapScanState *node)
 			/* Adjust the prefetch target */
 			BitmapAdjustPrefetchTarget(node);
 		}
-		else
-		{
-			/*
-			 * Continuing in previously obtained page.
-			 */
 
-#ifdef USE_PREFETCH
-
-			/*
-			 * Try to prefetch at least a few pages even before we get to the
-			 * second page if we don't stop reading after the first tuple.
-			 */
-			if (node->prefetch_target < node->prefetch_maximum)
-				node->prefetch_target++;
-#endif							/* USE_PREFETCH */
-		}
 
 		/*
 		 * We issue prefetch requests *after* fetching the current page to try
@@ -351,7 +337,10 @@ BitmapAdjustPrefetchIterator(BitmapHeapScanState *node,
 #ifdef USE_PREFETCH
 	TBMIterator *prefetch_iterator = node->prefetch_iterator;
 
-	/* NEON: we are not using prefetch iterator for parallel plan so no need to adjust it */
+	/*
+	 * A parallel scan takes its pages from its own queue of prefetched
+	 * pages, see BitmapPrefetch, so there is no iterator to adjust.
+	 */
 	if (node->pstate != NULL)
 		return;
 
@@ -374,34 +363,28 @@ BitmapAdjustPrefetchIterator(BitmapHeapScanState *node,
 /*
  * BitmapAdjustPrefetchTarget - Adjust the prefetch target
  *
- * Increase prefetch target if it's not yet at the max.  Note that
- * we will increase it to zero after fetching the very first
- * page/tuple, then to one after the second tuple is fetched, then
- * it doubles as later pages are fetched.
+ * Called for every page fetched; the prefetch controller starts with a
+ * target of zero, so that nothing is prefetched before the first page has
+ * been fetched, and then adapts it to how the scan consumes pages.
  */
 static inline void
 BitmapAdjustPrefetchTarget(BitmapHeapScanState *node)
 {
 #ifdef USE_PREFETCH
-	if (node->prefetch_target >= node->prefetch_maximum)
-		/* don't increase any further */ ;
-	else if (node->prefetch_target >= node->prefetch_maximum / 2)
-		node->prefetch_target = node->prefetch_maximum;
-	else if (node->prefetch_target > 0)
-		node->prefetch_target *= 2;
-	else
-		node->prefetch_target++;
+	PrefetchControlConsume(&node->prefetch_ctl);
 #endif							/* USE_PREFETCH */
 }
 
 /*
- * BitmapPrefetch - Prefetch, if prefetch_pages are behind prefetch_target
+ * BitmapPrefetch - Prefetch, if prefetch_pages are behind the prefetch target
  */
 static inline void
 BitmapPrefetch(BitmapHeapScanState *node, TableScanDesc scan)
 {
 #ifdef USE_PREFETCH
 	ParallelBitmapHeapState *pstate = node->pstate;
+	BlockNumber blocks[PREFETCH_BATCH_SIZE];
+	int			nblocks = 0;
 
 	if (pstate == NULL)
 	{
@@ -409,7 +392,7 @@ BitmapPrefetch(BitmapHeapScanState *node, TableScanDesc scan)
 
 		if (prefetch_iterator)
 		{
-			while (node->prefetch_pages < node->prefetch_target)
+			while (node->prefetch_pages < PrefetchControlTarget(&node->prefetch_ctl))
 			{
 				TBMIterateResult *tbmpre = tbm_iterate(prefetch_iterator);
 				bool		skip_fetch;
@@ -422,6 +405,7 @@ BitmapPrefetch(BitmapHeapScanState *node, TableScanDesc scan)
 					break;
 				}
 				node->prefetch_pages++;
+				PrefetchControlIssued(&node->prefetch_ctl, 1);
 
 				/*
 				 * If we expect not to have to actually read this heap page,
@@ -441,52 +425,70 @@ BitmapPrefetch(BitmapHeapScanState *node, TableScanDesc scan)
 											 &node->pvmbuffer));
 
 				if (!skip_fetch)
-					PrefetchBuffer(scan->rs_rd, MAIN_FORKNUM, tbmpre->blockno);
+				{
+					blocks[nblocks++] = tbmpre->blockno;
+					if (nblocks == PREFETCH_BATCH_SIZE)
+					{
+						PrefetchBuffers(scan->rs_rd, MAIN_FORKNUM, blocks, nblocks);
+						nblocks = 0;
+					}
+				}
 			}
 		}
 	}
-	else
+	else if (!node->prefetch_exhausted)
 	{
-		while (1)
-		{
-			TBMIterateResult *tbmpre;
-			bool		do_prefetch = false;
-			bool		skip_fetch;
+		int			target = PrefetchControlTarget(&node->prefetch_ctl);
 
-			if (node->prefetch_pages < node->prefetch_target)
+		/*
+		 * Each worker prefetches only pages that it claims for itself from
+		 * the shared iterator, as Neon prefetch requests can only be used by
+		 * the backend that issued them.  The claimed pages are queued in
+		 * prefetch_requests, from where BitmapHeapNext takes them.  Pages are
+		 * claimed in chunks once the queue has drained to half the target:
+		 * that takes the shared iterator's lock once per chunk rather than
+		 * once per page, and gives each worker runs of adjacent pages.
+		 */
+		if (node->prefetch_pages < target &&
+			node->prefetch_pages <= target / 2)
+		{
+			TBMIterateResult *claimed[PREFETCH_BATCH_SIZE];
+			int			nclaim = Min(target - node->prefetch_pages,
+									 PREFETCH_BATCH_SIZE);
+			int			n;
+
+			Assert(target <= MAX_IO_CONCURRENCY);
+			for (int i = 0; i < nclaim; i++)
+				claimed[i] = (TBMIterateResult *)
+					&node->prefetch_requests[(node->prefetch_head + node->prefetch_pages + i) % MAX_IO_CONCURRENCY];
+
+			n = tbm_shared_iterate_batch(node->shared_tbmiterator,
+										 claimed, nclaim);
+			if (n < nclaim)
+				node->prefetch_exhausted = true;
+			node->prefetch_pages += n;
+			PrefetchControlIssued(&node->prefetch_ctl, n);
+
+			for (int i = 0; i < n; i++)
 			{
-				Assert(node->prefetch_pages < MAX_IO_CONCURRENCY);
-				do_prefetch = true;
-			}
-
-			if (!do_prefetch)
-				return;
+				TBMIterateResult *tbmpre = claimed[i];
+
+				/* As above, skip prefetch if we expect not to need page */
+				if (node->can_skip_fetch &&
+					!tbmpre->recheck &&
+					VM_ALL_VISIBLE(node->ss.ss_currentRelation,
+								   tbmpre->blockno,
+								   &node->pvmbuffer))
+					continue;
 
-			tbmpre = tbm_shared_iterate(node->shared_tbmiterator);
-			if (tbmpre != NULL)
-			{
-				memcpy(&node->prefetch_requests[(node->prefetch_head + node->prefetch_pages) % MAX_IO_CONCURRENCY],
-					   tbmpre,
-					   offsetof(TBMIterateResult, offsets) + sizeof(OffsetNumber)*Max(tbmpre->ntuples, 0));
-				node->prefetch_pages += 1;
-			}
-			else
-			{
-				/* No more pages to prefetch */
-				break;
+				blocks[nblocks++] = tbmpre->blockno;
 			}
-
-			/* As above, skip prefetch if we expect not to need page */
-			skip_fetch = (node->can_skip_fetch &&
-						  !tbmpre->recheck &&
-						  VM_ALL_VISIBLE(node->ss.ss_currentRelation,
-										 tbmpre->blockno,
-										 &node->pvmbuffer));
-
-			if (!skip_fetch)
-				PrefetchBuffer(scan->rs_rd, MAIN_FORKNUM, tbmpre->blockno);
 		}
 	}
+
+	/* issue whatever is left over as one batch */
+	if (nblocks > 0)
+		PrefetchBuffers(scan->rs_rd, MAIN_FORKNUM, blocks, nblocks);
 #endif							/* USE_PREFETCH */
 }
 
@@ -658,7 +660,7 @@ ExecInitBitmapHeapScan(BitmapHeapScan *node, EState *estate, int eflags)
 	scanstate->lossy_pages = 0;
 	scanstate->prefetch_iterator = NULL;
 	scanstate->prefetch_pages = 0;
-	scanstate->prefetch_target = 0;
+	scanstate->prefetch_exhausted = false;
 	scanstate->pscan_len = 0;
 	scanstate->initialized = false;
 	scanstate->shared_tbmiterator = NULL;
@@ -717,6 +719,7 @@ ExecInitBitmapHeapScan(BitmapHeapScan *node, EState *estate, int eflags)
 	 * otherwise the current value of the effective_io_concurrency GUC.
 	 */
 	scanstate->prefetch_maximum = get_tablespace_io_concurrency(currentRelation->rd_rel->reltablespace);
+	PrefetchControlInit(&scanstate->prefetch_ctl, scanstate->prefetch_maximum, 0);
 
 	scanstate->ss.ss_currentRelation = currentRelation;
 
@@ -1244,8 +1244,11 @@ ExecHashJoinSaveTuple(MinimalTuple tuple, uint32 hashvalue,
 
 	if (file == NULL)
 	{
-		/* First write to this batch file, so open it. */
-		file = BufFileCreateTemp(false);
+		/*
+		 * First write to this batch file, so open it.  Batch files are
+		 * written and read back sequentially, so they can be compressed.
+		 */
+		file = BufFileCreateCompressTemp(false);
 		*fileptr = file;
 	}
 
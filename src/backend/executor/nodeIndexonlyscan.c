@@ -101,7 +101,9 @@ IndexOnlyNext(IndexOnlyScanState *node)
 
 		/* Set it up for index-only scan */
 		node->ioss_ScanDesc->xs_want_itup = true;
-		node->ioss_VMBuffer = InvalidBuffer;
+		node->ioss_ScanDesc->xs_skip_scan =
+			((IndexOnlyScan *) node->ss.ps.plan)->indexskipscan;
+		visibilitymap_cache_init(&node->ioss_VMBuffers);
 
 		/*
 		 * If no run-time keys to calculate or they are ready, go ahead and
@@ -157,10 +159,14 @@ IndexOnlyNext(IndexOnlyScanState *node)
 		 *
 		 * It's worth going through this complexity to avoid needing to lock
 		 * the VM buffer, which could cause significant contention.
+		 *
+		 * The TIDs need not be in heap order, so keep a few VM pages pinned
+		 * so that jumping between far-apart heap blocks doesn't make us
+		 * unpin and re-read a VM page every time.
 		 */
-		if (!VM_ALL_VISIBLE(scandesc->heapRelation,
-							ItemPointerGetBlockNumber(tid),
-							&node->ioss_VMBuffer))
+		if (!VM_ALL_VISIBLE_CACHED(scandesc->heapRelation,
+								   ItemPointerGetBlockNumber(tid),
+								   &node->ioss_VMBuffers))
 		{
 			/*
 			 * Rats, we have to visit the heap to check visibility.
@@ -375,12 +381,8 @@ ExecEndIndexOnlyScan(IndexOnlyScanState *node)
 	indexRelationDesc = node->ioss_RelationDesc;
 	indexScanDesc = node->ioss_ScanDesc;
 
-	/* Release VM buffer pin, if any. */
-	if (node->ioss_VMBuffer != InvalidBuffer)
-	{
-		ReleaseBuffer(node->ioss_VMBuffer);
-		node->ioss_VMBuffer = InvalidBuffer;
-	}
+	/* Release VM buffer pins, if any. */
+	visibilitymap_cache_release(&node->ioss_VMBuffers);
 
 	/*
 	 * Free the exprcontext(s) ... now dead code, see ExecFreeExprContext
@@ -678,7 +680,7 @@ ExecIndexOnlyScanInitializeDSM(IndexOnlyScanState *node,
 								 node->ioss_NumOrderByKeys,
 								 piscan);
 	node->ioss_ScanDesc->xs_want_itup = true;
-	node->ioss_VMBuffer = InvalidBuffer;
+	visibilitymap_cache_init(&node->ioss_VMBuffers);
 
 	/*
 	 * If no run-time keys to calculate or they are ready, go ahead and pass
@@ -22,6 +22,7 @@
  *		ExecEndIndexScan		releases all storage.
  *		ExecIndexMarkPos		marks scan position.
  *		ExecIndexRestrPos		restores scan position.
+ *		ExecIndexScanPrefetch	prefetches pages for an upcoming rescan.
  *		ExecIndexScanEstimate	estimates DSM space needed for parallel index scan
  *		ExecIndexScanInitializeDSM initialize DSM for parallel indexscan
  *		ExecIndexScanReInitializeDSM reinitialize DSM for fresh scan
@@ -116,6 +117,8 @@ IndexNext(IndexScanState *node)
 								   node->iss_NumOrderByKeys);
 
 		node->iss_ScanDesc = scandesc;
+		scandesc->xs_skip_scan =
+			((IndexScan *) node->ss.ps.plan)->indexskipscan;
 
 		/*
 		 * If no run-time keys to calculate or they are ready, go ahead and
@@ -211,6 +214,8 @@ IndexNextWithReorder(IndexScanState *node)
 								   node->iss_NumOrderByKeys);
 
 		node->iss_ScanDesc = scandesc;
+		scandesc->xs_skip_scan =
+			((IndexScan *) node->ss.ps.plan)->indexskipscan;
 
 		/*
 		 * If no run-time keys to calculate or they are ready, go ahead and
@@ -593,6 +598,109 @@ ExecReScanIndexScan(IndexScanState *node)
 	ExecScanReScan(&node->ss);
 }
 
+/*
+ * Strip a no-op relabeling from a runtime key expression.
+ */
+static Expr *
+IndexRuntimeKeyExpr(IndexRuntimeKeyInfo *runtimeKey)
+{
+	Expr	   *expr = runtimeKey->key_expr->expr;
+
+	while (IsA(expr, RelabelType))
+		expr = ((RelabelType *) expr)->arg;
+	return expr;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecIndexScanSupportsPrefetch
+ *
+ *		Can ExecIndexScanPrefetch be used for this scan?
+ *
+ *		Prefetching evaluates the runtime keys for parameter values
+ *		the scan may never be run with, so they must be plain Vars,
+ *		Params or Consts, which can neither fail nor have side effects.
+ *		Anything else, like 10 / a.x, could raise an error the plan
+ *		itself never would, e.g. under a LIMIT.
+ * ----------------------------------------------------------------
+ */
+bool
+ExecIndexScanSupportsPrefetch(IndexScanState *node)
+{
+	if (node->iss_RelationDesc == NULL ||
+		node->iss_RelationDesc->rd_indam->amprefetch == NULL ||
+		node->iss_NumRuntimeKeys == 0 ||
+		node->iss_NumOrderByKeys != 0)
+		return false;
+
+	for (int j = 0; j < node->iss_NumRuntimeKeys; j++)
+	{
+		Expr	   *expr = IndexRuntimeKeyExpr(&node->iss_RuntimeKeys[j]);
+
+		if (!IsA(expr, Var) && !IsA(expr, Param) && !IsA(expr, Const))
+			return false;
+	}
+
+	return true;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecIndexScanPrefetch
+ *
+ *		Prefetch the pages that a rescan with the current parameter
+ *		values will need.  This is used by nested loop joins to look
+ *		ahead over their next outer tuples, see nodeNestloop.c.
+ *
+ *		The runtime keys are evaluated into a private copy of the scan
+ *		keys, so the state of the scan itself is not affected.  The copy
+ *		lives in the runtime key context, which the next rescan resets.
+ * ----------------------------------------------------------------
+ */
+void
+ExecIndexScanPrefetch(IndexScanState *node, int nheappages)
+{
+	ExprContext *econtext = node->iss_RuntimeContext;
+	ScanKey		keys;
+	MemoryContext oldContext;
+
+	Assert(ExecIndexScanSupportsPrefetch(node));
+
+	/*
+	 * Evaluating the Param of an initplan that hasn't been run yet would run
+	 * it, which only the scan itself may do.
+	 */
+	for (int j = 0; j < node->iss_NumRuntimeKeys; j++)
+	{
+		Expr	   *expr = IndexRuntimeKeyExpr(&node->iss_RuntimeKeys[j]);
+
+		if (IsA(expr, Param) &&
+			((Param *) expr)->paramkind == PARAM_EXEC &&
+			econtext->ecxt_param_exec_vals[((Param *) expr)->paramid].execPlan != NULL)
+			return;
+	}
+
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+	keys = (ScanKey) palloc(node->iss_NumScanKeys * sizeof(ScanKeyData));
+	memcpy(keys, node->iss_ScanKeys, node->iss_NumScanKeys * sizeof(ScanKeyData));
+	MemoryContextSwitchTo(oldContext);
+
+	for (int j = 0; j < node->iss_NumRuntimeKeys; j++)
+	{
+		IndexRuntimeKeyInfo runtimeKey = node->iss_RuntimeKeys[j];
+
+		/* redirect the key to our copy */
+		runtimeKey.scan_key = keys + (runtimeKey.scan_key - node->iss_ScanKeys);
+		ExecIndexEvalRuntimeKeys(econtext, &runtimeKey, 1);
+
+		/* a NULL key means the scan will return nothing */
+		if (runtimeKey.scan_key->sk_flags & SK_ISNULL)
+			return;
+	}
+
+	index_prefetch(node->iss_RelationDesc, node->ss.ss_currentRelation,
+				   keys, node->iss_NumScanKeys,
+				   node->ss.ps.state->es_snapshot, nheappages);
+}
+
 
 /*
  * ExecIndexEvalRuntimeKeys
@@ -64,6 +64,21 @@
 #include "utils/rel.h"
 
 
+/*
+ * Number of rows an INSERT into a table buffers before writing them out with
+ * table_multi_insert().  heap_multi_insert() fills a whole page per WAL
+ * record, so a hundred or so rows of typical width already get most of the
+ * benefit, while keeping the memory for the buffered copies bounded.
+ */
+#define MAX_BATCHED_INSERT_TUPLES	100
+
+/*
+ * Also write the buffered rows out once they add up to this many bytes, so
+ * that a batch of very wide rows doesn't hold on to a lot of memory.  This
+ * is the same limit COPY FROM uses.
+ */
+#define MAX_BATCHED_INSERT_BYTES	65535
+
 typedef struct MTTargetRelLookup
 {
 	Oid			relationOid;	/* hash key, must be first */
@@ -110,7 +125,7 @@ typedef struct ModifyTableContext
 typedef struct UpdateContext
 {
 	bool		updated;		/* did UPDATE actually occur? */
-	bool		updateIndexes;	/* index update required? */
+	TU_UpdateIndexes updateIndexes; /* Which index updates are required? */
 	bool		crossPartUpdate;	/* was it a cross-partition update? */
 
 	/*
@@ -121,6 +136,14 @@ typedef struct UpdateContext
 } UpdateContext;
 
 
+static bool ExecInsertCanBatch(ModifyTableState *mtstate,
+							   ResultRelInfo *resultRelInfo);
+static void ExecBufferInsert(ModifyTableState *mtstate,
+							 ResultRelInfo *resultRelInfo,
+							 TupleTableSlot *slot,
+							 TupleTableSlot *planSlot,
+							 EState *estate,
+							 bool canSetTag);
 static void ExecBatchInsert(ModifyTableState *mtstate,
 							ResultRelInfo *resultRelInfo,
 							TupleTableSlot **slots,
@@ -747,7 +770,6 @@ ExecInsert(ModifyTableContext *context,
 	ModifyTable *node = (ModifyTable *) mtstate->ps.plan;
 	OnConflictAction onconflict = node->onConflictAction;
 	PartitionTupleRouting *proute = mtstate->mt_partition_tuple_routing;
-	MemoryContext oldContext;
 
 	/*
 	 * If the input result relation is a partitioned table, find the leaf
@@ -824,88 +846,8 @@ ExecInsert(ModifyTableContext *context,
 		 */
 		if (resultRelInfo->ri_BatchSize > 1)
 		{
-			bool		flushed = false;
-
-			/*
-			 * When we've reached the desired batch size, perform the
-			 * insertion.
-			 */
-			if (resultRelInfo->ri_NumSlots == resultRelInfo->ri_BatchSize)
-			{
-				ExecBatchInsert(mtstate, resultRelInfo,
-								resultRelInfo->ri_Slots,
-								resultRelInfo->ri_PlanSlots,
-								resultRelInfo->ri_NumSlots,
-								estate, canSetTag);
-				flushed = true;
-			}
-
-			oldContext = MemoryContextSwitchTo(estate->es_query_cxt);
-
-			if (resultRelInfo->ri_Slots == NULL)
-			{
-				resultRelInfo->ri_Slots = palloc(sizeof(TupleTableSlot *) *
-												 resultRelInfo->ri_BatchSize);
-				resultRelInfo->ri_PlanSlots = palloc(sizeof(TupleTableSlot *) *
-													 resultRelInfo->ri_BatchSize);
-			}
-
-			/*
-			 * Initialize the batch slots. We don't know how many slots will
-			 * be needed, so we initialize them as the batch grows, and we
-			 * keep them across batches. To mitigate an inefficiency in how
-			 * resource owner handles objects with many references (as with
-			 * many slots all referencing the same tuple descriptor) we copy
-			 * the appropriate tuple descriptor for each slot.
-			 */
-			if (resultRelInfo->ri_NumSlots >= resultRelInfo->ri_NumSlotsInitialized)
-			{
-				TupleDesc	tdesc = CreateTupleDescCopy(slot->tts_tupleDescriptor);
-				TupleDesc	plan_tdesc =
-				CreateTupleDescCopy(planSlot->tts_tupleDescriptor);
-
-				resultRelInfo->ri_Slots[resultRelInfo->ri_NumSlots] =
-					MakeSingleTupleTableSlot(tdesc, slot->tts_ops);
-
-				resultRelInfo->ri_PlanSlots[resultRelInfo->ri_NumSlots] =
-					MakeSingleTupleTableSlot(plan_tdesc, planSlot->tts_ops);
-
-				/* remember how many batch slots we initialized */
-				resultRelInfo->ri_NumSlotsInitialized++;
-			}
-
-			ExecCopySlot(resultRelInfo->ri_Slots[resultRelInfo->ri_NumSlots],
-						 slot);
-
-			ExecCopySlot(resultRelInfo->ri_PlanSlots[resultRelInfo->ri_NumSlots],
-						 planSlot);
-
-			/*
-			 * If these are the first tuples stored in the buffers, add the
-			 * target rel and the mtstate to the
-			 * es_insert_pending_result_relations and
-			 * es_insert_pending_modifytables lists respectively, execpt in
-			 * the case where flushing was done above, in which case they
-			 * would already have been added to the lists, so no need to do
-			 * this.
-			 */
-			if (resultRelInfo->ri_NumSlots == 0 && !flushed)
-			{
-				Assert(!list_member_ptr(estate->es_insert_pending_result_relations,
-										resultRelInfo));
-				estate->es_insert_pending_result_relations =
-					lappend(estate->es_insert_pending_result_relations,
-							resultRelInfo);
-				estate->es_insert_pending_modifytables =
-					lappend(estate->es_insert_pending_modifytables, mtstate);
-			}
-			Assert(list_member_ptr(estate->es_insert_pending_result_relations,
-								   resultRelInfo));
-
-			resultRelInfo->ri_NumSlots++;
-
-			MemoryContextSwitchTo(oldContext);
-
+			ExecBufferInsert(mtstate, resultRelInfo, slot, planSlot,
+							 estate, canSetTag);
 			return NULL;
 		}
 
@@ -989,6 +931,19 @@ ExecInsert(ModifyTableContext *context,
 			  resultRelInfo->ri_TrigDesc->trig_insert_before_row)))
 			ExecPartitionCheck(resultRelInfo, slot, estate, true);
 
+		/*
+		 * If this INSERT qualified for batching (see ExecInsertCanBatch),
+		 * just remember the row; it is written out together with the rest
+		 * of its batch by ExecBatchInsert.
+		 */
+		if (resultRelInfo->ri_BatchSize > 1)
+		{
+			Assert(onconflict == ONCONFLICT_NONE);
+			ExecBufferInsert(mtstate, resultRelInfo, slot, planSlot,
+							 estate, canSetTag);
+			return NULL;
+		}
+
 		if (onconflict != ONCONFLICT_NONE && resultRelInfo->ri_NumIndices > 0)
 		{
 			/* Perform a speculative insertion. */
@@ -1079,7 +1034,8 @@ ExecInsert(ModifyTableContext *context,
 			recheckIndexes = ExecInsertIndexTuples(resultRelInfo,
 												   slot, estate, false, true,
 												   &specConflict,
-												   arbiterIndexes);
+												   arbiterIndexes,
+												   false);
 
 			/* adjust the tuple's state accordingly */
 			table_tuple_complete_speculative(resultRelationDesc, slot,
@@ -1118,7 +1074,8 @@ ExecInsert(ModifyTableContext *context,
 			if (resultRelInfo->ri_NumIndices > 0)
 				recheckIndexes = ExecInsertIndexTuples(resultRelInfo,
 													   slot, estate, false,
-													   false, NULL, NIL);
+													   false, NULL, NIL,
+													   false);
 		}
 	}
 
@@ -1184,12 +1141,183 @@ ExecInsert(ModifyTableContext *context,
 	return result;
 }
 
+/* ----------------------------------------------------------------
+ *		ExecInsertCanBatch
+ *
+ *		Can the rows of this INSERT into a table be buffered and written out
+ *		in batches with table_multi_insert()?
+ *
+ *		That is only the case if nothing can observe that a row has not been
+ *		inserted yet when the next one is processed: no row-level triggers
+ *		(which includes foreign keys and deferred uniqueness checks), no
+ *		transition tables, no RETURNING or ON CONFLICT, and no volatile
+ *		functions in the statement that could look at the table (which the
+ *		planner tells us through batchInsertOk).  Partitioned tables are
+ *		not handled; each row would have to be buffered for its partition.
+ * ----------------------------------------------------------------
+ */
+static bool
+ExecInsertCanBatch(ModifyTableState *mtstate, ResultRelInfo *resultRelInfo)
+{
+	ModifyTable *node = (ModifyTable *) mtstate->ps.plan;
+	Relation	rel = resultRelInfo->ri_RelationDesc;
+	TriggerDesc *trigdesc = resultRelInfo->ri_TrigDesc;
+
+	if (!node->batchInsertOk ||
+		node->onConflictAction != ONCONFLICT_NONE ||
+		node->returningLists != NIL)
+		return false;
+
+	if (rel->rd_rel->relkind != RELKIND_RELATION ||
+		resultRelInfo->ri_FdwRoutine != NULL ||
+		mtstate->mt_partition_tuple_routing != NULL ||
+		mtstate->mt_transition_capture != NULL)
+		return false;
+
+	if (trigdesc != NULL &&
+		(trigdesc->trig_insert_before_row ||
+		 trigdesc->trig_insert_after_row ||
+		 trigdesc->trig_insert_instead_row ||
+		 trigdesc->trig_insert_new_table))
+		return false;
+
+	return true;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecBufferInsert
+ *
+ *		Add a tuple to the batch of pending inserts for resultRelInfo,
+ *		first flushing the batch if it is full.  The tuple must already have
+ *		passed all the checks ExecInsert performs before the actual
+ *		insertion.
+ * ----------------------------------------------------------------
+ */
+static void
+ExecBufferInsert(ModifyTableState *mtstate,
+				 ResultRelInfo *resultRelInfo,
+				 TupleTableSlot *slot,
+				 TupleTableSlot *planSlot,
+				 EState *estate,
+				 bool canSetTag)
+{
+	bool		flushed = false;
+	MemoryContext oldContext;
+
+	/*
+	 * When we've reached the desired batch size, or buffered enough bytes of
+	 * rows for a table, perform the insertion.
+	 */
+	if (resultRelInfo->ri_NumSlots == resultRelInfo->ri_BatchSize ||
+		resultRelInfo->ri_BatchBytes >= MAX_BATCHED_INSERT_BYTES)
+	{
+		ExecBatchInsert(mtstate, resultRelInfo,
+						resultRelInfo->ri_Slots,
+						resultRelInfo->ri_PlanSlots,
+						resultRelInfo->ri_NumSlots,
+						estate, canSetTag);
+		flushed = true;
+	}
+
+	oldContext = MemoryContextSwitchTo(estate->es_query_cxt);
+
+	if (resultRelInfo->ri_Slots == NULL)
+	{
+		resultRelInfo->ri_Slots = palloc(sizeof(TupleTableSlot *) *
+										 resultRelInfo->ri_BatchSize);
+		if (resultRelInfo->ri_FdwRoutine)
+			resultRelInfo->ri_PlanSlots = palloc(sizeof(TupleTableSlot *) *
+												 resultRelInfo->ri_BatchSize);
+	}
+
+	/*
+	 * Initialize the batch slots. We don't know how many slots will be
+	 * needed, so we initialize them as the batch grows, and we keep them
+	 * across batches. To mitigate an inefficiency in how resource owner
+	 * handles objects with many references (as with many slots all
+	 * referencing the same tuple descriptor) we copy the appropriate tuple
+	 * descriptor for each slot.
+	 *
+	 * For a table, the buffered rows are handed to table_multi_insert(), so
+	 * use the table AM's own slot type for them.  There's no RETURNING in
+	 * that case, so the plan slots are only needed for foreign tables.
+	 */
+	if (resultRelInfo->ri_NumSlots >= resultRelInfo->ri_NumSlotsInitialized)
+	{
+		TupleDesc	tdesc = CreateTupleDescCopy(slot->tts_tupleDescriptor);
+
+		if (resultRelInfo->ri_FdwRoutine)
+		{
+			TupleDesc	plan_tdesc =
+			CreateTupleDescCopy(planSlot->tts_tupleDescriptor);
+
+			resultRelInfo->ri_Slots[resultRelInfo->ri_NumSlots] =
+				MakeSingleTupleTableSlot(tdesc, slot->tts_ops);
+
+			resultRelInfo->ri_PlanSlots[resultRelInfo->ri_NumSlots] =
+				MakeSingleTupleTableSlot(plan_tdesc, planSlot->tts_ops);
+		}
+		else
+			resultRelInfo->ri_Slots[resultRelInfo->ri_NumSlots] =
+				MakeSingleTupleTableSlot(tdesc,
+										 table_slot_callbacks(resultRelInfo->ri_RelationDesc));
+
+		/* remember how many batch slots we initialized */
+		resultRelInfo->ri_NumSlotsInitialized++;
+	}
+
+	ExecCopySlot(resultRelInfo->ri_Slots[resultRelInfo->ri_NumSlots],
+				 slot);
+
+	if (resultRelInfo->ri_FdwRoutine)
+		ExecCopySlot(resultRelInfo->ri_PlanSlots[resultRelInfo->ri_NumSlots],
+					 planSlot);
+	else
+	{
+		TupleTableSlot *batchslot;
+		bool		shouldFree;
+		HeapTuple	tuple;
+
+		/* the copy is materialized, so this is free for heap tuples */
+		batchslot = resultRelInfo->ri_Slots[resultRelInfo->ri_NumSlots];
+		tuple = ExecFetchSlotHeapTuple(batchslot, false, &shouldFree);
+		resultRelInfo->ri_BatchBytes += tuple->t_len;
+		if (shouldFree)
+			heap_freetuple(tuple);
+	}
+
+	/*
+	 * If these are the first tuples stored in the buffers, add the target rel
+	 * and the mtstate to the es_insert_pending_result_relations and
+	 * es_insert_pending_modifytables lists respectively, execpt in the case
+	 * where flushing was done above, in which case they would already have
+	 * been added to the lists, so no need to do this.
+	 */
+	if (resultRelInfo->ri_NumSlots == 0 && !flushed)
+	{
+		Assert(!list_member_ptr(estate->es_insert_pending_result_relations,
+								resultRelInfo));
+		estate->es_insert_pending_result_relations =
+			lappend(estate->es_insert_pending_result_relations,
+					resultRelInfo);
+		estate->es_insert_pending_modifytables =
+			lappend(estate->es_insert_pending_modifytables, mtstate);
+	}
+	Assert(list_member_ptr(estate->es_insert_pending_result_relations,
+						   resultRelInfo));
+
+	resultRelInfo->ri_NumSlots++;
+
+	MemoryContextSwitchTo(oldContext);
+}
+
 /* ----------------------------------------------------------------
  *		ExecBatchInsert
  *
  *		Insert multiple tuples in an efficient way.
  *		Currently, this handles inserting into a foreign table without
- *		RETURNING clause.
+ *		RETURNING clause, and into a table that has no row-level triggers
+ *		(see ExecInsertCanBatch).
  * ----------------------------------------------------------------
  */
 static void
@@ -1206,14 +1334,50 @@ ExecBatchInsert(ModifyTableState *mtstate,
 	TupleTableSlot *slot = NULL;
 	TupleTableSlot **rslots;
 
-	/*
-	 * insert into foreign table: let the FDW do it
-	 */
-	rslots = resultRelInfo->ri_FdwRoutine->ExecForeignBatchInsert(estate,
-																  resultRelInfo,
-																  slots,
-																  planSlots,
-																  &numInserted);
+	if (resultRelInfo->ri_FdwRoutine)
+	{
+		/*
+		 * insert into foreign table: let the FDW do it
+		 */
+		rslots = resultRelInfo->ri_FdwRoutine->ExecForeignBatchInsert(estate,
+																	  resultRelInfo,
+																	  slots,
+																	  planSlots,
+																	  &numInserted);
+	}
+	else
+	{
+		MemoryContext oldContext;
+
+		/*
+		 * insert into table: one table_multi_insert() call for the whole
+		 * batch, then the index entries tuple by tuple.  As in COPY FROM, do
+		 * this in the per-tuple context so that whatever the table AM and
+		 * the index AMs allocate is released right away.
+		 */
+		oldContext = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+		table_multi_insert(resultRelInfo->ri_RelationDesc, slots, numSlots,
+						   estate->es_output_cid, 0, NULL);
+
+		if (resultRelInfo->ri_NumIndices > 0)
+		{
+			for (i = 0; i < numSlots; i++)
+			{
+				List	   *recheckIndexes;
+
+				recheckIndexes = ExecInsertIndexTuples(resultRelInfo,
+													   slots[i], estate,
+													   false, false, NULL,
+													   NIL, false);
+				/* no deferred constraints without row triggers */
+				Assert(recheckIndexes == NIL);
+				list_free(recheckIndexes);
+			}
+		}
+		MemoryContextSwitchTo(oldContext);
+
+		rslots = slots;
+	}
 
 	for (i = 0; i < numInserted; i++)
 	{
@@ -1244,13 +1408,16 @@ ExecBatchInsert(ModifyTableState *mtstate,
 	for (i = 0; i < numSlots; i++)
 	{
 		ExecClearTuple(slots[i]);
-		ExecClearTuple(planSlots[i]);
+		if (planSlots)
+			ExecClearTuple(planSlots[i]);
 	}
 	resultRelInfo->ri_NumSlots = 0;
+	resultRelInfo->ri_BatchBytes = 0;
 }
 
 /*
- * ExecPendingInserts -- flushes all pending inserts to the foreign tables
+ * ExecPendingInserts -- flushes all pending batched inserts, into foreign
+ * tables and tables alike
  */
 static void
 ExecPendingInserts(EState *estate)
@@ -2108,11 +2275,12 @@ ExecUpdateEpilogue(ModifyTableContext *context, UpdateContext *updateCxt,
 	List	   *recheckIndexes = NIL;
 
 	/* insert index entries for tuple if necessary */
-	if (resultRelInfo->ri_NumIndices > 0 && updateCxt->updateIndexes)
+	if (resultRelInfo->ri_NumIndices > 0 && updateCxt->updateIndexes != TU_None)
 		recheckIndexes = ExecInsertIndexTuples(resultRelInfo,
 											   slot, context->estate,
 											   true, false,
-											   NULL, NIL);
+											   NULL, NIL,
+											   (updateCxt->updateIndexes == TU_Summarizing));
 
 	/* AFTER ROW UPDATE Triggers */
 	ExecARUpdateTriggers(context->estate, resultRelInfo,
@@ -4349,7 +4517,8 @@ ExecInitModifyTable(ModifyTable *node, EState *estate, int eflags)
 	/*
 	 * Determine if the FDW supports batch insert and determine the batch size
 	 * (a FDW may support batching, but it may be disabled for the
-	 * server/table).
+	 * server/table).  Inserts into a table are batched too, when nothing
+	 * can observe the difference.
 	 *
 	 * We only do this for INSERT, so that for UPDATE/DELETE the batch size
 	 * remains set to 0.
@@ -4368,6 +4537,8 @@ ExecInitModifyTable(ModifyTable *node, EState *estate, int eflags)
 				resultRelInfo->ri_FdwRoutine->GetForeignModifyBatchSize(resultRelInfo);
 			Assert(resultRelInfo->ri_BatchSize >= 1);
 		}
+		else if (ExecInsertCanBatch(mtstate, resultRelInfo))
+			resultRelInfo->ri_BatchSize = MAX_BATCHED_INSERT_TUPLES;
 		else
 			resultRelInfo->ri_BatchSize = 1;
 	}
@@ -4416,14 +4587,14 @@ ExecEndModifyTable(ModifyTableState *node)
 														   resultRelInfo);
 
 		/*
-		 * Cleanup the initialized batch slots. This only matters for FDWs
-		 * with batching, but the other cases will have ri_NumSlotsInitialized
-		 * == 0.
+		 * Cleanup the initialized batch slots. This only matters for batched
+		 * inserts, the other cases will have ri_NumSlotsInitialized == 0.
 		 */
 		for (j = 0; j < resultRelInfo->ri_NumSlotsInitialized; j++)
 		{
 			ExecDropSingleTupleTableSlot(resultRelInfo->ri_Slots[j]);
-			ExecDropSingleTupleTableSlot(resultRelInfo->ri_PlanSlots[j]);
+			if (resultRelInfo->ri_PlanSlots)
+				ExecDropSingleTupleTableSlot(resultRelInfo->ri_PlanSlots[j]);
 		}
 	}
 
@@ -17,14 +17,140 @@
  *		ExecNestLoop	 - process a nestloop join of two plans
  *		ExecInitNestLoop - initialize the join
  *		ExecEndNestLoop  - shut down the join
+ *
+ * NOTES
+ *		When the inner side is a parameterized index scan, every outer tuple
+ *		costs at least one index descent and one heap fetch, which with
+ *		remote storage means a synchronous round trip each.  To hide that
+ *		latency we read ahead a few outer tuples into a queue.  When a tuple
+ *		enters the queue we prefetch the leaf page its inner scan will start
+ *		on, and when it is halfway through the queue, by which time that
+ *		leaf page has hopefully arrived, the heap pages of the matching
+ *		items.  The depth of the queue is adapted by a PrefetchControl, with
+ *		each outer tuple counting as one consumed page.  Only inner scans
+ *		whose index keys are plain Vars, Params or Consts take part, so that
+ *		evaluating them early can't raise errors or run side effects out of
+ *		order.
  */
 
 #include "postgres.h"
 
+#include "catalog/catalog.h"
 #include "executor/execdebug.h"
+#include "executor/nodeIndexscan.h"
 #include "executor/nodeNestloop.h"
 #include "miscadmin.h"
+#include "optimizer/cost.h"
 #include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/spccache.h"
+
+/* upper bound of the number of queued outer tuples */
+#define NESTLOOP_LOOKAHEAD_MAXIMUM	32
+
+/* number of heap pages to prefetch per outer tuple, if not single_match */
+#define NESTLOOP_PREFETCH_HEAP_PAGES	8
+
+
+/*
+ * Store the values of the outer Vars that must be passed to the inner scan
+ * in the appropriate PARAM_EXEC slots.
+ */
+static void
+ExecNestLoopSetParams(NestLoopState *node, TupleTableSlot *outerTupleSlot,
+					  bool changed)
+{
+	NestLoop   *nl = (NestLoop *) node->js.ps.plan;
+	ExprContext *econtext = node->js.ps.ps_ExprContext;
+	PlanState  *innerPlan = innerPlanState(node);
+	ListCell   *lc;
+
+	foreach(lc, nl->nestParams)
+	{
+		NestLoopParam *nlp = (NestLoopParam *) lfirst(lc);
+		int			paramno = nlp->paramno;
+		ParamExecData *prm;
+
+		prm = &(econtext->ecxt_param_exec_vals[paramno]);
+		/* Param value should be an OUTER_VAR var */
+		Assert(IsA(nlp->paramval, Var));
+		Assert(nlp->paramval->varno == OUTER_VAR);
+		Assert(nlp->paramval->varattno > 0);
+		prm->value = slot_getattr(outerTupleSlot,
+								  nlp->paramval->varattno,
+								  &(prm->isnull));
+		/* Flag parameter value as changed */
+		if (changed)
+			innerPlan->chgParam = bms_add_member(innerPlan->chgParam,
+												 paramno);
+	}
+}
+
+/*
+ * Prefetch for the inner scan of a queued outer tuple.
+ *
+ * The parameters are set to the values of the queued tuple only temporarily:
+ * the caller sets them for the current outer tuple before rescanning the
+ * inner plan.
+ */
+static void
+ExecNestLoopPrefetchInner(NestLoopState *node, TupleTableSlot *slot,
+						  int nheappages)
+{
+	ExecNestLoopSetParams(node, slot, false);
+	ExecIndexScanPrefetch(castNode(IndexScanState, innerPlanState(node)),
+						  nheappages);
+}
+
+/*
+ * Get the next outer tuple by way of the lookahead queue.
+ */
+static TupleTableSlot *
+ExecNestLoopNextOuter(NestLoopState *node)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+	int			target = PrefetchControlConsume(&node->nl_Prefetch);
+	TupleTableSlot *slot;
+
+	/* keep "target" tuples queued behind the one we return */
+	while (!node->nl_OuterDone && node->nl_QueueLen <= target)
+	{
+		TupleTableSlot *outerTupleSlot = ExecProcNode(outerPlan);
+
+		if (TupIsNull(outerTupleSlot))
+		{
+			node->nl_OuterDone = true;
+			break;
+		}
+
+		slot = node->nl_OuterQueue[(node->nl_QueueHead + node->nl_QueueLen) %
+								   node->nl_QueueSize];
+		ExecCopySlot(slot, outerTupleSlot);
+		node->nl_QueueLen++;
+
+		ExecNestLoopPrefetchInner(node, slot, 0);
+		PrefetchControlIssued(&node->nl_Prefetch, 1);
+	}
+
+	if (node->nl_QueueLen == 0)
+		return NULL;
+
+	/* the leaf page of the tuple halfway through should be there by now */
+	if (node->nl_QueueLen > 1)
+		ExecNestLoopPrefetchInner(node,
+								  node->nl_OuterQueue[(node->nl_QueueHead + node->nl_QueueLen / 2) %
+													  node->nl_QueueSize],
+								  node->js.single_match ? 1 : NESTLOOP_PREFETCH_HEAP_PAGES);
+
+	/* swap the head of the queue with the slot of the previous outer tuple */
+	slot = node->nl_OuterQueue[node->nl_QueueHead];
+	node->nl_OuterQueue[node->nl_QueueHead] = node->nl_OuterSlot;
+	node->nl_OuterSlot = slot;
+	node->nl_QueueHead = (node->nl_QueueHead + 1) % node->nl_QueueSize;
+	node->nl_QueueLen--;
+
+	return slot;
+}
 
 
 /* ----------------------------------------------------------------
@@ -61,7 +187,6 @@ static TupleTableSlot *
 ExecNestLoop(PlanState *pstate)
 {
 	NestLoopState *node = castNode(NestLoopState, pstate);
-	NestLoop   *nl;
 	PlanState  *innerPlan;
 	PlanState  *outerPlan;
 	TupleTableSlot *outerTupleSlot;
@@ -69,7 +194,6 @@ ExecNestLoop(PlanState *pstate)
 	ExprState  *joinqual;
 	ExprState  *otherqual;
 	ExprContext *econtext;
-	ListCell   *lc;
 
 	CHECK_FOR_INTERRUPTS();
 
@@ -78,7 +202,6 @@ ExecNestLoop(PlanState *pstate)
 	 */
 	ENL1_printf("getting info from node");
 
-	nl = (NestLoop *) node->js.ps.plan;
 	joinqual = node->js.joinqual;
 	otherqual = node->js.ps.qual;
 	outerPlan = outerPlanState(node);
@@ -106,7 +229,10 @@ ExecNestLoop(PlanState *pstate)
 		if (node->nl_NeedNewOuter)
 		{
 			ENL1_printf("getting new outer tuple");
-			outerTupleSlot = ExecProcNode(outerPlan);
+			if (node->nl_Lookahead)
+				outerTupleSlot = ExecNestLoopNextOuter(node);
+			else
+				outerTupleSlot = ExecProcNode(outerPlan);
 
 			/*
 			 * if there are no more outer tuples, then the join is complete..
@@ -126,24 +252,7 @@ ExecNestLoop(PlanState *pstate)
 			 * fetch the values of any outer Vars that must be passed to the
 			 * inner scan, and store them in the appropriate PARAM_EXEC slots.
 			 */
-			foreach(lc, nl->nestParams)
-			{
-				NestLoopParam *nlp = (NestLoopParam *) lfirst(lc);
-				int			paramno = nlp->paramno;
-				ParamExecData *prm;
-
-				prm = &(econtext->ecxt_param_exec_vals[paramno]);
-				/* Param value should be an OUTER_VAR var */
-				Assert(IsA(nlp->paramval, Var));
-				Assert(nlp->paramval->varno == OUTER_VAR);
-				Assert(nlp->paramval->varattno > 0);
-				prm->value = slot_getattr(outerTupleSlot,
-										  nlp->paramval->varattno,
-										  &(prm->isnull));
-				/* Flag parameter value as changed */
-				innerPlan->chgParam = bms_add_member(innerPlan->chgParam,
-													 paramno);
-			}
+			ExecNestLoopSetParams(node, outerTupleSlot, true);
 
 			/*
 			 * now rescan the inner plan
@@ -301,6 +410,43 @@ ExecInitNestLoop(NestLoop *node, EState *estate, int eflags)
 		eflags &= ~EXEC_FLAG_REWIND;
 	innerPlanState(nlstate) = ExecInitNode(innerPlan(node), estate, eflags);
 
+	/*
+	 * Set up the lookahead queue if the inner side is an index scan that we
+	 * can prefetch for.  The queued tuples are copies, so that's the kind of
+	 * outer slot the expressions get to see.
+	 */
+	if (enable_nestloop_prefetch && node->nestParams != NIL &&
+		IsA(innerPlanState(nlstate), IndexScanState) &&
+		ExecIndexScanSupportsPrefetch((IndexScanState *) innerPlanState(nlstate)))
+	{
+		Relation	heapRel = ((ScanState *) innerPlanState(nlstate))->ss_currentRelation;
+		TupleDesc	outerDesc = ExecGetResultType(outerPlanState(nlstate));
+		int			maximum;
+
+		maximum = IsCatalogRelation(heapRel)
+			? effective_io_concurrency
+			: get_tablespace_io_concurrency(heapRel->rd_rel->reltablespace);
+		maximum = Min(maximum, NESTLOOP_LOOKAHEAD_MAXIMUM);
+
+		if (maximum > 0)
+		{
+			nlstate->nl_Lookahead = true;
+			nlstate->nl_QueueSize = maximum + 1;
+			nlstate->nl_OuterQueue = (TupleTableSlot **)
+				palloc(nlstate->nl_QueueSize * sizeof(TupleTableSlot *));
+			for (int i = 0; i < nlstate->nl_QueueSize; i++)
+				nlstate->nl_OuterQueue[i] =
+					ExecInitExtraTupleSlot(estate, outerDesc, &TTSOpsMinimalTuple);
+			nlstate->nl_OuterSlot =
+				ExecInitExtraTupleSlot(estate, outerDesc, &TTSOpsMinimalTuple);
+			PrefetchControlInit(&nlstate->nl_Prefetch, maximum, 1);
+
+			nlstate->js.ps.outerops = &TTSOpsMinimalTuple;
+			nlstate->js.ps.outeropsfixed = true;
+			nlstate->js.ps.outeropsset = true;
+		}
+	}
+
 	/*
 	 * Initialize result slot, type and projection.
 	 */
@@ -408,4 +554,13 @@ ExecReScanNestLoop(NestLoopState *node)
 
 	node->nl_NeedNewOuter = true;
 	node->nl_MatchedOuter = false;
+
+	/* forget the queued outer tuples, they are returned again */
+	if (node->nl_Lookahead)
+	{
+		node->nl_OuterDone = false;
+		node->nl_QueueHead = 0;
+		node->nl_QueueLen = 0;
+		PrefetchControlRestart(&node->nl_Prefetch);
+	}
 }
@@ -39,6 +39,7 @@ bool		jit_tuple_deforming = true;
 double		jit_above_cost = 100000;
 double		jit_inline_above_cost = 500000;
 double		jit_optimize_above_cost = 500000;
+int			jit_defer_evaluations = 0;
 
 static JitProviderCallbacks provider;
 static bool provider_successfully_loaded = false;
@@ -145,12 +146,10 @@ jit_release_context(JitContext *context)
 }
 
 /*
- * Ask provider to JIT compile an expression.
- *
- * Returns true if successful, false if not.
+ * Should the expression be JIT compiled, as far as the query is concerned?
  */
-bool
-jit_compile_expr(struct ExprState *state)
+static bool
+jit_expr_wanted(struct ExprState *state)
 {
 	/*
 	 * We can easily create a one-off context for functions without an
@@ -172,6 +171,20 @@ jit_compile_expr(struct ExprState *state)
 	if (!(state->parent->state->es_jit_flags & PGJIT_EXPR))
 		return false;
 
+	return true;
+}
+
+/*
+ * Ask provider to JIT compile an expression.
+ *
+ * Returns true if successful, false if not.
+ */
+bool
+jit_compile_expr(struct ExprState *state)
+{
+	if (!jit_expr_wanted(state))
+		return false;
+
 	/* this also takes !jit_enabled into account */
 	if (provider_init())
 		return provider.compile_expr(state);
@@ -179,6 +192,29 @@ jit_compile_expr(struct ExprState *state)
 	return false;
 }
 
+/*
+ * Should JIT compilation of an expression be deferred?
+ *
+ * If jit_defer_evaluations is set, expressions that would be JIT compiled
+ * start out interpreted, and are only compiled, by calling jit_compile_expr()
+ * from the interpreter, once they have been evaluated that many times.  That
+ * way, queries whose expressions are evaluated only a few times don't wait
+ * for the compilation, while the expressions of large queries still get
+ * compiled.
+ */
+bool
+jit_defer_compile_expr(struct ExprState *state)
+{
+	if (jit_defer_evaluations <= 0)
+		return false;
+
+	if (!jit_expr_wanted(state))
+		return false;
+
+	/* no point in counting if no provider can be loaded */
+	return provider_init();
+}
+
 /* Aggregate JIT instrumentation information */
 void
 InstrJitAgg(JitInstrumentation *dst, JitInstrumentation *add)
@@ -1910,6 +1910,28 @@ llvm_compile_expr(ExprState *state)
 				LLVMBuildBr(b, opblocks[opno + 1]);
 				break;
 
+			case EEOP_CACHEDEXPR_CHECK:
+				{
+					LLVMValueRef v_ret;
+
+					v_ret = build_EvalXFunc(b, mod, "ExecEvalCachedExprCheck",
+											v_state, op, v_econtext);
+					v_ret = LLVMBuildZExt(b, v_ret, TypeStorageBool, "");
+
+					LLVMBuildCondBr(b,
+									LLVMBuildICmp(b, LLVMIntEQ, v_ret,
+												  l_sbool_const(1), ""),
+									opblocks[op->d.cachedexpr.jumpdone],
+									opblocks[opno + 1]);
+					break;
+				}
+
+			case EEOP_CACHEDEXPR_STORE:
+				build_EvalXFunc(b, mod, "ExecEvalCachedExprStore",
+								v_state, op, v_econtext);
+				LLVMBuildBr(b, opblocks[opno + 1]);
+				break;
+
 			case EEOP_AGG_STRICT_DESERIALIZE:
 			case EEOP_AGG_DESERIALIZE:
 				{
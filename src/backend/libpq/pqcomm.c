@@ -148,6 +148,8 @@ static int	socket_putmessage(char msgtype, const char *s, size_t len);
 static void socket_putmessage_noblock(char msgtype, const char *s, size_t len);
 static int	internal_putbytes(const char *s, size_t len);
 static int	internal_flush(void);
+static int	internal_flush_buffer(const char *buf, size_t *start,
+								  size_t *end);
 
 #ifdef HAVE_UNIX_SOCKETS
 static int	Lock_AF_UNIX(const char *unixSocketDir, const char *unixSocketPath);
@@ -1310,6 +1312,26 @@ internal_putbytes(const char *s, size_t len)
 			if (internal_flush())
 				return EOF;
 		}
+
+		/*
+		 * If the buffer is empty and the data wouldn't fit in it anyway,
+		 * send it straight from the caller's memory rather than copying it
+		 * through the buffer one chunk at a time.  That saves a memcpy of
+		 * large values, and sends them in as few calls as the kernel allows.
+		 */
+		if (PqSendStart == PqSendPointer && len >= PqSendBufferSize)
+		{
+			size_t		start = 0;
+			size_t		end = len;
+
+			socket_set_nonblocking(false);
+			if (internal_flush_buffer(s, &start, &end))
+				return EOF;
+			/* in blocking mode, everything has been sent */
+			Assert(start == end);
+			return 0;
+		}
+
 		amount = PqSendBufferSize - PqSendPointer;
 		if (amount > len)
 			amount = len;
@@ -1351,17 +1373,38 @@ socket_flush(void)
  */
 static int
 internal_flush(void)
+{
+	size_t		start = PqSendStart;
+	size_t		end = PqSendPointer;
+	int			res;
+
+	res = internal_flush_buffer(PqSendBuffer, &start, &end);
+	PqSendStart = start;
+	PqSendPointer = end;
+	return res;
+}
+
+/* --------------------------------
+ *		internal_flush_buffer - send buf[*start .. *end)
+ *
+ * *start is advanced past the bytes sent.  When everything has been sent,
+ * or on failure, *start and *end are both reset to 0.  Return value is as
+ * for internal_flush().
+ * --------------------------------
+ */
+static int
+internal_flush_buffer(const char *buf, size_t *start, size_t *end)
 {
 	static int	last_reported_send_errno = 0;
 
-	char	   *bufptr = PqSendBuffer + PqSendStart;
-	char	   *bufend = PqSendBuffer + PqSendPointer;
+	const char *bufptr = buf + *start;
+	const char *bufend = buf + *end;
 
 	while (bufptr < bufend)
 	{
 		int			r;
 
-		r = secure_write(MyProcPort, bufptr, bufend - bufptr);
+		r = secure_write(MyProcPort, (char *) bufptr, bufend - bufptr);
 
 		if (r <= 0)
 		{
@@ -1401,7 +1444,7 @@ internal_flush(void)
 			 * flag that'll cause the next CHECK_FOR_INTERRUPTS to terminate
 			 * the connection.
 			 */
-			PqSendStart = PqSendPointer = 0;
+			*start = *end = 0;
 			ClientConnectionLost = 1;
 			InterruptPending = 1;
 			return EOF;
@@ -1409,10 +1452,10 @@ internal_flush(void)
 
 		last_reported_send_errno = 0;	/* reset after any successful send */
 		bufptr += r;
-		PqSendStart += r;
+		*start += r;
 	}
 
-	PqSendStart = PqSendPointer = 0;
+	*start = *end = 0;
 	return 0;
 }
 
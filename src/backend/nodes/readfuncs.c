@@ -1740,6 +1740,7 @@ _readModifyTable(void)
 	READ_UINT_FIELD(exclRelRTI);
 	READ_NODE_FIELD(exclRelTlist);
 	READ_NODE_FIELD(mergeActionLists);
+	READ_BOOL_FIELD(batchInsertOk);
 
 	READ_DONE();
 }
@@ -1908,6 +1909,7 @@ _readIndexScan(void)
 	READ_NODE_FIELD(indexorderbyorig);
 	READ_NODE_FIELD(indexorderbyops);
 	READ_ENUM_FIELD(indexorderdir, ScanDirection);
+	READ_BOOL_FIELD(indexskipscan);
 
 	READ_DONE();
 }
@@ -1928,6 +1930,7 @@ _readIndexOnlyScan(void)
 	READ_NODE_FIELD(indexorderby);
 	READ_NODE_FIELD(indextlist);
 	READ_ENUM_FIELD(indexorderdir, ScanDirection);
+	READ_BOOL_FIELD(indexskipscan);
 
 	READ_DONE();
 }
@@ -1946,6 +1949,7 @@ _readBitmapIndexScan(void)
 	READ_BOOL_FIELD(isshared);
 	READ_NODE_FIELD(indexqual);
 	READ_NODE_FIELD(indexqualorig);
+	READ_BOOL_FIELD(indexskipscan);
 
 	READ_DONE();
 }
@@ -1041,16 +1041,15 @@ tbm_iterate(TBMIterator *iterator)
 }
 
 /*
- *	tbm_shared_iterate - scan through next page of a TIDBitmap
+ *	tbm_shared_iterate_next - advance a shared iterator by one page
  *
- *	As above, but this will iterate using an iterator which is shared
- *	across multiple processes.  We need to acquire the iterator LWLock,
- *	before accessing the shared members.
+ *	Subroutine for tbm_shared_iterate and tbm_shared_iterate_batch.  Stores
+ *	the next page into *output and returns true, or returns false if the
+ *	bitmap is exhausted.  Caller must hold the iterator LWLock.
  */
-TBMIterateResult *
-tbm_shared_iterate(TBMSharedIterator *iterator)
+static bool
+tbm_shared_iterate_next(TBMSharedIterator *iterator, TBMIterateResult *output)
 {
-	TBMIterateResult *output = &iterator->output;
 	TBMSharedIteratorState *istate = iterator->state;
 	PagetableEntry *ptbase = NULL;
 	int		   *idxpages = NULL;
@@ -1063,9 +1062,6 @@ tbm_shared_iterate(TBMSharedIterator *iterator)
 	if (iterator->ptchunks != NULL)
 		idxchunks = iterator->ptchunks->index;
 
-	/* Acquire the LWLock before accessing the shared members */
-	LWLockAcquire(&istate->lock, LW_EXCLUSIVE);
-
 	/*
 	 * If lossy chunk pages remain, make sure we've advanced schunkptr/
 	 * schunkbit to the next set bit.
@@ -1106,8 +1102,7 @@ tbm_shared_iterate(TBMSharedIterator *iterator)
 			output->recheck = true;
 			istate->schunkbit++;
 
-			LWLockRelease(&istate->lock);
-			return output;
+			return true;
 		}
 	}
 
@@ -1123,15 +1118,60 @@ tbm_shared_iterate(TBMSharedIterator *iterator)
 		output->recheck = page->recheck;
 		istate->spageptr++;
 
-		LWLockRelease(&istate->lock);
-
-		return output;
+		return true;
 	}
 
-	LWLockRelease(&istate->lock);
-
 	/* Nothing more in the bitmap */
-	return NULL;
+	return false;
+}
+
+/*
+ *	tbm_shared_iterate - scan through next page of a TIDBitmap
+ *
+ *	As above, but this will iterate using an iterator which is shared
+ *	across multiple processes.  We need to acquire the iterator LWLock,
+ *	before accessing the shared members.
+ */
+TBMIterateResult *
+tbm_shared_iterate(TBMSharedIterator *iterator)
+{
+	TBMIterateResult *output = &iterator->output;
+	bool		found;
+
+	/* Acquire the LWLock before accessing the shared members */
+	LWLockAcquire(&iterator->state->lock, LW_EXCLUSIVE);
+	found = tbm_shared_iterate_next(iterator, output);
+	LWLockRelease(&iterator->state->lock);
+
+	return found ? output : NULL;
+}
+
+/*
+ *	tbm_shared_iterate_batch - scan through the next few pages of a TIDBitmap
+ *
+ *	Like tbm_shared_iterate, but claims up to "n" pages with a single
+ *	acquisition of the iterator LWLock.  The pages are stored into the
+ *	caller-supplied results, each of which must have room for
+ *	MaxHeapTuplesPerPage offsets.  Because no other process can advance the
+ *	iterator meanwhile, the claimed pages are consecutive pages of the
+ *	bitmap.  Returns the number of pages claimed, which is less than "n"
+ *	only if the bitmap has been exhausted.
+ */
+int
+tbm_shared_iterate_batch(TBMSharedIterator *iterator,
+						 TBMIterateResult **outputs, int n)
+{
+	int			i;
+
+	LWLockAcquire(&iterator->state->lock, LW_EXCLUSIVE);
+	for (i = 0; i < n; i++)
+	{
+		if (!tbm_shared_iterate_next(iterator, outputs[i]))
+			break;
+	}
+	LWLockRelease(&iterator->state->lock);
+
+	return i;
 }
 
 /*
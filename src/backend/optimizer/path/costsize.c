@@ -155,6 +155,7 @@ bool		enable_async_append = true;
 bool        enable_seqscan_prefetch = true;
 bool        enable_indexscan_prefetch = true;
 bool        enable_indexonlyscan_prefetch = true;
+bool        enable_nestloop_prefetch = true;
 
 typedef struct
 {
@@ -586,7 +587,13 @@ cost_index(IndexPath *path, PlannerInfo *root, double loop_count,
 	 * the fraction of main-table tuples we will have to retrieve) and its
 	 * correlation to the main-table tuple order.  We need a cast here because
 	 * pathnodes.h uses a weak function type to avoid including amapi.h.
+	 *
+	 * The path is marked parallel-aware first if it is to be a partial path,
+	 * since some access methods scan differently in parallel.  A partial path
+	 * that gets no workers below is thrown away by the caller.
 	 */
+	if (partial_path)
+		path->path.parallel_aware = true;
 	amcostestimate = (amcostestimate_function) index->amcostestimate;
 	amcostestimate(root, path, loop_count,
 				   &indexStartupCost, &indexTotalCost,
@@ -747,8 +754,6 @@ cost_index(IndexPath *path, PlannerInfo *root, double loop_count,
 		 */
 		if (path->path.parallel_workers <= 0)
 			return;
-
-		path->path.parallel_aware = true;
 	}
 
 	/*
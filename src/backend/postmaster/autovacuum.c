@@ -183,6 +183,17 @@ typedef struct av_relation
 								 * reloptions, or NULL if none */
 } av_relation;
 
+/*
+ * struct to keep track of tables that need to be vacuumed and/or analyzed,
+ * before rechecking; see relation_needs_vacanalyze for the meaning of score
+ */
+typedef struct av_candidate
+{
+	Oid			ac_relid;
+	bool		ac_wraparound;
+	double		ac_score;
+} av_candidate;
+
 /* struct to keep track of tables to vacuum and/or analyze, after rechecking */
 typedef struct autovac_table
 {
@@ -334,7 +345,9 @@ static void relation_needs_vacanalyze(Oid relid, AutoVacOpts *relopts,
 									  Form_pg_class classForm,
 									  PgStat_StatTabEntry *tabentry,
 									  int effective_multixact_freeze_max_age,
-									  bool *dovacuum, bool *doanalyze, bool *wraparound);
+									  bool *dovacuum, bool *doanalyze, bool *wraparound,
+									  double *score);
+static int	av_candidate_comparator(const ListCell *a, const ListCell *b);
 
 static void autovacuum_do_vac_analyze(autovac_table *tab,
 									  BufferAccessStrategy bstrategy);
@@ -1972,7 +1985,7 @@ do_autovacuum(void)
 	HeapTuple	tuple;
 	TableScanDesc relScan;
 	Form_pg_database dbForm;
-	List	   *table_oids = NIL;
+	List	   *candidates = NIL;
 	List	   *orphan_oids = NIL;
 	HASHCTL		ctl;
 	HTAB	   *table_toast_map;
@@ -2078,6 +2091,7 @@ do_autovacuum(void)
 		bool		dovacuum;
 		bool		doanalyze;
 		bool		wraparound;
+		double		score;
 
 		if (classForm->relkind != RELKIND_RELATION &&
 			classForm->relkind != RELKIND_MATVIEW)
@@ -2118,11 +2132,18 @@ do_autovacuum(void)
 		/* Check if it needs vacuum or analyze */
 		relation_needs_vacanalyze(relid, relopts, classForm, tabentry,
 								  effective_multixact_freeze_max_age,
-								  &dovacuum, &doanalyze, &wraparound);
+								  &dovacuum, &doanalyze, &wraparound, &score);
 
-		/* Relations that need work are added to table_oids */
+		/* Relations that need work are added to candidates */
 		if (dovacuum || doanalyze)
-			table_oids = lappend_oid(table_oids, relid);
+		{
+			av_candidate *cand = palloc(sizeof(av_candidate));
+
+			cand->ac_relid = relid;
+			cand->ac_wraparound = wraparound;
+			cand->ac_score = score;
+			candidates = lappend(candidates, cand);
+		}
 
 		/*
 		 * Remember TOAST associations for the second pass.  Note: we must do
@@ -2171,6 +2192,7 @@ do_autovacuum(void)
 		bool		dovacuum;
 		bool		doanalyze;
 		bool		wraparound;
+		double		score;
 
 		/*
 		 * We cannot safely process other backends' temp tables, so skip 'em.
@@ -2201,16 +2223,30 @@ do_autovacuum(void)
 
 		relation_needs_vacanalyze(relid, relopts, classForm, tabentry,
 								  effective_multixact_freeze_max_age,
-								  &dovacuum, &doanalyze, &wraparound);
+								  &dovacuum, &doanalyze, &wraparound, &score);
 
 		/* ignore analyze for toast tables */
 		if (dovacuum)
-			table_oids = lappend_oid(table_oids, relid);
+		{
+			av_candidate *cand = palloc(sizeof(av_candidate));
+
+			cand->ac_relid = relid;
+			cand->ac_wraparound = wraparound;
+			cand->ac_score = score;
+			candidates = lappend(candidates, cand);
+		}
 	}
 
 	table_endscan(relScan);
 	table_close(classRel, AccessShareLock);
 
+	/*
+	 * Process the most urgent tables first, rather than in pg_class order, so
+	 * that a table close to wraparound or full of dead tuples doesn't have to
+	 * wait for a long run of tables that only barely crossed a threshold.
+	 */
+	list_sort(candidates, av_candidate_comparator);
+
 	/*
 	 * Recheck orphan temporary tables, and if they still seem orphaned, drop
 	 * them.  We'll eat a transaction per dropped table, which might seem
@@ -2316,9 +2352,9 @@ do_autovacuum(void)
 	/*
 	 * Perform operations on collected tables.
 	 */
-	foreach(cell, table_oids)
+	foreach(cell, candidates)
 	{
-		Oid			relid = lfirst_oid(cell);
+		Oid			relid = ((av_candidate *) lfirst(cell))->ac_relid;
 		HeapTuple	classTup;
 		autovac_table *tab;
 		bool		isshared;
@@ -2674,6 +2710,10 @@ perform_work_item(AutoVacuumWorkItem *workitem)
 									ObjectIdGetDatum(workitem->avw_relation),
 									Int64GetDatum((int64) workitem->avw_blockNumber));
 				break;
+			case AVW_GINCleanupPendingList:
+				DirectFunctionCall1(gin_clean_pending_list,
+									ObjectIdGetDatum(workitem->avw_relation));
+				break;
 			default:
 				elog(WARNING, "unrecognized work item found: type %d",
 					 workitem->avw_type);
@@ -2904,6 +2944,23 @@ table_recheck_autovac(Oid relid, HTAB *table_toast_map,
 	return tab;
 }
 
+/*
+ * list_sort comparator for av_candidate: tables that need an anti-wraparound
+ * vacuum go first, and then the highest score goes first
+ */
+static int
+av_candidate_comparator(const ListCell *a, const ListCell *b)
+{
+	const av_candidate *ca = (const av_candidate *) lfirst(a);
+	const av_candidate *cb = (const av_candidate *) lfirst(b);
+
+	if (ca->ac_wraparound != cb->ac_wraparound)
+		return ca->ac_wraparound ? -1 : 1;
+	if (ca->ac_score == cb->ac_score)
+		return 0;
+	return (ca->ac_score < cb->ac_score) ? 1 : -1;
+}
+
 /*
  * recheck_relation_needs_vacanalyze
  *
@@ -2922,6 +2979,7 @@ recheck_relation_needs_vacanalyze(Oid relid,
 								  bool *wraparound)
 {
 	PgStat_StatTabEntry *tabentry;
+	double		score;
 
 	/* fetch the pgstat table entry */
 	tabentry = pgstat_fetch_stat_tabentry_ext(classForm->relisshared,
@@ -2929,7 +2987,7 @@ recheck_relation_needs_vacanalyze(Oid relid,
 
 	relation_needs_vacanalyze(relid, avopts, classForm, tabentry,
 							  effective_multixact_freeze_max_age,
-							  dovacuum, doanalyze, wraparound);
+							  dovacuum, doanalyze, wraparound, &score);
 
 	/* ignore ANALYZE for toast tables */
 	if (classForm->relkind == RELKIND_TOASTVALUE)
@@ -2972,6 +3030,16 @@ recheck_relation_needs_vacanalyze(Oid relid,
  * autovacuum_vacuum_threshold GUC variable.  Similarly, a vac_scale_factor
  * value < 0 is substituted with the value of
  * autovacuum_vacuum_scale_factor GUC variable.  Ditto for analyze.
+ *
+ * "score" is returned as a measure of how urgently the table needs attention,
+ * used to decide the order in which tables are processed.  It is the largest
+ * of the ratios of each of the quantities above to the limit that triggers
+ * work: relfrozenxid age to freeze_max_age, relminmxid age to
+ * multixact_freeze_max_age, and the dead, inserted and changed tuple counts
+ * to their thresholds.  So a score above 1 means that something is due, and
+ * tables further past their limits score higher.  Since the thresholds grow
+ * with reltuples, a big table doesn't outrank a small one just by having
+ * more dead tuples in absolute terms.
  */
 static void
 relation_needs_vacanalyze(Oid relid,
@@ -2982,7 +3050,8 @@ relation_needs_vacanalyze(Oid relid,
  /* output params below */
 						  bool *dovacuum,
 						  bool *doanalyze,
-						  bool *wraparound)
+						  bool *wraparound,
+						  double *score)
 {
 	bool		force_vacuum;
 	bool		av_enabled;
@@ -3074,6 +3143,19 @@ relation_needs_vacanalyze(Oid relid,
 	}
 	*wraparound = force_vacuum;
 
+	/* Score the relfrozenxid and relminmxid ages */
+	*score = 0.0;
+	if (TransactionIdIsNormal(classForm->relfrozenxid) &&
+		TransactionIdPrecedes(classForm->relfrozenxid, recentXid))
+		*score = Max(*score,
+					 (double) (recentXid - classForm->relfrozenxid) /
+					 Max(freeze_max_age, 1));
+	if (MultiXactIdIsValid(classForm->relminmxid) &&
+		MultiXactIdPrecedes(classForm->relminmxid, recentMulti))
+		*score = Max(*score,
+					 (double) (recentMulti - classForm->relminmxid) /
+					 Max(multixact_freeze_max_age, 1));
+
 	/* User disabled it in pg_class.reloptions?  (But ignore if at risk) */
 	if (!av_enabled && !force_vacuum)
 	{
@@ -3122,6 +3204,11 @@ relation_needs_vacanalyze(Oid relid,
 		*dovacuum = force_vacuum || (vactuples > vacthresh) ||
 			(vac_ins_base_thresh >= 0 && instuples > vacinsthresh);
 		*doanalyze = (anltuples > anlthresh);
+
+		*score = Max(*score, vactuples / Max(vacthresh, 1));
+		if (vac_ins_base_thresh >= 0)
+			*score = Max(*score, instuples / Max(vacinsthresh, 1));
+		*score = Max(*score, anltuples / Max(anlthresh, 1));
 	}
 	else
 	{
@@ -3221,6 +3308,10 @@ autovac_report_workitem(AutoVacuumWorkItem *workitem,
 			snprintf(activity, MAX_AUTOVAC_ACTIV_LEN,
 					 "autovacuum: BRIN summarize");
 			break;
+		case AVW_GINCleanupPendingList:
+			snprintf(activity, MAX_AUTOVAC_ACTIV_LEN,
+					 "autovacuum: GIN pending list cleanup");
+			break;
 	}
 
 	/*
@@ -3258,6 +3349,9 @@ AutoVacuumingActive(void)
 /*
  * Request one work item to the next autovacuum run processing our database.
  * Return false if the request can't be recorded.
+ *
+ * A request identical to one that is already waiting is not recorded again,
+ * but reported as recorded.
  */
 bool
 AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
@@ -3268,6 +3362,21 @@ AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId,
 
 	LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
 
+	for (i = 0; i < NUM_WORKITEMS; i++)
+	{
+		AutoVacuumWorkItem *workitem = &AutoVacuumShmem->av_workItems[i];
+
+		if (workitem->avw_used && !workitem->avw_active &&
+			workitem->avw_type == type &&
+			workitem->avw_database == MyDatabaseId &&
+			workitem->avw_relation == relationId &&
+			workitem->avw_blockNumber == blkno)
+		{
+			LWLockRelease(AutovacuumLock);
+			return true;
+		}
+	}
+
 	/*
 	 * Locate an unused work item and fill it with the given data.
 	 */
@@ -257,6 +257,10 @@ WalWriterMain(void)
 		else if (left_till_hibernate > 0)
 			left_till_hibernate--;
 
+		/* Keep some WAL segments ready ahead of the insert position. */
+		if (XLogPreallocateSegments())
+			left_till_hibernate = LOOPS_UNTIL_HIBERNATE;
+
 		/* report pending statistics to the cumulative stats system */
 		pgstat_report_wal(false);
 
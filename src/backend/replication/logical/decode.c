@@ -34,6 +34,7 @@
 #include "access/xlogreader.h"
 #include "access/xlogrecord.h"
 #include "access/xlogutils.h"
+#include "catalog/catalog.h"
 #include "catalog/pg_control.h"
 #include "replication/decode.h"
 #include "replication/logical.h"
@@ -42,6 +43,11 @@
 #include "replication/reorderbuffer.h"
 #include "replication/snapbuild.h"
 #include "storage/standby.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/rel.h"
+#include "utils/relfilenodemap.h"
+#include "utils/snapmgr.h"
 
 /* individual record(group)'s handlers */
 static void DecodeInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf);
@@ -70,6 +76,22 @@ static inline bool FilterPrepare(LogicalDecodingContext *ctx,
 static bool DecodeTXNNeedSkip(LogicalDecodingContext *ctx,
 							  XLogRecordBuffer *buf, Oid dbId,
 							  RepOriginId origin_id);
+static bool FilterByRelation(LogicalDecodingContext *ctx,
+							 XLogRecordBuffer *buf, RelFileNode *rnode,
+							 ReorderBufferChangeType action);
+
+/* entry of LogicalDecodingContext->relation_filter_cache */
+typedef struct RelationFilterEntry
+{
+	RelFileNode rnode;			/* hash key */
+	bool		filter_insert;
+	bool		filter_update;
+	bool		filter_delete;
+} RelationFilterEntry;
+
+/* count of relcache invalidations seen by this backend */
+static uint64 relation_filter_inval_count = 0;
+static bool relation_filter_callback_registered = false;
 
 /*
  * Take every XLogReadRecord()ed record and perform the actions required to
@@ -553,6 +575,193 @@ FilterByOrigin(LogicalDecodingContext *ctx, RepOriginId origin_id)
 	return filter_by_origin_cb_wrapper(ctx, origin_id);
 }
 
+static void
+RelationFilterInvalCallback(Datum arg, Oid relid)
+{
+	relation_filter_inval_count++;
+}
+
+/*
+ * Look up the relation with the given relfilenode and ask the output plugin
+ * which changes of it are of interest.
+ */
+static void
+RelationFilterLookup(LogicalDecodingContext *ctx, Snapshot snapshot,
+					 RelationFilterEntry *entry)
+{
+	MemoryContext ccxt = CurrentMemoryContext;
+	ResourceOwner cowner = CurrentResourceOwner;
+	bool		using_subtxn = IsTransactionOrTransactionBlock();
+	Oid			reloid;
+
+	entry->filter_insert = false;
+	entry->filter_update = false;
+	entry->filter_delete = false;
+
+	/* catalog access needs a transaction, as in ReorderBufferProcessTXN */
+	if (using_subtxn)
+		BeginInternalSubTransaction("filter_by_relation");
+	else
+		StartTransactionCommand();
+
+	SetupHistoricSnapshot(snapshot, NULL);
+	PG_TRY();
+	{
+		reloid = RelidByRelfilenode(entry->rnode.spcNode,
+									entry->rnode.relNode);
+		if (OidIsValid(reloid))
+		{
+			Relation	relation = RelationIdGetRelation(reloid);
+
+			/*
+			 * Leave alone everything that ReorderBufferProcessTXN treats
+			 * specially; in particular TOAST chunks are needed to decode the
+			 * changes of the main table.
+			 */
+			if (RelationIsValid(relation) &&
+				RelationIsLogicallyLogged(relation) &&
+				!IsToastRelation(relation) &&
+				!relation->rd_rel->relrewrite &&
+				relation->rd_rel->relkind != RELKIND_SEQUENCE)
+			{
+				entry->filter_insert =
+					filter_by_relation_cb_wrapper(ctx, relation,
+												  REORDER_BUFFER_CHANGE_INSERT);
+				entry->filter_update =
+					filter_by_relation_cb_wrapper(ctx, relation,
+												  REORDER_BUFFER_CHANGE_UPDATE);
+				entry->filter_delete =
+					filter_by_relation_cb_wrapper(ctx, relation,
+												  REORDER_BUFFER_CHANGE_DELETE);
+			}
+			if (RelationIsValid(relation))
+				RelationClose(relation);
+		}
+
+		TeardownHistoricSnapshot(false);
+	}
+	PG_CATCH();
+	{
+		TeardownHistoricSnapshot(true);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	/* we didn't change anything, just throw the transaction away */
+	if (using_subtxn)
+		RollbackAndReleaseCurrentSubTransaction();
+	else
+		AbortCurrentTransaction();
+
+	MemoryContextSwitchTo(ccxt);
+	CurrentResourceOwner = cowner;
+}
+
+/*
+ * Should a change of the given relation be left out of the reorder buffer?
+ *
+ * Changes of relations the output plugin is not interested in, say tables
+ * that are not published, would be thrown away by its change callback only
+ * once the transaction is replayed.  By then they have been copied, queued,
+ * maybe spilled to disk, and their TOAST'ed values reassembled.  If the
+ * plugin has a filter_by_relation_cb, we ask it early instead.
+ *
+ * The relation is looked up with the transaction's base snapshot, which is
+ * what replay will use for the change as long as neither the transaction
+ * itself nor a concurrently committed one has changed the catalog since; we
+ * stop filtering the transaction's changes once either has, see
+ * ReorderBufferXidGetFilterSnapshot.  Mapping the relfilenode to a relation
+ * needs catalog access, so the plugin's decisions are cached by relfilenode,
+ * for as long as the same snapshot is used and no relcache invalidation
+ * arrives.  The latter covers changes of publications.  Whenever anything is
+ * unclear, the change is simply not filtered.
+ */
+static bool
+FilterByRelation(LogicalDecodingContext *ctx, XLogRecordBuffer *buf,
+				 RelFileNode *rnode, ReorderBufferChangeType action)
+{
+	TransactionId xid = XLogRecGetXid(buf->record);
+	Snapshot	snapshot;
+	RelationFilterEntry *entry;
+	RelationFilterEntry lookup;
+	uint64		inval_count;
+
+	if (ctx->callbacks.filter_by_relation_cb == NULL)
+		return false;
+
+	if (SnapBuildCurrentState(ctx->snapshot_builder) != SNAPBUILD_CONSISTENT)
+		return false;
+
+	snapshot = ReorderBufferXidGetFilterSnapshot(ctx->reorder, xid);
+	if (snapshot == NULL)
+		return false;
+
+	if (!relation_filter_callback_registered)
+	{
+		CacheRegisterRelcacheCallback(RelationFilterInvalCallback, (Datum) 0);
+		relation_filter_callback_registered = true;
+	}
+
+	if (ctx->relation_filter_cache == NULL ||
+		ctx->relation_filter_snapshot != snapshot ||
+		ctx->relation_filter_inval_count != relation_filter_inval_count)
+	{
+		HASHCTL		hash_ctl;
+
+		if (ctx->relation_filter_cache != NULL)
+			hash_destroy(ctx->relation_filter_cache);
+
+		hash_ctl.keysize = sizeof(RelFileNode);
+		hash_ctl.entrysize = sizeof(RelationFilterEntry);
+		hash_ctl.hcxt = ctx->context;
+		ctx->relation_filter_cache =
+			hash_create("logical decoding relation filter cache", 64,
+						&hash_ctl, HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+		ctx->relation_filter_inval_count = relation_filter_inval_count;
+
+		/* keep the snapshot alive, so that its address stays unique */
+		if (ctx->relation_filter_snapshot != snapshot)
+		{
+			if (ctx->relation_filter_snapshot != NULL)
+				SnapBuildSnapDecRefcount(ctx->relation_filter_snapshot);
+			SnapBuildSnapIncRefcount(snapshot);
+			ctx->relation_filter_snapshot = snapshot;
+		}
+	}
+
+	entry = (RelationFilterEntry *)
+		hash_search(ctx->relation_filter_cache, rnode, HASH_FIND, NULL);
+	if (entry == NULL)
+	{
+		inval_count = relation_filter_inval_count;
+
+		lookup.rnode = *rnode;
+		RelationFilterLookup(ctx, snapshot, &lookup);
+		entry = &lookup;
+
+		/* don't cache a decision that may be stale already */
+		if (inval_count == relation_filter_inval_count)
+		{
+			entry = (RelationFilterEntry *)
+				hash_search(ctx->relation_filter_cache, rnode, HASH_ENTER,
+							NULL);
+			*entry = lookup;
+		}
+	}
+
+	switch (action)
+	{
+		case REORDER_BUFFER_CHANGE_INSERT:
+			return entry->filter_insert;
+		case REORDER_BUFFER_CHANGE_UPDATE:
+			return entry->filter_update;
+		case REORDER_BUFFER_CHANGE_DELETE:
+			return entry->filter_delete;
+		default:
+			return false;
+	}
+}
+
 /*
  * Handle rmgr LOGICALMSG_ID records for DecodeRecordIntoReorderBuffer().
  */
@@ -890,6 +1099,12 @@ DecodeInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 	if (FilterByOrigin(ctx, XLogRecGetOrigin(r)))
 		return;
 
+	/* nor for this relation */
+	if (!(xlrec->flags & (XLH_INSERT_IS_SPECULATIVE |
+						  XLH_INSERT_ON_TOAST_RELATION)) &&
+		FilterByRelation(ctx, buf, &target_node, REORDER_BUFFER_CHANGE_INSERT))
+		return;
+
 	change = ReorderBufferGetChange(ctx->reorder);
 	if (!(xlrec->flags & XLH_INSERT_IS_SPECULATIVE))
 		change->action = REORDER_BUFFER_CHANGE_INSERT;
@@ -940,6 +1155,10 @@ DecodeUpdate(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 	if (FilterByOrigin(ctx, XLogRecGetOrigin(r)))
 		return;
 
+	/* nor for this relation */
+	if (FilterByRelation(ctx, buf, &target_node, REORDER_BUFFER_CHANGE_UPDATE))
+		return;
+
 	change = ReorderBufferGetChange(ctx->reorder);
 	change->action = REORDER_BUFFER_CHANGE_UPDATE;
 	change->origin_id = XLogRecGetOrigin(r);
@@ -1006,6 +1225,11 @@ DecodeDelete(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 	if (FilterByOrigin(ctx, XLogRecGetOrigin(r)))
 		return;
 
+	/* nor for this relation */
+	if (!(xlrec->flags & XLH_DELETE_IS_SUPER) &&
+		FilterByRelation(ctx, buf, &target_node, REORDER_BUFFER_CHANGE_DELETE))
+		return;
+
 	change = ReorderBufferGetChange(ctx->reorder);
 
 	if (xlrec->flags & XLH_DELETE_IS_SUPER)
@@ -1108,6 +1332,10 @@ DecodeMultiInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 	if (FilterByOrigin(ctx, XLogRecGetOrigin(r)))
 		return;
 
+	/* nor for this relation */
+	if (FilterByRelation(ctx, buf, &rnode, REORDER_BUFFER_CHANGE_INSERT))
+		return;
+
 	/*
 	 * We know that this multi_insert isn't for a catalog, so the block should
 	 * always have data even if a full-page write of it is taken.
@@ -118,6 +118,29 @@ logicalrep_relmap_init(void)
 								  (Datum) 0);
 }
 
+/*
+ * Release the attribute map of a relation map cache entry, and the
+ * attribute functions that go with it.
+ */
+static void
+logicalrep_relmap_free_attrmap(LogicalRepRelMapEntry *entry)
+{
+	if (entry->attrmap)
+	{
+		free_attrmap(entry->attrmap);
+		entry->attrmap = NULL;
+	}
+
+	if (entry->attfuncscxt)
+	{
+		MemoryContextDelete(entry->attfuncscxt);
+		entry->attfuncscxt = NULL;
+		entry->attinfuncs = NULL;
+		entry->attrecvfuncs = NULL;
+		entry->atttypioparams = NULL;
+	}
+}
+
 /*
  * Free the entry of a relation map cache.
  */
@@ -143,8 +166,7 @@ logicalrep_relmap_free_entry(LogicalRepRelMapEntry *entry)
 	}
 	bms_free(remoterel->attkeys);
 
-	if (entry->attrmap)
-		free_attrmap(entry->attrmap);
+	logicalrep_relmap_free_attrmap(entry);
 }
 
 /*
@@ -374,11 +396,7 @@ logicalrep_rel_open(LogicalRepRelId remoteid, LOCKMODE lockmode)
 		Bitmapset  *missingatts;
 
 		/* Release the no-longer-useful attrmap, if any. */
-		if (entry->attrmap)
-		{
-			free_attrmap(entry->attrmap);
-			entry->attrmap = NULL;
-		}
+		logicalrep_relmap_free_attrmap(entry);
 
 		/* Try to find and lock the relation by name. */
 		relid = RangeVarGetRelid(makeRangeVar(remoterel->nspname,
@@ -628,11 +646,7 @@ logicalrep_partition_open(LogicalRepRelMapEntry *root,
 	}
 
 	/* Release the no-longer-useful attrmap, if any. */
-	if (entry->attrmap)
-	{
-		free_attrmap(entry->attrmap);
-		entry->attrmap = NULL;
-	}
+	logicalrep_relmap_free_attrmap(entry);
 
 	if (!entry->remoterel.remoteid)
 	{
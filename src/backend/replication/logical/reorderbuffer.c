@@ -554,11 +554,13 @@ ReorderBufferGetTupleBuf(ReorderBuffer *rb, Size tuple_len)
 
 	alloc_len = tuple_len + SizeofHeapTupleHeader;
 
+	/*
+	 * Decoding can queue millions of tuples, so keep the per-tuple overhead
+	 * down to the HeapTupleData the output plugins need.
+	 */
 	tuple = (ReorderBufferTupleBuf *)
 		MemoryContextAlloc(rb->tup_context,
-						   sizeof(ReorderBufferTupleBuf) +
-						   MAXIMUM_ALIGNOF + alloc_len);
-	tuple->alloc_tuple_size = alloc_len;
+						   MAXALIGN(sizeof(ReorderBufferTupleBuf)) + alloc_len);
 	tuple->tuple.t_data = ReorderBufferTupleBufData(tuple);
 
 	return tuple;
@@ -1073,6 +1075,8 @@ ReorderBufferAssignChild(ReorderBuffer *rb, TransactionId xid,
 
 	subtxn->txn_flags |= RBTXN_IS_SUBXACT;
 	subtxn->toplevel_xid = xid;
+	if (rbtxn_has_new_snapshot(subtxn))
+		txn->txn_flags |= RBTXN_HAS_NEW_SNAPSHOT;
 	Assert(subtxn->nsubtxns == 0);
 
 	/* set the reference to top-level transaction */
@@ -3067,11 +3071,18 @@ ReorderBufferAddSnapshot(ReorderBuffer *rb, TransactionId xid,
 						 XLogRecPtr lsn, Snapshot snap)
 {
 	ReorderBufferChange *change = ReorderBufferGetChange(rb);
+	ReorderBufferTXN *txn;
 
 	change->data.snapshot = snap;
 	change->action = REORDER_BUFFER_CHANGE_INTERNAL_SNAPSHOT;
 
 	ReorderBufferQueueChange(rb, xid, lsn, change, false);
+
+	/* the base snapshot no longer describes the catalog for later changes */
+	txn = ReorderBufferTXNByXid(rb, xid, true, NULL, lsn, true);
+	txn->txn_flags |= RBTXN_HAS_NEW_SNAPSHOT;
+	if (txn->toptxn != NULL)
+		txn->toptxn->txn_flags |= RBTXN_HAS_NEW_SNAPSHOT;
 }
 
 /*
@@ -3339,6 +3350,40 @@ ReorderBufferXidHasCatalogChanges(ReorderBuffer *rb, TransactionId xid)
 	return rbtxn_has_catalog_changes(txn);
 }
 
+/*
+ * Get the catalog snapshot against which to decide whether a change of the
+ * given txn/subtxn may be filtered away before it's queued, or NULL if it
+ * must not be.
+ *
+ * That is the transaction's base snapshot, which replay uses for the change
+ * unless a newer catalog snapshot has been queued in between.  So this is
+ * NULL once one has been, and also once the transaction is known to have
+ * catalog changes of its own, which no queued snapshot reflects yet.  It's
+ * also NULL while the change is incomplete (for a toasted tuple, or a
+ * speculative insertion), so that the change which completes it gets queued
+ * and the transaction can still be streamed.
+ */
+Snapshot
+ReorderBufferXidGetFilterSnapshot(ReorderBuffer *rb, TransactionId xid)
+{
+	ReorderBufferTXN *txn;
+
+	txn = ReorderBufferTXNByXid(rb, xid, false, NULL, InvalidXLogRecPtr,
+								false);
+	if (txn == NULL || rbtxn_has_new_snapshot(txn))
+		return NULL;
+
+	/* the rest is tracked by the toplevel txn */
+	if (txn->toptxn != NULL)
+		txn = txn->toptxn;
+
+	if (rbtxn_has_catalog_changes(txn) || rbtxn_has_partial_change(txn) ||
+		rbtxn_has_new_snapshot(txn))
+		return NULL;
+
+	return txn->base_snapshot;
+}
+
 /*
  * ReorderBufferXidHasBaseSnapshot
  *		Have we already set the base snapshot for the given txn/subtxn?
@@ -607,6 +607,50 @@ slot_fill_defaults(LogicalRepRelMapEntry *rel, EState *estate,
 			ExecEvalExpr(defexprs[i], econtext, &slot->tts_isnull[defmap[i]]);
 }
 
+/*
+ * Get the input function of local attribute "i" of "rel", or its receive
+ * function if "binary", along with the type's I/O parameter.
+ *
+ * The functions are looked up once per relation map entry, rather than for
+ * every column value applied, and keep their fn_extra caches across rows.
+ */
+static FmgrInfo *
+logicalrep_attr_input_func(LogicalRepRelMapEntry *rel, Form_pg_attribute att,
+						   int i, bool binary, Oid *typioparam)
+{
+	FmgrInfo  **funcs = binary ? &rel->attrecvfuncs : &rel->attinfuncs;
+	int			natts = rel->attrmap->maplen;
+
+	if (rel->attfuncscxt == NULL)
+	{
+		rel->attfuncscxt =
+			AllocSetContextCreate(GetMemoryChunkContext(rel->attrmap),
+								  "logical replication attribute functions",
+								  ALLOCSET_SMALL_SIZES);
+		rel->atttypioparams = (Oid *)
+			MemoryContextAlloc(rel->attfuncscxt, natts * sizeof(Oid));
+	}
+
+	if (*funcs == NULL)
+		*funcs = (FmgrInfo *)
+			MemoryContextAllocZero(rel->attfuncscxt, natts * sizeof(FmgrInfo));
+
+	if (!OidIsValid((*funcs)[i].fn_oid))
+	{
+		Oid			func;
+
+		if (binary)
+			getTypeBinaryInputInfo(att->atttypid, &func,
+								   &rel->atttypioparams[i]);
+		else
+			getTypeInputInfo(att->atttypid, &func, &rel->atttypioparams[i]);
+		fmgr_info_cxt(func, &(*funcs)[i], rel->attfuncscxt);
+	}
+
+	*typioparam = rel->atttypioparams[i];
+	return &(*funcs)[i];
+}
+
 /*
  * Store tuple data into slot.
  *
@@ -639,18 +683,19 @@ slot_store_data(TupleTableSlot *slot, LogicalRepRelMapEntry *rel,
 
 			if (tupleData->colstatus[remoteattnum] == LOGICALREP_COLUMN_TEXT)
 			{
-				Oid			typinput;
+				FmgrInfo   *flinfo;
 				Oid			typioparam;
 
-				getTypeInputInfo(att->atttypid, &typinput, &typioparam);
+				flinfo = logicalrep_attr_input_func(rel, att, i, false,
+													&typioparam);
 				slot->tts_values[i] =
-					OidInputFunctionCall(typinput, colvalue->data,
-										 typioparam, att->atttypmod);
+					InputFunctionCall(flinfo, colvalue->data,
+									  typioparam, att->atttypmod);
 				slot->tts_isnull[i] = false;
 			}
 			else if (tupleData->colstatus[remoteattnum] == LOGICALREP_COLUMN_BINARY)
 			{
-				Oid			typreceive;
+				FmgrInfo   *flinfo;
 				Oid			typioparam;
 
 				/*
@@ -659,10 +704,11 @@ slot_store_data(TupleTableSlot *slot, LogicalRepRelMapEntry *rel,
 				 */
 				colvalue->cursor = 0;
 
-				getTypeBinaryInputInfo(att->atttypid, &typreceive, &typioparam);
+				flinfo = logicalrep_attr_input_func(rel, att, i, true,
+													&typioparam);
 				slot->tts_values[i] =
-					OidReceiveFunctionCall(typreceive, colvalue,
-										   typioparam, att->atttypmod);
+					ReceiveFunctionCall(flinfo, colvalue,
+										typioparam, att->atttypmod);
 
 				/* Trouble if it didn't eat the whole buffer */
 				if (colvalue->cursor != colvalue->len)
@@ -754,18 +800,19 @@ slot_modify_data(TupleTableSlot *slot, TupleTableSlot *srcslot,
 
 			if (tupleData->colstatus[remoteattnum] == LOGICALREP_COLUMN_TEXT)
 			{
-				Oid			typinput;
+				FmgrInfo   *flinfo;
 				Oid			typioparam;
 
-				getTypeInputInfo(att->atttypid, &typinput, &typioparam);
+				flinfo = logicalrep_attr_input_func(rel, att, i, false,
+													&typioparam);
 				slot->tts_values[i] =
-					OidInputFunctionCall(typinput, colvalue->data,
-										 typioparam, att->atttypmod);
+					InputFunctionCall(flinfo, colvalue->data,
+									  typioparam, att->atttypmod);
 				slot->tts_isnull[i] = false;
 			}
 			else if (tupleData->colstatus[remoteattnum] == LOGICALREP_COLUMN_BINARY)
 			{
-				Oid			typreceive;
+				FmgrInfo   *flinfo;
 				Oid			typioparam;
 
 				/*
@@ -774,10 +821,11 @@ slot_modify_data(TupleTableSlot *slot, TupleTableSlot *srcslot,
 				 */
 				colvalue->cursor = 0;
 
-				getTypeBinaryInputInfo(att->atttypid, &typreceive, &typioparam);
+				flinfo = logicalrep_attr_input_func(rel, att, i, true,
+													&typioparam);
 				slot->tts_values[i] =
-					OidReceiveFunctionCall(typreceive, colvalue,
-										   typioparam, att->atttypmod);
+					ReceiveFunctionCall(flinfo, colvalue,
+										typioparam, att->atttypmod);
 
 				/* Trouble if it didn't eat the whole buffer */
 				if (colvalue->cursor != colvalue->len)
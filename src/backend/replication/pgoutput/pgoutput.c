@@ -56,6 +56,9 @@ static void pgoutput_message(LogicalDecodingContext *ctx,
 							 Size sz, const char *message);
 static bool pgoutput_origin_filter(LogicalDecodingContext *ctx,
 								   RepOriginId origin_id);
+static bool pgoutput_relation_filter(LogicalDecodingContext *ctx,
+									 Relation relation,
+									 ReorderBufferChangeType action);
 static void pgoutput_begin_prepare_txn(LogicalDecodingContext *ctx,
 									   ReorderBufferTXN *txn);
 static void pgoutput_prepare_txn(LogicalDecodingContext *ctx,
@@ -263,6 +266,7 @@ _PG_output_plugin_init(OutputPluginCallbacks *cb)
 	cb->commit_prepared_cb = pgoutput_commit_prepared_txn;
 	cb->rollback_prepared_cb = pgoutput_rollback_prepared_txn;
 	cb->filter_by_origin_cb = pgoutput_origin_filter;
+	cb->filter_by_relation_cb = pgoutput_relation_filter;
 	cb->shutdown_cb = pgoutput_shutdown;
 
 	/* transaction streaming */
@@ -1715,6 +1719,36 @@ pgoutput_origin_filter(LogicalDecodingContext *ctx,
 	return false;
 }
 
+/*
+ * Skip changes of tables whose publications don't publish the action, as
+ * pgoutput_change would.  Row filters need the tuple, so they are still
+ * evaluated there.
+ */
+static bool
+pgoutput_relation_filter(LogicalDecodingContext *ctx, Relation relation,
+						 ReorderBufferChangeType action)
+{
+	PGOutputData *data = (PGOutputData *) ctx->output_plugin_private;
+	RelationSyncEntry *relentry;
+
+	if (!is_publishable_relation(relation))
+		return true;
+
+	relentry = get_rel_sync_entry(data, relation);
+
+	switch (action)
+	{
+		case REORDER_BUFFER_CHANGE_INSERT:
+			return !relentry->pubactions.pubinsert;
+		case REORDER_BUFFER_CHANGE_UPDATE:
+			return !relentry->pubactions.pubupdate;
+		case REORDER_BUFFER_CHANGE_DELETE:
+			return !relentry->pubactions.pubdelete;
+		default:
+			return false;
+	}
+}
+
 /*
  * Shutdown the output plugin.
  *
@@ -101,6 +101,11 @@ static void SyncRepQueueInsert(int mode);
 static void SyncRepCancelWait(void);
 static int	SyncRepWakeQueue(bool all, int mode);
 
+/* weight of the averages used by SyncRepGroupCommitDelay */
+#define SYNC_REP_AVERAGE_WEIGHT		8
+/* upper limit of the adaptive commit delay, the same as for commit_delay */
+#define SYNC_REP_MAX_COMMIT_DELAY	100000
+
 static bool SyncRepGetSyncRecPtr(XLogRecPtr *writePtr,
 								 XLogRecPtr *flushPtr,
 								 XLogRecPtr *applyPtr,
@@ -532,12 +537,74 @@ SyncRepReleaseWaiters(void)
 
 	LWLockRelease(SyncRepLock);
 
+	/* feed the group size average, see SyncRepGroupCommitDelay */
+	if (numflush > 0)
+	{
+		uint32		size = pg_atomic_read_u32(&WalSndCtl->flushAckGroupSize);
+
+		size += (numflush * SYNC_REP_GROUP_SIZE_SCALE - (int64) size) /
+			SYNC_REP_AVERAGE_WEIGHT;
+		pg_atomic_write_u32(&WalSndCtl->flushAckGroupSize, size);
+	}
+
 	elog(DEBUG3, "released %d procs up to write %X/%X, %d procs up to flush %X/%X, %d procs up to apply %X/%X",
 		 numwrite, LSN_FORMAT_ARGS(writePtr),
 		 numflush, LSN_FORMAT_ARGS(flushPtr),
 		 numapply, LSN_FORMAT_ARGS(applyPtr));
 }
 
+/*
+ * Feed the flush acknowledgment latency average with the flush lag just
+ * measured by a walsender of a sync standby.
+ */
+void
+SyncRepReportFlushLag(TimeOffset flushLag)
+{
+	uint64		latency = pg_atomic_read_u64(&WalSndCtl->flushAckLatency);
+
+	if (latency == 0)
+		latency = flushLag;
+	else
+		latency += (flushLag - (int64) latency) / SYNC_REP_AVERAGE_WEIGHT;
+	pg_atomic_write_u64(&WalSndCtl->flushAckLatency, latency);
+}
+
+/*
+ * Return the adaptive commit delay in microseconds, at most max_delay if
+ * that's positive.  siblings is commit_siblings.
+ *
+ * A committing backend that finds the WAL flushed by someone else waits for
+ * the next confirmation of a sync standby, so if a transaction commits just
+ * after a flush, it waits for almost two round trips.  Holding the flush a
+ * little lets such transactions ride along with the one confirmation.  This
+ * pays off if commits arrive often compared to the round trip, which we
+ * estimate from the number of backends the recent confirmations released.
+ * The delay grows with that number, up to half the recent round trip time:
+ * with R the round trip and g the group size, R / 2 * g / (g + siblings).
+ */
+int
+SyncRepGroupCommitDelay(int max_delay, int siblings)
+{
+	uint64		latency;
+	uint64		size;
+	uint64		delay;
+
+	if (!SyncRepRequested() ||
+		!((volatile WalSndCtlData *) WalSndCtl)->sync_standbys_defined)
+		return 0;
+
+	latency = pg_atomic_read_u64(&WalSndCtl->flushAckLatency);
+	size = pg_atomic_read_u32(&WalSndCtl->flushAckGroupSize);
+	if (latency == 0 || size == 0)
+		return 0;
+
+	delay = latency / 2 * size /
+		(size + (uint64) siblings * SYNC_REP_GROUP_SIZE_SCALE);
+	if (max_delay > 0)
+		delay = Min(delay, max_delay);
+	return (int) Min(delay, SYNC_REP_MAX_COMMIT_DELAY);
+}
+
 /*
  * Calculate the synced Write, Flush and Apply positions among sync standbys.
  *
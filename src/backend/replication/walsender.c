@@ -177,6 +177,15 @@ static TimestampTz last_reply_timestamp = 0;
 /* Have we sent a heartbeat message asking for reply, since last reply? */
 static bool waiting_for_ping_response = false;
 
+/*
+ * While ProcessRepliesIfAny() works through the messages that have arrived,
+ * the effects of the standby's replies on waiting backends and on the slot
+ * are only remembered here, and applied once for the last reply.
+ */
+static bool replies_batched = false;
+static bool reply_release_pending = false;
+static XLogRecPtr reply_release_flushPtr = InvalidXLogRecPtr;
+
 /*
  * While streaming WAL in Copy mode, streamingDoneSending is set to true
  * after we have sent CopyDone. We should not send any more CopyData messages
@@ -213,15 +222,27 @@ typedef struct
 /* The size of our buffer of time samples. */
 #define LAG_TRACKER_BUFFER_SIZE 8192
 
-/* A mechanism for tracking replication lag. */
+/* The read position of one standby in a lag tracker buffer. */
 typedef struct
+{
+	int			read_heads[NUM_SYNC_REP_WAIT_MODE];
+	WalTimeSample last_read[NUM_SYNC_REP_WAIT_MODE];
+} LagTrackerReader;
+
+/*
+ * A mechanism for tracking replication lag.  The samples of the WAL sent are
+ * shared by the readers, one per standby fed by this process: a walsender
+ * has a single one, the walproposer one per safekeeper.  A tracker is local
+ * to the process, so it needs no locking.
+ */
+struct LagTracker
 {
 	XLogRecPtr	last_lsn;
 	WalTimeSample buffer[LAG_TRACKER_BUFFER_SIZE];
 	int			write_head;
-	int			read_heads[NUM_SYNC_REP_WAIT_MODE];
-	WalTimeSample last_read[NUM_SYNC_REP_WAIT_MODE];
-} LagTracker;
+	int			nreaders;
+	LagTrackerReader readers[FLEXIBLE_ARRAY_MEMBER];
+};
 
 static LagTracker *lag_tracker;
 
@@ -246,6 +267,7 @@ static void StartReplication(StartReplicationCmd *cmd);
 static void StartLogicalReplication(StartReplicationCmd *cmd);
 static void ProcessStandbyMessage(void);
 static void ProcessStandbyReplyMessage(void);
+static void ProcessStandbyReplyRelease(XLogRecPtr flushPtr);
 static void ProcessStandbyHSFeedbackMessage(void);
 static void ProcessRepliesIfAny(void);
 static void ProcessPendingWrites(void);
@@ -260,6 +282,7 @@ static void WalSndUpdateProgress(LogicalDecodingContext *ctx, XLogRecPtr lsn, Tr
 								 bool skipped_xact);
 static XLogRecPtr WalSndWaitForWal(XLogRecPtr loc);
 static bool TransactionIdInRecentPast(TransactionId xid, uint32 epoch);
+static void LagTrackerCompact(LagTracker *tracker);
 
 static void WalSndSegmentOpen(XLogReaderState *state, XLogSegNo nextSegNo,
 							  TimeLineID *tli_p);
@@ -305,7 +328,7 @@ InitWalSender(void)
 	}
 
 	/* Initialize empty timestamp buffer for lag tracking. */
-	lag_tracker = MemoryContextAllocZero(TopMemoryContext, sizeof(LagTracker));
+	lag_tracker = LagTrackerCreate(1);
 }
 
 /*
@@ -331,6 +354,8 @@ WalSndErrorCleanup(void)
 	ReplicationSlotCleanup();
 
 	replication_active = false;
+	replies_batched = false;
+	reply_release_pending = false;
 
 	/*
 	 * If there is a transaction in progress, it will clean up our
@@ -1909,6 +1934,13 @@ ProcessRepliesIfAny(void)
 
 	last_processing = GetCurrentTimestamp();
 
+	/*
+	 * A standby that is busy confirming flushes may have sent many replies
+	 * since we last looked, all but the newest of which are stale by now.
+	 * Don't take SyncRepLock and update the slot for each of them.
+	 */
+	replies_batched = true;
+
 	/*
 	 * If we already received a CopyDone from the frontend, any subsequent
 	 * message is the beginning of a new command, and should be processed in
@@ -1999,6 +2031,13 @@ ProcessRepliesIfAny(void)
 		}
 	}
 
+	replies_batched = false;
+	if (reply_release_pending)
+	{
+		reply_release_pending = false;
+		ProcessStandbyReplyRelease(reply_release_flushPtr);
+	}
+
 	/*
 	 * Save the last reply timestamp if we've received at least one reply.
 	 */
@@ -2141,6 +2180,9 @@ ProcessStandbyReply(XLogRecPtr	writePtr,
 	flushLag = LagTrackerRead(SYNC_REP_WAIT_FLUSH, flushPtr, now);
 	applyLag = LagTrackerRead(SYNC_REP_WAIT_APPLY, applyPtr, now);
 
+	if (flushLag != -1 && MyWalSnd->sync_standby_priority > 0)
+		SyncRepReportFlushLag(flushLag);
+
 	/*
 	 * If the standby reports that it has fully replayed the WAL in two
 	 * consecutive reply messages, then the second such message must result
@@ -2184,6 +2226,24 @@ ProcessStandbyReply(XLogRecPtr	writePtr,
 		SpinLockRelease(&walsnd->mutex);
 	}
 
+	if (replies_batched)
+	{
+		/* confirm the furthest position, as handling each reply would */
+		if (!reply_release_pending || flushPtr > reply_release_flushPtr)
+			reply_release_flushPtr = flushPtr;
+		reply_release_pending = true;
+	}
+	else
+		ProcessStandbyReplyRelease(flushPtr);
+}
+
+/*
+ * Act on the positions of the latest reply from the standby, which have
+ * already been stored in MyWalSnd.
+ */
+static void
+ProcessStandbyReplyRelease(XLogRecPtr flushPtr)
+{
 	if (!am_cascading_walsender)
 		SyncRepReleaseWaiters();
 
@@ -3324,6 +3384,8 @@ WalSndShmemInit(void)
 
 		for (i = 0; i < NUM_SYNC_REP_WAIT_MODE; i++)
 			SHMQueueInit(&(WalSndCtl->SyncRepQueue[i]));
+		pg_atomic_init_u64(&WalSndCtl->flushAckLatency, 0);
+		pg_atomic_init_u32(&WalSndCtl->flushAckGroupSize, 0);
 
 		for (i = 0; i < max_wal_senders; i++)
 		{
@@ -3730,62 +3792,150 @@ WalSndKeepaliveIfNecessary(void)
 	}
 }
 
+/*
+ * Create a lag tracker for 'nreaders' standbys, in TopMemoryContext.
+ */
+LagTracker *
+LagTrackerCreate(int nreaders)
+{
+	LagTracker *tracker;
+
+	Assert(nreaders > 0);
+
+	tracker = MemoryContextAllocZero(TopMemoryContext,
+									 offsetof(LagTracker, readers) +
+									 nreaders * sizeof(LagTrackerReader));
+	tracker->nreaders = nreaders;
+
+	return tracker;
+}
+
 /*
  * Record the end of the WAL and the time it was flushed locally, so that
- * LagTrackerRead can compute the elapsed time (lag) when this WAL location is
- * eventually reported to have been written, flushed and applied by the
- * standby in a reply message.
+ * LagTrackerReadSample can compute the elapsed time (lag) when this WAL
+ * location is eventually reported to have been written, flushed and applied
+ * by a standby in a reply message.
  */
 void
-LagTrackerWrite(XLogRecPtr lsn, TimestampTz local_flush_time)
+LagTrackerWriteSample(LagTracker *tracker, XLogRecPtr lsn,
+					  TimestampTz local_flush_time)
 {
-	bool		buffer_full;
+	bool		buffer_full = false;
 	int			new_write_head;
-	int			i;
-
-	if (!am_walsender)
-		return;
 
 	/*
 	 * If the lsn hasn't advanced since last time, then do nothing.  This way
 	 * we only record a new sample when new WAL has been written.
 	 */
-	if (lag_tracker->last_lsn == lsn)
+	if (tracker->last_lsn == lsn)
 		return;
-	lag_tracker->last_lsn = lsn;
+	tracker->last_lsn = lsn;
 
 	/*
 	 * If advancing the write head of the circular buffer would crash into any
 	 * of the read heads, then the buffer is full.  In other words, the
-	 * slowest reader (presumably apply) is the one that controls the release
-	 * of space.
+	 * slowest reader (presumably apply of the slowest standby) is the one
+	 * that controls the release of space.  Make room by halving the sampling
+	 * rate of the samples not yet read by everyone.
 	 */
-	new_write_head = (lag_tracker->write_head + 1) % LAG_TRACKER_BUFFER_SIZE;
-	buffer_full = false;
-	for (i = 0; i < NUM_SYNC_REP_WAIT_MODE; ++i)
+	new_write_head = (tracker->write_head + 1) % LAG_TRACKER_BUFFER_SIZE;
+	for (int r = 0; r < tracker->nreaders && !buffer_full; r++)
 	{
-		if (new_write_head == lag_tracker->read_heads[i])
-			buffer_full = true;
+		for (int i = 0; i < NUM_SYNC_REP_WAIT_MODE; ++i)
+		{
+			if (new_write_head == tracker->readers[r].read_heads[i])
+			{
+				buffer_full = true;
+				break;
+			}
+		}
 	}
 
-	/*
-	 * If the buffer is full, for now we just rewind by one slot and overwrite
-	 * the last sample, as a simple (if somewhat uneven) way to lower the
-	 * sampling rate.  There may be better adaptive compaction algorithms.
-	 */
 	if (buffer_full)
 	{
-		new_write_head = lag_tracker->write_head;
-		if (lag_tracker->write_head > 0)
-			lag_tracker->write_head--;
-		else
-			lag_tracker->write_head = LAG_TRACKER_BUFFER_SIZE - 1;
+		LagTrackerCompact(tracker);
+		new_write_head = (tracker->write_head + 1) % LAG_TRACKER_BUFFER_SIZE;
 	}
 
 	/* Store a sample at the current write head position. */
-	lag_tracker->buffer[lag_tracker->write_head].lsn = lsn;
-	lag_tracker->buffer[lag_tracker->write_head].time = local_flush_time;
-	lag_tracker->write_head = new_write_head;
+	tracker->buffer[tracker->write_head].lsn = lsn;
+	tracker->buffer[tracker->write_head].time = local_flush_time;
+	tracker->write_head = new_write_head;
+}
+
+/*
+ * Drop every other sample of a full lag tracker buffer, counting back from
+ * the newest one, which is always kept.  Each read head moves to the first
+ * kept sample at or after the one it pointed to, so a reader just sees a
+ * lower sampling rate for the part of the WAL it hasn't caught up with.
+ * Compared to overwriting the newest sample over and over, this keeps the
+ * samples evenly spread over the unread WAL.
+ */
+static void
+LagTrackerCompact(LagTracker *tracker)
+{
+	int			oldest = tracker->write_head;
+	int			nsamples = 0;
+	int			parity;
+	int			nkept;
+
+	/* The slowest read head points to the oldest sample still needed. */
+	for (int r = 0; r < tracker->nreaders; r++)
+	{
+		for (int i = 0; i < NUM_SYNC_REP_WAIT_MODE; ++i)
+		{
+			int			head = tracker->readers[r].read_heads[i];
+			int			distance;
+
+			distance = (tracker->write_head - head + LAG_TRACKER_BUFFER_SIZE) %
+				LAG_TRACKER_BUFFER_SIZE;
+			if (distance > nsamples)
+			{
+				nsamples = distance;
+				oldest = head;
+			}
+		}
+	}
+
+	if (nsamples < 2)
+		return;
+
+	/* keep the samples at the offsets from 'oldest' having this parity */
+	parity = (nsamples - 1) % 2;
+	nkept = (nsamples + 1 - parity) / 2;
+
+	for (int j = 0; j < nkept; j++)
+		tracker->buffer[(oldest + j) % LAG_TRACKER_BUFFER_SIZE] =
+			tracker->buffer[(oldest + parity + 2 * j) % LAG_TRACKER_BUFFER_SIZE];
+
+	for (int r = 0; r < tracker->nreaders; r++)
+	{
+		for (int i = 0; i < NUM_SYNC_REP_WAIT_MODE; ++i)
+		{
+			int		   *head = &tracker->readers[r].read_heads[i];
+			int			offset;
+
+			offset = (*head - oldest + LAG_TRACKER_BUFFER_SIZE) %
+				LAG_TRACKER_BUFFER_SIZE;
+			if (offset % 2 != parity)
+				offset++;
+			*head = (oldest + (offset - parity) / 2) % LAG_TRACKER_BUFFER_SIZE;
+		}
+	}
+
+	tracker->write_head = (oldest + nkept) % LAG_TRACKER_BUFFER_SIZE;
+}
+
+/*
+ * LagTrackerWriteSample for the walsender's own lag tracker.
+ */
+void
+LagTrackerWrite(XLogRecPtr lsn, TimestampTz local_flush_time)
+{
+	if (!am_walsender)
+		return;
+
+	LagTrackerWriteSample(lag_tracker, lsn, local_flush_time);
 }
 
 /*
@@ -3794,27 +3944,33 @@ LagTrackerWrite(XLogRecPtr lsn, TimestampTz local_flush_time)
  * We have a separate read head for each of the reported LSN locations we
  * receive in replies from standby; 'head' controls which read head is
  * used.  Whenever a read head crosses an LSN which was written into the
- * lag buffer with LagTrackerWrite, we can use the associated timestamp to
+ * lag buffer with LagTrackerWriteSample, we can use the associated timestamp to
  * find out the time this LSN (or an earlier one) was flushed locally, and
  * therefore compute the lag.
  *
+ * Each standby fed from the tracker reads it as its own 'reader'.
+ *
  * Return -1 if no new sample data is available, and otherwise the elapsed
  * time in microseconds.
  */
 TimeOffset
-LagTrackerRead(int head, XLogRecPtr lsn, TimestampTz now)
+LagTrackerReadSample(LagTracker *tracker, int reader, int head,
+					 XLogRecPtr lsn, TimestampTz now)
 {
+	LagTrackerReader *rd = &tracker->readers[reader];
 	TimestampTz time = 0;
 
+	Assert(reader >= 0 && reader < tracker->nreaders);
+
 	/* Read all unread samples up to this LSN or end of buffer. */
-	while (lag_tracker->read_heads[head] != lag_tracker->write_head &&
-		   lag_tracker->buffer[lag_tracker->read_heads[head]].lsn <= lsn)
+	while (rd->read_heads[head] != tracker->write_head &&
+		   tracker->buffer[rd->read_heads[head]].lsn <= lsn)
 	{
-		time = lag_tracker->buffer[lag_tracker->read_heads[head]].time;
-		lag_tracker->last_read[head] =
-			lag_tracker->buffer[lag_tracker->read_heads[head]];
-		lag_tracker->read_heads[head] =
-			(lag_tracker->read_heads[head] + 1) % LAG_TRACKER_BUFFER_SIZE;
+		time = tracker->buffer[rd->read_heads[head]].time;
+		rd->last_read[head] =
+			tracker->buffer[rd->read_heads[head]];
+		rd->read_heads[head] =
+			(rd->read_heads[head] + 1) % LAG_TRACKER_BUFFER_SIZE;
 	}
 
 	/*
@@ -3824,8 +3980,8 @@ LagTrackerRead(int head, XLogRecPtr lsn, TimestampTz now)
 	 * interpolation at the beginning of the next burst of WAL after a period
 	 * of idleness.
 	 */
-	if (lag_tracker->read_heads[head] == lag_tracker->write_head)
-		lag_tracker->last_read[head].time = 0;
+	if (rd->read_heads[head] == tracker->write_head)
+		rd->last_read[head].time = 0;
 
 	if (time > now)
 	{
@@ -3843,17 +3999,17 @@ LagTrackerRead(int head, XLogRecPtr lsn, TimestampTz now)
 		 * eventually start moving again and cross one of our samples before
 		 * we can show the lag increasing.
 		 */
-		if (lag_tracker->read_heads[head] == lag_tracker->write_head)
+		if (rd->read_heads[head] == tracker->write_head)
 		{
 			/* There are no future samples, so we can't interpolate. */
 			return -1;
 		}
-		else if (lag_tracker->last_read[head].time != 0)
+		else if (rd->last_read[head].time != 0)
 		{
 			/* We can interpolate between last_read and the next sample. */
 			double		fraction;
-			WalTimeSample prev = lag_tracker->last_read[head];
-			WalTimeSample next = lag_tracker->buffer[lag_tracker->read_heads[head]];
+			WalTimeSample prev = rd->last_read[head];
+			WalTimeSample next = tracker->buffer[rd->read_heads[head]];
 
 			if (lsn < prev.lsn)
 			{
@@ -3890,7 +4046,7 @@ LagTrackerRead(int head, XLogRecPtr lsn, TimestampTz now)
 			 * standby reaches the future sample the best we can do is report
 			 * the hypothetical lag if that sample were to be replayed now.
 			 */
-			time = lag_tracker->buffer[lag_tracker->read_heads[head]].time;
+			time = tracker->buffer[rd->read_heads[head]].time;
 		}
 	}
 
@@ -3898,3 +4054,12 @@ LagTrackerRead(int head, XLogRecPtr lsn, TimestampTz now)
 	Assert(time != 0);
 	return now - time;
 }
+
+/*
+ * LagTrackerRead for the walsender's own lag tracker.
+ */
+TimeOffset
+LagTrackerRead(int head, XLogRecPtr lsn, TimestampTz now)
+{
+	return LagTrackerReadSample(lag_tracker, 0, head, lsn, now);
+}
@@ -33,6 +33,14 @@ CkptSortItem *CkptBufferIds;
 Buffer		wal_redo_buffer;
 bool		am_wal_redo_postgres = false;
 
+/*
+ * Buffers with the target pages of a batch of WAL redo requests.  A redo
+ * process that reconstructs several pages at a time keeps all of them
+ * resident, protected from eviction like wal_redo_buffer.
+ */
+Buffer		wal_redo_buffers[MAX_WAL_REDO_BUFFERS];
+int			num_wal_redo_buffers = 0;
+
 /*
  * Data Structures:
  *		buffers live in a freelist and a lookup data structure.
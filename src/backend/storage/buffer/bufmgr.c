@@ -39,6 +39,7 @@
 #include "catalog/catalog.h"
 #include "catalog/storage.h"
 #include "catalog/storage_xlog.h"
+#include "common/hashfn.h"
 #include "executor/instrument.h"
 #include "lib/binaryheap.h"
 #include "miscadmin.h"
@@ -47,7 +48,9 @@
 #include "postmaster/bgwriter.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
+#include "storage/bufsim.h"
 #include "storage/ipc.h"
+#include "storage/prefetch.h"
 #include "storage/proc.h"
 #include "storage/smgr.h"
 #include "storage/standby.h"
@@ -81,6 +84,31 @@
  */
 #define BUF_DROP_FULL_SCAN_THRESHOLD		(uint64) (NBuffers / 32)
 
+/* Maximum factor by which BgBufferSync cleans ahead of its estimate */
+#define BGW_MAX_LRU_BOOST			8.0
+
+/*
+ * Set of relfilenodes whose buffers are being dropped, looked up for every
+ * buffer when DropRelFileNodesAllBuffers has to scan the whole buffer pool.
+ */
+typedef struct RelFileNodeSetEntry
+{
+	RelFileNode rnode;
+	char		status;			/* for simplehash */
+} RelFileNodeSetEntry;
+
+#define SH_PREFIX		rnodeset
+#define SH_ELEMENT_TYPE	RelFileNodeSetEntry
+#define SH_KEY_TYPE		RelFileNode
+#define SH_KEY			rnode
+#define SH_HASH_KEY(tb, key) \
+	hash_bytes((const unsigned char *) &(key), sizeof(RelFileNode))
+#define SH_EQUAL(tb, a, b)	RelFileNodeEquals(a, b)
+#define SH_SCOPE		static inline
+#define SH_DECLARE
+#define SH_DEFINE
+#include "lib/simplehash.h"
+
 typedef struct PrivateRefCountEntry
 {
 	Buffer		buffer;
@@ -163,9 +191,22 @@ int			backend_flush_after = 0;
 /* Evict unpinned pages (for better test coverage) */
 bool		zenith_test_evict = false;
 
-/* local state for StartBufferIO and related functions */
-static BufferDesc *InProgressBuf = NULL;
-static bool IsForInput;
+/*
+ * local state for StartBufferIO and related functions
+ *
+ * ReadBuffers() keeps I/O in progress on a whole run of buffers while it
+ * reads them with a single smgrreadv(), and allocating the next buffer of
+ * the run may need to write out a dirty victim meanwhile.  So we have to
+ * track more than one in-progress buffer at a time.
+ */
+typedef struct InProgressIO
+{
+	BufferDesc *buf;
+	bool		forInput;
+} InProgressIO;
+
+static InProgressIO InProgressBufs[MAX_BUFFERS_PER_READ + 1];
+static int	NInProgressBufs = 0;
 
 /* local state for LockBufferForCleanup */
 static BufferDesc *PinCountWaitBuf = NULL;
@@ -466,7 +507,15 @@ ForgetPrivateRefCountEntry(PrivateRefCountEntry *ref)
 static Buffer ReadBuffer_common(SMgrRelation reln, char relpersistence,
 								ForkNumber forkNum, BlockNumber blockNum,
 								ReadBufferMode mode, BufferAccessStrategy strategy,
-								bool *hit);
+								bool started, bool *hit);
+static void ReadBufferVerifyPage(SMgrRelation smgr, ForkNumber forkNum,
+								 BlockNumber blockNum, Block bufBlock,
+								 ReadBufferMode mode);
+static int	ReadBuffers_common(SMgrRelation smgr, char relpersistence,
+							   ForkNumber forkNum, BlockNumber blockNum,
+							   int nblocks, Buffer *buffers,
+							   ReadBufferMode mode,
+							   BufferAccessStrategy strategy);
 static bool PinBuffer(BufferDesc *buf, BufferAccessStrategy strategy);
 static void PinBuffer_Locked(BufferDesc *buf);
 static void UnpinBuffer(BufferDesc *buf, bool fixOwner);
@@ -503,14 +552,13 @@ static int	ts_ckpt_progress_comparator(Datum a, Datum b, void *arg);
 
 
 /*
- * Implementation of PrefetchBuffer() for shared buffers.
+ * Look up a block in the buffer pool, without pinning it.  Returns the
+ * buffer ID the block is in at the moment, or -1 if it isn't cached.
  */
-PrefetchBufferResult
-PrefetchSharedBuffer(SMgrRelation smgr_reln,
-					 ForkNumber forkNum,
-					 BlockNumber blockNum)
+static int
+LookupSharedBuffer(SMgrRelation smgr_reln, ForkNumber forkNum,
+				   BlockNumber blockNum)
 {
-	PrefetchBufferResult result = {InvalidBuffer, false};
 	BufferTag	newTag;			/* identity of requested block */
 	uint32		newHash;		/* hash value for newTag */
 	LWLock	   *newPartitionLock;	/* buffer partition lock for it */
@@ -531,6 +579,22 @@ PrefetchSharedBuffer(SMgrRelation smgr_reln,
 	buf_id = BufTableLookup(&newTag, newHash);
 	LWLockRelease(newPartitionLock);
 
+	return buf_id;
+}
+
+/*
+ * Implementation of PrefetchBuffer() for shared buffers.
+ */
+PrefetchBufferResult
+PrefetchSharedBuffer(SMgrRelation smgr_reln,
+					 ForkNumber forkNum,
+					 BlockNumber blockNum)
+{
+	PrefetchBufferResult result = {InvalidBuffer, false};
+	int			buf_id;
+
+	buf_id = LookupSharedBuffer(smgr_reln, forkNum, blockNum);
+
 	/* If not in buffers, initiate prefetch */
 	if (buf_id < 0)
 	{
@@ -616,6 +680,87 @@ PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
 	}
 }
 
+/*
+ * PrefetchBuffers -- initiate asynchronous reads of a set of blocks
+ *
+ * This is the batched form of PrefetchBuffer(): blocks that are already in
+ * shared buffers are skipped, and all the others are handed to the storage
+ * manager with smgrprefetchv(), so that it can pack many page requests into
+ * a single message.  The blocks need not be consecutive or sorted.
+ *
+ * Returns the number of blocks for which I/O was initiated.
+ */
+int
+PrefetchBuffers(Relation reln, ForkNumber forkNum, BlockNumber *blocks,
+				int nblocks)
+{
+	int			ninitiated = 0;
+
+	Assert(RelationIsValid(reln));
+
+	if (RelationUsesLocalBuffers(reln))
+	{
+		SMgrRelation smgr_reln;
+
+		/* see comments in ReadBufferExtended */
+		if (RELATION_IS_OTHER_TEMP(reln))
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("cannot access temporary tables of other sessions")));
+
+		/* local buffers gain nothing from batching; do them one by one */
+		smgr_reln = RelationGetSmgr(reln);
+		for (int i = 0; i < nblocks; i++)
+		{
+			Assert(BlockNumberIsValid(blocks[i]));
+			if (PrefetchLocalBuffer(smgr_reln, forkNum, blocks[i]).initiated_io)
+				ninitiated++;
+		}
+	}
+	else
+	{
+#ifdef USE_PREFETCH
+		SMgrRelation smgr_reln = RelationGetSmgr(reln);
+		BlockNumber misses[PREFETCH_BATCH_SIZE];
+		int			nmisses = 0;
+
+		for (int i = 0; i < nblocks; i++)
+		{
+			BufferTag	newTag;		/* identity of requested block */
+			uint32		newHash;	/* hash value for newTag */
+			LWLock	   *newPartitionLock;	/* buffer partition lock for it */
+			int			buf_id;
+
+			Assert(BlockNumberIsValid(blocks[i]));
+
+			/* see if the block is in the buffer pool already */
+			INIT_BUFFERTAG(newTag, smgr_reln->smgr_rnode.node,
+						   forkNum, blocks[i]);
+			newHash = BufTableHashCode(&newTag);
+			newPartitionLock = BufMappingPartitionLock(newHash);
+
+			LWLockAcquire(newPartitionLock, LW_SHARED);
+			buf_id = BufTableLookup(&newTag, newHash);
+			LWLockRelease(newPartitionLock);
+
+			if (buf_id >= 0)
+				continue;
+
+			misses[nmisses++] = blocks[i];
+			if (nmisses == PREFETCH_BATCH_SIZE)
+			{
+				ninitiated += smgrprefetchv(smgr_reln, forkNum, misses, nmisses);
+				nmisses = 0;
+			}
+		}
+
+		ninitiated += smgrprefetchv(smgr_reln, forkNum, misses, nmisses);
+#endif							/* USE_PREFETCH */
+	}
+
+	return ninitiated;
+}
+
 /*
  * ReadRecentBuffer -- try to pin a block in a recently observed buffer
  *
@@ -782,12 +927,141 @@ ReadBufferExtended(Relation reln, ForkNumber forkNum, BlockNumber blockNum,
 	 */
 	pgstat_count_buffer_read(reln);
 	buf = ReadBuffer_common(RelationGetSmgr(reln), reln->rd_rel->relpersistence,
-							forkNum, blockNum, mode, strategy, &hit);
+							forkNum, blockNum, mode, strategy, false, &hit);
+	if (hit)
+		pgstat_count_buffer_hit(reln);
+	return buf;
+}
+
+/*
+ * StartReadBuffer -- start reading a block of a relation, without waiting
+ *		for it
+ *
+ * This is the first half of ReadBufferExtended(): if the block is not
+ * cached, the storage manager is asked to start reading it, and *read is set
+ * up for WaitReadBuffer(), which returns the pinned buffer.  A caller can
+ * start several reads and do other work while they are in progress.  No
+ * buffer is pinned or allocated in between, so there is no limit on the
+ * number of outstanding reads, and it is fine to abandon one.  If another
+ * backend reads the block into shared buffers meanwhile, WaitReadBuffer()
+ * just uses that buffer.
+ *
+ * Only the modes that read existing pages are supported: RBM_NORMAL,
+ * RBM_NORMAL_NO_LOG and RBM_ZERO_ON_ERROR.  P_NEW is not allowed.
+ */
+void
+StartReadBuffer(PendingBufferRead *read, Relation reln, ForkNumber forkNum,
+				BlockNumber blockNum, ReadBufferMode mode,
+				BufferAccessStrategy strategy)
+{
+	Assert(BlockNumberIsValid(blockNum));
+	Assert(mode == RBM_NORMAL || mode == RBM_NORMAL_NO_LOG ||
+		   mode == RBM_ZERO_ON_ERROR);
+
+	/* see comments in ReadBufferExtended */
+	if (RELATION_IS_OTHER_TEMP(reln))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot access temporary tables of other sessions")));
+
+	read->rel = reln;
+	read->forkNum = forkNum;
+	read->blockNum = blockNum;
+	read->mode = mode;
+	read->strategy = strategy;
+	read->recent_buffer = InvalidBuffer;
+	read->started = false;
+
+	if (RelationUsesLocalBuffers(reln))
+	{
+		/* local buffers are read from local files, a prefetch will do */
+		read->recent_buffer =
+			PrefetchLocalBuffer(RelationGetSmgr(reln), forkNum,
+								blockNum).recent_buffer;
+	}
+	else
+	{
+		int			buf_id;
+
+		buf_id = LookupSharedBuffer(RelationGetSmgr(reln), forkNum, blockNum);
+		if (buf_id >= 0)
+			read->recent_buffer = buf_id + 1;
+		else
+			read->started = smgrstartread(RelationGetSmgr(reln), forkNum,
+										  blockNum);
+	}
+}
+
+/*
+ * WaitReadBuffer -- complete a read started by StartReadBuffer()
+ *
+ * Returns the pinned buffer containing the block, waiting for the read to
+ * complete if necessary.
+ */
+Buffer
+WaitReadBuffer(PendingBufferRead *read)
+{
+	Relation	reln = read->rel;
+	bool		hit;
+	Buffer		buf;
+
+	pgstat_count_buffer_read(reln);
+
+	/* the block was cached at the start, see if it still is */
+	if (BufferIsValid(read->recent_buffer) &&
+		ReadRecentBuffer(RelationGetSmgr(reln)->smgr_rnode.node,
+						 read->forkNum, read->blockNum, read->recent_buffer))
+	{
+		pgstat_count_buffer_hit(reln);
+		return read->recent_buffer;
+	}
+
+	buf = ReadBuffer_common(RelationGetSmgr(reln), reln->rd_rel->relpersistence,
+							read->forkNum, read->blockNum, read->mode,
+							read->strategy, read->started, &hit);
 	if (hit)
 		pgstat_count_buffer_hit(reln);
 	return buf;
 }
 
+/*
+ * ReadBuffers -- like ReadBufferExtended, but for a run of consecutive
+ *		blocks.
+ *
+ * On return, buffers[i] holds a pinned buffer containing block
+ * blockNum + i.  Blocks that are not already cached are fetched with as few
+ * smgrreadv() calls as possible, so that a storage manager supporting
+ * vectored reads can serve the whole run with a single request.
+ *
+ * Only the modes that read existing pages are supported: RBM_NORMAL,
+ * RBM_NORMAL_NO_LOG and RBM_ZERO_ON_ERROR.  P_NEW is not allowed, and
+ * nblocks must be between 1 and MAX_BUFFERS_PER_READ.
+ */
+void
+ReadBuffers(Relation reln, ForkNumber forkNum, BlockNumber blockNum,
+			int nblocks, Buffer *buffers, ReadBufferMode mode,
+			BufferAccessStrategy strategy)
+{
+	int			nhits;
+
+	/* see comments in ReadBufferExtended */
+	if (RELATION_IS_OTHER_TEMP(reln))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot access temporary tables of other sessions")));
+
+	nhits = ReadBuffers_common(RelationGetSmgr(reln),
+							   reln->rd_rel->relpersistence,
+							   forkNum, blockNum, nblocks, buffers,
+							   mode, strategy);
+
+	/* update pgstat counters to reflect the cache hits and misses */
+	for (int i = 0; i < nblocks; i++)
+		pgstat_count_buffer_read(reln);
+	for (int i = 0; i < nhits; i++)
+		pgstat_count_buffer_hit(reln);
+}
+
 
 /*
  * ReadBufferWithoutRelcache -- like ReadBufferExtended, but doesn't require
@@ -811,19 +1085,22 @@ ReadBufferWithoutRelcache(RelFileNode rnode, ForkNumber forkNum,
 
 	return ReadBuffer_common(smgr, permanent ? RELPERSISTENCE_PERMANENT :
 							 RELPERSISTENCE_UNLOGGED, forkNum, blockNum,
-							 mode, strategy, &hit);
+							 mode, strategy, false, &hit);
 }
 
 
 /*
  * ReadBuffer_common -- common logic for all ReadBuffer variants
  *
+ * If started is true, a read of the block was started with smgrstartread(),
+ * which is collected if the block has to be read.
+ *
  * *hit is set to true if the request was satisfied from shared buffer cache.
  */
 static Buffer
 ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 				  BlockNumber blockNum, ReadBufferMode mode,
-				  BufferAccessStrategy strategy, bool *hit)
+				  BufferAccessStrategy strategy, bool started, bool *hit)
 {
 	BufferDesc *bufHdr;
 	Block		bufBlock;
@@ -1030,36 +1307,23 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 			if (track_io_timing)
 				INSTR_TIME_SET_CURRENT(io_start);
 
-			smgrread(smgr, forkNum, blockNum, (char *) bufBlock);
+			if (started)
+				smgrwaitread(smgr, forkNum, blockNum, (char *) bufBlock);
+			else
+				smgrread(smgr, forkNum, blockNum, (char *) bufBlock);
 
 			if (track_io_timing)
 			{
 				INSTR_TIME_SET_CURRENT(io_time);
 				INSTR_TIME_SUBTRACT(io_time, io_start);
+				/* also the feedback for prefetch distance control */
+				PrefetchControlReportRead(io_time);
 				pgstat_count_buffer_read_time(INSTR_TIME_GET_MICROSEC(io_time));
 				INSTR_TIME_ADD(pgBufferUsage.blk_read_time, io_time);
 			}
 
 			/* check for garbage data */
-			if (!PageIsVerifiedExtended((Page) bufBlock, blockNum,
-										PIV_LOG_WARNING | PIV_REPORT_STAT))
-			{
-				if (mode == RBM_ZERO_ON_ERROR || zero_damaged_pages)
-				{
-					ereport(WARNING,
-							(errcode(ERRCODE_DATA_CORRUPTED),
-							 errmsg("invalid page in block %u of relation %s; zeroing out page",
-									blockNum,
-									relpath(smgr->smgr_rnode, forkNum))));
-					MemSet((char *) bufBlock, 0, BLCKSZ);
-				}
-				else
-					ereport(ERROR,
-							(errcode(ERRCODE_DATA_CORRUPTED),
-							 errmsg("invalid page in block %u of relation %s",
-									blockNum,
-									relpath(smgr->smgr_rnode, forkNum))));
-			}
+			ReadBufferVerifyPage(smgr, forkNum, blockNum, bufBlock, mode);
 		}
 	}
 
@@ -1108,6 +1372,198 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	return BufferDescriptorGetBuffer(bufHdr);
 }
 
+/*
+ * ReadBufferVerifyPage -- check a page just read in for garbage data
+ *
+ * Depending on mode and zero_damaged_pages, a damaged page is either zeroed
+ * out with a WARNING or reported with an ERROR.
+ */
+static void
+ReadBufferVerifyPage(SMgrRelation smgr, ForkNumber forkNum,
+					 BlockNumber blockNum, Block bufBlock,
+					 ReadBufferMode mode)
+{
+	if (!PageIsVerifiedExtended((Page) bufBlock, blockNum,
+								PIV_LOG_WARNING | PIV_REPORT_STAT))
+	{
+		if (mode == RBM_ZERO_ON_ERROR || zero_damaged_pages)
+		{
+			ereport(WARNING,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("invalid page in block %u of relation %s; zeroing out page",
+							blockNum,
+							relpath(smgr->smgr_rnode, forkNum))));
+			MemSet((char *) bufBlock, 0, BLCKSZ);
+		}
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("invalid page in block %u of relation %s",
+							blockNum,
+							relpath(smgr->smgr_rnode, forkNum))));
+	}
+}
+
+/*
+ * ReadBuffers_common -- read a run of consecutive blocks into buffers
+ *
+ * This is the multi-block counterpart of ReadBuffer_common, for the modes
+ * that actually read pages (RBM_NORMAL, RBM_NORMAL_NO_LOG and
+ * RBM_ZERO_ON_ERROR).  All buffers are pinned first; the ones that are not
+ * already cached are then filled with one smgrreadv() per run of
+ * consecutive misses.
+ *
+ * Returns the number of blocks that were satisfied from the buffer cache.
+ */
+static int
+ReadBuffers_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
+				   BlockNumber blockNum, int nblocks, Buffer *buffers,
+				   ReadBufferMode mode, BufferAccessStrategy strategy)
+{
+	BufferDesc *bufHdrs[MAX_BUFFERS_PER_READ];
+	bool		found[MAX_BUFFERS_PER_READ];
+	/* see ReadBuffer_common */
+	bool		isLocalBuf = SmgrIsTemp(smgr) || am_wal_redo_postgres;
+	int			nhits = 0;
+	int			i;
+
+	Assert(nblocks > 0 && nblocks <= MAX_BUFFERS_PER_READ);
+	Assert(BlockNumberIsValid(blockNum) &&
+		   BlockNumberIsValid(blockNum + nblocks - 1));
+	Assert(mode == RBM_NORMAL || mode == RBM_NORMAL_NO_LOG ||
+		   mode == RBM_ZERO_ON_ERROR);
+
+	/*
+	 * Look up or allocate all the buffers, in ascending block order.  For a
+	 * miss, BufferAlloc leaves IO_IN_PROGRESS set, which holds off other
+	 * backends until we have read the page.  A backend may thus wait for
+	 * I/O on a higher block while holding I/O on lower ones, but since every
+	 * reader acquires them in ascending order that cannot deadlock.
+	 */
+	for (i = 0; i < nblocks; i++)
+	{
+		/* Make sure we will have room to remember the buffer pin */
+		ResourceOwnerEnlargeBuffers(CurrentResourceOwner);
+
+		TRACE_POSTGRESQL_BUFFER_READ_START(forkNum, blockNum + i,
+										   smgr->smgr_rnode.node.spcNode,
+										   smgr->smgr_rnode.node.dbNode,
+										   smgr->smgr_rnode.node.relNode,
+										   smgr->smgr_rnode.backend,
+										   false);
+
+		if (isLocalBuf)
+		{
+			bufHdrs[i] = LocalBufferAlloc(smgr, forkNum, blockNum + i,
+										  &found[i]);
+			if (found[i])
+				pgBufferUsage.local_blks_hit++;
+			else
+				pgBufferUsage.local_blks_read++;
+		}
+		else
+		{
+			bufHdrs[i] = BufferAlloc(smgr, relpersistence, forkNum,
+									 blockNum + i, strategy, &found[i]);
+			if (found[i])
+				pgBufferUsage.shared_blks_hit++;
+			else
+				pgBufferUsage.shared_blks_read++;
+		}
+		buffers[i] = BufferDescriptorGetBuffer(bufHdrs[i]);
+	}
+
+	/* At this point we do NOT hold any locks. */
+
+	i = 0;
+	while (i < nblocks)
+	{
+		char	   *bufBlocks[MAX_BUFFERS_PER_READ];
+		instr_time	io_start,
+					io_time;
+		int			nread;
+
+		if (found[i])
+		{
+			nhits++;
+			VacuumPageHit++;
+			if (VacuumCostActive)
+				VacuumCostBalance += VacuumCostPageHit;
+
+			TRACE_POSTGRESQL_BUFFER_READ_DONE(forkNum, blockNum + i,
+											  smgr->smgr_rnode.node.spcNode,
+											  smgr->smgr_rnode.node.dbNode,
+											  smgr->smgr_rnode.node.relNode,
+											  smgr->smgr_rnode.backend,
+											  false,
+											  true);
+			i++;
+			continue;
+		}
+
+		/* collect the run of misses starting here */
+		for (nread = 0; i + nread < nblocks && !found[i + nread]; nread++)
+		{
+			BufferDesc *bufHdr = bufHdrs[i + nread];
+
+			Assert(!(pg_atomic_read_u32(&bufHdr->state) & BM_VALID));	/* spinlock not needed */
+			bufBlocks[nread] = isLocalBuf ? LocalBufHdrGetBlock(bufHdr) :
+				BufHdrGetBlock(bufHdr);
+		}
+
+		if (track_io_timing)
+			INSTR_TIME_SET_CURRENT(io_start);
+
+		smgrreadv(smgr, forkNum, blockNum + i, nread, bufBlocks);
+
+		if (track_io_timing)
+		{
+			INSTR_TIME_SET_CURRENT(io_time);
+			INSTR_TIME_SUBTRACT(io_time, io_start);
+			PrefetchControlReportRead(io_time);
+			pgstat_count_buffer_read_time(INSTR_TIME_GET_MICROSEC(io_time));
+			INSTR_TIME_ADD(pgBufferUsage.blk_read_time, io_time);
+		}
+
+		for (int j = 0; j < nread; j++)
+		{
+			BufferDesc *bufHdr = bufHdrs[i + j];
+
+			ReadBufferVerifyPage(smgr, forkNum, blockNum + i + j,
+								 bufBlocks[j], mode);
+
+			if (isLocalBuf)
+			{
+				/* Only need to adjust flags */
+				uint32		buf_state = pg_atomic_read_u32(&bufHdr->state);
+
+				buf_state |= BM_VALID;
+				pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
+			}
+			else
+			{
+				/* Set BM_VALID, terminate IO, and wake up any waiters */
+				TerminateBufferIO(bufHdr, false, BM_VALID);
+			}
+
+			VacuumPageMiss++;
+			if (VacuumCostActive)
+				VacuumCostBalance += VacuumCostPageMiss;
+
+			TRACE_POSTGRESQL_BUFFER_READ_DONE(forkNum, blockNum + i + j,
+											  smgr->smgr_rnode.node.spcNode,
+											  smgr->smgr_rnode.node.dbNode,
+											  smgr->smgr_rnode.node.relNode,
+											  smgr->smgr_rnode.backend,
+											  false,
+											  false);
+		}
+		i += nread;
+	}
+
+	return nhits;
+}
+
 /*
  * BufferAlloc -- subroutine for ReadBuffer.  Handles lookup of a shared
  *		buffer.  If no buffer exists already, selects a replacement
@@ -1169,6 +1625,8 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 		/* Can release the mapping lock as soon as we've pinned it */
 		LWLockRelease(newPartitionLock);
 
+		BufferSimulationAccess(&newTag, newHash, true);
+
 		*foundPtr = true;
 
 		if (!valid)
@@ -1199,6 +1657,8 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	 */
 	LWLockRelease(newPartitionLock);
 
+	BufferSimulationAccess(&newTag, newHash, false);
+
 	/* Loop here in case we have to try another victim buffer */
 	for (;;)
 	{
@@ -1284,6 +1744,13 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 				FlushBuffer(buf, NULL);
 				LWLockRelease(BufferDescriptorGetContentLock(buf));
 
+				/*
+				 * Writes of ring buffers are expected, but with the default
+				 * strategy the bgwriter should have cleaned the buffer.
+				 */
+				if (strategy == NULL)
+					StrategyCountBackendWrite();
+
 				ScheduleBufferTagForWriteback(&BackendWritebackContext,
 											  &buf->tag);
 
@@ -2268,6 +2735,7 @@ BgBufferSync(WritebackContext *wb_context)
 	int			strategy_buf_id;
 	uint32		strategy_passes;
 	uint32		recent_alloc;
+	uint32		recent_backend_writes;
 
 	/*
 	 * Information saved between calls so we can determine the strategy
@@ -2283,6 +2751,12 @@ BgBufferSync(WritebackContext *wb_context)
 	static float smoothed_alloc = 0;
 	static float smoothed_density = 10.0;
 
+	/*
+	 * Factor by which we clean ahead of the allocation estimate, raised while
+	 * backends still have to write out dirty buffers themselves.
+	 */
+	static float lru_boost = 1.0;
+
 	/* Potentially these could be tunables, but for now, not */
 	float		smoothing_samples = 16;
 	float		scan_whole_pool_milliseconds = 120000.0;
@@ -2310,6 +2784,7 @@ BgBufferSync(WritebackContext *wb_context)
 	 * buffer allocations have happened since our last call.
 	 */
 	strategy_buf_id = StrategySyncStart(&strategy_passes, &recent_alloc);
+	recent_backend_writes = StrategyBackendWrites();
 
 	/* Report buffer alloc counts to pgstat */
 	PendingBgWriterStats.buf_alloc += recent_alloc;
@@ -2435,8 +2910,21 @@ BgBufferSync(WritebackContext *wb_context)
 		smoothed_alloc += ((float) recent_alloc - smoothed_alloc) /
 			smoothing_samples;
 
+	/*
+	 * If backends had to write out dirty victims since the last cycle, the
+	 * estimate fell short of what they needed, so double how far ahead we
+	 * clean, up to BGW_MAX_LRU_BOOST times.  Once they stop, slowly fall back
+	 * to the plain estimate.  A multiplier below 1.0 leaves writes to
+	 * backends on purpose, so don't fight it.
+	 */
+	if (recent_backend_writes > 0 && bgwriter_lru_multiplier >= 1.0)
+		lru_boost = Min(lru_boost * 2, BGW_MAX_LRU_BOOST);
+	else
+		lru_boost = Max(lru_boost - lru_boost / smoothing_samples, 1.0);
+
 	/* Scale the estimate by a GUC to allow more aggressive tuning. */
-	upcoming_alloc_est = (int) (smoothed_alloc * bgwriter_lru_multiplier);
+	upcoming_alloc_est = (int) (smoothed_alloc * bgwriter_lru_multiplier *
+								lru_boost);
 
 	/*
 	 * If recent_alloc remains at zero for many cycles, smoothed_alloc will
@@ -3229,7 +3717,7 @@ DropRelFileNodesAllBuffers(SMgrRelation *smgr_reln, int nnodes)
 	uint64		nBlocksToInvalidate = 0;
 	RelFileNode *nodes;
 	bool		cached = true;
-	bool		use_bsearch;
+	rnodeset_hash *nodeset = NULL;
 
 	if (nnodes == 0)
 		return;
@@ -3322,15 +3810,22 @@ DropRelFileNodesAllBuffers(SMgrRelation *smgr_reln, int nnodes)
 
 	/*
 	 * For low number of relations to drop just use a simple walk through, to
-	 * save the bsearch overhead. The threshold to use is rather a guess than
+	 * save the hashing overhead. The threshold to use is rather a guess than
 	 * an exactly determined value, as it depends on many factors (CPU and RAM
-	 * speeds, amount of shared buffers etc.).
+	 * speeds, amount of shared buffers etc.).  When dropping many relations,
+	 * such as a whole schema, a hash lookup per buffer is a lot cheaper than
+	 * a binary search through thousands of relfilenodes.
 	 */
-	use_bsearch = n > RELS_BSEARCH_THRESHOLD;
+	if (n > RELS_BSEARCH_THRESHOLD)
+	{
+		nodeset = rnodeset_create(CurrentMemoryContext, n, NULL);
+		for (i = 0; i < n; i++)
+		{
+			bool		found;
 
-	/* sort the list of rnodes if necessary */
-	if (use_bsearch)
-		pg_qsort(nodes, n, sizeof(RelFileNode), rnode_comparator);
+			(void) rnodeset_insert(nodeset, nodes[i], &found);
+		}
+	}
 
 	for (i = 0; i < NBuffers; i++)
 	{
@@ -3343,7 +3838,7 @@ DropRelFileNodesAllBuffers(SMgrRelation *smgr_reln, int nnodes)
 		 * and saves some cycles.
 		 */
 
-		if (!use_bsearch)
+		if (nodeset == NULL)
 		{
 			int			j;
 
@@ -3358,9 +3853,11 @@ DropRelFileNodesAllBuffers(SMgrRelation *smgr_reln, int nnodes)
 		}
 		else
 		{
-			rnode = bsearch((const void *) &(bufHdr->tag.rnode),
-							nodes, n, sizeof(RelFileNode),
-							rnode_comparator);
+			RelFileNodeSetEntry *entry;
+
+			entry = rnodeset_lookup(nodeset, bufHdr->tag.rnode);
+			if (entry != NULL)
+				rnode = &entry->rnode;
 		}
 
 		/* buffer doesn't belong to any of the given relfilenodes; skip it */
@@ -3374,6 +3871,8 @@ DropRelFileNodesAllBuffers(SMgrRelation *smgr_reln, int nnodes)
 			UnlockBufHdr(bufHdr, buf_state);
 	}
 
+	if (nodeset != NULL)
+		rnodeset_destroy(nodeset);
 	pfree(nodes);
 	pfree(rels);
 }
@@ -4598,7 +5097,7 @@ StartBufferIO(BufferDesc *buf, bool forInput)
 {
 	uint32		buf_state;
 
-	Assert(!InProgressBuf);
+	Assert(NInProgressBufs < lengthof(InProgressBufs));
 
 	for (;;)
 	{
@@ -4622,8 +5121,9 @@ StartBufferIO(BufferDesc *buf, bool forInput)
 	buf_state |= BM_IO_IN_PROGRESS;
 	UnlockBufHdr(buf, buf_state);
 
-	InProgressBuf = buf;
-	IsForInput = forInput;
+	InProgressBufs[NInProgressBufs].buf = buf;
+	InProgressBufs[NInProgressBufs].forInput = forInput;
+	NInProgressBufs++;
 
 	return true;
 }
@@ -4648,8 +5148,14 @@ static void
 TerminateBufferIO(BufferDesc *buf, bool clear_dirty, uint32 set_flag_bits)
 {
 	uint32		buf_state;
+	int			i;
 
-	Assert(buf == InProgressBuf);
+	for (i = NInProgressBufs - 1; i >= 0; i--)
+	{
+		if (InProgressBufs[i].buf == buf)
+			break;
+	}
+	Assert(i >= 0);
 
 	buf_state = LockBufHdr(buf);
 
@@ -4662,7 +5168,10 @@ TerminateBufferIO(BufferDesc *buf, bool clear_dirty, uint32 set_flag_bits)
 	buf_state |= set_flag_bits;
 	UnlockBufHdr(buf, buf_state);
 
-	InProgressBuf = NULL;
+	/* forget it, keeping the remaining entries in order */
+	NInProgressBufs--;
+	memmove(&InProgressBufs[i], &InProgressBufs[i + 1],
+			(NInProgressBufs - i) * sizeof(InProgressIO));
 
 	ConditionVariableBroadcast(BufferDescriptorGetIOCV(buf));
 }
@@ -4679,15 +5188,14 @@ TerminateBufferIO(BufferDesc *buf, bool clear_dirty, uint32 set_flag_bits)
 void
 AbortBufferIO(void)
 {
-	BufferDesc *buf = InProgressBuf;
-
-	if (buf)
+	while (NInProgressBufs > 0)
 	{
+		BufferDesc *buf = InProgressBufs[NInProgressBufs - 1].buf;
 		uint32		buf_state;
 
 		buf_state = LockBufHdr(buf);
 		Assert(buf_state & BM_IO_IN_PROGRESS);
-		if (IsForInput)
+		if (InProgressBufs[NInProgressBufs - 1].forInput)
 		{
 			Assert(!(buf_state & BM_DIRTY));
 
@@ -0,0 +1,305 @@
+/*-------------------------------------------------------------------------
+ *
+ * bufsim.c
+ *	  Simulation of a buffer cache of a different size.
+ *
+ * To find out how much memory a workload needs, it helps to know the hit
+ * rate it would get with a smaller buffer pool, without restarting it with
+ * one.  If buffer_simulation_size is set, the buffer manager reports the
+ * blocks it looks up to this module, which keeps a cache of that many block
+ * tags in shared memory, replaced in clock-sweep order like shared buffers,
+ * and counts how many lookups it would have answered.  The simulated cache
+ * holds no data, so it costs a few dozen bytes per simulated buffer.
+ *
+ * buffer_simulation_level selects which lookups the simulated cache sees.
+ * At the shared_buffers level it sees them all, so it simulates a buffer
+ * pool of the given size.  At the file_cache level it only sees the lookups
+ * that missed the buffer pool, so it simulates a cache of that size between
+ * the buffer pool and the storage, such as a local file cache in front of
+ * the page server.
+ *
+ * To keep the simulation cheap for concurrent backends, the cache is split
+ * into BUFFER_SIMULATION_PARTITIONS partitions by the hash code of the block
+ * tag, each with its own lock and clock hand, so it is a bit less accurate
+ * than one clock sweep over all of it.  A simulated cache has at least one
+ * buffer per partition.
+ *
+ *
+ * Portions Copyright (c) 1996-2022, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/buffer/bufsim.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "funcapi.h"
+#include "storage/bufsim.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+#include "utils/timestamp.h"
+
+/* must be a power of 2, see HASH_PARTITION */
+#define BUFFER_SIMULATION_PARTITIONS	16
+
+typedef struct BufSimSlot
+{
+	BufferTag	tag;
+	uint32		hashcode;		/* hash code of tag */
+	bool		valid;
+	uint8		usage_count;	/* as in BufferDesc, up to BM_MAX_USAGE_COUNT */
+} BufSimSlot;
+
+/* entry of the hash table mapping block tags to slots */
+typedef struct BufSimHashEntry
+{
+	BufferTag	tag;			/* hash key, must be first */
+	int			slot;
+} BufSimHashEntry;
+
+typedef struct BufSimPartition
+{
+	/* protects the partition's slots, hash entries and counters */
+	LWLock		lock;
+	int			first_slot;
+	int			nslots;
+	int			clock_hand;
+	uint64		hits;
+	uint64		misses;
+} BufSimPartition;
+
+typedef struct BufSimCtl
+{
+	BufSimPartition partitions[BUFFER_SIMULATION_PARTITIONS];
+	pg_atomic_uint64 reset_time;
+	BufSimSlot	slots[FLEXIBLE_ARRAY_MEMBER];
+} BufSimCtl;
+
+/* GUC variables */
+int			buffer_simulation_size = 0;
+int			buffer_simulation_level = BUFFER_SIMULATION_SHARED_BUFFERS;
+
+static BufSimCtl *bufSim = NULL;
+static HTAB *bufSimHash = NULL;
+
+static const char *const buffer_simulation_level_names[] = {
+	[BUFFER_SIMULATION_SHARED_BUFFERS] = "shared_buffers",
+	[BUFFER_SIMULATION_FILE_CACHE] = "file_cache",
+};
+
+/* number of simulated buffers */
+static int
+BufferSimulationNumSlots(void)
+{
+	return Max(buffer_simulation_size, BUFFER_SIMULATION_PARTITIONS);
+}
+
+/*
+ * BufferSimulationShmemSize -- shared memory needed for the simulation
+ */
+Size
+BufferSimulationShmemSize(void)
+{
+	Size		size;
+
+	if (buffer_simulation_size <= 0)
+		return 0;
+
+	size = add_size(offsetof(BufSimCtl, slots),
+					mul_size(BufferSimulationNumSlots(), sizeof(BufSimSlot)));
+	size = MAXALIGN(size);
+	size = add_size(size, hash_estimate_size(BufferSimulationNumSlots(),
+											 sizeof(BufSimHashEntry)));
+	return size;
+}
+
+/*
+ * BufferSimulationShmemInit -- allocate and initialize the simulated cache
+ */
+void
+BufferSimulationShmemInit(void)
+{
+	int			nslots = BufferSimulationNumSlots();
+	HASHCTL		info;
+	bool		found;
+
+	if (buffer_simulation_size <= 0)
+		return;
+
+	bufSim = (BufSimCtl *)
+		ShmemInitStruct("buffer simulation",
+						add_size(offsetof(BufSimCtl, slots),
+								 mul_size(nslots, sizeof(BufSimSlot))),
+						&found);
+	if (!found)
+	{
+		int			first_slot = 0;
+
+		for (int i = 0; i < BUFFER_SIMULATION_PARTITIONS; i++)
+		{
+			BufSimPartition *part = &bufSim->partitions[i];
+
+			LWLockInitialize(&part->lock, LWTRANCHE_BUFFER_SIMULATION);
+			part->first_slot = first_slot;
+			part->nslots = nslots / BUFFER_SIMULATION_PARTITIONS +
+				(i < nslots % BUFFER_SIMULATION_PARTITIONS ? 1 : 0);
+			part->clock_hand = 0;
+			part->hits = part->misses = 0;
+			first_slot += part->nslots;
+		}
+		for (int i = 0; i < nslots; i++)
+			bufSim->slots[i].valid = false;
+		pg_atomic_init_u64(&bufSim->reset_time, GetCurrentTimestamp());
+	}
+
+	info.keysize = sizeof(BufferTag);
+	info.entrysize = sizeof(BufSimHashEntry);
+	info.num_partitions = BUFFER_SIMULATION_PARTITIONS;
+	bufSimHash = ShmemInitHash("buffer simulation hash",
+							   nslots, nslots,
+							   &info,
+							   HASH_ELEM | HASH_BLOBS | HASH_PARTITION);
+}
+
+/*
+ * BufferSimulationAccess -- report a lookup of a block in the buffer pool
+ *
+ * "hashcode" is the hash code of the tag, as computed by BufTableHashCode,
+ * and "found" tells whether the block was found in the buffer pool.
+ */
+void
+BufferSimulationAccess(BufferTag *tag, uint32 hashcode, bool found)
+{
+	BufSimPartition *part;
+	BufSimHashEntry *entry;
+	BufSimSlot *slot;
+	bool		entered;
+
+	if (bufSim == NULL)
+		return;
+	if (found && buffer_simulation_level == BUFFER_SIMULATION_FILE_CACHE)
+		return;
+
+	part = &bufSim->partitions[hashcode % BUFFER_SIMULATION_PARTITIONS];
+
+	LWLockAcquire(&part->lock, LW_EXCLUSIVE);
+
+	entry = (BufSimHashEntry *)
+		hash_search_with_hash_value(bufSimHash, tag, hashcode, HASH_FIND,
+									NULL);
+	if (entry != NULL)
+	{
+		slot = &bufSim->slots[entry->slot];
+		if (slot->usage_count < BM_MAX_USAGE_COUNT)
+			slot->usage_count++;
+		part->hits++;
+		LWLockRelease(&part->lock);
+		return;
+	}
+
+	part->misses++;
+
+	/* find a victim by clock sweep, as StrategyGetBuffer does */
+	for (;;)
+	{
+		slot = &bufSim->slots[part->first_slot + part->clock_hand];
+		if (++part->clock_hand >= part->nslots)
+			part->clock_hand = 0;
+
+		if (!slot->valid)
+			break;
+		if (slot->usage_count == 0)
+		{
+			if (hash_search_with_hash_value(bufSimHash, &slot->tag,
+											slot->hashcode, HASH_REMOVE,
+											NULL) == NULL)
+				elog(ERROR, "buffer simulation hash table corrupted");
+			break;
+		}
+		slot->usage_count--;
+	}
+
+	entry = (BufSimHashEntry *)
+		hash_search_with_hash_value(bufSimHash, tag, hashcode, HASH_ENTER,
+									&entered);
+	Assert(!entered);
+	entry->slot = slot - bufSim->slots;
+
+	slot->tag = *tag;
+	slot->hashcode = hashcode;
+	slot->valid = true;
+	slot->usage_count = 1;
+
+	LWLockRelease(&part->lock);
+}
+
+/*
+ * BufferSimulationResetStats -- reset the hit and miss counters
+ *
+ * The contents of the simulated cache are kept.
+ */
+void
+BufferSimulationResetStats(void)
+{
+	if (bufSim == NULL)
+		return;
+
+	for (int i = 0; i < BUFFER_SIMULATION_PARTITIONS; i++)
+	{
+		BufSimPartition *part = &bufSim->partitions[i];
+
+		LWLockAcquire(&part->lock, LW_EXCLUSIVE);
+		part->hits = part->misses = 0;
+		LWLockRelease(&part->lock);
+	}
+	pg_atomic_write_u64(&bufSim->reset_time, GetCurrentTimestamp());
+}
+
+/*
+ * Report the hit rate of the simulated cache.
+ *
+ * Returns no row if the simulation is disabled.
+ */
+Datum
+pg_stat_get_buffer_simulation(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_BUFFER_SIMULATION_COLS 5
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	Datum		values[PG_STAT_GET_BUFFER_SIMULATION_COLS];
+	bool		nulls[PG_STAT_GET_BUFFER_SIMULATION_COLS];
+	uint64		hits = 0;
+	uint64		misses = 0;
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	if (bufSim == NULL)
+		return (Datum) 0;
+
+	for (int i = 0; i < BUFFER_SIMULATION_PARTITIONS; i++)
+	{
+		BufSimPartition *part = &bufSim->partitions[i];
+
+		LWLockAcquire(&part->lock, LW_SHARED);
+		hits += part->hits;
+		misses += part->misses;
+		LWLockRelease(&part->lock);
+	}
+
+	for (int i = 0; i < PG_STAT_GET_BUFFER_SIMULATION_COLS; ++i)
+		nulls[i] = false;
+
+	values[0] = Int32GetDatum(BufferSimulationNumSlots());
+	values[1] = CStringGetTextDatum(buffer_simulation_level_names[buffer_simulation_level]);
+	values[2] = Int64GetDatum(hits);
+	values[3] = Int64GetDatum(misses);
+	values[4] = TimestampTzGetDatum(pg_atomic_read_u64(&bufSim->reset_time));
+	tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+
+	return (Datum) 0;
+}
@@ -52,6 +52,8 @@ typedef struct
 	 */
 	uint32		completePasses; /* Complete cycles of the clock sweep */
 	pg_atomic_uint32 numBufferAllocs;	/* Buffers allocated since last reset */
+	pg_atomic_uint32 numBackendWrites;	/* Dirty victims written by backends
+										 * since last reset */
 
 	/*
 	 * Bgworker process to be notified upon activity or -1 if none. See
@@ -103,6 +105,19 @@ static BufferDesc *GetBufferFromRing(BufferAccessStrategy strategy,
 static void AddBufferToRing(BufferAccessStrategy strategy,
 							BufferDesc *buf);
 
+/*
+ * Number of clock hand positions a backend claims at a time.  Advancing the
+ * shared hand for every buffer considered makes all the backends that are
+ * looking for victims bounce its cache line between them, so each backend
+ * advances it by a batch of positions and then sweeps those on its own.
+ * The buffers are still considered in approximately clock order.
+ */
+#define CLOCK_SWEEP_BATCH	16
+
+/* Positions claimed by this backend and not yet swept, not wrapped */
+static uint32 sweepNext = 0;
+static uint32 sweepEnd = 0;
+
 /*
  * ClockSweepTick - Helper routine for StrategyGetBuffer()
  *
@@ -113,59 +128,63 @@ static inline uint32
 ClockSweepTick(void)
 {
 	uint32		victim;
+	uint32		batch;
+
+	if (sweepNext != sweepEnd)
+		return sweepNext++ % NBuffers;
+
+	/* don't let a few backends claim a small buffer pool between them */
+	batch = Max(Min(CLOCK_SWEEP_BATCH, NBuffers / CLOCK_SWEEP_BATCH), 1);
 
 	/*
-	 * Atomically move hand ahead one buffer - if there's several processes
+	 * Atomically move hand ahead one batch - if there's several processes
 	 * doing this, this can lead to buffers being returned slightly out of
 	 * apparent order.
 	 */
 	victim =
-		pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, 1);
+		pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, batch);
+	sweepNext = victim + 1;
+	sweepEnd = victim + batch;
 
-	if (victim >= NBuffers)
+	/*
+	 * If our batch includes the position where the hand wraps around, force
+	 * completePasses to be incremented while holding the spinlock. We need
+	 * the spinlock so StrategySyncStart() can return a consistent value
+	 * consisting of nextVictimBuffer and completePasses.
+	 */
+	if ((victim >= NBuffers && victim % NBuffers == 0) ||
+		(victim + batch - 1) / NBuffers != victim / NBuffers)
 	{
-		uint32		originalVictim = victim;
+		uint32		expected;
+		uint32		wrapped;
+		bool		success = false;
 
-		/* always wrap what we look up in BufferDescriptors */
-		victim = victim % NBuffers;
+		expected = victim + batch;
 
-		/*
-		 * If we're the one that just caused a wraparound, force
-		 * completePasses to be incremented while holding the spinlock. We
-		 * need the spinlock so StrategySyncStart() can return a consistent
-		 * value consisting of nextVictimBuffer and completePasses.
-		 */
-		if (victim == 0)
+		while (!success)
 		{
-			uint32		expected;
-			uint32		wrapped;
-			bool		success = false;
+			/*
+			 * Acquire the spinlock while increasing completePasses. That
+			 * allows other readers to read nextVictimBuffer and
+			 * completePasses in a consistent manner which is required for
+			 * StrategySyncStart().  In theory delaying the increment could
+			 * lead to an overflow of nextVictimBuffers, but that's highly
+			 * unlikely and wouldn't be particularly harmful.
+			 */
+			SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
 
-			expected = originalVictim + 1;
+			wrapped = expected % NBuffers;
 
-			while (!success)
-			{
-				/*
-				 * Acquire the spinlock while increasing completePasses. That
-				 * allows other readers to read nextVictimBuffer and
-				 * completePasses in a consistent manner which is required for
-				 * StrategySyncStart().  In theory delaying the increment
-				 * could lead to an overflow of nextVictimBuffers, but that's
-				 * highly unlikely and wouldn't be particularly harmful.
-				 */
-				SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
-
-				wrapped = expected % NBuffers;
-
-				success = pg_atomic_compare_exchange_u32(&StrategyControl->nextVictimBuffer,
-														 &expected, wrapped);
-				if (success)
-					StrategyControl->completePasses++;
-				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
-			}
+			success = pg_atomic_compare_exchange_u32(&StrategyControl->nextVictimBuffer,
+													 &expected, wrapped);
+			if (success)
+				StrategyControl->completePasses++;
+			SpinLockRelease(&StrategyControl->buffer_strategy_lock);
 		}
 	}
-	return victim;
+
+	/* always wrap what we look up in BufferDescriptors */
+	return victim % NBuffers;
 }
 
 /*
@@ -419,6 +438,29 @@ StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
 	return result;
 }
 
+/*
+ * StrategyCountBackendWrite -- note that a backend had to write out a dirty
+ * victim buffer itself
+ *
+ * This tells the bgwriter that it didn't keep enough clean buffers ahead of
+ * the clock sweep.
+ */
+void
+StrategyCountBackendWrite(void)
+{
+	pg_atomic_fetch_add_u32(&StrategyControl->numBackendWrites, 1);
+}
+
+/*
+ * StrategyBackendWrites -- return and reset the number of dirty victim
+ * buffers written by backends since the last call
+ */
+uint32
+StrategyBackendWrites(void)
+{
+	return pg_atomic_exchange_u32(&StrategyControl->numBackendWrites, 0);
+}
+
 /*
  * StrategyNotifyBgWriter -- set or clear allocation notification latch
  *
@@ -517,6 +559,7 @@ StrategyInitialize(bool init)
 		/* Clear statistics */
 		StrategyControl->completePasses = 0;
 		pg_atomic_init_u32(&StrategyControl->numBufferAllocs, 0);
+		pg_atomic_init_u32(&StrategyControl->numBackendWrites, 0);
 
 		/* No pending notification */
 		StrategyControl->bgwprocno = -1;
@@ -25,8 +25,6 @@
 #include "utils/memutils.h"
 #include "utils/resowner_private.h"
 
-/* ZENITH: prevent eviction of the buffer of target page */
-extern Buffer wal_redo_buffer;
 
 /*#define LBDEBUG*/
 
@@ -51,9 +49,23 @@ static int	nextFreeLocalBuf = 0;
 
 static HTAB *LocalBufHash = NULL;
 
+/*
+ * In the WAL redo process, the pages of the current request are kept in the
+ * first WAL_REDO_LOCAL_BUFFERS local buffers, without the hash table.  The
+ * working set of a request is small enough to search linearly: the target
+ * pages plus the few other pages the redo functions touch.
+ * nWalRedoLocalBufs is the number of those buffers in use.
+ */
+#define WAL_REDO_LOCAL_BUFFERS	(2 * MAX_WAL_REDO_BUFFERS)
+
+static int	nWalRedoLocalBufs = 0;
+
 
 static void InitLocalBuffers(void);
 static Block GetLocalBufferStorage(void);
+static bool IsWalRedoTargetBuffer(Buffer buffer);
+static int	WalRedoLocalBufferLookup(BufferTag *tag);
+static int	WalRedoLocalBufferVictim(void);
 
 
 /*
@@ -70,6 +82,7 @@ PrefetchLocalBuffer(SMgrRelation smgr, ForkNumber forkNum,
 	PrefetchBufferResult result = {InvalidBuffer, false};
 	BufferTag	newTag;			/* identity of requested block */
 	LocalBufferLookupEnt *hresult;
+	int			b;
 
 	INIT_BUFFERTAG(newTag, smgr->smgr_rnode.node, forkNum, blockNum);
 
@@ -78,13 +91,19 @@ PrefetchLocalBuffer(SMgrRelation smgr, ForkNumber forkNum,
 		InitLocalBuffers();
 
 	/* See if the desired buffer already exists */
-	hresult = (LocalBufferLookupEnt *)
-		hash_search(LocalBufHash, (void *) &newTag, HASH_FIND, NULL);
+	if (am_wal_redo_postgres)
+		b = WalRedoLocalBufferLookup(&newTag);
+	else
+	{
+		hresult = (LocalBufferLookupEnt *)
+			hash_search(LocalBufHash, (void *) &newTag, HASH_FIND, NULL);
+		b = hresult ? hresult->id : -1;
+	}
 
-	if (hresult)
+	if (b >= 0)
 	{
 		/* Yes, so nothing to do */
-		result.recent_buffer = -hresult->id - 1;
+		result.recent_buffer = -b - 1;
 	}
 	else
 	{
@@ -99,6 +118,130 @@ PrefetchLocalBuffer(SMgrRelation smgr, ForkNumber forkNum,
 }
 
 
+/*
+ * IsWalRedoTargetBuffer -
+ *	  Does the buffer hold a target page of the WAL redo process?
+ */
+static bool
+IsWalRedoTargetBuffer(Buffer buffer)
+{
+	if (buffer == wal_redo_buffer)
+		return true;
+	for (int i = 0; i < num_wal_redo_buffers; i++)
+	{
+		if (wal_redo_buffers[i] == buffer)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * AddWalRedoTargetBuffer -
+ *	  Protect the buffer with a target page of a batch of WAL redo requests
+ *	  from eviction, until ResetWalRedoTargetBuffers is called.
+ */
+void
+AddWalRedoTargetBuffer(Buffer buffer)
+{
+	Assert(BufferIsLocal(buffer));
+
+	if (IsWalRedoTargetBuffer(buffer))
+		return;
+	if (num_wal_redo_buffers >= MAX_WAL_REDO_BUFFERS ||
+		num_wal_redo_buffers >= NLocBuffer - 1)
+		elog(ERROR, "too many WAL redo target buffers");
+
+	wal_redo_buffers[num_wal_redo_buffers++] = buffer;
+}
+
+/*
+ * ResetWalRedoTargetBuffers -
+ *	  Allow the target pages of the previous batch to be evicted again.
+ */
+void
+ResetWalRedoTargetBuffers(void)
+{
+	num_wal_redo_buffers = 0;
+}
+
+/*
+ * WalRedoLocalBufferLookup -
+ *	  Find the buffer with the given page in the WAL redo working set.
+ *
+ * Returns the local buffer index, or -1 if the page is not in a buffer.
+ */
+static int
+WalRedoLocalBufferLookup(BufferTag *tag)
+{
+	for (int b = 0; b < nWalRedoLocalBufs; b++)
+	{
+		BufferDesc *bufHdr = GetLocalBufferDescriptor(b);
+
+		if ((pg_atomic_read_u32(&bufHdr->state) & BM_TAG_VALID) &&
+			BUFFERTAGS_EQUAL(bufHdr->tag, *tag))
+			return b;
+	}
+	return -1;
+}
+
+/*
+ * WalRedoLocalBufferVictim -
+ *	  Choose a buffer of the WAL redo working set for a new page.
+ *
+ * An unused buffer is taken if there is one.  Otherwise, an unpinned buffer
+ * that doesn't hold a target page is reused.
+ */
+static int
+WalRedoLocalBufferVictim(void)
+{
+	int			limit = Min(NLocBuffer, WAL_REDO_LOCAL_BUFFERS);
+
+	if (nWalRedoLocalBufs < limit)
+		return nWalRedoLocalBufs++;
+
+	for (int b = 0; b < limit; b++)
+	{
+		if (LocalRefCount[b] == 0 && !IsWalRedoTargetBuffer(-b - 1))
+			return b;
+	}
+
+	ereport(ERROR,
+			(errcode(ERRCODE_INSUFFICIENT_RESOURCES),
+			 errmsg("no empty local buffer available")));
+	return -1;					/* keep compiler quiet */
+}
+
+/*
+ * DropWalRedoLocalBuffers -
+ *	  Forget all the pages of the WAL redo working set.
+ *
+ * Called by the WAL redo process between requests.  The pages must not be
+ * pinned anymore; dirty pages are dropped without writing them out.
+ */
+void
+DropWalRedoLocalBuffers(void)
+{
+	Assert(am_wal_redo_postgres);
+
+	for (int b = 0; b < nWalRedoLocalBufs; b++)
+	{
+		BufferDesc *bufHdr = GetLocalBufferDescriptor(b);
+		uint32		buf_state;
+
+		if (LocalRefCount[b] != 0)
+			elog(ERROR, "WAL redo local buffer %d is still referenced (local %u)",
+				 -b - 1, LocalRefCount[b]);
+
+		buf_state = pg_atomic_read_u32(&bufHdr->state);
+		CLEAR_BUFFERTAG(bufHdr->tag);
+		buf_state &= ~BUF_FLAG_MASK;
+		buf_state &= ~BUF_USAGECOUNT_MASK;
+		pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
+	}
+	nWalRedoLocalBufs = 0;
+	ResetWalRedoTargetBuffers();
+}
+
 /*
  * LocalBufferAlloc -
  *	  Find or create a local buffer for the given page of the given relation.
@@ -127,12 +270,17 @@ LocalBufferAlloc(SMgrRelation smgr, ForkNumber forkNum, BlockNumber blockNum,
 		InitLocalBuffers();
 
 	/* See if the desired buffer already exists */
-	hresult = (LocalBufferLookupEnt *)
-		hash_search(LocalBufHash, (void *) &newTag, HASH_FIND, NULL);
+	if (am_wal_redo_postgres)
+		b = WalRedoLocalBufferLookup(&newTag);
+	else
+	{
+		hresult = (LocalBufferLookupEnt *)
+			hash_search(LocalBufHash, (void *) &newTag, HASH_FIND, NULL);
+		b = hresult ? hresult->id : -1;
+	}
 
-	if (hresult)
+	if (b >= 0)
 	{
-		b = hresult->id;
 		bufHdr = GetLocalBufferDescriptor(b);
 		Assert(BUFFERTAGS_EQUAL(bufHdr->tag, newTag));
 #ifdef LBDEBUG
@@ -171,47 +319,54 @@ LocalBufferAlloc(SMgrRelation smgr, ForkNumber forkNum, BlockNumber blockNum,
 
 	/*
 	 * Need to get a new buffer.  We use a clock sweep algorithm (essentially
-	 * the same as what freelist.c does now...)
+	 * the same as what freelist.c does now...), except in the WAL redo
+	 * process.
 	 */
 	trycounter = NLocBuffer;
-	for (;;)
+	if (am_wal_redo_postgres)
 	{
-		b = nextFreeLocalBuf;
-
-		if (++nextFreeLocalBuf >= NLocBuffer)
-			nextFreeLocalBuf = 0;
-
+		b = WalRedoLocalBufferVictim();
 		bufHdr = GetLocalBufferDescriptor(b);
-
-		if (LocalRefCount[b] == 0)
+		buf_state = pg_atomic_read_u32(&bufHdr->state);
+		LocalRefCount[b]++;
+		ResourceOwnerRememberBuffer(CurrentResourceOwner,
+									BufferDescriptorGetBuffer(bufHdr));
+	}
+	else
+	{
+		for (;;)
 		{
-			if (-b - 1 == wal_redo_buffer)
-			{
-				/* ZENITH: Prevent eviction of the buffer with target wal redo page */
-				continue;
-			}
+			b = nextFreeLocalBuf;
 
-			buf_state = pg_atomic_read_u32(&bufHdr->state);
+			if (++nextFreeLocalBuf >= NLocBuffer)
+				nextFreeLocalBuf = 0;
 
-			if (BUF_STATE_GET_USAGECOUNT(buf_state) > 0)
-			{
-				buf_state -= BUF_USAGECOUNT_ONE;
-				pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
-				trycounter = NLocBuffer;
-			}
-			else
+			bufHdr = GetLocalBufferDescriptor(b);
+
+			if (LocalRefCount[b] == 0)
 			{
-				/* Found a usable buffer */
-				LocalRefCount[b]++;
-				ResourceOwnerRememberBuffer(CurrentResourceOwner,
-											BufferDescriptorGetBuffer(bufHdr));
-				break;
+				buf_state = pg_atomic_read_u32(&bufHdr->state);
+
+				if (BUF_STATE_GET_USAGECOUNT(buf_state) > 0)
+				{
+					buf_state -= BUF_USAGECOUNT_ONE;
+					pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
+					trycounter = NLocBuffer;
+				}
+				else
+				{
+					/* Found a usable buffer */
+					LocalRefCount[b]++;
+					ResourceOwnerRememberBuffer(CurrentResourceOwner,
+												BufferDescriptorGetBuffer(bufHdr));
+					break;
+				}
 			}
+			else if (--trycounter == 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_INSUFFICIENT_RESOURCES),
+						 errmsg("no empty local buffer available")));
 		}
-		else if (--trycounter == 0)
-			ereport(ERROR,
-					(errcode(ERRCODE_INSUFFICIENT_RESOURCES),
-					 errmsg("no empty local buffer available")));
 	}
 
 	/*
@@ -259,22 +414,28 @@ LocalBufferAlloc(SMgrRelation smgr, ForkNumber forkNum, BlockNumber blockNum,
 	 */
 	if (buf_state & BM_TAG_VALID)
 	{
-		hresult = (LocalBufferLookupEnt *)
-			hash_search(LocalBufHash, (void *) &bufHdr->tag,
-						HASH_REMOVE, NULL);
-		if (!hresult)			/* shouldn't happen */
-			elog(ERROR, "local buffer hash table corrupted");
+		if (!am_wal_redo_postgres)
+		{
+			hresult = (LocalBufferLookupEnt *)
+				hash_search(LocalBufHash, (void *) &bufHdr->tag,
+							HASH_REMOVE, NULL);
+			if (!hresult)		/* shouldn't happen */
+				elog(ERROR, "local buffer hash table corrupted");
+		}
 		/* mark buffer invalid just in case hash insert fails */
 		CLEAR_BUFFERTAG(bufHdr->tag);
 		buf_state &= ~(BM_VALID | BM_TAG_VALID);
 		pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
 	}
 
-	hresult = (LocalBufferLookupEnt *)
-		hash_search(LocalBufHash, (void *) &newTag, HASH_ENTER, &found);
-	if (found)					/* shouldn't happen */
-		elog(ERROR, "local buffer hash table corrupted");
-	hresult->id = b;
+	if (!am_wal_redo_postgres)
+	{
+		hresult = (LocalBufferLookupEnt *)
+			hash_search(LocalBufHash, (void *) &newTag, HASH_ENTER, &found);
+		if (found)				/* shouldn't happen */
+			elog(ERROR, "local buffer hash table corrupted");
+		hresult->id = b;
+	}
 
 	/*
 	 * it's all ours now.
@@ -360,11 +521,14 @@ DropRelFileNodeLocalBuffers(RelFileNode rnode, ForkNumber forkNum,
 									bufHdr->tag.forkNum),
 					 LocalRefCount[i]);
 			/* Remove entry from hashtable */
-			hresult = (LocalBufferLookupEnt *)
-				hash_search(LocalBufHash, (void *) &bufHdr->tag,
-							HASH_REMOVE, NULL);
-			if (!hresult)		/* shouldn't happen */
-				elog(ERROR, "local buffer hash table corrupted");
+			if (!am_wal_redo_postgres)
+			{
+				hresult = (LocalBufferLookupEnt *)
+					hash_search(LocalBufHash, (void *) &bufHdr->tag,
+								HASH_REMOVE, NULL);
+				if (!hresult)	/* shouldn't happen */
+					elog(ERROR, "local buffer hash table corrupted");
+			}
 			/* Mark buffer invalid */
 			CLEAR_BUFFERTAG(bufHdr->tag);
 			buf_state &= ~BUF_FLAG_MASK;
@@ -404,11 +568,14 @@ DropRelFileNodeAllLocalBuffers(RelFileNode rnode)
 									bufHdr->tag.forkNum),
 					 LocalRefCount[i]);
 			/* Remove entry from hashtable */
-			hresult = (LocalBufferLookupEnt *)
-				hash_search(LocalBufHash, (void *) &bufHdr->tag,
-							HASH_REMOVE, NULL);
-			if (!hresult)		/* shouldn't happen */
-				elog(ERROR, "local buffer hash table corrupted");
+			if (!am_wal_redo_postgres)
+			{
+				hresult = (LocalBufferLookupEnt *)
+					hash_search(LocalBufHash, (void *) &bufHdr->tag,
+								HASH_REMOVE, NULL);
+				if (!hresult)	/* shouldn't happen */
+					elog(ERROR, "local buffer hash table corrupted");
+			}
 			/* Mark buffer invalid */
 			CLEAR_BUFFERTAG(bufHdr->tag);
 			buf_state &= ~BUF_FLAG_MASK;
@@ -0,0 +1,320 @@
+/*-------------------------------------------------------------------------
+ *
+ * prefetch.c
+ *	  Adaptive prefetch distance control for scans.
+ *
+ * Sequential, index and bitmap heap scans all prefetch pages ahead of the
+ * page they are currently processing.  Prefetching too little leaves the
+ * scan waiting for the page server on every page; prefetching too much
+ * floods it with requests for pages that a query with a low LIMIT will never
+ * look at.  This module decides how far ahead a scan should prefetch, based
+ * on feedback from the scan itself and from the buffer manager:
+ *
+ * - The distance starts small and grows by at most one page for every page
+ *	 the scan consumes, so it doubles per window of consumed pages ("slow
+ *	 start"), and a scan that stops early has wasted few requests.
+ *
+ * - The distance needed to hide the read latency follows from Little's law:
+ *	 it is the read latency divided by the time the scan spends on a page
+ *	 when it doesn't have to wait, plus the page being read.  The distance
+ *	 moves towards that value by one page per consumed page.
+ *
+ * - When a scan is restarted, the number of prefetched pages that were never
+ *	 consumed decides where the next scan starts: a scan that wasted more
+ *	 prefetches than it used (typically the inner side of a nested loop with
+ *	 a LIMIT) starts lower the next time, one that used almost all of them
+ *	 starts higher.
+ *
+ * PrefetchQueue builds on this for scans that know the blocks they will read
+ * in advance but not in physical order, such as the heap blocks of the items
+ * of an index page.
+ *
+ * The latency feedback needs the clock, so it is only collected when
+ * track_io_timing is on; otherwise the distance just grows to the maximum by
+ * slow start.  The read latency is tracked per backend, since it is a
+ * property of the storage rather than of the scan.  It is a peak estimate
+ * that decays slowly: reads of pages whose prefetch already completed are
+ * fast and would otherwise drag the estimate down to the point where
+ * prefetching no longer hides the latency.
+ *
+ *
+ * Portions Copyright (c) 1996-2022, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/buffer/prefetch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "storage/bufmgr.h"
+#include "storage/prefetch.h"
+
+/* weight of a new sample in the moving averages */
+#define PREFETCH_AVERAGE_WEIGHT		(1.0 / 8)
+
+/* fraction by which the latency estimate decays per smgr read */
+#define PREFETCH_LATENCY_DECAY		(1.0 / 64)
+
+/* per-backend storage read latency feedback, see PrefetchControlReportRead */
+static double read_latency_usec = 0;
+static uint64 read_wait_usec = 0;
+
+
+/*
+ * PrefetchControlInit -- initialize the controller of a new scan
+ *
+ * "maximum" is the upper bound of the prefetch distance, usually the
+ * io_concurrency of the tablespace; prefetching is disabled if it is not
+ * positive.  "start" is the distance the scan starts with.
+ */
+void
+PrefetchControlInit(PrefetchControl *pc, int maximum, int start)
+{
+	pc->maximum = maximum;
+	pc->start = maximum > 0 ? Min(start, maximum) : 0;
+	pc->busy_usec = 0;
+	/* nothing to learn from yet */
+	pc->issued = pc->consumed = 0;
+	PrefetchControlRestart(pc);
+}
+
+/*
+ * PrefetchControlRestart -- prepare the controller for a rescan
+ *
+ * The starting distance is adjusted according to how many of the pages
+ * prefetched by the previous scan were consumed.
+ */
+void
+PrefetchControlRestart(PrefetchControl *pc)
+{
+	if (pc->maximum > 0 && pc->issued > 0)
+	{
+		uint64		wasted = pc->issued > pc->consumed ?
+		pc->issued - pc->consumed : 0;
+
+		if (wasted > pc->consumed)
+			pc->start = Max(pc->start / 2, Min(pc->start, 1));
+		else if (wasted * 4 < pc->consumed)
+			pc->start = Min(Max(pc->start * 2, 1), pc->maximum);
+	}
+
+	pc->target = pc->start;
+	pc->issued = 0;
+	pc->consumed = 0;
+	INSTR_TIME_SET_ZERO(pc->last_consume);
+	pc->last_wait_usec = read_wait_usec;
+}
+
+/*
+ * PrefetchControlRescan -- prepare the controller for a scan that may be a
+ * rescan
+ *
+ * Restarts the controller if it was set up for the same maximum distance
+ * before, so that a rescan starts with what the previous scans learned;
+ * otherwise initializes it as for a new scan.
+ */
+void
+PrefetchControlRescan(PrefetchControl *pc, int maximum, int start)
+{
+	if (pc->maximum == maximum)
+		PrefetchControlRestart(pc);
+	else
+		PrefetchControlInit(pc, maximum, start);
+}
+
+/*
+ * PrefetchControlIssued -- report pages added to the prefetch window
+ */
+void
+PrefetchControlIssued(PrefetchControl *pc, int npages)
+{
+	pc->issued += npages;
+}
+
+/*
+ * PrefetchControlConsume -- report that the scan moves on to its next page
+ *
+ * Returns the new prefetch distance.
+ */
+int
+PrefetchControlConsume(PrefetchControl *pc)
+{
+	int			needed;
+
+	if (pc->maximum <= 0)
+		return 0;
+
+	pc->consumed++;
+
+	/*
+	 * Measure the time spent on the previous page, minus waiting for reads.
+	 * Scans can consume a page per tuple, so only read the clock if it is
+	 * read for track_io_timing anyway.
+	 */
+	if (track_io_timing)
+	{
+		instr_time	now;
+
+		INSTR_TIME_SET_CURRENT(now);
+		if (!INSTR_TIME_IS_ZERO(pc->last_consume))
+		{
+			instr_time	elapsed = now;
+			double		busy;
+
+			INSTR_TIME_SUBTRACT(elapsed, pc->last_consume);
+			busy = (double) INSTR_TIME_GET_MICROSEC(elapsed) -
+				(double) (read_wait_usec - pc->last_wait_usec);
+			busy = Max(busy, 1.0);
+
+			if (pc->busy_usec == 0)
+				pc->busy_usec = busy;
+			else
+				pc->busy_usec += (busy - pc->busy_usec) * PREFETCH_AVERAGE_WEIGHT;
+		}
+		pc->last_consume = now;
+		pc->last_wait_usec = read_wait_usec;
+	}
+
+	/* distance that hides the read latency, by Little's law */
+	if (read_latency_usec > 0 && pc->busy_usec > 0)
+	{
+		double		pages = read_latency_usec / pc->busy_usec + 1;
+
+		needed = pages < pc->maximum ? (int) pages : pc->maximum;
+	}
+	else
+		needed = pc->maximum;	/* no feedback yet */
+
+	if (pc->target < needed)
+		pc->target++;
+	else if (pc->target > needed && pc->target > 1)
+		pc->target--;
+
+	return pc->target;
+}
+
+/*
+ * PrefetchControlReportRead -- report the duration of an smgr read
+ *
+ * Called by the buffer manager for every read of a page (or a run of pages
+ * read with one request) that wasn't found in the buffer pool, if
+ * track_io_timing is on.
+ */
+void
+PrefetchControlReportRead(instr_time io_time)
+{
+	uint64		usec = INSTR_TIME_GET_MICROSEC(io_time);
+
+	read_wait_usec += usec;
+
+	if ((double) usec > read_latency_usec)
+		read_latency_usec = (double) usec;
+	else
+		read_latency_usec -= read_latency_usec * PREFETCH_LATENCY_DECAY;
+}
+
+/*
+ * PrefetchQueueInit -- initialize the queue of a new scan of "rel"
+ *
+ * "maximum" and "start" are as for PrefetchControlInit.
+ */
+void
+PrefetchQueueInit(PrefetchQueue *pq, Relation rel, int maximum, int start)
+{
+	pq->rel = rel;
+	PrefetchControlInit(&pq->ctl, maximum, start);
+	PrefetchQueueReset(pq);
+}
+
+/*
+ * PrefetchQueueRestart -- prepare the queue for a rescan
+ */
+void
+PrefetchQueueRestart(PrefetchQueue *pq)
+{
+	PrefetchControlRestart(&pq->ctl);
+	PrefetchQueueReset(pq);
+}
+
+/*
+ * PrefetchQueueReset -- forget the queued blocks
+ *
+ * Used when the scan abandons the blocks it has queued, e.g. because it
+ * moves on to the next index page and queues the blocks of that one.
+ */
+void
+PrefetchQueueReset(PrefetchQueue *pq)
+{
+	pq->head = pq->issued = pq->tail = 0;
+}
+
+/*
+ * PrefetchQueueAdd -- queue the block the scan will read after the others
+ *
+ * Nothing is prefetched until PrefetchQueueIssue or PrefetchQueueConsume is
+ * called, so that a batch of blocks can be queued at once.  If the queue is
+ * full, the block is not queued; it is merely not prefetched then.
+ */
+void
+PrefetchQueueAdd(PrefetchQueue *pq, BlockNumber blkno)
+{
+	if (pq->ctl.maximum <= 0)
+		return;
+
+	if (pq->tail == PREFETCH_QUEUE_SIZE)
+	{
+		/* make room by discarding the consumed blocks */
+		if (pq->head == 0)
+			return;
+		memmove(pq->blocks, pq->blocks + pq->head,
+				(pq->tail - pq->head) * sizeof(BlockNumber));
+		pq->tail -= pq->head;
+		pq->issued = Max(pq->issued - pq->head, 0);
+		pq->head = 0;
+	}
+
+	pq->blocks[pq->tail++] = blkno;
+}
+
+/*
+ * PrefetchQueueIssue -- prefetch the queued blocks within the distance
+ */
+void
+PrefetchQueueIssue(PrefetchQueue *pq)
+{
+	int			end;
+
+	if (pq->ctl.maximum <= 0)
+		return;
+
+	end = Min(pq->tail, pq->head + PrefetchControlTarget(&pq->ctl));
+	pq->issued = Max(pq->issued, pq->head);
+	if (pq->issued < end)
+	{
+		PrefetchBuffers(pq->rel, MAIN_FORKNUM, pq->blocks + pq->issued,
+						end - pq->issued);
+		PrefetchControlIssued(&pq->ctl, end - pq->issued);
+		pq->issued = end;
+	}
+}
+
+/*
+ * PrefetchQueueConsume -- report that the scan moves on to its next block
+ *
+ * The block at the head of the queue is dequeued, and prefetching continues
+ * with the following ones.
+ */
+void
+PrefetchQueueConsume(PrefetchQueue *pq)
+{
+	if (pq->ctl.maximum <= 0)
+		return;
+
+	PrefetchControlConsume(&pq->ctl);
+	if (pq->head < pq->tail)
+		pq->head++;
+	PrefetchQueueIssue(pq);
+}
@@ -40,18 +40,36 @@
  * when the corresponding files need to be survived across the transaction and
  * need to be opened and closed multiple times.  Such files need to be created
  * as a member of a FileSet.
+ *
+ * Finally, temporary files created with BufFileCreateCompressTemp are
+ * compressed a buffer at a time, according to temp_file_compression.  Each
+ * buffer is stored as a BufFileChunkHeader followed by the (possibly
+ * compressed) data, so the physical offsets no longer match logical ones.
+ * The last, partially filled buffer is kept in memory and only stored once
+ * it's full, so stored chunks never change.
+ * Data can only be appended to such files, and they can only be repositioned
+ * to the start or to a position previously reported by BufFileTell, which is
+ * an opaque value combining the physical offset of a chunk with a position
+ * within its data.  That's all that hash join batch files and forward-only
+ * tuplestores need.
  *-------------------------------------------------------------------------
  */
 
 #include "postgres.h"
 
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
 #include "commands/tablespace.h"
+#include "common/pg_lzcompress.h"
 #include "executor/instrument.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "storage/buf_internals.h"
 #include "storage/buffile.h"
 #include "storage/fd.h"
+#include "utils/memutils.h"
 #include "utils/resowner.h"
 
 /*
@@ -62,6 +80,36 @@
 #define MAX_PHYSICAL_FILESIZE	0x40000000
 #define BUFFILE_SEG_SIZE		(MAX_PHYSICAL_FILESIZE / BLCKSZ)
 
+/*
+ * Header preceding each buffer of a compressed BufFile.  storedlen equals
+ * rawlen if the buffer didn't compress, and is smaller otherwise.
+ */
+typedef struct BufFileChunkHeader
+{
+	int32		rawlen;			/* number of bytes of data in the buffer */
+	int32		storedlen;		/* number of bytes following this header */
+} BufFileChunkHeader;
+
+/*
+ * Encoding of the offset part of a position in a compressed BufFile.  A
+ * position within a buffer never exceeds BLCKSZ, so it fits in the low bits.
+ */
+#define COMPRESSED_POS_BITS		16
+#define MakeCompressedPos(chunkoff, pos) \
+	(((off_t) (chunkoff) << COMPRESSED_POS_BITS) | (pos))
+#define CompressedPosChunk(off)		((off) >> COMPRESSED_POS_BITS)
+#define CompressedPosOffset(off) \
+	((int) ((off) & ((1 << COMPRESSED_POS_BITS) - 1)))
+
+/*
+ * Size of the read-ahead buffer of a compressed BufFile.  It must hold at
+ * least one chunk of maximum size.
+ */
+#define COMPRESSED_READ_AHEAD	(4 * BLCKSZ)
+
+/* GUC */
+int			temp_file_compression = TEMP_FILE_COMPRESSION_NONE;
+
 /*
  * This data structure represents a buffered file that consists of one or
  * more physical files (each accessed through a virtual file descriptor
@@ -95,6 +143,34 @@ struct BufFile
 	off_t		curOffset;		/* offset part of current pos */
 	int			pos;			/* next read/write position in buffer */
 	int			nbytes;			/* total # of valid bytes in buffer */
+
+	/*
+	 * Compression method (TEMP_FILE_COMPRESSION_NONE for a plain file), and a
+	 * palloc'd buffer to compress one chunk into.  For a compressed file,
+	 * (curFile, curOffset) is the physical position of the chunk held in the
+	 * buffer, chunkLen is its length as stored (0 if not stored yet), and
+	 * (endFile, endOffset) is the physical end of the stored data.  The last
+	 * chunk, at the end, isn't stored until it's full; while the buffer holds
+	 * another chunk, its data is kept in tail (palloc'd when first needed).
+	 */
+	int			compress;
+	char	   *cbuffer;
+	int			chunkLen;
+	int			endFile;
+	off_t		endOffset;
+	char	   *tail;
+	int			tailBytes;
+
+	/*
+	 * Read-ahead buffer of a compressed file, allocated on first read: raLen
+	 * bytes of stored chunks, starting at the physical position (raFile,
+	 * raOffset).
+	 */
+	char	   *rabuffer;
+	int			raFile;
+	off_t		raOffset;
+	int			raLen;
+
 	PGAlignedBlock buffer;
 };
 
@@ -104,6 +180,13 @@ static void extendBufFile(BufFile *file);
 static void BufFileLoadBuffer(BufFile *file);
 static void BufFileDumpBuffer(BufFile *file);
 static void BufFileFlush(BufFile *file);
+static void BufFileWriteRaw(BufFile *file, char *data, int len);
+static int	BufFileReadRaw(BufFile *file, char *data, int len);
+static int	BufFileReadAhead(BufFile *file, int len, char **data);
+static void BufFileLoadCompressedBuffer(BufFile *file);
+static void BufFileDumpCompressedBuffer(BufFile *file);
+static void BufFileNextChunkPos(BufFile *file, int *fileno, off_t *offset);
+static bool BufFileAtLastChunk(BufFile *file);
 static File MakeNewFileSetSegment(BufFile *file, int segment);
 
 /*
@@ -122,6 +205,17 @@ makeBufFileCommon(int nfiles)
 	file->curOffset = 0L;
 	file->pos = 0;
 	file->nbytes = 0;
+	file->compress = TEMP_FILE_COMPRESSION_NONE;
+	file->cbuffer = NULL;
+	file->chunkLen = 0;
+	file->endFile = 0;
+	file->endOffset = 0L;
+	file->tail = NULL;
+	file->tailBytes = 0;
+	file->rabuffer = NULL;
+	file->raFile = 0;
+	file->raOffset = 0L;
+	file->raLen = 0;
 
 	return file;
 }
@@ -210,6 +304,34 @@ BufFileCreateTemp(bool interXact)
 	return file;
 }
 
+/*
+ * Create a BufFile for a new temporary file, like BufFileCreateTemp, that is
+ * compressed according to temp_file_compression.
+ *
+ * The caller can only append data at the end of the file, and can only seek
+ * to the start of the file or to a position reported by BufFileTell; relative
+ * seeks are not supported.
+ *
+ * Positions in a compressed file need a 64-bit off_t, so where that's not
+ * available the file is left uncompressed.
+ */
+BufFile *
+BufFileCreateCompressTemp(bool interXact)
+{
+	BufFile    *file = BufFileCreateTemp(interXact);
+
+#if SIZEOF_OFF_T >= 8
+	if (temp_file_compression != TEMP_FILE_COMPRESSION_NONE)
+	{
+		file->compress = temp_file_compression;
+		file->cbuffer = palloc(sizeof(BufFileChunkHeader) +
+							   PGLZ_MAX_OUTPUT(BLCKSZ));
+	}
+#endif
+
+	return file;
+}
+
 /*
  * Build the name for a given segment of a given BufFile.
  */
@@ -415,6 +537,12 @@ BufFileClose(BufFile *file)
 		FileClose(file->files[i]);
 	/* release the buffer space */
 	pfree(file->files);
+	if (file->cbuffer)
+		pfree(file->cbuffer);
+	if (file->tail)
+		pfree(file->tail);
+	if (file->rabuffer)
+		pfree(file->rabuffer);
 	pfree(file);
 }
 
@@ -486,16 +614,54 @@ BufFileLoadBuffer(BufFile *file)
  */
 static void
 BufFileDumpBuffer(BufFile *file)
+{
+	if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+	{
+		BufFileDumpCompressedBuffer(file);
+		return;
+	}
+
+	BufFileWriteRaw(file, file->buffer.data, file->nbytes);
+	file->dirty = false;
+
+	/*
+	 * At this point, curOffset has been advanced to the end of the buffer,
+	 * ie, its original value + nbytes.  We need to make it point to the
+	 * logical file position, ie, original value + pos, in case that is less
+	 * (as could happen due to a small backwards seek in a dirty buffer!)
+	 */
+	file->curOffset -= (file->nbytes - file->pos);
+	if (file->curOffset < 0)	/* handle possible segment crossing */
+	{
+		file->curFile--;
+		Assert(file->curFile >= 0);
+		file->curOffset += MAX_PHYSICAL_FILESIZE;
+	}
+
+	/*
+	 * Now we can set the buffer empty without changing the logical position
+	 */
+	file->pos = 0;
+	file->nbytes = 0;
+}
+
+/*
+ * BufFileWriteRaw
+ *
+ * Write len bytes of data at curOffset, and advance curOffset past them.
+ */
+static void
+BufFileWriteRaw(BufFile *file, char *data, int len)
 {
 	int			wpos = 0;
 	int			bytestowrite;
 	File		thisfile;
 
 	/*
-	 * Unlike BufFileLoadBuffer, we must dump the whole buffer even if it
-	 * crosses a component-file boundary; so we need a loop.
+	 * Unlike BufFileLoadBuffer, we must write all the data even if it crosses
+	 * a component-file boundary; so we need a loop.
 	 */
-	while (wpos < file->nbytes)
+	while (wpos < len)
 	{
 		off_t		availbytes;
 		instr_time	io_start;
@@ -515,7 +681,7 @@ BufFileDumpBuffer(BufFile *file)
 		/*
 		 * Determine how much we need to write into this file.
 		 */
-		bytestowrite = file->nbytes - wpos;
+		bytestowrite = len - wpos;
 		availbytes = MAX_PHYSICAL_FILESIZE - file->curOffset;
 
 		if ((off_t) bytestowrite > availbytes)
@@ -527,7 +693,7 @@ BufFileDumpBuffer(BufFile *file)
 			INSTR_TIME_SET_CURRENT(io_start);
 
 		bytestowrite = FileWrite(thisfile,
-								 file->buffer.data + wpos,
+								 data + wpos,
 								 bytestowrite,
 								 file->curOffset,
 								 WAIT_EVENT_BUFFILE_WRITE);
@@ -549,27 +715,300 @@ BufFileDumpBuffer(BufFile *file)
 
 		pgBufferUsage.temp_blks_written++;
 	}
+}
+
+/*
+ * BufFileReadRaw
+ *
+ * Read up to len bytes of data at curOffset, crossing component-file
+ * boundaries as needed, and advance curOffset past them.  Returns the number
+ * of bytes read, which is less than len only at end of file.  The caller
+ * counts the read in temp_blks_read.
+ */
+static int
+BufFileReadRaw(BufFile *file, char *data, int len)
+{
+	int			rpos = 0;
+
+	while (rpos < len)
+	{
+		File		thisfile;
+		int			nread;
+		instr_time	io_start;
+		instr_time	io_time;
+
+		/*
+		 * Advance to next component file if necessary and possible.
+		 */
+		if (file->curOffset >= MAX_PHYSICAL_FILESIZE)
+		{
+			if (file->curFile + 1 >= file->numFiles)
+				break;
+			file->curFile++;
+			file->curOffset = 0L;
+		}
+
+		thisfile = file->files[file->curFile];
+
+		if (track_io_timing)
+			INSTR_TIME_SET_CURRENT(io_start);
+
+		nread = FileRead(thisfile,
+						 data + rpos,
+						 Min(len - rpos, MAX_PHYSICAL_FILESIZE - file->curOffset),
+						 file->curOffset,
+						 WAIT_EVENT_BUFFILE_READ);
+		if (nread < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read file \"%s\": %m",
+							FilePathName(thisfile))));
+
+		if (track_io_timing)
+		{
+			INSTR_TIME_SET_CURRENT(io_time);
+			INSTR_TIME_SUBTRACT(io_time, io_start);
+			INSTR_TIME_ADD(pgBufferUsage.temp_blk_read_time, io_time);
+		}
+
+		if (nread == 0)
+			break;
+
+		file->curOffset += nread;
+		rpos += nread;
+	}
+
+	return rpos;
+}
+
+/*
+ * BufFileDumpCompressedBuffer
+ *
+ * BufFileDumpBuffer for a compressed file, whose buffer holds the last chunk.
+ * A full chunk is compressed and stored at the end of the file; the data
+ * stays loaded in the buffer, so the logical position is unchanged.  A
+ * partial chunk is just copied to the tail, to be reloaded from there; as
+ * tuplestores switch between reading and writing all the time, that saves
+ * writing and rereading it on each switch.
+ */
+static void
+BufFileDumpCompressedBuffer(BufFile *file)
+{
+	BufFileChunkHeader *hdr = (BufFileChunkHeader *) file->cbuffer;
+	char	   *dest = file->cbuffer + sizeof(BufFileChunkHeader);
+	int32		len = -1;
+	int			chunkFile = file->curFile;
+	off_t		chunkOffset = file->curOffset;
+
+	Assert(BufFileAtLastChunk(file));
+
+	if (file->nbytes < BLCKSZ)
+	{
+		if (file->tail == NULL)
+			file->tail = MemoryContextAlloc(GetMemoryChunkContext(file),
+											BLCKSZ);
+		memcpy(file->tail, file->buffer.data, file->nbytes);
+		file->tailBytes = file->nbytes;
+		file->dirty = false;
+		return;
+	}
+
+	switch (file->compress)
+	{
+		case TEMP_FILE_COMPRESSION_PGLZ:
+			len = pglz_compress(file->buffer.data, file->nbytes, dest,
+								PGLZ_strategy_default);
+			break;
+		case TEMP_FILE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			len = LZ4_compress_default(file->buffer.data, dest,
+									   file->nbytes, file->nbytes - 1);
+			if (len == 0)
+				len = -1;
+#endif
+			break;
+		default:
+			elog(ERROR, "invalid temporary file compression method %d",
+				 file->compress);
+	}
+
+	/* store the data as is if it didn't compress */
+	hdr->rawlen = file->nbytes;
+	if (len < 0 || len >= file->nbytes)
+	{
+		memcpy(dest, file->buffer.data, file->nbytes);
+		len = file->nbytes;
+	}
+	hdr->storedlen = len;
+
+	/* Store the chunk, and start a new, empty last chunk after it */
+	BufFileWriteRaw(file, file->cbuffer, sizeof(BufFileChunkHeader) + len);
+	file->endFile = file->curFile;
+	file->endOffset = file->curOffset;
+	file->tailBytes = 0;
+
+	file->curFile = chunkFile;
+	file->curOffset = chunkOffset;
+	file->chunkLen = sizeof(BufFileChunkHeader) + len;
 	file->dirty = false;
+}
 
-	/*
-	 * At this point, curOffset has been advanced to the end of the buffer,
-	 * ie, its original value + nbytes.  We need to make it point to the
-	 * logical file position, ie, original value + pos, in case that is less
-	 * (as could happen due to a small backwards seek in a dirty buffer!)
-	 */
-	file->curOffset -= (file->nbytes - file->pos);
-	if (file->curOffset < 0)	/* handle possible segment crossing */
+/*
+ * BufFileReadAhead
+ *
+ * Set *data to the stored data at the physical position (curFile, curOffset)
+ * of a compressed file, and return how many of the len bytes wanted are
+ * available there, which is less than len only at the end of the file's data.
+ * The data comes from the read-ahead buffer, which is refilled from that
+ * position if it doesn't hold all of them, so that a file read sequentially
+ * is read COMPRESSED_READ_AHEAD bytes at a time rather than a chunk at a time.
+ */
+static int
+BufFileReadAhead(BufFile *file, int len, char **data)
+{
+	int			fileno = file->curFile;
+	off_t		offset = file->curOffset;
+
+	Assert(len <= COMPRESSED_READ_AHEAD);
+
+	if (fileno != file->raFile || offset < file->raOffset ||
+		offset + len > file->raOffset + file->raLen)
 	{
-		file->curFile--;
-		Assert(file->curFile >= 0);
-		file->curOffset += MAX_PHYSICAL_FILESIZE;
+		off_t		avail;
+		int			toread = COMPRESSED_READ_AHEAD;
+
+		if (file->rabuffer == NULL)
+			file->rabuffer = MemoryContextAlloc(GetMemoryChunkContext(file),
+												COMPRESSED_READ_AHEAD);
+
+		/* there's nothing to read past the end of the stored data */
+		avail = (off_t) (file->endFile - fileno) * MAX_PHYSICAL_FILESIZE +
+			file->endOffset - offset;
+		if (avail < toread)
+			toread = (int) avail;
+
+		file->raFile = fileno;
+		file->raOffset = offset;
+		file->raLen = BufFileReadRaw(file, file->rabuffer, toread);
+		pgBufferUsage.temp_blks_read++;
+
+		file->curFile = fileno;
+		file->curOffset = offset;
 	}
 
-	/*
-	 * Now we can set the buffer empty without changing the logical position
-	 */
-	file->pos = 0;
-	file->nbytes = 0;
+	*data = file->rabuffer + (offset - file->raOffset);
+	return (int) Min(len, file->raOffset + file->raLen - offset);
+}
+
+/*
+ * BufFileLoadCompressedBuffer
+ *
+ * Load the chunk at curOffset of a compressed file into the buffer: the last
+ * chunk from the tail, any other one by reading and decompressing it.  At
+ * call, the buffer must be empty.
+ */
+static void
+BufFileLoadCompressedBuffer(BufFile *file)
+{
+	BufFileChunkHeader hdr;
+	char	   *src;
+	int			nread;
+	int32		rawlen = -1;
+
+	Assert(!file->dirty && file->nbytes == 0 && file->chunkLen == 0);
+
+	if (BufFileAtLastChunk(file))
+	{
+		if (file->tailBytes > 0)
+			memcpy(file->buffer.data, file->tail, file->tailBytes);
+		file->nbytes = file->tailBytes;
+		return;
+	}
+
+	nread = BufFileReadAhead(file, sizeof(BufFileChunkHeader), &src);
+	if (nread == sizeof(BufFileChunkHeader))
+		memcpy(&hdr, src, sizeof(BufFileChunkHeader));
+	if (nread < (int) sizeof(BufFileChunkHeader) ||
+		hdr.rawlen <= 0 || hdr.rawlen > BLCKSZ ||
+		hdr.storedlen <= 0 || hdr.storedlen > hdr.rawlen)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("invalid chunk header in temporary file \"%s\"",
+								 FilePathName(file->files[file->curFile]))));
+
+	nread = BufFileReadAhead(file, sizeof(BufFileChunkHeader) + hdr.storedlen,
+							 &src) - sizeof(BufFileChunkHeader);
+	src += sizeof(BufFileChunkHeader);
+	if (nread < hdr.storedlen)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from temporary file \"%s\": read only %d of %d bytes",
+						FilePathName(file->files[file->curFile]),
+						nread, hdr.storedlen)));
+
+	if (hdr.storedlen == hdr.rawlen)
+		memcpy(file->buffer.data, src, hdr.rawlen);
+	else
+	{
+		switch (file->compress)
+		{
+			case TEMP_FILE_COMPRESSION_PGLZ:
+				rawlen = pglz_decompress(src, hdr.storedlen,
+										 file->buffer.data, hdr.rawlen, true);
+				break;
+			case TEMP_FILE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+				rawlen = LZ4_decompress_safe(src, file->buffer.data,
+											 hdr.storedlen, hdr.rawlen);
+#endif
+				break;
+			default:
+				elog(ERROR, "invalid temporary file compression method %d",
+					 file->compress);
+		}
+		if (rawlen != hdr.rawlen)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg_internal("compressed data in temporary file \"%s\" is corrupt",
+									 FilePathName(file->files[file->curFile]))));
+	}
+
+	file->nbytes = hdr.rawlen;
+	file->chunkLen = sizeof(BufFileChunkHeader) + hdr.storedlen;
+}
+
+/*
+ * BufFileNextChunkPos
+ *
+ * Get the physical position following the chunk held in the buffer of a
+ * compressed file, which must have been stored.
+ */
+static void
+BufFileNextChunkPos(BufFile *file, int *fileno, off_t *offset)
+{
+	Assert(file->chunkLen > 0);
+
+	*fileno = file->curFile;
+	*offset = file->curOffset + file->chunkLen;
+
+	/* chunks can span segments; see BufFileWriteRaw */
+	while (*offset > MAX_PHYSICAL_FILESIZE)
+	{
+		(*fileno)++;
+		*offset -= MAX_PHYSICAL_FILESIZE;
+	}
+}
+
+/*
+ * BufFileAtLastChunk
+ *
+ * Is the buffer of a compressed file at the last chunk of the file, which
+ * isn't stored yet, so that data can be appended there?
+ */
+static bool
+BufFileAtLastChunk(BufFile *file)
+{
+	return file->curFile == file->endFile && file->curOffset == file->endOffset;
 }
 
 /*
@@ -584,17 +1023,32 @@ BufFileRead(BufFile *file, void *ptr, size_t size)
 	size_t		nread = 0;
 	size_t		nthistime;
 
-	BufFileFlush(file);
+	/* the dirty last chunk of a compressed file can be read as it is */
+	if (file->compress == TEMP_FILE_COMPRESSION_NONE)
+		BufFileFlush(file);
 
 	while (size > 0)
 	{
 		if (file->pos >= file->nbytes)
 		{
+			if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+			{
+				/* Move on to the next chunk, if this isn't the last one */
+				if (BufFileAtLastChunk(file))
+					break;		/* no more data available */
+				BufFileNextChunkPos(file, &file->curFile, &file->curOffset);
+				file->chunkLen = 0;
+			}
+			else
+				file->curOffset += file->pos;
+
 			/* Try to load more data into buffer. */
-			file->curOffset += file->pos;
 			file->pos = 0;
 			file->nbytes = 0;
-			BufFileLoadBuffer(file);
+			if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+				BufFileLoadCompressedBuffer(file);
+			else
+				BufFileLoadBuffer(file);
 			if (file->nbytes <= 0)
 				break;			/* no more data available */
 		}
@@ -635,15 +1089,40 @@ BufFileWrite(BufFile *file, void *ptr, size_t size)
 			/* Buffer full, dump it out */
 			if (file->dirty)
 				BufFileDumpBuffer(file);
-			else
+			else if (file->compress == TEMP_FILE_COMPRESSION_NONE)
 			{
 				/* Hmm, went directly from reading to writing? */
 				file->curOffset += file->pos;
 				file->pos = 0;
 				file->nbytes = 0;
 			}
+
+			/*
+			 * A compressed file continues with its last chunk, which must
+			 * follow the full one that was just stored or read.
+			 */
+			if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+			{
+				int			fileno;
+				off_t		offset;
+
+				BufFileNextChunkPos(file, &fileno, &offset);
+				if (fileno != file->endFile || offset != file->endOffset)
+					elog(ERROR, "compressed temporary files can only be appended to");
+				file->curFile = fileno;
+				file->curOffset = offset;
+				file->pos = 0;
+				file->nbytes = 0;
+				file->chunkLen = 0;
+				BufFileLoadCompressedBuffer(file);
+			}
 		}
 
+		/* Likewise, don't start overwriting data in a compressed file */
+		if (file->compress != TEMP_FILE_COMPRESSION_NONE &&
+			(file->pos != file->nbytes || !BufFileAtLastChunk(file)))
+			elog(ERROR, "compressed temporary files can only be appended to");
+
 		nthistime = BLCKSZ - file->pos;
 		if (nthistime > size)
 			nthistime = size;
@@ -691,6 +1170,39 @@ BufFileSeek(BufFile *file, int fileno, off_t offset, int whence)
 	int			newFile;
 	off_t		newOffset;
 
+	/*
+	 * In a compressed file, offset must be 0 or come from BufFileTell; see
+	 * BufFileCreateCompressTemp.
+	 */
+	if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+	{
+		off_t		chunkOffset = CompressedPosChunk(offset);
+		int			newPos = CompressedPosOffset(offset);
+
+		if (whence != SEEK_SET)
+			elog(ERROR, "compressed temporary files do not support relative seeks");
+		if (fileno < 0 || fileno >= file->numFiles || offset < 0 ||
+			newPos > BLCKSZ)
+			return EOF;
+
+		/* Load the target chunk, unless it's already in the buffer */
+		if (fileno != file->curFile || chunkOffset != file->curOffset ||
+			(file->nbytes == 0 && !file->dirty))
+		{
+			BufFileFlush(file);
+			file->curFile = fileno;
+			file->curOffset = chunkOffset;
+			file->pos = 0;
+			file->nbytes = 0;
+			file->chunkLen = 0;
+			BufFileLoadCompressedBuffer(file);
+		}
+		if (newPos > file->nbytes)
+			return EOF;
+		file->pos = newPos;
+		return 0;
+	}
+
 	switch (whence)
 	{
 		case SEEK_SET:
@@ -782,7 +1294,10 @@ void
 BufFileTell(BufFile *file, int *fileno, off_t *offset)
 {
 	*fileno = file->curFile;
-	*offset = file->curOffset + file->pos;
+	if (file->compress != TEMP_FILE_COMPRESSION_NONE)
+		*offset = MakeCompressedPos(file->curOffset, file->pos);
+	else
+		*offset = file->curOffset + file->pos;
 }
 
 /*
@@ -805,6 +1320,31 @@ BufFileSeekBlock(BufFile *file, long blknum)
 					   SEEK_SET);
 }
 
+/*
+ * BufFilePrefetchBlocks --- hint that "nblocks" BLCKSZ-sized blocks starting
+ * at the n'th block will be read
+ *
+ * This only asks the kernel to start reading the blocks into its page cache;
+ * the logical position is not moved.  The range is cut at the end of the
+ * segment file containing the first block, and blocks beyond the end of the
+ * file are ignored.
+ */
+void
+BufFilePrefetchBlocks(BufFile *file, long blknum, int nblocks)
+{
+#ifdef USE_PREFETCH
+	int			fileno = (int) (blknum / BUFFILE_SEG_SIZE);
+	long		segblkno = blknum % BUFFILE_SEG_SIZE;
+
+	if (fileno < 0 || fileno >= file->numFiles)
+		return;
+
+	nblocks = Min(nblocks, BUFFILE_SEG_SIZE - segblkno);
+	(void) FilePrefetch(file->files[fileno], (off_t) segblkno * BLCKSZ,
+						nblocks * BLCKSZ, WAIT_EVENT_BUFFILE_READ);
+#endif
+}
+
 #ifdef NOT_USED
 /*
  * BufFileTellBlock --- block-oriented tell
@@ -109,6 +109,8 @@ static Size fsm_space_cat_to_avail(uint8 cat);
 static int	fsm_set_and_search(Relation rel, FSMAddress addr, uint16 slot,
 							   uint8 newValue, uint8 minValue);
 static BlockNumber fsm_search(Relation rel, uint8 min_cat);
+static void fsm_prefetch_children(Relation rel, FSMAddress addr,
+								  int start_slot, int end_slot);
 static uint8 fsm_vacuum_page(Relation rel, FSMAddress addr,
 							 BlockNumber start, BlockNumber end,
 							 bool *eof);
@@ -791,6 +793,37 @@ fsm_search(Relation rel, uint8 min_cat)
 }
 
 
+/*
+ * Prefetch the children of the FSM page at addr in slots start_slot to
+ * end_slot, as far as they exist.
+ */
+static void
+fsm_prefetch_children(Relation rel, FSMAddress addr,
+					  int start_slot, int end_slot)
+{
+	BlockNumber blocks[PREFETCH_BATCH_SIZE];
+	BlockNumber nblocks;
+	int			n = 0;
+
+	Assert(end_slot - start_slot < PREFETCH_BATCH_SIZE);
+
+	/* fsm_readbuf() of the parent has made sure the size is cached */
+	nblocks = RelationGetSmgr(rel)->smgr_cached_nblocks[FSM_FORKNUM];
+	if (nblocks == InvalidBlockNumber)
+		return;
+
+	for (int slot = start_slot; slot <= end_slot; slot++)
+	{
+		BlockNumber blkno = fsm_logical_to_physical(fsm_get_child(addr, slot));
+
+		if (blkno >= nblocks)
+			break;
+		blocks[n++] = blkno;
+	}
+	if (n > 0)
+		PrefetchBuffers(rel, FSM_FORKNUM, blocks, n);
+}
+
 /*
  * Recursive guts of FreeSpaceMapVacuum
  *
@@ -877,6 +910,17 @@ fsm_vacuum_page(Relation rel, FSMAddress addr,
 
 			CHECK_FOR_INTERRUPTS();
 
+			/*
+			 * The children of a page just above the bottom level are leaf
+			 * pages stored consecutively, and we are going to read them all,
+			 * so prefetch them in batches.
+			 */
+			if (addr.level == FSM_BOTTOM_LEVEL + 1 && !eof &&
+				(slot - start_slot) % PREFETCH_BATCH_SIZE == 0)
+				fsm_prefetch_children(rel, addr, slot,
+									  Min(slot + PREFETCH_BATCH_SIZE - 1,
+										  end_slot));
+
 			/* After we hit end-of-file, just clear the rest of the slots */
 			if (!eof)
 				child_avail = fsm_vacuum_page(rel, fsm_get_child(addr, slot),
@@ -37,6 +37,8 @@
 #include "replication/walreceiver.h"
 #include "replication/walsender.h"
 #include "storage/bufmgr.h"
+#include "storage/bufsim.h"
+#include "storage/dbsize_cache.h"
 #include "storage/dsm.h"
 #include "storage/ipc.h"
 #include "storage/pg_shmem.h"
@@ -44,6 +46,7 @@
 #include "storage/predicate.h"
 #include "storage/proc.h"
 #include "storage/procarray.h"
+#include "storage/relsize_cache.h"
 #include "storage/procsignal.h"
 #include "storage/sinvaladt.h"
 #include "storage/spin.h"
@@ -110,6 +113,9 @@ CalculateShmemSize(int *num_semaphores)
 											 sizeof(ShmemIndexEnt)));
 	size = add_size(size, dsm_estimate_size());
 	size = add_size(size, BufferShmemSize());
+	size = add_size(size, RelSizeCacheShmemSize());
+	size = add_size(size, DbSizeCacheShmemSize());
+	size = add_size(size, BufferSimulationShmemSize());
 	size = add_size(size, LockShmemSize());
 	size = add_size(size, PredicateLockShmemSize());
 	size = add_size(size, ProcGlobalShmemSize());
@@ -245,6 +251,9 @@ CreateSharedMemoryAndSemaphores(void)
 	SUBTRANSShmemInit();
 	MultiXactShmemInit();
 	InitBufferPool();
+	RelSizeCacheShmemInit();
+	DbSizeCacheShmemInit();
+	BufferSimulationShmemInit();
 
 	/*
 	 * Set up lock manager
@@ -26,6 +26,7 @@
 #include "storage/shmem.h"
 #include "storage/sinvaladt.h"
 #include "storage/spin.h"
+#include "utils/guc.h"
 
 /*
  * Conceptually, the shared cache invalidation messages are stored in an
@@ -43,9 +44,9 @@
  * SICleanupQueue is called, and we try not to do that often.)
  *
  * In reality, the messages are stored in a circular buffer of MAXNUMMESSAGES
- * entries.  We translate MsgNum values into circular-buffer indexes by
- * computing MsgNum % MAXNUMMESSAGES (this should be fast as long as
- * MAXNUMMESSAGES is a constant and a power of 2).  As long as maxMsgNum
+ * entries, set by invalidation_queue_size.  We translate MsgNum values into
+ * circular-buffer indexes by computing MsgNum % MAXNUMMESSAGES, which is
+ * cheap because MAXNUMMESSAGES is a power of 2.  As long as maxMsgNum
  * doesn't exceed minMsgNum by more than MAXNUMMESSAGES, we have enough space
  * in the buffer.  If the buffer does overflow, we recover by setting the
  * "reset" flag for each backend that has fallen too far behind.  A backend
@@ -107,10 +108,11 @@
  * Configurable parameters.
  *
  * MAXNUMMESSAGES: max number of shared-inval messages we can buffer.
- * Must be a power of 2 for speed.
+ * Must be a power of 2 for speed, see check_invalidation_queue_size.
  *
  * MSGNUMWRAPAROUND: how often to reduce MsgNum variables to avoid overflow.
- * Must be a multiple of MAXNUMMESSAGES.  Should be large.
+ * Must be a multiple of MAXNUMMESSAGES, which any power of 2 up to the
+ * maximum invalidation_queue_size is.  Should be large.
  *
  * CLEANUP_MIN: the minimum number of messages that must be in the buffer
  * before we bother to call SICleanupQueue.
@@ -127,8 +129,8 @@
  * per iteration.
  */
 
-#define MAXNUMMESSAGES 4096
-#define MSGNUMWRAPAROUND (MAXNUMMESSAGES * 262144)
+#define MAXNUMMESSAGES invalidation_queue_size
+#define MSGNUMWRAPAROUND (1 << 30)
 #define CLEANUP_MIN (MAXNUMMESSAGES / 2)
 #define CLEANUP_QUANTUM (MAXNUMMESSAGES / 16)
 #define SIG_THRESHOLD (MAXNUMMESSAGES / 2)
@@ -178,9 +180,10 @@ typedef struct SISeg
 	slock_t		msgnumLock;		/* spinlock protecting maxMsgNum */
 
 	/*
-	 * Circular buffer holding shared-inval messages
+	 * Circular buffer holding shared-inval messages, allocated after the
+	 * procState array
 	 */
-	SharedInvalidationMessage buffer[MAXNUMMESSAGES];
+	SharedInvalidationMessage *buffer;
 
 	/*
 	 * Per-backend invalidation state info (has MaxBackends entries).
@@ -190,6 +193,9 @@ typedef struct SISeg
 
 static SISeg *shmInvalBuffer;	/* pointer to the shared inval buffer */
 
+/* GUC variable */
+int			invalidation_queue_size = 4096;
+
 
 static LocalTransactionId nextLocalTransactionId;
 
@@ -215,10 +221,27 @@ SInvalShmemSize(void)
 	 * Standby mode.
 	 */
 	size = add_size(size, mul_size(sizeof(ProcState), MaxBackends));
+	size = MAXALIGN(size);
+	size = add_size(size, mul_size(sizeof(SharedInvalidationMessage),
+								   MAXNUMMESSAGES));
 
 	return size;
 }
 
+/*
+ * GUC check_hook for invalidation_queue_size
+ */
+bool
+check_invalidation_queue_size(int *newval, void **extra, GucSource source)
+{
+	if ((*newval & (*newval - 1)) != 0)
+	{
+		GUC_check_errdetail("\"invalidation_queue_size\" must be a power of two.");
+		return false;
+	}
+	return true;
+}
+
 /*
  * CreateSharedInvalidationState
  *		Create and initialize the SI message buffer
@@ -242,6 +265,10 @@ CreateSharedInvalidationState(void)
 	shmInvalBuffer->lastBackend = 0;
 	shmInvalBuffer->maxBackends = MaxBackends;
 	SpinLockInit(&shmInvalBuffer->msgnumLock);
+	shmInvalBuffer->buffer = (SharedInvalidationMessage *)
+		((char *) shmInvalBuffer +
+		 MAXALIGN(add_size(offsetof(SISeg, procState),
+						   mul_size(sizeof(ProcState), MaxBackends))));
 
 	/* The buffer[] array is initially all unused, so we need not fill it */
 
@@ -486,7 +513,7 @@ SIInsertDataEntries(const SharedInvalidationMessage *data, int n)
 		max = segP->maxMsgNum;
 		while (nthistime-- > 0)
 		{
-			segP->buffer[max % MAXNUMMESSAGES] = *data++;
+			segP->buffer[max & (MAXNUMMESSAGES - 1)] = *data++;
 			max++;
 		}
 
@@ -609,7 +636,7 @@ SIGetDataEntries(SharedInvalidationMessage *data, int datasize)
 	n = 0;
 	while (n < datasize && stateP->nextMsgNum < max)
 	{
-		data[n++] = segP->buffer[stateP->nextMsgNum % MAXNUMMESSAGES];
+		data[n++] = segP->buffer[stateP->nextMsgNum & (MAXNUMMESSAGES - 1)];
 		stateP->nextMsgNum++;
 	}
 
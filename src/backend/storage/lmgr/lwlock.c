@@ -183,6 +183,14 @@ static const char *const BuiltinTrancheNames[] = {
 	"PgStatsHash",
 	/* LWTRANCHE_PGSTATS_DATA: */
 	"PgStatsData",
+	/* LWTRANCHE_LAST_WRITTEN_LSN_CACHE: */
+	"LastWrittenLsnCache",
+	/* LWTRANCHE_RELSIZE_CACHE: */
+	"RelSizeCache",
+	/* LWTRANCHE_DBSIZE_CACHE: */
+	"DbSizeCache",
+	/* LWTRANCHE_BUFFER_SIMULATION: */
+	"BufferSimulation",
 };
 
 StaticAssertDecl(lengthof(BuiltinTrancheNames) ==
@@ -93,6 +93,7 @@ static void RemoveProcFromArray(int code, Datum arg);
 static void ProcKill(int code, Datum arg);
 static void AuxiliaryProcKill(int code, Datum arg);
 static void CheckDeadLock(void);
+static Size FastPathLockShmemSize(void);
 
 
 /*
@@ -114,9 +115,23 @@ ProcGlobalShmemSize(void)
 	size = add_size(size, mul_size(TotalProcs, sizeof(*ProcGlobal->subxidStates)));
 	size = add_size(size, mul_size(TotalProcs, sizeof(*ProcGlobal->statusFlags)));
 
+	/* fast-path lock arrays */
+	size = add_size(size, mul_size(TotalProcs, FastPathLockShmemSize()));
+
 	return size;
 }
 
+/*
+ * Report shared-memory space needed for the fast-path lock arrays of one
+ * PGPROC.
+ */
+static Size
+FastPathLockShmemSize(void)
+{
+	return MAXALIGN(FastPathLockGroupsPerBackend * sizeof(uint64)) +
+		MAXALIGN(FP_LOCK_SLOTS_PER_BACKEND * sizeof(Oid));
+}
+
 /*
  * Report number of semaphores needed by InitProcGlobal.
  */
@@ -163,6 +178,7 @@ InitProcGlobal(void)
 				j;
 	bool		found;
 	uint32		TotalProcs = MaxBackends + NUM_AUXILIARY_PROCS + max_prepared_xacts;
+	char	   *fpPtr;
 
 	/* Create the ProcGlobal shared structure */
 	ProcGlobal = (PROC_HDR *)
@@ -212,10 +228,22 @@ InitProcGlobal(void)
 	ProcGlobal->statusFlags = (uint8 *) ShmemAlloc(TotalProcs * sizeof(*ProcGlobal->statusFlags));
 	MemSet(ProcGlobal->statusFlags, 0, TotalProcs * sizeof(*ProcGlobal->statusFlags));
 
+	/*
+	 * The fast-path lock arrays are sized at startup, so they are allocated
+	 * separately from the PGPROCs.
+	 */
+	fpPtr = (char *) ShmemAlloc(TotalProcs * FastPathLockShmemSize());
+	MemSet(fpPtr, 0, TotalProcs * FastPathLockShmemSize());
+
 	for (i = 0; i < TotalProcs; i++)
 	{
 		/* Common initialization for all PGPROCs, regardless of type. */
 
+		procs[i].fpLockBits = (uint64 *) fpPtr;
+		fpPtr += MAXALIGN(FastPathLockGroupsPerBackend * sizeof(uint64));
+		procs[i].fpRelId = (Oid *) fpPtr;
+		fpPtr += MAXALIGN(FP_LOCK_SLOTS_PER_BACKEND * sizeof(Oid));
+
 		/*
 		 * Set up per-PGPROC semaphore, latch, and fpInfoLock.  Prepared xact
 		 * dummy PGPROCs don't need these though - they're never associated
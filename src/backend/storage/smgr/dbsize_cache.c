@@ -0,0 +1,244 @@
+/*-------------------------------------------------------------------------
+ *
+ * dbsize_cache.c
+ *	  Shared-memory cache of database sizes.
+ *
+ * With a remote storage manager, pg_database_size() asks the storage for
+ * the size of the database through dbsize_hook, which is a request to the
+ * page server.  Monitoring tools that poll the size of every database
+ * every few seconds would keep the page server busy with those requests.
+ *
+ * This module caches the sizes returned by dbsize_hook in shared memory.  A
+ * cached size is maintained incrementally while it is cached: smgr.c adds
+ * the size of every block a relation of the database is extended with, and
+ * forgets the size when a relation is truncated or dropped, since it does
+ * not know how much smaller the database got.  A cached size is used for at
+ * most dbsize_cache_ttl seconds, which bounds the error of anything the
+ * incremental maintenance misses, such as an extension or truncation that
+ * raced with the request that filled the cache.
+ *
+ *
+ * Portions Copyright (c) 1996-2022, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/smgr/dbsize_cache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "port/atomics.h"
+#include "storage/dbsize_cache.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/hsearch.h"
+#include "utils/timestamp.h"
+
+/* maximum number of databases whose size is cached */
+#define DBSIZE_CACHE_ENTRIES	1024
+
+/* number of partitions of the hash table, each with its own lock */
+#define DBSIZE_CACHE_PARTITIONS	16
+
+typedef struct DbSizeEntry
+{
+	Oid			dbOid;			/* hash key, must be first */
+	TimestampTz fetched;		/* when size was obtained from the storage */
+	pg_atomic_uint64 size;		/* size in bytes */
+} DbSizeEntry;
+
+typedef struct DbSizeCacheCtl
+{
+	/*
+	 * Protect the partitions of the hash table, so that relations of
+	 * different databases are extended without contending for a lock.  The
+	 * sizes are updated atomically, under a shared lock.
+	 */
+	LWLockPadded locks[DBSIZE_CACHE_PARTITIONS];
+
+	/*
+	 * Number of cached sizes.  Read without a lock by DbSizeCacheExtend and
+	 * DbSizeCacheInvalidate, so that relation extension doesn't touch any
+	 * lock when nothing is cached, which is always the case unless
+	 * dbsize_hook is set.
+	 */
+	pg_atomic_uint32 nentries;
+} DbSizeCacheCtl;
+
+/* GUC variable: how long a cached size may be used, in seconds */
+int			dbsize_cache_ttl = 10;
+
+static DbSizeCacheCtl *dbSizeCache = NULL;
+static HTAB *dbSizeHash = NULL;
+
+/*
+ * DbSizeCacheShmemSize -- shared memory needed for the cache
+ */
+Size
+DbSizeCacheShmemSize(void)
+{
+	return add_size(MAXALIGN(sizeof(DbSizeCacheCtl)),
+					hash_estimate_size(DBSIZE_CACHE_ENTRIES,
+									   sizeof(DbSizeEntry)));
+}
+
+/*
+ * DbSizeCacheShmemInit -- allocate and initialize the cache
+ */
+void
+DbSizeCacheShmemInit(void)
+{
+	HASHCTL		info;
+	bool		found;
+
+	dbSizeCache = (DbSizeCacheCtl *)
+		ShmemInitStruct("dbsize_cache", sizeof(DbSizeCacheCtl), &found);
+	if (!found)
+	{
+		for (int i = 0; i < DBSIZE_CACHE_PARTITIONS; i++)
+			LWLockInitialize(&dbSizeCache->locks[i].lock,
+							 LWTRANCHE_DBSIZE_CACHE);
+		pg_atomic_init_u32(&dbSizeCache->nentries, 0);
+	}
+
+	info.keysize = sizeof(Oid);
+	info.entrysize = sizeof(DbSizeEntry);
+	info.num_partitions = DBSIZE_CACHE_PARTITIONS;
+	dbSizeHash = ShmemInitHash("dbsize_cache hash",
+							   DBSIZE_CACHE_ENTRIES, DBSIZE_CACHE_ENTRIES,
+							   &info,
+							   HASH_ELEM | HASH_BLOBS | HASH_PARTITION);
+}
+
+/*
+ * DbSizeCachePartitionLock -- get the lock of the partition holding the
+ * size of a database, and the hash code of its key
+ */
+static LWLock *
+DbSizeCachePartitionLock(Oid dbOid, uint32 *hashcode)
+{
+	*hashcode = get_hash_value(dbSizeHash, &dbOid);
+
+	return &dbSizeCache->locks[*hashcode % DBSIZE_CACHE_PARTITIONS].lock;
+}
+
+/*
+ * DbSizeCacheLookup -- get the cached size of a database
+ *
+ * Returns false if the size is not cached, or was obtained from the storage
+ * more than dbsize_cache_ttl seconds ago.
+ */
+bool
+DbSizeCacheLookup(Oid dbOid, int64 *size)
+{
+	DbSizeEntry *entry;
+	bool		result = false;
+	uint32		hashcode;
+	LWLock	   *partitionLock;
+
+	if (dbSizeCache == NULL || dbsize_cache_ttl <= 0)
+		return false;
+
+	partitionLock = DbSizeCachePartitionLock(dbOid, &hashcode);
+	LWLockAcquire(partitionLock, LW_SHARED);
+	entry = (DbSizeEntry *) hash_search_with_hash_value(dbSizeHash, &dbOid,
+														hashcode, HASH_FIND,
+														NULL);
+	if (entry != NULL &&
+		!TimestampDifferenceExceeds(entry->fetched, GetCurrentTimestamp(),
+									dbsize_cache_ttl * 1000))
+	{
+		*size = (int64) pg_atomic_read_u64(&entry->size);
+		result = true;
+	}
+	LWLockRelease(partitionLock);
+
+	return result;
+}
+
+/*
+ * DbSizeCacheStore -- cache the size of a database just obtained from the
+ * storage
+ */
+void
+DbSizeCacheStore(Oid dbOid, int64 size)
+{
+	DbSizeEntry *entry;
+	bool		found;
+	uint32		hashcode;
+	LWLock	   *partitionLock;
+
+	if (dbSizeCache == NULL || dbsize_cache_ttl <= 0)
+		return;
+
+	partitionLock = DbSizeCachePartitionLock(dbOid, &hashcode);
+	LWLockAcquire(partitionLock, LW_EXCLUSIVE);
+	entry = (DbSizeEntry *) hash_search_with_hash_value(dbSizeHash, &dbOid,
+														hashcode,
+														HASH_ENTER_NULL,
+														&found);
+	/* if the cache is full, just don't cache it */
+	if (entry != NULL)
+	{
+		entry->fetched = GetCurrentTimestamp();
+		if (found)
+			pg_atomic_write_u64(&entry->size, (uint64) size);
+		else
+		{
+			pg_atomic_init_u64(&entry->size, (uint64) size);
+			pg_atomic_fetch_add_u32(&dbSizeCache->nentries, 1);
+		}
+	}
+	LWLockRelease(partitionLock);
+}
+
+/*
+ * DbSizeCacheExtend -- report that a database has grown by "nbytes"
+ */
+void
+DbSizeCacheExtend(Oid dbOid, int64 nbytes)
+{
+	DbSizeEntry *entry;
+	uint32		hashcode;
+	LWLock	   *partitionLock;
+
+	if (dbSizeCache == NULL || dbsize_cache_ttl <= 0 ||
+		pg_atomic_read_u32(&dbSizeCache->nentries) == 0)
+		return;
+
+	partitionLock = DbSizeCachePartitionLock(dbOid, &hashcode);
+	LWLockAcquire(partitionLock, LW_SHARED);
+	entry = (DbSizeEntry *) hash_search_with_hash_value(dbSizeHash, &dbOid,
+														hashcode, HASH_FIND,
+														NULL);
+	if (entry != NULL)
+		pg_atomic_fetch_add_u64(&entry->size, nbytes);
+	LWLockRelease(partitionLock);
+}
+
+/*
+ * DbSizeCacheInvalidate -- forget the size of a database
+ *
+ * Used when a database shrinks by an unknown amount.
+ */
+void
+DbSizeCacheInvalidate(Oid dbOid)
+{
+	bool		found;
+	uint32		hashcode;
+	LWLock	   *partitionLock;
+
+	if (dbSizeCache == NULL ||
+		pg_atomic_read_u32(&dbSizeCache->nentries) == 0)
+		return;
+
+	partitionLock = DbSizeCachePartitionLock(dbOid, &hashcode);
+	LWLockAcquire(partitionLock, LW_EXCLUSIVE);
+	hash_search_with_hash_value(dbSizeHash, &dbOid, hashcode, HASH_REMOVE,
+								&found);
+	if (found)
+		pg_atomic_fetch_sub_u32(&dbSizeCache->nentries, 1);
+	LWLockRelease(partitionLock);
+}
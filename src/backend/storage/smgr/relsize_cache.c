@@ -0,0 +1,373 @@
+/*-------------------------------------------------------------------------
+ *
+ * relsize_cache.c
+ *	  Shared-memory cache of relation fork sizes.
+ *
+ * Asking the storage manager for the size of a relation fork can be
+ * expensive: with a remote storage manager, it is a round trip to the page
+ * server.  The size cached in each SMgrRelation can only be trusted during
+ * recovery, because nothing tells a backend that another one has extended
+ * the relation, so each new backend and each planner call would pay for it.
+ *
+ * This module keeps the sizes of recently used relation forks in shared
+ * memory instead.  smgr.c keeps the cache up to date for any storage
+ * manager: extending a fork raises its cached size, truncating it sets it,
+ * and dropping a relation or database forgets it.  Sizes only grow between
+ * those events, so a cached size never goes down: a size reported by the
+ * storage manager is merged in by keeping the larger of the two.
+ *
+ * A size read from the storage manager after a cache miss can still be
+ * stale by the time it is entered, if the fork was extended in between and
+ * the entry that extension made has been replaced again.  Entering it then
+ * would make the cache claim a smaller size than the fork has.  To prevent
+ * that, the cache counts the entries it drops; a lookup that misses returns
+ * the count, and the size read afterwards is only entered if no entry has
+ * been dropped since.  Truncation needs an AccessExclusiveLock on the
+ * relation, so nobody can look the size up concurrently.
+ *
+ * Entries are replaced in clock order when the cache is full.  Temporary
+ * relations are backend-local and are not cached here.
+ *
+ *
+ * Portions Copyright (c) 1996-2022, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/smgr/relsize_cache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+#include "storage/relsize_cache.h"
+#include "storage/shmem.h"
+#include "utils/hsearch.h"
+
+typedef struct RelSizeTag
+{
+	RelFileNode rnode;
+	ForkNumber	forknum;
+} RelSizeTag;
+
+typedef struct RelSizeSlot
+{
+	RelSizeTag	tag;
+	BlockNumber nblocks;
+	bool		valid;
+	pg_atomic_uint32 referenced;	/* set by lookups, cleared by the clock */
+} RelSizeSlot;
+
+/* entry of the hash table mapping fork tags to slots */
+typedef struct RelSizeHashEntry
+{
+	RelSizeTag	tag;			/* hash key, must be first */
+	int			slot;
+} RelSizeHashEntry;
+
+typedef struct RelSizeCacheCtl
+{
+	/* protects everything but the referenced flags */
+	LWLock		lock;
+	int			clock_hand;
+	uint64		generation;		/* number of entries dropped so far */
+	RelSizeSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} RelSizeCacheCtl;
+
+/* GUC variable: number of forks whose size is cached, 0 disables */
+int			relsize_cache_size = 8192;
+
+static RelSizeCacheCtl *relSizeCache = NULL;
+static HTAB *relSizeHash = NULL;
+
+static inline void
+InitRelSizeTag(RelSizeTag *tag, RelFileNode rnode, ForkNumber forknum)
+{
+	/* clear the padding, the tag is hashed as a blob */
+	MemSet(tag, 0, sizeof(RelSizeTag));
+	tag->rnode = rnode;
+	tag->forknum = forknum;
+}
+
+/*
+ * RelSizeCacheShmemSize -- shared memory needed for the cache
+ */
+Size
+RelSizeCacheShmemSize(void)
+{
+	Size		size;
+
+	if (relsize_cache_size <= 0)
+		return 0;
+
+	size = add_size(offsetof(RelSizeCacheCtl, slots),
+					mul_size(relsize_cache_size, sizeof(RelSizeSlot)));
+	size = MAXALIGN(size);
+	size = add_size(size, hash_estimate_size(relsize_cache_size,
+											 sizeof(RelSizeHashEntry)));
+	return size;
+}
+
+/*
+ * RelSizeCacheShmemInit -- allocate and initialize the cache
+ */
+void
+RelSizeCacheShmemInit(void)
+{
+	HASHCTL		info;
+	bool		found;
+
+	if (relsize_cache_size <= 0)
+		return;
+
+	relSizeCache = (RelSizeCacheCtl *)
+		ShmemInitStruct("relsize_cache",
+						add_size(offsetof(RelSizeCacheCtl, slots),
+								 mul_size(relsize_cache_size,
+										  sizeof(RelSizeSlot))),
+						&found);
+	if (!found)
+	{
+		LWLockInitialize(&relSizeCache->lock, LWTRANCHE_RELSIZE_CACHE);
+		relSizeCache->clock_hand = 0;
+		relSizeCache->generation = 0;
+		for (int i = 0; i < relsize_cache_size; i++)
+		{
+			relSizeCache->slots[i].valid = false;
+			pg_atomic_init_u32(&relSizeCache->slots[i].referenced, 0);
+		}
+	}
+
+	info.keysize = sizeof(RelSizeTag);
+	info.entrysize = sizeof(RelSizeHashEntry);
+	relSizeHash = ShmemInitHash("relsize_cache hash",
+								relsize_cache_size, relsize_cache_size,
+								&info, HASH_ELEM | HASH_BLOBS);
+}
+
+/*
+ * RelSizeCacheEnter -- find or create the slot of a fork
+ *
+ * The caller must hold the lock exclusively.  A new slot has valid set and
+ * nblocks set to InvalidBlockNumber.
+ */
+static RelSizeSlot *
+RelSizeCacheEnter(RelSizeTag *tag)
+{
+	RelSizeHashEntry *entry;
+	RelSizeSlot *slot;
+	bool		found;
+
+	entry = (RelSizeHashEntry *) hash_search(relSizeHash, tag, HASH_FIND,
+											 NULL);
+	if (entry != NULL)
+		return &relSizeCache->slots[entry->slot];
+
+	/* find a victim: an unused slot, or one not referenced lately */
+	for (;;)
+	{
+		slot = &relSizeCache->slots[relSizeCache->clock_hand];
+		if (++relSizeCache->clock_hand >= relsize_cache_size)
+			relSizeCache->clock_hand = 0;
+
+		if (!slot->valid)
+			break;
+		if (pg_atomic_read_u32(&slot->referenced) == 0)
+		{
+			if (hash_search(relSizeHash, &slot->tag, HASH_REMOVE,
+							NULL) == NULL)
+				elog(ERROR, "relsize cache hash table corrupted");
+			relSizeCache->generation++;
+			break;
+		}
+		pg_atomic_write_u32(&slot->referenced, 0);
+	}
+
+	entry = (RelSizeHashEntry *) hash_search(relSizeHash, tag, HASH_ENTER,
+											 &found);
+	Assert(!found);
+	entry->slot = slot - relSizeCache->slots;
+
+	slot->tag = *tag;
+	slot->nblocks = InvalidBlockNumber;
+	slot->valid = true;
+	pg_atomic_write_u32(&slot->referenced, 1);
+
+	return slot;
+}
+
+/*
+ * RelSizeCacheLookup -- get the cached size of a relation fork
+ *
+ * Returns InvalidBlockNumber if it is not cached.  *generation is set to
+ * pass to RelSizeCacheFill along with the size the caller then reads from
+ * the storage manager.
+ */
+BlockNumber
+RelSizeCacheLookup(RelFileNode rnode, ForkNumber forknum, uint64 *generation)
+{
+	RelSizeTag	tag;
+	RelSizeHashEntry *entry;
+	BlockNumber result = InvalidBlockNumber;
+
+	*generation = 0;
+	if (relSizeCache == NULL)
+		return InvalidBlockNumber;
+
+	InitRelSizeTag(&tag, rnode, forknum);
+
+	LWLockAcquire(&relSizeCache->lock, LW_SHARED);
+	entry = (RelSizeHashEntry *) hash_search(relSizeHash, &tag, HASH_FIND,
+											 NULL);
+	if (entry != NULL)
+	{
+		RelSizeSlot *slot = &relSizeCache->slots[entry->slot];
+
+		result = slot->nblocks;
+		pg_atomic_write_u32(&slot->referenced, 1);
+	}
+	*generation = relSizeCache->generation;
+	LWLockRelease(&relSizeCache->lock);
+
+	return result;
+}
+
+/*
+ * RelSizeCacheExtend -- report that a relation fork has been extended to at
+ * least "nblocks" blocks
+ */
+void
+RelSizeCacheExtend(RelFileNode rnode, ForkNumber forknum, BlockNumber nblocks)
+{
+	RelSizeTag	tag;
+	RelSizeSlot *slot;
+
+	if (relSizeCache == NULL || nblocks == InvalidBlockNumber)
+		return;
+
+	InitRelSizeTag(&tag, rnode, forknum);
+
+	LWLockAcquire(&relSizeCache->lock, LW_EXCLUSIVE);
+	slot = RelSizeCacheEnter(&tag);
+	if (slot->nblocks == InvalidBlockNumber || slot->nblocks < nblocks)
+		slot->nblocks = nblocks;
+	LWLockRelease(&relSizeCache->lock);
+}
+
+/*
+ * RelSizeCacheFill -- enter the size of a relation fork read from the
+ * storage manager after RelSizeCacheLookup missed
+ *
+ * "generation" is what that lookup returned.  If an entry has been dropped
+ * since, the fork may have been extended and its entry dropped while the
+ * size was read, so the size is only merged into an entry that exists.
+ */
+void
+RelSizeCacheFill(RelFileNode rnode, ForkNumber forknum, BlockNumber nblocks,
+				 uint64 generation)
+{
+	RelSizeTag	tag;
+	RelSizeSlot *slot = NULL;
+
+	if (relSizeCache == NULL || nblocks == InvalidBlockNumber)
+		return;
+
+	InitRelSizeTag(&tag, rnode, forknum);
+
+	LWLockAcquire(&relSizeCache->lock, LW_EXCLUSIVE);
+	if (relSizeCache->generation == generation)
+		slot = RelSizeCacheEnter(&tag);
+	else
+	{
+		RelSizeHashEntry *entry;
+
+		entry = (RelSizeHashEntry *) hash_search(relSizeHash, &tag,
+												 HASH_FIND, NULL);
+		if (entry != NULL)
+			slot = &relSizeCache->slots[entry->slot];
+	}
+	if (slot != NULL &&
+		(slot->nblocks == InvalidBlockNumber || slot->nblocks < nblocks))
+		slot->nblocks = nblocks;
+	LWLockRelease(&relSizeCache->lock);
+}
+
+/*
+ * RelSizeCacheSet -- report that a relation fork has exactly "nblocks"
+ * blocks
+ *
+ * Used when a fork has been created or truncated, which the caller must
+ * prevent from happening concurrently with other size changes and lookups.
+ */
+void
+RelSizeCacheSet(RelFileNode rnode, ForkNumber forknum, BlockNumber nblocks)
+{
+	RelSizeTag	tag;
+	RelSizeSlot *slot;
+
+	if (relSizeCache == NULL)
+		return;
+
+	InitRelSizeTag(&tag, rnode, forknum);
+
+	LWLockAcquire(&relSizeCache->lock, LW_EXCLUSIVE);
+	slot = RelSizeCacheEnter(&tag);
+	slot->nblocks = nblocks;
+	LWLockRelease(&relSizeCache->lock);
+}
+
+/*
+ * RelSizeCacheForget -- forget the size of a relation fork
+ */
+void
+RelSizeCacheForget(RelFileNode rnode, ForkNumber forknum)
+{
+	RelSizeTag	tag;
+	RelSizeHashEntry *entry;
+
+	if (relSizeCache == NULL)
+		return;
+
+	InitRelSizeTag(&tag, rnode, forknum);
+
+	LWLockAcquire(&relSizeCache->lock, LW_EXCLUSIVE);
+	entry = (RelSizeHashEntry *) hash_search(relSizeHash, &tag, HASH_REMOVE,
+											 NULL);
+	if (entry != NULL)
+	{
+		relSizeCache->slots[entry->slot].valid = false;
+		relSizeCache->generation++;
+	}
+	LWLockRelease(&relSizeCache->lock);
+}
+
+/*
+ * RelSizeCacheForgetDatabase -- forget the sizes of all forks of a database
+ *
+ * Used when a database is dropped and its files are removed wholesale,
+ * without going through smgrdounlinkall.
+ */
+void
+RelSizeCacheForgetDatabase(Oid dbid)
+{
+	if (relSizeCache == NULL)
+		return;
+
+	LWLockAcquire(&relSizeCache->lock, LW_EXCLUSIVE);
+	for (int i = 0; i < relsize_cache_size; i++)
+	{
+		RelSizeSlot *slot = &relSizeCache->slots[i];
+
+		if (slot->valid && slot->tag.rnode.dbNode == dbid)
+		{
+			if (hash_search(relSizeHash, &slot->tag, HASH_REMOVE,
+							NULL) == NULL)
+				elog(ERROR, "relsize cache hash table corrupted");
+			slot->valid = false;
+			relSizeCache->generation++;
+		}
+	}
+	LWLockRelease(&relSizeCache->lock);
+}
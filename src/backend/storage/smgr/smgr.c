@@ -17,12 +17,16 @@
  */
 #include "postgres.h"
 
+#include "access/xlog.h"
 #include "access/xlogutils.h"
 #include "catalog/pg_tablespace.h"
 #include "lib/ilist.h"
+#include "pgstat.h"
 #include "storage/bufmgr.h"
+#include "storage/dbsize_cache.h"
 #include "storage/ipc.h"
 #include "storage/md.h"
+#include "storage/relsize_cache.h"
 #include "storage/smgr.h"
 #include "utils/hsearch.h"
 #include "utils/inval.h"
@@ -37,6 +41,7 @@ static const f_smgr smgr_md = {
 		.smgr_exists = mdexists,
 		.smgr_unlink = mdunlink,
 		.smgr_extend = mdextend,
+		.smgr_zeroextend = mdzeroextend,
 		.smgr_prefetch = mdprefetch,
 		.smgr_read = mdread,
 		.smgr_write = mdwrite,
@@ -57,6 +62,45 @@ static dlist_head unowned_relns;
 /* local function prototypes */
 //static void smgrshutdown(int code, Datum arg);
 
+/*
+ * Time the storage manager operations that may have to wait for the storage,
+ * if track_io_timing is enabled, for pg_stat_smgr_latency.
+ */
+static inline void
+smgr_timing_start(instr_time *start)
+{
+	if (track_io_timing)
+		INSTR_TIME_SET_CURRENT(*start);
+	else
+		INSTR_TIME_SET_ZERO(*start);
+}
+
+static inline void
+smgr_timing_end(PgStat_SmgrOp op, instr_time *start)
+{
+	instr_time	io_time;
+
+	if (INSTR_TIME_IS_ZERO(*start))
+		return;
+
+	INSTR_TIME_SET_CURRENT(io_time);
+	INSTR_TIME_SUBTRACT(io_time, *start);
+	pgstat_count_smgr_op(op, io_time);
+}
+
+/*
+ * Can the shared relation size cache be used for this relation?
+ *
+ * Temporary relations are backend-local.  During recovery, the redo filter
+ * may skip extending relations whose pages are not in the buffer pool, so
+ * sizes are neither cached nor looked up until recovery has ended.
+ */
+static inline bool
+smgr_use_relsize_cache(SMgrRelation reln)
+{
+	return !SmgrIsTemp(reln) && !RecoveryInProgress();
+}
+
 
 /*
  *	smgrinit(), smgrshutdown() -- Initialize or shut down storage
@@ -262,7 +306,14 @@ smgrclearowner(SMgrRelation *owner, SMgrRelation reln)
 bool
 smgrexists(SMgrRelation reln, ForkNumber forknum)
 {
-	return (*reln->smgr).smgr_exists(reln, forknum);
+	instr_time	io_start;
+	bool		result;
+
+	smgr_timing_start(&io_start);
+	result = (*reln->smgr).smgr_exists(reln, forknum);
+	smgr_timing_end(PGSTAT_SMGR_EXISTS, &io_start);
+
+	return result;
 }
 
 /*
@@ -385,6 +436,10 @@ void
 smgrcreate(SMgrRelation reln, ForkNumber forknum, bool isRedo)
 {
 	(*reln->smgr).smgr_create(reln, forknum, isRedo);
+
+	/* a newly created fork is empty; in redo, it may have existed already */
+	if (!isRedo && smgr_use_relsize_cache(reln))
+		RelSizeCacheSet(reln->smgr_rnode.node, forknum, 0);
 }
 
 /*
@@ -457,9 +512,16 @@ smgrdounlinkall(SMgrRelation *rels, int nrels, bool isRedo)
 
 		rnodes[i] = rnode;
 
-		/* Close the forks at smgr level */
+		if (!RelFileNodeBackendIsTemp(rnode))
+			DbSizeCacheInvalidate(rnode.node.dbNode);
+
+		/* Close the forks at smgr level, and forget their sizes */
 		for (forknum = 0; forknum <= MAX_FORKNUM; forknum++)
+		{
 			(*rels[i]->smgr).smgr_close(rels[i], forknum);
+			if (!RelFileNodeBackendIsTemp(rnode))
+				RelSizeCacheForget(rnode.node, forknum);
+		}
 	}
 
 	/*
@@ -516,6 +578,67 @@ smgrextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 		reln->smgr_cached_nblocks[forknum] = blocknum + 1;
 	else
 		reln->smgr_cached_nblocks[forknum] = InvalidBlockNumber;
+
+	if (smgr_use_relsize_cache(reln))
+		RelSizeCacheExtend(reln->smgr_rnode.node, forknum, blocknum + 1);
+	if (!SmgrIsTemp(reln))
+		DbSizeCacheExtend(reln->smgr_rnode.node.dbNode, BLCKSZ);
+}
+
+/*
+ *	smgrzeroextend() -- Add new zeroed out blocks to a file.
+ *
+ *		Similar to smgrextend(), except the relation can be extended by
+ *		multiple blocks at once and the added blocks will be filled with
+ *		zeroes.  Storage managers that can do that cheaper than block by
+ *		block provide smgr_zeroextend; for the others we fall back to one
+ *		smgr_extend per block.
+ */
+void
+smgrzeroextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+			   int nblocks, bool skipFsync)
+{
+	Assert(nblocks > 0);
+
+	if ((*reln->smgr).smgr_zeroextend)
+		(*reln->smgr).smgr_zeroextend(reln, forknum, blocknum,
+									  nblocks, skipFsync);
+	else
+	{
+		PGAlignedBlock zerobuf = {{0}};
+
+		for (int i = 0; i < nblocks; i++)
+			(*reln->smgr).smgr_extend(reln, forknum, blocknum + i,
+									  zerobuf.data, skipFsync);
+	}
+
+	/*
+	 * Normally we expect this to increase the fork size by nblocks, but if
+	 * the cached value isn't as expected, just invalidate it so the next call
+	 * asks the kernel.
+	 */
+	if (reln->smgr_cached_nblocks[forknum] == blocknum)
+		reln->smgr_cached_nblocks[forknum] = blocknum + nblocks;
+	else
+		reln->smgr_cached_nblocks[forknum] = InvalidBlockNumber;
+
+	if (smgr_use_relsize_cache(reln))
+		RelSizeCacheExtend(reln->smgr_rnode.node, forknum, blocknum + nblocks);
+	if (!SmgrIsTemp(reln))
+		DbSizeCacheExtend(reln->smgr_rnode.node.dbNode,
+						  (int64) nblocks * BLCKSZ);
+}
+
+/*
+ *	smgrcanzeroextend() -- Does the storage manager provide smgr_zeroextend?
+ *
+ *		Callers that would otherwise extend through shared buffers use this to
+ *		decide whether bypassing them with smgrzeroextend() is worthwhile.
+ */
+bool
+smgrcanzeroextend(SMgrRelation reln)
+{
+	return (*reln->smgr).smgr_zeroextend != NULL;
 }
 
 /*
@@ -528,7 +651,55 @@ smgrextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 bool
 smgrprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum)
 {
-	return (*reln->smgr).smgr_prefetch(reln, forknum, blocknum);
+	instr_time	io_start;
+	bool		result;
+
+	smgr_timing_start(&io_start);
+	result = (*reln->smgr).smgr_prefetch(reln, forknum, blocknum);
+	smgr_timing_end(PGSTAT_SMGR_PREFETCH, &io_start);
+
+	return result;
+}
+
+/*
+ *	smgrprefetchv() -- Initiate asynchronous reads of a set of blocks of a
+ *					   relation.
+ *
+ *		The blocks need not be consecutive.  Storage managers that can pack
+ *		several requests into one message provide smgr_prefetchv; for the
+ *		others we issue one smgr_prefetch per block, carrying on past blocks
+ *		that fail.  Returns the number of blocks for which a read was
+ *		initiated; like smgrprefetch(), this can fall short in recovery if the
+ *		file doesn't exist.
+ */
+int
+smgrprefetchv(SMgrRelation reln, ForkNumber forknum, BlockNumber *blocknums,
+			  int nblocks)
+{
+	instr_time	io_start;
+	int			ninitiated = 0;
+
+	if (nblocks <= 0)
+		return 0;
+
+	/* a vectored request counts as one call */
+	smgr_timing_start(&io_start);
+	if ((*reln->smgr).smgr_prefetchv)
+	{
+		if ((*reln->smgr).smgr_prefetchv(reln, forknum, blocknums, nblocks))
+			ninitiated = nblocks;
+	}
+	else
+	{
+		for (int i = 0; i < nblocks; i++)
+		{
+			if ((*reln->smgr).smgr_prefetch(reln, forknum, blocknums[i]))
+				ninitiated++;
+		}
+	}
+	smgr_timing_end(PGSTAT_SMGR_PREFETCH, &io_start);
+
+	return ninitiated;
 }
 
 /*
@@ -543,7 +714,85 @@ void
 smgrread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 		 char *buffer)
 {
+	instr_time	io_start;
+
+	smgr_timing_start(&io_start);
 	(*reln->smgr).smgr_read(reln, forknum, blocknum, buffer);
+	smgr_timing_end(PGSTAT_SMGR_READ, &io_start);
+}
+
+/*
+ *	smgrreadv() -- read a run of consecutive blocks of a relation into the
+ *				   supplied buffers.
+ *
+ *		buffers[i] receives block blocknum + i.  Storage managers that can
+ *		fetch several pages in one request (e.g. over the network) provide
+ *		smgr_readv; for the others we fall back to one smgr_read per block.
+ */
+void
+smgrreadv(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+		  int nblocks, char **buffers)
+{
+	instr_time	io_start;
+
+	Assert(nblocks > 0);
+
+	/* a vectored request counts as one call */
+	smgr_timing_start(&io_start);
+	if ((*reln->smgr).smgr_readv)
+		(*reln->smgr).smgr_readv(reln, forknum, blocknum, nblocks, buffers);
+	else
+	{
+		for (int i = 0; i < nblocks; i++)
+			(*reln->smgr).smgr_read(reln, forknum, blocknum + i, buffers[i]);
+	}
+	smgr_timing_end(PGSTAT_SMGR_READ, &io_start);
+}
+
+/*
+ *	smgrstartread() -- Start reading a block of a relation, without waiting
+ *					   for it.
+ *
+ *		The page is to be collected later with smgrwaitread(), but it is fine
+ *		not to.  Storage managers that don't support asynchronous reads
+ *		merely prefetch the block.  Like smgrprefetch(), this can return false
+ *		in recovery if the file doesn't exist.
+ */
+bool
+smgrstartread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum)
+{
+	instr_time	io_start;
+	bool		result;
+
+	smgr_timing_start(&io_start);
+	if ((*reln->smgr).smgr_startread)
+		result = (*reln->smgr).smgr_startread(reln, forknum, blocknum);
+	else
+		result = (*reln->smgr).smgr_prefetch(reln, forknum, blocknum);
+	smgr_timing_end(PGSTAT_SMGR_PREFETCH, &io_start);
+
+	return result;
+}
+
+/*
+ *	smgrwaitread() -- collect a block whose read was started with
+ *					  smgrstartread() into the supplied buffer.
+ *
+ *		This waits for the read to complete if it hasn't yet.  For storage
+ *		managers that don't support asynchronous reads, this is a plain read.
+ */
+void
+smgrwaitread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+			 char *buffer)
+{
+	instr_time	io_start;
+
+	smgr_timing_start(&io_start);
+	if ((*reln->smgr).smgr_waitread)
+		(*reln->smgr).smgr_waitread(reln, forknum, blocknum, buffer);
+	else
+		(*reln->smgr).smgr_read(reln, forknum, blocknum, buffer);
+	smgr_timing_end(PGSTAT_SMGR_READ, &io_start);
 }
 
 /*
@@ -589,16 +838,38 @@ smgrwriteback(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 BlockNumber
 smgrnblocks(SMgrRelation reln, ForkNumber forknum)
 {
+	instr_time	io_start;
 	BlockNumber result;
+	uint64		generation = 0;
 
 	/* Check and return if we get the cached value for the number of blocks. */
 	result = smgrnblocks_cached(reln, forknum);
 	if (result != InvalidBlockNumber)
 		return result;
 
+	/*
+	 * The shared relation size cache is kept up to date by all backends, so
+	 * unlike the local value it can be trusted outside recovery, too.
+	 */
+	if (smgr_use_relsize_cache(reln))
+	{
+		result = RelSizeCacheLookup(reln->smgr_rnode.node, forknum,
+									&generation);
+		if (result != InvalidBlockNumber)
+		{
+			reln->smgr_cached_nblocks[forknum] = result;
+			return result;
+		}
+	}
+
+	/* only calls that reach the storage manager are timed */
+	smgr_timing_start(&io_start);
 	result = (*reln->smgr).smgr_nblocks(reln, forknum);
+	smgr_timing_end(PGSTAT_SMGR_NBLOCKS, &io_start);
 
 	reln->smgr_cached_nblocks[forknum] = result;
+	if (smgr_use_relsize_cache(reln))
+		RelSizeCacheFill(reln->smgr_rnode.node, forknum, result, generation);
 
 	return result;
 }
@@ -656,11 +927,16 @@ smgrtruncate(SMgrRelation reln, ForkNumber *forknum, int nforks, BlockNumber *nb
 	 */
 	CacheInvalidateSmgr(reln->smgr_rnode);
 
+	if (!SmgrIsTemp(reln))
+		DbSizeCacheInvalidate(reln->smgr_rnode.node.dbNode);
+
 	/* Do the truncation */
 	for (i = 0; i < nforks; i++)
 	{
 		/* Make the cached size is invalid if we encounter an error. */
 		reln->smgr_cached_nblocks[forknum[i]] = InvalidBlockNumber;
+		if (!SmgrIsTemp(reln))
+			RelSizeCacheForget(reln->smgr_rnode.node, forknum[i]);
 
 		(*reln->smgr).smgr_truncate(reln, forknum[i], nblocks[i]);
 
@@ -672,6 +948,8 @@ smgrtruncate(SMgrRelation reln, ForkNumber *forknum, int nforks, BlockNumber *nb
 		 * But these ensure they aren't outright wrong until then.
 		 */
 		reln->smgr_cached_nblocks[forknum[i]] = nblocks[i];
+		if (smgr_use_relsize_cache(reln))
+			RelSizeCacheSet(reln->smgr_rnode.node, forknum[i], nblocks[i]);
 	}
 }
 
@@ -39,6 +39,7 @@
 #include "access/parallel.h"
 #include "access/printtup.h"
 #include "access/xact.h"
+#include "access/xloginsert.h"
 #include "catalog/pg_type.h"
 #include "commands/async.h"
 #include "commands/prepare.h"
@@ -3408,9 +3409,15 @@ ProcessInterrupts(void)
 	if (LogMemoryContextPending)
 		ProcessLogMemoryContextInterrupt();
 
-	/* Call registered callback if any */
-	if (ProcessInterruptsCallback)
+	/*
+	 * The proportional WAL backpressure sleep replaces the throttling done by
+	 * the callback, so don't call it if we just slept.
+	 */
+	if (WalBackpressurePending)
+		ProcessWalBackpressure();
+	else if (ProcessInterruptsCallback)
 	{
+		/* Call registered callback if any */
 		if (ProcessInterruptsCallback())
 			goto Retry;
 	}
@@ -4038,7 +4045,7 @@ PostgresSingleUserMain(int argc, char *argv[],
 	 */
 	process_shared_preload_libraries();
 
-	/* Initialize MaxBackends */
+	/* Initialize MaxBackends and the size of the fast-path lock arrays */
 	InitializeMaxBackends();
 
 	/*
@@ -399,6 +399,7 @@ pgstat_bestart(void)
 	lbeentry.st_progress_command = PROGRESS_COMMAND_INVALID;
 	lbeentry.st_progress_command_target = InvalidOid;
 	lbeentry.st_query_id = UINT64CONST(0);
+	lbeentry.st_allocated_bytes = backend_allocated_bytes;
 
 	/*
 	 * we don't zero st_progress_param here to save cycles; nobody should
@@ -446,6 +447,9 @@ pgstat_bestart(void)
 
 	PGSTAT_END_WRITE_ACTIVITY(vbeentry);
 
+	/* From now on, report our memory in the entry */
+	BackendMemorySetReporting(true);
+
 	/* Update app name to current GUC setting */
 	if (application_name)
 		pgstat_report_appname(application_name);
@@ -459,6 +463,9 @@ pgstat_beshutdown_hook(int code, Datum arg)
 {
 	volatile PgBackendStatus *beentry = MyBEEntry;
 
+	/* Stop reporting our memory in the entry */
+	BackendMemorySetReporting(false);
+
 	/*
 	 * Clear my status entry, following the protocol of bumping st_changecount
 	 * before and after.  We use a volatile pointer here to ensure the
@@ -661,6 +668,30 @@ pgstat_report_query_id(uint64 query_id, bool force)
 }
 
 
+/* ----------
+ * pgstat_report_allocated_bytes() -
+ *
+ *	Called from mcxt.c to report the memory allocated by the memory contexts
+ *	of the backend, whenever that changes.  This follows the st_changecount
+ *	protocol, so readers of the entry see a consistent value even where
+ *	64-bit stores aren't atomic.  Memory must not be allocated or freed
+ *	between PGSTAT_BEGIN_WRITE_ACTIVITY and PGSTAT_END_WRITE_ACTIVITY, as
+ *	that would nest the protocol.
+ * ----------
+ */
+void
+pgstat_report_allocated_bytes(uint64 allocated_bytes)
+{
+	volatile PgBackendStatus *beentry = MyBEEntry;
+
+	if (!beentry)
+		return;
+
+	PGSTAT_BEGIN_WRITE_ACTIVITY(beentry);
+	beentry->st_allocated_bytes = allocated_bytes;
+	PGSTAT_END_WRITE_ACTIVITY(beentry);
+}
+
 /* ----------
  * pgstat_report_appname() -
  *
@@ -72,9 +72,11 @@
  * - pgstat_checkpointer.c
  * - pgstat_database.c
  * - pgstat_function.c
+ * - pgstat_lastwrittenlsn.c
  * - pgstat_relation.c
  * - pgstat_replslot.c
  * - pgstat_slru.c
+ * - pgstat_smgr.c
  * - pgstat_subscription.c
  * - pgstat_wal.c
  *
@@ -383,6 +385,24 @@ static const PgStat_KindInfo pgstat_kind_infos[PGSTAT_NUM_KINDS] = {
 		.reset_all_cb = pgstat_wal_reset_all_cb,
 		.snapshot_cb = pgstat_wal_snapshot_cb,
 	},
+
+	[PGSTAT_KIND_LWLSN_CACHE] = {
+		.name = "last_written_lsn_cache",
+
+		.fixed_amount = true,
+
+		.reset_all_cb = pgstat_lwlsn_cache_reset_all_cb,
+		.snapshot_cb = pgstat_lwlsn_cache_snapshot_cb,
+	},
+
+	[PGSTAT_KIND_SMGR] = {
+		.name = "smgr",
+
+		.fixed_amount = true,
+
+		.reset_all_cb = pgstat_smgr_reset_all_cb,
+		.snapshot_cb = pgstat_smgr_snapshot_cb,
+	},
 };
 
 
@@ -590,6 +610,8 @@ pgstat_report_stat(bool force)
 	/* Don't expend a clock check if nothing to do */
 	if (dlist_is_empty(&pgStatPending) &&
 		!have_slrustats &&
+		!have_lwlsnstats &&
+		!have_smgrstats &&
 		!pgstat_have_pending_wal())
 	{
 		Assert(pending_since == 0);
@@ -641,6 +663,12 @@ pgstat_report_stat(bool force)
 	/* flush SLRU stats */
 	partial_flush |= pgstat_slru_flush(nowait);
 
+	/* flush last written LSN cache stats */
+	partial_flush |= pgstat_lwlsn_cache_flush(nowait);
+
+	/* flush storage manager latency stats */
+	partial_flush |= pgstat_smgr_flush(nowait);
+
 	last_flush = now;
 
 	/*
@@ -1350,6 +1378,18 @@ pgstat_write_statsfile(void)
 	pgstat_build_snapshot_fixed(PGSTAT_KIND_WAL);
 	write_chunk_s(fpout, &pgStatLocal.snapshot.wal);
 
+	/*
+	 * Write last written LSN cache stats struct
+	 */
+	pgstat_build_snapshot_fixed(PGSTAT_KIND_LWLSN_CACHE);
+	write_chunk_s(fpout, &pgStatLocal.snapshot.lwlsn_cache);
+
+	/*
+	 * Write storage manager stats struct
+	 */
+	pgstat_build_snapshot_fixed(PGSTAT_KIND_SMGR);
+	write_chunk_s(fpout, &pgStatLocal.snapshot.smgr);
+
 	/*
 	 * Walk through the stats entries
 	 */
@@ -1524,6 +1564,18 @@ pgstat_read_statsfile(void)
 	if (!read_chunk_s(fpin, &shmem->wal.stats))
 		goto error;
 
+	/*
+	 * Read last written LSN cache stats struct
+	 */
+	if (!read_chunk_s(fpin, &shmem->lwlsn_cache.stats))
+		goto error;
+
+	/*
+	 * Read storage manager stats struct
+	 */
+	if (!read_chunk_s(fpin, &shmem->smgr.stats))
+		goto error;
+
 	/*
 	 * We found an existing statistics file. Read it and put all the hash
 	 * table entries into place.
@@ -0,0 +1,147 @@
+/* -------------------------------------------------------------------------
+ *
+ * pgstat_lastwrittenlsn.c
+ *	  Implementation of last written LSN cache statistics.
+ *
+ * This file contains the implementation of statistics for the last written
+ * LSN cache maintained in xlog.c.  It is kept separate from pgstat.c to
+ * enforce the line between the statistics access / storage implementation
+ * and the details about individual types of statistics.
+ *
+ * Copyright (c) 2001-2022, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/activity/pgstat_lastwrittenlsn.c
+ * -------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "utils/pgstat_internal.h"
+
+
+/*
+ * Last written LSN cache counts waiting to be flushed out.  The cache is
+ * consulted in critical sections, so we use static memory in order to avoid
+ * memory allocation.
+ */
+static PgStat_LastWrittenLsnCacheStats PendingLastWrittenLsnCacheStats;
+bool		have_lwlsnstats = false;
+
+
+/*
+ * Last written LSN cache statistics count accumulation functions --- called
+ * from xlog.c
+ */
+
+void
+pgstat_count_lwlsn_page_hit(void)
+{
+	PendingLastWrittenLsnCacheStats.page_hits++;
+	have_lwlsnstats = true;
+}
+
+void
+pgstat_count_lwlsn_range_hit(void)
+{
+	PendingLastWrittenLsnCacheStats.range_hits++;
+	have_lwlsnstats = true;
+}
+
+void
+pgstat_count_lwlsn_miss(void)
+{
+	PendingLastWrittenLsnCacheStats.misses++;
+	have_lwlsnstats = true;
+}
+
+void
+pgstat_count_lwlsn_eviction(bool range)
+{
+	if (range)
+		PendingLastWrittenLsnCacheStats.range_evictions++;
+	else
+		PendingLastWrittenLsnCacheStats.page_evictions++;
+	have_lwlsnstats = true;
+}
+
+void
+pgstat_count_lwlsn_lock_wait(PgStat_Counter wait_time)
+{
+	PendingLastWrittenLsnCacheStats.lock_waits++;
+	PendingLastWrittenLsnCacheStats.lock_wait_time += wait_time;
+	have_lwlsnstats = true;
+}
+
+/*
+ * Support function for the SQL-callable pgstat* functions. Returns
+ * a pointer to the last written LSN cache statistics struct.
+ */
+PgStat_LastWrittenLsnCacheStats *
+pgstat_fetch_stat_lwlsn_cache(void)
+{
+	pgstat_snapshot_fixed(PGSTAT_KIND_LWLSN_CACHE);
+
+	return &pgStatLocal.snapshot.lwlsn_cache;
+}
+
+/*
+ * Flush out locally pending last written LSN cache stats entries
+ *
+ * If nowait is true, this function returns true if the lock could not be
+ * acquired. Otherwise return false.
+ */
+bool
+pgstat_lwlsn_cache_flush(bool nowait)
+{
+	PgStatShared_LastWrittenLsnCache *stats_shmem = &pgStatLocal.shmem->lwlsn_cache;
+
+	if (!have_lwlsnstats)
+		return false;
+
+	if (!nowait)
+		LWLockAcquire(&stats_shmem->lock, LW_EXCLUSIVE);
+	else if (!LWLockConditionalAcquire(&stats_shmem->lock, LW_EXCLUSIVE))
+		return true;
+
+#define LWLSNSTAT_ACC(fld) stats_shmem->stats.fld += PendingLastWrittenLsnCacheStats.fld
+	LWLSNSTAT_ACC(page_hits);
+	LWLSNSTAT_ACC(range_hits);
+	LWLSNSTAT_ACC(misses);
+	LWLSNSTAT_ACC(page_evictions);
+	LWLSNSTAT_ACC(range_evictions);
+	LWLSNSTAT_ACC(lock_waits);
+	LWLSNSTAT_ACC(lock_wait_time);
+#undef LWLSNSTAT_ACC
+
+	LWLockRelease(&stats_shmem->lock);
+
+	/* done, clear the pending entry */
+	MemSet(&PendingLastWrittenLsnCacheStats, 0,
+		   sizeof(PendingLastWrittenLsnCacheStats));
+	have_lwlsnstats = false;
+
+	return false;
+}
+
+void
+pgstat_lwlsn_cache_reset_all_cb(TimestampTz ts)
+{
+	PgStatShared_LastWrittenLsnCache *stats_shmem = &pgStatLocal.shmem->lwlsn_cache;
+
+	LWLockAcquire(&stats_shmem->lock, LW_EXCLUSIVE);
+	memset(&stats_shmem->stats, 0, sizeof(stats_shmem->stats));
+	stats_shmem->stats.stat_reset_timestamp = ts;
+	LWLockRelease(&stats_shmem->lock);
+}
+
+void
+pgstat_lwlsn_cache_snapshot_cb(void)
+{
+	PgStatShared_LastWrittenLsnCache *stats_shmem = &pgStatLocal.shmem->lwlsn_cache;
+
+	LWLockAcquire(&stats_shmem->lock, LW_SHARED);
+	memcpy(&pgStatLocal.snapshot.lwlsn_cache, &stats_shmem->stats,
+		   sizeof(pgStatLocal.snapshot.lwlsn_cache));
+	LWLockRelease(&stats_shmem->lock);
+}
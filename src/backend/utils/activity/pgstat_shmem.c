@@ -202,6 +202,8 @@ StatsShmemInit(void)
 		LWLockInitialize(&ctl->checkpointer.lock, LWTRANCHE_PGSTATS_DATA);
 		LWLockInitialize(&ctl->slru.lock, LWTRANCHE_PGSTATS_DATA);
 		LWLockInitialize(&ctl->wal.lock, LWTRANCHE_PGSTATS_DATA);
+		LWLockInitialize(&ctl->lwlsn_cache.lock, LWTRANCHE_PGSTATS_DATA);
+		LWLockInitialize(&ctl->smgr.lock, LWTRANCHE_PGSTATS_DATA);
 	}
 	else
 	{
@@ -222,6 +224,8 @@ pgstat_attach_shmem(void)
 	pgStatLocal.dsa = dsa_attach_in_place(pgStatLocal.shmem->raw_dsa_area,
 										  NULL);
 	dsa_pin_mapping(pgStatLocal.dsa);
+	/* pgstat_detach_shmem() returns any cached objects at shutdown */
+	dsa_enable_cache(pgStatLocal.dsa);
 
 	pgStatLocal.shared_hash = dshash_attach(pgStatLocal.dsa, &dsh_params,
 											pgStatLocal.shmem->hash_handle, 0);
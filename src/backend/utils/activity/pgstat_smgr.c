@@ -0,0 +1,147 @@
+/* -------------------------------------------------------------------------
+ *
+ * pgstat_smgr.c
+ *	  Implementation of storage manager latency statistics.
+ *
+ * This file contains the implementation of the latency histograms of the
+ * storage manager operations that may have to wait for the storage, which
+ * smgr.c collects when track_io_timing is enabled.  With a remote storage
+ * manager, these are the requests to the page server.  It is kept separate
+ * from pgstat.c to enforce the line between the statistics access / storage
+ * implementation and the details about individual types of statistics.
+ *
+ * Copyright (c) 2001-2022, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/activity/pgstat_smgr.c
+ * -------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "port/pg_bitutils.h"
+#include "utils/pgstat_internal.h"
+
+
+static const char *const smgr_op_names[PGSTAT_SMGR_NUM_OPS] = {
+	[PGSTAT_SMGR_READ] = "read",
+	[PGSTAT_SMGR_PREFETCH] = "prefetch",
+	[PGSTAT_SMGR_NBLOCKS] = "nblocks",
+	[PGSTAT_SMGR_EXISTS] = "exists",
+};
+
+/*
+ * Storage manager operation counts waiting to be flushed out.  We use static
+ * memory so that counting an operation never needs to allocate memory.
+ */
+static PgStat_SmgrStats PendingSmgrStats;
+bool		have_smgrstats = false;
+
+
+/*
+ * Count one call of a storage manager operation that took "io_time" ---
+ * called from smgr.c
+ */
+void
+pgstat_count_smgr_op(PgStat_SmgrOp op, instr_time io_time)
+{
+	PgStat_SmgrOpStats *opstats = &PendingSmgrStats.ops[op];
+	uint64		usec = INSTR_TIME_GET_MICROSEC(io_time);
+	int			bucket;
+
+	if (usec == 0)
+		bucket = 0;
+	else
+		bucket = Min(pg_leftmost_one_pos64(usec) + 1,
+					 PGSTAT_SMGR_HIST_BUCKETS - 1);
+
+	opstats->calls++;
+	opstats->total_time += usec;
+	opstats->histogram[bucket]++;
+	have_smgrstats = true;
+}
+
+/*
+ * Returns the name of a storage manager operation, as shown in the
+ * pg_stat_smgr_latency view.
+ */
+const char *
+pgstat_get_smgr_op_name(PgStat_SmgrOp op)
+{
+	Assert(op >= 0 && op < PGSTAT_SMGR_NUM_OPS);
+
+	return smgr_op_names[op];
+}
+
+/*
+ * Support function for the SQL-callable pgstat* functions. Returns
+ * a pointer to the storage manager statistics struct.
+ */
+PgStat_SmgrStats *
+pgstat_fetch_stat_smgr(void)
+{
+	pgstat_snapshot_fixed(PGSTAT_KIND_SMGR);
+
+	return &pgStatLocal.snapshot.smgr;
+}
+
+/*
+ * Flush out locally pending storage manager stats entries
+ *
+ * If nowait is true, this function returns true if the lock could not be
+ * acquired. Otherwise return false.
+ */
+bool
+pgstat_smgr_flush(bool nowait)
+{
+	PgStatShared_Smgr *stats_shmem = &pgStatLocal.shmem->smgr;
+
+	if (!have_smgrstats)
+		return false;
+
+	if (!nowait)
+		LWLockAcquire(&stats_shmem->lock, LW_EXCLUSIVE);
+	else if (!LWLockConditionalAcquire(&stats_shmem->lock, LW_EXCLUSIVE))
+		return true;
+
+	for (int op = 0; op < PGSTAT_SMGR_NUM_OPS; op++)
+	{
+		PgStat_SmgrOpStats *sharedent = &stats_shmem->stats.ops[op];
+		PgStat_SmgrOpStats *pendingent = &PendingSmgrStats.ops[op];
+
+		sharedent->calls += pendingent->calls;
+		sharedent->total_time += pendingent->total_time;
+		for (int i = 0; i < PGSTAT_SMGR_HIST_BUCKETS; i++)
+			sharedent->histogram[i] += pendingent->histogram[i];
+	}
+
+	LWLockRelease(&stats_shmem->lock);
+
+	/* done, clear the pending entry */
+	MemSet(&PendingSmgrStats, 0, sizeof(PendingSmgrStats));
+	have_smgrstats = false;
+
+	return false;
+}
+
+void
+pgstat_smgr_reset_all_cb(TimestampTz ts)
+{
+	PgStatShared_Smgr *stats_shmem = &pgStatLocal.shmem->smgr;
+
+	LWLockAcquire(&stats_shmem->lock, LW_EXCLUSIVE);
+	memset(&stats_shmem->stats, 0, sizeof(stats_shmem->stats));
+	stats_shmem->stats.stat_reset_timestamp = ts;
+	LWLockRelease(&stats_shmem->lock);
+}
+
+void
+pgstat_smgr_snapshot_cb(void)
+{
+	PgStatShared_Smgr *stats_shmem = &pgStatLocal.shmem->smgr;
+
+	LWLockAcquire(&stats_shmem->lock, LW_SHARED);
+	memcpy(&pgStatLocal.snapshot.smgr, &stats_shmem->stats,
+		   sizeof(pgStatLocal.snapshot.smgr));
+	LWLockRelease(&stats_shmem->lock);
+}
@@ -101,6 +101,7 @@ pgstat_flush_wal(bool nowait)
 	WALSTAT_ACC(wal_fpi);
 	WALSTAT_ACC(wal_bytes);
 	WALSTAT_ACC(wal_buffers_full);
+	WALSTAT_ACC(wal_segment_init);
 	WALSTAT_ACC(wal_write);
 	WALSTAT_ACC(wal_sync);
 	WALSTAT_ACC(wal_write_time);
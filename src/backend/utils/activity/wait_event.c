@@ -406,6 +406,9 @@ pgstat_get_wait_ipc(WaitEventIPC w)
 		case WAIT_EVENT_MQ_SEND:
 			event_name = "MessageQueueSend";
 			break;
+		case WAIT_EVENT_MULTIXACT_CREATION:
+			event_name = "MultiXactCreation";
+			break;
 		case WAIT_EVENT_PARALLEL_BITMAP_SCAN:
 			event_name = "ParallelBitmapScan";
 			break;
@@ -621,6 +624,9 @@ pgstat_get_wait_io(WaitEventIO w)
 		case WAIT_EVENT_LOGICAL_REWRITE_MAPPING_WRITE:
 			event_name = "LogicalRewriteMappingWrite";
 			break;
+		case WAIT_EVENT_LOGICAL_REWRITE_READ:
+			event_name = "LogicalRewriteRead";
+			break;
 		case WAIT_EVENT_LOGICAL_REWRITE_SYNC:
 			event_name = "LogicalRewriteSync";
 			break;
@@ -22,6 +22,7 @@
 #include "commands/dbcommands.h"
 #include "commands/tablespace.h"
 #include "miscadmin.h"
+#include "storage/dbsize_cache.h"
 #include "storage/fd.h"
 #include "storage/smgr.h"
 #include "utils/acl.h"
@@ -133,7 +134,12 @@ calculate_database_size(Oid dbOid)
 
 	if (dbsize_hook)
 	{
-		totalsize = (*dbsize_hook)(dbOid);
+		/* asking the storage is expensive, so use a recent size if cached */
+		if (!DbSizeCacheLookup(dbOid, &totalsize))
+		{
+			totalsize = (*dbsize_hook)(dbOid);
+			DbSizeCacheStore(dbOid, totalsize);
+		}
 		return totalsize;
 	}
 
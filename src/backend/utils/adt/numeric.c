@@ -522,6 +522,10 @@ static bool numericvar_to_uint64(const NumericVar *var, uint64 *result);
 #ifdef HAVE_INT128
 static bool numericvar_to_int128(const NumericVar *var, int128 *result);
 static void int128_to_numericvar(int128 val, NumericVar *var);
+static bool numericvar_to_scaled_int128(const NumericVar *var, int rscale,
+										int128 *result);
+static Numeric make_result_from_scaled_int128(int128 val, int rscale,
+											  bool *have_error);
 #endif
 static double numericvar_to_double_no_overflow(const NumericVar *var);
 
@@ -2822,6 +2826,24 @@ numeric_add_opt_error(Numeric num1, Numeric num2, bool *have_error)
 	init_var_from_num(num1, &arg1);
 	init_var_from_num(num2, &arg2);
 
+#ifdef HAVE_INT128
+
+	/*
+	 * If both inputs are small, add them as scaled integers instead, which
+	 * saves building an intermediate NumericVar.
+	 */
+	{
+		int			rscale = Max(arg1.dscale, arg2.dscale);
+		int128		val1,
+					val2;
+
+		if (numericvar_to_scaled_int128(&arg1, rscale, &val1) &&
+			numericvar_to_scaled_int128(&arg2, rscale, &val2))
+			return make_result_from_scaled_int128(val1 + val2, rscale,
+												  have_error);
+	}
+#endif
+
 	init_var(&result);
 	add_var(&arg1, &arg2, &result);
 
@@ -2900,6 +2922,20 @@ numeric_sub_opt_error(Numeric num1, Numeric num2, bool *have_error)
 	init_var_from_num(num1, &arg1);
 	init_var_from_num(num2, &arg2);
 
+#ifdef HAVE_INT128
+	/* Fast path for small inputs, as in numeric_add_opt_error() */
+	{
+		int			rscale = Max(arg1.dscale, arg2.dscale);
+		int128		val1,
+					val2;
+
+		if (numericvar_to_scaled_int128(&arg1, rscale, &val1) &&
+			numericvar_to_scaled_int128(&arg2, rscale, &val2))
+			return make_result_from_scaled_int128(val1 - val2, rscale,
+												  have_error);
+	}
+#endif
+
 	init_var(&result);
 	sub_var(&arg1, &arg2, &result);
 
@@ -3018,6 +3054,27 @@ numeric_mul_opt_error(Numeric num1, Numeric num2, bool *have_error)
 	init_var_from_num(num1, &arg1);
 	init_var_from_num(num2, &arg2);
 
+#ifdef HAVE_INT128
+
+	/*
+	 * If both inputs are small, the exact product of their scaled integer
+	 * forms fits in 128 bits.  Its scale is the sum of the input scales,
+	 * which may exceed NUMERIC_DSCALE_MAX even for small values such as
+	 * 1e-9000; leave those to be rounded below.
+	 */
+	if (arg1.dscale + arg2.dscale <= NUMERIC_DSCALE_MAX)
+	{
+		int128		val1,
+					val2;
+
+		if (numericvar_to_scaled_int128(&arg1, arg1.dscale, &val1) &&
+			numericvar_to_scaled_int128(&arg2, arg2.dscale, &val2))
+			return make_result_from_scaled_int128(val1 * val2,
+												  arg1.dscale + arg2.dscale,
+												  have_error);
+	}
+#endif
+
 	init_var(&result);
 	mul_var(&arg1, &arg2, &result, arg1.dscale + arg2.dscale);
 
@@ -7908,6 +7965,116 @@ int128_to_numericvar(int128 val, NumericVar *var)
 	var->ndigits = ndigits;
 	var->weight = ndigits - 1;
 }
+
+/*
+ * Largest magnitude, exclusive, accepted by numericvar_to_scaled_int128().
+ * The product of two such values, scaled up by a further factor of up to
+ * 10^(DEC_DIGITS - 1) in make_result_from_scaled_int128(), fits in int128.
+ */
+#define NUMERIC_SMALL_SCALED_LIMIT	((int128) INT64CONST(100000000000000000))
+
+/*
+ * Convert a small numeric to a scaled integer: its value times 10^rscale,
+ * which must be an integer, ie rscale >= var->dscale.
+ *
+ * Returns false if the result's magnitude would be NUMERIC_SMALL_SCALED_LIMIT
+ * or more.  This is meant for arithmetic fast paths, so values with many
+ * digits are refused without looking at their digits.
+ */
+static bool
+numericvar_to_scaled_int128(const NumericVar *var, int rscale, int128 *result)
+{
+	int			nfrac = (rscale + DEC_DIGITS - 1) / DEC_DIGITS;
+	int128		val = 0;
+
+	Assert(var->dscale <= rscale);
+
+	if (var->ndigits == 0)
+	{
+		*result = 0;
+		return true;
+	}
+
+	/*
+	 * Accumulate var * NBASE^nfrac.  Five NBASE digits are enough for any
+	 * value below the limit.  Digits beyond var->dscale should be zero
+	 * anyway, but refuse values that have any rather than drop them.
+	 */
+	if (var->weight + 1 + nfrac > 5 ||
+		var->ndigits > var->weight + 1 + nfrac)
+		return false;
+
+	for (int pos = var->weight; pos >= -nfrac; pos--)
+	{
+		int			i = var->weight - pos;
+
+		val = val * NBASE + (i < var->ndigits ? var->digits[i] : 0);
+	}
+
+	/* Now scale down exactly to 10^rscale */
+	for (int i = nfrac * DEC_DIGITS - rscale; i > 0; i--)
+	{
+		if (val % 10 != 0)
+			return false;
+		val /= 10;
+	}
+
+	if (val >= NUMERIC_SMALL_SCALED_LIMIT)
+		return false;
+
+	*result = var->sign == NUMERIC_NEG ? -val : val;
+	return true;
+}
+
+/*
+ * Build a Numeric with display scale rscale from a scaled integer, ie one
+ * holding the desired value times 10^rscale.  The digits are assembled in a
+ * local buffer, so no NumericVar needs to be allocated.
+ */
+static Numeric
+make_result_from_scaled_int128(int128 val, int rscale, bool *have_error)
+{
+	NumericVar	var;
+	NumericDigit digits[40 / DEC_DIGITS + 1];
+	int			nfrac = (rscale + DEC_DIGITS - 1) / DEC_DIGITS;
+	uint128		uval;
+	NumericDigit *ptr;
+	int			ndigits;
+
+	var.sign = val < 0 ? NUMERIC_NEG : NUMERIC_POS;
+	var.dscale = rscale;
+	var.buf = NULL;
+
+	if (val == 0)
+	{
+		var.ndigits = 0;
+		var.weight = 0;
+		var.digits = digits;
+		return make_result_opt_error(&var, have_error);
+	}
+
+	/* Scale up to a multiple of NBASE, so the decimal point is at a digit */
+	uval = val < 0 ? -val : val;
+	for (int i = nfrac * DEC_DIGITS - rscale; i > 0; i--)
+		uval *= 10;
+
+	ptr = digits + lengthof(digits);
+	ndigits = 0;
+	do
+	{
+		uint128		newuval = uval / NBASE;
+
+		*--ptr = uval - newuval * NBASE;
+		ndigits++;
+		uval = newuval;
+	} while (uval);
+
+	var.digits = ptr;
+	var.ndigits = ndigits;
+	var.weight = ndigits - 1 - nfrac;
+
+	return make_result_opt_error(&var, have_error);
+}
 #endif
 
 /*
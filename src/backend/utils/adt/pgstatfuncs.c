@@ -25,9 +25,11 @@
 #include "pgstat.h"
 #include "postmaster/bgworker_internals.h"
 #include "postmaster/postmaster.h"
+#include "storage/bufsim.h"
 #include "storage/proc.h"
 #include "storage/procarray.h"
 #include "utils/acl.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/inet.h"
 #include "utils/timestamp.h"
@@ -533,6 +535,52 @@ pg_stat_get_progress_info(PG_FUNCTION_ARGS)
 	return (Datum) 0;
 }
 
+/*
+ * Returns the memory allocated by the memory contexts of each PG backend.
+ */
+Datum
+pg_stat_get_backend_memory(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_BACKEND_MEMORY_COLS	3
+	int			num_backends = pgstat_fetch_stat_numbackends();
+	int			curr_backend;
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	/* 1-based index */
+	for (curr_backend = 1; curr_backend <= num_backends; curr_backend++)
+	{
+		LocalPgBackendStatus *local_beentry;
+		PgBackendStatus *beentry;
+		Datum		values[PG_STAT_GET_BACKEND_MEMORY_COLS];
+		bool		nulls[PG_STAT_GET_BACKEND_MEMORY_COLS];
+
+		MemSet(values, 0, sizeof(values));
+		MemSet(nulls, 0, sizeof(nulls));
+
+		local_beentry = pgstat_fetch_stat_local_beentry(curr_backend);
+		if (!local_beentry)
+			continue;
+
+		beentry = &local_beentry->backendStatus;
+
+		/* Values available to all callers */
+		values[0] = Int32GetDatum(beentry->st_procpid);
+		values[1] = CStringGetTextDatum(GetBackendTypeDesc(beentry->st_backendType));
+
+		/* show the memory only to role members */
+		if (HAS_PGSTAT_PERMISSIONS(beentry->st_userid))
+			values[2] = Int64GetDatum((int64) beentry->st_allocated_bytes);
+		else
+			nulls[2] = true;
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	return (Datum) 0;
+}
+
 /*
  * Returns activity of PG backends.
  */
@@ -1745,7 +1793,7 @@ pg_stat_get_buf_alloc(PG_FUNCTION_ARGS)
 Datum
 pg_stat_get_wal(PG_FUNCTION_ARGS)
 {
-#define PG_STAT_GET_WAL_COLS	9
+#define PG_STAT_GET_WAL_COLS	10
 	TupleDesc	tupdesc;
 	Datum		values[PG_STAT_GET_WAL_COLS];
 	bool		nulls[PG_STAT_GET_WAL_COLS];
@@ -1766,15 +1814,17 @@ pg_stat_get_wal(PG_FUNCTION_ARGS)
 					   NUMERICOID, -1, 0);
 	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "wal_buffers_full",
 					   INT8OID, -1, 0);
-	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "wal_write",
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "wal_segment_init",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "wal_write",
 					   INT8OID, -1, 0);
-	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "wal_sync",
+	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "wal_sync",
 					   INT8OID, -1, 0);
-	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "wal_write_time",
+	TupleDescInitEntry(tupdesc, (AttrNumber) 8, "wal_write_time",
 					   FLOAT8OID, -1, 0);
-	TupleDescInitEntry(tupdesc, (AttrNumber) 8, "wal_sync_time",
+	TupleDescInitEntry(tupdesc, (AttrNumber) 9, "wal_sync_time",
 					   FLOAT8OID, -1, 0);
-	TupleDescInitEntry(tupdesc, (AttrNumber) 9, "stats_reset",
+	TupleDescInitEntry(tupdesc, (AttrNumber) 10, "stats_reset",
 					   TIMESTAMPTZOID, -1, 0);
 
 	BlessTupleDesc(tupdesc);
@@ -1794,19 +1844,123 @@ pg_stat_get_wal(PG_FUNCTION_ARGS)
 									Int32GetDatum(-1));
 
 	values[3] = Int64GetDatum(wal_stats->wal_buffers_full);
-	values[4] = Int64GetDatum(wal_stats->wal_write);
-	values[5] = Int64GetDatum(wal_stats->wal_sync);
+	values[4] = Int64GetDatum(wal_stats->wal_segment_init);
+	values[5] = Int64GetDatum(wal_stats->wal_write);
+	values[6] = Int64GetDatum(wal_stats->wal_sync);
 
 	/* Convert counters from microsec to millisec for display */
-	values[6] = Float8GetDatum(((double) wal_stats->wal_write_time) / 1000.0);
-	values[7] = Float8GetDatum(((double) wal_stats->wal_sync_time) / 1000.0);
+	values[7] = Float8GetDatum(((double) wal_stats->wal_write_time) / 1000.0);
+	values[8] = Float8GetDatum(((double) wal_stats->wal_sync_time) / 1000.0);
+
+	values[9] = TimestampTzGetDatum(wal_stats->stat_reset_timestamp);
+
+	/* Returns the record as Datum */
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
+/*
+ * Returns statistics of the last written LSN cache.
+ */
+Datum
+pg_stat_get_last_written_lsn_cache(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_LWLSN_CACHE_COLS	8
+	TupleDesc	tupdesc;
+	Datum		values[PG_STAT_GET_LWLSN_CACHE_COLS];
+	bool		nulls[PG_STAT_GET_LWLSN_CACHE_COLS];
+	PgStat_LastWrittenLsnCacheStats *stats;
+
+	/* Initialise values and NULL flags arrays */
+	MemSet(values, 0, sizeof(values));
+	MemSet(nulls, 0, sizeof(nulls));
+
+	/* Initialise attributes information in the tuple descriptor */
+	tupdesc = CreateTemplateTupleDesc(PG_STAT_GET_LWLSN_CACHE_COLS);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "page_hits",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "range_hits",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "misses",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "page_evictions",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "range_evictions",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "lock_waits",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "lock_wait_time",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 8, "stats_reset",
+					   TIMESTAMPTZOID, -1, 0);
+
+	BlessTupleDesc(tupdesc);
+
+	/* Get statistics about the last written LSN cache */
+	stats = pgstat_fetch_stat_lwlsn_cache();
+
+	/* Fill values and NULLs */
+	values[0] = Int64GetDatum(stats->page_hits);
+	values[1] = Int64GetDatum(stats->range_hits);
+	values[2] = Int64GetDatum(stats->misses);
+	values[3] = Int64GetDatum(stats->page_evictions);
+	values[4] = Int64GetDatum(stats->range_evictions);
+	values[5] = Int64GetDatum(stats->lock_waits);
+
+	/* Convert counter from microsec to millisec for display */
+	values[6] = Float8GetDatum(((double) stats->lock_wait_time) / 1000.0);
 
-	values[8] = TimestampTzGetDatum(wal_stats->stat_reset_timestamp);
+	values[7] = TimestampTzGetDatum(stats->stat_reset_timestamp);
 
 	/* Returns the record as Datum */
 	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
 }
 
+/*
+ * Returns latency statistics of storage manager operations.
+ */
+Datum
+pg_stat_get_smgr_latency(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_SMGR_LATENCY_COLS	5
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	PgStat_SmgrStats *stats;
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	/* request storage manager stats from the cumulative stats system */
+	stats = pgstat_fetch_stat_smgr();
+
+	for (int op = 0; op < PGSTAT_SMGR_NUM_OPS; op++)
+	{
+		/* for each row */
+		Datum		values[PG_STAT_GET_SMGR_LATENCY_COLS];
+		bool		nulls[PG_STAT_GET_SMGR_LATENCY_COLS];
+		Datum		buckets[PGSTAT_SMGR_HIST_BUCKETS];
+		PgStat_SmgrOpStats *stat = &stats->ops[op];
+
+		MemSet(values, 0, sizeof(values));
+		MemSet(nulls, 0, sizeof(nulls));
+
+		for (int i = 0; i < PGSTAT_SMGR_HIST_BUCKETS; i++)
+			buckets[i] = Int64GetDatum(stat->histogram[i]);
+
+		values[0] = PointerGetDatum(cstring_to_text(pgstat_get_smgr_op_name(op)));
+		values[1] = Int64GetDatum(stat->calls);
+		/* convert counter from microsec to millisec for display */
+		values[2] = Float8GetDatum(((double) stat->total_time) / 1000.0);
+		values[3] = PointerGetDatum(construct_array(buckets,
+													PGSTAT_SMGR_HIST_BUCKETS,
+													INT8OID, sizeof(int64),
+													FLOAT8PASSBYVAL,
+													TYPALIGN_DOUBLE));
+		values[4] = TimestampTzGetDatum(stats->stat_reset_timestamp);
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	return (Datum) 0;
+}
+
 /*
  * Returns statistics of SLRU caches.
  */
@@ -2104,15 +2258,21 @@ pg_stat_reset_shared(PG_FUNCTION_ARGS)
 		pgstat_reset_of_kind(PGSTAT_KIND_BGWRITER);
 		pgstat_reset_of_kind(PGSTAT_KIND_CHECKPOINTER);
 	}
+	else if (strcmp(target, "buffer_simulation") == 0)
+		BufferSimulationResetStats();
+	else if (strcmp(target, "last_written_lsn_cache") == 0)
+		pgstat_reset_of_kind(PGSTAT_KIND_LWLSN_CACHE);
 	else if (strcmp(target, "recovery_prefetch") == 0)
 		XLogPrefetchResetStats();
+	else if (strcmp(target, "smgr") == 0)
+		pgstat_reset_of_kind(PGSTAT_KIND_SMGR);
 	else if (strcmp(target, "wal") == 0)
 		pgstat_reset_of_kind(PGSTAT_KIND_WAL);
 	else
 		ereport(ERROR,
 				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 				 errmsg("unrecognized reset target: \"%s\"", target),
-				 errhint("Target must be \"archiver\", \"bgwriter\", \"recovery_prefetch\", or \"wal\".")));
+				 errhint("Target must be \"archiver\", \"bgwriter\", \"buffer_simulation\", \"last_written_lsn_cache\", \"recovery_prefetch\", \"smgr\", or \"wal\".")));
 
 	PG_RETURN_VOID();
 }
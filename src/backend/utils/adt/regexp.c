@@ -103,6 +103,9 @@ typedef struct cached_re_str
 	int			cre_pat_len;	/* length of original RE, in bytes */
 	int			cre_flags;		/* compile flags: extended,icase etc */
 	Oid			cre_collation;	/* collation to use */
+	int			cre_must_off;	/* offset in cre_pat of a literal that every
+								 * match must contain */
+	int			cre_must_len;	/* length of that literal, or 0 if none */
 	regex_t		cre_re;			/* the compiled regular expression */
 } cached_re_str;
 
@@ -120,6 +123,10 @@ static regexp_matches_ctx *setup_regexp_matches(text *orig_str, text *pattern,
 												bool fetching_unmatched);
 static ArrayType *build_regexp_match_result(regexp_matches_ctx *matchctx);
 static Datum build_regexp_split_result(regexp_matches_ctx *splitctx);
+static void find_required_literal(const char *pat, int pat_len, int cflags,
+								  int *must_off, int *must_len);
+static bool data_contains_literal(const char *dat, int dat_len,
+								  const char *lit, int lit_len);
 
 
 /*
@@ -227,6 +234,8 @@ RE_compile_and_cache(text *text_re, int cflags, Oid collation)
 	re_temp.cre_pat_len = text_re_len;
 	re_temp.cre_flags = cflags;
 	re_temp.cre_collation = collation;
+	find_required_literal(re_temp.cre_pat, text_re_len, cflags,
+						  &re_temp.cre_must_off, &re_temp.cre_must_len);
 
 	/*
 	 * Okay, we have a valid new item in re_temp; insert it into the storage
@@ -354,9 +363,131 @@ RE_compile_and_execute(text *text_re, char *dat, int dat_len,
 	/* Compile RE */
 	re = RE_compile_and_cache(text_re, cflags, collation);
 
+	/*
+	 * Its cache entry is now at the front.  If the pattern has a literal
+	 * that every match must contain, and the data doesn't contain it, we can
+	 * skip converting the data and running the regex engine.
+	 */
+	Assert(re == &re_array[0].cre_re);
+	if (re_array[0].cre_must_len > 0 &&
+		!data_contains_literal(dat, dat_len,
+							   re_array[0].cre_pat + re_array[0].cre_must_off,
+							   re_array[0].cre_must_len))
+		return false;
+
 	return RE_execute(re, dat, dat_len, nmatch, pmatch);
 }
 
+/*
+ * find_required_literal - find a literal string any match must contain
+ *
+ * Sets *must_off and *must_len to the position and length, in pat, of the
+ * longest run of ordinary characters that every match of the pattern must
+ * contain, or *must_len to 0 if we find none.
+ *
+ * This doesn't attempt to understand the whole regex syntax.  We only handle
+ * case-sensitive AREs without alternation, and look at the pattern up to the
+ * first escape, bracket expression or parenthesized group; that is enough
+ * for the common "foo.*bar" sort of filter.  A character followed by a
+ * quantifier is not part of any run.  The pattern is known to be a valid
+ * regex, since it has been compiled.
+ *
+ * All metacharacters are ASCII, and server encodings never use ASCII bytes
+ * within multibyte characters, so we can scan the pattern bytewise.
+ */
+static void
+find_required_literal(const char *pat, int pat_len, int cflags,
+					  int *must_off, int *must_len)
+{
+	int			run_start = 0;
+	int			run_end = 0;
+	int			last_char = 0;	/* start of the last character in the run */
+	int			i = 0;
+
+	*must_off = 0;
+	*must_len = 0;
+
+	if ((cflags & ~REG_NOSUB) != REG_ADVANCED)
+		return;
+	/* "***" introduces a director, which changes the syntax of the rest */
+	if (pat_len > 0 && pat[0] == '*')
+		return;
+	if (memchr(pat, '|', pat_len) != NULL)
+		return;
+
+#define END_RUN() \
+	do { \
+		if (run_end - run_start > *must_len) \
+		{ \
+			*must_off = run_start; \
+			*must_len = run_end - run_start; \
+		} \
+	} while (0)
+
+	while (i < pat_len)
+	{
+		char		c = pat[i];
+
+		if (c == '*' || c == '+' || c == '?' || c == '{')
+		{
+			/* the quantified character is not required */
+			if (run_end > run_start)
+				run_end = last_char;
+			END_RUN();
+			if (c == '{')
+				return;
+			i++;
+			run_start = run_end = i;
+		}
+		else if (c == '\\' || c == '[' || c == '(' || c == ')')
+		{
+			END_RUN();
+			return;
+		}
+		else if (strchr("^$.]}", c) != NULL)
+		{
+			END_RUN();
+			i++;
+			run_start = run_end = i;
+		}
+		else
+		{
+			last_char = i;
+			i += pg_mblen(pat + i);
+			run_end = Min(i, pat_len);
+		}
+	}
+	END_RUN();
+
+#undef END_RUN
+}
+
+/*
+ * data_contains_literal - does dat contain lit as a byte string?
+ *
+ * A false positive is possible, in encodings that allow a match starting
+ * within a multibyte character, but not a false negative, which is all that
+ * prefiltering needs.
+ */
+static bool
+data_contains_literal(const char *dat, int dat_len,
+					  const char *lit, int lit_len)
+{
+	const char *p = dat;
+	const char *last = dat + dat_len - lit_len;
+
+	while (p <= last)
+	{
+		p = memchr(p, (unsigned char) lit[0], last - p + 1);
+		if (p == NULL)
+			return false;
+		if (memcmp(p, lit, lit_len) == 0)
+			return true;
+		p++;
+	}
+	return false;
+}
+
 
 /*
  * parse_re_flags - parse the options argument of regexp_match and friends
@@ -40,6 +40,7 @@
 #include "parser/parse_coerce.h"
 #include "parser/parse_relation.h"
 #include "storage/bufmgr.h"
+#include "storage/proc.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
 #include "utils/datum.h"
@@ -169,6 +170,32 @@ typedef struct RI_CompareHashEntry
 	FmgrInfo	cast_func_finfo;	/* in case we must coerce input */
 } RI_CompareHashEntry;
 
+/*
+ * RI_CheckedKey
+ *
+ * The last referenced key that RI_FKey_check() found (and locked FOR KEY
+ * SHARE) for a foreign key constraint.  Bulk loads very often insert runs of
+ * rows referencing the same key; as long as our transaction holds that lock,
+ * nobody else can remove the referenced row, so the check for an identical
+ * key can be skipped.
+ *
+ * The entry is only trusted while lxid matches our current transaction and
+ * generation matches ri_checked_key_generation, which is advanced whenever
+ * the lock might have been lost or the referenced row might have gone away
+ * through our own actions: on subtransaction abort, when any PK-side RI
+ * trigger runs (i.e. we deleted a referenced row or changed its key), and on
+ * relcache or pg_constraint invalidations (TRUNCATE, DETACH PARTITION, DDL).
+ */
+typedef struct RI_CheckedKey
+{
+	Oid			constraint_id;	/* OID of pg_constraint entry (hash key) */
+	LocalTransactionId lxid;	/* transaction holding the row lock */
+	uint64		generation;		/* ri_checked_key_generation at check */
+	int			nkeys;			/* number of key columns */
+	Datum		fk_values[RI_MAX_NUMKEYS];	/* key values, as in FK table */
+	bool		fk_copied[RI_MAX_NUMKEYS];	/* fk_values[i] is palloc'd? */
+} RI_CheckedKey;
+
 
 /*
  * Local data
@@ -178,6 +205,9 @@ static HTAB *ri_query_cache = NULL;
 static HTAB *ri_compare_cache = NULL;
 static dlist_head ri_constraint_cache_valid_list;
 static int	ri_constraint_cache_valid_count = 0;
+static HTAB *ri_checked_key_cache = NULL;
+static MemoryContext ri_checked_key_cxt = NULL;
+static uint64 ri_checked_key_generation = 1;
 
 
 /*
@@ -208,6 +238,15 @@ static bool ri_AttributesEqual(Oid eq_opr, Oid typeid,
 
 static void ri_InitHashTables(void);
 static void InvalidateConstraintCacheCallBack(Datum arg, int cacheid, uint32 hashvalue);
+static void InvalidateCheckedKeysRelCallBack(Datum arg, Oid relid);
+static void InvalidateCheckedKeysSubXactCallBack(SubXactEvent event,
+												 SubTransactionId mySubid,
+												 SubTransactionId parentSubid,
+												 void *arg);
+static bool ri_CheckedKeyMatches(const RI_ConstraintInfo *riinfo,
+								 Relation fk_rel, TupleTableSlot *newslot);
+static void ri_RememberCheckedKey(const RI_ConstraintInfo *riinfo,
+								  Relation fk_rel, TupleTableSlot *newslot);
 static SPIPlanPtr ri_FetchPreparedPlan(RI_QueryKey *key);
 static void ri_HashPreparedPlan(RI_QueryKey *key, SPIPlanPtr plan);
 static RI_CompareHashEntry *ri_HashCompareOp(Oid eq_opr, Oid typeid);
@@ -344,6 +383,13 @@ RI_FKey_check(TriggerData *trigdata)
 			break;
 	}
 
+	/* Same key as the one we found and locked last time? */
+	if (ri_CheckedKeyMatches(riinfo, fk_rel, newslot))
+	{
+		table_close(pk_rel, RowShareLock);
+		return PointerGetDatum(NULL);
+	}
+
 	if (SPI_connect() != SPI_OK_CONNECT)
 		elog(ERROR, "SPI_connect failed");
 
@@ -413,11 +459,107 @@ RI_FKey_check(TriggerData *trigdata)
 	if (SPI_finish() != SPI_OK_FINISH)
 		elog(ERROR, "SPI_finish failed");
 
+	/* The key exists, and is now locked by us */
+	ri_RememberCheckedKey(riinfo, fk_rel, newslot);
+
 	table_close(pk_rel, RowShareLock);
 
 	return PointerGetDatum(NULL);
 }
 
+/*
+ * ri_CheckedKeyMatches -
+ *
+ * Is the FK key of newslot identical to the last key RI_FKey_check() found
+ * for this constraint, and is that finding still good?  See RI_CheckedKey.
+ *
+ * The values are compared bytewise rather than with the FK equality
+ * operator: values that merely compare as equal might not match the same
+ * PK rows, e.g. under a nondeterministic collation.
+ */
+static bool
+ri_CheckedKeyMatches(const RI_ConstraintInfo *riinfo, Relation fk_rel,
+					 TupleTableSlot *newslot)
+{
+	RI_CheckedKey *entry;
+
+	if (!ri_checked_key_cache)
+		ri_InitHashTables();
+
+	entry = (RI_CheckedKey *) hash_search(ri_checked_key_cache,
+										  &riinfo->constraint_id,
+										  HASH_FIND, NULL);
+	if (entry == NULL ||
+		entry->lxid != MyProc->lxid ||
+		entry->generation != ri_checked_key_generation ||
+		entry->nkeys != riinfo->nkeys)
+		return false;
+
+	for (int i = 0; i < riinfo->nkeys; i++)
+	{
+		Form_pg_attribute att = TupleDescAttr(RelationGetDescr(fk_rel),
+											  riinfo->fk_attnums[i] - 1);
+		Datum		value;
+		bool		isnull;
+
+		value = slot_getattr(newslot, riinfo->fk_attnums[i], &isnull);
+		Assert(!isnull);
+		if (!datum_image_eq(entry->fk_values[i], value,
+							att->attbyval, att->attlen))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * ri_RememberCheckedKey -
+ *
+ * Remember the FK key of newslot as found and locked.  See RI_CheckedKey.
+ */
+static void
+ri_RememberCheckedKey(const RI_ConstraintInfo *riinfo, Relation fk_rel,
+					  TupleTableSlot *newslot)
+{
+	RI_CheckedKey *entry;
+	bool		found;
+	MemoryContext oldcxt;
+
+	entry = (RI_CheckedKey *) hash_search(ri_checked_key_cache,
+										  &riinfo->constraint_id,
+										  HASH_ENTER, &found);
+
+	/* Free the previous key's values, if any */
+	if (found)
+	{
+		for (int i = 0; i < entry->nkeys; i++)
+		{
+			if (entry->fk_copied[i])
+				pfree(DatumGetPointer(entry->fk_values[i]));
+		}
+	}
+	entry->nkeys = 0;
+
+	oldcxt = MemoryContextSwitchTo(ri_checked_key_cxt);
+	for (int i = 0; i < riinfo->nkeys; i++)
+	{
+		Form_pg_attribute att = TupleDescAttr(RelationGetDescr(fk_rel),
+											  riinfo->fk_attnums[i] - 1);
+		Datum		value;
+		bool		isnull;
+
+		value = slot_getattr(newslot, riinfo->fk_attnums[i], &isnull);
+		Assert(!isnull);
+		entry->fk_values[i] = datumCopy(value, att->attbyval, att->attlen);
+		entry->fk_copied[i] = !att->attbyval;
+	}
+	MemoryContextSwitchTo(oldcxt);
+
+	entry->nkeys = riinfo->nkeys;
+	entry->lxid = MyProc->lxid;
+	entry->generation = ri_checked_key_generation;
+}
+
 
 /*
  * RI_FKey_check_ins -
@@ -2070,6 +2212,13 @@ ri_FetchConstraintInfo(Trigger *trigger, Relation trig_rel, bool rel_is_pk)
 	/* Find or create a hashtable entry for the constraint */
 	riinfo = ri_LoadConstraintInfo(constraintOid);
 
+	/*
+	 * A PK-side trigger means we're deleting a referenced row or changing
+	 * its key, so stop trusting the keys RI_FKey_check() remembered.
+	 */
+	if (rel_is_pk)
+		ri_checked_key_generation++;
+
 	/* Do some easy cross-checks against the trigger call data */
 	if (rel_is_pk)
 	{
@@ -2256,6 +2405,30 @@ InvalidateConstraintCacheCallBack(Datum arg, int cacheid, uint32 hashvalue)
 			ri_constraint_cache_valid_count--;
 		}
 	}
+
+	ri_checked_key_generation++;
+}
+
+/*
+ * Callbacks that make RI_FKey_check() forget the keys it has found, see
+ * RI_CheckedKey.  A relcache invalidation may mean that a referenced table
+ * was truncated or lost a partition; a subtransaction abort may have
+ * released the row locks we took.
+ */
+static void
+InvalidateCheckedKeysRelCallBack(Datum arg, Oid relid)
+{
+	ri_checked_key_generation++;
+}
+
+static void
+InvalidateCheckedKeysSubXactCallBack(SubXactEvent event,
+									 SubTransactionId mySubid,
+									 SubTransactionId parentSubid,
+									 void *arg)
+{
+	if (event == SUBXACT_EVENT_ABORT_SUB)
+		ri_checked_key_generation++;
 }
 
 
@@ -2693,6 +2866,20 @@ ri_InitHashTables(void)
 	ri_compare_cache = hash_create("RI compare cache",
 								   RI_INIT_QUERYHASHSIZE,
 								   &ctl, HASH_ELEM | HASH_BLOBS);
+
+	ctl.keysize = sizeof(Oid);
+	ctl.entrysize = sizeof(RI_CheckedKey);
+	ri_checked_key_cache = hash_create("RI checked key cache",
+									   RI_INIT_CONSTRAINTHASHSIZE,
+									   &ctl, HASH_ELEM | HASH_BLOBS);
+	ri_checked_key_cxt = AllocSetContextCreate(TopMemoryContext,
+											   "RI checked keys",
+											   ALLOCSET_SMALL_SIZES);
+
+	/* Arrange to forget checked keys, see RI_CheckedKey */
+	CacheRegisterRelcacheCallback(InvalidateCheckedKeysRelCallBack,
+								  (Datum) 0);
+	RegisterSubXactCallback(InvalidateCheckedKeysSubXactCallBack, NULL);
 }
 
 
@@ -39,14 +39,31 @@ static float calc_rank_and(const float *w, TSVector t, TSQuery q);
 
 /*
  * Returns a weight of a word collocation
+ *
+ * calc_rank_and() calls this for every pair of matching positions, so the
+ * weights for the distances that can matter are computed only once.
  */
+#define MAX_WORD_DISTANCE	100
+
 static float4
 word_distance(int32 w)
 {
-	if (w > 100)
+	static float4 distance_weights[MAX_WORD_DISTANCE + 1];
+	static bool distance_weights_valid = false;
+
+	if (w > MAX_WORD_DISTANCE)
 		return 1e-30f;
 
-	return 1.0 / (1.005 + 0.05 * exp(((float4) w) / 1.5 - 2));
+	if (!distance_weights_valid)
+	{
+		int			i;
+
+		for (i = 0; i <= MAX_WORD_DISTANCE; i++)
+			distance_weights[i] = 1.0 / (1.005 + 0.05 * exp(((float4) i) / 1.5 - 2));
+		distance_weights_valid = true;
+	}
+
+	return distance_weights[w];
 }
 
 static int
@@ -537,6 +554,13 @@ compareDocR(const void *va, const void *vb)
 	return (WEP_GETPOS(a->pos) > WEP_GETPOS(b->pos)) ? 1 : -1;
 }
 
+#define ST_SORT sort_docrep
+#define ST_ELEMENT_TYPE DocRepresentation
+#define ST_COMPARE(a, b) compareDocR(a, b)
+#define ST_SCOPE static
+#define ST_DEFINE
+#include "lib/sort_template.h"
+
 #define MAXQROPOS	MAXENTRYPOS
 typedef struct
 {
@@ -800,18 +824,27 @@ get_docrep(TSVector txt, QueryRepresentation *qr, int *doclen)
 		DocRepresentation *rptr = doc + 1,
 				   *wptr = doc,
 					storage;
+		QueryItem **items;
 
 		/*
 		 * Sort representation in ascending order by pos and entry
 		 */
-		qsort((void *) doc, cur, sizeof(DocRepresentation), compareDocR);
+		sort_docrep(doc, cur);
+
+		/*
+		 * Entries that get joined below are adjacent after sorting, so one
+		 * array holding every entry's QueryItem in sorted order can back all
+		 * of the joined items lists, instead of allocating one per position.
+		 */
+		items = palloc(sizeof(QueryItem *) * cur);
+		for (i = 0; i < cur; i++)
+			items[i] = doc[i].data.map.item;
 
 		/*
 		 * Join QueryItem per WordEntry and it's position
 		 */
 		storage.pos = doc->pos;
-		storage.data.query.items = palloc(sizeof(QueryItem *) * qr->query->size);
-		storage.data.query.items[0] = doc->data.map.item;
+		storage.data.query.items = items;
 		storage.data.query.nitem = 1;
 
 		while (rptr - doc < cur)
@@ -819,7 +852,6 @@ get_docrep(TSVector txt, QueryRepresentation *qr, int *doclen)
 			if (rptr->pos == (rptr - 1)->pos &&
 				rptr->data.map.entry == (rptr - 1)->data.map.entry)
 			{
-				storage.data.query.items[storage.data.query.nitem] = rptr->data.map.item;
 				storage.data.query.nitem++;
 			}
 			else
@@ -827,8 +859,7 @@ get_docrep(TSVector txt, QueryRepresentation *qr, int *doclen)
 				*wptr = storage;
 				wptr++;
 				storage.pos = rptr->pos;
-				storage.data.query.items = palloc(sizeof(QueryItem *) * qr->query->size);
-				storage.data.query.items[0] = rptr->data.map.item;
+				storage.data.query.items = items + (rptr - doc);
 				storage.data.query.nitem = 1;
 			}
 
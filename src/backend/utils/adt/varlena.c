@@ -86,6 +86,12 @@ typedef struct
 	int			last_len2;		/* Length of last buf2 string/strxfrm() blob */
 	int			last_returned;	/* Last comparison result (cache) */
 	bool		cache_blob;		/* Does buf2 contain strxfrm() blob, etc? */
+#ifdef USE_ICU
+	UChar	   *ubuf1;			/* buf1 converted to UTF-16, or NULL */
+	UChar	   *ubuf2;			/* buf2 converted to UTF-16, or NULL */
+	int32_t		ulen1;			/* Length of ubuf1, in UChars */
+	int32_t		ulen2;			/* Length of ubuf2, in UChars */
+#endif
 	bool		collate_c;
 	Oid			typid;			/* Actual datatype (text/bpchar/bytea/name) */
 	hyperLogLogState abbr_card; /* Abbreviated key cardinality state */
@@ -2126,6 +2132,10 @@ varstr_sortsupport(SortSupport ssup, Oid typid, Oid collid)
 		sss->last_len2 = -1;
 		/* Initialize */
 		sss->last_returned = 0;
+#ifdef USE_ICU
+		sss->ubuf1 = NULL;
+		sss->ubuf2 = NULL;
+#endif
 		sss->locale = locale;
 
 		/*
@@ -2301,6 +2311,7 @@ varstrfastcmp_locale(char *a1p, int len1, char *a2p, int len2, SortSupport ssup)
 	VarStringSortSupport *sss = (VarStringSortSupport *) ssup->ssup_extra;
 	int			result;
 	bool		arg1_match;
+	bool		arg2_match;
 
 	/* Fast pre-check for equality, as discussed in varstr_cmp() */
 	if (len1 == len2 && memcmp(a1p, a2p, len1) == 0)
@@ -2364,13 +2375,16 @@ varstrfastcmp_locale(char *a1p, int len1, char *a2p, int len2, SortSupport ssup)
 	 * it seems (at least with moderate to low cardinality sets), because
 	 * quicksort compares the same pivot against many values.
 	 */
+	arg2_match = true;
 	if (len2 != sss->last_len2 || memcmp(sss->buf2, a2p, len2) != 0)
 	{
+		arg2_match = false;
 		memcpy(sss->buf2, a2p, len2);
 		sss->buf2[len2] = '\0';
 		sss->last_len2 = len2;
 	}
-	else if (arg1_match && !sss->cache_blob)
+
+	if (arg1_match && arg2_match && !sss->cache_blob)
 	{
 		/* Use result cached following last actual strcoll() call */
 		return sss->last_returned;
@@ -2398,20 +2412,35 @@ varstrfastcmp_locale(char *a1p, int len1, char *a2p, int len2, SortSupport ssup)
 			else
 #endif
 			{
-				int32_t		ulen1,
-							ulen2;
-				UChar	   *uchar1,
-						   *uchar2;
+				MemoryContext oldcontext;
 
-				ulen1 = icu_to_uchar(&uchar1, a1p, len1);
-				ulen2 = icu_to_uchar(&uchar2, a2p, len2);
+				/*
+				 * Converting to UTF-16 costs about as much as the comparison
+				 * itself, so keep each side's converted string around for as
+				 * long as buf1/buf2 still hold the same original string.
+				 * That's the common case for the pivot of a quicksort
+				 * partitioning step.  A conversion call may have clobbered
+				 * the buffers since we last set these, so don't trust them
+				 * when cache_blob is set.
+				 */
+				oldcontext = MemoryContextSwitchTo(ssup->ssup_cxt);
+				if (!arg1_match || sss->cache_blob || sss->ubuf1 == NULL)
+				{
+					if (sss->ubuf1)
+						pfree(sss->ubuf1);
+					sss->ulen1 = icu_to_uchar(&sss->ubuf1, a1p, len1);
+				}
+				if (!arg2_match || sss->cache_blob || sss->ubuf2 == NULL)
+				{
+					if (sss->ubuf2)
+						pfree(sss->ubuf2);
+					sss->ulen2 = icu_to_uchar(&sss->ubuf2, a2p, len2);
+				}
+				MemoryContextSwitchTo(oldcontext);
 
 				result = ucol_strcoll(sss->locale->info.icu.ucol,
-									  uchar1, ulen1,
-									  uchar2, ulen2);
-
-				pfree(uchar1);
-				pfree(uchar2);
+									  sss->ubuf1, sss->ulen1,
+									  sss->ubuf2, sss->ulen2);
 			}
 #else							/* not USE_ICU */
 			/* shouldn't happen */
@@ -5320,6 +5349,9 @@ pg_column_compression(PG_FUNCTION_ARGS)
 		case TOAST_LZ4_COMPRESSION_ID:
 			result = "lz4";
 			break;
+		case TOAST_ZSTD_COMPRESSION_ID:
+			result = "zstd";
+			break;
 		default:
 			elog(ERROR, "invalid compression method id %d", cmid);
 	}
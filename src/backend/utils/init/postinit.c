@@ -40,6 +40,7 @@
 #include "mb/pg_wchar.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "port/pg_bitutils.h"
 #include "postmaster/autovacuum.h"
 #include "postmaster/postmaster.h"
 #include "replication/slot.h"
@@ -70,6 +71,7 @@
 static HeapTuple GetDatabaseTuple(const char *dbname);
 static HeapTuple GetDatabaseTupleByOid(Oid dboid);
 static void PerformAuthentication(Port *port);
+static void InitializeFastPathLocks(void);
 static void CheckMyDatabase(const char *name, bool am_superuser, bool override_allow_connections);
 static void ShutdownPostgres(int code, Datum arg);
 static void StatementTimeoutHandler(void);
@@ -542,7 +544,8 @@ pg_split_opts(char **argv, int *argcp, const char *optstr)
 }
 
 /*
- * Initialize MaxBackends value from config options.
+ * Initialize MaxBackends value from config options, along with the number of
+ * fast-path lock groups per backend.
  *
  * This must be called after modules have had the chance to alter GUCs in
  * shared_preload_libraries and before shared memory size is determined.
@@ -564,6 +567,33 @@ InitializeMaxBackends(void)
 	/* internal error because the values were all checked previously */
 	if (MaxBackends > MAX_BACKENDS)
 		elog(ERROR, "too many backends configured");
+
+	/*
+	 * This is done here rather than by callers, so that no entry point can
+	 * forget it and leave the fast-path lock arrays sized to zero.
+	 */
+	InitializeFastPathLocks();
+}
+
+/*
+ * Initialize the number of fast-path lock groups per backend.
+ *
+ * The fast-path lock arrays are sized so that max_locks_per_transaction
+ * relation locks fit in them, assuming the relations spread evenly over the
+ * groups.  The number of groups is a power of 2, so that mapping a relation
+ * to its group is cheap.
+ *
+ * Called by InitializeMaxBackends; like MaxBackends, the value is passed to
+ * subprocesses in the EXEC_BACKEND case.
+ */
+static void
+InitializeFastPathLocks(void)
+{
+	Assert(FastPathLockGroupsPerBackend == 0);
+
+	FastPathLockGroupsPerBackend =
+		Max(Min(pg_nextpower2_32(max_locks_per_xact) / FP_LOCK_SLOTS_PER_GROUP,
+				FP_LOCK_GROUPS_PER_BACKEND_MAX), 1);
 }
 
 /*
@@ -528,6 +528,16 @@ UtfToLocal(const unsigned char *utf, int len,
 		unsigned char b3 = 0;
 		unsigned char b4 = 0;
 
+		/* copy runs of ASCII characters a chunk at a time */
+		l = valid_ascii_prefix_len(utf, len);
+		if (l > 0)
+		{
+			memcpy(iso, utf, l);
+			iso += l;
+			utf += l;
+			continue;
+		}
+
 		/* "break" cases all represent errors */
 		if (*utf == '\0')
 			break;
@@ -739,6 +749,16 @@ LocalToUtf(const unsigned char *iso, int len,
 		unsigned char b3 = 0;
 		unsigned char b4 = 0;
 
+		/* copy runs of ASCII characters a chunk at a time */
+		l = valid_ascii_prefix_len(iso, len);
+		if (l > 0)
+		{
+			memcpy(utf, iso, l);
+			utf += l;
+			iso += l;
+			continue;
+		}
+
 		/* "break" cases all represent errors */
 		if (*iso == '\0')
 			break;
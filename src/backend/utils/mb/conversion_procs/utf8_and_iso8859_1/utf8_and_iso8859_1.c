@@ -48,6 +48,19 @@ iso8859_1_to_utf8(PG_FUNCTION_ARGS)
 
 	while (len > 0)
 	{
+		int			l;
+
+		/* copy runs of ASCII characters a chunk at a time */
+		l = valid_ascii_prefix_len(src, len);
+		if (l > 0)
+		{
+			memcpy(dest, src, l);
+			dest += l;
+			src += l;
+			len -= l;
+			continue;
+		}
+
 		c = *src;
 		if (c == 0)
 		{
@@ -85,6 +98,19 @@ utf8_to_iso8859_1(PG_FUNCTION_ARGS)
 
 	while (len > 0)
 	{
+		int			l;
+
+		/* copy runs of ASCII characters a chunk at a time */
+		l = valid_ascii_prefix_len(src, len);
+		if (l > 0)
+		{
+			memcpy(dest, src, l);
+			dest += l;
+			src += l;
+			len -= l;
+			continue;
+		}
+
 		c = *src;
 		if (c == 0)
 		{
@@ -101,7 +127,7 @@ utf8_to_iso8859_1(PG_FUNCTION_ARGS)
 		}
 		else
 		{
-			int			l = pg_utf_mblen(src);
+			l = pg_utf_mblen(src);
 
 			if (l > len || !pg_utf8_islegal(src, l))
 			{
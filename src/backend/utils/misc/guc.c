@@ -34,7 +34,10 @@
 
 #include "access/commit_ts.h"
 #include "access/gin.h"
+#include "access/multixact.h"
 #include "access/rmgr.h"
+#include "access/slru.h"
+#include "access/subtrans.h"
 #include "access/tableam.h"
 #include "access/toast_compression.h"
 #include "access/transam.h"
@@ -51,6 +54,7 @@
 #include "catalog/storage.h"
 #include "commands/async.h"
 #include "commands/prepare.h"
+#include "commands/sequence.h"
 #include "commands/tablespace.h"
 #include "commands/trigger.h"
 #include "commands/user.h"
@@ -87,12 +91,17 @@
 #include "replication/walreceiver.h"
 #include "replication/walsender.h"
 #include "storage/bufmgr.h"
+#include "storage/buffile.h"
+#include "storage/bufsim.h"
+#include "storage/dbsize_cache.h"
 #include "storage/dsm_impl.h"
 #include "storage/fd.h"
 #include "storage/large_object.h"
 #include "storage/pg_shmem.h"
 #include "storage/predicate.h"
 #include "storage/proc.h"
+#include "storage/relsize_cache.h"
+#include "storage/sinvaladt.h"
 #include "storage/smgr.h"
 #include "storage/standby.h"
 #include "tcop/tcopprot.h"
@@ -140,6 +149,7 @@
 extern bool Log_disconnections;
 extern int	CommitDelay;
 extern int	CommitSiblings;
+extern bool adaptive_commit_delay;
 extern char *default_tablespace;
 extern char *temp_tablespaces;
 extern bool ignore_checksum_failure;
@@ -512,6 +522,12 @@ static const struct config_enum_entry recovery_prefetch_options[] = {
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry buffer_simulation_level_options[] = {
+	{"shared_buffers", BUFFER_SIMULATION_SHARED_BUFFERS, false},
+	{"file_cache", BUFFER_SIMULATION_FILE_CACHE, false},
+	{NULL, 0, false}
+};
+
 static const struct config_enum_entry force_parallel_mode_options[] = {
 	{"off", FORCE_PARALLEL_OFF, false},
 	{"on", FORCE_PARALLEL_ON, false},
@@ -575,6 +591,18 @@ static struct config_enum_entry default_toast_compression_options[] = {
 	{"pglz", TOAST_PGLZ_COMPRESSION, false},
 #ifdef  USE_LZ4
 	{"lz4", TOAST_LZ4_COMPRESSION, false},
+#endif
+#ifdef USE_ZSTD
+	{"zstd", TOAST_ZSTD_COMPRESSION, false},
+#endif
+	{NULL, 0, false}
+};
+
+static const struct config_enum_entry temp_file_compression_options[] = {
+	{"none", TEMP_FILE_COMPRESSION_NONE, false},
+	{"pglz", TEMP_FILE_COMPRESSION_PGLZ, false},
+#ifdef USE_LZ4
+	{"lz4", TEMP_FILE_COMPRESSION_LZ4, false},
 #endif
 	{NULL, 0, false}
 };
@@ -1036,7 +1064,7 @@ static struct config_bool ConfigureNamesBool[] =
 	},
 	{
 		{"enable_indexonlyscan_prefetch", PGC_USERSET, RESOURCES_ASYNCHRONOUS,
-			gettext_noop("Enables prefetching of leave pages in index-only scans."),
+			gettext_noop("Enables prefetching of leaf pages and of not all-visible heap pages in index-only scans."),
 			NULL,
 			GUC_EXPLAIN
 		},
@@ -1044,6 +1072,16 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_nestloop_prefetch", PGC_USERSET, RESOURCES_ASYNCHRONOUS,
+			gettext_noop("Enables prefetching for the inner index scans of nested-loop joins."),
+			NULL,
+			GUC_EXPLAIN
+		},
+		&enable_nestloop_prefetch,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_seqscan", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of sequential-scan plans."),
@@ -2213,6 +2251,16 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"adaptive_commit_delay", PGC_SUSET, UNGROUPED,
+			gettext_noop("Sizes the commit delay by the time synchronous standbys take to confirm a flush."),
+			gettext_noop("commit_delay, if set, is the upper limit of the delay.")
+		},
+		&adaptive_commit_delay,
+		false,
+		NULL, NULL, NULL
+	},
+
 
 	/* End-of-list marker */
 	{
@@ -2281,6 +2329,17 @@ static struct config_int ConfigureNamesInt[] =
 		8, 1, INT_MAX,
 		NULL, NULL, NULL
 	},
+	{
+		{"jit_defer_evaluations", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the number of evaluations of an expression "
+						 "before it is JIT compiled."),
+			gettext_noop("Zero compiles expressions before the query starts."),
+			GUC_EXPLAIN
+		},
+		&jit_defer_evaluations,
+		0, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
 	{
 		{"geqo_threshold", PGC_USERSET, QUERY_TUNING_GEQO,
 			gettext_noop("Sets the threshold of FROM items beyond which GEQO is used."),
@@ -2468,6 +2527,48 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"relsize_cache_size", PGC_POSTMASTER, UNGROUPED,
+			gettext_noop("Sets the number of relation fork sizes cached in shared memory."),
+			gettext_noop("0 disables the cache.")
+		},
+		&relsize_cache_size,
+		8192, 0, INT_MAX / 2,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"dbsize_cache_ttl", PGC_SIGHUP, UNGROUPED,
+			gettext_noop("Sets how long a cached database size reported by the storage may be used."),
+			gettext_noop("0 disables the cache."),
+			GUC_UNIT_S
+		},
+		&dbsize_cache_ttl,
+		10, 0, INT_MAX / 1000,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"buffer_simulation_size", PGC_POSTMASTER, UNGROUPED,
+			gettext_noop("Sets the number of buffers of the simulated buffer cache."),
+			gettext_noop("0 disables the simulation."),
+			GUC_UNIT_BLOCKS
+		},
+		&buffer_simulation_size,
+		0, 0, INT_MAX / 2,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"neon_sequence_log_values", PGC_SUSET, UNGROUPED,
+			gettext_noop("Sets the number of sequence values WAL-logged in advance by nextval()."),
+			gettext_noop("0 WAL-logs every sequence fetch.")
+		},
+		&neon_sequence_log_values,
+		0, 0, 1024 * 1024,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"temp_buffers", PGC_USERSET, RESOURCES_MEM,
 			gettext_noop("Sets the maximum number of temporary buffers used by each session."),
@@ -2569,6 +2670,18 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"max_backend_memory", PGC_SUSET, RESOURCES_MEM,
+			gettext_noop("Sets the maximum memory to be allocated by each backend."),
+			gettext_noop("A query that needs more memory is canceled. "
+						 "0 disables the limit."),
+			GUC_UNIT_KB
+		},
+		&max_backend_memory,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
 	/*
 	 * We use the hopefully-safely-small value of 100kB as the compiled-in
 	 * default for max_stack_depth.  InitializeGUCOptions will increase it if
@@ -2669,6 +2782,49 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"subtransaction_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the subtransaction cache."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&subtransaction_buffers,
+		32, 8, SLRU_MAX_ALLOWED_BUFFERS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"multixact_offset_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the MultiXact offset cache."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&multixact_offset_buffers,
+		8, 8, SLRU_MAX_ALLOWED_BUFFERS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"multixact_member_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the MultiXact member cache."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&multixact_member_buffers,
+		16, 8, SLRU_MAX_ALLOWED_BUFFERS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"invalidation_queue_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the number of messages the shared cache invalidation queue can hold."),
+			gettext_noop("Must be a power of two.")
+		},
+		&invalidation_queue_size,
+		4096, 4096, 1024 * 1024,
+		check_invalidation_queue_size, NULL, NULL
+	},
+
 #ifdef LOCK_DEBUG
 	{
 		{"trace_lock_oidmin", PGC_SUSET, DEVELOPER_OPTIONS,
@@ -2971,6 +3127,16 @@ static struct config_int ConfigureNamesInt[] =
 		check_wal_buffers, NULL, NULL
 	},
 
+	{
+		{"wal_insert_locks", PGC_POSTMASTER, WAL_SETTINGS,
+			gettext_noop("Sets the number of locks that allow WAL insertions to proceed concurrently."),
+			gettext_noop("-1 means to choose a number based on max_connections.")
+		},
+		&wal_insert_locks,
+		-1, -1, MAX_WAL_INSERT_LOCKS,
+		check_wal_insert_locks, NULL, NULL
+	},
+
 	{
 		{"wal_writer_delay", PGC_SIGHUP, WAL_SETTINGS,
 			gettext_noop("Time between WAL flushes performed in the WAL writer."),
@@ -2993,6 +3159,16 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"wal_preallocate_segments", PGC_SIGHUP, WAL_SETTINGS,
+			gettext_noop("Number of WAL segments that WAL writer keeps ready ahead of the insert position."),
+			NULL
+		},
+		&wal_preallocate_segments,
+		0, 0, 1024,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_skip_threshold", PGC_USERSET, WAL_SETTINGS,
 			gettext_noop("Minimum size of new file to fsync instead of writing WAL."),
@@ -3004,6 +3180,16 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"wal_compression_zstd_level", PGC_SUSET, WAL_SETTINGS,
+			gettext_noop("Sets the compression level used when wal_compression is zstd."),
+			NULL
+		},
+		&wal_compression_zstd_level,
+		3, 1, 22,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"max_wal_senders", PGC_POSTMASTER, REPLICATION_SENDING,
 			gettext_noop("Sets the maximum number of simultaneously running WAL sender processes."),
@@ -5120,6 +5306,16 @@ static struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"temp_file_compression", PGC_USERSET, RESOURCES_DISK,
+			gettext_noop("Sets the compression method for hash join and tuplestore temporary files."),
+			NULL
+		},
+		&temp_file_compression,
+		TEMP_FILE_COMPRESSION_NONE, temp_file_compression_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"recovery_prefetch", PGC_SIGHUP, WAL_RECOVERY,
 			gettext_noop("Prefetch referenced blocks during recovery."),
@@ -5197,6 +5393,17 @@ static struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"buffer_simulation_level", PGC_SIGHUP, UNGROUPED,
+			gettext_noop("Sets which buffer lookups the simulated buffer cache sees."),
+			gettext_noop("shared_buffers simulates a buffer pool of a different size, "
+						 "file_cache a cache between the buffer pool and the storage.")
+		},
+		&buffer_simulation_level,
+		BUFFER_SIMULATION_SHARED_BUFFERS, buffer_simulation_level_options,
+		NULL, NULL, NULL
+	},
+
 	/* End-of-list marker */
 	{
 		{NULL, 0, 0, NULL, NULL}, NULL, 0, NULL, NULL, NULL, NULL
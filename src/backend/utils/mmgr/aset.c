@@ -466,7 +466,7 @@ AllocSetContextCreateInternal(MemoryContext parent,
 	 * Allocate the initial block.  Unlike other aset.c blocks, it starts with
 	 * the context header and its block header follows that.
 	 */
-	set = (AllocSet) malloc(firstBlockSize);
+	set = (AllocSet) BackendMemoryAlloc(firstBlockSize);
 	if (set == NULL)
 	{
 		if (TopMemoryContext)
@@ -600,12 +600,14 @@ AllocSetReset(MemoryContext context)
 		else
 		{
 			/* Normal case, release the block */
-			context->mem_allocated -= block->endptr - ((char *) block);
+			Size		blksize = block->endptr - ((char *) block);
+
+			context->mem_allocated -= blksize;
 
 #ifdef CLOBBER_FREED_MEMORY
 			wipe_mem(block, block->freeptr - ((char *) block));
 #endif
-			free(block);
+			BackendMemoryFree(block, blksize);
 		}
 		block = next;
 	}
@@ -628,8 +630,7 @@ AllocSetDelete(MemoryContext context)
 {
 	AllocSet	set = (AllocSet) context;
 	AllocBlock	block = set->blocks;
-	Size		keepersize PG_USED_FOR_ASSERTS_ONLY
-	= set->keeper->endptr - ((char *) set);
+	Size		keepersize = set->keeper->endptr - ((char *) set);
 
 	AssertArg(AllocSetIsValid(set));
 
@@ -667,7 +668,8 @@ AllocSetDelete(MemoryContext context)
 				freelist->num_free--;
 
 				/* All that remains is to free the header/initial block */
-				free(oldset);
+				BackendMemoryFree(oldset,
+								  oldset->keeper->endptr - ((char *) oldset));
 			}
 			Assert(freelist->num_free == 0);
 		}
@@ -684,16 +686,17 @@ AllocSetDelete(MemoryContext context)
 	while (block != NULL)
 	{
 		AllocBlock	next = block->next;
+		Size		blksize = block->endptr - ((char *) block);
 
 		if (block != set->keeper)
-			context->mem_allocated -= block->endptr - ((char *) block);
+			context->mem_allocated -= blksize;
 
 #ifdef CLOBBER_FREED_MEMORY
 		wipe_mem(block, block->freeptr - ((char *) block));
 #endif
 
 		if (block != set->keeper)
-			free(block);
+			BackendMemoryFree(block, blksize);
 
 		block = next;
 	}
@@ -701,7 +704,7 @@ AllocSetDelete(MemoryContext context)
 	Assert(context->mem_allocated == keepersize);
 
 	/* Finally, free the context header, including the keeper block */
-	free(set);
+	BackendMemoryFree(set, keepersize);
 }
 
 /*
@@ -737,7 +740,7 @@ AllocSetAlloc(MemoryContext context, Size size)
 	{
 		chunk_size = MAXALIGN(size);
 		blksize = chunk_size + ALLOC_BLOCKHDRSZ + ALLOC_CHUNKHDRSZ;
-		block = (AllocBlock) malloc(blksize);
+		block = (AllocBlock) BackendMemoryAlloc(blksize);
 		if (block == NULL)
 			return NULL;
 
@@ -917,7 +920,7 @@ AllocSetAlloc(MemoryContext context, Size size)
 			blksize <<= 1;
 
 		/* Try to allocate it */
-		block = (AllocBlock) malloc(blksize);
+		block = (AllocBlock) BackendMemoryAlloc(blksize);
 
 		/*
 		 * We could be asking for pretty big blocks here, so cope if malloc
@@ -928,7 +931,7 @@ AllocSetAlloc(MemoryContext context, Size size)
 			blksize >>= 1;
 			if (blksize < required_size)
 				break;
-			block = (AllocBlock) malloc(blksize);
+			block = (AllocBlock) BackendMemoryAlloc(blksize);
 		}
 
 		if (block == NULL)
@@ -1013,6 +1016,7 @@ AllocSetFree(MemoryContext context, void *pointer)
 		 * blocks.  Just unlink that block and return it to malloc().
 		 */
 		AllocBlock	block = (AllocBlock) (((char *) chunk) - ALLOC_BLOCKHDRSZ);
+		Size		blksize;
 
 		/*
 		 * Try to verify that we have a sane block pointer: it should
@@ -1033,12 +1037,13 @@ AllocSetFree(MemoryContext context, void *pointer)
 		if (block->next)
 			block->next->prev = block->prev;
 
-		context->mem_allocated -= block->endptr - ((char *) block);
+		blksize = block->endptr - ((char *) block);
+		context->mem_allocated -= blksize;
 
 #ifdef CLOBBER_FREED_MEMORY
 		wipe_mem(block, block->freeptr - ((char *) block));
 #endif
-		free(block);
+		BackendMemoryFree(block, blksize);
 	}
 	else
 	{
@@ -1127,7 +1132,7 @@ AllocSetRealloc(MemoryContext context, void *pointer, Size size)
 		blksize = chksize + ALLOC_BLOCKHDRSZ + ALLOC_CHUNKHDRSZ;
 		oldblksize = block->endptr - ((char *) block);
 
-		block = (AllocBlock) realloc(block, blksize);
+		block = (AllocBlock) BackendMemoryRealloc(block, oldblksize, blksize);
 		if (block == NULL)
 		{
 			/* Disallow external access to private part of chunk header. */
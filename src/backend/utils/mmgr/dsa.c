@@ -28,7 +28,10 @@
  * allocation of small objects from pre-existing superblocks uses one LWLock
  * per pool.  Currently there is one pool, and therefore one lock, per size
  * class.  Per-core pools to increase concurrency and strategies for reducing
- * the resulting fragmentation are areas for future research.  Each superblock
+ * the resulting fragmentation are areas for future research.  A backend may
+ * also opt in to keeping a small private cache of free objects per size
+ * class (see dsa_enable_cache), so that most small allocations and frees
+ * don't touch the pool's lock at all.  Each superblock
  * is managed with a 'span', which tracks the superblock's freelist.  Free
  * requests are handled by looking in the page map to find which span an
  * address was allocated from, so that small objects can be returned to the
@@ -250,6 +253,24 @@ static const uint16 dsa_size_classes[] = {
 #define DSA_SCLASS_BLOCK_OF_SPANS		0
 #define DSA_SCLASS_SPAN_LARGE			1
 
+/*
+ * When a backend has enabled object caching for an area, it keeps up to
+ * DSA_CACHE_SIZE free objects of each size class no larger than
+ * DSA_CACHE_MAX_OBJECT_SIZE in backend-private memory.  The cache is refilled
+ * from, and overflows back into, the shared pool DSA_CACHE_BATCH objects at a
+ * time, so that the pool's lock is taken once per batch rather than once per
+ * object.  Larger objects are rarer and are always handled by the pool.
+ */
+#define DSA_CACHE_SIZE					16
+#define DSA_CACHE_BATCH					8
+#define DSA_CACHE_MAX_OBJECT_SIZE		1024
+
+/* Is the given size class served from the backend's cache? */
+#define DsaSizeClassIsCached(area, size_class) \
+	((area)->caches != NULL && \
+	 (size_class) > DSA_SCLASS_SPAN_LARGE && \
+	 dsa_size_classes[(size_class)] <= DSA_CACHE_MAX_OBJECT_SIZE)
+
 /*
  * The following lookup table is used to map the size of small objects
  * (less than 1kB) onto the corresponding size class.  To use this table,
@@ -345,6 +366,17 @@ typedef struct
 	dsa_pointer *pagemap;		/* Page map within segment. */
 } dsa_segment_map;
 
+/*
+ * A dsa_object_cache holds free objects of one size class that this backend
+ * has taken out of the shared pool, stacked so that the most recently freed
+ * object is handed out first.  See DSA_CACHE_SIZE.
+ */
+typedef struct
+{
+	int			nobjects;		/* Number of objects currently cached */
+	dsa_pointer objects[DSA_CACHE_SIZE];
+} dsa_object_cache;
+
 /*
  * Per-backend state for a storage area.  Backends obtain one of these by
  * creating an area or attaching to an existing one using a handle.  Each
@@ -372,6 +404,12 @@ struct dsa_area
 
 	/* The last observed freed_segment_counter. */
 	size_t		freed_segment_counter;
+
+	/*
+	 * This backend's caches of free objects, indexed by size class, or NULL
+	 * if dsa_enable_cache hasn't been called.
+	 */
+	dsa_object_cache *caches;
 };
 
 #define DSA_SPAN_NOTHING_FREE	((uint16) -1)
@@ -387,6 +425,11 @@ static void init_span(dsa_area *area, dsa_pointer span_pointer,
 static bool transfer_first_span(dsa_area *area, dsa_area_pool *pool,
 								int fromclass, int toclass);
 static inline dsa_pointer alloc_object(dsa_area *area, int size_class);
+static dsa_pointer alloc_object_locked(dsa_area *area, int size_class);
+static void free_object_locked(dsa_area *area, dsa_pointer dp);
+static void refill_object_cache(dsa_area *area, int size_class);
+static void flush_object_cache(dsa_area *area, int size_class, int nobjects);
+static void flush_all_object_caches(dsa_area *area);
 static bool ensure_active_superblock(dsa_area *area, dsa_area_pool *pool,
 									 int size_class);
 static dsa_segment_map *get_segment_by_index(dsa_area *area,
@@ -641,6 +684,32 @@ dsa_pin_mapping(dsa_area *area)
 			dsm_pin_mapping(area->segment_maps[i].segment);
 }
 
+/*
+ * Keep a private cache of free small objects for this backend, so that most
+ * calls to dsa_allocate and dsa_free for small sizes don't need to acquire
+ * the shared pool's lock.  This pays off for areas in which several backends
+ * concurrently allocate and free many small objects.
+ *
+ * Objects in the cache remain allocated as far as other backends are
+ * concerned until they are handed back, which happens in batches, and in
+ * full by dsa_trim and dsa_detach.  Callers must therefore only enable this
+ * for an area that is either reliably detached with dsa_detach while its
+ * segments are still mapped, or that is destroyed as a whole once this
+ * backend is finished with it; otherwise up to DSA_CACHE_SIZE objects per
+ * size class could be leaked when the backend exits.
+ */
+void
+dsa_enable_cache(dsa_area *area)
+{
+	if (area->caches != NULL)
+		return;
+
+	/* Allocate the caches alongside the area object, which frees them. */
+	area->caches = MemoryContextAllocZero(GetMemoryChunkContext(area),
+										  sizeof(dsa_object_cache) *
+										  DSA_NUM_SIZE_CLASSES);
+}
+
 /*
  * Allocate memory in this storage area.  The return value is a dsa_pointer
  * that can be passed to other processes, and converted to a local pointer
@@ -792,8 +861,23 @@ dsa_allocate_extended(dsa_area *area, size_t size, int flags)
 	Assert(size <= dsa_size_classes[size_class]);
 	Assert(size_class == 0 || size > dsa_size_classes[size_class - 1]);
 
-	/* Attempt to allocate an object from the appropriate pool. */
-	result = alloc_object(area, size_class);
+	/*
+	 * Attempt to allocate an object from this backend's cache, if enabled,
+	 * or otherwise from the appropriate pool.
+	 */
+	if (DsaSizeClassIsCached(area, size_class))
+	{
+		dsa_object_cache *cache = &area->caches[size_class];
+
+		if (cache->nobjects == 0)
+			refill_object_cache(area, size_class);
+		if (cache->nobjects > 0)
+			result = cache->objects[--cache->nobjects];
+		else
+			result = InvalidDsaPointer;
+	}
+	else
+		result = alloc_object(area, size_class);
 
 	/* Check for failure to allocate. */
 	if (!DsaPointerIsValid(result))
@@ -824,9 +908,6 @@ dsa_free(dsa_area *area, dsa_pointer dp)
 	int			pageno;
 	dsa_pointer span_pointer;
 	dsa_area_span *span;
-	char	   *superblock;
-	char	   *object;
-	size_t		size;
 	int			size_class;
 
 	/* Make sure we don't have a stale segment in the slot 'dp' refers to. */
@@ -837,10 +918,7 @@ dsa_free(dsa_area *area, dsa_pointer dp)
 	pageno = DSA_EXTRACT_OFFSET(dp) / FPM_PAGE_SIZE;
 	span_pointer = segment_map->pagemap[pageno];
 	span = dsa_get_address(area, span_pointer);
-	superblock = dsa_get_address(area, span->start);
-	object = dsa_get_address(area, dp);
 	size_class = span->size_class;
-	size = dsa_size_classes[size_class];
 
 	/*
 	 * Special case for large objects that live in a special span: we return
@@ -850,7 +928,7 @@ dsa_free(dsa_area *area, dsa_pointer dp)
 	{
 
 #ifdef CLOBBER_FREED_MEMORY
-		memset(object, 0x7f, span->npages * FPM_PAGE_SIZE);
+		memset(dsa_get_address(area, dp), 0x7f, span->npages * FPM_PAGE_SIZE);
 #endif
 
 		/* Give pages back to free page manager. */
@@ -874,10 +952,55 @@ dsa_free(dsa_area *area, dsa_pointer dp)
 	}
 
 #ifdef CLOBBER_FREED_MEMORY
-	memset(object, 0x7f, size);
+	memset(dsa_get_address(area, dp), 0x7f, dsa_size_classes[size_class]);
 #endif
 
+	/*
+	 * If this backend caches objects of this size, just push it onto the
+	 * cache, first making room by giving a batch of older objects back to the
+	 * pool if the cache is full.
+	 */
+	if (DsaSizeClassIsCached(area, size_class))
+	{
+		dsa_object_cache *cache = &area->caches[size_class];
+
+		if (cache->nobjects == DSA_CACHE_SIZE)
+			flush_object_cache(area, size_class, DSA_CACHE_BATCH);
+		cache->objects[cache->nobjects++] = dp;
+		return;
+	}
+
 	LWLockAcquire(DSA_SCLASS_LOCK(area, size_class), LW_EXCLUSIVE);
+	free_object_locked(area, dp);
+	LWLockRelease(DSA_SCLASS_LOCK(area, size_class));
+}
+
+/*
+ * Return a small object to its span's freelist.  The caller must hold the
+ * lock for the object's size class.
+ */
+static void
+free_object_locked(dsa_area *area, dsa_pointer dp)
+{
+	dsa_segment_map *segment_map;
+	int			pageno;
+	dsa_pointer span_pointer;
+	dsa_area_span *span;
+	char	   *superblock;
+	char	   *object;
+	size_t		size;
+
+	/* Locate the object and span. */
+	segment_map = get_segment_by_index(area, DSA_EXTRACT_SEGMENT_NUMBER(dp));
+	pageno = DSA_EXTRACT_OFFSET(dp) / FPM_PAGE_SIZE;
+	span_pointer = segment_map->pagemap[pageno];
+	span = dsa_get_address(area, span_pointer);
+	superblock = dsa_get_address(area, span->start);
+	object = dsa_get_address(area, dp);
+	size = dsa_size_classes[span->size_class];
+
+	Assert(span->size_class != DSA_SCLASS_SPAN_LARGE);
+	Assert(LWLockHeldByMe(DSA_SCLASS_LOCK(area, span->size_class)));
 
 	/* Put the object on the span's freelist. */
 	Assert(object >= superblock);
@@ -923,8 +1046,6 @@ dsa_free(dsa_area *area, dsa_pointer dp)
 		 */
 		destroy_superblock(area, span_pointer);
 	}
-
-	LWLockRelease(DSA_SCLASS_LOCK(area, size_class));
 }
 
 /*
@@ -1026,6 +1147,9 @@ dsa_trim(dsa_area *area)
 {
 	int			size_class;
 
+	/* Give back any objects this backend is holding on to. */
+	flush_all_object_caches(area);
+
 	/*
 	 * Trim in reverse pool order so we get to the spans-of-spans last, just
 	 * in case any become entirely free while processing all the other pools.
@@ -1256,6 +1380,7 @@ create_internal(void *place, size_t size,
 	memset(area->segment_maps, 0, sizeof(dsa_segment_map) * DSA_MAX_SEGMENTS);
 	area->high_segment_index = 0;
 	area->freed_segment_counter = 0;
+	area->caches = NULL;
 	LWLockInitialize(&control->lock, control->lwlock_tranche_id);
 	for (i = 0; i < DSA_NUM_SIZE_CLASSES; ++i)
 		LWLockInitialize(DSA_SCLASS_LOCK(area, i),
@@ -1312,6 +1437,7 @@ attach_internal(void *place, dsm_segment *segment, dsa_handle handle)
 	memset(&area->segment_maps[0], 0,
 		   sizeof(dsa_segment_map) * DSA_MAX_SEGMENTS);
 	area->high_segment_index = 0;
+	area->caches = NULL;
 
 	/* Set up the segment map for this process's mapping. */
 	segment_map = &area->segment_maps[0];
@@ -1441,12 +1567,7 @@ transfer_first_span(dsa_area *area,
 static inline dsa_pointer
 alloc_object(dsa_area *area, int size_class)
 {
-	dsa_area_pool *pool = &area->control->pools[size_class];
-	dsa_area_span *span;
-	dsa_pointer block;
 	dsa_pointer result;
-	char	   *object;
-	size_t		size;
 
 	/*
 	 * Even though ensure_active_superblock can in turn call alloc_object if
@@ -1456,6 +1577,27 @@ alloc_object(dsa_area *area, int size_class)
 	 */
 	Assert(!LWLockHeldByMe(DSA_SCLASS_LOCK(area, size_class)));
 	LWLockAcquire(DSA_SCLASS_LOCK(area, size_class), LW_EXCLUSIVE);
+	result = alloc_object_locked(area, size_class);
+	LWLockRelease(DSA_SCLASS_LOCK(area, size_class));
+
+	return result;
+}
+
+/*
+ * Workhorse for alloc_object and refill_object_cache.  The caller must hold
+ * the size class's lock.
+ */
+static dsa_pointer
+alloc_object_locked(dsa_area *area, int size_class)
+{
+	dsa_area_pool *pool = &area->control->pools[size_class];
+	dsa_area_span *span;
+	dsa_pointer block;
+	dsa_pointer result;
+	char	   *object;
+	size_t		size;
+
+	Assert(LWLockHeldByMe(DSA_SCLASS_LOCK(area, size_class)));
 
 	/*
 	 * If there's no active superblock, we must successfully obtain one or
@@ -1498,10 +1640,70 @@ alloc_object(dsa_area *area, int size_class)
 			transfer_first_span(area, pool, 1, DSA_FULLNESS_CLASSES - 1);
 	}
 
-	Assert(LWLockHeldByMe(DSA_SCLASS_LOCK(area, size_class)));
+	return result;
+}
+
+/*
+ * Move up to DSA_CACHE_BATCH objects from the shared pool into this
+ * backend's cache for the given size class, taking the pool's lock only
+ * once.  On return the cache is empty only if the pool is out of memory.
+ */
+static void
+refill_object_cache(dsa_area *area, int size_class)
+{
+	dsa_object_cache *cache = &area->caches[size_class];
+
+	Assert(!LWLockHeldByMe(DSA_SCLASS_LOCK(area, size_class)));
+	LWLockAcquire(DSA_SCLASS_LOCK(area, size_class), LW_EXCLUSIVE);
+	while (cache->nobjects < DSA_CACHE_BATCH)
+	{
+		dsa_pointer object = alloc_object_locked(area, size_class);
+
+		if (!DsaPointerIsValid(object))
+			break;
+		cache->objects[cache->nobjects++] = object;
+	}
 	LWLockRelease(DSA_SCLASS_LOCK(area, size_class));
+}
 
-	return result;
+/*
+ * Give the 'nobjects' least recently cached objects of the given size class
+ * back to the shared pool, taking the pool's lock only once.
+ */
+static void
+flush_object_cache(dsa_area *area, int size_class, int nobjects)
+{
+	dsa_object_cache *cache = &area->caches[size_class];
+	int			i;
+
+	Assert(nobjects <= cache->nobjects);
+	if (nobjects == 0)
+		return;
+
+	LWLockAcquire(DSA_SCLASS_LOCK(area, size_class), LW_EXCLUSIVE);
+	for (i = 0; i < nobjects; ++i)
+		free_object_locked(area, cache->objects[i]);
+	LWLockRelease(DSA_SCLASS_LOCK(area, size_class));
+
+	cache->nobjects -= nobjects;
+	memmove(&cache->objects[0], &cache->objects[nobjects],
+			sizeof(dsa_pointer) * cache->nobjects);
+}
+
+/*
+ * Give all of this backend's cached objects back to the shared pools.
+ */
+static void
+flush_all_object_caches(dsa_area *area)
+{
+	int			size_class;
+
+	if (area->caches == NULL)
+		return;
+
+	for (size_class = 0; size_class < DSA_NUM_SIZE_CLASSES; ++size_class)
+		flush_object_cache(area, size_class,
+						   area->caches[size_class].nobjects);
 }
 
 /*
@@ -1921,6 +2123,9 @@ dsa_detach(dsa_area *area)
 {
 	int			i;
 
+	/* Return cached objects while the segments are still mapped. */
+	flush_all_object_caches(area);
+
 	/* Detach from all segments. */
 	for (i = 0; i <= area->high_segment_index; ++i)
 		if (area->segment_maps[i].segment != NULL)
@@ -1936,6 +2141,8 @@ dsa_detach(dsa_area *area)
 	 */
 
 	/* Free the backend-local area object. */
+	if (area->caches != NULL)
+		pfree(area->caches);
 	pfree(area);
 }
 
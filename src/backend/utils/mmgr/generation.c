@@ -257,7 +257,7 @@ GenerationContextCreate(MemoryContext parent,
 	 * Allocate the initial block.  Unlike other generation.c blocks, it
 	 * starts with the context header and its block header follows that.
 	 */
-	set = (GenerationContext *) malloc(allocSize);
+	set = (GenerationContext *) BackendMemoryAlloc(allocSize);
 	if (set == NULL)
 	{
 		MemoryContextStats(TopMemoryContext);
@@ -374,10 +374,13 @@ GenerationReset(MemoryContext context)
 static void
 GenerationDelete(MemoryContext context)
 {
+	GenerationContext *set = (GenerationContext *) context;
+
 	/* Reset to release all releasable GenerationBlocks */
 	GenerationReset(context);
 	/* And free the context header and keeper block */
-	free(context);
+	BackendMemoryFree(context,
+					  MAXALIGN(sizeof(GenerationContext)) + set->keeper->blksize);
 }
 
 /*
@@ -407,7 +410,7 @@ GenerationAlloc(MemoryContext context, Size size)
 	{
 		Size		blksize = required_size + Generation_BLOCKHDRSZ;
 
-		block = (GenerationBlock *) malloc(blksize);
+		block = (GenerationBlock *) BackendMemoryAlloc(blksize);
 		if (block == NULL)
 			return NULL;
 
@@ -508,7 +511,7 @@ GenerationAlloc(MemoryContext context, Size size)
 			if (blksize < required_size)
 				blksize = pg_nextpower2_size_t(required_size);
 
-			block = (GenerationBlock *) malloc(blksize);
+			block = (GenerationBlock *) BackendMemoryAlloc(blksize);
 
 			if (block == NULL)
 				return NULL;
@@ -639,6 +642,8 @@ GenerationBlockFreeBytes(GenerationBlock *block)
 static inline void
 GenerationBlockFree(GenerationContext *set, GenerationBlock *block)
 {
+	Size		blksize = block->blksize;
+
 	/* Make sure nobody tries to free the keeper block */
 	Assert(block != set->keeper);
 	/* We shouldn't be freeing the freeblock either */
@@ -647,13 +652,13 @@ GenerationBlockFree(GenerationContext *set, GenerationBlock *block)
 	/* release the block from the list of blocks */
 	dlist_delete(&block->node);
 
-	((MemoryContext) set)->mem_allocated -= block->blksize;
+	((MemoryContext) set)->mem_allocated -= blksize;
 
 #ifdef CLOBBER_FREED_MEMORY
-	wipe_mem(block, block->blksize);
+	wipe_mem(block, blksize);
 #endif
 
-	free(block);
+	BackendMemoryFree(block, blksize);
 }
 
 /*
@@ -733,7 +738,7 @@ GenerationFree(MemoryContext context, void *pointer)
 	dlist_delete(&block->node);
 
 	context->mem_allocated -= block->blksize;
-	free(block);
+	BackendMemoryFree(block, block->blksize);
 }
 
 /*
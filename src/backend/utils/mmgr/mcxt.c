@@ -26,6 +26,7 @@
 #include "storage/proc.h"
 #include "storage/procarray.h"
 #include "storage/procsignal.h"
+#include "utils/backend_status.h"
 #include "utils/fmgrprotos.h"
 #include "utils/memdebug.h"
 #include "utils/memutils.h"
@@ -56,6 +57,17 @@ MemoryContext CurTransactionContext = NULL;
 /* This is a transient link to the active portal's memory context: */
 MemoryContext PortalContext = NULL;
 
+/*
+ * Memory allocated by the memory contexts of this backend, in bytes.  While
+ * the backend has an entry in the backend status array, every change is also
+ * reported there, where other backends can see it (see pgstat_bestart).
+ */
+uint64		backend_allocated_bytes = 0;
+bool		backend_memory_reporting = false;
+
+/* GUC variable: limit of backend_allocated_bytes, in kB */
+int			max_backend_memory = 0;
+
 static void MemoryContextCallResetCallbacks(MemoryContext context);
 static void MemoryContextStatsInternal(MemoryContext context, int level,
 									   bool print, int max_children,
@@ -79,6 +91,54 @@ static void MemoryContextStatsPrint(MemoryContext context, void *passthru,
  *****************************************************************************/
 
 
+/*
+ * BackendMemoryLimitExceeded
+ *		Would allocating another "size" bytes exceed max_backend_memory?
+ *
+ * If so, the memory context refuses the allocation, which makes palloc()
+ * throw an out-of-memory ERROR and cancel the query.  The limit is not
+ * enforced where an ERROR would be escalated or could not be reported: in
+ * critical sections, while interrupts are held off (which covers error
+ * recovery), and in processes without an entry in the backend status array,
+ * notably the postmaster.
+ */
+bool
+BackendMemoryLimitExceeded(Size size)
+{
+	if (backend_allocated_bytes + size <= (uint64) max_backend_memory * 1024)
+		return false;
+
+	if (CritSectionCount > 0 || InterruptHoldoffCount > 0 ||
+		!backend_memory_reporting)
+		return false;
+
+	return true;
+}
+
+/*
+ * BackendMemorySetReporting
+ *		Start or stop reporting the backend's memory total in its entry in
+ *		the backend status array.
+ */
+void
+BackendMemorySetReporting(bool reporting)
+{
+	backend_memory_reporting = reporting;
+	if (reporting)
+		BackendMemoryReport();
+}
+
+/*
+ * BackendMemoryReport
+ *		Report the backend's memory total in the backend status array.
+ */
+void
+BackendMemoryReport(void)
+{
+	pgstat_report_allocated_bytes(backend_allocated_bytes);
+}
+
+
 /*
  * MemoryContextInit
  *		Start up the memory-context subsystem.
@@ -229,7 +229,7 @@ SlabContextCreate(MemoryContext parent,
 	headerSize += chunksPerBlock * sizeof(bool);
 #endif
 
-	slab = (SlabContext *) malloc(headerSize);
+	slab = (SlabContext *) BackendMemoryAlloc(headerSize);
 	if (slab == NULL)
 	{
 		MemoryContextStats(TopMemoryContext);
@@ -308,7 +308,7 @@ SlabReset(MemoryContext context)
 #ifdef CLOBBER_FREED_MEMORY
 			wipe_mem(block, slab->blockSize);
 #endif
-			free(block);
+			BackendMemoryFree(block, slab->blockSize);
 			slab->nblocks--;
 			context->mem_allocated -= slab->blockSize;
 		}
@@ -330,7 +330,7 @@ SlabDelete(MemoryContext context)
 	/* Reset to release all the SlabBlocks */
 	SlabReset(context);
 	/* And free the context header */
-	free(context);
+	BackendMemoryFree(context, ((SlabContext *) context)->headerSize);
 }
 
 /*
@@ -365,7 +365,7 @@ SlabAlloc(MemoryContext context, Size size)
 	 */
 	if (slab->minFreeChunks == 0)
 	{
-		block = (SlabBlock *) malloc(slab->blockSize);
+		block = (SlabBlock *) BackendMemoryAlloc(slab->blockSize);
 
 		if (block == NULL)
 			return NULL;
@@ -560,7 +560,7 @@ SlabFree(MemoryContext context, void *pointer)
 	/* If the block is now completely empty, free it. */
 	if (block->nfree == slab->chunksPerBlock)
 	{
-		free(block);
+		BackendMemoryFree(block, slab->blockSize);
 		slab->nblocks--;
 		context->mem_allocated -= slab->blockSize;
 	}
@@ -337,6 +337,19 @@ ltsReadFillBuffer(LogicalTape *lt)
 		/* Advance to next block, if we have buffer space left */
 	} while (lt->buffer_size - lt->nbytes > BLCKSZ);
 
+	/*
+	 * The blocks of the different tapes are interleaved in the underlying
+	 * file, so the kernel's sequential read-ahead doesn't help when we come
+	 * back for the rest of this tape.  Ask for the next buffer's worth now,
+	 * so that it is hopefully in the page cache by the time this buffer is
+	 * consumed.  Thanks to block preallocation (see ltsGetPreallocBlock), the
+	 * blocks following the next one mostly belong to this tape, too.
+	 */
+	if (lt->nextBlockNumber != -1L)
+		BufFilePrefetchBlocks(lt->tapeSet->pfile,
+							  lt->nextBlockNumber + lt->offsetBlockNumber,
+							  lt->buffer_size / BLCKSZ);
+
 	return (lt->nbytes > 0);
 }
 
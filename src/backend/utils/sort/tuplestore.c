@@ -29,11 +29,14 @@
  * When the caller requests backward-scan capability, we write the temp file
  * in a format that allows either forward or backward scan.  Otherwise, only
  * forward scan is allowed.  A request for backward scan must be made before
- * putting any tuples into the tuplestore.  Rewind is normally allowed but
- * can be turned off via tuplestore_set_eflags; turning off rewind for all
- * read pointers enables truncation of the tuplestore at the oldest read point
- * for minimal memory usage.  (The caller must explicitly call tuplestore_trim
- * at appropriate times for truncation to actually happen.)
+ * putting any tuples into the tuplestore.  A temp file that needn't support
+ * backward scan may be compressed, per temp_file_compression.
+ *
+ * Rewind is normally allowed but can be turned off via tuplestore_set_eflags;
+ * turning off rewind for all read pointers enables truncation of the
+ * tuplestore at the oldest read point for minimal memory usage.  (The caller
+ * must explicitly call tuplestore_trim at appropriate times for truncation to
+ * actually happen.)
  *
  * Note: in TSS_WRITEFILE state, the temp file's seek position is the
  * current write position, and the write-position variables in the tuplestore
@@ -818,16 +821,23 @@ tuplestore_puttuple_common(Tuplestorestate *state, void *tuple)
 			oldowner = CurrentResourceOwner;
 			CurrentResourceOwner = state->resowner;
 
-			state->myfile = BufFileCreateTemp(state->interXact);
-
-			CurrentResourceOwner = oldowner;
-
 			/*
 			 * Freeze the decision about whether trailing length words will be
 			 * used.  We can't change this choice once data is on tape, even
 			 * though callers might drop the requirement.
 			 */
 			state->backward = (state->eflags & EXEC_FLAG_BACKWARD) != 0;
+
+			/*
+			 * The file can be compressed per temp_file_compression, unless
+			 * backward scans need relative seeks in it.
+			 */
+			if (state->backward)
+				state->myfile = BufFileCreateTemp(state->interXact);
+			else
+				state->myfile = BufFileCreateCompressTemp(state->interXact);
+
+			CurrentResourceOwner = oldowner;
 			state->status = TSS_WRITEFILE;
 			dumptuples(state);
 			break;
@@ -24,7 +24,9 @@
 #include "access/xlogrecord.h"
 #include "access/xlogstats.h"
 #include "common/fe_memutils.h"
+#include "common/hashfn.h"
 #include "common/logging.h"
+#include "common/relpath.h"
 #include "getopt_long.h"
 #include "port/pg_bitutils.h"
 #include "rmgrdesc.h"
@@ -43,6 +45,43 @@ static volatile sig_atomic_t time_to_stop = false;
 
 static const RelFileNode emptyRelFileNode = {0, 0, 0};
 
+/*
+ * Per-relation statistics for --stats=relation, keyed by relation fork.
+ * The record size of a record is counted against the first relation fork it
+ * references, and the size of each full-page image against the relation
+ * fork of the block.  Records that reference no block are counted against
+ * the all-zeroes key.
+ */
+typedef struct XLogDumpRelKey
+{
+	RelFileNode rnode;
+	ForkNumber	forknum;
+} XLogDumpRelKey;
+
+typedef struct XLogDumpRelStats
+{
+	XLogDumpRelKey key;
+	char		status;			/* for simplehash */
+	uint64		count;			/* records referencing the relation fork */
+	uint64		rec_len;
+	uint64		fpi_len;
+} XLogDumpRelStats;
+
+#define SH_PREFIX		relstats
+#define SH_ELEMENT_TYPE	XLogDumpRelStats
+#define SH_KEY_TYPE		XLogDumpRelKey
+#define SH_KEY			key
+#define SH_HASH_KEY(tb, key) \
+	hash_bytes((const unsigned char *) &(key), sizeof(XLogDumpRelKey))
+#define SH_EQUAL(tb, a, b)	(memcmp(&(a), &(b), sizeof(XLogDumpRelKey)) == 0)
+#define SH_SCOPE		static inline
+#define SH_RAW_ALLOCATOR	pg_malloc0
+#define SH_DECLARE
+#define SH_DEFINE
+#include "lib/simplehash.h"
+
+static relstats_hash *RelStats = NULL;
+
 typedef struct XLogDumpPrivate
 {
 	TimeLineID	timeline;
@@ -63,6 +102,7 @@ typedef struct XLogDumpConfig
 	bool		follow;
 	bool		stats;
 	bool		stats_per_record;
+	bool		stats_per_relation;
 
 	bool		ignore_format_errors;
 
@@ -537,6 +577,88 @@ XLogDumpDisplayRecord(XLogDumpConfig *config, XLogReaderState *record)
 	pfree(s.data);
 }
 
+/*
+ * Accumulate the per-relation statistics of a record.
+ */
+static void
+XLogDumpStoreRelStats(XLogReaderState *record)
+{
+	XLogDumpRelKey keys[XLR_MAX_BLOCK_ID + 1];
+	int			nkeys = 0;
+	uint32		rec_len;
+	uint32		fpi_len;
+	XLogDumpRelStats *entry;
+	bool		found;
+
+	if (RelStats == NULL)
+		RelStats = relstats_create(256, NULL);
+
+	XLogRecGetLen(record, &rec_len, &fpi_len);
+
+	for (int block_id = 0; block_id <= XLogRecMaxBlockId(record); block_id++)
+	{
+		XLogDumpRelKey key;
+		bool		seen = false;
+
+		memset(&key, 0, sizeof(key));
+		if (!XLogRecGetBlockTagExtended(record, block_id, &key.rnode,
+										&key.forknum, NULL, NULL))
+			continue;
+
+		entry = relstats_insert(RelStats, key, &found);
+		if (!found)
+			entry->count = entry->rec_len = entry->fpi_len = 0;
+		if (XLogRecHasBlockImage(record, block_id))
+			entry->fpi_len += XLogRecGetBlock(record, block_id)->bimg_len;
+
+		/* count each relation fork once per record */
+		for (int i = 0; i < nkeys; i++)
+		{
+			if (memcmp(&keys[i], &key, sizeof(key)) == 0)
+			{
+				seen = true;
+				break;
+			}
+		}
+		if (!seen)
+		{
+			if (nkeys == 0)
+				entry->rec_len += rec_len;
+			entry->count++;
+			keys[nkeys++] = key;
+		}
+	}
+
+	if (nkeys == 0)
+	{
+		XLogDumpRelKey key;
+
+		memset(&key, 0, sizeof(key));
+		entry = relstats_insert(RelStats, key, &found);
+		if (!found)
+			entry->count = entry->rec_len = entry->fpi_len = 0;
+		entry->rec_len += rec_len;
+		entry->count++;
+	}
+}
+
+/*
+ * qsort comparator to sort relation statistics by combined size, largest
+ * first.
+ */
+static int
+XLogDumpRelStatsCmp(const void *a, const void *b)
+{
+	const XLogDumpRelStats *ra = *(XLogDumpRelStats *const *) a;
+	const XLogDumpRelStats *rb = *(XLogDumpRelStats *const *) b;
+	uint64		la = ra->rec_len + ra->fpi_len;
+	uint64		lb = rb->rec_len + rb->fpi_len;
+
+	if (la != lb)
+		return la > lb ? -1 : 1;
+	return memcmp(&ra->key, &rb->key, sizeof(XLogDumpRelKey));
+}
+
 /*
  * Display a single row of record counts and sizes for an rmgr or record.
  */
@@ -578,6 +700,51 @@ XLogDumpStatsRow(const char *name,
 }
 
 
+/*
+ * Display the per-relation statistics, largest relation forks first.
+ */
+static void
+XLogDumpDisplayRelStats(uint64 total_count, uint64 total_rec_len,
+						uint64 total_fpi_len, uint64 total_len)
+{
+	relstats_iterator it;
+	XLogDumpRelStats *entry;
+	XLogDumpRelStats **entries;
+	int			nentries = 0;
+
+	if (RelStats == NULL)
+		return;
+
+	entries = pg_malloc(sizeof(XLogDumpRelStats *) * RelStats->members);
+	relstats_start_iterate(RelStats, &it);
+	while ((entry = relstats_iterate(RelStats, &it)) != NULL)
+		entries[nentries++] = entry;
+	qsort(entries, nentries, sizeof(XLogDumpRelStats *), XLogDumpRelStatsCmp);
+
+	for (int i = 0; i < nentries; i++)
+	{
+		const char *name;
+
+		entry = entries[i];
+		if (entry->key.rnode.relNode == InvalidOid)
+			name = "(no relation)";
+		else
+			name = psprintf("%u/%u/%u/%s",
+							entry->key.rnode.spcNode,
+							entry->key.rnode.dbNode,
+							entry->key.rnode.relNode,
+							forkNames[entry->key.forknum]);
+
+		XLogDumpStatsRow(name,
+						 entry->count, total_count,
+						 entry->rec_len, total_rec_len,
+						 entry->fpi_len, total_fpi_len,
+						 entry->rec_len + entry->fpi_len, total_len);
+	}
+
+	pg_free(entries);
+}
+
 /*
  * Display summary statistics about the records seen so far.
  */
@@ -625,60 +792,67 @@ XLogDumpDisplayStats(XLogDumpConfig *config, XLogStats *stats)
 
 	printf("%-27s %20s %8s %20s %8s %20s %8s %20s %8s\n"
 		   "%-27s %20s %8s %20s %8s %20s %8s %20s %8s\n",
-		   "Type", "N", "(%)", "Record size", "(%)", "FPI size", "(%)", "Combined size", "(%)",
+		   config->stats_per_relation ? "Relation" : "Type",
+		   "N", "(%)", "Record size", "(%)", "FPI size", "(%)", "Combined size", "(%)",
 		   "----", "-", "---", "-----------", "---", "--------", "---", "-------------", "---");
 
-	for (ri = 0; ri <= RM_MAX_ID; ri++)
+	if (config->stats_per_relation)
+		XLogDumpDisplayRelStats(total_count, total_rec_len, total_fpi_len,
+								total_len);
+	else
 	{
-		uint64		count,
-					rec_len,
-					fpi_len,
-					tot_len;
-		const RmgrDescData *desc;
-
-		if (!RmgrIdIsValid(ri))
-			continue;
-
-		desc = GetRmgrDesc(ri);
-
-		if (!config->stats_per_record)
+		for (ri = 0; ri <= RM_MAX_ID; ri++)
 		{
-			count = stats->rmgr_stats[ri].count;
-			rec_len = stats->rmgr_stats[ri].rec_len;
-			fpi_len = stats->rmgr_stats[ri].fpi_len;
-			tot_len = rec_len + fpi_len;
+			uint64		count,
+						rec_len,
+						fpi_len,
+						tot_len;
+			const RmgrDescData *desc;
 
-			if (RmgrIdIsCustom(ri) && count == 0)
+			if (!RmgrIdIsValid(ri))
 				continue;
 
-			XLogDumpStatsRow(desc->rm_name,
-							 count, total_count, rec_len, total_rec_len,
-							 fpi_len, total_fpi_len, tot_len, total_len);
-		}
-		else
-		{
-			for (rj = 0; rj < MAX_XLINFO_TYPES; rj++)
-			{
-				const char *id;
+			desc = GetRmgrDesc(ri);
 
-				count = stats->record_stats[ri][rj].count;
-				rec_len = stats->record_stats[ri][rj].rec_len;
-				fpi_len = stats->record_stats[ri][rj].fpi_len;
+			if (!config->stats_per_record)
+			{
+				count = stats->rmgr_stats[ri].count;
+				rec_len = stats->rmgr_stats[ri].rec_len;
+				fpi_len = stats->rmgr_stats[ri].fpi_len;
 				tot_len = rec_len + fpi_len;
 
-				/* Skip undefined combinations and ones that didn't occur */
-				if (count == 0)
+				if (RmgrIdIsCustom(ri) && count == 0)
 					continue;
 
-				/* the upper four bits in xl_info are the rmgr's */
-				id = desc->rm_identify(rj << 4);
-				if (id == NULL)
-					id = psprintf("UNKNOWN (%x)", rj << 4);
-
-				XLogDumpStatsRow(psprintf("%s/%s", desc->rm_name, id),
+				XLogDumpStatsRow(desc->rm_name,
 								 count, total_count, rec_len, total_rec_len,
 								 fpi_len, total_fpi_len, tot_len, total_len);
 			}
+			else
+			{
+				for (rj = 0; rj < MAX_XLINFO_TYPES; rj++)
+				{
+					const char *id;
+
+					count = stats->record_stats[ri][rj].count;
+					rec_len = stats->record_stats[ri][rj].rec_len;
+					fpi_len = stats->record_stats[ri][rj].fpi_len;
+					tot_len = rec_len + fpi_len;
+
+					/* Skip undefined combinations and ones that didn't occur */
+					if (count == 0)
+						continue;
+
+					/* the upper four bits in xl_info are the rmgr's */
+					id = desc->rm_identify(rj << 4);
+					if (id == NULL)
+						id = psprintf("UNKNOWN (%x)", rj << 4);
+
+					XLogDumpStatsRow(psprintf("%s/%s", desc->rm_name, id),
+									 count, total_count, rec_len, total_rec_len,
+									 fpi_len, total_fpi_len, tot_len, total_len);
+				}
+			}
 		}
 	}
 
@@ -742,8 +916,9 @@ usage(void)
 	printf(_("  -V, --version          output version information, then exit\n"));
 	printf(_("  -w, --fullpage         only show records with a full page write\n"));
 	printf(_("  -x, --xid=XID          only show records with transaction ID XID\n"));
-	printf(_("  -z, --stats[=record]   show statistics instead of records\n"
-			 "                         (optionally, show per-record statistics)\n"));
+	printf(_("  -z, --stats[=record|relation]\n"
+			 "                         show statistics instead of records\n"
+			 "                         (optionally, per record type or per relation)\n"));
 	printf(_("  -?, --help             show this help, then exit\n"));
 	printf(_("\nReport bugs to <%s>.\n"), PACKAGE_BUGREPORT);
 	printf(_("%s home page: <%s>\n"), PACKAGE_NAME, PACKAGE_URL);
@@ -841,6 +1016,7 @@ main(int argc, char **argv)
 	config.filter_by_fpw = false;
 	config.stats = false;
 	config.stats_per_record = false;
+	config.stats_per_relation = false;
 	config.ignore_format_errors = false;
 
 	stats.startptr = InvalidXLogRecPtr;
@@ -1014,10 +1190,13 @@ main(int argc, char **argv)
 			case 'z':
 				config.stats = true;
 				config.stats_per_record = false;
+				config.stats_per_relation = false;
 				if (optarg)
 				{
 					if (strcmp(optarg, "record") == 0)
 						config.stats_per_record = true;
+					else if (strcmp(optarg, "relation") == 0)
+						config.stats_per_relation = true;
 					else if (strcmp(optarg, "rmgr") != 0)
 					{
 						pg_log_error("unrecognized value for option %s: %s",
@@ -1320,6 +1499,8 @@ main(int argc, char **argv)
 			if (config.stats == true)
 			{
 				XLogRecStoreStats(&stats, xlogreader_state);
+				if (config.stats_per_relation)
+					XLogDumpStoreRelStats(xlogreader_state);
 				stats.endptr = xlogreader_state->EndRecPtr;
 			}
 			else
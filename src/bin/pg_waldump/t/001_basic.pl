@@ -3,6 +3,7 @@
 
 use strict;
 use warnings;
+use PostgreSQL::Test::Cluster;
 use PostgreSQL::Test::Utils;
 use Test::More;
 
@@ -10,4 +11,38 @@ program_help_ok('pg_waldump');
 program_version_ok('pg_waldump');
 program_options_handling_ok('pg_waldump');
 
+command_fails_like(
+	[ 'pg_waldump', '--stats=foo' ],
+	qr/error: unrecognized value for option --stats: foo/,
+	'invalid --stats value');
+
+# Per-relation statistics of the WAL written while filling a table
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+$node->start;
+
+$node->safe_psql('postgres', 'CREATE TABLE test_table (a int)');
+my $start_lsn =
+  $node->safe_psql('postgres', 'SELECT pg_current_wal_insert_lsn()');
+$node->safe_psql('postgres',
+	'INSERT INTO test_table SELECT generate_series(1, 1000)');
+my $end_lsn =
+  $node->safe_psql('postgres', 'SELECT pg_current_wal_insert_lsn()');
+my $relname = $node->safe_psql(
+	'postgres', q{
+	SELECT format('%s/%s/%s', t.oid, d.oid, pg_relation_filenode('test_table'))
+	FROM pg_tablespace t, pg_database d
+	WHERE t.spcname = 'pg_default' AND d.datname = current_database()});
+
+$node->stop;
+
+command_like(
+	[
+		'pg_waldump', '--path', $node->data_dir . '/pg_wal',
+		'--start', $start_lsn, '--end', $end_lsn,
+		'--stats=relation'
+	],
+	qr/^Relation\s+N\s+\(%\).*^\Q$relname\E\/main\s+[1-9]\d*\s/ms,
+	'--stats=relation reports the relation filled');
+
 done_testing();
@@ -274,6 +274,7 @@ int			agg_interval;		/* log aggregates instead of individual
 bool		per_script_stats = false;	/* whether to collect stats per script */
 int			progress = 0;		/* thread progress report every this seconds */
 bool		progress_timestamp = false; /* progress report with Unix time */
+bool		latency_percentiles = false;	/* report latency percentiles */
 int			nclients = 1;		/* number of clients */
 int			nthreads = 1;		/* number of threads */
 bool		is_connect;			/* establish connection for each transaction */
@@ -375,6 +376,27 @@ typedef struct SimpleStats
 	double		sum2;			/* sum of squared values */
 } SimpleStats;
 
+/*
+ * Histogram of transaction latencies, in microseconds, used to report
+ * latency percentiles.
+ *
+ * Values below LATENCY_HIST_SUB_BUCKETS get a bucket each.  Above that, each
+ * power-of-two range is split into LATENCY_HIST_SUB_BUCKETS equal buckets,
+ * so that a value is known to within about 3% whatever its magnitude.
+ * Values of 2^LATENCY_HIST_MAX_BIT microseconds (about 12 days) or more all
+ * go to the last bucket.
+ */
+#define LATENCY_HIST_SUB_BITS	5
+#define LATENCY_HIST_SUB_BUCKETS (1 << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_MAX_BIT	40
+#define LATENCY_HIST_BUCKETS \
+	(LATENCY_HIST_SUB_BUCKETS * (LATENCY_HIST_MAX_BIT - LATENCY_HIST_SUB_BITS + 1))
+
+typedef struct LatencyHistogram
+{
+	int64		counts[LATENCY_HIST_BUCKETS];
+} LatencyHistogram;
+
 /*
  * The instr_time type is expensive when dealing with time arithmetic.  Define
  * a type to hold microseconds instead.  Type int64 is good enough for about
@@ -453,6 +475,7 @@ typedef struct StatsData
 									 * error */
 	SimpleStats latency;
 	SimpleStats lag;
+	LatencyHistogram latency_hist;	/* only kept under --latency-percentiles */
 } StatsData;
 
 /*
@@ -821,6 +844,27 @@ static const BuiltinScript builtin_script[] =
 		"<builtin: select only>",
 		"\\set aid random(1, " CppAsString2(naccounts) " * :scale)\n"
 		"SELECT abalance FROM pgbench_accounts WHERE aid = :aid;\n"
+	},
+	{
+		"range-scan",
+		"<builtin: range scan>",
+		"\\set aid random(1, " CppAsString2(naccounts) " * :scale - 999)\n"
+		"SELECT sum(abalance) FROM pgbench_accounts WHERE aid BETWEEN :aid AND :aid + 999;\n"
+	},
+	{
+		"index-only-scan",
+		"<builtin: index-only scan>",
+		"\\set aid random(1, " CppAsString2(naccounts) " * :scale - 999)\n"
+		"SELECT count(*) FROM pgbench_accounts WHERE aid BETWEEN :aid AND :aid + 999;\n"
+	},
+	{
+		"bulk-insert",
+		"<builtin: bulk insert>",
+		"\\set aid random(1, " CppAsString2(naccounts) " * :scale - 999)\n"
+		"\\set bid random(1, " CppAsString2(nbranches) " * :scale)\n"
+		"\\set tid random(1, " CppAsString2(ntellers) " * :scale)\n"
+		"\\set delta random(-5000, 5000)\n"
+		"INSERT INTO pgbench_history (tid, bid, aid, delta, mtime) SELECT :tid, :bid, aid, :delta, CURRENT_TIMESTAMP FROM generate_series(:aid, :aid + 999) AS aid;\n"
 	}
 };
 
@@ -923,6 +967,7 @@ usage(void)
 		   "  -v, --vacuum-all         vacuum all four standard tables before tests\n"
 		   "  --aggregate-interval=NUM aggregate data over NUM seconds\n"
 		   "  --failures-detailed      report the failures grouped by basic types\n"
+		   "  --latency-percentiles    report latency percentiles\n"
 		   "  --log-prefix=PREFIX      prefix for transaction time log file\n"
 		   "                           (default: \"pgbench_log\")\n"
 		   "  --max-tries=NUM          max number of tries to run transaction (default: 1)\n"
@@ -1442,6 +1487,85 @@ mergeSimpleStats(SimpleStats *acc, SimpleStats *ss)
 	acc->sum2 += ss->sum2;
 }
 
+/*
+ * Accumulate one latency, in microseconds, into a LatencyHistogram.
+ */
+static void
+addToLatencyHistogram(LatencyHistogram *hist, double val)
+{
+	uint64		v = val > 0 ? (uint64) val : 0;
+	int			bucket;
+
+	if (v < LATENCY_HIST_SUB_BUCKETS)
+		bucket = (int) v;
+	else
+	{
+		int			msb = pg_leftmost_one_pos64(v);
+
+		if (msb >= LATENCY_HIST_MAX_BIT)
+			bucket = LATENCY_HIST_BUCKETS - 1;
+		else
+			bucket = LATENCY_HIST_SUB_BUCKETS * (msb - LATENCY_HIST_SUB_BITS + 1) +
+				(int) ((v >> (msb - LATENCY_HIST_SUB_BITS)) &
+					   (LATENCY_HIST_SUB_BUCKETS - 1));
+	}
+
+	hist->counts[bucket]++;
+}
+
+/*
+ * Merge two LatencyHistogram objects
+ */
+static void
+mergeLatencyHistogram(LatencyHistogram *acc, LatencyHistogram *hist)
+{
+	for (int i = 0; i < LATENCY_HIST_BUCKETS; i++)
+		acc->counts[i] += hist->counts[i];
+}
+
+/*
+ * Return the latency, in microseconds, below which the given fraction of the
+ * values recorded in hist fall.  If base is not NULL, only the values added
+ * to hist since it was a copy of base are considered.
+ *
+ * The result is the upper bound of the bucket holding the requested rank, so
+ * it overestimates by at most the width of that bucket.
+ */
+static double
+getLatencyPercentile(const LatencyHistogram *hist,
+					 const LatencyHistogram *base, double fraction)
+{
+	int64		total = 0;
+	int64		rank;
+	int64		seen = 0;
+
+	for (int i = 0; i < LATENCY_HIST_BUCKETS; i++)
+		total += hist->counts[i] - (base ? base->counts[i] : 0);
+
+	if (total <= 0)
+		return 0.0;
+
+	rank = (int64) ceil(fraction * total);
+	rank = Max(rank, 1);
+
+	for (int i = 0; i < LATENCY_HIST_BUCKETS; i++)
+	{
+		seen += hist->counts[i] - (base ? base->counts[i] : 0);
+		if (seen >= rank)
+		{
+			int			group = i / LATENCY_HIST_SUB_BUCKETS;
+			int			sub = i % LATENCY_HIST_SUB_BUCKETS;
+
+			if (group == 0)
+				return (double) sub;
+			return (double) ((((uint64) (LATENCY_HIST_SUB_BUCKETS + sub + 1)) << (group - 1)) - 1);
+		}
+	}
+
+	/* not reached, as the counts add up to total */
+	return 0.0;
+}
+
 /*
  * Initialize a StatsData struct to mostly zeroes, with its start time set to
  * the given value.
@@ -1458,6 +1582,7 @@ initStats(StatsData *sd, pg_time_usec_t start)
 	sd->deadlock_failures = 0;
 	initSimpleStats(&sd->latency);
 	initSimpleStats(&sd->lag);
+	memset(&sd->latency_hist, 0, sizeof(LatencyHistogram));
 }
 
 /*
@@ -1492,6 +1617,8 @@ accumStats(StatsData *stats, bool skipped, double lat, double lag,
 			stats->cnt++;
 
 			addToSimpleStats(&stats->latency, lat);
+			if (latency_percentiles)
+				addToLatencyHistogram(&stats->latency_hist, lat);
 
 			/* and possibly the same for schedule lag */
 			if (throttle_delay)
@@ -4655,7 +4782,7 @@ processXactStats(TState *thread, CState *st, pg_time_usec_t *now,
 	double		latency = 0.0,
 				lag = 0.0;
 	bool		detailed = progress || throttle_delay || latency_limit ||
-	use_log || per_script_stats;
+	use_log || per_script_stats || latency_percentiles;
 
 	if (detailed && !skipped && st->estatus == ESTATUS_NO_ERROR)
 	{
@@ -6201,6 +6328,9 @@ printProgressReport(TState *threads, int64 test_start, pg_time_usec_t now,
 	{
 		mergeSimpleStats(&cur.latency, &threads[i].stats.latency);
 		mergeSimpleStats(&cur.lag, &threads[i].stats.lag);
+		if (latency_percentiles)
+			mergeLatencyHistogram(&cur.latency_hist,
+								  &threads[i].stats.latency_hist);
 		cur.cnt += threads[i].stats.cnt;
 		cur.skipped += threads[i].stats.skipped;
 		cur.retries += threads[i].stats.retries;
@@ -6251,6 +6381,13 @@ printProgressReport(TState *threads, int64 test_start, pg_time_usec_t now,
 					cur.skipped - last->skipped);
 	}
 
+	/* percentiles over this interval only */
+	if (latency_percentiles && cnt > 0)
+		fprintf(stderr, ", p50 %.3f p99 %.3f p99.9 %.3f ms",
+				0.001 * getLatencyPercentile(&cur.latency_hist, &last->latency_hist, 0.50),
+				0.001 * getLatencyPercentile(&cur.latency_hist, &last->latency_hist, 0.99),
+				0.001 * getLatencyPercentile(&cur.latency_hist, &last->latency_hist, 0.999));
+
 	/* it can be non-zero only if max_tries is not equal to one */
 	if (max_tries != 1)
 		fprintf(stderr,
@@ -6275,6 +6412,20 @@ printSimpleStats(const char *prefix, SimpleStats *ss)
 	}
 }
 
+static void
+printLatencyPercentiles(const char *prefix, LatencyHistogram *hist)
+{
+	if (!latency_percentiles)
+		return;
+
+	printf("%s p50 = %.3f ms\n", prefix,
+		   0.001 * getLatencyPercentile(hist, NULL, 0.50));
+	printf("%s p99 = %.3f ms\n", prefix,
+		   0.001 * getLatencyPercentile(hist, NULL, 0.99));
+	printf("%s p99.9 = %.3f ms\n", prefix,
+		   0.001 * getLatencyPercentile(hist, NULL, 0.999));
+}
+
 /* print version banner */
 static void
 printVersion(PGconn *con)
@@ -6382,8 +6533,11 @@ printResults(StatsData *total,
 			   latency_limit / 1000.0, latency_late, total->cnt,
 			   (total->cnt > 0) ? 100.0 * latency_late / total->cnt : 0.0);
 
-	if (throttle_delay || progress || latency_limit)
+	if (throttle_delay || progress || latency_limit || latency_percentiles)
+	{
 		printSimpleStats("latency", &total->latency);
+		printLatencyPercentiles("latency", &total->latency_hist);
+	}
 	else
 	{
 		/* no measurement, show average latency computed from run time */
@@ -6480,6 +6634,7 @@ printResults(StatsData *total,
 						   100.0 * sstats->skipped / script_total_cnt);
 
 				printSimpleStats(" - latency", &sstats->latency);
+				printLatencyPercentiles(" - latency", &sstats->latency_hist);
 			}
 
 			/*
@@ -6619,6 +6774,7 @@ main(int argc, char **argv)
 		{"failures-detailed", no_argument, NULL, 13},
 		{"max-tries", required_argument, NULL, 14},
 		{"verbose-errors", no_argument, NULL, 15},
+		{"latency-percentiles", no_argument, NULL, 16},
 		{NULL, 0, NULL, 0}
 	};
 
@@ -6961,6 +7117,10 @@ main(int argc, char **argv)
 				benchmarking_option_set = true;
 				verbose_errors = true;
 				break;
+			case 16:			/* latency-percentiles */
+				benchmarking_option_set = true;
+				latency_percentiles = true;
+				break;
 			default:
 				/* getopt_long already emitted a complaint */
 				pg_log_error_hint("Try \"%s --help\" for more information.", progname);
@@ -7313,6 +7473,9 @@ main(int argc, char **argv)
 		/* aggregate thread level stats */
 		mergeSimpleStats(&stats.latency, &thread->stats.latency);
 		mergeSimpleStats(&stats.lag, &thread->stats.lag);
+		if (latency_percentiles)
+			mergeLatencyHistogram(&stats.latency_hist,
+								  &thread->stats.latency_hist);
 		stats.cnt += thread->stats.cnt;
 		stats.skipped += thread->stats.skipped;
 		stats.retries += thread->stats.retries;
@@ -145,6 +145,18 @@ $node->pgbench(
 	],
 	'pgbench select only');
 
+$node->pgbench(
+	'-t 10 -c 2 -n -b range-scan -b index-only-scan -b bulk-insert',
+	0,
+	[
+		qr{builtin: range scan},
+		qr{builtin: index-only scan},
+		qr{builtin: bulk insert},
+		qr{processed: 20/20}
+	],
+	[qr{^$}],
+	'pgbench cache-sensitive builtins');
+
 # check if threads are supported
 my $nthreads = 2;
 
@@ -1145,6 +1157,19 @@ $node->pgbench(
 	'pgbench late throttling',
 	{ '001_pgbench_sleep' => q{\sleep 2ms} });
 
+# latency percentiles
+$node->pgbench(
+	'-t 20 -S -c 2 -n --latency-percentiles',
+	0,
+	[
+		qr{processed: 40/40},
+		qr{latency p50 = \d+\.\d+ ms},
+		qr{latency p99 = \d+\.\d+ ms},
+		qr{latency p99\.9 = \d+\.\d+ ms}
+	],
+	[qr{^$}],
+	'pgbench latency percentiles');
+
 # return a list of files from directory $dir matching regexpr $re
 # this works around glob portability and escaping issues
 sub list_files
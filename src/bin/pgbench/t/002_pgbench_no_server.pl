@@ -257,7 +257,9 @@ pgbench(
 	[qr{^$}],
 	[
 		qr{Available builtin scripts:}, qr{tpcb-like},
-		qr{simple-update},              qr{select-only}
+		qr{simple-update},              qr{select-only},
+		qr{range-scan},                 qr{index-only-scan},
+		qr{bulk-insert}
 	],
 	'pgbench builtin list');
 
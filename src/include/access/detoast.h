@@ -12,6 +12,8 @@
 #ifndef DETOAST_H
 #define DETOAST_H
 
+#include "nodes/pg_list.h"
+
 /*
  * Macro to fetch the possibly-unaligned contents of an EXTERNAL datum
  * into a local "struct varatt_external" toast pointer.  This should be
@@ -63,6 +65,31 @@ extern struct varlena *detoast_attr_slice(struct varlena *attr,
 										  int32 sliceoffset,
 										  int32 slicelength);
 
+/* ----------
+ * ToastPrefetchState -
+ *
+ *		Toast relations kept open across detoast_prefetch_attrs() calls,
+ *		between detoast_prefetch_begin() and detoast_prefetch_end().
+ * ----------
+ */
+typedef struct ToastPrefetchState
+{
+	MemoryContext mcxt;			/* where the relations' descriptors live */
+	List	   *toastrels;		/* the open relations, see detoast.c */
+} ToastPrefetchState;
+
+/* ----------
+ * detoast_prefetch_attrs() -
+ *
+ *		Prefetches the chunks of the external attributes among the
+ *		given ones, which the caller is about to detoast.
+ * ----------
+ */
+extern void detoast_prefetch_begin(ToastPrefetchState *state);
+extern void detoast_prefetch_attrs(ToastPrefetchState *state,
+								   struct varlena **attrs, int nattrs);
+extern void detoast_prefetch_end(ToastPrefetchState *state);
+
 /* ----------
  * toast_raw_datum_size -
  *
@@ -161,6 +161,13 @@ extern void index_rescan(IndexScanDesc scan,
 extern void index_endscan(IndexScanDesc scan);
 extern void index_markpos(IndexScanDesc scan);
 extern void index_restrpos(IndexScanDesc scan);
+extern void index_prefetch(Relation indexRelation, Relation heapRelation,
+						   ScanKey keys, int nkeys, Snapshot snapshot,
+						   int nheappages);
+extern int	index_prefetch_maximum(Relation relation);
+struct PrefetchQueue;
+extern void index_heap_prefetch_rescan(IndexScanDesc scan,
+									   struct PrefetchQueue *pq);
 extern Size index_parallelscan_estimate(Relation indexrel, Snapshot snapshot);
 extern void index_parallelscan_initialize(Relation heaprel, Relation indexrel,
 										  Snapshot snapshot, ParallelIndexScanDesc target);
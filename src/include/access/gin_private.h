@@ -176,6 +176,14 @@ typedef struct GinBtreeData
 
 	/* Search key for data tree (posting tree) */
 	ItemPointerData itemptr;
+
+	/*
+	 * Neon: if set, a search of a posting tree queues the leaf it descends
+	 * to and the leaf's right siblings under the same parent for
+	 * prefetching, and sets leafPrefetchNext to the parent's right sibling.
+	 */
+	struct PrefetchQueue *leafPrefetch;
+	BlockNumber leafPrefetchNext;
 } GinBtreeData;
 
 /* This represents a tuple to be inserted to entry tree. */
@@ -230,7 +238,8 @@ extern void GinPageDeletePostingItem(Page page, OffsetNumber offset);
 extern void ginInsertItemPointers(Relation index, BlockNumber rootBlkno,
 								  ItemPointerData *items, uint32 nitem,
 								  GinStatsData *buildStats);
-extern GinBtreeStack *ginScanBeginPostingTree(GinBtree btree, Relation index, BlockNumber rootBlkno, Snapshot snapshot);
+extern GinBtreeStack *ginScanBeginPostingTree(GinBtree btree, Relation index, BlockNumber rootBlkno, Snapshot snapshot,
+											   struct PrefetchQueue *leafPrefetch);
 extern void ginDataFillRoot(GinBtree btree, Page root, BlockNumber lblkno, Page lpage, BlockNumber rblkno, Page rpage);
 
 /*
@@ -345,6 +354,13 @@ typedef struct GinScanEntryData
 	/* Current page in posting tree */
 	Buffer		buffer;
 
+	/*
+	 * Neon: posting tree leaf pages to prefetch, and the next internal page
+	 * whose children are to be queued, if any.  NULL for a posting list.
+	 */
+	struct PrefetchQueue *leafPrefetch;
+	BlockNumber leafPrefetchParent;
+
 	/* current ItemPointer to heap */
 	ItemPointerData curItem;
 
@@ -457,7 +473,8 @@ typedef struct GinTupleCollector
 } GinTupleCollector;
 
 extern void ginHeapTupleFastInsert(GinState *ginstate,
-								   GinTupleCollector *collector);
+								   GinTupleCollector *collector,
+								   Relation heapRel);
 extern void ginHeapTupleFastCollect(GinState *ginstate,
 									GinTupleCollector *collector,
 									OffsetNumber attnum, Datum value, bool isNull,
@@ -20,6 +20,7 @@
 #include "lib/pairingheap.h"
 #include "storage/bufmgr.h"
 #include "storage/buffile.h"
+#include "storage/prefetch.h"
 #include "utils/hsearch.h"
 #include "access/genam.h"
 
@@ -176,6 +177,10 @@ typedef struct GISTScanOpaqueData
 	OffsetNumber curPageData;	/* next item to return */
 	MemoryContext pageDataCxt;	/* context holding the fetched tuples, for
 								 * index-only scans */
+
+	/* Neon: prefetch state */
+	PrefetchControl index_prefetch; /* prefetching of child index pages */
+	PrefetchQueue heap_prefetch;	/* heap blocks of pageData[], to prefetch */
 } GISTScanOpaqueData;
 
 typedef GISTScanOpaqueData *GISTScanOpaque;
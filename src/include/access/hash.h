@@ -25,6 +25,7 @@
 #include "lib/stringinfo.h"
 #include "storage/bufmgr.h"
 #include "storage/lockdefs.h"
+#include "storage/prefetch.h"
 #include "utils/hsearch.h"
 #include "utils/relcache.h"
 
@@ -187,6 +188,9 @@ typedef struct HashScanOpaqueData
 	 * HashScanPosData
 	 */
 	HashScanPosData currPos;	/* current position data */
+
+	/* heap blocks of the items in currPos, in scan order, to prefetch */
+	PrefetchQueue heap_prefetch;
 } HashScanOpaqueData;
 
 typedef HashScanOpaqueData *HashScanOpaque;
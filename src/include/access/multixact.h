@@ -29,9 +29,9 @@
 
 #define MaxMultiXactOffset	((MultiXactOffset) 0xFFFFFFFF)
 
-/* Number of SLRU buffers to use for multixact */
-#define NUM_MULTIXACTOFFSET_BUFFERS		8
-#define NUM_MULTIXACTMEMBER_BUFFERS		16
+/* GUC variables: number of SLRU buffers to use for multixact */
+extern PGDLLIMPORT int multixact_offset_buffers;
+extern PGDLLIMPORT int multixact_member_buffers;
 
 /*
  * Possible multixact lock modes ("status").  The first four modes are for
@@ -18,11 +18,13 @@
 #include "access/itup.h"
 #include "access/sdir.h"
 #include "access/tableam.h"
+#include "access/visibilitymapdefs.h"
 #include "access/xlogreader.h"
 #include "catalog/pg_am_d.h"
 #include "catalog/pg_index.h"
 #include "lib/stringinfo.h"
 #include "storage/bufmgr.h"
+#include "storage/prefetch.h"
 #include "storage/shm_toc.h"
 
 /* There's room for a 16-bit vacuum cycle ID in BTPageOpaqueData */
@@ -1029,6 +1031,36 @@ typedef struct BTArrayKeyInfo
 	Datum	   *elem_values;	/* array of num_elems Datums */
 } BTArrayKeyInfo;
 
+/*
+ * A skip scan key stands in for a missing qual on the first index column;
+ * see _bt_preprocess_array_keys.  It acts like an equality-type array key
+ * whose elements are the distinct values of the column, which are found by
+ * probing the index as the scan advances.
+ */
+typedef enum BTSkipState
+{
+	BTSKIP_START,				/* before the first value */
+	BTSKIP_VALUE,				/* column = value */
+	BTSKIP_NULL,				/* column IS NULL */
+	BTSKIP_RANGE				/* column beyond value in range_dir */
+} BTSkipState;
+
+typedef struct BTSkipKeyInfo
+{
+	BTSkipState state;
+	Datum		value;			/* current value, in VALUE and RANGE states */
+	ScanDirection range_dir;	/* scan direction, in RANGE state */
+	int			dense_probes;	/* successive probes that skipped no page */
+	BTSkipState mark_state;		/* state saved by _bt_mark_array_keys */
+	Datum		mark_value;
+	ScanDirection mark_range_dir;
+	int16		attlen;			/* type of the column */
+	bool		attbyval;
+	FmgrInfo	eq_finfo;		/* = operator of the column's opfamily */
+	FmgrInfo	lt_finfo;		/* < operator */
+	FmgrInfo	gt_finfo;		/* > operator */
+} BTSkipKeyInfo;
+
 typedef struct BTScanOpaqueData
 {
 	/* these fields are set by _bt_preprocess_keys(): */
@@ -1044,6 +1076,11 @@ typedef struct BTScanOpaqueData
 								 * processed */
 	BTArrayKeyInfo *arrayKeys;	/* info about each equality-type array key */
 	MemoryContext arrayContext; /* scan-lifespan context for array data */
+	BlockNumber lastLeafPage;	/* last leaf page read, to restart the scan
+								 * for the next array keys from, or
+								 * InvalidBlockNumber */
+	BTSkipKeyInfo *skipKey;		/* skip scan key, which is arrayKeyData[0],
+								 * or NULL */
 
 	/* info about killed items if any (killedItems is NULL if never used) */
 	int		   *killedItems;	/* currPos.items indexes of killed items */
@@ -1073,22 +1110,30 @@ typedef struct BTScanOpaqueData
 	/* Neon: prefetch state */
 	int         prefetch_maximum; /* maximal number of prefetch requests */
 
-	/* Prefech of referenced heap pages for index scan */
-	/* To minimize waste prefetch requests we start with prefetch distance 0
-	 * and increase it until it reaches prefetch_maximum
-	 */
-	int         current_prefetch_distance;
+	/* Prefetch distance control, for heap pages in index scans and */
+	/* for leaf pages in index-only scans */
+	PrefetchControl prefetch_ctl;
 
 	/* Prefetch of leave pages of B-Tree for index-only scan */
 	int         n_prefetch_requests; /* number of active prefetch requests */
 	int         n_prefetch_blocks; /* number of elements in prefetch_blocks */
 	int         last_prefetch_index; /* current position in prefetch_blocks (prefetch_blocks[0..last_prefetch_index] are already requested */
 	BlockNumber next_parent; /* pointer to next parent page */
+	uint32      prefetch_pages_seen; /* parallel scan: pages scanned by all workers at last prefetch */
 	BlockNumber prefetch_blocks[MaxTIDsPerBTreePage + 1]; /* leaves + parent page */
+
+	/* Prefetch of heap pages for index-only scan, see _bt_prefetch_heap_for_ios */
+	BlockNumber heap_prefetch_page; /* leaf page heap_prefetch_item refers to */
+	int         heap_prefetch_item; /* next item of currPos to look at */
+	VMBufferCache heap_prefetch_vmbufs; /* visibility map pages of the heap */
 } BTScanOpaqueData;
 
 typedef BTScanOpaqueData *BTScanOpaque;
 
+/* Does the scan consist of several primitive scans? */
+#define BTScanHasArrayKeys(so) \
+	((so)->numArrayKeys != 0 || (so)->skipKey != NULL)
+
 /*
  * We use some private sk_flags bits in preprocessed scan keys.  We're allowed
  * to use bits 16-31 (see skey.h).  The uppermost bits are copied from the
@@ -1152,6 +1197,9 @@ extern void btparallelrescan(IndexScanDesc scan);
 extern void btendscan(IndexScanDesc scan);
 extern void btmarkpos(IndexScanDesc scan);
 extern void btrestrpos(IndexScanDesc scan);
+extern void btprefetch(Relation indexRelation, Relation heapRelation,
+					   ScanKey keys, int nkeys, Snapshot snapshot,
+					   int nheappages);
 extern IndexBulkDeleteResult *btbulkdelete(IndexVacuumInfo *info,
 										   IndexBulkDeleteResult *stats,
 										   IndexBulkDeleteCallback callback,
@@ -1166,6 +1214,7 @@ extern bool btcanreturn(Relation index, int attno);
 extern bool _bt_parallel_seize(IndexScanDesc scan, BlockNumber *pageno);
 extern void _bt_parallel_release(IndexScanDesc scan, BlockNumber scan_page);
 extern void _bt_parallel_done(IndexScanDesc scan);
+extern uint32 _bt_parallel_pages_scanned(IndexScanDesc scan);
 extern void _bt_parallel_advance_array_keys(IndexScanDesc scan);
 
 /*
@@ -1247,6 +1296,10 @@ extern OffsetNumber _bt_binsrch_insert(Relation rel, BTInsertState insertstate);
 extern int32 _bt_compare(Relation rel, BTScanInsert key, Page page, OffsetNumber offnum);
 extern bool _bt_first(IndexScanDesc scan, ScanDirection dir);
 extern bool _bt_next(IndexScanDesc scan, ScanDirection dir);
+extern bool _bt_skip_probe(IndexScanDesc scan, ScanDirection dir,
+						   Datum *value, bool *isnull, bool *samepage);
+extern void _bt_prefetch(Relation rel, Relation heapRel, ScanKey scankey,
+						 int nkeys, Snapshot snapshot, int nheappages);
 extern Buffer _bt_get_endpoint(Relation rel, uint32 level, bool rightmost,
 							   BlockNumber* parent,
 							   Snapshot snapshot);
@@ -1257,7 +1310,7 @@ extern Buffer _bt_get_endpoint(Relation rel, uint32 level, bool rightmost,
 extern BTScanInsert _bt_mkscankey(Relation rel, IndexTuple itup);
 extern void _bt_freestack(BTStack stack);
 extern void _bt_preprocess_array_keys(IndexScanDesc scan);
-extern void _bt_start_array_keys(IndexScanDesc scan, ScanDirection dir);
+extern bool _bt_start_array_keys(IndexScanDesc scan, ScanDirection dir);
 extern bool _bt_advance_array_keys(IndexScanDesc scan, ScanDirection dir);
 extern void _bt_mark_array_keys(IndexScanDesc scan);
 extern void _bt_restore_array_keys(IndexScanDesc scan);
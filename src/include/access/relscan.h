@@ -93,6 +93,10 @@ typedef struct ParallelBlockTableScanWorkerData
 	uint32		phsw_chunk_remaining;	/* # blocks left in this chunk */
 	uint32		phsw_chunk_size;	/* The number of blocks to allocate in
 									 * each I/O chunk for the scan */
+	uint64		phsw_next_nallocated;	/* First block of the chunk claimed
+										 * in advance, see
+										 * table_block_parallelscan_claimnext */
+	uint32		phsw_next_chunk_size;	/* # blocks in that chunk, 0 if none */
 } ParallelBlockTableScanWorkerData;
 typedef struct ParallelBlockTableScanWorkerData *ParallelBlockTableScanWorker;
 
@@ -122,6 +126,7 @@ typedef struct IndexScanDescData
 	struct ScanKeyData *keyData;	/* array of index qualifier descriptors */
 	struct ScanKeyData *orderByData;	/* array of ordering op descriptors */
 	bool		xs_want_itup;	/* caller requests index tuples */
+	bool		xs_skip_scan;	/* planner costed a skip scan */
 	bool		xs_temp_snap;	/* unregister snapshot at scan end? */
 
 	/* signaling to index AM about killing index tuples */
@@ -33,6 +33,17 @@
  */
 #define SLRU_PAGES_PER_SEGMENT	32
 
+/*
+ * The buffer slots of an SLRU are divided into banks of about SLRU_BANK_SIZE
+ * slots each.  A page can only be kept in the slots of bank
+ * (pageno % num_banks), so looking up a page or selecting a victim for it
+ * only has to scan one bank, however many buffers the SLRU has.
+ */
+#define SLRU_BANK_SIZE			16
+
+/* upper limit of the configurable SLRU buffer pools, 1GB */
+#define SLRU_MAX_ALLOWED_BUFFERS	((1024 * 1024 * 1024) / BLCKSZ)
+
 /*
  * Page status codes.  Note that these do not include the "dirty" bit.
  * page_dirty can be true only in the VALID or WRITE_IN_PROGRESS states;
@@ -57,6 +68,9 @@ typedef struct SlruSharedData
 	/* Number of buffers managed by this SLRU structure */
 	int			num_slots;
 
+	/* Number of banks the buffers are divided into, see SLRU_BANK_SIZE */
+	int			num_banks;
+
 	/*
 	 * Arrays holding info for each buffer slot.  Page number is undefined
 	 * when status is EMPTY, as is page_lru_count.
@@ -19,6 +19,7 @@
 #include "catalog/pg_am_d.h"
 #include "nodes/tidbitmap.h"
 #include "storage/buf.h"
+#include "storage/prefetch.h"
 #include "utils/geo_decls.h"
 #include "utils/relcache.h"
 
@@ -240,6 +241,10 @@ typedef struct SpGistScanOpaqueData
 	 * SpGistLeafTuples aren't exactly IndexTuples; however, they are larger,
 	 * so this is safe.
 	 */
+
+	/* Neon: prefetch state */
+	PrefetchControl index_prefetch; /* prefetching of child index pages */
+	PrefetchQueue heap_prefetch;	/* heap blocks of heapPtrs[], to prefetch */
 } SpGistScanOpaqueData;
 
 typedef SpGistScanOpaqueData *SpGistScanOpaque;
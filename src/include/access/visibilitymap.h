@@ -25,6 +25,28 @@
 	((visibilitymap_get_status((r), (b), (v)) & VISIBILITYMAP_ALL_VISIBLE) != 0)
 #define VM_ALL_FROZEN(r, b, v) \
 	((visibilitymap_get_status((r), (b), (v)) & VISIBILITYMAP_ALL_FROZEN) != 0)
+#define VM_ALL_VISIBLE_CACHED(r, b, c) \
+	((visibilitymap_get_status_cached((r), (b), (c)) & VISIBILITYMAP_ALL_VISIBLE) != 0)
+
+/*
+ * State for prefetching the heap blocks that a sequential scan, which skips
+ * blocks according to their visibility map bits, is about to read.  Blocks
+ * are requested in batches, topping the window up once half of it has been
+ * read, so that remote storage sees a few large requests rather than a
+ * stream of single-block reads.
+ */
+typedef struct VMPrefetchState
+{
+	int			maximum;		/* window size in blocks; 0 disables */
+	int			pending;		/* prefetched blocks not read yet */
+	BlockNumber next;			/* next block to consider for prefetching */
+	uint8		vmflags;		/* VM bits that decide whether a block is
+								 * read; all blocks are read if 0 */
+	bool		skip_if_set;	/* read blocks with none of vmflags set,
+								 * rather than those with one of them set */
+	Buffer		vmbuffer;		/* VM buffer for looking ahead */
+	BlockNumber *blocks;		/* workspace for PrefetchBuffers() */
+} VMPrefetchState;
 
 extern bool visibilitymap_clear(Relation rel, BlockNumber heapBlk,
 								Buffer vmbuf, uint8 flags);
@@ -35,6 +57,17 @@ extern void visibilitymap_set(Relation rel, BlockNumber heapBlk, Buffer heapBuf,
 							  XLogRecPtr recptr, Buffer vmBuf, TransactionId cutoff_xid,
 							  uint8 flags);
 extern uint8 visibilitymap_get_status(Relation rel, BlockNumber heapBlk, Buffer *vmbuf);
+extern void visibilitymap_cache_init(VMBufferCache *cache);
+extern uint8 visibilitymap_get_status_cached(Relation rel, BlockNumber heapBlk,
+											 VMBufferCache *cache);
+extern void visibilitymap_cache_release(VMBufferCache *cache);
+extern void visibilitymap_prefetch_init(VMPrefetchState *ps, Relation rel,
+										uint8 vmflags, bool skip_if_set);
+extern void visibilitymap_prefetch_before_read(VMPrefetchState *ps,
+											   Relation rel,
+											   BlockNumber blkno,
+											   BlockNumber nblocks);
+extern void visibilitymap_prefetch_end(VMPrefetchState *ps);
 extern void visibilitymap_count(Relation rel, BlockNumber *all_visible, BlockNumber *all_frozen);
 extern BlockNumber visibilitymap_prepare_truncate(Relation rel,
 												  BlockNumber nheapblocks);
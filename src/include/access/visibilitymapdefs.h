@@ -13,6 +13,8 @@
 #ifndef VISIBILITYMAPDEFS_H
 #define VISIBILITYMAPDEFS_H
 
+#include "storage/buf.h"
+
 /* Number of bits for one heap page */
 #define BITS_PER_HEAPBLOCK 2
 
@@ -22,4 +24,19 @@
 #define VISIBILITYMAP_VALID_BITS	0x03	/* OR of all valid visibilitymap
 											 * flags bits */
 
+/*
+ * A few pinned visibility map pages, for callers that test the bits of heap
+ * blocks in random order, like index-only scans.  Each map page has a fixed
+ * slot, so looking it up is as cheap as with a single pinned buffer, but
+ * alternating between heap blocks covered by different map pages doesn't
+ * cost an unpin and a buffer lookup each time.  Kept small, as every slot
+ * may hold a pin for the whole scan.
+ */
+#define VM_BUFFER_CACHE_SIZE	4
+
+typedef struct VMBufferCache
+{
+	Buffer		buffers[VM_BUFFER_CACHE_SIZE];
+} VMBufferCache;
+
 #endif							/* VISIBILITYMAPDEFS_H */
@@ -46,6 +46,14 @@ extern PGDLLIMPORT int max_wal_size_mb;
 extern PGDLLIMPORT int wal_keep_size_mb;
 extern PGDLLIMPORT int max_slot_wal_keep_size_mb;
 extern PGDLLIMPORT int XLOGbuffers;
+extern PGDLLIMPORT int wal_insert_locks;
+
+/*
+ * Upper limit of wal_insert_locks.  Some operations hold all the insertion
+ * locks at once, inside a critical section, so there must be ample room
+ * below MAX_SIMUL_LWLOCKS (200) for them and any other locks held.
+ */
+#define MAX_WAL_INSERT_LOCKS	128
 extern PGDLLIMPORT int XLogArchiveTimeout;
 extern PGDLLIMPORT int wal_retrieve_retry_interval;
 extern PGDLLIMPORT char *XLogArchiveCommand;
@@ -53,8 +61,10 @@ extern PGDLLIMPORT bool EnableHotStandby;
 extern PGDLLIMPORT bool fullPageWrites;
 extern PGDLLIMPORT bool wal_log_hints;
 extern PGDLLIMPORT int wal_compression;
+extern PGDLLIMPORT int wal_compression_zstd_level;
 extern PGDLLIMPORT bool wal_init_zero;
 extern PGDLLIMPORT bool wal_recycle;
+extern PGDLLIMPORT int wal_preallocate_segments;
 extern PGDLLIMPORT bool *wal_consistency_checking;
 extern PGDLLIMPORT char *wal_consistency_checking_string;
 extern PGDLLIMPORT bool log_checkpoints;
@@ -210,6 +220,7 @@ extern XLogRecPtr XLogInsertRecord(struct XLogRecData *rdata,
 								   bool topxid_included);
 extern void XLogFlush(XLogRecPtr RecPtr);
 extern bool XLogBackgroundFlush(void);
+extern bool XLogPreallocateSegments(void);
 extern bool XLogNeedsFlush(XLogRecPtr RecPtr);
 extern int	XLogFileInit(XLogSegNo segno, TimeLineID tli);
 extern int	XLogFileOpen(XLogSegNo segno, TimeLineID tli);
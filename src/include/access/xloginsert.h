@@ -67,4 +67,7 @@ extern XLogRecPtr XLogSaveBufferForHint(Buffer buffer, bool buffer_std);
 
 extern void InitXLogInsert(void);
 
+extern PGDLLIMPORT bool WalBackpressurePending;
+extern void ProcessWalBackpressure(void);
+
 #endif							/* XLOGINSERT_H */
@@ -237,18 +237,46 @@ typedef struct VacuumParams
 
 /*
  * VacDeadItems stores TIDs whose index tuples are deleted by index vacuuming.
+ *
+ * The TIDs are stored per heap block, as either a bitmap of the block's dead
+ * offset numbers or a sorted array of them, whichever is smaller.  A bitmap
+ * takes much less space than an array of TIDs unless the block has only a
+ * few of them, and an array is used for those blocks.  data[] is made of
+ * 8-byte slots.  The VacDeadBlock entries, in ascending block number order,
+ * take slots from the start of data[], and the offsets take slots from its
+ * end: the offsets of the block in entry i start at its first_slot, and end
+ * where the offsets of entry i - 1 start (or at max_slots, for entry 0).  An
+ * array that doesn't fill its last slot is padded with InvalidOffsetNumber.
+ *
+ * Use the vac_dead_items_* functions to access it.
  */
+typedef struct VacDeadBlock
+{
+	BlockNumber blkno;			/* heap block number */
+	uint32		first_slot:31,	/* start of offsets in data[] */
+				is_array:1;		/* offsets are an array, not a bitmap? */
+} VacDeadBlock;
+
 typedef struct VacDeadItems
 {
-	int			max_items;		/* # slots allocated in array */
-	int			num_items;		/* current # of entries */
+	int			max_slots;		/* # slots allocated in data[] */
+	int			num_blocks;		/* current # of heap blocks */
+	int64		num_items;		/* current # of TIDs */
 
-	/* Sorted array of TIDs to delete from indexes */
-	ItemPointerData items[FLEXIBLE_ARRAY_MEMBER];
+	/* VacDeadBlock entries and offset bitmaps, see above */
+	uint64		data[FLEXIBLE_ARRAY_MEMBER];
 } VacDeadItems;
 
-#define MAXDEADITEMS(avail_mem) \
-	(((avail_mem) - offsetof(VacDeadItems, items)) / sizeof(ItemPointerData))
+#define MAXDEADSLOTS(avail_mem) \
+	(((avail_mem) - offsetof(VacDeadItems, data)) / sizeof(uint64))
+
+/*
+ * Most slots one heap block's TIDs can take, a VacDeadBlock and a bitmap
+ * covering MaxHeapTuplesPerPage offsets (needs access/htup_details.h).  An
+ * array is only used when it's smaller than the bitmap.
+ */
+#define VAC_DEAD_BLOCK_MAX_SLOTS \
+	(1 + (MaxHeapTuplesPerPage - 1) / 64 + 1)
 
 /* GUC parameters */
 extern PGDLLIMPORT int default_statistics_target;	/* PGDLLIMPORT for PostGIS */
@@ -308,12 +336,23 @@ extern IndexBulkDeleteResult *vac_bulkdel_one_index(IndexVacuumInfo *ivinfo,
 													VacDeadItems *dead_items);
 extern IndexBulkDeleteResult *vac_cleanup_one_index(IndexVacuumInfo *ivinfo,
 													IndexBulkDeleteResult *istat);
-extern Size vac_max_items_to_alloc_size(int max_items);
+extern Size vac_max_slots_to_alloc_size(int max_slots);
+extern void vac_dead_items_init(VacDeadItems *dead_items, int max_slots);
+extern void vac_dead_items_reset(VacDeadItems *dead_items);
+extern bool vac_dead_items_full(VacDeadItems *dead_items);
+extern int64 vac_dead_items_max_items(VacDeadItems *dead_items);
+extern Size vac_dead_items_used_size(VacDeadItems *dead_items);
+extern void vac_dead_items_add(VacDeadItems *dead_items, BlockNumber blkno,
+							   OffsetNumber *offsets, int num_offsets);
+extern BlockNumber vac_dead_items_get_block(VacDeadItems *dead_items,
+											int blockidx);
+extern int	vac_dead_items_get_offsets(VacDeadItems *dead_items, int blockidx,
+									   OffsetNumber *offsets);
 
 /* in commands/vacuumparallel.c */
 extern ParallelVacuumState *parallel_vacuum_init(Relation rel, Relation *indrels,
 												 int nindexes, int nrequested_workers,
-												 int max_items, int elevel,
+												 int max_slots, int elevel,
 												 BufferAccessStrategy bstrategy);
 extern void parallel_vacuum_end(ParallelVacuumState *pvs, IndexBulkDeleteResult **istats);
 extern VacDeadItems *parallel_vacuum_get_dead_items(ParallelVacuumState *pvs);
@@ -240,6 +240,13 @@ typedef enum ExprEvalOp
 	EEOP_WINDOW_FUNC,
 	EEOP_SUBPLAN,
 
+	/*
+	 * Return the cached result of an expression, jumping over its steps, or
+	 * cache it after evaluating them.
+	 */
+	EEOP_CACHEDEXPR_CHECK,
+	EEOP_CACHEDEXPR_STORE,
+
 	/* aggregation related nodes */
 	EEOP_AGG_STRICT_DESERIALIZE,
 	EEOP_AGG_DESERIALIZE,
@@ -619,6 +626,14 @@ typedef struct ExprEvalStep
 			SubPlanState *sstate;
 		}			subplan;
 
+		/* for EEOP_CACHEDEXPR_CHECK / STORE */
+		struct
+		{
+			/* out-of-line state, shared by the two steps */
+			struct CachedExprResult *cache;
+			int			jumpdone;	/* CHECK: jump here if cached */
+		}			cachedexpr;
+
 		/* for EEOP_AGG_*DESERIALIZE */
 		struct
 		{
@@ -667,6 +682,19 @@ typedef struct ExprEvalStep
 } ExprEvalStep;
 
 
+/*
+ * Cached result of an expression whose inputs can't change during the
+ * execution of the query, see ExecInitCachedExpr().
+ */
+typedef struct CachedExprResult
+{
+	bool		valid;			/* has the result been computed yet? */
+	bool		isnull;
+	Datum		value;			/* allocated in the per-query context */
+	int16		typlen;			/* type of the result */
+	bool		typbyval;
+} CachedExprResult;
+
 /* Non-inline data for container operations */
 typedef struct SubscriptingRefState
 {
@@ -713,6 +741,7 @@ extern void ExprEvalPushStep(ExprState *es, const ExprEvalStep *s);
 
 /* functions in execExprInterp.c */
 extern void ExecReadyInterpretedExpr(ExprState *state);
+extern void ExecReadyDeferredJitExpr(ExprState *state);
 extern ExprEvalOp ExecEvalStepOp(ExprState *state, ExprEvalStep *op);
 
 extern Datum ExecInterpExprStillValid(ExprState *state, ExprContext *econtext, bool *isNull);
@@ -760,6 +789,10 @@ extern void ExecEvalXmlExpr(ExprState *state, ExprEvalStep *op);
 extern void ExecEvalGroupingFunc(ExprState *state, ExprEvalStep *op);
 extern void ExecEvalSubPlan(ExprState *state, ExprEvalStep *op,
 							ExprContext *econtext);
+extern bool ExecEvalCachedExprCheck(ExprState *state, ExprEvalStep *op,
+									ExprContext *econtext);
+extern void ExecEvalCachedExprStore(ExprState *state, ExprEvalStep *op,
+									ExprContext *econtext);
 extern void ExecEvalWholeRowVar(ExprState *state, ExprEvalStep *op,
 								ExprContext *econtext);
 extern void ExecEvalSysVar(ExprState *state, ExprEvalStep *op,
@@ -89,6 +89,7 @@ extern PGDLLIMPORT bool jit_tuple_deforming;
 extern PGDLLIMPORT double jit_above_cost;
 extern PGDLLIMPORT double jit_inline_above_cost;
 extern PGDLLIMPORT double jit_optimize_above_cost;
+extern PGDLLIMPORT int jit_defer_evaluations;
 
 
 extern void jit_reset_after_error(void);
@@ -99,6 +100,7 @@ extern void jit_release_context(JitContext *context);
  * not be able to perform JIT (i.e. return false).
  */
 extern bool jit_compile_expr(struct ExprState *state);
+extern bool jit_defer_compile_expr(struct ExprState *state);
 extern void InstrJitAgg(JitInstrumentation *dst, JitInstrumentation *add);
 
 
@@ -19,6 +19,8 @@
 #ifndef PG_WCHAR_H
 #define PG_WCHAR_H
 
+#include "port/simd.h"
+
 /*
  * The pg_wchar type
  */
@@ -712,9 +714,34 @@ is_valid_ascii(const unsigned char *s, int len)
 	uint64		chunk,
 				highbit_cum = UINT64CONST(0),
 				zero_cum = UINT64CONST(0x8080808080808080);
+#ifndef USE_NO_SIMD
+	const Vector8 zero = vector8_broadcast(0);
+	Vector8		vchunk,
+				vhighbit_cum = zero,
+				vzero_cum = zero;
+#endif
 
 	Assert(len % sizeof(chunk) == 0);
 
+#ifndef USE_NO_SIMD
+	/* Check as much as possible a whole vector at a time */
+	while (len >= (int) sizeof(Vector8))
+	{
+		vector8_load(&vchunk, s);
+
+		/* Zero bytes turn into lanes with all bits set, high bit included */
+		vzero_cum = vector8_or(vzero_cum, vector8_eq(vchunk, zero));
+		vhighbit_cum = vector8_or(vhighbit_cum, vchunk);
+
+		s += sizeof(Vector8);
+		len -= sizeof(Vector8);
+	}
+
+	if (vector8_is_highbit_set(vector8_or(vhighbit_cum, vzero_cum)))
+		return false;
+#endif
+
+	/* Check any remainder 8 bytes at a time */
 	while (len > 0)
 	{
 		memcpy(&chunk, s, sizeof(chunk));
@@ -752,4 +779,22 @@ is_valid_ascii(const unsigned char *s, int len)
 	return true;
 }
 
+/*
+ * Return the length of the longest prefix of s, no longer than len, that is
+ * made up of whole 16-byte chunks of valid ASCII (see is_valid_ascii()).
+ *
+ * Encoding conversions use this to copy runs of ASCII characters, which
+ * convert to themselves, a chunk at a time.
+ */
+static inline int
+valid_ascii_prefix_len(const unsigned char *s, int len)
+{
+	int			n = 0;
+
+	while (len - n >= 16 && is_valid_ascii(s + n, 16))
+		n += 16;
+
+	return n;
+}
+
 #endif							/* PG_WCHAR_H */
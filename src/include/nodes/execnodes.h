@@ -15,6 +15,7 @@
 #define EXECNODES_H
 
 #include "access/tupconvert.h"
+#include "access/visibilitymapdefs.h"
 #include "executor/instrument.h"
 #include "fmgr.h"
 #include "lib/ilist.h"
@@ -25,6 +26,7 @@
 #include "partitioning/partdefs.h"
 #include "storage/bufmgr.h"
 #include "storage/condition_variable.h"
+#include "storage/prefetch.h"
 #include "utils/hsearch.h"
 #include "utils/queryenvironment.h"
 #include "utils/reltrigger.h"
@@ -115,6 +117,19 @@ typedef struct ExprState
 
 	Datum	   *innermost_domainval;
 	bool	   *innermost_domainnull;
+
+	/* outermost cacheable calls within cacheable_root, see execExpr.c */
+	Expr	   *cacheable_root;
+	List	   *cacheable_exprs;
+
+	/*
+	 * For JIT compilation deferred until the expression has been evaluated
+	 * jit_defer_evaluations times: the number of evaluations left, and the
+	 * resource owner that would have owned the code if it had been compiled
+	 * up front.
+	 */
+	int			jit_countdown;
+	struct ResourceOwnerData *jit_resowner;
 } ExprState;
 
 
@@ -487,6 +502,7 @@ typedef struct ResultRelInfo
 	int			ri_NumSlots;	/* number of slots in the array */
 	int			ri_NumSlotsInitialized; /* number of initialized slots */
 	int			ri_BatchSize;	/* max slots inserted in a single batch */
+	Size		ri_BatchBytes;	/* bytes of tuples buffered for a table */
 	TupleTableSlot **ri_Slots;	/* input tuples for batch insert */
 	TupleTableSlot **ri_PlanSlots;
 
@@ -1591,7 +1607,7 @@ typedef struct IndexScanState
  *		RelationDesc	   index relation descriptor
  *		ScanDesc		   index scan descriptor
  *		TableSlot		   slot for holding tuples fetched from the table
- *		VMBuffer		   buffer in use for visibility map testing, if any
+ *		VMBuffers		   buffers in use for visibility map testing, if any
  *		PscanLen		   size of parallel index-only scan descriptor
  * ----------------
  */
@@ -1610,7 +1626,7 @@ typedef struct IndexOnlyScanState
 	Relation	ioss_RelationDesc;
 	struct IndexScanDescData *ioss_ScanDesc;
 	TupleTableSlot *ioss_TableSlot;
-	Buffer		ioss_VMBuffer;
+	VMBufferCache ioss_VMBuffers;
 	Size		ioss_PscanLen;
 } IndexOnlyScanState;
 
@@ -1715,8 +1731,9 @@ typedef struct TBMIteratePrefetchResult
  *		lossy_pages		   total number of lossy pages retrieved
  *		prefetch_iterator  iterator for prefetching ahead of current page
  *		prefetch_pages	   # pages prefetch iterator is ahead of current
- *		prefetch_target    current target prefetch distance
- *		prefetch_maximum   maximum value for prefetch_target
+ *		prefetch_ctl	   prefetch distance control
+ *		prefetch_maximum   maximum prefetch distance
+ *		prefetch_exhausted has a parallel scan claimed all pages to prefetch?
  *		pscan_len		   size of the shared memory for parallel bitmap
  *		initialized		   is node is ready to iterate
  *		shared_tbmiterator	   shared iterator
@@ -1738,8 +1755,9 @@ typedef struct BitmapHeapScanState
 	long		lossy_pages;
 	TBMIterator *prefetch_iterator;
 	int			prefetch_pages;
-	int			prefetch_target;
+	PrefetchControl prefetch_ctl;
 	int			prefetch_maximum;
+	bool		prefetch_exhausted;
 	Size		pscan_len;
 	bool		initialized;
 	TBMSharedIterator *shared_tbmiterator;
@@ -2015,6 +2033,15 @@ typedef struct JoinState
  *		NeedNewOuter	   true if need new outer tuple on next call
  *		MatchedOuter	   true if found a join match for current outer tuple
  *		NullInnerTupleSlot prepared null tuple for left outer joins
+ *		Lookahead		   true if we queue outer tuples to prefetch for the
+ *						   inner index scan, see nodeNestloop.c
+ *		OuterDone		   true if the outer plan has been exhausted
+ *		QueueSize		   allocated length of OuterQueue
+ *		QueueHead		   index of the next outer tuple in OuterQueue
+ *		QueueLen		   number of queued outer tuples
+ *		OuterQueue		   ring buffer of upcoming outer tuples
+ *		OuterSlot		   holds the current outer tuple
+ *		Prefetch		   controls the lookahead distance
  * ----------------
  */
 typedef struct NestLoopState
@@ -2023,6 +2050,14 @@ typedef struct NestLoopState
 	bool		nl_NeedNewOuter;
 	bool		nl_MatchedOuter;
 	TupleTableSlot *nl_NullInnerTupleSlot;
+	bool		nl_Lookahead;
+	bool		nl_OuterDone;
+	int			nl_QueueSize;
+	int			nl_QueueHead;
+	int			nl_QueueLen;
+	TupleTableSlot **nl_OuterQueue;
+	TupleTableSlot *nl_OuterSlot;
+	PrefetchControl nl_Prefetch;
 } NestLoopState;
 
 /* ----------------
@@ -533,7 +533,13 @@ typedef enum NodeTag
 	T_SupportRequestCost,		/* in nodes/supportnodes.h */
 	T_SupportRequestRows,		/* in nodes/supportnodes.h */
 	T_SupportRequestIndexCondition, /* in nodes/supportnodes.h */
-	T_SupportRequestWFuncMonotonic	/* in nodes/supportnodes.h */
+	T_SupportRequestWFuncMonotonic, /* in nodes/supportnodes.h */
+
+	/*
+	 * Tags added since the major release go last, so that the values of the
+	 * others, which extensions were compiled with, don't change.
+	 */
+	T_BumpContext				/* in nodes/memnodes.h */
 } NodeTag;
 
 /*
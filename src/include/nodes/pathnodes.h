@@ -1239,6 +1239,9 @@ typedef struct Path
  * we need not recompute them when considering using the same index in a
  * bitmap index/heap scan (see BitmapHeapPath).  The costs of the IndexPath
  * itself represent the costs of an IndexScan or IndexOnlyScan plan type.
+ *
+ * 'indexskipscan' is set by the index AM's cost estimator if it costed the
+ * scan as skipping over the values of a leading index column without quals.
  *----------
  */
 typedef struct IndexPath
@@ -1251,6 +1254,7 @@ typedef struct IndexPath
 	ScanDirection indexscandir;
 	Cost		indextotalcost;
 	Selectivity indexselectivity;
+	bool		indexskipscan;
 } IndexPath;
 
 /*
@@ -240,6 +240,8 @@ typedef struct ModifyTable
 	List	   *exclRelTlist;	/* tlist of the EXCLUDED pseudo relation */
 	List	   *mergeActionLists;	/* per-target-table lists of actions for
 									 * MERGE */
+	bool		batchInsertOk;	/* INSERT source is free of volatile
+								 * functions, so rows may be buffered */
 } ModifyTable;
 
 struct PartitionPruneInfo;		/* forward reference to struct below */
@@ -402,6 +404,10 @@ typedef struct SampleScan
  *
  * indexorderdir specifies the scan ordering, for indexscans on amcanorder
  * indexes (for other indexes it should be "don't care").
+ *
+ * indexskipscan tells the index AM that the planner costed the scan as a
+ * skip scan (see IndexPath), so that it may skip over the values of a
+ * leading index column without quals.
  * ----------------
  */
 typedef struct IndexScan
@@ -414,6 +420,7 @@ typedef struct IndexScan
 	List	   *indexorderbyorig;	/* the same in original form */
 	List	   *indexorderbyops;	/* OIDs of sort ops for ORDER BY exprs */
 	ScanDirection indexorderdir;	/* forward or backward or don't care */
+	bool		indexskipscan;	/* skip over the leading index column? */
 } IndexScan;
 
 /* ----------------
@@ -456,6 +463,7 @@ typedef struct IndexOnlyScan
 	List	   *indexorderby;	/* list of index ORDER BY exprs */
 	List	   *indextlist;		/* TargetEntry list describing index's cols */
 	ScanDirection indexorderdir;	/* forward or backward or don't care */
+	bool		indexskipscan;	/* skip over the leading index column? */
 } IndexOnlyScan;
 
 /* ----------------
@@ -482,6 +490,7 @@ typedef struct BitmapIndexScan
 	bool		isshared;		/* Create shared bitmap if set */
 	List	   *indexqual;		/* list of index quals (OpExprs) */
 	List	   *indexqualorig;	/* the same in original form */
+	bool		indexskipscan;	/* skip over the leading index column? */
 } BitmapIndexScan;
 
 /* ----------------
@@ -72,6 +72,7 @@ extern PGDLLIMPORT bool enable_async_append;
 extern PGDLLIMPORT bool enable_seqscan_prefetch;
 extern PGDLLIMPORT bool enable_indexscan_prefetch;
 extern PGDLLIMPORT bool enable_indexonlyscan_prefetch;
+extern PGDLLIMPORT bool enable_nestloop_prefetch;
 
 extern PGDLLIMPORT int constraint_exclusion;
 
@@ -122,6 +122,7 @@ extern Expr *expression_planner_with_deps(Expr *expr,
 
 extern bool plan_cluster_use_sort(Oid tableOid, Oid indexOid);
 extern int	plan_create_index_workers(Oid tableOid, Oid indexOid);
+extern int	plan_validate_constraint_workers(Oid tableOid, Node *qual);
 
 /* in plan/setrefs.c: */
 
@@ -50,10 +50,12 @@ typedef enum PgStat_Kind
 	PGSTAT_KIND_CHECKPOINTER,
 	PGSTAT_KIND_SLRU,
 	PGSTAT_KIND_WAL,
+	PGSTAT_KIND_LWLSN_CACHE,
+	PGSTAT_KIND_SMGR,
 } PgStat_Kind;
 
 #define PGSTAT_KIND_FIRST_VALID PGSTAT_KIND_DATABASE
-#define PGSTAT_KIND_LAST PGSTAT_KIND_WAL
+#define PGSTAT_KIND_LAST PGSTAT_KIND_SMGR
 #define PGSTAT_NUM_KINDS (PGSTAT_KIND_LAST + 1)
 
 /* Values for track_functions GUC variable --- order is significant! */
@@ -242,7 +244,7 @@ typedef struct PgStat_TableXactStatus
  * ------------------------------------------------------------
  */
 
-#define PGSTAT_FILE_FORMAT_ID	0x01A5BCA7
+#define PGSTAT_FILE_FORMAT_ID	0x01A5BCAA
 
 typedef struct PgStat_ArchiverStats
 {
@@ -392,6 +394,7 @@ typedef struct PgStat_WalStats
 	PgStat_Counter wal_fpi;
 	uint64		wal_bytes;
 	PgStat_Counter wal_buffers_full;
+	PgStat_Counter wal_segment_init;
 	PgStat_Counter wal_write;
 	PgStat_Counter wal_sync;
 	PgStat_Counter wal_write_time;
@@ -399,6 +402,49 @@ typedef struct PgStat_WalStats
 	TimestampTz stat_reset_timestamp;
 } PgStat_WalStats;
 
+typedef struct PgStat_LastWrittenLsnCacheStats
+{
+	PgStat_Counter page_hits;	/* lookups answered by a page entry */
+	PgStat_Counter range_hits;	/* lookups answered by a range entry */
+	PgStat_Counter misses;		/* lookups falling back to the maximum */
+	PgStat_Counter page_evictions;
+	PgStat_Counter range_evictions;
+	PgStat_Counter lock_waits;	/* updates that had to wait for the lock */
+	PgStat_Counter lock_wait_time;	/* time spent waiting, in microseconds */
+	TimestampTz stat_reset_timestamp;
+} PgStat_LastWrittenLsnCacheStats;
+
+/* storage manager operations whose latency is tracked */
+typedef enum PgStat_SmgrOp
+{
+	PGSTAT_SMGR_READ,
+	PGSTAT_SMGR_PREFETCH,
+	PGSTAT_SMGR_NBLOCKS,
+	PGSTAT_SMGR_EXISTS,
+} PgStat_SmgrOp;
+
+#define PGSTAT_SMGR_NUM_OPS (PGSTAT_SMGR_EXISTS + 1)
+
+/*
+ * Latency histogram buckets: bucket 0 counts calls that took less than a
+ * microsecond, bucket i calls that took 2^(i-1) to 2^i microseconds, and the
+ * last bucket all longer calls.
+ */
+#define PGSTAT_SMGR_HIST_BUCKETS	24
+
+typedef struct PgStat_SmgrOpStats
+{
+	PgStat_Counter calls;
+	PgStat_Counter total_time;	/* time spent, in microseconds */
+	PgStat_Counter histogram[PGSTAT_SMGR_HIST_BUCKETS];
+} PgStat_SmgrOpStats;
+
+typedef struct PgStat_SmgrStats
+{
+	PgStat_SmgrOpStats ops[PGSTAT_SMGR_NUM_OPS];
+	TimestampTz stat_reset_timestamp;
+} PgStat_SmgrStats;
+
 
 /*
  * Functions in pgstat.c
@@ -642,6 +688,27 @@ extern void pgstat_report_wal(bool force);
 extern PgStat_WalStats *pgstat_fetch_stat_wal(void);
 
 
+/*
+ * Functions in pgstat_lastwrittenlsn.c
+ */
+
+extern void pgstat_count_lwlsn_page_hit(void);
+extern void pgstat_count_lwlsn_range_hit(void);
+extern void pgstat_count_lwlsn_miss(void);
+extern void pgstat_count_lwlsn_eviction(bool range);
+extern void pgstat_count_lwlsn_lock_wait(PgStat_Counter wait_time);
+extern PgStat_LastWrittenLsnCacheStats *pgstat_fetch_stat_lwlsn_cache(void);
+
+
+/*
+ * Functions in pgstat_smgr.c
+ */
+
+extern void pgstat_count_smgr_op(PgStat_SmgrOp op, instr_time io_time);
+extern const char *pgstat_get_smgr_op_name(PgStat_SmgrOp op);
+extern PgStat_SmgrStats *pgstat_fetch_stat_smgr(void);
+
+
 /*
  * Variables in pgstat.c
  */
@@ -0,0 +1,147 @@
+/*-------------------------------------------------------------------------
+ *
+ * simd.h
+ *	  Support for platform-specific vector operations.
+ *
+ * Portions Copyright (c) 1996-2022, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/port/simd.h
+ *
+ * NOTES
+ * - VectorN in this file refers to a register where the element operands
+ * are N bits wide. The vector width is platform-specific, so users that care
+ * about that will need to inspect "sizeof(VectorN)".
+ *
+ * - Only the instruction sets that every compiler targeting the platform
+ * enables by default are used, so no runtime check is needed: SSE2 on
+ * x86-64, and Advanced SIMD (Neon) on 64-bit ARM.  On other platforms
+ * USE_NO_SIMD is defined, and callers are expected to use a scalar code
+ * path instead.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SIMD_H
+#define SIMD_H
+
+#if (defined(__x86_64__) || defined(_M_AMD64))
+/*
+ * SSE2 instructions are part of the spec for the 64-bit x86 ISA. We assume
+ * that compilers targeting this architecture understand SSE2 intrinsics.
+ */
+#include <emmintrin.h>
+#define USE_SSE2
+typedef __m128i Vector8;
+
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+/*
+ * We use the Neon instructions if the compiler provides access to them (as
+ * indicated by __ARM_NEON) and we are on aarch64.  While Neon support is
+ * technically optional for aarch64, it appears that all available 64-bit
+ * hardware does have it.
+ */
+#include <arm_neon.h>
+#define USE_NEON
+typedef uint8x16_t Vector8;
+
+#else
+#define USE_NO_SIMD
+#endif
+
+#ifndef USE_NO_SIMD
+
+/*
+ * Load a chunk of memory into the given vector.  The memory doesn't need to
+ * be aligned.
+ */
+static inline void
+vector8_load(Vector8 *v, const uint8 *s)
+{
+#if defined(USE_SSE2)
+	*v = _mm_loadu_si128((const __m128i *) s);
+#elif defined(USE_NEON)
+	*v = vld1q_u8(s);
+#endif
+}
+
+/*
+ * Create a vector with all elements set to the same value.
+ */
+static inline Vector8
+vector8_broadcast(const uint8 c)
+{
+#if defined(USE_SSE2)
+	return _mm_set1_epi8(c);
+#elif defined(USE_NEON)
+	return vdupq_n_u8(c);
+#endif
+}
+
+/*
+ * Return the bitwise OR of the inputs.
+ */
+static inline Vector8
+vector8_or(const Vector8 v1, const Vector8 v2)
+{
+#if defined(USE_SSE2)
+	return _mm_or_si128(v1, v2);
+#elif defined(USE_NEON)
+	return vorrq_u8(v1, v2);
+#endif
+}
+
+/*
+ * Return a vector with all bits set in each lane where the corresponding
+ * lanes in the inputs are equal.
+ */
+static inline Vector8
+vector8_eq(const Vector8 v1, const Vector8 v2)
+{
+#if defined(USE_SSE2)
+	return _mm_cmpeq_epi8(v1, v2);
+#elif defined(USE_NEON)
+	return vceqq_u8(v1, v2);
+#endif
+}
+
+/*
+ * Return a vector with all bits set in each lane where the element of v1 is
+ * less than or equal to the corresponding element of v2, treating elements
+ * as unsigned.
+ */
+static inline Vector8
+vector8_le(const Vector8 v1, const Vector8 v2)
+{
+#if defined(USE_SSE2)
+	/* SSE2 has no unsigned comparison, but min(v1, v2) == v1 iff v1 <= v2 */
+	return _mm_cmpeq_epi8(_mm_min_epu8(v1, v2), v1);
+#elif defined(USE_NEON)
+	return vcleq_u8(v1, v2);
+#endif
+}
+
+/*
+ * Return true if the high bit of any element is set.
+ */
+static inline bool
+vector8_is_highbit_set(const Vector8 v)
+{
+#if defined(USE_SSE2)
+	return _mm_movemask_epi8(v) != 0;
+#elif defined(USE_NEON)
+	return vmaxvq_u8(v) > 0x7F;
+#endif
+}
+
+/*
+ * Return true if any element of the vector equals the given value.
+ */
+static inline bool
+vector8_has(const Vector8 v, const uint8 c)
+{
+	return vector8_is_highbit_set(vector8_eq(v, vector8_broadcast(c)));
+}
+
+#endif							/* ! USE_NO_SIMD */
+
+#endif							/* SIMD_H */
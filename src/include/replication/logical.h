@@ -109,6 +109,14 @@ typedef struct LogicalDecodingContext
 	TransactionId write_xid;
 	/* Are we processing the end LSN of a transaction? */
 	bool		end_xact;
+
+	/*
+	 * Decisions of filter_by_relation_cb by relfilenode, and the snapshot and
+	 * count of relcache invalidations they are valid for, see decode.c.
+	 */
+	struct HTAB *relation_filter_cache;
+	Snapshot	relation_filter_snapshot;
+	uint64		relation_filter_inval_count;
 } LogicalDecodingContext;
 
 
@@ -141,6 +149,9 @@ extern void LogicalConfirmReceivedLocation(XLogRecPtr lsn);
 extern bool filter_prepare_cb_wrapper(LogicalDecodingContext *ctx,
 									  TransactionId xid, const char *gid);
 extern bool filter_by_origin_cb_wrapper(LogicalDecodingContext *ctx, RepOriginId origin_id);
+extern bool filter_by_relation_cb_wrapper(LogicalDecodingContext *ctx,
+										  Relation relation,
+										  ReorderBufferChangeType action);
 extern void ResetLogicalStreamingState(void);
 extern void UpdateDecodingStats(LogicalDecodingContext *ctx);
 
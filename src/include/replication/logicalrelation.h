@@ -13,6 +13,7 @@
 #define LOGICALRELATION_H
 
 #include "access/attmap.h"
+#include "fmgr.h"
 #include "replication/logicalproto.h"
 
 typedef struct LogicalRepRelMapEntry
@@ -32,6 +33,16 @@ typedef struct LogicalRepRelMapEntry
 	AttrMap    *attrmap;		/* map of local attributes to remote ones */
 	bool		updatable;		/* Can apply updates/deletes? */
 
+	/*
+	 * Input and receive functions of the local attributes, looked up at
+	 * first use by the apply worker, and the memory context they live in.
+	 * Released along with attrmap.
+	 */
+	MemoryContext attfuncscxt;
+	FmgrInfo   *attinfuncs;
+	FmgrInfo   *attrecvfuncs;
+	Oid		   *atttypioparams;
+
 	/* Sync state. */
 	char		state;
 	XLogRecPtr	statelsn;
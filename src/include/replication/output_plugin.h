@@ -94,6 +94,14 @@ typedef void (*LogicalDecodeMessageCB) (struct LogicalDecodingContext *ctx,
 typedef bool (*LogicalDecodeFilterByOriginCB) (struct LogicalDecodingContext *ctx,
 											   RepOriginId origin_id);
 
+/*
+ * Filter INSERT, UPDATE and DELETE changes by the relation they modify,
+ * before they are queued in the reorder buffer.
+ */
+typedef bool (*LogicalDecodeFilterByRelationCB) (struct LogicalDecodingContext *ctx,
+												 Relation relation,
+												 ReorderBufferChangeType action);
+
 /*
  * Called to shutdown an output plugin.
  */
@@ -238,6 +246,9 @@ typedef struct OutputPluginCallbacks
 	LogicalDecodeStreamChangeCB stream_change_cb;
 	LogicalDecodeStreamMessageCB stream_message_cb;
 	LogicalDecodeStreamTruncateCB stream_truncate_cb;
+
+	/* early filtering of changes */
+	LogicalDecodeFilterByRelationCB filter_by_relation_cb;
 } OutputPluginCallbacks;
 
 /* Functions in replication/logical/logical.c */
@@ -22,21 +22,20 @@ extern PGDLLIMPORT int logical_decoding_work_mem;
 /* an individual tuple, stored in one chunk of memory */
 typedef struct ReorderBufferTupleBuf
 {
-	/* position in preallocated list */
-	slist_node	node;
-
 	/* tuple header, the interesting bit for users of logical decoding */
 	HeapTupleData tuple;
 
-	/* pre-allocated size of tuple buffer, different from tuple size */
-	Size		alloc_tuple_size;
-
 	/* actual tuple data follows */
 } ReorderBufferTupleBuf;
 
-/* pointer to the data stored in a TupleBuf */
+/*
+ * pointer to the data stored in a TupleBuf
+ *
+ * The buffer is allocated as a single chunk, so this is only the header
+ * padded to a MAXALIGN boundary.
+ */
 #define ReorderBufferTupleBufData(p) \
-	((HeapTupleHeader) MAXALIGN(((char *) p) + sizeof(ReorderBufferTupleBuf)))
+	((HeapTupleHeader) (((char *) p) + MAXALIGN(sizeof(ReorderBufferTupleBuf))))
 
 /*
  * Types of the change passed to a 'change' callback.
@@ -84,11 +83,12 @@ typedef struct ReorderBufferChange
 	/* The type of change. */
 	ReorderBufferChangeType action;
 
+	/* kept next to action, so that both fit in the padding before txn */
+	RepOriginId origin_id;
+
 	/* Transaction this change belongs to. */
 	struct ReorderBufferTXN *txn;
 
-	RepOriginId origin_id;
-
 	/*
 	 * Context data for the change. Which part of the union is valid depends
 	 * on action.
@@ -176,6 +176,7 @@ typedef struct ReorderBufferChange
 #define RBTXN_HAS_PARTIAL_CHANGE  0x0020
 #define RBTXN_PREPARE             0x0040
 #define RBTXN_SKIPPED_PREPARE	  0x0080
+#define RBTXN_HAS_NEW_SNAPSHOT    0x0100
 
 /* Does the transaction have catalog changes? */
 #define rbtxn_has_catalog_changes(txn) \
@@ -233,6 +234,12 @@ typedef struct ReorderBufferChange
 	((txn)->txn_flags & RBTXN_SKIPPED_PREPARE) != 0 \
 )
 
+/* Has a catalog snapshot newer than the base snapshot been queued? */
+#define rbtxn_has_new_snapshot(txn) \
+( \
+	((txn)->txn_flags & RBTXN_HAS_NEW_SNAPSHOT) != 0 \
+)
+
 typedef struct ReorderBufferTXN
 {
 	/* See above */
@@ -667,6 +674,7 @@ extern void ReorderBufferProcessXid(ReorderBuffer *, TransactionId xid, XLogRecP
 
 extern void ReorderBufferXidSetCatalogChanges(ReorderBuffer *, TransactionId xid, XLogRecPtr lsn);
 extern bool ReorderBufferXidHasCatalogChanges(ReorderBuffer *, TransactionId xid);
+extern Snapshot ReorderBufferXidGetFilterSnapshot(ReorderBuffer *, TransactionId xid);
 extern bool ReorderBufferXidHasBaseSnapshot(ReorderBuffer *, TransactionId xid);
 
 extern bool ReorderBufferRememberPrepareInfo(ReorderBuffer *rb, TransactionId xid,
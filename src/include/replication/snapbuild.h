@@ -65,6 +65,7 @@ extern SnapBuild *AllocateSnapshotBuilder(struct ReorderBuffer *cache,
 										  XLogRecPtr two_phase_at);
 extern void FreeSnapshotBuilder(SnapBuild *cache);
 
+extern void SnapBuildSnapIncRefcount(Snapshot snap);
 extern void SnapBuildSnapDecRefcount(Snapshot snap);
 
 extern Snapshot SnapBuildInitialSnapshot(SnapBuild *builder);
@@ -14,6 +14,7 @@
 #define _SYNCREP_H
 
 #include "access/xlogdefs.h"
+#include "datatype/timestamp.h"
 #include "utils/guc.h"
 
 #define SyncRepRequested() \
@@ -90,10 +91,14 @@ extern void SyncRepCleanupAtProcExit(void);
 /* called by wal sender */
 extern void SyncRepInitConfig(void);
 extern void SyncRepReleaseWaiters(void);
+extern void SyncRepReportFlushLag(TimeOffset flushLag);
 
 /* called by wal sender and user backend */
 extern int	SyncRepGetCandidateStandbys(SyncRepStandbyData **standbys);
 
+/* called by user backend flushing WAL */
+extern int	SyncRepGroupCommitDelay(int max_delay, int siblings);
+
 /* called by checkpointer */
 extern void SyncRepUpdateSyncStandbysDefined(void);
 
@@ -55,6 +55,20 @@ extern void WalSndRqstFileReload(void);
  */
 extern uint64 (*delay_backend_us)(void);
 
+/*
+ * Lag tracking.  The walproposer, which feeds several safekeepers, creates a
+ * tracker with one reader per safekeeper; LagTrackerWrite and LagTrackerRead
+ * use the walsender's own tracker, which has a single reader.
+ */
+typedef struct LagTracker LagTracker;
+
+extern LagTracker *LagTrackerCreate(int nreaders);
+extern void LagTrackerWriteSample(LagTracker *tracker, XLogRecPtr lsn,
+								  TimestampTz local_flush_time);
+extern TimeOffset LagTrackerReadSample(LagTracker *tracker, int reader,
+									   int head, XLogRecPtr lsn,
+									   TimestampTz now);
+
 /* expose these so that they can be reused by the neon walproposer extension */
 extern void LagTrackerWrite(XLogRecPtr lsn, TimestampTz local_flush_time);
 extern TimeOffset LagTrackerRead(int head, XLogRecPtr lsn, TimestampTz now);
@@ -14,6 +14,7 @@
 
 #include "access/xlog.h"
 #include "nodes/nodes.h"
+#include "port/atomics.h"
 #include "replication/syncrep.h"
 #include "storage/latch.h"
 #include "storage/shmem.h"
@@ -82,6 +83,9 @@ typedef struct WalSnd
 
 extern PGDLLIMPORT WalSnd *MyWalSnd;
 
+/* fixed-point scale of WalSndCtlData.flushAckGroupSize */
+#define SYNC_REP_GROUP_SIZE_SCALE	16
+
 /* There is one WalSndCtl struct for the whole database cluster */
 typedef struct
 {
@@ -104,6 +108,17 @@ typedef struct
 	 */
 	bool		sync_standbys_defined;
 
+	/*
+	 * Moving averages of the time from flushing WAL locally to a sync
+	 * standby confirming the flush, in microseconds, and of the number of
+	 * backends released by one confirmation, scaled by
+	 * SYNC_REP_GROUP_SIZE_SCALE.  Used to size the adaptive commit delay,
+	 * see SyncRepGroupCommitDelay().  Updated without locking, since a lost
+	 * update doesn't matter.
+	 */
+	pg_atomic_uint64 flushAckLatency;
+	pg_atomic_uint32 flushAckGroupSize;
+
 	WalSnd		walsnds[FLEXIBLE_ARRAY_MEMBER];
 } WalSndCtlData;
 
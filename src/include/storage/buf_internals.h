@@ -280,6 +280,12 @@ extern PGDLLIMPORT WritebackContext BackendWritebackContext;
 
 extern Buffer wal_redo_buffer;
 
+/* maximum number of target pages of a batch of WAL redo requests */
+#define MAX_WAL_REDO_BUFFERS	64
+
+extern Buffer wal_redo_buffers[MAX_WAL_REDO_BUFFERS];
+extern int	num_wal_redo_buffers;
+
 /* in localbuf.c */
 extern PGDLLIMPORT BufferDesc *LocalBufferDescriptors;
 
@@ -319,6 +325,8 @@ extern bool StrategyRejectBuffer(BufferAccessStrategy strategy,
 
 extern int	StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc);
 extern void StrategyNotifyBgWriter(int bgwprocno);
+extern void StrategyCountBackendWrite(void);
+extern uint32 StrategyBackendWrites(void);
 
 extern Size StrategyShmemSize(void);
 extern void StrategyInitialize(bool init);
@@ -343,5 +351,8 @@ extern void DropRelFileNodeLocalBuffers(RelFileNode rnode, ForkNumber forkNum,
 										BlockNumber firstDelBlock);
 extern void DropRelFileNodeAllLocalBuffers(RelFileNode rnode);
 extern void AtEOXact_LocalBuffers(bool isCommit);
+extern void AddWalRedoTargetBuffer(Buffer buffer);
+extern void ResetWalRedoTargetBuffers(void);
+extern void DropWalRedoLocalBuffers(void);
 
 #endif							/* BUFMGR_INTERNALS_H */
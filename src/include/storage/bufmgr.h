@@ -55,6 +55,21 @@ typedef struct PrefetchBufferResult
 	bool		initiated_io;	/* If true, a miss resulting in async I/O */
 } PrefetchBufferResult;
 
+/*
+ * State of a read started by StartReadBuffer(), to be completed by
+ * WaitReadBuffer().
+ */
+typedef struct PendingBufferRead
+{
+	Relation	rel;
+	ForkNumber	forkNum;
+	BlockNumber blockNum;
+	ReadBufferMode mode;
+	BufferAccessStrategy strategy;
+	Buffer		recent_buffer;	/* If valid, a hit (recheck needed!) */
+	bool		started;		/* If true, a read was started in the smgr */
+} PendingBufferRead;
+
 /* forward declared, to avoid having to expose buf_internals.h here */
 struct WritebackContext;
 
@@ -89,6 +104,12 @@ extern PGDLLIMPORT int32 *LocalRefCount;
 /* upper limit for effective_io_concurrency (better to he power of 2) */
 #define MAX_IO_CONCURRENCY 1024
 
+/* number of blocks PrefetchBuffers() hands to the smgr in one request */
+#define PREFETCH_BATCH_SIZE 64
+
+/* upper limit for the number of blocks filled by one ReadBuffers() call */
+#define MAX_BUFFERS_PER_READ 32
+
 /* special block number for ReadBuffer() */
 #define P_NEW	InvalidBlockNumber	/* grow the file to get a new page */
 
@@ -178,12 +199,22 @@ extern PrefetchBufferResult PrefetchSharedBuffer(struct SMgrRelationData *smgr_r
 												 BlockNumber blockNum);
 extern PrefetchBufferResult PrefetchBuffer(Relation reln, ForkNumber forkNum,
 										   BlockNumber blockNum);
+extern int	PrefetchBuffers(Relation reln, ForkNumber forkNum,
+							BlockNumber *blocks, int nblocks);
 extern bool ReadRecentBuffer(RelFileNode rnode, ForkNumber forkNum,
 							 BlockNumber blockNum, Buffer recent_buffer);
 extern Buffer ReadBuffer(Relation reln, BlockNumber blockNum);
 extern Buffer ReadBufferExtended(Relation reln, ForkNumber forkNum,
 								 BlockNumber blockNum, ReadBufferMode mode,
 								 BufferAccessStrategy strategy);
+extern void ReadBuffers(Relation reln, ForkNumber forkNum,
+						BlockNumber blockNum, int nblocks, Buffer *buffers,
+						ReadBufferMode mode, BufferAccessStrategy strategy);
+extern void StartReadBuffer(PendingBufferRead *read, Relation reln,
+							ForkNumber forkNum, BlockNumber blockNum,
+							ReadBufferMode mode,
+							BufferAccessStrategy strategy);
+extern Buffer WaitReadBuffer(PendingBufferRead *read);
 extern Buffer ReadBufferWithoutRelcache(RelFileNode rnode,
 										ForkNumber forkNum, BlockNumber blockNum,
 										ReadBufferMode mode, BufferAccessStrategy strategy,
@@ -0,0 +1,37 @@
+/*-------------------------------------------------------------------------
+ *
+ * bufsim.h
+ *	  Simulation of a buffer cache of a different size.
+ *
+ *
+ * Portions Copyright (c) 1996-2022, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/bufsim.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef BUFSIM_H
+#define BUFSIM_H
+
+#include "storage/buf_internals.h"
+
+/* which block accesses the simulated cache sees */
+typedef enum BufferSimulationLevel
+{
+	BUFFER_SIMULATION_SHARED_BUFFERS,	/* all shared buffer accesses */
+	BUFFER_SIMULATION_FILE_CACHE	/* reads that missed the buffer pool */
+} BufferSimulationLevel;
+
+/* GUC variables */
+extern PGDLLIMPORT int buffer_simulation_size;
+extern PGDLLIMPORT int buffer_simulation_level;
+
+extern Size BufferSimulationShmemSize(void);
+extern void BufferSimulationShmemInit(void);
+
+extern void BufferSimulationAccess(BufferTag *tag, uint32 hashcode,
+								   bool found);
+extern void BufferSimulationResetStats(void);
+
+#endif							/* BUFSIM_H */
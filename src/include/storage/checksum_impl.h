@@ -138,12 +138,24 @@ do { \
 	(checksum) = __tmp * FNV_PRIME ^ (__tmp >> 17); \
 } while (0)
 
+/*
+ * With GCC or clang on x86-64, the checksum loop is also compiled for AVX2
+ * and AVX-512, which have a 32-bit vector multiply and process 8 and 16 of
+ * the parallel sums per instruction, and the best variant the CPU supports
+ * is chosen on first use.  Otherwise the vectorization is left to the
+ * compiler's baseline target.
+ */
+#if defined(__x86_64__) && (defined(__clang__) || \
+	(defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define PG_CHECKSUM_CHOOSE_TARGET
+#endif
+
 /*
  * Block checksum algorithm.  The page must be adequately aligned
  * (at least on 4-byte boundary).
  */
-static uint32
-pg_checksum_block(const PGChecksummablePage *page)
+static pg_attribute_always_inline uint32
+pg_checksum_block_impl(const PGChecksummablePage *page)
 {
 	uint32		sums[N_SUMS];
 	uint32		result = 0;
@@ -173,6 +185,56 @@ pg_checksum_block(const PGChecksummablePage *page)
 	return result;
 }
 
+#ifdef PG_CHECKSUM_CHOOSE_TARGET
+
+static uint32
+pg_checksum_block_default(const PGChecksummablePage *page)
+{
+	return pg_checksum_block_impl(page);
+}
+
+static uint32 __attribute__((target("avx2")))
+pg_checksum_block_avx2(const PGChecksummablePage *page)
+{
+	return pg_checksum_block_impl(page);
+}
+
+static uint32 __attribute__((target("avx512f")))
+pg_checksum_block_avx512(const PGChecksummablePage *page)
+{
+	return pg_checksum_block_impl(page);
+}
+
+static uint32 pg_checksum_block_choose(const PGChecksummablePage *page);
+
+static uint32 (*pg_checksum_block) (const PGChecksummablePage *page) =
+pg_checksum_block_choose;
+
+/*
+ * On the first call, check which instruction set extensions the CPU and OS
+ * support, set the pg_checksum_block function pointer accordingly, and call
+ * it.
+ */
+static uint32
+pg_checksum_block_choose(const PGChecksummablePage *page)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		pg_checksum_block = pg_checksum_block_avx512;
+	else if (__builtin_cpu_supports("avx2"))
+		pg_checksum_block = pg_checksum_block_avx2;
+	else
+		pg_checksum_block = pg_checksum_block_default;
+
+	return pg_checksum_block(page);
+}
+
+#else
+
+#define pg_checksum_block(page) pg_checksum_block_impl(page)
+
+#endif							/* PG_CHECKSUM_CHOOSE_TARGET */
+
 /*
  * Compute the checksum for a Postgres page.
  *
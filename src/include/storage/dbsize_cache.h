@@ -0,0 +1,28 @@
+/*-------------------------------------------------------------------------
+ *
+ * dbsize_cache.h
+ *	  Shared-memory cache of database sizes.
+ *
+ *
+ * Portions Copyright (c) 1996-2022, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/dbsize_cache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef DBSIZE_CACHE_H
+#define DBSIZE_CACHE_H
+
+/* GUC variable */
+extern PGDLLIMPORT int dbsize_cache_ttl;
+
+extern Size DbSizeCacheShmemSize(void);
+extern void DbSizeCacheShmemInit(void);
+
+extern bool DbSizeCacheLookup(Oid dbOid, int64 *size);
+extern void DbSizeCacheStore(Oid dbOid, int64 size);
+extern void DbSizeCacheExtend(Oid dbOid, int64 nbytes);
+extern void DbSizeCacheInvalidate(Oid dbOid);
+
+#endif							/* DBSIZE_CACHE_H */
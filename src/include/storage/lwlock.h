@@ -193,6 +193,10 @@ typedef enum BuiltinTrancheIds
 	LWTRANCHE_PGSTATS_DSA,
 	LWTRANCHE_PGSTATS_HASH,
 	LWTRANCHE_PGSTATS_DATA,
+	LWTRANCHE_LAST_WRITTEN_LSN_CACHE,
+	LWTRANCHE_RELSIZE_CACHE,
+	LWTRANCHE_DBSIZE_CACHE,
+	LWTRANCHE_BUFFER_SIMULATION,
 	LWTRANCHE_FIRST_USER_DEFINED
 }			BuiltinTrancheIds;
 
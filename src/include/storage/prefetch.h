@@ -0,0 +1,106 @@
+/*-------------------------------------------------------------------------
+ *
+ * prefetch.h
+ *	  Adaptive prefetch distance control for scans.
+ *
+ *
+ * Portions Copyright (c) 1996-2022, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/prefetch.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include "portability/instr_time.h"
+#include "storage/block.h"
+#include "utils/relcache.h"
+
+/*
+ * State of the prefetch distance controller of one scan.
+ *
+ * The scan reports each page it prefetches and each page it consumes, and
+ * asks the controller how far ahead of its current position it should keep
+ * requests in flight.  See prefetch.c for the policy.
+ */
+typedef struct PrefetchControl
+{
+	int			maximum;		/* upper bound of target, <= 0 if disabled */
+	int			start;			/* target to start a (re)scan with */
+	int			target;			/* current prefetch distance */
+	uint64		issued;			/* pages prefetched since (re)start */
+	uint64		consumed;		/* pages consumed since (re)start */
+	double		busy_usec;		/* moving average of time spent per page
+								 * outside of smgr reads */
+	instr_time	last_consume;	/* time of the previous consumed page */
+	uint64		last_wait_usec; /* read wait total at last_consume */
+} PrefetchControl;
+
+extern void PrefetchControlInit(PrefetchControl *pc, int maximum, int start);
+extern void PrefetchControlRestart(PrefetchControl *pc);
+extern void PrefetchControlRescan(PrefetchControl *pc, int maximum, int start);
+extern void PrefetchControlIssued(PrefetchControl *pc, int npages);
+extern int	PrefetchControlConsume(PrefetchControl *pc);
+extern void PrefetchControlReportRead(instr_time io_time);
+
+/*
+ * Current prefetch distance of the scan.
+ */
+static inline int
+PrefetchControlTarget(PrefetchControl *pc)
+{
+	return pc->target;
+}
+
+/* enough for the items of the fullest index page */
+#define PREFETCH_QUEUE_SIZE 1024
+
+/*
+ * Queue of the blocks of a relation that a scan will read, in the order it
+ * will read them.
+ *
+ * This is the AM-independent part of prefetching for index scans: the
+ * access method queues the heap blocks of the items it is about to return
+ * (or the index pages it is about to visit), and reports each one it moves
+ * on to.  The queue keeps prefetch requests in flight for the next blocks
+ * as directed by its PrefetchControl.
+ */
+typedef struct PrefetchQueue
+{
+	Relation	rel;			/* relation the blocks belong to */
+	PrefetchControl ctl;		/* controls the prefetch distance */
+	int			head;			/* index of the block being consumed */
+	int			issued;			/* blocks before this have been prefetched */
+	int			tail;			/* index of the first free slot */
+	BlockNumber blocks[PREFETCH_QUEUE_SIZE];
+} PrefetchQueue;
+
+extern void PrefetchQueueInit(PrefetchQueue *pq, Relation rel, int maximum,
+							  int start);
+extern void PrefetchQueueRestart(PrefetchQueue *pq);
+extern void PrefetchQueueReset(PrefetchQueue *pq);
+extern void PrefetchQueueAdd(PrefetchQueue *pq, BlockNumber blkno);
+extern void PrefetchQueueIssue(PrefetchQueue *pq);
+extern void PrefetchQueueConsume(PrefetchQueue *pq);
+
+/*
+ * Is prefetching enabled at all for the scan?
+ */
+static inline bool
+PrefetchQueueEnabled(PrefetchQueue *pq)
+{
+	return pq->ctl.maximum > 0;
+}
+
+/*
+ * Number of queued blocks that haven't been consumed yet.
+ */
+static inline int
+PrefetchQueueLength(PrefetchQueue *pq)
+{
+	return pq->tail - pq->head;
+}
+
+#endif							/* PREFETCH_H */
@@ -0,0 +1,37 @@
+/*-------------------------------------------------------------------------
+ *
+ * relsize_cache.h
+ *	  Shared-memory cache of relation fork sizes.
+ *
+ *
+ * Portions Copyright (c) 1996-2022, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/relsize_cache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef RELSIZE_CACHE_H
+#define RELSIZE_CACHE_H
+
+#include "storage/block.h"
+#include "storage/relfilenode.h"
+
+/* GUC variable */
+extern PGDLLIMPORT int relsize_cache_size;
+
+extern Size RelSizeCacheShmemSize(void);
+extern void RelSizeCacheShmemInit(void);
+
+extern BlockNumber RelSizeCacheLookup(RelFileNode rnode, ForkNumber forknum,
+									  uint64 *generation);
+extern void RelSizeCacheExtend(RelFileNode rnode, ForkNumber forknum,
+							   BlockNumber nblocks);
+extern void RelSizeCacheFill(RelFileNode rnode, ForkNumber forknum,
+							 BlockNumber nblocks, uint64 generation);
+extern void RelSizeCacheSet(RelFileNode rnode, ForkNumber forknum,
+							BlockNumber nblocks);
+extern void RelSizeCacheForget(RelFileNode rnode, ForkNumber forknum);
+extern void RelSizeCacheForgetDatabase(Oid dbid);
+
+#endif							/* RELSIZE_CACHE_H */
@@ -98,6 +98,15 @@ typedef SMgrRelationData *SMgrRelation;
  * and so it's too late to raise an error.  Also, various conditions that
  * would normally be errors should be allowed during bootstrap and/or WAL
  * recovery --- see comments in md.c for details.
+ *
+ * smgr_startread starts reading a block without waiting for it, and
+ * smgr_waitread collects the page read by an earlier smgr_startread of the
+ * same block.  A backend may have several reads outstanding, and collect
+ * them in any order.  Unlike a read, a started read may also never be
+ * collected, e.g. if another backend has read the block into shared buffers
+ * meanwhile, so the storage manager must be able to drop it, as it does with
+ * prefetches.  Storage managers without this support leave both NULL; a
+ * prefetch and a synchronous read are then used instead.
  */
 typedef struct f_smgr
 {
@@ -112,10 +121,22 @@ typedef struct f_smgr
 								bool isRedo);
 	void		(*smgr_extend) (SMgrRelation reln, ForkNumber forknum,
 								BlockNumber blocknum, char *buffer, bool skipFsync);
+	void		(*smgr_zeroextend) (SMgrRelation reln, ForkNumber forknum,
+									BlockNumber blocknum, int nblocks,
+									bool skipFsync);	/* may be NULL */
 	bool		(*smgr_prefetch) (SMgrRelation reln, ForkNumber forknum,
 								  BlockNumber blocknum);
+	bool		(*smgr_prefetchv) (SMgrRelation reln, ForkNumber forknum,
+								   BlockNumber *blocknums, int nblocks);	/* may be NULL */
 	void		(*smgr_read) (SMgrRelation reln, ForkNumber forknum,
 							  BlockNumber blocknum, char *buffer);
+	void		(*smgr_readv) (SMgrRelation reln, ForkNumber forknum,
+							   BlockNumber blocknum, int nblocks,
+							   char **buffers);	/* may be NULL */
+	bool		(*smgr_startread) (SMgrRelation reln, ForkNumber forknum,
+								   BlockNumber blocknum);	/* may be NULL */
+	void		(*smgr_waitread) (SMgrRelation reln, ForkNumber forknum,
+								  BlockNumber blocknum, char *buffer);	/* may be NULL */
 	void		(*smgr_write) (SMgrRelation reln, ForkNumber forknum,
 							   BlockNumber blocknum, char *buffer, bool skipFsync);
 	void		(*smgr_writeback) (SMgrRelation reln, ForkNumber forknum,
@@ -163,10 +184,21 @@ extern void smgrdosyncall(SMgrRelation *rels, int nrels);
 extern void smgrdounlinkall(SMgrRelation *rels, int nrels, bool isRedo);
 extern void smgrextend(SMgrRelation reln, ForkNumber forknum,
 					   BlockNumber blocknum, char *buffer, bool skipFsync);
+extern void smgrzeroextend(SMgrRelation reln, ForkNumber forknum,
+						   BlockNumber blocknum, int nblocks, bool skipFsync);
+extern bool smgrcanzeroextend(SMgrRelation reln);
 extern bool smgrprefetch(SMgrRelation reln, ForkNumber forknum,
 						 BlockNumber blocknum);
+extern int	smgrprefetchv(SMgrRelation reln, ForkNumber forknum,
+						  BlockNumber *blocknums, int nblocks);
 extern void smgrread(SMgrRelation reln, ForkNumber forknum,
 					 BlockNumber blocknum, char *buffer);
+extern void smgrreadv(SMgrRelation reln, ForkNumber forknum,
+					  BlockNumber blocknum, int nblocks, char **buffers);
+extern bool smgrstartread(SMgrRelation reln, ForkNumber forknum,
+						  BlockNumber blocknum);
+extern void smgrwaitread(SMgrRelation reln, ForkNumber forknum,
+						 BlockNumber blocknum, char *buffer);
 extern void smgrwrite(SMgrRelation reln, ForkNumber forknum,
 					  BlockNumber blocknum, char *buffer, bool skipFsync);
 extern void smgrwriteback(SMgrRelation reln, ForkNumber forknum,
@@ -168,6 +168,12 @@ typedef struct PgBackendStatus
 
 	/* query identifier, optionally computed using post_parse_analyze_hook */
 	uint64		st_query_id;
+
+	/*
+	 * Memory allocated by the memory contexts of the backend, in bytes.  The
+	 * backend updates this on every block it allocates or frees.
+	 */
+	uint64		st_allocated_bytes;
 } PgBackendStatus;
 
 
@@ -299,6 +305,7 @@ extern void pgstat_clear_backend_activity_snapshot(void);
 extern void pgstat_report_activity(BackendState state, const char *cmd_str);
 extern void pgstat_report_query_id(uint64 query_id, bool force);
 extern void pgstat_report_tempfile(size_t filesize);
+extern void pgstat_report_allocated_bytes(uint64 allocated_bytes);
 extern void pgstat_report_appname(const char *appname);
 extern void pgstat_report_xact_timestamp(TimestampTz tstamp);
 extern const char *pgstat_get_backend_current_activity(int pid, bool checkUser);
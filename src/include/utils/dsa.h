@@ -108,6 +108,7 @@ extern void dsa_release_in_place(void *place);
 extern void dsa_on_dsm_detach_release_in_place(dsm_segment *, Datum);
 extern void dsa_on_shmem_exit_release_in_place(int, Datum);
 extern void dsa_pin_mapping(dsa_area *area);
+extern void dsa_enable_cache(dsa_area *area);
 extern void dsa_detach(dsa_area *area);
 extern void dsa_pin(dsa_area *area);
 extern void dsa_unpin(dsa_area *area);
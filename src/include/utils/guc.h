@@ -460,8 +460,14 @@ extern void assign_search_path(const char *newval, void *extra);
 
 /* in access/transam/xlog.c */
 extern bool check_wal_buffers(int *newval, void **extra, GucSource source);
+extern bool check_wal_insert_locks(int *newval, void **extra,
+								   GucSource source);
 extern void assign_xlog_sync_method(int new_sync_method, void *extra);
 
+/* in storage/ipc/sinvaladt.c */
+extern bool check_invalidation_queue_size(int *newval, void **extra,
+										  GucSource source);
+
 /* in access/transam/xlogprefetcher.c */
 extern bool check_recovery_prefetch(int *new_value, void **extra, GucSource source);
 extern void assign_recovery_prefetch(int new_value, void *extra);
@@ -148,6 +148,67 @@ extern void MemoryContextCreate(MemoryContext node,
 extern void HandleLogMemoryContextInterrupt(void);
 extern void ProcessLogMemoryContextInterrupt(void);
 
+/*
+ * Accounting of the memory obtained from malloc() by the memory contexts of
+ * the backend.  The context-type-specific routines allocate and free all of
+ * their blocks through these, so that the total is maintained in O(1) per
+ * block, and max_backend_memory can be enforced by failing the allocation.
+ */
+extern PGDLLIMPORT int max_backend_memory;
+extern PGDLLIMPORT uint64 backend_allocated_bytes;
+extern PGDLLIMPORT bool backend_memory_reporting;
+
+extern bool BackendMemoryLimitExceeded(Size size);
+extern void BackendMemorySetReporting(bool reporting);
+extern void BackendMemoryReport(void);
+
+static inline void *
+BackendMemoryAlloc(Size size)
+{
+	void	   *ptr;
+
+	if (unlikely(max_backend_memory > 0) && BackendMemoryLimitExceeded(size))
+		return NULL;
+
+	ptr = malloc(size);
+	if (ptr != NULL)
+	{
+		backend_allocated_bytes += size;
+		if (backend_memory_reporting)
+			BackendMemoryReport();
+	}
+	return ptr;
+}
+
+static inline void *
+BackendMemoryRealloc(void *ptr, Size oldsize, Size size)
+{
+	void	   *newptr;
+
+	if (unlikely(max_backend_memory > 0) && size > oldsize &&
+		BackendMemoryLimitExceeded(size - oldsize))
+		return NULL;
+
+	newptr = realloc(ptr, size);
+	if (newptr != NULL)
+	{
+		backend_allocated_bytes -= oldsize;
+		backend_allocated_bytes += size;
+		if (backend_memory_reporting)
+			BackendMemoryReport();
+	}
+	return newptr;
+}
+
+static inline void
+BackendMemoryFree(void *ptr, Size size)
+{
+	backend_allocated_bytes -= size;
+	if (backend_memory_reporting)
+		BackendMemoryReport();
+	free(ptr);
+}
+
 /*
  * Memory-context-type-specific functions
  */
@@ -187,6 +248,13 @@ extern MemoryContext GenerationContextCreate(MemoryContext parent,
 											 Size initBlockSize,
 											 Size maxBlockSize);
 
+/* bump.c */
+extern MemoryContext BumpContextCreate(MemoryContext parent,
+									   const char *name,
+									   Size minContextSize,
+									   Size initBlockSize,
+									   Size maxBlockSize);
+
 /*
  * Recommended default alloc parameters, suitable for "ordinary" contexts
  * that might hold quite a lot of data.
@@ -344,6 +344,20 @@ typedef struct PgStatShared_Wal
 	PgStat_WalStats stats;
 } PgStatShared_Wal;
 
+typedef struct PgStatShared_LastWrittenLsnCache
+{
+	/* lock protects ->stats */
+	LWLock		lock;
+	PgStat_LastWrittenLsnCacheStats stats;
+} PgStatShared_LastWrittenLsnCache;
+
+typedef struct PgStatShared_Smgr
+{
+	/* lock protects ->stats */
+	LWLock		lock;
+	PgStat_SmgrStats stats;
+} PgStatShared_Smgr;
+
 
 
 /* ----------
@@ -422,6 +436,8 @@ typedef struct PgStat_ShmemControl
 	PgStatShared_Checkpointer checkpointer;
 	PgStatShared_SLRU slru;
 	PgStatShared_Wal wal;
+	PgStatShared_LastWrittenLsnCache lwlsn_cache;
+	PgStatShared_Smgr smgr;
 } PgStat_ShmemControl;
 
 
@@ -447,6 +463,10 @@ typedef struct PgStat_Snapshot
 
 	PgStat_WalStats wal;
 
+	PgStat_LastWrittenLsnCacheStats lwlsn_cache;
+
+	PgStat_SmgrStats smgr;
+
 	/* to free snapshot in bulk */
 	MemoryContext context;
 	struct pgstat_snapshot_hash *stats;
@@ -620,6 +640,24 @@ extern void pgstat_wal_reset_all_cb(TimestampTz ts);
 extern void pgstat_wal_snapshot_cb(void);
 
 
+/*
+ * Functions in pgstat_lastwrittenlsn.c
+ */
+
+extern bool pgstat_lwlsn_cache_flush(bool nowait);
+extern void pgstat_lwlsn_cache_reset_all_cb(TimestampTz ts);
+extern void pgstat_lwlsn_cache_snapshot_cb(void);
+
+
+/*
+ * Functions in pgstat_smgr.c
+ */
+
+extern bool pgstat_smgr_flush(bool nowait);
+extern void pgstat_smgr_reset_all_cb(TimestampTz ts);
+extern void pgstat_smgr_snapshot_cb(void);
+
+
 /*
  * Functions in pgstat_subscription.c
  */
@@ -650,6 +688,20 @@ extern PGDLLIMPORT PgStat_LocalState pgStatLocal;
 extern PGDLLIMPORT bool have_slrustats;
 
 
+/*
+ * Variables in pgstat_lastwrittenlsn.c
+ */
+
+extern PGDLLIMPORT bool have_lwlsnstats;
+
+
+/*
+ * Variables in pgstat_smgr.c
+ */
+
+extern PGDLLIMPORT bool have_smgrstats;
+
+
 /*
  * Implementation of inline functions declared above.
  */
@@ -116,7 +116,10 @@ typedef struct VariableStatData
  *
  * Callers should initialize all fields of GenericCosts to zero.  In addition,
  * they can set numIndexTuples to some positive value if they have a better
- * than default way of estimating the number of leaf index tuples visited.
+ * than default way of estimating the number of leaf index tuples visited,
+ * and num_sa_scans to the number of index scans the AM performs for other
+ * reasons than ScalarArrayOpExprs, which genericcostestimate multiplies by
+ * the number of scans they induce.
  */
 typedef struct
 {
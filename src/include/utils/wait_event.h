@@ -111,6 +111,7 @@ typedef enum
 	WAIT_EVENT_MQ_PUT_MESSAGE,
 	WAIT_EVENT_MQ_RECEIVE,
 	WAIT_EVENT_MQ_SEND,
+	WAIT_EVENT_MULTIXACT_CREATION,
 	WAIT_EVENT_PARALLEL_BITMAP_SCAN,
 	WAIT_EVENT_PARALLEL_CREATE_INDEX_SCAN,
 	WAIT_EVENT_PARALLEL_FINISH,
@@ -190,6 +191,7 @@ typedef enum
 	WAIT_EVENT_LOGICAL_REWRITE_CHECKPOINT_SYNC,
 	WAIT_EVENT_LOGICAL_REWRITE_MAPPING_SYNC,
 	WAIT_EVENT_LOGICAL_REWRITE_MAPPING_WRITE,
+	WAIT_EVENT_LOGICAL_REWRITE_READ,
 	WAIT_EVENT_LOGICAL_REWRITE_SYNC,
 	WAIT_EVENT_LOGICAL_REWRITE_TRUNCATE,
 	WAIT_EVENT_LOGICAL_REWRITE_WRITE,
@@ -41,7 +41,8 @@ char	   *const pgresStatus[] = {
 	"PGRES_COPY_BOTH",
 	"PGRES_SINGLE_TUPLE",
 	"PGRES_PIPELINE_SYNC",
-	"PGRES_PIPELINE_ABORTED"
+	"PGRES_PIPELINE_ABORTED",
+	"PGRES_TUPLES_CHUNK"
 };
 
 /* We return this if we're unable to make a PGresult at all */
@@ -199,6 +200,7 @@ PQmakeEmptyPGresult(PGconn *conn, ExecStatusType status)
 			case PGRES_COPY_IN:
 			case PGRES_COPY_BOTH:
 			case PGRES_SINGLE_TUPLE:
+			case PGRES_TUPLES_CHUNK:
 				/* non-error cases */
 				break;
 			default:
@@ -916,8 +918,8 @@ pqPrepareAsyncResult(PGconn *conn)
 	/*
 	 * Replace conn->result with next_result, if any.  In the normal case
 	 * there isn't a next result and we're just dropping ownership of the
-	 * current result.  In single-row mode this restores the situation to what
-	 * it was before we created the current single-row result.
+	 * current result.  In partial-result mode this restores the situation to
+	 * what it was before we created the current partial result.
 	 */
 	conn->result = conn->next_result;
 	conn->error_result = false; /* next_result is never an error */
@@ -1199,10 +1201,13 @@ pqSaveParameterStatus(PGconn *conn, const char *name, const char *value)
  * (Such a string should already be translated via libpq_gettext().)
  * If it is left NULL, the error is presumed to be "out of memory".
  *
- * In single-row mode, we create a new result holding just the current row,
- * stashing the previous result in conn->next_result so that it becomes
- * active again after pqPrepareAsyncResult().  This allows the result metadata
- * (column descriptions) to be carried forward to each result row.
+ * In partial-result mode (single-row or chunked-rows), we create a new
+ * result to hold the incoming rows, stashing the previous result in
+ * conn->next_result so that it becomes active again after
+ * pqPrepareAsyncResult().  This allows the result metadata (column
+ * descriptions) to be carried forward to each partial result.  The partial
+ * result is handed to the client once it holds conn->maxChunkSize rows; in
+ * single-row mode that is every row.
  */
 int
 pqRowProcessor(PGconn *conn, const char **errmsgp)
@@ -1214,11 +1219,12 @@ pqRowProcessor(PGconn *conn, const char **errmsgp)
 	int			i;
 
 	/*
-	 * In single-row mode, make a new PGresult that will hold just this one
-	 * row; the original conn->result is left unchanged so that it can be used
-	 * again as the template for future rows.
+	 * In partial-result mode, if there's not a partial result already, make
+	 * one by cloning conn->result, and make it the active result.  The
+	 * original conn->result is stashed unchanged in conn->next_result so that
+	 * it can be used again as the template for future partial results.
 	 */
-	if (conn->singleRowMode)
+	if (conn->partialResMode && conn->next_result == NULL)
 	{
 		/* Copy everything that should be in the result at this point */
 		res = PQcopyResult(res,
@@ -1226,6 +1232,12 @@ pqRowProcessor(PGconn *conn, const char **errmsgp)
 						   PG_COPYRES_NOTICEHOOKS);
 		if (!res)
 			return 0;
+		/* Change result status to the appropriate special value */
+		res->resultStatus = conn->singleRowMode ?
+			PGRES_SINGLE_TUPLE : PGRES_TUPLES_CHUNK;
+		/* Stash old result for re-use later */
+		conn->next_result = conn->result;
+		conn->result = res;
 	}
 
 	/*
@@ -1275,26 +1287,16 @@ pqRowProcessor(PGconn *conn, const char **errmsgp)
 		goto fail;
 
 	/*
-	 * Success.  In single-row mode, make the result available to the client
-	 * immediately.
+	 * Success.  In partial-result mode, if we have enough rows then make the
+	 * result available to the client immediately.
 	 */
-	if (conn->singleRowMode)
-	{
-		/* Change result status to special single-row value */
-		res->resultStatus = PGRES_SINGLE_TUPLE;
-		/* Stash old result for re-use later */
-		conn->next_result = conn->result;
-		conn->result = res;
-		/* And mark the result ready to return */
+	if (conn->partialResMode && res->ntups >= conn->maxChunkSize)
 		conn->asyncStatus = PGASYNC_READY_MORE;
-	}
 
 	return 1;
 
 fail:
-	/* release locally allocated PGresult, if we made one */
-	if (res != conn->result)
-		PQclear(res);
+	/* any partial result is conn->result by now; caller discards it */
 	return 0;
 }
 
@@ -1757,8 +1759,10 @@ PQsendQueryStart(PGconn *conn, bool newQuery)
 		 */
 		pqClearAsyncResult(conn);
 
-		/* reset single-row processing mode */
+		/* reset single-row and chunked-rows processing modes */
+		conn->partialResMode = false;
 		conn->singleRowMode = false;
+		conn->maxChunkSize = 0;
 	}
 
 	/* ready to send command message */
@@ -1939,28 +1943,60 @@ sendFailed:
 }
 
 /*
- * Select row-by-row processing mode
+ * Is it OK to change partial-result mode now?
  */
-int
-PQsetSingleRowMode(PGconn *conn)
+static bool
+canChangeResultMode(PGconn *conn)
 {
 	/*
-	 * Only allow setting the flag when we have launched a query and not yet
+	 * Only allow changing the mode when we have launched a query and not yet
 	 * received any results.
 	 */
 	if (!conn)
-		return 0;
+		return false;
 	if (conn->asyncStatus != PGASYNC_BUSY)
-		return 0;
+		return false;
 	if (!conn->cmd_queue_head ||
 		(conn->cmd_queue_head->queryclass != PGQUERY_SIMPLE &&
 		 conn->cmd_queue_head->queryclass != PGQUERY_EXTENDED))
-		return 0;
+		return false;
 	if (pgHavePendingResult(conn))
+		return false;
+	return true;
+}
+
+/*
+ * Select row-by-row processing mode
+ */
+int
+PQsetSingleRowMode(PGconn *conn)
+{
+	if (!canChangeResultMode(conn))
 		return 0;
 
-	/* OK, set flag */
+	/* OK, set flags */
+	conn->partialResMode = true;
 	conn->singleRowMode = true;
+	conn->maxChunkSize = 1;
+	return 1;
+}
+
+/*
+ * Select chunked results processing mode
+ *
+ * Rows are returned in PGRES_TUPLES_CHUNK results of at most chunkSize rows
+ * each, rather than all in one PGresult or one PGresult per row.
+ */
+int
+PQsetChunkedRowsMode(PGconn *conn, int chunkSize)
+{
+	if (chunkSize <= 0 || !canChangeResultMode(conn))
+		return 0;
+
+	/* OK, set flags */
+	conn->partialResMode = true;
+	conn->singleRowMode = false;
+	conn->maxChunkSize = chunkSize;
 	return 1;
 }
 
@@ -2130,6 +2166,19 @@ PQgetResult(PGconn *conn)
 
 		case PGASYNC_READY:
 
+			/*
+			 * In chunked-rows mode the last, not-full chunk is still pending
+			 * when the command completes.  Return it first, staying in READY
+			 * state; the next call returns the PGRES_TUPLES_OK result that is
+			 * restored from next_result, and proceeds as usual.
+			 */
+			if (conn->result &&
+				conn->result->resultStatus == PGRES_TUPLES_CHUNK)
+			{
+				res = pqPrepareAsyncResult(conn);
+				break;
+			}
+
 			/*
 			 * For any query type other than simple query protocol, we advance
 			 * the command queue here.  This is because for simple query
@@ -3102,10 +3151,12 @@ pqPipelineProcessQueue(PGconn *conn)
 	}
 
 	/*
-	 * Reset single-row processing mode.  (Client has to set it up for each
-	 * query, if desired.)
+	 * Reset single-row and chunked-rows processing modes.  (Client has to
+	 * set them up for each query, if desired.)
 	 */
+	conn->partialResMode = false;
 	conn->singleRowMode = false;
+	conn->maxChunkSize = 0;
 
 	/*
 	 * If there are no further commands to process in the queue, get us in
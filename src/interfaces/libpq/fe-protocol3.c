@@ -211,6 +211,10 @@ pqParseInput3(PGconn *conn)
 					if (conn->result)
 						strlcpy(conn->result->cmdStatus, conn->workBuffer.data,
 								CMDSTATUS_LEN);
+					/* a pending partial chunk is followed by its template */
+					if (conn->next_result)
+						strlcpy(conn->next_result->cmdStatus,
+								conn->workBuffer.data, CMDSTATUS_LEN);
 					conn->asyncStatus = PGASYNC_READY;
 					break;
 				case 'E':		/* error return */
@@ -370,7 +374,8 @@ pqParseInput3(PGconn *conn)
 					break;
 				case 'D':		/* Data Row */
 					if (conn->result != NULL &&
-						conn->result->resultStatus == PGRES_TUPLES_OK)
+						(conn->result->resultStatus == PGRES_TUPLES_OK ||
+						 conn->result->resultStatus == PGRES_TUPLES_CHUNK))
 					{
 						/* Read another tuple of a normal query response */
 						if (getAnotherTuple(conn, msgLength))
@@ -18,6 +18,31 @@
 
 #include "port/pg_crc32c.h"
 
+#ifdef __x86_64__
+
+/*
+ * Length of each of the three streams that large inputs are split into, see
+ * pg_comp_crc32c_sse42().  pg_crc32c_shift_table is computed for it.
+ */
+#define CRC32C_STREAM_LEN	256
+
+static const uint32 pg_crc32c_shift_table[4][256];
+
+/*
+ * Return the CRC register after feeding CRC32C_STREAM_LEN zero bytes into
+ * it, starting from 'crc'.  As that is linear in 'crc', it can be computed
+ * one byte of 'crc' at a time from a table.
+ */
+static inline pg_crc32c
+crc32c_shift(pg_crc32c crc)
+{
+	return pg_crc32c_shift_table[0][crc & 0xFF] ^
+		pg_crc32c_shift_table[1][(crc >> 8) & 0xFF] ^
+		pg_crc32c_shift_table[2][(crc >> 16) & 0xFF] ^
+		pg_crc32c_shift_table[3][crc >> 24];
+}
+#endif							/* __x86_64__ */
+
 pg_attribute_no_sanitize_alignment()
 pg_crc32c
 pg_comp_crc32c_sse42(pg_crc32c crc, const void *data, size_t len)
@@ -25,6 +50,38 @@ pg_comp_crc32c_sse42(pg_crc32c crc, const void *data, size_t len)
 	const unsigned char *p = data;
 	const unsigned char *pend = p + len;
 
+#ifdef __x86_64__
+
+	/*
+	 * The CRC32 instruction has a latency of several cycles but can start a
+	 * new one every cycle, so a single dependency chain leaves most of its
+	 * throughput unused.  For large inputs such as full-page images, compute
+	 * the CRCs of three consecutive chunks independently, in the same loop,
+	 * and then combine them: the CRC of the concatenation of chunks A and B
+	 * is the CRC of A advanced over len(B) zero bytes, XORed with the CRC of
+	 * B computed from zero.
+	 */
+	while (p + 3 * CRC32C_STREAM_LEN <= pend)
+	{
+		const unsigned char *p1 = p + CRC32C_STREAM_LEN;
+		const unsigned char *p2 = p1 + CRC32C_STREAM_LEN;
+		uint64		crc0 = crc;
+		uint64		crc1 = 0;
+		uint64		crc2 = 0;
+
+		for (int i = 0; i < CRC32C_STREAM_LEN; i += 8)
+		{
+			crc0 = _mm_crc32_u64(crc0, *((const uint64 *) (p + i)));
+			crc1 = _mm_crc32_u64(crc1, *((const uint64 *) (p1 + i)));
+			crc2 = _mm_crc32_u64(crc2, *((const uint64 *) (p2 + i)));
+		}
+
+		crc = crc32c_shift(crc32c_shift((uint32) crc0) ^ (uint32) crc1) ^
+			(uint32) crc2;
+		p += 3 * CRC32C_STREAM_LEN;
+	}
+#endif							/* __x86_64__ */
+
 	/*
 	 * Process eight bytes of data at a time.
 	 *
@@ -67,3 +124,278 @@ pg_comp_crc32c_sse42(pg_crc32c crc, const void *data, size_t len)
 
 	return crc;
 }
+
+#ifdef __x86_64__
+
+/*
+ * pg_crc32c_shift_table[k][b] is the CRC register obtained by feeding
+ * CRC32C_STREAM_LEN zero bytes into a register holding b << (8 * k), for the
+ * reflected Castagnoli polynomial used by the CRC32 instruction.
+ */
+static const uint32 pg_crc32c_shift_table[4][256] = {
+	{
+		0x00000000, 0xDCB17AA4, 0xBC8E83B9, 0x603FF91D,
+		0x7CF17183, 0xA0400B27, 0xC07FF23A, 0x1CCE889E,
+		0xF9E2E306, 0x255399A2, 0x456C60BF, 0x99DD1A1B,
+		0x85139285, 0x59A2E821, 0x399D113C, 0xE52C6B98,
+		0xF629B0FD, 0x2A98CA59, 0x4AA73344, 0x961649E0,
+		0x8AD8C17E, 0x5669BBDA, 0x365642C7, 0xEAE73863,
+		0x0FCB53FB, 0xD37A295F, 0xB345D042, 0x6FF4AAE6,
+		0x733A2278, 0xAF8B58DC, 0xCFB4A1C1, 0x1305DB65,
+		0xE9BF170B, 0x350E6DAF, 0x553194B2, 0x8980EE16,
+		0x954E6688, 0x49FF1C2C, 0x29C0E531, 0xF5719F95,
+		0x105DF40D, 0xCCEC8EA9, 0xACD377B4, 0x70620D10,
+		0x6CAC858E, 0xB01DFF2A, 0xD0220637, 0x0C937C93,
+		0x1F96A7F6, 0xC327DD52, 0xA318244F, 0x7FA95EEB,
+		0x6367D675, 0xBFD6ACD1, 0xDFE955CC, 0x03582F68,
+		0xE67444F0, 0x3AC53E54, 0x5AFAC749, 0x864BBDED,
+		0x9A853573, 0x46344FD7, 0x260BB6CA, 0xFABACC6E,
+		0xD69258E7, 0x0A232243, 0x6A1CDB5E, 0xB6ADA1FA,
+		0xAA632964, 0x76D253C0, 0x16EDAADD, 0xCA5CD079,
+		0x2F70BBE1, 0xF3C1C145, 0x93FE3858, 0x4F4F42FC,
+		0x5381CA62, 0x8F30B0C6, 0xEF0F49DB, 0x33BE337F,
+		0x20BBE81A, 0xFC0A92BE, 0x9C356BA3, 0x40841107,
+		0x5C4A9999, 0x80FBE33D, 0xE0C41A20, 0x3C756084,
+		0xD9590B1C, 0x05E871B8, 0x65D788A5, 0xB966F201,
+		0xA5A87A9F, 0x7919003B, 0x1926F926, 0xC5978382,
+		0x3F2D4FEC, 0xE39C3548, 0x83A3CC55, 0x5F12B6F1,
+		0x43DC3E6F, 0x9F6D44CB, 0xFF52BDD6, 0x23E3C772,
+		0xC6CFACEA, 0x1A7ED64E, 0x7A412F53, 0xA6F055F7,
+		0xBA3EDD69, 0x668FA7CD, 0x06B05ED0, 0xDA012474,
+		0xC904FF11, 0x15B585B5, 0x758A7CA8, 0xA93B060C,
+		0xB5F58E92, 0x6944F436, 0x097B0D2B, 0xD5CA778F,
+		0x30E61C17, 0xEC5766B3, 0x8C689FAE, 0x50D9E50A,
+		0x4C176D94, 0x90A61730, 0xF099EE2D, 0x2C289489,
+		0xA8C8C73F, 0x7479BD9B, 0x14464486, 0xC8F73E22,
+		0xD439B6BC, 0x0888CC18, 0x68B73505, 0xB4064FA1,
+		0x512A2439, 0x8D9B5E9D, 0xEDA4A780, 0x3115DD24,
+		0x2DDB55BA, 0xF16A2F1E, 0x9155D603, 0x4DE4ACA7,
+		0x5EE177C2, 0x82500D66, 0xE26FF47B, 0x3EDE8EDF,
+		0x22100641, 0xFEA17CE5, 0x9E9E85F8, 0x422FFF5C,
+		0xA70394C4, 0x7BB2EE60, 0x1B8D177D, 0xC73C6DD9,
+		0xDBF2E547, 0x07439FE3, 0x677C66FE, 0xBBCD1C5A,
+		0x4177D034, 0x9DC6AA90, 0xFDF9538D, 0x21482929,
+		0x3D86A1B7, 0xE137DB13, 0x8108220E, 0x5DB958AA,
+		0xB8953332, 0x64244996, 0x041BB08B, 0xD8AACA2F,
+		0xC46442B1, 0x18D53815, 0x78EAC108, 0xA45BBBAC,
+		0xB75E60C9, 0x6BEF1A6D, 0x0BD0E370, 0xD76199D4,
+		0xCBAF114A, 0x171E6BEE, 0x772192F3, 0xAB90E857,
+		0x4EBC83CF, 0x920DF96B, 0xF2320076, 0x2E837AD2,
+		0x324DF24C, 0xEEFC88E8, 0x8EC371F5, 0x52720B51,
+		0x7E5A9FD8, 0xA2EBE57C, 0xC2D41C61, 0x1E6566C5,
+		0x02ABEE5B, 0xDE1A94FF, 0xBE256DE2, 0x62941746,
+		0x87B87CDE, 0x5B09067A, 0x3B36FF67, 0xE78785C3,
+		0xFB490D5D, 0x27F877F9, 0x47C78EE4, 0x9B76F440,
+		0x88732F25, 0x54C25581, 0x34FDAC9C, 0xE84CD638,
+		0xF4825EA6, 0x28332402, 0x480CDD1F, 0x94BDA7BB,
+		0x7191CC23, 0xAD20B687, 0xCD1F4F9A, 0x11AE353E,
+		0x0D60BDA0, 0xD1D1C704, 0xB1EE3E19, 0x6D5F44BD,
+		0x97E588D3, 0x4B54F277, 0x2B6B0B6A, 0xF7DA71CE,
+		0xEB14F950, 0x37A583F4, 0x579A7AE9, 0x8B2B004D,
+		0x6E076BD5, 0xB2B61171, 0xD289E86C, 0x0E3892C8,
+		0x12F61A56, 0xCE4760F2, 0xAE7899EF, 0x72C9E34B,
+		0x61CC382E, 0xBD7D428A, 0xDD42BB97, 0x01F3C133,
+		0x1D3D49AD, 0xC18C3309, 0xA1B3CA14, 0x7D02B0B0,
+		0x982EDB28, 0x449FA18C, 0x24A05891, 0xF8112235,
+		0xE4DFAAAB, 0x386ED00F, 0x58512912, 0x84E053B6
+	},
+	{
+		0x00000000, 0x547DF88F, 0xA8FBF11E, 0xFC860991,
+		0x541B94CD, 0x00666C42, 0xFCE065D3, 0xA89D9D5C,
+		0xA837299A, 0xFC4AD115, 0x00CCD884, 0x54B1200B,
+		0xFC2CBD57, 0xA85145D8, 0x54D74C49, 0x00AAB4C6,
+		0x558225C5, 0x01FFDD4A, 0xFD79D4DB, 0xA9042C54,
+		0x0199B108, 0x55E44987, 0xA9624016, 0xFD1FB899,
+		0xFDB50C5F, 0xA9C8F4D0, 0x554EFD41, 0x013305CE,
+		0xA9AE9892, 0xFDD3601D, 0x0155698C, 0x55289103,
+		0xAB044B8A, 0xFF79B305, 0x03FFBA94, 0x5782421B,
+		0xFF1FDF47, 0xAB6227C8, 0x57E42E59, 0x0399D6D6,
+		0x03336210, 0x574E9A9F, 0xABC8930E, 0xFFB56B81,
+		0x5728F6DD, 0x03550E52, 0xFFD307C3, 0xABAEFF4C,
+		0xFE866E4F, 0xAAFB96C0, 0x567D9F51, 0x020067DE,
+		0xAA9DFA82, 0xFEE0020D, 0x02660B9C, 0x561BF313,
+		0x56B147D5, 0x02CCBF5A, 0xFE4AB6CB, 0xAA374E44,
+		0x02AAD318, 0x56D72B97, 0xAA512206, 0xFE2CDA89,
+		0x53E4E1E5, 0x0799196A, 0xFB1F10FB, 0xAF62E874,
+		0x07FF7528, 0x53828DA7, 0xAF048436, 0xFB797CB9,
+		0xFBD3C87F, 0xAFAE30F0, 0x53283961, 0x0755C1EE,
+		0xAFC85CB2, 0xFBB5A43D, 0x0733ADAC, 0x534E5523,
+		0x0666C420, 0x521B3CAF, 0xAE9D353E, 0xFAE0CDB1,
+		0x527D50ED, 0x0600A862, 0xFA86A1F3, 0xAEFB597C,
+		0xAE51EDBA, 0xFA2C1535, 0x06AA1CA4, 0x52D7E42B,
+		0xFA4A7977, 0xAE3781F8, 0x52B18869, 0x06CC70E6,
+		0xF8E0AA6F, 0xAC9D52E0, 0x501B5B71, 0x0466A3FE,
+		0xACFB3EA2, 0xF886C62D, 0x0400CFBC, 0x507D3733,
+		0x50D783F5, 0x04AA7B7A, 0xF82C72EB, 0xAC518A64,
+		0x04CC1738, 0x50B1EFB7, 0xAC37E626, 0xF84A1EA9,
+		0xAD628FAA, 0xF91F7725, 0x05997EB4, 0x51E4863B,
+		0xF9791B67, 0xAD04E3E8, 0x5182EA79, 0x05FF12F6,
+		0x0555A630, 0x51285EBF, 0xADAE572E, 0xF9D3AFA1,
+		0x514E32FD, 0x0533CA72, 0xF9B5C3E3, 0xADC83B6C,
+		0xA7C9C3CA, 0xF3B43B45, 0x0F3232D4, 0x5B4FCA5B,
+		0xF3D25707, 0xA7AFAF88, 0x5B29A619, 0x0F545E96,
+		0x0FFEEA50, 0x5B8312DF, 0xA7051B4E, 0xF378E3C1,
+		0x5BE57E9D, 0x0F988612, 0xF31E8F83, 0xA763770C,
+		0xF24BE60F, 0xA6361E80, 0x5AB01711, 0x0ECDEF9E,
+		0xA65072C2, 0xF22D8A4D, 0x0EAB83DC, 0x5AD67B53,
+		0x5A7CCF95, 0x0E01371A, 0xF2873E8B, 0xA6FAC604,
+		0x0E675B58, 0x5A1AA3D7, 0xA69CAA46, 0xF2E152C9,
+		0x0CCD8840, 0x58B070CF, 0xA436795E, 0xF04B81D1,
+		0x58D61C8D, 0x0CABE402, 0xF02DED93, 0xA450151C,
+		0xA4FAA1DA, 0xF0875955, 0x0C0150C4, 0x587CA84B,
+		0xF0E13517, 0xA49CCD98, 0x581AC409, 0x0C673C86,
+		0x594FAD85, 0x0D32550A, 0xF1B45C9B, 0xA5C9A414,
+		0x0D543948, 0x5929C1C7, 0xA5AFC856, 0xF1D230D9,
+		0xF178841F, 0xA5057C90, 0x59837501, 0x0DFE8D8E,
+		0xA56310D2, 0xF11EE85D, 0x0D98E1CC, 0x59E51943,
+		0xF42D222F, 0xA050DAA0, 0x5CD6D331, 0x08AB2BBE,
+		0xA036B6E2, 0xF44B4E6D, 0x08CD47FC, 0x5CB0BF73,
+		0x5C1A0BB5, 0x0867F33A, 0xF4E1FAAB, 0xA09C0224,
+		0x08019F78, 0x5C7C67F7, 0xA0FA6E66, 0xF48796E9,
+		0xA1AF07EA, 0xF5D2FF65, 0x0954F6F4, 0x5D290E7B,
+		0xF5B49327, 0xA1C96BA8, 0x5D4F6239, 0x09329AB6,
+		0x09982E70, 0x5DE5D6FF, 0xA163DF6E, 0xF51E27E1,
+		0x5D83BABD, 0x09FE4232, 0xF5784BA3, 0xA105B32C,
+		0x5F2969A5, 0x0B54912A, 0xF7D298BB, 0xA3AF6034,
+		0x0B32FD68, 0x5F4F05E7, 0xA3C90C76, 0xF7B4F4F9,
+		0xF71E403F, 0xA363B8B0, 0x5FE5B121, 0x0B9849AE,
+		0xA305D4F2, 0xF7782C7D, 0x0BFE25EC, 0x5F83DD63,
+		0x0AAB4C60, 0x5ED6B4EF, 0xA250BD7E, 0xF62D45F1,
+		0x5EB0D8AD, 0x0ACD2022, 0xF64B29B3, 0xA236D13C,
+		0xA29C65FA, 0xF6E19D75, 0x0A6794E4, 0x5E1A6C6B,
+		0xF687F137, 0xA2FA09B8, 0x5E7C0029, 0x0A01F8A6
+	},
+	{
+		0x00000000, 0x4A7FF165, 0x94FFE2CA, 0xDE8013AF,
+		0x2C13B365, 0x666C4200, 0xB8EC51AF, 0xF293A0CA,
+		0x582766CA, 0x125897AF, 0xCCD88400, 0x86A77565,
+		0x7434D5AF, 0x3E4B24CA, 0xE0CB3765, 0xAAB4C600,
+		0xB04ECD94, 0xFA313CF1, 0x24B12F5E, 0x6ECEDE3B,
+		0x9C5D7EF1, 0xD6228F94, 0x08A29C3B, 0x42DD6D5E,
+		0xE869AB5E, 0xA2165A3B, 0x7C964994, 0x36E9B8F1,
+		0xC47A183B, 0x8E05E95E, 0x5085FAF1, 0x1AFA0B94,
+		0x6571EDD9, 0x2F0E1CBC, 0xF18E0F13, 0xBBF1FE76,
+		0x49625EBC, 0x031DAFD9, 0xDD9DBC76, 0x97E24D13,
+		0x3D568B13, 0x77297A76, 0xA9A969D9, 0xE3D698BC,
+		0x11453876, 0x5B3AC913, 0x85BADABC, 0xCFC52BD9,
+		0xD53F204D, 0x9F40D128, 0x41C0C287, 0x0BBF33E2,
+		0xF92C9328, 0xB353624D, 0x6DD371E2, 0x27AC8087,
+		0x8D184687, 0xC767B7E2, 0x19E7A44D, 0x53985528,
+		0xA10BF5E2, 0xEB740487, 0x35F41728, 0x7F8BE64D,
+		0xCAE3DBB2, 0x809C2AD7, 0x5E1C3978, 0x1463C81D,
+		0xE6F068D7, 0xAC8F99B2, 0x720F8A1D, 0x38707B78,
+		0x92C4BD78, 0xD8BB4C1D, 0x063B5FB2, 0x4C44AED7,
+		0xBED70E1D, 0xF4A8FF78, 0x2A28ECD7, 0x60571DB2,
+		0x7AAD1626, 0x30D2E743, 0xEE52F4EC, 0xA42D0589,
+		0x56BEA543, 0x1CC15426, 0xC2414789, 0x883EB6EC,
+		0x228A70EC, 0x68F58189, 0xB6759226, 0xFC0A6343,
+		0x0E99C389, 0x44E632EC, 0x9A662143, 0xD019D026,
+		0xAF92366B, 0xE5EDC70E, 0x3B6DD4A1, 0x711225C4,
+		0x8381850E, 0xC9FE746B, 0x177E67C4, 0x5D0196A1,
+		0xF7B550A1, 0xBDCAA1C4, 0x634AB26B, 0x2935430E,
+		0xDBA6E3C4, 0x91D912A1, 0x4F59010E, 0x0526F06B,
+		0x1FDCFBFF, 0x55A30A9A, 0x8B231935, 0xC15CE850,
+		0x33CF489A, 0x79B0B9FF, 0xA730AA50, 0xED4F5B35,
+		0x47FB9D35, 0x0D846C50, 0xD3047FFF, 0x997B8E9A,
+		0x6BE82E50, 0x2197DF35, 0xFF17CC9A, 0xB5683DFF,
+		0x902BC195, 0xDA5430F0, 0x04D4235F, 0x4EABD23A,
+		0xBC3872F0, 0xF6478395, 0x28C7903A, 0x62B8615F,
+		0xC80CA75F, 0x8273563A, 0x5CF34595, 0x168CB4F0,
+		0xE41F143A, 0xAE60E55F, 0x70E0F6F0, 0x3A9F0795,
+		0x20650C01, 0x6A1AFD64, 0xB49AEECB, 0xFEE51FAE,
+		0x0C76BF64, 0x46094E01, 0x98895DAE, 0xD2F6ACCB,
+		0x78426ACB, 0x323D9BAE, 0xECBD8801, 0xA6C27964,
+		0x5451D9AE, 0x1E2E28CB, 0xC0AE3B64, 0x8AD1CA01,
+		0xF55A2C4C, 0xBF25DD29, 0x61A5CE86, 0x2BDA3FE3,
+		0xD9499F29, 0x93366E4C, 0x4DB67DE3, 0x07C98C86,
+		0xAD7D4A86, 0xE702BBE3, 0x3982A84C, 0x73FD5929,
+		0x816EF9E3, 0xCB110886, 0x15911B29, 0x5FEEEA4C,
+		0x4514E1D8, 0x0F6B10BD, 0xD1EB0312, 0x9B94F277,
+		0x690752BD, 0x2378A3D8, 0xFDF8B077, 0xB7874112,
+		0x1D338712, 0x574C7677, 0x89CC65D8, 0xC3B394BD,
+		0x31203477, 0x7B5FC512, 0xA5DFD6BD, 0xEFA027D8,
+		0x5AC81A27, 0x10B7EB42, 0xCE37F8ED, 0x84480988,
+		0x76DBA942, 0x3CA45827, 0xE2244B88, 0xA85BBAED,
+		0x02EF7CED, 0x48908D88, 0x96109E27, 0xDC6F6F42,
+		0x2EFCCF88, 0x64833EED, 0xBA032D42, 0xF07CDC27,
+		0xEA86D7B3, 0xA0F926D6, 0x7E793579, 0x3406C41C,
+		0xC69564D6, 0x8CEA95B3, 0x526A861C, 0x18157779,
+		0xB2A1B179, 0xF8DE401C, 0x265E53B3, 0x6C21A2D6,
+		0x9EB2021C, 0xD4CDF379, 0x0A4DE0D6, 0x403211B3,
+		0x3FB9F7FE, 0x75C6069B, 0xAB461534, 0xE139E451,
+		0x13AA449B, 0x59D5B5FE, 0x8755A651, 0xCD2A5734,
+		0x679E9134, 0x2DE16051, 0xF36173FE, 0xB91E829B,
+		0x4B8D2251, 0x01F2D334, 0xDF72C09B, 0x950D31FE,
+		0x8FF73A6A, 0xC588CB0F, 0x1B08D8A0, 0x517729C5,
+		0xA3E4890F, 0xE99B786A, 0x371B6BC5, 0x7D649AA0,
+		0xD7D05CA0, 0x9DAFADC5, 0x432FBE6A, 0x09504F0F,
+		0xFBC3EFC5, 0xB1BC1EA0, 0x6F3C0D0F, 0x2543FC6A
+	},
+	{
+		0x00000000, 0x25BBF5DB, 0x4B77EBB6, 0x6ECC1E6D,
+		0x96EFD76C, 0xB35422B7, 0xDD983CDA, 0xF823C901,
+		0x2833D829, 0x0D882DF2, 0x6344339F, 0x46FFC644,
+		0xBEDC0F45, 0x9B67FA9E, 0xF5ABE4F3, 0xD0101128,
+		0x5067B052, 0x75DC4589, 0x1B105BE4, 0x3EABAE3F,
+		0xC688673E, 0xE33392E5, 0x8DFF8C88, 0xA8447953,
+		0x7854687B, 0x5DEF9DA0, 0x332383CD, 0x16987616,
+		0xEEBBBF17, 0xCB004ACC, 0xA5CC54A1, 0x8077A17A,
+		0xA0CF60A4, 0x8574957F, 0xEBB88B12, 0xCE037EC9,
+		0x3620B7C8, 0x139B4213, 0x7D575C7E, 0x58ECA9A5,
+		0x88FCB88D, 0xAD474D56, 0xC38B533B, 0xE630A6E0,
+		0x1E136FE1, 0x3BA89A3A, 0x55648457, 0x70DF718C,
+		0xF0A8D0F6, 0xD513252D, 0xBBDF3B40, 0x9E64CE9B,
+		0x6647079A, 0x43FCF241, 0x2D30EC2C, 0x088B19F7,
+		0xD89B08DF, 0xFD20FD04, 0x93ECE369, 0xB65716B2,
+		0x4E74DFB3, 0x6BCF2A68, 0x05033405, 0x20B8C1DE,
+		0x4472B7B9, 0x61C94262, 0x0F055C0F, 0x2ABEA9D4,
+		0xD29D60D5, 0xF726950E, 0x99EA8B63, 0xBC517EB8,
+		0x6C416F90, 0x49FA9A4B, 0x27368426, 0x028D71FD,
+		0xFAAEB8FC, 0xDF154D27, 0xB1D9534A, 0x9462A691,
+		0x141507EB, 0x31AEF230, 0x5F62EC5D, 0x7AD91986,
+		0x82FAD087, 0xA741255C, 0xC98D3B31, 0xEC36CEEA,
+		0x3C26DFC2, 0x199D2A19, 0x77513474, 0x52EAC1AF,
+		0xAAC908AE, 0x8F72FD75, 0xE1BEE318, 0xC40516C3,
+		0xE4BDD71D, 0xC10622C6, 0xAFCA3CAB, 0x8A71C970,
+		0x72520071, 0x57E9F5AA, 0x3925EBC7, 0x1C9E1E1C,
+		0xCC8E0F34, 0xE935FAEF, 0x87F9E482, 0xA2421159,
+		0x5A61D858, 0x7FDA2D83, 0x111633EE, 0x34ADC635,
+		0xB4DA674F, 0x91619294, 0xFFAD8CF9, 0xDA167922,
+		0x2235B023, 0x078E45F8, 0x69425B95, 0x4CF9AE4E,
+		0x9CE9BF66, 0xB9524ABD, 0xD79E54D0, 0xF225A10B,
+		0x0A06680A, 0x2FBD9DD1, 0x417183BC, 0x64CA7667,
+		0x88E56F72, 0xAD5E9AA9, 0xC39284C4, 0xE629711F,
+		0x1E0AB81E, 0x3BB14DC5, 0x557D53A8, 0x70C6A673,
+		0xA0D6B75B, 0x856D4280, 0xEBA15CED, 0xCE1AA936,
+		0x36396037, 0x138295EC, 0x7D4E8B81, 0x58F57E5A,
+		0xD882DF20, 0xFD392AFB, 0x93F53496, 0xB64EC14D,
+		0x4E6D084C, 0x6BD6FD97, 0x051AE3FA, 0x20A11621,
+		0xF0B10709, 0xD50AF2D2, 0xBBC6ECBF, 0x9E7D1964,
+		0x665ED065, 0x43E525BE, 0x2D293BD3, 0x0892CE08,
+		0x282A0FD6, 0x0D91FA0D, 0x635DE460, 0x46E611BB,
+		0xBEC5D8BA, 0x9B7E2D61, 0xF5B2330C, 0xD009C6D7,
+		0x0019D7FF, 0x25A22224, 0x4B6E3C49, 0x6ED5C992,
+		0x96F60093, 0xB34DF548, 0xDD81EB25, 0xF83A1EFE,
+		0x784DBF84, 0x5DF64A5F, 0x333A5432, 0x1681A1E9,
+		0xEEA268E8, 0xCB199D33, 0xA5D5835E, 0x806E7685,
+		0x507E67AD, 0x75C59276, 0x1B098C1B, 0x3EB279C0,
+		0xC691B0C1, 0xE32A451A, 0x8DE65B77, 0xA85DAEAC,
+		0xCC97D8CB, 0xE92C2D10, 0x87E0337D, 0xA25BC6A6,
+		0x5A780FA7, 0x7FC3FA7C, 0x110FE411, 0x34B411CA,
+		0xE4A400E2, 0xC11FF539, 0xAFD3EB54, 0x8A681E8F,
+		0x724BD78E, 0x57F02255, 0x393C3C38, 0x1C87C9E3,
+		0x9CF06899, 0xB94B9D42, 0xD787832F, 0xF23C76F4,
+		0x0A1FBFF5, 0x2FA44A2E, 0x41685443, 0x64D3A198,
+		0xB4C3B0B0, 0x9178456B, 0xFFB45B06, 0xDA0FAEDD,
+		0x222C67DC, 0x07979207, 0x695B8C6A, 0x4CE079B1,
+		0x6C58B86F, 0x49E34DB4, 0x272F53D9, 0x0294A602,
+		0xFAB76F03, 0xDF0C9AD8, 0xB1C084B5, 0x947B716E,
+		0x446B6046, 0x61D0959D, 0x0F1C8BF0, 0x2AA77E2B,
+		0xD284B72A, 0xF73F42F1, 0x99F35C9C, 0xBC48A947,
+		0x3C3F083D, 0x1984FDE6, 0x7748E38B, 0x52F31650,
+		0xAAD0DF51, 0x8F6B2A8A, 0xE1A734E7, 0xC41CC13C,
+		0x140CD014, 0x31B725CF, 0x5F7B3BA2, 0x7AC0CE79,
+		0x82E30778, 0xA758F2A3, 0xC994ECCE, 0xEC2F1915
+	}
+};
+#endif							/* __x86_64__ */
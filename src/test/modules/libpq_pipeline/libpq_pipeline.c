@@ -1159,7 +1159,10 @@ test_singlerowmode(PGconn *conn)
 		pg_fatal("failed to enter pipeline mode: %s",
 				 PQerrorMessage(conn));
 
-	/* One series of three commands, using single-row mode for the first two. */
+	/*
+	 * One series of three commands, using single-row mode for the first one
+	 * and chunked-rows mode for the second.
+	 */
 	for (i = 0; i < 3; i++)
 	{
 		char	   *param[1];
@@ -1186,13 +1189,19 @@ test_singlerowmode(PGconn *conn)
 		bool		first = true;
 		bool		saw_ending_tuplesok;
 		bool		isSingleTuple = false;
+		bool		isTuplesChunk = false;
 
-		/* Set single row mode for only first 2 SELECT queries */
-		if (i < 2)
+		/* Set single row mode for the first query, chunked for the second */
+		if (i == 0)
 		{
 			if (PQsetSingleRowMode(conn) != 1)
 				pg_fatal("PQsetSingleRowMode() failed for i=%d", i);
 		}
+		else if (i == 1)
+		{
+			if (PQsetChunkedRowsMode(conn, 3) != 1)
+				pg_fatal("PQsetChunkedRowsMode() failed for i=%d", i);
+		}
 
 		/* Consume rows for this query */
 		saw_ending_tuplesok = false;
@@ -1210,12 +1219,18 @@ test_singlerowmode(PGconn *conn)
 				break;
 			}
 
-			/* Expect SINGLE_TUPLE for queries 0 and 1, TUPLES_OK for 2 */
+			/*
+			 * Expect SINGLE_TUPLE for query 0, TUPLES_CHUNK for query 1,
+			 * TUPLES_OK for 2
+			 */
 			if (first)
 			{
-				if (i <= 1 && est != PGRES_SINGLE_TUPLE)
+				if (i == 0 && est != PGRES_SINGLE_TUPLE)
 					pg_fatal("Expected PGRES_SINGLE_TUPLE for query %d, got %s",
 							 i, PQresStatus(est));
+				if (i == 1 && est != PGRES_TUPLES_CHUNK)
+					pg_fatal("Expected PGRES_TUPLES_CHUNK for query %d, got %s",
+							 i, PQresStatus(est));
 				if (i >= 2 && est != PGRES_TUPLES_OK)
 					pg_fatal("Expected PGRES_TUPLES_OK for query %d, got %s",
 							 i, PQresStatus(est));
@@ -1228,12 +1243,12 @@ test_singlerowmode(PGconn *conn)
 				case PGRES_TUPLES_OK:
 					fprintf(stderr, ", tuples: %d\n", PQntuples(res));
 					saw_ending_tuplesok = true;
-					if (isSingleTuple)
+					if (isSingleTuple || isTuplesChunk)
 					{
 						if (PQntuples(res) == 0)
 							fprintf(stderr, "all tuples received in query %d\n", i);
 						else
-							pg_fatal("Expected to follow PGRES_SINGLE_TUPLE, but received PGRES_TUPLES_OK directly instead");
+							pg_fatal("Expected to follow PGRES_SINGLE_TUPLE or PGRES_TUPLES_CHUNK, but received PGRES_TUPLES_OK directly instead");
 					}
 					break;
 
@@ -1242,6 +1257,15 @@ test_singlerowmode(PGconn *conn)
 					fprintf(stderr, ", %d tuple: %s\n", PQntuples(res), PQgetvalue(res, 0, 0));
 					break;
 
+				case PGRES_TUPLES_CHUNK:
+					/* query 1 returns four rows, in chunks of three and one */
+					if (PQntuples(res) != (isTuplesChunk ? 1 : 3))
+						pg_fatal("Expected %d tuples in chunk of query %d, got %d",
+								 isTuplesChunk ? 1 : 3, i, PQntuples(res));
+					isTuplesChunk = true;
+					fprintf(stderr, ", %d tuples: %s\n", PQntuples(res), PQgetvalue(res, 0, 0));
+					break;
+
 				default:
 					pg_fatal("unexpected");
 			}
@@ -0,0 +1,45 @@
+CREATE EXTENSION test_dsa;
+
+-- An area that can't grow beyond its first segment, so that the number of
+-- objects that fit in it doesn't change as long as none are leaked
+SELECT test_dsa_create(1024 * 1024) AS handle \gset
+
+-- Fill it up with small and then with large objects, and empty it again
+SELECT test_dsa_allocate(256) AS objects \gset
+SELECT test_dsa_free(:'objects') AS nobjects \gset
+SELECT :nobjects > 1000 AS ok;
+SELECT test_dsa_trim();
+SELECT test_dsa_allocate(2048) AS objects \gset
+SELECT test_dsa_free(:'objects') AS nlarge \gset
+SELECT test_dsa_trim();
+
+-- With caching, small objects are taken from the cache, which is refilled
+-- from the shared pool and overflows back into it; just as many fit
+SELECT test_dsa_enable_cache();
+SELECT test_dsa_allocate(256) AS objects \gset
+SELECT test_dsa_free(:'objects') = :nobjects AS ok;
+SELECT test_dsa_allocate(256) AS objects \gset
+SELECT test_dsa_free(:'objects') = :nobjects AS ok;
+
+-- dsa_trim hands back the cached objects, so just as many large objects fit
+SELECT test_dsa_trim();
+SELECT test_dsa_allocate(2048) AS objects \gset
+SELECT test_dsa_free(:'objects') = :nlarge AS ok;
+SELECT test_dsa_trim();
+
+-- Objects allocated by one backend can be freed by another one that caches
+-- them, and dsa_detach hands them all back
+SELECT test_dsa_allocate(256) AS objects \gset
+SELECT test_dsa_detach();
+\c
+SELECT test_dsa_attach(:handle);
+SELECT test_dsa_enable_cache();
+SELECT test_dsa_free(:'objects') = :nobjects AS ok;
+SELECT test_dsa_detach();
+\c
+SELECT test_dsa_attach(:handle);
+SELECT test_dsa_trim();
+SELECT test_dsa_allocate(256) AS objects \gset
+SELECT test_dsa_free(:'objects') = :nobjects AS ok;
+
+SELECT test_dsa_destroy();
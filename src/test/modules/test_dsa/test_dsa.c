@@ -0,0 +1,213 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_dsa.c
+ *		Test allocation and freeing of objects in a DSA area, with and
+ *		without the backend-local object caches.
+ *
+ * The area is created once and pinned, so that it outlives the backend that
+ * created it; other backends attach to it by handle.  Each backend keeps its
+ * own attachment across calls until test_dsa_detach or test_dsa_destroy.
+ *
+ * Copyright (c) 2022, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_dsa/test_dsa.c
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "catalog/pg_type.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+#include "storage/lwlock.h"
+#include "utils/array.h"
+#include "utils/dsa.h"
+#include "utils/memutils.h"
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(test_dsa_create);
+PG_FUNCTION_INFO_V1(test_dsa_attach);
+PG_FUNCTION_INFO_V1(test_dsa_enable_cache);
+PG_FUNCTION_INFO_V1(test_dsa_allocate);
+PG_FUNCTION_INFO_V1(test_dsa_free);
+PG_FUNCTION_INFO_V1(test_dsa_trim);
+PG_FUNCTION_INFO_V1(test_dsa_detach);
+PG_FUNCTION_INFO_V1(test_dsa_destroy);
+
+/* This backend's attachment to the test area, if any */
+static dsa_area *test_area = NULL;
+
+static dsa_area *
+get_test_area(void)
+{
+	if (test_area == NULL)
+		elog(ERROR, "not attached to a test DSA area");
+	return test_area;
+}
+
+/*
+ * Create a new area that is at most 'size_limit' bytes large, and leave this
+ * backend attached to it.  Returns the area's handle.
+ */
+Datum
+test_dsa_create(PG_FUNCTION_ARGS)
+{
+	int64		size_limit = PG_GETARG_INT64(0);
+	MemoryContext oldcontext;
+	int			tranche_id;
+
+	if (test_area != NULL)
+		elog(ERROR, "already attached to a test DSA area");
+
+	tranche_id = LWLockNewTrancheId();
+	LWLockRegisterTranche(tranche_id, "test_dsa");
+
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+	test_area = dsa_create(tranche_id);
+	MemoryContextSwitchTo(oldcontext);
+
+	dsa_pin(test_area);
+	dsa_pin_mapping(test_area);
+	dsa_set_size_limit(test_area, size_limit);
+
+	PG_RETURN_INT64((int64) dsa_get_handle(test_area));
+}
+
+Datum
+test_dsa_attach(PG_FUNCTION_ARGS)
+{
+	dsa_handle	handle = (dsa_handle) PG_GETARG_INT64(0);
+	MemoryContext oldcontext;
+
+	if (test_area != NULL)
+		elog(ERROR, "already attached to a test DSA area");
+
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+	test_area = dsa_attach(handle);
+	MemoryContextSwitchTo(oldcontext);
+
+	dsa_pin_mapping(test_area);
+
+	PG_RETURN_VOID();
+}
+
+Datum
+test_dsa_enable_cache(PG_FUNCTION_ARGS)
+{
+	dsa_enable_cache(get_test_area());
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * Allocate objects of the given size until the area is full.  Returns the
+ * dsa_pointers of all of them.
+ */
+Datum
+test_dsa_allocate(PG_FUNCTION_ARGS)
+{
+	int32		size = PG_GETARG_INT32(0);
+	dsa_area   *area = get_test_area();
+	Datum	   *objects;
+	int			nobjects = 0;
+	int			maxobjects = 1024;
+
+	/* each object starts with its position in the result */
+	if (size < (int32) sizeof(int32))
+		elog(ERROR, "invalid object size %d", size);
+
+	objects = palloc(sizeof(Datum) * maxobjects);
+	for (;;)
+	{
+		dsa_pointer dp;
+
+		CHECK_FOR_INTERRUPTS();
+
+		dp = dsa_allocate_extended(area, size, DSA_ALLOC_NO_OOM);
+		if (!DsaPointerIsValid(dp))
+			break;
+
+		if (nobjects == maxobjects)
+		{
+			maxobjects *= 2;
+			objects = repalloc(objects, sizeof(Datum) * maxobjects);
+		}
+		*(int32 *) dsa_get_address(area, dp) = nobjects;
+		objects[nobjects++] = Int64GetDatum((int64) dp);
+	}
+
+	if (nobjects == 0)
+		elog(ERROR, "could not allocate any objects of size %d", size);
+
+	PG_RETURN_ARRAYTYPE_P(construct_array(objects, nobjects, INT8OID,
+										  sizeof(int64), FLOAT8PASSBYVAL,
+										  TYPALIGN_DOUBLE));
+}
+
+/*
+ * Check that the given objects still hold what test_dsa_allocate put there,
+ * which would not be the case for an object handed out twice, and free them
+ * in reverse order of allocation.  Returns the number of objects freed.
+ */
+Datum
+test_dsa_free(PG_FUNCTION_ARGS)
+{
+	ArrayType  *array = PG_GETARG_ARRAYTYPE_P(0);
+	dsa_area   *area = get_test_area();
+	Datum	   *objects;
+	int			nobjects;
+	int			i;
+
+	deconstruct_array(array, INT8OID, sizeof(int64), FLOAT8PASSBYVAL,
+					  TYPALIGN_DOUBLE, &objects, NULL, &nobjects);
+
+	for (i = nobjects - 1; i >= 0; i--)
+	{
+		dsa_pointer dp = (dsa_pointer) DatumGetInt64(objects[i]);
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (*(int32 *) dsa_get_address(area, dp) != i)
+			elog(ERROR, "object " DSA_POINTER_FORMAT " was overwritten",
+				 dp);
+
+		dsa_free(area, dp);
+	}
+
+	PG_RETURN_INT32(nobjects);
+}
+
+Datum
+test_dsa_trim(PG_FUNCTION_ARGS)
+{
+	dsa_trim(get_test_area());
+
+	PG_RETURN_VOID();
+}
+
+Datum
+test_dsa_detach(PG_FUNCTION_ARGS)
+{
+	dsa_detach(get_test_area());
+	test_area = NULL;
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * Unpin the area and detach from it, which destroys it unless some other
+ * backend is still attached.
+ */
+Datum
+test_dsa_destroy(PG_FUNCTION_ARGS)
+{
+	dsa_area   *area = get_test_area();
+
+	dsa_unpin(area);
+	dsa_detach(area);
+	test_area = NULL;
+
+	PG_RETURN_VOID();
+}
@@ -0,0 +1,48 @@
+--
+-- Run all micro-benchmarks, record the results, and compare them with the
+-- previous run recorded in this database.  Invoked by "make bench", which
+-- sets the loops and repeats variables.
+--
+\set QUIET on
+CREATE EXTENSION IF NOT EXISTS test_microbench;
+CREATE TABLE IF NOT EXISTS microbench_history (
+	run_id int8 NOT NULL,
+	run_at timestamptz NOT NULL DEFAULT now(),
+	benchmark text NOT NULL,
+	loops int8 NOT NULL,
+	ns_per_op float8 NOT NULL,
+	cycles_per_op float8,
+	cache_misses_per_op float8
+);
+\set QUIET off
+
+INSERT INTO microbench_history (run_id, benchmark, loops, ns_per_op,
+								cycles_per_op, cache_misses_per_op)
+SELECT coalesce((SELECT max(run_id) FROM microbench_history), 0) + 1, m.*
+  FROM microbench(NULL, :loops, :repeats) m;
+
+--
+-- Flag benchmarks that got more than 10% slower than in the previous run.
+-- Cycle counts are used when available, since they don't depend on the
+-- clock frequency.
+--
+WITH runs AS (
+	SELECT DISTINCT run_id FROM microbench_history ORDER BY run_id DESC LIMIT 2
+), cur AS (
+	SELECT * FROM microbench_history WHERE run_id = (SELECT max(run_id) FROM runs)
+), prev AS (
+	SELECT * FROM microbench_history
+	 WHERE run_id = (SELECT min(run_id) FROM runs)
+	   AND run_id <> (SELECT max(run_id) FROM runs)
+)
+SELECT cur.benchmark,
+	   round(cur.ns_per_op::numeric, 2) AS ns_per_op,
+	   round(cur.cycles_per_op::numeric, 1) AS cycles_per_op,
+	   round(cur.cache_misses_per_op::numeric, 3) AS cache_misses_per_op,
+	   round((coalesce(cur.cycles_per_op / prev.cycles_per_op,
+					   cur.ns_per_op / prev.ns_per_op))::numeric, 3) AS ratio,
+	   CASE WHEN coalesce(cur.cycles_per_op / prev.cycles_per_op,
+						  cur.ns_per_op / prev.ns_per_op) > 1.10
+			THEN 'REGRESSION' ELSE '' END AS status
+  FROM cur LEFT JOIN prev USING (benchmark)
+ ORDER BY cur.benchmark;
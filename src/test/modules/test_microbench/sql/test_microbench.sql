@@ -0,0 +1,16 @@
+CREATE EXTENSION test_microbench;
+
+--
+-- Timings vary from run to run, so only check that every benchmark runs
+-- and reports sane values.  Hardware counters may not be available.
+--
+SELECT benchmark, loops, ns_per_op > 0 AS timed,
+       coalesce(cycles_per_op >= 0, true) AS cycles_ok,
+       coalesce(cache_misses_per_op >= 0, true) AS cache_misses_ok
+  FROM microbench(NULL, 10, 1);
+
+SELECT benchmark, loops FROM microbench('tuplesort', 1000, 2);
+
+-- Error cases
+SELECT * FROM microbench('no_such_benchmark');
+SELECT * FROM microbench('expr', 0);
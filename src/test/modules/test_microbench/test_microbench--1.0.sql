@@ -0,0 +1,18 @@
+/* src/test/modules/test_microbench/test_microbench--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_microbench" to load this file. \quit
+
+--
+-- Run the named benchmark, or all of them if name is NULL.
+--
+CREATE FUNCTION microbench(name text DEFAULT NULL,
+						   nloops int8 DEFAULT 100000,
+						   nrepeats int4 DEFAULT 5,
+						   OUT benchmark text,
+						   OUT loops int8,
+						   OUT ns_per_op float8,
+						   OUT cycles_per_op float8,
+						   OUT cache_misses_per_op float8)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME' LANGUAGE C;
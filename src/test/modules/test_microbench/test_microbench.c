@@ -0,0 +1,509 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_microbench.c
+ *		Micro-benchmarks for backend hot paths.
+ *
+ * Each benchmark exercises one code path in a tight loop, with all setup
+ * done outside of the timed region, and with inputs that are the same on
+ * every run.  A benchmark is run once to warm up caches, and then 'repeats'
+ * times; the fastest of those runs is reported, which is much less noisy than
+ * the mean.  Where the kernel allows it, CPU cycles and cache misses spent in
+ * user space are counted with Linux perf events and reported alongside the
+ * elapsed time.
+ *
+ * Copyright (c) 2022, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_microbench/test_microbench.c
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "access/table.h"
+#include "access/xlog.h"
+#include "catalog/pg_class.h"
+#include "catalog/pg_operator.h"
+#include "catalog/pg_type.h"
+#include "common/pg_prng.h"
+#include "executor/executor.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "nodes/makefuncs.h"
+#include "portability/instr_time.h"
+#include "replication/message.h"
+#include "storage/bufmgr.h"
+#include "utils/builtins.h"
+#include "utils/fmgroids.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+#include "utils/tuplesort.h"
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(microbench);
+
+/* Size of the payload of each WAL record written by the xlog_insert test */
+#define XLOG_PAYLOAD_SIZE	64
+
+/* Seed for the pseudo-random input of the tuplesort test */
+#define TUPLESORT_SEED		UINT64CONST(0x5eed5eed5eed5eed)
+
+/* Maximum number of values sorted at a time by the tuplesort test */
+#define TUPLESORT_MAX_VALUES	(1024 * 1024)
+
+/* State shared by the setup, run and teardown callbacks of a benchmark */
+typedef struct MicroBenchState
+{
+	int64		loops;
+	ExprContext *econtext;
+	ExprState  *exprstate;
+	Relation	rel;
+	Datum	   *values;
+	int			nvalues;
+	char		payload[XLOG_PAYLOAD_SIZE];
+} MicroBenchState;
+
+typedef struct MicroBench
+{
+	const char *name;
+	void		(*setup) (MicroBenchState *state);
+	void		(*run) (MicroBenchState *state);
+	void		(*teardown) (MicroBenchState *state);
+} MicroBench;
+
+/* Hardware counters, or -1 if they couldn't be opened */
+typedef struct PerfCounters
+{
+	int			cycles_fd;
+	int			cache_misses_fd;
+} PerfCounters;
+
+static void expr_setup(MicroBenchState *state);
+static void expr_run(MicroBenchState *state);
+static void expr_teardown(MicroBenchState *state);
+static void bufmgr_setup(MicroBenchState *state);
+static void bufmgr_hit_run(MicroBenchState *state);
+static void last_written_lsn_run(MicroBenchState *state);
+static void bufmgr_teardown(MicroBenchState *state);
+static void xlog_insert_run(MicroBenchState *state);
+static void tuplesort_setup(MicroBenchState *state);
+static void tuplesort_run(MicroBenchState *state);
+static void tuplesort_teardown(MicroBenchState *state);
+static void snapshot_run(MicroBenchState *state);
+
+static const MicroBench benchmarks[] = {
+	/* ExecInterpExpr: evaluate (1 + 2) > 0 */
+	{"expr", expr_setup, expr_run, expr_teardown},
+	/* ReadBuffer_common: pin and unpin a page that is in shared buffers */
+	{"bufmgr_hit", bufmgr_setup, bufmgr_hit_run, bufmgr_teardown},
+	/* XLogInsert: write a small non-transactional logical message */
+	{"xlog_insert", NULL, xlog_insert_run, NULL},
+	/* tuplesort: in-memory sorts of int4 datums, one loop per datum */
+	{"tuplesort", tuplesort_setup, tuplesort_run, tuplesort_teardown},
+	/* GetSnapshotData: retake a snapshot, with no commits in between */
+	{"snapshot", NULL, snapshot_run, NULL},
+	/* GetLastWrittenLSN: look up the last written LSN of a page */
+	{"last_written_lsn", bufmgr_setup, last_written_lsn_run, bufmgr_teardown}
+};
+
+static void run_benchmark(const MicroBench *bench, int64 loops, int repeats,
+						  PerfCounters *counters, Tuplestorestate *tupstore,
+						  TupleDesc tupdesc);
+static void perf_counters_open(PerfCounters *counters);
+static void perf_counters_close(PerfCounters *counters);
+static void perf_counters_start(PerfCounters *counters);
+static void perf_counters_stop(PerfCounters *counters, int64 *cycles,
+							   int64 *cache_misses);
+
+/*
+ * SQL-callable entry point.  Runs the benchmark of the given name, or all of
+ * them if the name is NULL, and returns one row per benchmark.
+ */
+Datum
+microbench(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	char	   *name = NULL;
+	int64		loops;
+	int32		repeats;
+	PerfCounters counters;
+	volatile bool found = false;
+
+	if (PG_ARGISNULL(1) || PG_ARGISNULL(2))
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("loop and repeat counts must not be null")));
+	if (!PG_ARGISNULL(0))
+		name = text_to_cstring(PG_GETARG_TEXT_PP(0));
+	loops = PG_GETARG_INT64(1);
+	repeats = PG_GETARG_INT32(2);
+	if (loops <= 0 || repeats <= 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("loop and repeat counts must be positive")));
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	perf_counters_open(&counters);
+
+	PG_TRY();
+	{
+		for (int i = 0; i < lengthof(benchmarks); i++)
+		{
+			if (name != NULL && strcmp(name, benchmarks[i].name) != 0)
+				continue;
+
+			run_benchmark(&benchmarks[i], loops, repeats, &counters,
+						  rsinfo->setResult, rsinfo->setDesc);
+			found = true;
+		}
+	}
+	PG_FINALLY();
+	{
+		perf_counters_close(&counters);
+	}
+	PG_END_TRY();
+
+	if (!found)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("unrecognized benchmark \"%s\"", name)));
+
+	return (Datum) 0;
+}
+
+/*
+ * Run one benchmark, and add a row with the results of its fastest run to
+ * the tuplestore.
+ */
+static void
+run_benchmark(const MicroBench *bench, int64 loops, int repeats,
+			  PerfCounters *counters, Tuplestorestate *tupstore,
+			  TupleDesc tupdesc)
+{
+	MicroBenchState state;
+	double		best_ns = -1;
+	int64		best_cycles = -1;
+	int64		best_cache_misses = -1;
+	Datum		values[5];
+	bool		nulls[5];
+
+	memset(&state, 0, sizeof(state));
+	state.loops = loops;
+	if (bench->setup)
+		bench->setup(&state);
+
+	/* The first run only warms up caches, and isn't measured. */
+	bench->run(&state);
+
+	for (int i = 0; i < repeats; i++)
+	{
+		instr_time	start;
+		instr_time	duration;
+		int64		cycles;
+		int64		cache_misses;
+		double		ns;
+
+		CHECK_FOR_INTERRUPTS();
+
+		perf_counters_start(counters);
+		INSTR_TIME_SET_CURRENT(start);
+		bench->run(&state);
+		INSTR_TIME_SET_CURRENT(duration);
+		perf_counters_stop(counters, &cycles, &cache_misses);
+		INSTR_TIME_SUBTRACT(duration, start);
+
+		ns = INSTR_TIME_GET_DOUBLE(duration) * 1000000000.0;
+		if (best_ns < 0 || ns < best_ns)
+		{
+			best_ns = ns;
+			best_cycles = cycles;
+			best_cache_misses = cache_misses;
+		}
+	}
+
+	if (bench->teardown)
+		bench->teardown(&state);
+
+	memset(nulls, 0, sizeof(nulls));
+	values[0] = CStringGetTextDatum(bench->name);
+	values[1] = Int64GetDatum(loops);
+	values[2] = Float8GetDatum(best_ns / loops);
+	if (best_cycles >= 0)
+		values[3] = Float8GetDatum((double) best_cycles / loops);
+	else
+		nulls[3] = true;
+	if (best_cache_misses >= 0)
+		values[4] = Float8GetDatum((double) best_cache_misses / loops);
+	else
+		nulls[4] = true;
+
+	tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+}
+
+/*
+ * expr: ExecInterpExpr on a small expression tree.  The constants aren't
+ * folded, since the expression doesn't go through the planner.
+ */
+static void
+expr_setup(MicroBenchState *state)
+{
+	Expr	   *sum;
+	Expr	   *cmp;
+
+	sum = (Expr *) makeFuncExpr(F_INT4PL, INT4OID,
+								list_make2(makeConst(INT4OID, -1, InvalidOid,
+													 sizeof(int32),
+													 Int32GetDatum(1),
+													 false, true),
+										   makeConst(INT4OID, -1, InvalidOid,
+													 sizeof(int32),
+													 Int32GetDatum(2),
+													 false, true)),
+								InvalidOid, InvalidOid,
+								COERCE_EXPLICIT_CALL);
+	cmp = (Expr *) makeFuncExpr(F_INT4GT, BOOLOID,
+								list_make2(sum,
+										   makeConst(INT4OID, -1, InvalidOid,
+													 sizeof(int32),
+													 Int32GetDatum(0),
+													 false, true)),
+								InvalidOid, InvalidOid,
+								COERCE_EXPLICIT_CALL);
+
+	state->econtext = CreateStandaloneExprContext();
+	state->exprstate = ExecInitExpr(cmp, NULL);
+}
+
+static void
+expr_run(MicroBenchState *state)
+{
+	for (int64 i = 0; i < state->loops; i++)
+	{
+		bool		isnull;
+
+		(void) ExecEvalExprSwitchContext(state->exprstate, state->econtext,
+										 &isnull);
+		ResetExprContext(state->econtext);
+	}
+}
+
+static void
+expr_teardown(MicroBenchState *state)
+{
+	FreeExprContext(state->econtext, true);
+}
+
+/*
+ * bufmgr_hit and last_written_lsn: both work on pg_class, which always
+ * exists and has at least one block.
+ */
+static void
+bufmgr_setup(MicroBenchState *state)
+{
+	state->rel = table_open(RelationRelationId, AccessShareLock);
+}
+
+static void
+bufmgr_hit_run(MicroBenchState *state)
+{
+	for (int64 i = 0; i < state->loops; i++)
+		ReleaseBuffer(ReadBuffer(state->rel, 0));
+}
+
+static void
+last_written_lsn_run(MicroBenchState *state)
+{
+	for (int64 i = 0; i < state->loops; i++)
+		(void) GetLastWrittenLSN(state->rel->rd_node, MAIN_FORKNUM,
+								 (BlockNumber) (i % 1024));
+}
+
+static void
+bufmgr_teardown(MicroBenchState *state)
+{
+	table_close(state->rel, AccessShareLock);
+}
+
+/*
+ * xlog_insert: XLogInsert of a small record.  Logical messages are used
+ * because they can be emitted at any wal_level and are ignored on replay.
+ */
+static void
+xlog_insert_run(MicroBenchState *state)
+{
+	if (RecoveryInProgress())
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("WAL cannot be written during recovery")));
+
+	for (int64 i = 0; i < state->loops; i++)
+		(void) LogLogicalMessage("test_microbench", state->payload,
+								 sizeof(state->payload), false);
+}
+
+/*
+ * tuplesort: sort 'loops' pseudo-random int4 values, which are the same on
+ * every run.  To bound the memory used for the input, the values are sorted
+ * in batches of at most TUPLESORT_MAX_VALUES, each sorting the same input.
+ */
+static void
+tuplesort_setup(MicroBenchState *state)
+{
+	pg_prng_state prng;
+
+	state->nvalues = (int) Min(state->loops, TUPLESORT_MAX_VALUES);
+	pg_prng_seed(&prng, TUPLESORT_SEED);
+	state->values = palloc(sizeof(Datum) * state->nvalues);
+	for (int i = 0; i < state->nvalues; i++)
+		state->values[i] = Int32GetDatum((int32) pg_prng_uint32(&prng));
+}
+
+static void
+tuplesort_run(MicroBenchState *state)
+{
+	for (int64 done = 0; done < state->loops; done += state->nvalues)
+	{
+		int			nvalues = (int) Min(state->loops - done, state->nvalues);
+		Tuplesortstate *sortstate;
+		Datum		value;
+		bool		isnull;
+
+		sortstate = tuplesort_begin_datum(INT4OID, Int4LessOperator,
+										  InvalidOid, false, work_mem, NULL,
+										  TUPLESORT_NONE);
+		for (int i = 0; i < nvalues; i++)
+			tuplesort_putdatum(sortstate, state->values[i], false);
+		tuplesort_performsort(sortstate);
+		while (tuplesort_getdatum(sortstate, true, &value, &isnull, NULL))
+			;
+		tuplesort_end(sortstate);
+	}
+}
+
+static void
+tuplesort_teardown(MicroBenchState *state)
+{
+	pfree(state->values);
+}
+
+/*
+ * snapshot: GetSnapshotData, by way of GetLatestSnapshot().
+ *
+ * Unless other sessions commit concurrently, every call after the first
+ * finds xactCompletionCount unchanged and takes the GetSnapshotDataReuse()
+ * fast path, so this measures that path rather than a scan of the procarray.
+ */
+static void
+snapshot_run(MicroBenchState *state)
+{
+	for (int64 i = 0; i < state->loops; i++)
+		(void) GetLatestSnapshot();
+}
+
+#ifdef __linux__
+
+static int
+perf_counter_open(uint64 config)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void
+perf_counters_open(PerfCounters *counters)
+{
+	/* This fails if there's no PMU, or if perf_event_paranoid forbids it. */
+	counters->cycles_fd = perf_counter_open(PERF_COUNT_HW_CPU_CYCLES);
+	counters->cache_misses_fd = perf_counter_open(PERF_COUNT_HW_CACHE_MISSES);
+}
+
+static void
+perf_counters_close(PerfCounters *counters)
+{
+	if (counters->cycles_fd >= 0)
+		close(counters->cycles_fd);
+	if (counters->cache_misses_fd >= 0)
+		close(counters->cache_misses_fd);
+}
+
+static void
+perf_counters_start(PerfCounters *counters)
+{
+	if (counters->cycles_fd >= 0)
+	{
+		ioctl(counters->cycles_fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(counters->cycles_fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+	if (counters->cache_misses_fd >= 0)
+	{
+		ioctl(counters->cache_misses_fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(counters->cache_misses_fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+}
+
+static int64
+perf_counter_read(int fd)
+{
+	uint64		count;
+
+	if (fd < 0)
+		return -1;
+	ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+	if (read(fd, &count, sizeof(count)) != sizeof(count))
+		return -1;
+	return (int64) count;
+}
+
+static void
+perf_counters_stop(PerfCounters *counters, int64 *cycles, int64 *cache_misses)
+{
+	*cycles = perf_counter_read(counters->cycles_fd);
+	*cache_misses = perf_counter_read(counters->cache_misses_fd);
+}
+
+#else							/* !__linux__ */
+
+static void
+perf_counters_open(PerfCounters *counters)
+{
+	counters->cycles_fd = -1;
+	counters->cache_misses_fd = -1;
+}
+
+static void
+perf_counters_close(PerfCounters *counters)
+{
+}
+
+static void
+perf_counters_start(PerfCounters *counters)
+{
+}
+
+static void
+perf_counters_stop(PerfCounters *counters, int64 *cycles, int64 *cache_misses)
+{
+	*cycles = -1;
+	*cache_misses = -1;
+}
+
+#endif							/* __linux__ */
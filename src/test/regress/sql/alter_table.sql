@@ -2713,6 +2713,18 @@ ALTER TABLE hash_parted ATTACH PARTITION fail_part FOR VALUES WITH (MODULUS 8, R
 ALTER TABLE hash_parted ATTACH PARTITION fail_part FOR VALUES WITH (MODULUS 3, REMAINDER 2);
 DROP TABLE fail_part;
 
+-- check that the partition constraint can be verified by parallel workers
+CREATE TABLE parallel_attach (a int) PARTITION BY RANGE (a);
+CREATE TABLE parallel_attach_1 (a int) WITH (parallel_workers = 2);
+INSERT INTO parallel_attach_1 SELECT generate_series(1, 1001);
+-- terse, as the violation may be reported by either a worker or the leader
+\set VERBOSITY terse
+ALTER TABLE parallel_attach ATTACH PARTITION parallel_attach_1 FOR VALUES FROM (1) TO (1001);
+\set VERBOSITY default
+DELETE FROM parallel_attach_1 WHERE a = 1001;
+ALTER TABLE parallel_attach ATTACH PARTITION parallel_attach_1 FOR VALUES FROM (1) TO (1001);
+DROP TABLE parallel_attach;
+
 --
 -- DETACH PARTITION
 --
@@ -515,3 +515,22 @@ CREATE UNLOGGED TABLE brintest_unlogged (n numrange);
 CREATE INDEX brinidx_unlogged ON brintest_unlogged USING brin (n);
 INSERT INTO brintest_unlogged VALUES (numrange(0, 2^1000::numeric));
 DROP TABLE brintest_unlogged;
+
+-- test that a BRIN index doesn't block a HOT update, but still gets the new
+-- value summarized
+CREATE TABLE brin_hot (
+  id  integer PRIMARY KEY,
+  val integer NOT NULL
+) WITH (autovacuum_enabled = off, fillfactor = 70);
+INSERT INTO brin_hot SELECT *, 0 FROM generate_series(1, 235);
+CREATE INDEX val_brin ON brin_hot using brin(val);
+
+BEGIN;
+UPDATE brin_hot SET val = -3 WHERE id = 42;
+SELECT pg_stat_get_xact_tuples_hot_updated('brin_hot'::regclass::oid);
+COMMIT;
+
+SET enable_seqscan = off;
+SELECT * FROM brin_hot WHERE val = -3;
+RESET enable_seqscan;
+DROP TABLE brin_hot;
@@ -242,3 +242,83 @@ CREATE TABLE btree_part (id int4) PARTITION BY RANGE (id);
 CREATE INDEX btree_part_idx ON btree_part(id);
 ALTER INDEX btree_part_idx ALTER COLUMN id SET (n_distinct=100);
 DROP TABLE btree_part;
+
+--
+-- Test skip scans, which use quals on the second index column when there
+-- are none on the first
+--
+create table btree_skip (a int, b int, c int);
+insert into btree_skip select a, b, b
+  from generate_series(1, 4) a, generate_series(1, 1000) b;
+insert into btree_skip select null, b, b from generate_series(1, 1000) b;
+insert into btree_skip values (1, null, 0), (2, null, 0), (3, null, 0),
+  (4, null, 0), (null, null, 0);
+create index btree_skip_a_b_idx on btree_skip (a, b);
+vacuum analyze btree_skip;
+
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+
+explain (costs off)
+select * from btree_skip where b = 500 order by a;
+select * from btree_skip where b = 500 order by a;
+explain (costs off)
+select * from btree_skip where b = 500 order by a desc;
+select * from btree_skip where b = 500 order by a desc;
+select a, b from btree_skip where b >= 999 order by a, b;
+select a, b from btree_skip where b > 998 order by a desc, b desc;
+select count(*) from btree_skip where b is not null and b < 3;
+select * from btree_skip where b is null order by a;
+select * from btree_skip where b is null order by a desc;
+
+-- NULLS FIRST and DESC columns
+drop index btree_skip_a_b_idx;
+create index btree_skip_a_nf_b_idx on btree_skip (a nulls first, b desc);
+explain (costs off)
+select a, b from btree_skip where b >= 999 order by a nulls first, b desc;
+select a, b from btree_skip where b >= 999 order by a nulls first, b desc;
+select a, b from btree_skip where b >= 999 order by a desc nulls last, b;
+select * from btree_skip where b is null order by a nulls first;
+
+-- Bitmap scans
+set enable_indexscan = off;
+set enable_bitmapscan = on;
+explain (costs off)
+select count(*) from btree_skip where b = 500;
+select count(*) from btree_skip where b = 500;
+select count(*) from btree_skip where b is null;
+select count(*) from btree_skip where b <= 10;
+reset enable_indexscan;
+
+-- Mark and restore, as the inner side of a merge join
+drop index btree_skip_a_nf_b_idx;
+create index btree_skip_a_b_idx on btree_skip (a, b);
+create table btree_skip_outer (a int);
+insert into btree_skip_outer values (1), (1), (3), (3), (4);
+set enable_bitmapscan = off;
+set enable_hashjoin = off;
+set enable_nestloop = off;
+set enable_material = off;
+select o.a, s.b from btree_skip_outer o join btree_skip s on s.a = o.a
+  where s.b between 500 and 501 order by o.a, s.b;
+
+-- Skipping is given up where the first column's values are dense, in
+-- both scan directions
+create table btree_skip_dense (a int, b int);
+insert into btree_skip_dense select a, b
+  from generate_series(1, 4) a, generate_series(1, 2000) b;
+insert into btree_skip_dense select a, a % 2 from generate_series(1001, 1040) a;
+create index btree_skip_dense_idx on btree_skip_dense (a, b);
+alter table btree_skip_dense alter column a set (n_distinct = 10);
+vacuum analyze btree_skip_dense;
+explain (costs off)
+select array_agg(a) from (select a from btree_skip_dense where b = 1 order by a) s;
+select array_agg(a) from (select a from btree_skip_dense where b = 1 order by a) s;
+select array_agg(a) from (select a from btree_skip_dense where b = 1 order by a desc) s;
+
+reset enable_seqscan;
+reset enable_bitmapscan;
+reset enable_hashjoin;
+reset enable_nestloop;
+reset enable_material;
+drop table btree_skip, btree_skip_outer, btree_skip_dense;
@@ -0,0 +1,23 @@
+-- Tests for zstd TOAST compression; see compression.sql for the general
+-- behavior of column compression methods.
+
+\set HIDE_TOAST_COMPRESSION false
+
+CREATE TABLE cmzstd(f1 text COMPRESSION zstd);
+-- compressed inline, and compressed into several frames then moved out of
+-- line
+INSERT INTO cmzstd VALUES (repeat('1234567890', 1004));
+INSERT INTO cmzstd
+  SELECT string_agg(md5(g::text), '' ORDER BY g) FROM generate_series(1, 5000) g;
+\d+ cmzstd
+
+-- verify stored compression method in the data
+SELECT pg_column_compression(f1) FROM cmzstd;
+
+-- decompress whole values and data slices
+SELECT length(f1) FROM cmzstd;
+SELECT SUBSTR(f1, 200, 5) FROM cmzstd;
+SELECT SUBSTR(f1, 40001, 10) FROM cmzstd;
+SELECT SUBSTR(f1, 150001, 10) FROM cmzstd;
+
+DROP TABLE cmzstd;
@@ -204,3 +204,23 @@ select * from inttest where a not in (1::myint,2::myint,3::myint,4::myint,5::myi
 select * from inttest where a not in (0::myint,2::myint,3::myint,4::myint,5::myint, null);
 
 rollback;
+
+--
+-- Test caching of stable calls of constants and external parameters
+--
+create function cache_probe(int) returns int stable language plpgsql as
+$$ begin raise notice 'cache_probe(%)', $1; return $1; end $$;
+create function volatile_probe(int) returns int volatile language plpgsql as
+$$ begin raise notice 'volatile_probe(%)', $1; return $1; end $$;
+-- computed once, not for each row
+select x, cache_probe(2) from generate_series(1, 3) x;
+-- nested calls are cached as a whole
+select x, cache_probe(cache_probe(2) + 1) from generate_series(1, 3) x;
+-- calls of volatile functions are not cached
+select x, cache_probe(volatile_probe(2)) from generate_series(1, 3) x;
+-- computed again when the plan node is rescanned
+select o.a, s.x, s.p from (values (1), (2)) o(a),
+  lateral (select x, cache_probe(1) as p
+           from generate_series(1, o.a) x offset 0) s;
+drop function cache_probe(int);
+drop function volatile_probe(int);
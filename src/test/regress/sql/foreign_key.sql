@@ -2069,3 +2069,29 @@ UPDATE fkpart11.pk SET a = 3 WHERE a = 4;
 UPDATE fkpart11.pk SET a = 1 WHERE a = 2;
 
 DROP SCHEMA fkpart11 CASCADE;
+
+-- RI_FKey_check() remembers the last referenced key it found; make sure
+-- that doesn't outlive the referenced row
+CREATE TABLE fkrepeat_pk (a int PRIMARY KEY);
+CREATE TABLE fkrepeat_fk (a int REFERENCES fkrepeat_pk);
+INSERT INTO fkrepeat_pk VALUES (1);
+BEGIN;
+INSERT INTO fkrepeat_fk SELECT 1 FROM generate_series(1, 3);
+SAVEPOINT s1;
+INSERT INTO fkrepeat_pk VALUES (2);
+INSERT INTO fkrepeat_fk VALUES (2);
+ROLLBACK TO s1;
+INSERT INTO fkrepeat_fk VALUES (2); -- fail
+ROLLBACK;
+BEGIN;
+INSERT INTO fkrepeat_fk VALUES (1);
+DELETE FROM fkrepeat_fk;
+DELETE FROM fkrepeat_pk;
+INSERT INTO fkrepeat_fk VALUES (1); -- fail
+ROLLBACK;
+BEGIN;
+INSERT INTO fkrepeat_fk VALUES (1);
+TRUNCATE fkrepeat_pk, fkrepeat_fk;
+INSERT INTO fkrepeat_fk VALUES (1); -- fail
+ROLLBACK;
+DROP TABLE fkrepeat_fk, fkrepeat_pk;
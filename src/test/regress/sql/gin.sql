@@ -181,3 +181,14 @@ values
   ('{}',    null),
   ('{1}',   '{2,3}');
 drop table t_gin_test_tbl;
+
+-- An insertion cleans up a pending list that has grown far past its limit,
+-- even when autovacuum has been asked to clean it up
+create table t_gin_pending_tbl(i int4[]);
+create index t_gin_pending_idx on t_gin_pending_tbl using gin (i)
+  with (fastupdate = on, gin_pending_list_limit = 64);
+insert into t_gin_pending_tbl select array[g, g + 1]
+  from generate_series(1, 20000) g;
+select gin_clean_pending_list('t_gin_pending_idx') *
+  current_setting('block_size')::int <= 4 * 64 * 1024 as bounded;
+drop table t_gin_pending_tbl;
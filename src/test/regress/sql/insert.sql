@@ -597,3 +597,56 @@ alter table returningwrtest2 drop c;
 alter table returningwrtest attach partition returningwrtest2 for values in (2);
 insert into returningwrtest values (2, 'foo') returning returningwrtest;
 drop table returningwrtest;
+
+--
+-- INSERT into a table buffers the rows and writes them out in batches when
+-- nothing can tell the difference; check the cases that could
+--
+create table batchins (a int primary key, b text);
+-- more rows than one batch holds, wide enough to be flushed on size, too
+insert into batchins select g, repeat('x', 1000) from generate_series(1, 250) g;
+select count(*), sum(a), sum(length(b)) from batchins;
+-- a duplicate within the same batch is still caught
+insert into batchins select g, 'y' from generate_series(251, 300) g
+  union all select 260, 'dup';
+-- a BEFORE ROW trigger sees all the rows inserted before its own
+create function batchins_count() returns trigger language plpgsql as $$
+begin
+  new.b := (select count(*) from batchins)::text;
+  return new;
+end $$;
+create trigger batchins_count before insert on batchins
+  for each row execute function batchins_count();
+insert into batchins select g, null from generate_series(301, 305) g;
+select a, b from batchins where a > 300 order by a;
+drop trigger batchins_count on batchins;
+-- AFTER ROW triggers fire once per row
+create function batchins_notice() returns trigger language plpgsql as $$
+begin
+  raise notice 'inserted %', new.a;
+  return null;
+end $$;
+create trigger batchins_notice after insert on batchins
+  for each row execute function batchins_notice();
+insert into batchins values (306, 'a'), (307, 'b');
+drop trigger batchins_notice on batchins;
+-- RETURNING returns every row
+insert into batchins select g, 'r' from generate_series(308, 310) g
+  returning a, b;
+-- ON CONFLICT sees conflicts with rows of the same statement
+insert into batchins select g % 3 + 311, 'c' || g from generate_series(1, 6) g
+  on conflict (a) do nothing;
+select a, b from batchins where a > 310 order by a;
+-- rows are routed to the right partitions
+create table batchins_part (a int, b text) partition by range (a);
+create table batchins_part1 partition of batchins_part for values from (1) to (101);
+create table batchins_part2 partition of batchins_part for values from (101) to (301);
+insert into batchins_part select g, 'p' from generate_series(1, 300) g;
+select tableoid::regclass, count(*), min(a), max(a) from batchins_part
+  group by 1 order by 1;
+-- and a row inserted directly into the wrong partition is still rejected
+insert into batchins_part1 select g, 'p' from generate_series(100, 101) g;
+drop table batchins_part;
+drop table batchins;
+drop function batchins_count();
+drop function batchins_notice();
@@ -157,6 +157,15 @@ $$
 $$);
 rollback to settings;
 
+-- non-parallel, with compressed batch files
+savepoint settings;
+set local max_parallel_workers_per_gather = 0;
+set local work_mem = '128kB';
+set local hash_mem_multiplier = 1.0;
+set local temp_file_compression = 'pglz';
+select count(*) from simple r join simple s using (id);
+rollback to settings;
+
 -- parallel with parallel-oblivious hash join
 savepoint settings;
 set local max_parallel_workers_per_gather = 2;
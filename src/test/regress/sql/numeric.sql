@@ -1102,6 +1102,22 @@ select 4769999999999999999999999999999999999999999999999999999999999999999999999
 
 select trim_scale((0.1 - 2e-16383) * (0.1 - 3e-16383));
 
+--
+-- Test addition, subtraction and multiplication of values on both sides of
+-- the limits of the fast path for small values
+--
+
+select x, y, x + y as sum, x - y as diff, x * y as prod
+from (values (99999999999999999, 1),
+             (100000000000000000, 1),
+             (-99999999999999999, 99999999999999999),
+             (0.99999999999999999, 0.99999999999999999),
+             (1.00000000000000000, 0.00000000000000001),
+             (12345678.9, -0.000000001),
+             (99999999.99999999, 99999999.99999999)) v(x, y);
+select 1e-8000 * 1e-8000 = 1e-16000 as eq, scale(1e-8000 * 1e-8000);
+select 1e-9000 * 1e-9000 = 0 as eq, scale(1e-9000 * 1e-9000);
+
 --
 -- Test some corner cases for division
 --
@@ -152,6 +152,11 @@ select regexp_match('fooba', '(?:..)*');
 select regexp_match('xyz', repeat('.', 260));
 select regexp_match('foo', '(?:.|){99}');
 
+-- Required-literal prefiltering
+select 'xfooybarz' ~ 'foo.*bar' as t, 'xfoybarz' ~ 'foo.*bar' as f;
+select 'barfoo' ~ 'foo.*bar' as f, 'fobar' ~ 'fo+bar' as t;
+select 'ac' ~ 'ab?c' as t, 'abbbcd' ~ 'ab{2,3}cd' as t;
+
 -- Error conditions
 select 'xyz' ~ 'x(\w)(?=\1)';  -- no backrefs in LACONs
 select 'xyz' ~ 'x(\w)(?=(\1))';
@@ -48,6 +48,15 @@ select count(*) > 0 as ok from pg_stat_slru;
 -- There must be only one record
 select count(*) = 1 as ok from pg_stat_wal;
 
+-- There must be only one record
+select count(*) = 1 as ok from pg_stat_last_written_lsn_cache;
+
+-- There must be one record per storage manager operation
+select count(*) = 4 as ok from pg_stat_smgr_latency;
+
+-- The buffer cache simulation is disabled by default
+select count(*) = 0 as ok from pg_stat_buffer_simulation;
+
 -- We expect no walreceiver running in this test
 select count(*) = 0 as ok from pg_stat_wal_receiver;
 
@@ -2766,3 +2766,25 @@ alter trigger parenttrig on parent rename to anothertrig;
 
 drop table parent, child;
 drop function f();
+
+-- Several AFTER ROW triggers fired by the same row all see its tuples
+create table trig_rows (a int, b text) partition by list (a);
+create table trig_rows_1 partition of trig_rows for values in (1);
+create table trig_rows_2 partition of trig_rows for values in (2);
+create function trig_rows_show() returns trigger language plpgsql as $$
+begin
+  raise notice '% on %: % old %, new %',
+    tg_name, tg_table_name, tg_op, old, new;
+  return null;
+end$$;
+create trigger trig_a after insert or update or delete on trig_rows
+  for each row execute function trig_rows_show();
+create trigger trig_b after insert or update or delete on trig_rows
+  for each row execute function trig_rows_show();
+insert into trig_rows values (1, 'one'), (1, 'uno');
+update trig_rows set b = b || '!';
+-- moving a row to another partition fires DELETE and INSERT triggers
+update trig_rows set a = 2 where b = 'one!';
+delete from trig_rows;
+drop table trig_rows;
+drop function trig_rows_show();
@@ -1629,3 +1629,24 @@ create temp table with_test (i int);
 with with_test as (select 42) insert into with_test select * from with_test;
 select * from with_test;
 drop table with_test;
+
+-- check CTE scans reading a tuplestore spilled to a compressed temp file
+set work_mem = '64kB';
+set temp_file_compression = pglz;
+with recursive t(n, pad) as (
+  select 1, repeat('x', 100)
+  union all
+  select n + 1, pad from t where n < 5000
+)
+select count(*), sum(a.n) from t a join t b on a.n = b.n;
+-- interleave two readers with the writer of a compressed tuplestore: each
+-- subquery scan rereads the CTE and makes it append the next row, at varying
+-- offsets within the compressed chunks
+with x as materialized (
+  select g, repeat('x', 100) || g as pad from generate_series(1, 3000) g
+)
+select count(*), bool_and(n = repeat('x', 100) || (g + 1)) as ok
+from (select a.g, (select b.pad from x b where b.g > a.g limit 1) as n
+      from x a where a.g % 37 = 0) s;
+reset temp_file_compression;
+reset work_mem;
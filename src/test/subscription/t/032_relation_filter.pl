@@ -0,0 +1,119 @@
+# Copyright (c) 2022, PostgreSQL Global Development Group
+
+# Test that changes filtered by relation while decoding, before they are
+# queued, are the ones replay would have thrown away
+use strict;
+use warnings;
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+# create publisher node
+my $node_publisher = PostgreSQL::Test::Cluster->new('publisher');
+$node_publisher->init(allows_streaming => 'logical');
+$node_publisher->start;
+
+# create subscriber node
+my $node_subscriber = PostgreSQL::Test::Cluster->new('subscriber');
+$node_subscriber->init(allows_streaming => 'logical');
+$node_subscriber->start;
+
+my $publisher_connstr = $node_publisher->connstr . ' dbname=postgres';
+my $appname           = 'tap_sub';
+
+my $ddl = qq(
+	CREATE TABLE tab_ins (a int primary key);
+	CREATE TABLE tab_b (a int primary key);
+	CREATE TABLE tab_c (a int primary key););
+$node_publisher->safe_psql('postgres', $ddl);
+$node_subscriber->safe_psql('postgres', $ddl);
+
+$node_publisher->safe_psql('postgres',
+	"CREATE PUBLICATION tap_pub FOR TABLE tab_ins WITH (publish = 'insert')"
+);
+$node_subscriber->safe_psql('postgres',
+	"CREATE SUBSCRIPTION tap_sub CONNECTION '$publisher_connstr application_name=$appname' PUBLICATION tap_pub"
+);
+$node_subscriber->wait_for_subscription_sync($node_publisher, $appname);
+
+# Only the inserts of tab_ins are published, and the changes of the other
+# tables are not
+$node_publisher->safe_psql(
+	'postgres', qq(
+	INSERT INTO tab_ins VALUES (1), (2), (3);
+	UPDATE tab_ins SET a = a + 10 WHERE a = 1;
+	DELETE FROM tab_ins WHERE a = 2;
+	INSERT INTO tab_b VALUES (1);
+	INSERT INTO tab_ins VALUES (4);));
+$node_publisher->wait_for_catchup($appname);
+
+my $result =
+  $node_subscriber->safe_psql('postgres', "SELECT a FROM tab_ins ORDER BY a");
+is($result, qq(1
+2
+3
+4), 'updates and deletes of an insert-only publication are filtered');
+$result =
+  $node_subscriber->safe_psql('postgres', "SELECT count(*) FROM tab_b");
+is($result, qq(0), 'changes of an unpublished table are filtered');
+
+# Adding a table to the publication makes its later changes published, even
+# though its earlier ones were filtered
+$node_publisher->safe_psql('postgres',
+	"ALTER PUBLICATION tap_pub ADD TABLE tab_b");
+$node_subscriber->safe_psql('postgres',
+	"ALTER SUBSCRIPTION tap_sub REFRESH PUBLICATION WITH (copy_data = false)"
+);
+$node_publisher->safe_psql('postgres', "INSERT INTO tab_b VALUES (2)");
+$node_publisher->wait_for_catchup($appname);
+
+$result =
+  $node_subscriber->safe_psql('postgres', "SELECT a FROM tab_b ORDER BY a");
+is($result, qq(2), 'changes are published after ALTER PUBLICATION ADD TABLE');
+
+# A transaction that started before a table was added to the publication
+# decodes its later changes of the table with a newer catalog snapshot than
+# its base snapshot; they must not be filtered with the base snapshot
+my $psql_timeout = IPC::Run::timer($PostgreSQL::Test::Utils::timeout_default);
+my %psql = ('stdin' => '', 'stdout' => '');
+$psql{run} =
+  $node_publisher->background_psql('postgres', \$psql{stdin},
+	\$psql{stdout}, $psql_timeout);
+$psql{stdin} .= qq(
+	BEGIN;
+	INSERT INTO tab_ins VALUES (5);
+	SELECT 'started';
+);
+ok(pump_until($psql{run}, $psql_timeout, \$psql{stdout}, qr/^started$/m),
+	'transaction started');
+
+$node_publisher->safe_psql('postgres',
+	"ALTER PUBLICATION tap_pub ADD TABLE tab_c");
+$node_subscriber->safe_psql('postgres',
+	"ALTER SUBSCRIPTION tap_sub REFRESH PUBLICATION WITH (copy_data = false)"
+);
+
+$psql{stdin} .= qq(
+	INSERT INTO tab_c VALUES (1);
+	COMMIT;
+	SELECT 'committed';
+);
+ok(pump_until($psql{run}, $psql_timeout, \$psql{stdout}, qr/^committed$/m),
+	'transaction committed');
+$psql{stdin} .= "\\q\n";
+$psql{run}->finish;
+
+$node_publisher->wait_for_catchup($appname);
+
+$result =
+  $node_subscriber->safe_psql('postgres', "SELECT a FROM tab_c ORDER BY a");
+is($result, qq(1),
+	'changes after a concurrent ALTER PUBLICATION ADD TABLE are published');
+$result = $node_subscriber->safe_psql('postgres',
+	"SELECT count(*) FROM tab_ins WHERE a = 5");
+is($result, qq(1), 'changes before it are published');
+
+$node_subscriber->stop('fast');
+$node_publisher->stop('fast');
+
+done_testing();